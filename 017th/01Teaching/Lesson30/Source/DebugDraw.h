@@ -0,0 +1,39 @@
+﻿#pragma once
+#include "DxLib.h"
+
+/**
+* @struct DEBUGDRAW
+* @brief 経路やポリゴンの輪郭などの確認用の図形をためておき、まとめて描画する入れ物
+* @details 線と三角形を種類ごとの配列にためて、DebugDraw_Flush で種類ごとに１回ずつ描画する
+*          DebugDraw_BeginStatic から DebugDraw_EndStatic までに追加した図形は頂点バッファに入れて、毎フレーム作り直さずに描画する
+*/
+struct DEBUGDRAW
+{
+	VERTEX3D *line;							//!< 線の頂点( ２頂点で１本 )
+	int lineNum;							//!< ためている線の数
+	int lineMax;							//!< ためられる線の最大数
+	VERTEX3D *triangle;						//!< 三角形の頂点( ３頂点で１枚 )
+	int triangleNum;						//!< ためている三角形の数
+	int triangleMax;						//!< ためられる三角形の最大数
+	bool isStatic;							//!< DebugDraw_BeginStatic から DebugDraw_EndStatic までの間か
+	int staticLineBuffer;					//!< 変わらない線の頂点バッファ( -1:無し )
+	int staticTriangleBuffer;				//!< 変わらない三角形の頂点バッファ( -1:無し )
+	int staticLineNum;						//!< 変わらない線の数
+	int staticTriangleNum;					//!< 変わらない三角形の数
+	int drawCallNum;						//!< このフレームで描画を呼んだ回数( 一杯になって途中で描画した分も含む )
+	int drawLineNum;						//!< このフレームで描画した線の数
+	int drawTriangleNum;					//!< このフレームで描画した三角形の数
+	int lastDrawCallNum;					//!< 前のフレームで描画を呼んだ回数( 統計用 )
+	int lastDrawLineNum;					//!< 前のフレームで描画した線の数( 統計用 )
+	int lastDrawTriangleNum;				//!< 前のフレームで描画した三角形の数( 統計用 )
+};
+
+bool DebugDraw_Initialize(DEBUGDRAW *debugDraw, int lineMax, int triangleMax);	//!< 入れ物を確保する( 戻り値  true:成功  false:失敗 )
+void DebugDraw_Terminate(DEBUGDRAW *debugDraw);		//!< 入れ物の後始末
+void DebugDraw_AddLine(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, COLOR_U8 color);	//!< 線を追加する
+void DebugDraw_AddTriangle(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, VECTOR pos3, COLOR_U8 color, bool fillFlag);	//!< 三角形を追加する( fillFlag が false なら輪郭の線 )
+void DebugDraw_AddSphere(DEBUGDRAW *debugDraw, VECTOR centerPos, float r, COLOR_U8 color, bool fillFlag);	//!< 球を追加する( fillFlag が false なら線で組んだ形 )
+void DebugDraw_AddCapsule(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, float r, COLOR_U8 color, bool fillFlag);	//!< カプセルを追加する( fillFlag が false なら線で組んだ形 )
+void DebugDraw_BeginStatic(DEBUGDRAW *debugDraw);	//!< ここから DebugDraw_EndStatic までに追加した図形を変わらない図形として覚える
+void DebugDraw_EndStatic(DEBUGDRAW *debugDraw);		//!< 追加した図形を頂点バッファに入れる( 前に覚えた図形は捨てる )
+void DebugDraw_Flush(DEBUGDRAW *debugDraw);			//!< 変わらない図形とためている図形を描画して、ためている図形を空にする
@@ -1,4 +1,5 @@
 ﻿#include "DxLib.h"
+#include "DebugDraw.h"
 #include <math.h>
 /**
 * @file
@@ -22,6 +23,8 @@ const float CAMERA_LOOK_AT_HEIGHT = 180.0f;		//!< カメラの注視点の高さ
 const float CAMERA_LOOK_AT_DISTANCE = 250.0f;	//!< カメラと注視点の距離
 const float	LINE_AREA_SIZE = 10000.0f;			//!< ラインを描く範囲
 const int	LINE_NUM = 50;						//!< ラインの数
+const int	DEBUGDRAW_LINEMAX = LINE_NUM * 2 + 1;	//!< 確認用の図形としてためられる線の最大数( 地面のライン )
+const int	DEBUGDRAW_TRIANGLEMAX = 1;			//!< 確認用の図形としてためられる三角形の最大数
 
 /**
 * @enum Animation
@@ -106,6 +109,38 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// 3Dモデルの座標を初期化
 	VECTOR position = VGet(0.0f, 0.0f, 0.0f);
 
+	// 位置関係が分かるように地面に描くラインは変わらないので、確認用の図形の頂点バッファに入れておく
+	DEBUGDRAW debugDraw;
+	if(!DebugDraw_Initialize(&debugDraw, DEBUGDRAW_LINEMAX, DEBUGDRAW_TRIANGLEMAX))
+	{
+		DxLib_End();
+		return -1;
+	}
+	DebugDraw_BeginStatic(&debugDraw);
+	{
+		VECTOR pos1;
+		VECTOR pos2;
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<=LINE_NUM; i++)
+		{
+			DebugDraw_AddLine(&debugDraw, pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.x += LINE_AREA_SIZE / LINE_NUM;
+			pos2.x += LINE_AREA_SIZE / LINE_NUM;
+		}
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<LINE_NUM; i++)
+		{
+			DebugDraw_AddLine(&debugDraw, pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.z += LINE_AREA_SIZE / LINE_NUM;
+			pos2.z += LINE_AREA_SIZE / LINE_NUM;
+		}
+	}
+	DebugDraw_EndStatic(&debugDraw);
+
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
 
@@ -296,33 +331,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		// 3Dモデルの描画
 		MV1DrawModel(modelHandle);
 
-		// 位置関係が分かるように地面にラインを描画する
-		{
-			VECTOR pos1;
-			VECTOR pos2;
-
-			SetUseZBufferFlag(true);
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<=LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.x += LINE_AREA_SIZE / LINE_NUM;
-				pos2.x += LINE_AREA_SIZE / LINE_NUM;
-			}
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.z += LINE_AREA_SIZE / LINE_NUM;
-				pos2.z += LINE_AREA_SIZE / LINE_NUM;
-			}
-
-			SetUseZBufferFlag(false);
-		}
+		// 位置関係が分かるように地面にラインを描画する( 頂点バッファに入れておいたものを１回で描画する )
+		SetUseZBufferFlag(true);
+		DebugDraw_Flush(&debugDraw);
+		SetUseZBufferFlag(false);
 
 		// 裏画面の内容を表画面に反映
 		ScreenFlip();
@@ -334,6 +346,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 	}
 
+	// 確認用の図形の後始末
+	DebugDraw_Terminate(&debugDraw);
+
 	// DXライブラリの後始末
 	DxLib_End();
 
@@ -0,0 +1,449 @@
+﻿#include "DebugDraw.h"
+#include <malloc.h>
+#include <math.h>
+/**
+* @file
+* @brief Lesson32
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details 経路やポリゴンの輪郭などの確認用の図形をためておき、まとめて描画する
+*          DrawLine3D、DrawTriangle3D、DrawSphere3D、DrawCapsule3D を図形の数だけ呼ぶ代わりに、種類ごとに DrawPrimitive3D を１回ずつ呼ぶ
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+static const int DEBUGDRAW_SHELLDIV = 8;		//!< 球とカプセルの経度方向の分割数
+static const int DEBUGDRAW_SHELLROW = 6;		//!< 球とカプセルの緯度方向の頂点の列の数( 南極、-45度、赤道( 下 )、赤道( 上 )、45度、北極 )
+static const float DEBUGDRAW_SHELLROWSIN[DEBUGDRAW_SHELLROW] = { -1.0f, -0.70710678f, 0.0f, 0.0f, 0.70710678f, 1.0f };	//!< 頂点の列ごとの緯度の sin
+static const float DEBUGDRAW_SHELLROWCOS[DEBUGDRAW_SHELLROW] = { 0.0f, 0.70710678f, 1.0f, 1.0f, 0.70710678f, 0.0f };	//!< 頂点の列ごとの緯度の cos
+
+/**
+* @fn DebugDraw_Initialize
+* @brief 入れ物を確保する
+* @param[out] DEBUGDRAW *debugDraw
+* @param[in] int lineMax ためられる線の最大数, int triangleMax ためられる三角形の最大数
+* @return bool true:成功  false:失敗
+*/
+bool DebugDraw_Initialize(DEBUGDRAW *debugDraw, int lineMax, int triangleMax)
+{
+	debugDraw->line = (VERTEX3D *)malloc(sizeof(VERTEX3D) * lineMax * 2);
+	debugDraw->triangle = (VERTEX3D *)malloc(sizeof(VERTEX3D) * triangleMax * 3);
+	debugDraw->staticLineBuffer = -1;
+	debugDraw->staticTriangleBuffer = -1;
+	if(debugDraw->line == NULL || debugDraw->triangle == NULL)
+	{
+		DebugDraw_Terminate(debugDraw);
+		return false;
+	}
+
+	debugDraw->lineNum = 0;
+	debugDraw->lineMax = lineMax;
+	debugDraw->triangleNum = 0;
+	debugDraw->triangleMax = triangleMax;
+	debugDraw->isStatic = false;
+	debugDraw->staticLineNum = 0;
+	debugDraw->staticTriangleNum = 0;
+	debugDraw->drawCallNum = 0;
+	debugDraw->drawLineNum = 0;
+	debugDraw->drawTriangleNum = 0;
+	debugDraw->lastDrawCallNum = 0;
+	debugDraw->lastDrawLineNum = 0;
+	debugDraw->lastDrawTriangleNum = 0;
+	return true;
+}
+
+/**
+* @fn DebugDraw_Terminate
+* @brief 入れ物の後始末
+* @param[in] DEBUGDRAW *debugDraw
+*/
+void DebugDraw_Terminate(DEBUGDRAW *debugDraw)
+{
+	if(debugDraw->staticLineBuffer != -1)
+	{
+		DeleteVertexBuffer(debugDraw->staticLineBuffer);
+	}
+	if(debugDraw->staticTriangleBuffer != -1)
+	{
+		DeleteVertexBuffer(debugDraw->staticTriangleBuffer);
+	}
+	free(debugDraw->line);
+	free(debugDraw->triangle);
+	debugDraw->line = NULL;
+	debugDraw->triangle = NULL;
+	debugDraw->staticLineBuffer = -1;
+	debugDraw->staticTriangleBuffer = -1;
+	debugDraw->lineNum = 0;
+	debugDraw->lineMax = 0;
+	debugDraw->triangleNum = 0;
+	debugDraw->triangleMax = 0;
+	debugDraw->staticLineNum = 0;
+	debugDraw->staticTriangleNum = 0;
+}
+
+/**
+* @fn DebugDraw_FlushDynamic
+* @brief ためている図形を描画して空にする
+* @param[in] DEBUGDRAW *debugDraw
+* @details 線はライティングをせずに、三角形は法線でライティングをして描画する
+*          色のアルファ値で半透明にする、ブレンドモードとライティングは呼び出し前の設定に戻す
+*/
+static void DebugDraw_FlushDynamic(DEBUGDRAW *debugDraw)
+{
+	if(debugDraw->lineNum == 0 && debugDraw->triangleNum == 0)
+	{
+		return;
+	}
+
+	// 呼び出し側の描画の設定を覚えておき、描画後に戻す
+	int blendMode;
+	int blendParam;
+	GetDrawBlendMode(&blendMode, &blendParam);
+	int useLighting = GetUseLighting();
+	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
+	if(debugDraw->lineNum > 0)
+	{
+		SetUseLighting(false);
+		DrawPrimitive3D(debugDraw->line, debugDraw->lineNum * 2, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPHIC, true);
+		debugDraw->drawCallNum++;
+		debugDraw->drawLineNum += debugDraw->lineNum;
+	}
+	if(debugDraw->triangleNum > 0)
+	{
+		SetUseLighting(true);
+		DrawPrimitive3D(debugDraw->triangle, debugDraw->triangleNum * 3, DX_PRIMTYPE_TRIANGLELIST, DX_NONE_GRAPHIC, true);
+		debugDraw->drawCallNum++;
+		debugDraw->drawTriangleNum += debugDraw->triangleNum;
+	}
+	SetUseLighting(useLighting);
+	SetDrawBlendMode(blendMode, blendParam);
+
+	debugDraw->lineNum = 0;
+	debugDraw->triangleNum = 0;
+}
+
+/**
+* @fn DebugDraw_ReserveLine
+* @brief 線を num 本ためられるようにする
+* @param[in] DEBUGDRAW *debugDraw, int num
+* @return bool true:ためられる  false:あふれる
+* @details 一杯の時はそこまでの図形を先に描画して空ける( 変わらない図形を覚えている間は空けられない )
+*/
+static bool DebugDraw_ReserveLine(DEBUGDRAW *debugDraw, int num)
+{
+	if(debugDraw->lineNum + num <= debugDraw->lineMax)
+	{
+		return true;
+	}
+	if(debugDraw->isStatic || num > debugDraw->lineMax)
+	{
+		return false;
+	}
+	DebugDraw_FlushDynamic(debugDraw);
+	return true;
+}
+
+/**
+* @fn DebugDraw_ReserveTriangle
+* @brief 三角形を num 枚ためられるようにする
+* @param[in] DEBUGDRAW *debugDraw, int num
+* @return bool true:ためられる  false:あふれる
+* @details 一杯の時はそこまでの図形を先に描画して空ける( 変わらない図形を覚えている間は空けられない )
+*/
+static bool DebugDraw_ReserveTriangle(DEBUGDRAW *debugDraw, int num)
+{
+	if(debugDraw->triangleNum + num <= debugDraw->triangleMax)
+	{
+		return true;
+	}
+	if(debugDraw->isStatic || num > debugDraw->triangleMax)
+	{
+		return false;
+	}
+	DebugDraw_FlushDynamic(debugDraw);
+	return true;
+}
+
+/**
+* @fn DebugDraw_SetVertex
+* @brief 頂点を設定する
+* @param[out] VERTEX3D *vertex
+* @param[in] VECTOR pos, VECTOR norm, COLOR_U8 color
+*/
+static void DebugDraw_SetVertex(VERTEX3D *vertex, VECTOR pos, VECTOR norm, COLOR_U8 color)
+{
+	vertex->pos = pos;
+	vertex->norm = norm;
+	vertex->dif = color;
+	vertex->spc = GetColorU8(0, 0, 0, 0);
+	vertex->u = 0.0f;
+	vertex->v = 0.0f;
+	vertex->su = 0.0f;
+	vertex->sv = 0.0f;
+}
+
+/**
+* @fn DebugDraw_AddLine
+* @brief 線を追加する
+* @param[in] DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, COLOR_U8 color
+*/
+void DebugDraw_AddLine(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, COLOR_U8 color)
+{
+	if(!DebugDraw_ReserveLine(debugDraw, 1))
+	{
+		return;
+	}
+	VERTEX3D *vertex = &debugDraw->line[debugDraw->lineNum * 2];
+	DebugDraw_SetVertex(&vertex[0], pos1, VGet(0.0f, 1.0f, 0.0f), color);
+	DebugDraw_SetVertex(&vertex[1], pos2, VGet(0.0f, 1.0f, 0.0f), color);
+	debugDraw->lineNum++;
+}
+
+/**
+* @fn DebugDraw_AddTriangle
+* @brief 三角形を追加する
+* @param[in] DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, VECTOR pos3, COLOR_U8 color, bool fillFlag false:輪郭の線だけ
+*/
+void DebugDraw_AddTriangle(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, VECTOR pos3, COLOR_U8 color, bool fillFlag)
+{
+	if(!fillFlag)
+	{
+		DebugDraw_AddLine(debugDraw, pos1, pos2, color);
+		DebugDraw_AddLine(debugDraw, pos2, pos3, color);
+		DebugDraw_AddLine(debugDraw, pos3, pos1, color);
+		return;
+	}
+	if(!DebugDraw_ReserveTriangle(debugDraw, 1))
+	{
+		return;
+	}
+
+	// 法線は辺の外積から求める( 潰れた三角形は上向きにする )
+	VECTOR norm = VCross(VSub(pos2, pos1), VSub(pos3, pos1));
+	float length = VSize(norm);
+	norm = length > 0.0f ? VScale(norm, 1.0f / length) : VGet(0.0f, 1.0f, 0.0f);
+
+	VERTEX3D *vertex = &debugDraw->triangle[debugDraw->triangleNum * 3];
+	DebugDraw_SetVertex(&vertex[0], pos1, norm, color);
+	DebugDraw_SetVertex(&vertex[1], pos2, norm, color);
+	DebugDraw_SetVertex(&vertex[2], pos3, norm, color);
+	debugDraw->triangleNum++;
+}
+
+/**
+* @fn DebugDraw_AddShell
+* @brief 線分の両端に半球をつけた形を追加する
+* @param[in] DEBUGDRAW *debugDraw, VECTOR pos1 下の半球の中心, VECTOR pos2 上の半球の中心, float r 半径, COLOR_U8 color, bool fillFlag false:線で組んだ形
+* @details 経度 DEBUGDRAW_SHELLDIV 本、緯度 DEBUGDRAW_SHELLROW 列の格子を作り、線なら緯線と経線、面なら格子の四角形を三角形２枚ずつで追加する
+*          pos1 と pos2 が同じ場所なら球になるので、重なる赤道の２列の間は追加しない
+*/
+static void DebugDraw_AddShell(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, float r, COLOR_U8 color, bool fillFlag)
+{
+	// 線分の向きを軸にして、それに垂直な２本の向きを求める
+	VECTOR axis = VSub(pos2, pos1);
+	float length = VSize(axis);
+	bool sphere = length <= 0.0f;
+	axis = sphere ? VGet(0.0f, 1.0f, 0.0f) : VScale(axis, 1.0f / length);
+	VECTOR side1 = VNorm(VCross(axis, fabsf(axis.x) < 0.9f ? VGet(1.0f, 0.0f, 0.0f) : VGet(0.0f, 1.0f, 0.0f)));
+	VECTOR side2 = VCross(axis, side1);
+
+	// 格子の頂点の向き( 長さ１ )と、その頂点の半球の中心を求める
+	VECTOR direction[DEBUGDRAW_SHELLROW][DEBUGDRAW_SHELLDIV];
+	VECTOR center[DEBUGDRAW_SHELLROW];
+	for(int row=0; row<DEBUGDRAW_SHELLROW; row++)
+	{
+		center[row] = row < DEBUGDRAW_SHELLROW / 2 ? pos1 : pos2;
+		for(int i=0; i<DEBUGDRAW_SHELLDIV; i++)
+		{
+			float angle = DX_PI_F * 2.0f * i / DEBUGDRAW_SHELLDIV;
+			VECTOR around = VAdd(VScale(side1, cosf(angle)), VScale(side2, sinf(angle)));
+			direction[row][i] = VAdd(VScale(around, DEBUGDRAW_SHELLROWCOS[row]), VScale(axis, DEBUGDRAW_SHELLROWSIN[row]));
+		}
+	}
+
+	int bandNum = DEBUGDRAW_SHELLROW - 1;
+	int equatorBand = DEBUGDRAW_SHELLROW / 2 - 1;
+	if(!fillFlag)
+	{
+		int lineNum = (DEBUGDRAW_SHELLROW - 2 - (sphere ? 1 : 0)) * DEBUGDRAW_SHELLDIV + (bandNum - (sphere ? 1 : 0)) * DEBUGDRAW_SHELLDIV;
+		if(!DebugDraw_ReserveLine(debugDraw, lineNum))
+		{
+			return;
+		}
+
+		// 緯線( 極は点なので除く )
+		for(int row=1; row<DEBUGDRAW_SHELLROW-1; row++)
+		{
+			if(sphere && row == equatorBand + 1)
+			{
+				continue;
+			}
+			for(int i=0; i<DEBUGDRAW_SHELLDIV; i++)
+			{
+				int next = (i + 1) % DEBUGDRAW_SHELLDIV;
+				DebugDraw_AddLine(debugDraw, VAdd(center[row], VScale(direction[row][i], r)), VAdd(center[row], VScale(direction[row][next], r)), color);
+			}
+		}
+
+		// 経線
+		for(int band=0; band<bandNum; band++)
+		{
+			if(sphere && band == equatorBand)
+			{
+				continue;
+			}
+			for(int i=0; i<DEBUGDRAW_SHELLDIV; i++)
+			{
+				DebugDraw_AddLine(debugDraw, VAdd(center[band], VScale(direction[band][i], r)), VAdd(center[band + 1], VScale(direction[band + 1][i], r)), color);
+			}
+		}
+		return;
+	}
+
+	// 極につながる帯は三角形１枚、それ以外は２枚ずつ
+	int triangleNum = (bandNum - 2 - (sphere ? 1 : 0)) * DEBUGDRAW_SHELLDIV * 2 + DEBUGDRAW_SHELLDIV * 2;
+	if(!DebugDraw_ReserveTriangle(debugDraw, triangleNum))
+	{
+		return;
+	}
+	static const int order[2][3] = { { 0, 2, 1 }, { 1, 2, 3 } };
+	for(int band=0; band<bandNum; band++)
+	{
+		if(sphere && band == equatorBand)
+		{
+			continue;
+		}
+		for(int i=0; i<DEBUGDRAW_SHELLDIV; i++)
+		{
+			int next = (i + 1) % DEBUGDRAW_SHELLDIV;
+			VECTOR d[4] = { direction[band][i], direction[band][next], direction[band + 1][i], direction[band + 1][next] };
+			VECTOR c[4] = { center[band], center[band], center[band + 1], center[band + 1] };
+			for(int t=0; t<2; t++)
+			{
+				// 極の列は全て同じ点なので、潰れる方の三角形は追加しない
+				if((band == 0 && t == 0) || (band == bandNum - 1 && t == 1))
+				{
+					continue;
+				}
+				VERTEX3D *vertex = &debugDraw->triangle[debugDraw->triangleNum * 3];
+				for(int k=0; k<3; k++)
+				{
+					int n = order[t][k];
+					DebugDraw_SetVertex(&vertex[k], VAdd(c[n], VScale(d[n], r)), d[n], color);
+				}
+				debugDraw->triangleNum++;
+			}
+		}
+	}
+}
+
+/**
+* @fn DebugDraw_AddSphere
+* @brief 球を追加する
+* @param[in] DEBUGDRAW *debugDraw, VECTOR centerPos, float r, COLOR_U8 color, bool fillFlag false:線で組んだ形
+*/
+void DebugDraw_AddSphere(DEBUGDRAW *debugDraw, VECTOR centerPos, float r, COLOR_U8 color, bool fillFlag)
+{
+	DebugDraw_AddShell(debugDraw, centerPos, centerPos, r, color, fillFlag);
+}
+
+/**
+* @fn DebugDraw_AddCapsule
+* @brief カプセルを追加する
+* @param[in] DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2 両端の球の中心, float r, COLOR_U8 color, bool fillFlag false:線で組んだ形
+*/
+void DebugDraw_AddCapsule(DEBUGDRAW *debugDraw, VECTOR pos1, VECTOR pos2, float r, COLOR_U8 color, bool fillFlag)
+{
+	DebugDraw_AddShell(debugDraw, pos1, pos2, r, color, fillFlag);
+}
+
+/**
+* @fn DebugDraw_BeginStatic
+* @brief ここから DebugDraw_EndStatic までに追加した図形を変わらない図形として覚える
+* @param[in] DEBUGDRAW *debugDraw
+* @details それまでにためていた図形は先に描画しておく
+*/
+void DebugDraw_BeginStatic(DEBUGDRAW *debugDraw)
+{
+	DebugDraw_FlushDynamic(debugDraw);
+	debugDraw->isStatic = true;
+}
+
+/**
+* @fn DebugDraw_EndStatic
+* @brief 追加した図形を頂点バッファに入れる
+* @param[in] DEBUGDRAW *debugDraw
+* @details 前に覚えた図形は捨てて、今回追加した図形に置き換える
+*/
+void DebugDraw_EndStatic(DEBUGDRAW *debugDraw)
+{
+	if(debugDraw->staticLineBuffer != -1)
+	{
+		DeleteVertexBuffer(debugDraw->staticLineBuffer);
+		debugDraw->staticLineBuffer = -1;
+	}
+	if(debugDraw->staticTriangleBuffer != -1)
+	{
+		DeleteVertexBuffer(debugDraw->staticTriangleBuffer);
+		debugDraw->staticTriangleBuffer = -1;
+	}
+
+	debugDraw->staticLineNum = debugDraw->lineNum;
+	if(debugDraw->lineNum > 0)
+	{
+		debugDraw->staticLineBuffer = CreateVertexBuffer(debugDraw->lineNum * 2, DX_VERTEX_TYPE_NORMAL_3D);
+		SetVertexBufferData(0, debugDraw->line, debugDraw->lineNum * 2, debugDraw->staticLineBuffer);
+	}
+	debugDraw->staticTriangleNum = debugDraw->triangleNum;
+	if(debugDraw->triangleNum > 0)
+	{
+		debugDraw->staticTriangleBuffer = CreateVertexBuffer(debugDraw->triangleNum * 3, DX_VERTEX_TYPE_NORMAL_3D);
+		SetVertexBufferData(0, debugDraw->triangle, debugDraw->triangleNum * 3, debugDraw->staticTriangleBuffer);
+	}
+
+	debugDraw->lineNum = 0;
+	debugDraw->triangleNum = 0;
+	debugDraw->isStatic = false;
+}
+
+/**
+* @fn DebugDraw_Flush
+* @brief 変わらない図形とためている図形を描画して、ためている図形を空にする
+* @param[in] DEBUGDRAW *debugDraw
+* @details 毎フレームの最後に１回呼ぶ( 描画の呼び出しは変わらない図形と、ためている図形の種類ごとに１回ずつ )
+*/
+void DebugDraw_Flush(DEBUGDRAW *debugDraw)
+{
+	// 呼び出し側の描画の設定を覚えておき、描画後に戻す
+	int blendMode;
+	int blendParam;
+	GetDrawBlendMode(&blendMode, &blendParam);
+	int useLighting = GetUseLighting();
+	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
+	if(debugDraw->staticLineNum > 0)
+	{
+		SetUseLighting(false);
+		DrawPrimitive3D_UseVertexBuffer(debugDraw->staticLineBuffer, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPHIC, true);
+		debugDraw->drawCallNum++;
+		debugDraw->drawLineNum += debugDraw->staticLineNum;
+	}
+	if(debugDraw->staticTriangleNum > 0)
+	{
+		SetUseLighting(true);
+		DrawPrimitive3D_UseVertexBuffer(debugDraw->staticTriangleBuffer, DX_PRIMTYPE_TRIANGLELIST, DX_NONE_GRAPHIC, true);
+		debugDraw->drawCallNum++;
+		debugDraw->drawTriangleNum += debugDraw->staticTriangleNum;
+	}
+	SetUseLighting(useLighting);
+	SetDrawBlendMode(blendMode, blendParam);
+
+	DebugDraw_FlushDynamic(debugDraw);
+
+	// このフレームの数を覚えて、次のフレームの数を数え直す
+	debugDraw->lastDrawCallNum = debugDraw->drawCallNum;
+	debugDraw->lastDrawLineNum = debugDraw->drawLineNum;
+	debugDraw->lastDrawTriangleNum = debugDraw->drawTriangleNum;
+	debugDraw->drawCallNum = 0;
+	debugDraw->drawLineNum = 0;
+	debugDraw->drawTriangleNum = 0;
+}
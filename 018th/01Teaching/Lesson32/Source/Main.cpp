@@ -1,4 +1,5 @@
 ﻿#include "DxLib.h"
+#include "DebugDraw.h"
 #include <math.h>
 /**
 * @file
@@ -13,6 +14,8 @@
 const float	CAMERA_ANGLE_SPEED = 3.0f;	//!< カメラの回転速度
 const float	LINE_AREA_SIZE = 10000.0f;	//!< ラインを描く範囲
 const int	LINE_NUM = 50;				//!< ラインの数
+const int	DEBUGDRAW_LINEMAX = LINE_NUM * 2 + 1;	//!< 確認用の図形としてためられる線の最大数( 地面のライン )
+const int	DEBUGDRAW_TRIANGLEMAX = 1;			//!< 確認用の図形としてためられる三角形の最大数
 
 /**
 * @fn WinMain
@@ -32,6 +35,38 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return -1;
 	}
 
+	// 位置関係が分かるように地面に描くラインは変わらないので、確認用の図形の頂点バッファに入れておく
+	DEBUGDRAW debugDraw;
+	if(!DebugDraw_Initialize(&debugDraw, DEBUGDRAW_LINEMAX, DEBUGDRAW_TRIANGLEMAX))
+	{
+		DxLib_End();
+		return -1;
+	}
+	DebugDraw_BeginStatic(&debugDraw);
+	{
+		VECTOR pos1;
+		VECTOR pos2;
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<=LINE_NUM; i++)
+		{
+			DebugDraw_AddLine(&debugDraw, pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.x += LINE_AREA_SIZE / LINE_NUM;
+			pos2.x += LINE_AREA_SIZE / LINE_NUM;
+		}
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<LINE_NUM; i++)
+		{
+			DebugDraw_AddLine(&debugDraw, pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.z += LINE_AREA_SIZE / LINE_NUM;
+			pos2.z += LINE_AREA_SIZE / LINE_NUM;
+		}
+	}
+	DebugDraw_EndStatic(&debugDraw);
+
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
 
@@ -137,33 +172,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
 		}
 
-		// 位置関係が分かるように地面にラインを描画する
-		{
-			VECTOR pos1;
-			VECTOR pos2;
-
-			SetUseZBufferFlag(true);
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<=LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.x += LINE_AREA_SIZE / LINE_NUM;
-				pos2.x += LINE_AREA_SIZE / LINE_NUM;
-			}
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.z += LINE_AREA_SIZE / LINE_NUM;
-				pos2.z += LINE_AREA_SIZE / LINE_NUM;
-			}
-
-			SetUseZBufferFlag(false);
-		}
+		// 位置関係が分かるように地面にラインを描画する( 頂点バッファに入れておいたものを１回で描画する )
+		SetUseZBufferFlag(true);
+		DebugDraw_Flush(&debugDraw);
+		SetUseZBufferFlag(false);
 
 		// X軸とY軸の回転から回転行列を作成
 
@@ -190,6 +202,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 	}
 
+	// 確認用の図形の後始末
+	DebugDraw_Terminate(&debugDraw);
+
 	// DXライブラリの後始末
 	DxLib_End();
 
@@ -0,0 +1,485 @@
+﻿#include "Jps.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson33
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details 格子状の迷路の経路探索( ４方向の JPS+ )
+*          ４方向にしか移動しない場合、向きを変えられるのは進む向きの左右に道があるマスだけなので、そこを分岐点とする
+*          各マスから各方向の次の分岐点までの距離を事前に求めておき、A* では分岐点から分岐点へ一気に飛ぶ
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const int JPS_MOVEX[JPS_DIRNUM] = { 1, 0, -1, 0 };	//!< 向きごとのＸ方向の移動量( East, South, West, North )
+const int JPS_MOVEZ[JPS_DIRNUM] = { 0, -1, 0, 1 };	//!< 向きごとのＺ方向の移動量
+
+/**
+* @fn Jps_IsWallLocal
+* @brief 迷路の範囲内の座標で壁かどうかを調べる
+* @param[in] const JPSMAP *map, int x, int z 迷路の範囲内の座標
+* @return bool true:壁か範囲の外  false:道
+*/
+static bool Jps_IsWallLocal(const JPSMAP *map, int x, int z)
+{
+	if(x < 0 || z < 0 || x >= map->width || z >= map->height)
+	{
+		return true;
+	}
+	int i = z * map->width + x;
+	return (map->wall[i >> 3] & (1 << (i & 7))) != 0;
+}
+
+/**
+* @fn Jps_IsJumpPoint
+* @brief 指定の向きに進んでいる時に、指定のマスが分岐点かどうか
+* @param[in] const JPSMAP *map, int x, int z, int dir
+* @return bool true:左右のどちらかに道がある  false:左右とも壁
+*/
+static bool Jps_IsJumpPoint(const JPSMAP *map, int x, int z, int dir)
+{
+	int left = (dir + 1) % JPS_DIRNUM;
+	int right = (dir + 3) % JPS_DIRNUM;
+	return !Jps_IsWallLocal(map, x + JPS_MOVEX[left], z + JPS_MOVEZ[left]) ||
+		!Jps_IsWallLocal(map, x + JPS_MOVEX[right], z + JPS_MOVEZ[right]);
+}
+
+/**
+* @fn Jps_HeapPush
+* @brief 未調査のマスを二分ヒープに追加する
+* @param[in] JPSMAP *map, int cell, int score 推定コスト
+*/
+static void Jps_HeapPush(JPSMAP *map, int cell, int score)
+{
+	if(map->heapNum >= map->heapMax)
+	{
+		map->heapMax = map->heapMax > 0 ? map->heapMax * 2 : 1024;
+		map->heapCell = (int *)realloc(map->heapCell, sizeof(int) * map->heapMax);
+		map->heapScore = (int *)realloc(map->heapScore, sizeof(int) * map->heapMax);
+	}
+
+	// 親より推定コストが小さい間は上に移動する
+	int i = map->heapNum++;
+	while(i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if(map->heapScore[parent] <= score)
+		{
+			break;
+		}
+		map->heapCell[i] = map->heapCell[parent];
+		map->heapScore[i] = map->heapScore[parent];
+		i = parent;
+	}
+	map->heapCell[i] = cell;
+	map->heapScore[i] = score;
+}
+
+/**
+* @fn Jps_HeapPop
+* @brief 推定コストが最も小さいマスを二分ヒープから取り出す
+* @param[in] JPSMAP *map
+* @param[out] int *score 推定コスト
+* @return int マスの番号
+*/
+static int Jps_HeapPop(JPSMAP *map, int *score)
+{
+	int cell = map->heapCell[0];
+	*score = map->heapScore[0];
+	map->heapNum--;
+	int lastCell = map->heapCell[map->heapNum];
+	int lastScore = map->heapScore[map->heapNum];
+
+	// 最後の要素を根から下に移動する
+	int i = 0;
+	for(;;)
+	{
+		int child = i * 2 + 1;
+		if(child >= map->heapNum)
+		{
+			break;
+		}
+		if(child + 1 < map->heapNum && map->heapScore[child + 1] < map->heapScore[child])
+		{
+			child++;
+		}
+		if(lastScore <= map->heapScore[child])
+		{
+			break;
+		}
+		map->heapCell[i] = map->heapCell[child];
+		map->heapScore[i] = map->heapScore[child];
+		i = child;
+	}
+	map->heapCell[i] = lastCell;
+	map->heapScore[i] = lastScore;
+	return cell;
+}
+
+/**
+* @fn Jps_Search
+* @brief 迷路の範囲内の座標で A* を行い、分岐点のつながりを parent に残す
+* @param[in] JPSMAP *map, int startX, int startZ, int goalX, int goalZ
+* @return int ゴールのマスの番号( たどり着けない場合は -1 )
+* @details 入ってきた向きと逆には戻らない、ゴールが進む向きの直線上にあれば分岐点でなくてもそこで止まる
+*/
+static int Jps_Search(JPSMAP *map, int startX, int startZ, int goalX, int goalZ)
+{
+	map->expandNum = 0;
+	if(Jps_IsWallLocal(map, startX, startZ) || Jps_IsWallLocal(map, goalX, goalZ))
+	{
+		return -1;
+	}
+
+	// 探索の番号を進めて、前回の探索の情報を使わないようにする
+	map->searchId++;
+	if(map->searchId == 0)
+	{
+		memset(map->visit, 0, sizeof(unsigned int) * map->width * map->height);
+		map->searchId = 1;
+	}
+
+	int start = startZ * map->width + startX;
+	int goal = goalZ * map->width + goalX;
+	map->heapNum = 0;
+	map->visit[start] = map->searchId;
+	map->cost[start] = 0;
+	map->parent[start] = -1;
+	map->arriveDir[start] = JPS_DIRNUM;
+	Jps_HeapPush(map, start, abs(goalX - startX) + abs(goalZ - startZ));
+
+	while(map->heapNum > 0)
+	{
+		int score;
+		int cell = Jps_HeapPop(map, &score);
+		int x = cell % map->width;
+		int z = cell / map->width;
+
+		// 後からコストの小さい経路が見つかった古い要素は飛ばす
+		if(score != map->cost[cell] + abs(goalX - x) + abs(goalZ - z))
+		{
+			continue;
+		}
+		map->expandNum++;
+		if(cell == goal)
+		{
+			return goal;
+		}
+
+		for(int dir=0; dir<JPS_DIRNUM; dir++)
+		{
+			// 来た方向には戻らない
+			if(map->arriveDir[cell] != JPS_DIRNUM && dir == (map->arriveDir[cell] + 2) % JPS_DIRNUM)
+			{
+				continue;
+			}
+
+			int jump = map->jump[cell * JPS_DIRNUM + dir];
+			int reach = jump > 0 ? jump : -jump;
+
+			// ゴールがこの向きの直線上で、分岐点か壁より手前にあるか
+			int goalDistance = 0;
+			if(JPS_MOVEX[dir] != 0 && goalZ == z)
+			{
+				goalDistance = (goalX - x) * JPS_MOVEX[dir];
+			}
+			else if(JPS_MOVEZ[dir] != 0 && goalX == x)
+			{
+				goalDistance = (goalZ - z) * JPS_MOVEZ[dir];
+			}
+
+			int step;
+			if(goalDistance > 0 && goalDistance <= reach)
+			{
+				step = goalDistance;
+			}
+			else if(jump > 0)
+			{
+				step = jump;
+			}
+			else
+			{
+				continue;
+			}
+
+			int nextX = x + JPS_MOVEX[dir] * step;
+			int nextZ = z + JPS_MOVEZ[dir] * step;
+			int next = nextZ * map->width + nextX;
+			int cost = map->cost[cell] + step;
+			if(map->visit[next] != map->searchId || cost < map->cost[next])
+			{
+				map->visit[next] = map->searchId;
+				map->cost[next] = cost;
+				map->parent[next] = cell;
+				map->arriveDir[next] = (BYTE)dir;
+				Jps_HeapPush(map, next, cost + abs(goalX - nextX) + abs(goalZ - nextZ));
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+* @fn Jps_Initialize
+* @brief 指定の大きさの迷路用の情報を確保する
+* @param[out] JPSMAP *map
+* @param[in] int width, int height
+* @return bool true:成功  false:失敗
+*/
+bool Jps_Initialize(JPSMAP *map, int width, int height)
+{
+	int cellNum = width * height;
+	memset(map, 0, sizeof(JPSMAP));
+	map->width = width;
+	map->height = height;
+	map->wall = (BYTE *)malloc((cellNum + 7) / 8);
+	map->jump = (short *)malloc(sizeof(short) * cellNum * JPS_DIRNUM);
+	map->cost = (int *)malloc(sizeof(int) * cellNum);
+	map->parent = (int *)malloc(sizeof(int) * cellNum);
+	map->visit = (unsigned int *)malloc(sizeof(unsigned int) * cellNum);
+	map->arriveDir = (BYTE *)malloc(cellNum);
+	if(map->wall == NULL || map->jump == NULL || map->cost == NULL || map->parent == NULL || map->visit == NULL || map->arriveDir == NULL)
+	{
+		Jps_Terminate(map);
+		return false;
+	}
+
+	// 構築するまでは全て壁にしておく
+	memset(map->wall, 0xFF, (cellNum + 7) / 8);
+	memset(map->jump, 0, sizeof(short) * cellNum * JPS_DIRNUM);
+	memset(map->visit, 0, sizeof(unsigned int) * cellNum);
+	return true;
+}
+
+/**
+* @fn Jps_Terminate
+* @brief 迷路用の情報の後始末
+* @param[in] JPSMAP *map
+*/
+void Jps_Terminate(JPSMAP *map)
+{
+	free(map->wall);
+	free(map->jump);
+	free(map->cost);
+	free(map->parent);
+	free(map->visit);
+	free(map->arriveDir);
+	free(map->heapCell);
+	free(map->heapScore);
+	memset(map, 0, sizeof(JPSMAP));
+}
+
+/**
+* @fn Jps_Build
+* @brief 指定の位置のマスの値から壁と分岐点までの距離を求める
+* @param[in] JPSMAP *map, int originX, int originZ 左下のマスの世界での座標, JPS_GETCELL getCell
+* @details 進む向きの先から順に調べると、１つ先のマスの距離に１を足すだけで求まる
+*/
+void Jps_Build(JPSMAP *map, int originX, int originZ, JPS_GETCELL getCell)
+{
+	map->originX = originX;
+	map->originZ = originZ;
+	map->serial++;
+
+	// 壁を１マス１ビットに詰める
+	memset(map->wall, 0, (map->width * map->height + 7) / 8);
+	for(int z=0; z<map->height; z++)
+	{
+		for(int x=0; x<map->width; x++)
+		{
+			if(getCell(originX + x, originZ + z) == 0)
+			{
+				int i = z * map->width + x;
+				map->wall[i >> 3] |= (BYTE)(1 << (i & 7));
+			}
+		}
+	}
+
+	for(int dir=0; dir<JPS_DIRNUM; dir++)
+	{
+		// 進む向きの先にあるマスから順に調べる
+		for(int n=0; n<map->height; n++)
+		{
+			int z = JPS_MOVEZ[dir] > 0 ? map->height - 1 - n : n;
+			for(int m=0; m<map->width; m++)
+			{
+				int x = JPS_MOVEX[dir] > 0 ? map->width - 1 - m : m;
+				short *jump = &map->jump[(z * map->width + x) * JPS_DIRNUM + dir];
+				int nextX = x + JPS_MOVEX[dir];
+				int nextZ = z + JPS_MOVEZ[dir];
+				if(Jps_IsWallLocal(map, x, z) || Jps_IsWallLocal(map, nextX, nextZ))
+				{
+					*jump = 0;
+				}
+				else if(Jps_IsJumpPoint(map, nextX, nextZ, dir))
+				{
+					*jump = 1;
+				}
+				else
+				{
+					short nextJump = map->jump[(nextZ * map->width + nextX) * JPS_DIRNUM + dir];
+					*jump = nextJump > 0 ? nextJump + 1 : nextJump - 1;
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn Jps_IsWall
+* @brief 指定のマスが壁か範囲の外かどうか
+* @param[in] const JPSMAP *map, int x, int z 世界での座標
+* @return bool true:壁か範囲の外  false:道
+*/
+bool Jps_IsWall(const JPSMAP *map, int x, int z)
+{
+	return Jps_IsWallLocal(map, x - map->originX, z - map->originZ);
+}
+
+/**
+* @fn Jps_FindPath
+* @brief 経路を探索する
+* @param[in] JPSMAP *map, int startX, int startZ, int goalX, int goalZ 世界での座標
+* @param[out] int *pathX, int *pathZ 経路の分岐点の世界での座標( スタートからゴールの順 )
+* @param[in] int pathMax pathX, pathZ の大きさ
+* @return int 経路の分岐点の数( スタートとゴールを含む、pathMax より多い場合は先頭から pathMax 個だけ格納する、たどり着けない場合は -1 )
+* @details 分岐点の間は直線なので、マスごとの経路は分岐点の間を埋めれば求まる
+*/
+int Jps_FindPath(JPSMAP *map, int startX, int startZ, int goalX, int goalZ, int *pathX, int *pathZ, int pathMax)
+{
+	int goal = Jps_Search(map, startX - map->originX, startZ - map->originZ, goalX - map->originX, goalZ - map->originZ);
+	if(goal < 0)
+	{
+		return -1;
+	}
+
+	// ゴールからたどって数を数え、後ろから格納する
+	int num = 0;
+	for(int cell=goal; cell>=0; cell=map->parent[cell])
+	{
+		num++;
+	}
+	int i = num;
+	for(int cell=goal; cell>=0; cell=map->parent[cell])
+	{
+		i--;
+		if(i < pathMax)
+		{
+			pathX[i] = cell % map->width + map->originX;
+			pathZ[i] = cell / map->width + map->originZ;
+		}
+	}
+	return num;
+}
+
+/**
+* @fn Jps_InitializeCache
+* @brief 経路の記録の入れ物を確保する
+* @param[out] JPSPATHCACHE *cache
+* @param[in] const JPSMAP *map 大きさを合わせる迷路
+* @return bool true:成功  false:失敗
+*/
+bool Jps_InitializeCache(JPSPATHCACHE *cache, const JPSMAP *map)
+{
+	memset(cache, 0, sizeof(JPSPATHCACHE));
+	for(int i=0; i<JPS_CACHENUM; i++)
+	{
+		cache->serial[i] = -1;
+		cache->step[i] = (BYTE *)malloc(map->width * map->height);
+		if(cache->step[i] == NULL)
+		{
+			Jps_TerminateCache(cache);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @fn Jps_TerminateCache
+* @brief 経路の記録の入れ物の後始末
+* @param[in] JPSPATHCACHE *cache
+*/
+void Jps_TerminateCache(JPSPATHCACHE *cache)
+{
+	for(int i=0; i<JPS_CACHENUM; i++)
+	{
+		free(cache->step[i]);
+		cache->step[i] = NULL;
+		cache->serial[i] = -1;
+	}
+}
+
+/**
+* @fn Jps_GetStep
+* @brief 指定のマスから目的地へ向かう時に次に進む向きを取得する
+* @param[in] JPSMAP *map, JPSPATHCACHE *cache, int x, int z, int targetX, int targetZ 世界での座標
+* @return int 向き( Direction、目的地にいるかたどり着けない場合は -1 )
+* @details 探索した経路の全てのマスに次に進む向きを記録するので、同じ目的地へ向かう他のモンスターが
+*          その経路の上にいる場合は探索しない。最短経路の途中から先も最短経路なので、記録が混ざっても回り続けることはない
+*/
+int Jps_GetStep(JPSMAP *map, JPSPATHCACHE *cache, int x, int z, int targetX, int targetZ)
+{
+	if((x == targetX && z == targetZ) || Jps_IsWall(map, x, z) || Jps_IsWall(map, targetX, targetZ))
+	{
+		return -1;
+	}
+	cache->useCount++;
+
+	// 同じ目的地の記録を探す、無ければ最も長く使っていない記録を使い回す
+	int entry = -1;
+	for(int i=0; i<JPS_CACHENUM; i++)
+	{
+		if(cache->serial[i] == map->serial && cache->targetX[i] == targetX && cache->targetZ[i] == targetZ)
+		{
+			entry = i;
+			break;
+		}
+	}
+	if(entry < 0)
+	{
+		entry = 0;
+		for(int i=1; i<JPS_CACHENUM; i++)
+		{
+			if(cache->lastUse[i] < cache->lastUse[entry])
+			{
+				entry = i;
+			}
+		}
+		cache->targetX[entry] = targetX;
+		cache->targetZ[entry] = targetZ;
+		cache->serial[entry] = map->serial;
+		memset(cache->step[entry], JPS_STEP_NONE, map->width * map->height);
+	}
+	cache->lastUse[entry] = cache->useCount;
+
+	BYTE *step = cache->step[entry];
+	int cell = (z - map->originZ) * map->width + (x - map->originX);
+	if(step[cell] != JPS_STEP_NONE)
+	{
+		cache->hitNum++;
+		return step[cell] == JPS_STEP_UNREACHABLE ? -1 : step[cell] - 1;
+	}
+
+	cache->searchNum++;
+	int goal = Jps_Search(map, x - map->originX, z - map->originZ, targetX - map->originX, targetZ - map->originZ);
+	if(goal < 0)
+	{
+		step[cell] = JPS_STEP_UNREACHABLE;
+		return -1;
+	}
+
+	// 分岐点の間の全てのマスに、その区間を進む向きを記録する
+	for(int next=goal; map->parent[next]>=0; next=map->parent[next])
+	{
+		int dir = map->arriveDir[next];
+		for(int i=map->parent[next]; i!=next; i+=JPS_MOVEZ[dir] * map->width + JPS_MOVEX[dir])
+		{
+			step[i] = (BYTE)(dir + 1);
+		}
+	}
+	return step[cell] - 1;
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int JPS_DIRNUM = 4;						//!< 移動できる方向の数( Direction と同じ順番 )
+const int JPS_CACHENUM = 8;						//!< 経路を覚えておく目的地の数
+const int JPS_STEP_NONE = 0;					//!< 経路の記録 : まだ調べていない
+const int JPS_STEP_UNREACHABLE = 0xFF;			//!< 経路の記録 : 目的地にたどり着けない
+
+typedef int (*JPS_GETCELL)(int x, int z);		//!< マスの値を取得する関数( 0:壁  それ以外:道 )
+
+/**
+* @struct JPSMAP
+* @brief 格子状の迷路の経路探索( ４方向の JPS+ )に使う情報
+* @details 壁は１マス１ビットで持ち、道のマスごとに各方向の次の分岐点までの距離を事前に計算しておく
+*          jump の値が正なら分岐点までのマス数、０以下なら壁まで進めるマス数に－を付けたもの
+*/
+struct JPSMAP
+{
+	int originX;							//!< 左下のマスの世界でのＸ座標
+	int originZ;							//!< 左下のマスの世界でのＺ座標
+	int width;								//!< Ｘ方向のマスの数
+	int height;								//!< Ｚ方向のマスの数
+	BYTE *wall;								//!< 壁かどうか( １マス１ビット )
+	short *jump;							//!< 各マスの各方向の分岐点までの距離( マスの数×JPS_DIRNUM )
+	int serial;								//!< 構築し直した回数( 経路の記録が古くなったかどうかの判定に使う )
+	int *cost;								//!< 探索中の各マスのスタートからのコスト
+	int *parent;							//!< 探索中の各マスの１つ前の分岐点( -1:スタート )
+	unsigned int *visit;					//!< 各マスを最後に調べた探索の番号
+	BYTE *arriveDir;						//!< 探索中の各マスに入った時の向き
+	unsigned int searchId;					//!< 探索の番号
+	int *heapCell;							//!< 未調査のマスの二分ヒープ
+	int *heapScore;							//!< 未調査のマスの推定コスト
+	int heapNum;							//!< 二分ヒープの要素数
+	int heapMax;							//!< 二分ヒープの大きさ
+	int expandNum;							//!< 最後の探索で展開したマスの数
+};
+
+/**
+* @struct JPSPATHCACHE
+* @brief 目的地ごとに求めた経路を、各マスで次に進む向きとして覚えておく入れ物
+* @details 同じ目的地を目指すモンスターが既に求めた経路の上にいれば、探索せずに次に進む向きが分かる
+*/
+struct JPSPATHCACHE
+{
+	int targetX[JPS_CACHENUM];				//!< 目的地の世界でのＸ座標
+	int targetZ[JPS_CACHENUM];				//!< 目的地の世界でのＺ座標
+	int serial[JPS_CACHENUM];				//!< 記録した時の JPSMAP::serial( -1:未使用 )
+	int lastUse[JPS_CACHENUM];				//!< 最後に使った時の useCount
+	BYTE *step[JPS_CACHENUM];				//!< 各マスで次に進む向き＋１( JPS_STEP_NONE, JPS_STEP_UNREACHABLE )
+	int useCount;							//!< Jps_GetStep を呼んだ回数
+	int searchNum;							//!< 実際に探索した回数
+	int hitNum;								//!< 記録した経路を使い回した回数
+};
+
+bool Jps_Initialize(JPSMAP *map, int width, int height);	//!< 指定の大きさの迷路用の情報を確保する( 戻り値  true:成功  false:失敗 )
+void Jps_Terminate(JPSMAP *map);				//!< 迷路用の情報の後始末
+void Jps_Build(JPSMAP *map, int originX, int originZ, JPS_GETCELL getCell);	//!< 指定の位置のマスの値から壁と分岐点までの距離を求める
+bool Jps_IsWall(const JPSMAP *map, int x, int z);	//!< 指定のマスが壁か範囲の外かどうか
+int Jps_FindPath(JPSMAP *map, int startX, int startZ, int goalX, int goalZ, int *pathX, int *pathZ, int pathMax);	//!< 経路を探索する( 戻り値 : 経路の分岐点の数、たどり着けない場合は -1 )
+bool Jps_InitializeCache(JPSPATHCACHE *cache, const JPSMAP *map);	//!< 経路の記録の入れ物を確保する( 戻り値  true:成功  false:失敗 )
+void Jps_TerminateCache(JPSPATHCACHE *cache);	//!< 経路の記録の入れ物の後始末
+int Jps_GetStep(JPSMAP *map, JPSPATHCACHE *cache, int x, int z, int targetX, int targetZ);	//!< 指定のマスから目的地へ向かう時に次に進む向きを取得する( 戻り値 : 向き、進めない場合は -1 )
@@ -1,5 +1,11 @@
 ﻿#include "DxLib.h"
+#include <malloc.h>
 #include "CheckKey.h"
+#include "Pvs.h"
+#include "TileMap.h"
+#include "WallMesh.h"
+#include "Monster.h"
+#include "Jps.h"
 /**
 * @file
 * @brief Lesson33
@@ -11,30 +17,16 @@
 */
 
 const float BLOCK_SIZE = 1000.0f;	//!< ブロックのサイズ
-const int   BLOCK_NUM_X = 16;		//!< Ｘ方向のブロック数
-const int   BLOCK_NUM_Z = 16;		//!< Ｚ方向のブロック数
 const float CAMERA_Y = 500.0f;		//!< カメラの高さ
-const int   MONSTER_NUM = 10;		//!< モンスター出現数
-
-char map[BLOCK_NUM_Z][BLOCK_NUM_X] =
-{
-	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-	0,1,1,2,1,0,1,1,1,0,1,1,0,1,1,0,
-	0,0,0,1,0,0,1,0,1,0,0,1,0,0,1,0,
-	0,1,1,2,1,1,1,0,1,0,0,1,1,1,1,0,
-	0,1,0,1,0,0,0,0,1,0,0,1,0,0,0,0,
-	0,0,0,0,0,0,0,0,1,0,0,1,1,1,0,0,
-	0,0,0,1,1,1,1,1,1,0,0,0,0,1,1,0,
-	0,0,0,1,1,1,0,1,0,0,0,1,0,0,1,0,
-	0,1,1,1,1,1,0,1,1,1,1,1,1,1,1,0,
-	0,0,0,1,0,0,0,1,0,0,0,1,0,0,1,0,
-	0,0,0,1,1,1,1,1,0,0,0,1,0,0,1,0,
-	0,0,0,0,0,1,0,0,0,0,1,1,1,1,1,0,
-	0,1,1,1,0,1,0,0,0,0,1,0,1,0,1,0,
-	0,1,0,1,1,1,0,0,0,1,1,0,1,0,0,0,
-	0,1,0,1,0,0,0,1,1,1,0,0,1,1,1,0,
-	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-};	//!< マップ( 1:道  0:壁 )
+const int   MONSTER_NUM = 256;		//!< モンスター出現数
+const int   MONSTER_MOVEFRAME = 30;	//!< モンスターが１マス進むのにかかるフレーム数
+const int   MONSTER_KEEPDISTANCE = 64;	//!< これより離れたモンスターは消滅させて空きに戻す
+const unsigned int MAZE_SEED = 20230103;	//!< 迷路を生成する種
+const int   VIEW_DEPTH = 16;		//!< 何マス先まで描画するか
+const int   VIEW_CELLMAX = 1024;	//!< 一度に描画するマスの最大数
+const int   CHASE_CHUNKRADIUS = 1;	//!< モンスターの経路探索に使う、今いるチャンクの周りのチャンク数
+const int   JPSBENCH_SIZE[2] = { 256, 1024 };	//!< -jpsbench で経路探索の速さを測る迷路の大きさ
+const int   JPSBENCH_TIME = 1000000;	//!< -jpsbench で１つの大きさの迷路を測る時間( マイクロ秒 )
 
 /**
 * @enum Direction
@@ -48,6 +40,90 @@ enum Direction
 	North,		//!< z軸プラス方向
 };
 
+static const BYTE *jpsBenchMap;		//!< -jpsbench で使う迷路
+static int jpsBenchSize;			//!< -jpsbench で使う迷路の大きさ
+
+/**
+* @fn GetJpsBenchCell
+* @brief -jpsbench で使う迷路のマスの値を取得する
+* @param[in] int x, int z
+* @return int 0:壁  1:道
+*/
+int GetJpsBenchCell(int x, int z)
+{
+	if(x < 0 || z < 0 || x >= jpsBenchSize || z >= jpsBenchSize)
+	{
+		return 0;
+	}
+	return jpsBenchMap[z * jpsBenchSize + x] != 0 ? 1 : 0;
+}
+
+/**
+* @fn RunJpsBenchmark
+* @brief 迷路の大きさごとに経路探索の速さを測ってログに書き出す
+* @return bool true:成功  false:失敗
+* @details ランダムに選んだ道のマス同士の経路を決められた時間だけ探索し続けて、１秒あたりの探索回数を求める
+*/
+bool RunJpsBenchmark()
+{
+	for(int i=0; i<2; i++)
+	{
+		int size = JPSBENCH_SIZE[i];
+		BYTE *map = (BYTE *)malloc(size * size);
+		if(map == NULL)
+		{
+			return false;
+		}
+		TileMap_GenerateArea(MAZE_SEED, 0, 0, size, size, map);
+		jpsBenchMap = map;
+		jpsBenchSize = size;
+
+		JPSMAP jps;
+		if(!Jps_Initialize(&jps, size, size))
+		{
+			free(map);
+			return false;
+		}
+		LONGLONG buildStart = GetNowHiPerformanceCount();
+		Jps_Build(&jps, 0, 0, GetJpsBenchCell);
+		LONGLONG buildTime = GetNowHiPerformanceCount() - buildStart;
+
+		// 道のマス同士の経路をひたすら探索する
+		SRand(size);
+		int queryNum = 0;
+		int foundNum = 0;
+		LONGLONG expandTotal = 0;
+		LONGLONG queryStart = GetNowHiPerformanceCount();
+		LONGLONG queryTime = 0;
+		while(queryTime < JPSBENCH_TIME)
+		{
+			int startX = GetRand(size - 1);
+			int startZ = GetRand(size - 1);
+			int goalX = GetRand(size - 1);
+			int goalZ = GetRand(size - 1);
+			if(map[startZ * size + startX] == 0 || map[goalZ * size + goalX] == 0)
+			{
+				continue;
+			}
+			if(Jps_FindPath(&jps, startX, startZ, goalX, goalZ, NULL, NULL, 0) >= 0)
+			{
+				foundNum++;
+			}
+			expandTotal += jps.expandNum;
+			queryNum++;
+			queryTime = GetNowHiPerformanceCount() - queryStart;
+		}
+
+		ErrorLogFmtAdd("jpsbench: %dx%d  build %lldus  query %d found %d  %d query/s  expand %d/query",
+			size, size, buildTime, queryNum, foundNum,
+			(int)(queryNum * 1000000LL / queryTime), (int)(expandTotal / (queryNum > 0 ? queryNum : 1)));
+
+		Jps_Terminate(&jps);
+		free(map);
+	}
+	return true;
+}
+
 /**
 * @fn WinMain
 * @brief Main関数
@@ -57,10 +133,16 @@ enum Direction
 */
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
-	int frameNo;		// フレーム番号
 	VECTOR camPos;		// カメラの座標
 	VECTOR camTarg;	// カメラの注視点
 
+	// -jpsbench を指定して起動した場合は、ウインドウを表示せずに経路探索の速さを測るだけにする
+	bool jpsBench = strstr(lpCmdLine, "-jpsbench") != NULL;
+	if(jpsBench)
+	{
+		SetWindowVisibleFlag(false);
+	}
+
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
@@ -70,6 +152,13 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return -1;
 	}
 
+	if(jpsBench)
+	{
+		bool result = RunJpsBenchmark();
+		DxLib_End();
+		return result ? 0 : -1;
+	}
+
 	// 壁モデルの読みこみ
 	int kabeModel = MV1LoadModel("Resource/Kabe.mqo");
 
@@ -77,23 +166,101 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	int monsterModel = MV1LoadModel("Resource/Goblin.x");
 	MV1SetScale(monsterModel, VGet(6.0f, 6.0f, 6.0f));		// ゴブリンのモデルサイズがマップに対して小さいので拡大する
 
-	// モンスターの出現情報配列を初期化
-	VECTOR* monsterData[MONSTER_NUM];
-	for(int i=0; i<MONSTER_NUM; i++)
+	// 迷路のチャンクの読み込みを開始する
+	if(!TileMap_Initialize(MAZE_SEED))
+	{
+		DxLib_End();
+		return -1;
+	}
+
+	// 壁モデルの各フレームのポリゴンを取り出しておく
+	if(!WallMesh_Initialize(kabeModel, BLOCK_SIZE))
+	{
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
+	}
+
+	// 見えるマスの一覧と、それを求める為の作業用の情報
+	static int visibleX[VIEW_CELLMAX];
+	static int visibleZ[VIEW_CELLMAX];
+	PVSWORK pvsWork;
+	if(!Pvs_Initialize(&pvsWork, PVS_VIEWSLOPE, VIEW_DEPTH))
+	{
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
+	}
+
+	// 今いるチャンクの全マス全方向の見えるマスの一覧( 奥行きはチャンクの大きさより短いので、周りのチャンクが読み込まれていれば作れる )
+	PVS pvs;
+	if(!Pvs_InitializeTable(&pvs, TILEMAP_CHUNKSIZE, TILEMAP_CHUNKSIZE))
+	{
+		Pvs_TerminateTable(&pvs);
+		Pvs_Terminate(&pvsWork);
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
+	}
+	SetCameraNearFar(10.0f, VIEW_DEPTH * BLOCK_SIZE);
+
+	// モンスターの入れ物を初期化
+	MONSTERPOOL monsterPool;
+	if(!Monster_Initialize(&monsterPool, MONSTER_NUM))
 	{
-		monsterData[i] = NULL;
+		Pvs_TerminateTable(&pvs);
+		Pvs_Terminate(&pvsWork);
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
 	}
 
-	// 位置と向きと入力状態の初期化
-	int posX = 1;
-	int posZ = 1;
+	// モンスターの経路探索用に、今いるチャンクとその周りのチャンクの迷路を覚えておく入れ物
+	int chaseSize = (CHASE_CHUNKRADIUS * 2 + 1) * TILEMAP_CHUNKSIZE;
+	JPSMAP jps;
+	JPSPATHCACHE jpsCache;
+	if(!Jps_Initialize(&jps, chaseSize, chaseSize))
+	{
+		Monster_Terminate(&monsterPool);
+		Pvs_TerminateTable(&pvs);
+		Pvs_Terminate(&pvsWork);
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
+	}
+	if(!Jps_InitializeCache(&jpsCache, &jps))
+	{
+		Jps_Terminate(&jps);
+		Monster_Terminate(&monsterPool);
+		Pvs_TerminateTable(&pvs);
+		Pvs_Terminate(&pvsWork);
+		WallMesh_Terminate();
+		TileMap_Terminate();
+		DxLib_End();
+		return -1;
+	}
+	int jpsChunkX = -1;		// 経路探索用の迷路を作った時にいたチャンク
+	int jpsChunkZ = -1;
+	int jpsLoadedMask = 0;	// 経路探索用の迷路を作った時に読み込み済みだったチャンク
+	int moveFrame = 0;
+
+	// 位置と向きと入力状態の初期化( 世界の真ん中の部屋から始める )
+	int posX = TileMap_GetWorldSize() / 2 + 1;
+	int posZ = TileMap_GetWorldSize() / 2 + 1;
 	int dir = Direction::East;
 
+	// 最初のチャンクは読み込みが終わるまで待つ
+	TileMap_Update(posX, posZ);
+	TileMap_WaitLoaded(posX, posZ);
+
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
 
-	bool monsterSpawn = false;
-
 	// メインループ
 	// エスケープキーが押されるまでループ
 	while(ProcessMessage() == 0 && CheckHitKey(KEY_INPUT_ESCAPE) == 0)
@@ -104,6 +271,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		// 画面をクリアする
 		ClearDrawScreen();
 
+		// 周りのチャンクの読み込みを依頼する
+		TileMap_Update(posX, posZ);
+
 		// 移動量
 		int moveX = 0;
 		int moveZ = 0;
@@ -160,7 +330,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		if(moveX != 0 || moveZ != 0)
 		{
 			// 移動先のマスが道だったら移動する
-			if(map[posZ + moveZ][posX + moveX] >= 1)
+			if(TileMap_GetCell(posX + moveX, posZ + moveZ) >= 1)
 			{
 				posX += moveX;
 				posZ += moveZ;
@@ -168,50 +338,76 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 
 		// スイッチマップに到達したら眼前にモンスターを出現させる
-		if(map[posZ][posX] == 2)
+		if(TileMap_GetCell(posX, posZ) == 2)
+		{
+			// 向いている方向にずらす
+			int spawnX = posX;
+			int spawnZ = posZ;
+			switch(dir)
+			{
+			case Direction::East: // Ｘ軸プラス方向
+				spawnX += 1;
+				break;
+
+			case Direction::South: // Ｚ軸マイナス方向
+				spawnZ -= 1;
+				break;
+
+			case Direction::West: // Ｘ軸マイナス方向
+				spawnX -= 1;
+				break;
+
+			case Direction::North: // Ｚ軸プラス方向
+				spawnZ += 1;
+				break;
+			}
+
+			// 空きリストから取り出して出現させる、一度出現したらもう出現しない
+			if(Monster_Spawn(&monsterPool, spawnX, spawnZ, dir) >= 0)
+			{
+				TileMap_SetCell(posX, posZ, 1);
+			}
+		}
+
+		// 遠くに置いてきたモンスターは空きに戻す
+		Monster_DespawnFar(&monsterPool, posX, posZ, MONSTER_KEEPDISTANCE);
+
+		// 今いるチャンクが変わったか周りのチャンクの読み込みが終わったら、経路探索用の迷路を作り直す
+		int chunkX = posX / TILEMAP_CHUNKSIZE;
+		int chunkZ = posZ / TILEMAP_CHUNKSIZE;
+		int loadedMask = 0;
+		for(int z=-CHASE_CHUNKRADIUS, bit=0; z<=CHASE_CHUNKRADIUS; z++)
 		{
-			for(int i=0; i<MONSTER_NUM; i++)
+			for(int x=-CHASE_CHUNKRADIUS; x<=CHASE_CHUNKRADIUS; x++, bit++)
 			{
-				// 配列の空いている箇所を探して出現させる
-				if(monsterData[i] == NULL)
+				if(TileMap_IsLoaded((chunkX + x) * TILEMAP_CHUNKSIZE, (chunkZ + z) * TILEMAP_CHUNKSIZE))
 				{
-					// 一旦自分と同じ場所に指定
-					monsterData[i] = new VECTOR;
-					monsterData[i]->x = (float)posX;
-					monsterData[i]->z = (float)posZ;
-
-					// 向いている方向にずらす
-					switch(dir)
-					{
-					case Direction::East: // Ｘ軸プラス方向
-						monsterData[i]->x += 1;
-						monsterData[i]->y = 90.0f * DX_PI_F / 180;	// 座標として使われない変数yにモデルの回転量を入れておく
-						break;
-
-					case Direction::South: // Ｚ軸マイナス方向
-						monsterData[i]->z -= 1;
-						monsterData[i]->y = 180.0f * DX_PI_F / 180;	// 座標として使われない変数yにモデルの回転量を入れておく
-						break;
-
-					case Direction::West: // Ｘ軸マイナス方向
-						monsterData[i]->x -= 1;
-						monsterData[i]->y = -90.0f * DX_PI_F / 180;	// 座標として使われない変数yにモデルの回転量を入れておく
-						break;
-
-					case Direction::North: // Ｚ軸プラス方向
-						monsterData[i]->z += 1;
-						monsterData[i]->y = 0.0f * DX_PI_F / 180;	// 座標として使われない変数yにモデルの回転量を入れておく
-						break;
-					}
-
-					// 一度出現したらもう出現しない
-					map[posZ][posX] = 1;
-
-					// 出現させたのでfor文から抜ける
-					break;
+					loadedMask |= 1 << bit;
 				}
 			}
 		}
+		if(chunkX != jpsChunkX || chunkZ != jpsChunkZ || loadedMask != jpsLoadedMask)
+		{
+			Jps_Build(&jps, (chunkX - CHASE_CHUNKRADIUS) * TILEMAP_CHUNKSIZE, (chunkZ - CHASE_CHUNKRADIUS) * TILEMAP_CHUNKSIZE, TileMap_GetCell);
+			jpsChunkX = chunkX;
+			jpsChunkZ = chunkZ;
+			jpsLoadedMask = loadedMask;
+		}
+
+		// 周りのチャンクが全部読み込まれたら、今いるチャンクの見えるマスの一覧を作る( 読み込み前のチャンクは壁になってしまうので待つ )
+		int allLoadedMask = (1 << ((CHASE_CHUNKRADIUS * 2 + 1) * (CHASE_CHUNKRADIUS * 2 + 1))) - 1;
+		if(loadedMask == allLoadedMask && (!pvs.isBuilt || pvs.originX != chunkX * TILEMAP_CHUNKSIZE || pvs.originZ != chunkZ * TILEMAP_CHUNKSIZE))
+		{
+			Pvs_Build(&pvs, &pvsWork, chunkX * TILEMAP_CHUNKSIZE, chunkZ * TILEMAP_CHUNKSIZE, TileMap_GetCell);
+		}
+
+		// 一定のフレームごとにモンスターをプレイヤーに向かって１マス進める
+		moveFrame++;
+		if(moveFrame >= MONSTER_MOVEFRAME)
+		{
+			moveFrame = 0;
+			Monster_Chase(&monsterPool, &jps, &jpsCache, posX, posZ);
+		}
 
 		// 左が押されていたら向いている方向を左に９０度変更する
 		if(CheckDownKey(KEY_INPUT_A) == 1)
@@ -266,62 +462,32 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		// カメラの位置と向きをセットする
 		SetCameraPositionAndTarget_UpVecY(camPos, camTarg);
 
-		// マップを描画する
-		for(int i=0; i<BLOCK_NUM_Z; i++)
+		// 今いるマスから見えるマスを含むチャンクの壁を、チャンクごとにまとめて描画する
+		// 一覧が無い間( 今いるチャンクに入った直後で周りの読み込みが終わっていない時 )はその場で求める
+		int visibleNum = Pvs_GetVisible(&pvs, posX, posZ, dir, visibleX, visibleZ, VIEW_CELLMAX);
+		bool pvsCast = visibleNum < 0;
+		if(pvsCast)
 		{
-			for(int j=0; j<BLOCK_NUM_X; j++)
-			{
-				// 道ではないところは描画しない
-				if(map[i][j] == 0)
-				{
-					continue;
-				}
-
-				// 壁モデルの座標を変更する
-				MV1SetPosition(kabeModel, VGet(j * BLOCK_SIZE, 0.0f, i * BLOCK_SIZE));
-
-				// ４方の壁の状態で描画するフレーム番号を変更する
-				frameNo = 0;
-				if(map[i][j + 1] == 0)
-				{
-					frameNo += 1;
-				}
-				if(map[i][j - 1] == 0)
-				{
-					frameNo += 2;
-				}
-				if(map[i + 1][j] == 0)
-				{
-					frameNo += 4;
-				}
-				if(map[i - 1][j] == 0)
-				{
-					frameNo += 8;
-				}
-
-				// 割り出した番号のフレームを描画する
-				MV1DrawFrame(kabeModel, frameNo);
-
-				// モンスター出現位置配列の中で有効なものを描画
-				for(int k=0; k<MONSTER_NUM; k++)
-				{
-					if(monsterData[k] != NULL)
-					{
-						// モンスターの座標をセット
-						MV1SetPosition(monsterModel, VGet(monsterData[k]->x * BLOCK_SIZE, 0.0f, monsterData[k]->z * BLOCK_SIZE));
-
-						// モンスターの回転をセット
-						MV1SetRotationXYZ(monsterModel, VGet(0.0f, monsterData[k]->y, 0.0f));
-
-						// モンスターを描画
-						MV1DrawModel(monsterModel);
-					}
-				}
-			}
+			visibleNum = Pvs_CastView(&pvsWork, posX, posZ, dir, TileMap_GetCell, visibleX, visibleZ, VIEW_CELLMAX);
 		}
+		WallMesh_Draw(visibleX, visibleZ, visibleNum);
+
+		// 見えるマスにいるモンスターを１体１回ずつ描画する
+		int monsterDrawNum = Monster_Draw(&monsterPool, monsterModel, BLOCK_SIZE, visibleX, visibleZ, visibleNum);
 
 		DrawFormatString(5, 5, 65535, "%d, %d", posX, posZ);
 		DrawFormatString(5, 25, 65535, "%d", dir);
+		DrawFormatString(5, 45, 65535, "pvs %d cells %s build %dus monster %d/%d draw %d", visibleNum, pvsCast ? "cast" : "table", (int)pvs.buildTime,
+			monsterPool.activeNum, monsterPool.capacity, monsterDrawNum);
+		TILEMAP_STATS tileStats;
+		TileMap_GetStats(&tileStats);
+		DrawFormatString(5, 65, 65535, "chunk %d/%d loading %d load %d evict %d edit %d gen %dus", tileStats.residentNum, tileStats.slotNum,
+			tileStats.loadingNum, tileStats.loadNum, tileStats.evictNum, tileStats.editNum, (int)tileStats.generateTimeMax);
+		WALLMESH_STATS wallStats;
+		WallMesh_GetStats(&wallStats);
+		DrawFormatString(5, 85, 65535, "wall draw %d poly %d bake %d %dus", wallStats.drawChunkNum, wallStats.drawPolygonNum,
+			wallStats.bakeNum, (int)wallStats.bakeTimeMax);
+		DrawFormatString(5, 105, 65535, "path search %d hit %d expand %d", jpsCache.searchNum, jpsCache.hitNum, jps.expandNum);
 
 		// 裏画面の内容を表画面に反映する
 		ScreenFlip();
@@ -333,6 +499,14 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 	}
 
+	Jps_TerminateCache(&jpsCache);
+	Jps_Terminate(&jps);
+	Monster_Terminate(&monsterPool);
+	Pvs_TerminateTable(&pvs);
+	Pvs_Terminate(&pvsWork);
+	WallMesh_Terminate();
+	TileMap_Terminate();
+
 	// DXライブラリの後始末
 	DxLib_End();
 
@@ -0,0 +1,230 @@
+﻿#include "Monster.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson33
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details 迷路に出現するモンスターの管理
+*          マス、向き、状態を別々の配列で持ち、空いている要素は空きリストから取り出す
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const int MONSTER_MOVEX[4] = { 1, 0, -1, 0 };	//!< 向きごとのＸ方向の移動量( East, South, West, North )
+const int MONSTER_MOVEZ[4] = { 0, -1, 0, 1 };	//!< 向きごとのＺ方向の移動量
+const float MONSTER_ROTATION[4] = { 90.0f * DX_PI_F / 180, 180.0f * DX_PI_F / 180, -90.0f * DX_PI_F / 180, 0.0f * DX_PI_F / 180 };	//!< 向きごとのモデルの回転量( East, South, West, North )
+
+/**
+* @fn Monster_Initialize
+* @brief 入れ物を確保して全要素を空きリストにつなぐ
+* @param[out] MONSTERPOOL *pool
+* @param[in] int capacity 最大数
+* @return bool true:成功  false:失敗
+*/
+bool Monster_Initialize(MONSTERPOOL *pool, int capacity)
+{
+	pool->capacity = capacity;
+	pool->cellX = (int *)malloc(sizeof(int) * capacity);
+	pool->cellZ = (int *)malloc(sizeof(int) * capacity);
+	pool->dir = (BYTE *)malloc(capacity);
+	pool->state = (BYTE *)malloc(capacity);
+	pool->nextFree = (int *)malloc(sizeof(int) * capacity);
+	if(pool->cellX == NULL || pool->cellZ == NULL || pool->dir == NULL || pool->state == NULL || pool->nextFree == NULL)
+	{
+		Monster_Terminate(pool);
+		return false;
+	}
+
+	for(int i=0; i<capacity; i++)
+	{
+		pool->state[i] = MONSTER_STATE_FREE;
+		pool->nextFree[i] = i + 1 < capacity ? i + 1 : -1;
+	}
+	pool->freeHead = capacity > 0 ? 0 : -1;
+	pool->activeNum = 0;
+	return true;
+}
+
+/**
+* @fn Monster_Terminate
+* @brief 入れ物の後始末
+* @param[in] MONSTERPOOL *pool
+*/
+void Monster_Terminate(MONSTERPOOL *pool)
+{
+	free(pool->cellX);
+	free(pool->cellZ);
+	free(pool->dir);
+	free(pool->state);
+	free(pool->nextFree);
+	pool->cellX = NULL;
+	pool->cellZ = NULL;
+	pool->dir = NULL;
+	pool->state = NULL;
+	pool->nextFree = NULL;
+	pool->capacity = 0;
+	pool->freeHead = -1;
+	pool->activeNum = 0;
+}
+
+/**
+* @fn Monster_Spawn
+* @brief 空きリストから取り出して出現させる
+* @param[in] MONSTERPOOL *pool, int x, int z 出現するマス, int dir 向き( Direction )
+* @return int 番号( 一杯の場合は -1 )
+*/
+int Monster_Spawn(MONSTERPOOL *pool, int x, int z, int dir)
+{
+	int index = pool->freeHead;
+	if(index < 0)
+	{
+		return -1;
+	}
+	pool->freeHead = pool->nextFree[index];
+
+	pool->cellX[index] = x;
+	pool->cellZ[index] = z;
+	pool->dir[index] = (BYTE)dir;
+	pool->state[index] = MONSTER_STATE_IDLE;
+	pool->activeNum++;
+	return index;
+}
+
+/**
+* @fn Monster_Despawn
+* @brief 消滅させて空きリストに戻す
+* @param[in] MONSTERPOOL *pool, int index
+*/
+void Monster_Despawn(MONSTERPOOL *pool, int index)
+{
+	if(pool->state[index] == MONSTER_STATE_FREE)
+	{
+		return;
+	}
+	pool->state[index] = MONSTER_STATE_FREE;
+	pool->nextFree[index] = pool->freeHead;
+	pool->freeHead = index;
+	pool->activeNum--;
+}
+
+/**
+* @fn Monster_DespawnFar
+* @brief 指定のマスから離れたモンスターを消滅させる
+* @param[in] MONSTERPOOL *pool, int x, int z, int distance これより遠い( ＸとＺの差の大きい方 )モンスターを消滅させる
+* @return int 消滅させた数
+*/
+int Monster_DespawnFar(MONSTERPOOL *pool, int x, int z, int distance)
+{
+	int num = 0;
+	for(int i=0; i<pool->capacity; i++)
+	{
+		if(pool->state[i] == MONSTER_STATE_FREE)
+		{
+			continue;
+		}
+		int distanceX = pool->cellX[i] > x ? pool->cellX[i] - x : x - pool->cellX[i];
+		int distanceZ = pool->cellZ[i] > z ? pool->cellZ[i] - z : z - pool->cellZ[i];
+		if(distanceX > distance || distanceZ > distance)
+		{
+			Monster_Despawn(pool, i);
+			num++;
+		}
+	}
+	return num;
+}
+
+/**
+* @fn Monster_Chase
+* @brief 全てのモンスターを目的地に向かって１マス進める
+* @param[in] MONSTERPOOL *pool, JPSMAP *map, JPSPATHCACHE *cache 経路の記録, int targetX, int targetZ 目的地
+* @return int 進んだ数
+* @details 同じ目的地へ向かうモンスターは経路の記録を共有するので、探索するのは記録の無いマスにいるモンスターだけ
+*/
+int Monster_Chase(MONSTERPOOL *pool, JPSMAP *map, JPSPATHCACHE *cache, int targetX, int targetZ)
+{
+	int moveNum = 0;
+	for(int i=0; i<pool->capacity; i++)
+	{
+		if(pool->state[i] == MONSTER_STATE_FREE)
+		{
+			continue;
+		}
+
+		int dir = Jps_GetStep(map, cache, pool->cellX[i], pool->cellZ[i], targetX, targetZ);
+		if(dir < 0)
+		{
+			pool->state[i] = MONSTER_STATE_IDLE;
+			continue;
+		}
+		pool->cellX[i] += MONSTER_MOVEX[dir];
+		pool->cellZ[i] += MONSTER_MOVEZ[dir];
+		pool->dir[i] = (BYTE)dir;
+		pool->state[i] = MONSTER_STATE_CHASE;
+		moveNum++;
+	}
+	return moveNum;
+}
+
+/**
+* @fn Monster_Draw
+* @brief 見えるマスにいるモンスターだけを描画する
+* @param[in] const MONSTERPOOL *pool, int modelHandle, float blockSize マス１つのサイズ
+* @param[in] const int *visibleX, const int *visibleZ 見えるマスの座標の一覧( 最初は自分のいるマス ), int visibleNum マスの数
+* @return int 描画した数
+* @details 最初に見えるマスをビットの表に記録しておき、モンスター１体ごとに一覧を探さずに１回で調べる
+*          モンスター１体につき１回だけ描画する
+*/
+int Monster_Draw(const MONSTERPOOL *pool, int modelHandle, float blockSize, const int *visibleX, const int *visibleZ, int visibleNum)
+{
+	if(visibleNum <= 0)
+	{
+		return 0;
+	}
+
+	// 自分のいるマスを中心にした範囲の見えるマスのビットを立てる( 範囲の外のマスは描画しない )
+	unsigned int visibleBit[MONSTER_VISIBLESIZE * MONSTER_VISIBLESIZE / 32];
+	memset(visibleBit, 0, sizeof(visibleBit));
+	int originX = visibleX[0] - MONSTER_VISIBLESIZE / 2;
+	int originZ = visibleZ[0] - MONSTER_VISIBLESIZE / 2;
+	for(int j=0; j<visibleNum; j++)
+	{
+		unsigned int x = (unsigned int)(visibleX[j] - originX);
+		unsigned int z = (unsigned int)(visibleZ[j] - originZ);
+		if(x < (unsigned int)MONSTER_VISIBLESIZE && z < (unsigned int)MONSTER_VISIBLESIZE)
+		{
+			int bit = z * MONSTER_VISIBLESIZE + x;
+			visibleBit[bit / 32] |= 1u << (bit % 32);
+		}
+	}
+
+	int drawNum = 0;
+	for(int i=0; i<pool->capacity; i++)
+	{
+		if(pool->state[i] == MONSTER_STATE_FREE)
+		{
+			continue;
+		}
+
+		// 見えるマスにいなければ描画しない
+		unsigned int x = (unsigned int)(pool->cellX[i] - originX);
+		unsigned int z = (unsigned int)(pool->cellZ[i] - originZ);
+		if(x >= (unsigned int)MONSTER_VISIBLESIZE || z >= (unsigned int)MONSTER_VISIBLESIZE)
+		{
+			continue;
+		}
+		int bit = z * MONSTER_VISIBLESIZE + x;
+		if((visibleBit[bit / 32] & (1u << (bit % 32))) == 0)
+		{
+			continue;
+		}
+
+		// モンスターの座標と回転をセットして描画
+		MV1SetPosition(modelHandle, VGet(pool->cellX[i] * blockSize, 0.0f, pool->cellZ[i] * blockSize));
+		MV1SetRotationXYZ(modelHandle, VGet(0.0f, MONSTER_ROTATION[pool->dir[i]], 0.0f));
+		MV1DrawModel(modelHandle);
+		drawNum++;
+	}
+	return drawNum;
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+#include "DxLib.h"
+#include "Jps.h"
+
+const int MONSTER_STATE_FREE = 0;				//!< モンスターの状態 : 未使用( 空きリストにつながっている )
+const int MONSTER_STATE_IDLE = 1;				//!< モンスターの状態 : 出現中( 目的地にたどり着けないので止まっている )
+const int MONSTER_STATE_CHASE = 2;				//!< モンスターの状態 : 目的地に向かって移動中
+const int MONSTER_VISIBLESIZE = 64;				//!< 描画時に見えるマスを記録する、最初の見えるマスを中心にした範囲の一辺のマスの数( 描画する奥行き×２より大きくする )
+
+/**
+* @struct MONSTERPOOL
+* @brief モンスターの情報を項目ごとの配列で持つ入れ物
+* @details 空いている要素は nextFree で１本のリストにつなぎ、出現と消滅を定数時間で行う
+*/
+struct MONSTERPOOL
+{
+	int capacity;							//!< 最大数
+	int *cellX;								//!< いるマスのＸ座標
+	int *cellZ;								//!< いるマスのＺ座標
+	BYTE *dir;								//!< 向き( Direction )
+	BYTE *state;							//!< 状態( MONSTER_STATE_FREE, MONSTER_STATE_IDLE, MONSTER_STATE_CHASE )
+	int *nextFree;							//!< 次の空いている要素の番号( -1:終端 )
+	int freeHead;							//!< 最初の空いている要素の番号( -1:空き無し )
+	int activeNum;							//!< 出現中の数
+};
+
+bool Monster_Initialize(MONSTERPOOL *pool, int capacity);	//!< 入れ物を確保して全要素を空きリストにつなぐ( 戻り値  true:成功  false:失敗 )
+void Monster_Terminate(MONSTERPOOL *pool);		//!< 入れ物の後始末
+int Monster_Spawn(MONSTERPOOL *pool, int x, int z, int dir);	//!< 空きリストから取り出して出現させる( 戻り値 : 番号、一杯の場合は -1 )
+void Monster_Despawn(MONSTERPOOL *pool, int index);	//!< 消滅させて空きリストに戻す
+int Monster_DespawnFar(MONSTERPOOL *pool, int x, int z, int distance);	//!< 指定のマスから離れたモンスターを消滅させる( 戻り値 : 消滅させた数 )
+int Monster_Chase(MONSTERPOOL *pool, JPSMAP *map, JPSPATHCACHE *cache, int targetX, int targetZ);	//!< 全てのモンスターを目的地に向かって１マス進める( 戻り値 : 進んだ数 )
+int Monster_Draw(const MONSTERPOOL *pool, int modelHandle, float blockSize, const int *visibleX, const int *visibleZ, int visibleNum);	//!< 見えるマスにいるモンスターだけを描画する( 戻り値 : 描画した数 )
@@ -0,0 +1,376 @@
+﻿#include "Pvs.h"
+#include <malloc.h>
+#include <math.h>
+/**
+* @file
+* @brief Lesson33
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details 格子状のマップの見えるマスの計算( PVS )
+*          範囲を決めて全マス全方向の一覧を事前に作っておき、一覧が無い場所ではその場で求める
+*          マスの中心から向いている方向に１行ずつ奥へ進み、手前の行の壁で遮られていない視線の範囲を
+*          傾き( 横のずれ÷奥行き )の区間の一覧で持つ。区間と少しでも重なるマスは見える可能性があるとする
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const int PVS_FORWARDX[4] = { 1, 0, -1, 0 };	//!< 向きごとの奥へのＸ方向の差分( East, South, West, North )
+const int PVS_FORWARDZ[4] = { 0, -1, 0, 1 };	//!< 向きごとの奥へのＺ方向の差分
+
+/**
+* @fn Pvs_Initialize
+* @brief 視野の広さと奥行きから作業用の情報を確保する
+* @param[out] PVSWORK *work
+* @param[in] float viewSlope 視野の左右の端の傾き, int maxDepth 調べる最大の奥行き
+* @return bool true:成功  false:失敗
+* @details １行のマスの数は奥行きに比例するので、区間の数もその程度で収まる
+*/
+bool Pvs_Initialize(PVSWORK *work, float viewSlope, int maxDepth)
+{
+	work->viewSlope = viewSlope;
+	work->maxDepth = maxDepth;
+	work->getCell = NULL;
+	work->intervalMax = (int)ceilf(viewSlope * (maxDepth + 1)) * 2 + 8;
+	work->interval = (PVSINTERVAL *)malloc(sizeof(PVSINTERVAL) * work->intervalMax);
+	work->nextInterval = (PVSINTERVAL *)malloc(sizeof(PVSINTERVAL) * work->intervalMax);
+	work->blocker = (PVSINTERVAL *)malloc(sizeof(PVSINTERVAL) * work->intervalMax);
+	work->intervalNum = 0;
+	work->blockerNum = 0;
+	work->cellX = NULL;
+	work->cellZ = NULL;
+	work->cellNum = 0;
+	work->cellMax = 0;
+	if(work->interval == NULL || work->nextInterval == NULL || work->blocker == NULL)
+	{
+		Pvs_Terminate(work);
+		return false;
+	}
+	return true;
+}
+
+/**
+* @fn Pvs_Terminate
+* @brief 作業用の情報の後始末
+* @param[in] PVSWORK *work
+*/
+void Pvs_Terminate(PVSWORK *work)
+{
+	free(work->blocker);
+	free(work->nextInterval);
+	free(work->interval);
+	work->blocker = NULL;
+	work->nextInterval = NULL;
+	work->interval = NULL;
+}
+
+/**
+* @fn Pvs_IsWall
+* @brief 指定のマスが視線を遮るかどうか
+* @param[in] const PVSWORK *work, int x, int z
+* @return bool true:壁かマップの外  false:道
+*/
+static bool Pvs_IsWall(const PVSWORK *work, int x, int z)
+{
+	return work->getCell(x, z) == 0;
+}
+
+/**
+* @fn Pvs_AddCell
+* @brief 見えるマスの一覧にマスを追加する
+* @param[in] PVSWORK *work, int x, int z
+* @details 一覧が一杯の場合は追加しない( 手前から順に追加するので奥の方が切り捨てられる )
+*/
+static void Pvs_AddCell(PVSWORK *work, int x, int z)
+{
+	if(work->cellNum >= work->cellMax)
+	{
+		return;
+	}
+	work->cellX[work->cellNum] = x;
+	work->cellZ[work->cellNum] = z;
+	work->cellNum++;
+}
+
+/**
+* @fn Pvs_Subtract
+* @brief 遮られていない視線の区間から壁の傾きの範囲を取り除く
+* @param[in] PVSWORK *work, float start, float end
+*/
+static void Pvs_Subtract(PVSWORK *work, float start, float end)
+{
+	int num = 0;
+	for(int i=0; i<work->intervalNum; i++)
+	{
+		PVSINTERVAL *in = &work->interval[i];
+		if(in->end <= start || in->start >= end)
+		{
+			work->nextInterval[num++] = *in;
+			continue;
+		}
+		if(in->start < start)
+		{
+			work->nextInterval[num].start = in->start;
+			work->nextInterval[num].end = start;
+			num++;
+		}
+		if(in->end > end)
+		{
+			work->nextInterval[num].start = end;
+			work->nextInterval[num].end = in->end;
+			num++;
+		}
+	}
+
+	PVSINTERVAL *swap = work->interval;
+	work->interval = work->nextInterval;
+	work->nextInterval = swap;
+	work->intervalNum = num;
+}
+
+/**
+* @fn Pvs_BuildView
+* @brief 指定のマスから指定の向きで見えるマスを一覧に追加する
+* @param[in] PVSWORK *work, int x, int z, int dir
+* @details 奥行き d、横 c のマスは、奥行き d-0.5～d+0.5、横 c-0.5～c+0.5 の正方形なので、
+*          中心から見た傾きの範囲は４つの角の傾きの最小値から最大値になる
+*/
+static void Pvs_BuildView(PVSWORK *work, int x, int z, int dir)
+{
+	float viewSlope = work->viewSlope;
+	int maxDepth = work->maxDepth;
+	int forwardX = PVS_FORWARDX[dir];
+	int forwardZ = PVS_FORWARDZ[dir];
+	int sideX = -forwardZ;
+	int sideZ = forwardX;
+
+	// 自分のいるマスは常に見える
+	work->cellNum = 0;
+	Pvs_AddCell(work, x, z);
+
+	work->interval[0].start = -viewSlope;
+	work->interval[0].end = viewSlope;
+	work->intervalNum = 1;
+
+	for(int d=1; d<=maxDepth && work->intervalNum > 0; d++)
+	{
+		float low = work->interval[0].start;
+		float high = work->interval[work->intervalNum - 1].end;
+		int cStart = (int)floorf(low * (d + 0.5f)) - 1;
+		int cEnd = (int)ceilf(high * (d + 0.5f)) + 1;
+		work->blockerNum = 0;
+
+		for(int c=cStart; c<=cEnd; c++)
+		{
+			float cellMin = (c - 0.5f) / (c - 0.5f < 0.0f ? d - 0.5f : d + 0.5f);
+			float cellMax = (c + 0.5f) / (c + 0.5f > 0.0f ? d - 0.5f : d + 0.5f);
+
+			// 遮られていない区間と重なっているか
+			bool visible = false;
+			for(int i=0; i<work->intervalNum; i++)
+			{
+				if(cellMax > work->interval[i].start && cellMin < work->interval[i].end)
+				{
+					visible = true;
+					break;
+				}
+			}
+			if(!visible)
+			{
+				continue;
+			}
+
+			// マップの外は壁として扱う
+			int cellX = x + forwardX * d + sideX * c;
+			int cellZ = z + forwardZ * d + sideZ * c;
+			if(Pvs_IsWall(work, cellX, cellZ))
+			{
+				work->blocker[work->blockerNum].start = cellMin;
+				work->blocker[work->blockerNum].end = cellMax;
+				work->blockerNum++;
+				continue;
+			}
+			Pvs_AddCell(work, cellX, cellZ);
+		}
+
+		// この行の壁で奥の行への視線を遮る( 同じ行の壁の後ろにあるマスは見えるとしておく )
+		for(int i=0; i<work->blockerNum; i++)
+		{
+			Pvs_Subtract(work, work->blocker[i].start, work->blocker[i].end);
+		}
+	}
+}
+
+/**
+* @fn Pvs_CastView
+* @brief 指定のマスから指定の向きで見えるマスをその場で求める
+* @param[in] PVSWORK *work Pvs_Initialize で確保した作業用の情報, int x, int z, int dir 向き( Direction )
+* @param[in] PVS_GETCELL getCell マスの値を取得する関数( 0:壁  それ以外:道 )
+* @param[out] int *cellX, int *cellZ 見えるマスの座標の一覧( 手前から奥の順 )
+* @param[in] int cellMax cellX, cellZ の大きさ
+* @return int マスの数( cellMax より多い場合は奥の方を切り捨てる )
+* @details 大きさの決まっていないマップのように、全マス分を事前に計算しておけない場合に毎フレーム呼ぶ
+*          見えるマスは cellX, cellZ に直接書き込むので、メモリの確保もコピーも行わない
+*/
+int Pvs_CastView(PVSWORK *work, int x, int z, int dir, PVS_GETCELL getCell, int *cellX, int *cellZ, int cellMax)
+{
+	work->getCell = getCell;
+	work->cellX = cellX;
+	work->cellZ = cellZ;
+	work->cellNum = 0;
+	work->cellMax = cellMax;
+	if(getCell(x, z) != 0)
+	{
+		Pvs_BuildView(work, x, z, dir);
+	}
+	return work->cellNum;
+}
+
+/**
+* @fn Pvs_InitializeTable
+* @brief 指定の大きさの範囲の見えるマスの一覧を確保する
+* @param[out] PVS *pvs
+* @param[in] int width, int height 範囲のマスの数
+* @return bool true:成功  false:失敗
+* @details 見えるマスの一覧は Pvs_Build で足りない分を広げるので、ここでは各向きの始まりだけ確保する
+*/
+bool Pvs_InitializeTable(PVS *pvs, int width, int height)
+{
+	pvs->originX = 0;
+	pvs->originZ = 0;
+	pvs->width = width;
+	pvs->height = height;
+	pvs->isBuilt = false;
+	pvs->cell = NULL;
+	pvs->cellNum = 0;
+	pvs->cellMax = 0;
+	pvs->maxVisibleNum = 0;
+	pvs->buildTime = 0;
+	pvs->start = (int *)malloc(sizeof(int) * (width * height * 4 + 1));
+	return pvs->start != NULL;
+}
+
+/**
+* @fn Pvs_TerminateTable
+* @brief 見えるマスの一覧の後始末
+* @param[in] PVS *pvs
+*/
+void Pvs_TerminateTable(PVS *pvs)
+{
+	free(pvs->cell);
+	free(pvs->start);
+	pvs->cell = NULL;
+	pvs->start = NULL;
+	pvs->cellNum = 0;
+	pvs->cellMax = 0;
+	pvs->isBuilt = false;
+}
+
+/**
+* @fn Pvs_Build
+* @brief 指定の範囲の全マス全方向の見えるマスの一覧を事前に作る
+* @param[in,out] PVS *pvs Pvs_InitializeTable で確保した一覧
+* @param[in] PVSWORK *work Pvs_Initialize で確保した作業用の情報
+* @param[in] int originX, int originZ 範囲の左下のマス, PVS_GETCELL getCell マスの値を取得する関数( 0:壁  それ以外:道 )
+* @return bool true:成功  false:失敗( 一覧は作っていない状態になる )
+* @details 範囲の周りの奥行き分のマスも getCell で正しく取得できる状態で呼ぶ
+*          見えるかどうかは壁だけで決まるので、道の種類を書き換えても作り直さなくて良い
+*/
+bool Pvs_Build(PVS *pvs, PVSWORK *work, int originX, int originZ, PVS_GETCELL getCell)
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+	pvs->originX = originX;
+	pvs->originZ = originZ;
+	pvs->isBuilt = false;
+	pvs->cellNum = 0;
+	pvs->maxVisibleNum = 0;
+
+	// １つの向きで調べるマスの数の上限( 各行で区間の両端の外側まで調べる分 )
+	int viewCellMax = 1;
+	for(int d=1; d<=work->maxDepth; d++)
+	{
+		viewCellMax += ((int)ceilf(work->viewSlope * (d + 0.5f)) + 1) * 2 + 1;
+	}
+	int *viewX = (int *)malloc(sizeof(int) * viewCellMax);
+	int *viewZ = (int *)malloc(sizeof(int) * viewCellMax);
+	if(viewX == NULL || viewZ == NULL)
+	{
+		free(viewZ);
+		free(viewX);
+		return false;
+	}
+
+	bool result = true;
+	for(int z=0; z<pvs->height && result; z++)
+	{
+		for(int x=0; x<pvs->width && result; x++)
+		{
+			for(int dir=0; dir<4; dir++)
+			{
+				int view = (z * pvs->width + x) * 4 + dir;
+				pvs->start[view] = pvs->cellNum;
+				int visibleNum = Pvs_CastView(work, originX + x, originZ + z, dir, getCell, viewX, viewZ, viewCellMax);
+				if(visibleNum == 0)
+				{
+					continue;
+				}
+
+				// 足りなくなったら倍に広げる
+				if(pvs->cellNum + visibleNum > pvs->cellMax)
+				{
+					int cellMax = pvs->cellMax * 2 > pvs->cellNum + visibleNum ? pvs->cellMax * 2 : pvs->cellNum + visibleNum + pvs->width * pvs->height;
+					PVSCELL *cell = (PVSCELL *)realloc(pvs->cell, sizeof(PVSCELL) * cellMax);
+					if(cell == NULL)
+					{
+						result = false;
+						break;
+					}
+					pvs->cell = cell;
+					pvs->cellMax = cellMax;
+				}
+				for(int i=0; i<visibleNum; i++)
+				{
+					pvs->cell[pvs->cellNum].x = (short)(viewX[i] - originX);
+					pvs->cell[pvs->cellNum].z = (short)(viewZ[i] - originZ);
+					pvs->cellNum++;
+				}
+				pvs->maxVisibleNum = visibleNum > pvs->maxVisibleNum ? visibleNum : pvs->maxVisibleNum;
+			}
+		}
+	}
+	pvs->start[pvs->width * pvs->height * 4] = pvs->cellNum;
+
+	free(viewZ);
+	free(viewX);
+	pvs->isBuilt = result;
+	pvs->buildTime = GetNowHiPerformanceCount() - startTime;
+	return result;
+}
+
+/**
+* @fn Pvs_GetVisible
+* @brief 事前に作った一覧から見えるマスを取得する
+* @param[in] const PVS *pvs, int x, int z, int dir 向き( Direction )
+* @param[out] int *cellX, int *cellZ 見えるマスの座標の一覧( 手前から奥の順 )
+* @param[in] int cellMax cellX, cellZ の大きさ
+* @return int マスの数( cellMax より多い場合は奥の方を切り捨てる )、一覧が無いか範囲の外の場合は -1
+* @details -1 の場合は Pvs_CastView でその場で求める
+*/
+int Pvs_GetVisible(const PVS *pvs, int x, int z, int dir, int *cellX, int *cellZ, int cellMax)
+{
+	x -= pvs->originX;
+	z -= pvs->originZ;
+	if(!pvs->isBuilt || x < 0 || z < 0 || x >= pvs->width || z >= pvs->height)
+	{
+		return -1;
+	}
+	int view = (z * pvs->width + x) * 4 + dir;
+	int num = pvs->start[view + 1] - pvs->start[view];
+	num = num < cellMax ? num : cellMax;
+	const PVSCELL *cell = pvs->cell + pvs->start[view];
+	for(int i=0; i<num; i++)
+	{
+		cellX[i] = pvs->originX + cell[i].x;
+		cellZ[i] = pvs->originZ + cell[i].z;
+	}
+	return num;
+}
@@ -0,0 +1,76 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const float PVS_VIEWSLOPE = 1.0f;			//!< 視野の左右の端の傾き( 横のずれ÷奥行き、1.0f で左右４５度、既定の視野角の画面の横幅より少し広い )
+
+typedef int (*PVS_GETCELL)(int x, int z);	//!< マスの値を取得する関数( 0:壁  それ以外:道、マップの外は 0 を返す )
+
+/**
+* @struct PVSINTERVAL
+* @brief 遮られていない視線の傾きの区間
+*/
+struct PVSINTERVAL
+{
+	float start;							//!< 区間の始まりの傾き
+	float end;								//!< 区間の終わりの傾き
+};
+
+/**
+* @struct PVSWORK
+* @brief 見えるマスを求める為の作業用の情報( 毎フレーム確保し直さないように、使う側で持っておく )
+*/
+struct PVSWORK
+{
+	float viewSlope;						//!< 視野の左右の端の傾き
+	int maxDepth;							//!< 調べる最大の奥行き
+	PVS_GETCELL getCell;					//!< マスの値を取得する関数
+	PVSINTERVAL *interval;					//!< 遮られていない視線の区間の一覧
+	PVSINTERVAL *nextInterval;				//!< 壁で遮った後の区間の一覧
+	int intervalNum;						//!< 区間の数
+	int intervalMax;						//!< 区間の配列の大きさ
+	PVSINTERVAL *blocker;					//!< 現在の行の壁の傾きの範囲
+	int blockerNum;							//!< 現在の行の壁の数
+	int *cellX;								//!< 見えるマスのＸ座標の一覧( Pvs_CastView の呼び出し側の配列 )
+	int *cellZ;								//!< 見えるマスのＺ座標の一覧( Pvs_CastView の呼び出し側の配列 )
+	int cellNum;							//!< 見えるマスの数
+	int cellMax;							//!< cellX, cellZ の大きさ
+};
+
+/**
+* @struct PVSCELL
+* @brief 見えるマスの、一覧を作った範囲の左下のマスからの相対座標
+*/
+struct PVSCELL
+{
+	short x;								//!< Ｘ座標
+	short z;								//!< Ｚ座標
+};
+
+/**
+* @struct PVS
+* @brief 指定の範囲の各マスから各方向を向いた時に見える可能性のあるマスの一覧( 事前計算した PVS )
+* @details 範囲内のマスの番号は z * width + x、向きの番号は Direction と同じ
+*          見えるマスは範囲の外にはみ出すことがあるので、範囲の周りの奥行き分のマスも読み込んでから作る
+*/
+struct PVS
+{
+	int originX;							//!< 一覧を作った範囲の左下のマスのＸ座標
+	int originZ;							//!< 一覧を作った範囲の左下のマスのＺ座標
+	int width;								//!< Ｘ方向のマスの数
+	int height;								//!< Ｚ方向のマスの数
+	bool isBuilt;							//!< 一覧を作ってあるかどうか
+	int *start;								//!< 各マスの各向きの一覧が cell のどこから始まるか( マスの数×４＋１ )
+	PVSCELL *cell;							//!< 見える可能性のあるマスの一覧( 手前から奥の順 )
+	int cellNum;							//!< cell に格納したマスの数の合計
+	int cellMax;							//!< cell の大きさ( 足りなくなったら広げる )
+	int maxVisibleNum;						//!< １つのマスの１つの向きから見えるマスの最大数
+	LONGLONG buildTime;						//!< 最後に一覧を作るのにかかった時間( マイクロ秒 )( 統計用 )
+};
+
+bool Pvs_Initialize(PVSWORK *work, float viewSlope, int maxDepth);	//!< 視野の広さと奥行きから作業用の情報を確保する( 戻り値  true:成功  false:失敗 )
+void Pvs_Terminate(PVSWORK *work);				//!< 作業用の情報の後始末
+int Pvs_CastView(PVSWORK *work, int x, int z, int dir, PVS_GETCELL getCell, int *cellX, int *cellZ, int cellMax);	//!< 指定のマスから指定の向きで見えるマスをその場で求める( 戻り値 : マスの数 )
+bool Pvs_InitializeTable(PVS *pvs, int width, int height);	//!< 指定の大きさの範囲の見えるマスの一覧を確保する( 戻り値  true:成功  false:失敗 )
+void Pvs_TerminateTable(PVS *pvs);				//!< 見えるマスの一覧の後始末
+bool Pvs_Build(PVS *pvs, PVSWORK *work, int originX, int originZ, PVS_GETCELL getCell);	//!< 指定の範囲の全マス全方向の見えるマスの一覧を事前に作る( 戻り値  true:成功  false:失敗 )
+int Pvs_GetVisible(const PVS *pvs, int x, int z, int dir, int *cellX, int *cellZ, int cellMax);	//!< 事前に作った一覧から見えるマスを取得する( 戻り値 : マスの数、範囲の外は -1 )
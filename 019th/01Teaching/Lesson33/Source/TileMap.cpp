@@ -0,0 +1,768 @@
+﻿#include "TileMap.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson33
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details チャンクに分割して必要な所だけ読み込む迷路のマップ
+*          各チャンクは種とチャンクの座標だけから生成するので、捨てたチャンクをもう一度読み込んでも同じ迷路になる
+*          チャンクの生成はバックグラウンドのスレッドで行い、メインスレッドは読み込み済みのチャンクだけを参照する
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const int TILEMAP_FREE = 0;						//!< チャンクの状態 : 未使用
+const int TILEMAP_LOADING = 1;					//!< チャンクの状態 : 読み込み中( マスの情報はスレッドが書き込んでいる )
+const int TILEMAP_READY = 2;					//!< チャンクの状態 : 読み込み済み
+const int TILEMAP_ROOMNUM = TILEMAP_CHUNKSIZE / 2;	//!< チャンク１つの一辺の部屋( 奇数座標のマス )の数
+const int TILEMAP_LOOPRATE = 16;				//!< 部屋の間の壁を追加で開ける確率( １／TILEMAP_LOOPRATE )
+const int TILEMAP_DOORRATE = 8;					//!< チャンクの境界の壁を追加で開ける確率( １／TILEMAP_DOORRATE )
+const int TILEMAP_SWITCHRATE = 4;				//!< 行き止まりをスイッチにする確率( １／TILEMAP_SWITCHRATE )
+const int TILEMAP_EDITFIRST = 64;				//!< 書き換えたマスの記録の最初の大きさ
+
+/**
+* @struct TILEMAPCHUNK
+* @brief 読み込んだチャンク１つ分の情報
+*/
+struct TILEMAPCHUNK
+{
+	BYTE cell[TILEMAP_CHUNKBYTES];			//!< マスの値( １マス２ビット、z * TILEMAP_CHUNKSIZE + x の順 )
+	int chunkX;								//!< チャンクのＸ方向の番号
+	int chunkZ;								//!< チャンクのＺ方向の番号
+	volatile LONG state;					//!< チャンクの状態( TILEMAP_FREE, TILEMAP_LOADING, TILEMAP_READY )
+	LONGLONG generateTime;					//!< 生成にかかった時間( マイクロ秒 )
+	bool ready;								//!< メインスレッドが読み込み済みを確認したかどうか
+	int lastUseFrame;						//!< 最後にプレイヤーの近くにあったフレーム
+};
+
+/**
+* @struct TILEMAPEDIT
+* @brief 書き換えたマス１つ分の記録
+*/
+struct TILEMAPEDIT
+{
+	int x;									//!< マスのＸ座標
+	int z;									//!< マスのＺ座標
+	int value;								//!< 書き換えた後の値
+};
+
+/**
+* @struct TILEMAPINFO
+* @brief チャンクに分割した迷路のマップの情報
+*/
+struct TILEMAPINFO
+{
+	unsigned int seed;						//!< 迷路の種
+	TILEMAPCHUNK *slot;						//!< チャンクを置く場所の配列( NULL:未初期化 )
+	int slotNum;							//!< チャンクを置く場所の数
+	short *chunkSlot;						//!< 世界の各チャンクを置いている場所の番号( -1:読み込んでいない )
+	int frame;								//!< TileMap_Update を呼んだ回数
+	HANDLE thread;							//!< 読み込み用のスレッドのハンドル
+	HANDLE requestSemaphore;				//!< 依頼が追加されたことを知らせるセマフォ
+	volatile LONG quit;						//!< 読み込み用のスレッドを終了させるかどうか
+	int request[TILEMAP_QUEUESIZE];			//!< 読み込みの依頼( チャンクを置く場所の番号 )
+	int requestHead;						//!< 次に依頼を書き込む位置( メインスレッドだけが使う )
+	int requestTail;						//!< 次に依頼を読み出す位置( 読み込み用のスレッドだけが使う )
+	TILEMAPEDIT *edit;						//!< 書き換えたマスの記録( 捨てたチャンクを生成し直した後に反映する、メインスレッドだけが使う )
+	int editNum;							//!< 書き換えたマスの数
+	int editMax;							//!< edit に確保した数
+	TILEMAP_STATS stats;					//!< 統計情報
+};
+
+static TILEMAPINFO tileMap;						//!< チャンクに分割した迷路のマップの実体
+
+/**
+* @fn TileMap_Hash
+* @brief 種とチャンクの座標から乱数の初期値を求める
+* @param[in] unsigned int seed, int chunkX, int chunkZ
+* @return unsigned int 乱数の初期値( 0 以外 )
+*/
+static unsigned int TileMap_Hash(unsigned int seed, int chunkX, int chunkZ)
+{
+	unsigned int hash = seed ^ ((unsigned int)chunkX * 0x9E3779B1u) ^ ((unsigned int)chunkZ * 0x85EBCA77u);
+	hash ^= hash >> 16;
+	hash *= 0x7FEB352Du;
+	hash ^= hash >> 15;
+	hash *= 0x846CA68Bu;
+	hash ^= hash >> 16;
+	return hash != 0 ? hash : 1;
+}
+
+/**
+* @fn TileMap_Random
+* @brief チャンクの生成用の乱数( xorshift )
+* @param[in] unsigned int *state 乱数の状態
+* @param[in] int range 乱数の範囲
+* @return int 0 から range - 1 の乱数
+*/
+static int TileMap_Random(unsigned int *state, int range)
+{
+	unsigned int x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return (int)(x % (unsigned int)range);
+}
+
+/**
+* @fn TileMap_GetChunkCell
+* @brief チャンク内のマスの値を取得する
+* @param[in] const BYTE *cell, int x, int z チャンク内の座標
+* @return int マスの値
+*/
+static int TileMap_GetChunkCell(const BYTE *cell, int x, int z)
+{
+	int i = z * TILEMAP_CHUNKSIZE + x;
+	return (cell[i >> 2] >> ((i & 3) * 2)) & 3;
+}
+
+/**
+* @fn TileMap_SetChunkCell
+* @brief チャンク内のマスの値を書き換える
+* @param[in] BYTE *cell, int x, int z チャンク内の座標, int value
+*/
+static void TileMap_SetChunkCell(BYTE *cell, int x, int z, int value)
+{
+	int i = z * TILEMAP_CHUNKSIZE + x;
+	int shift = (i & 3) * 2;
+	cell[i >> 2] = (BYTE)((cell[i >> 2] & ~(3 << shift)) | ((value & 3) << shift));
+}
+
+/**
+* @fn TileMap_Generate
+* @brief 種とチャンクの座標からチャンクの迷路を生成する
+* @param[out] BYTE *cell
+* @param[in] unsigned int seed, int chunkX, int chunkZ
+* @details 奇数座標のマスを部屋として穴掘り法で迷路を作り、少しだけ壁を開けて回り道を作る
+*          チャンク内の座標 0 の列と行は西と南のチャンクとの境界の壁で、このチャンクだけで扉の位置を決める
+*          東と北の境界は隣のチャンクが決めるので、生成に隣のチャンクの情報は要らない
+*/
+static void TileMap_Generate(BYTE *cell, unsigned int seed, int chunkX, int chunkZ)
+{
+	unsigned int random = TileMap_Hash(seed, chunkX, chunkZ);
+	const int moveX[4] = { 1, 0, -1, 0 };
+	const int moveZ[4] = { 0, -1, 0, 1 };
+	int stack[TILEMAP_ROOMNUM * TILEMAP_ROOMNUM];
+
+	// 全て壁にする
+	memset(cell, 0, TILEMAP_CHUNKBYTES);
+
+	// 穴掘り法で全部屋をつなぐ
+	int room = TileMap_Random(&random, TILEMAP_ROOMNUM * TILEMAP_ROOMNUM);
+	int stackNum = 0;
+	stack[stackNum++] = room;
+	TileMap_SetChunkCell(cell, (room % TILEMAP_ROOMNUM) * 2 + 1, (room / TILEMAP_ROOMNUM) * 2 + 1, 1);
+	while(stackNum > 0)
+	{
+		room = stack[stackNum - 1];
+		int roomX = room % TILEMAP_ROOMNUM;
+		int roomZ = room / TILEMAP_ROOMNUM;
+
+		// まだ掘っていない隣の部屋を探す
+		int next[4];
+		int nextNum = 0;
+		for(int i=0; i<4; i++)
+		{
+			int x = roomX + moveX[i];
+			int z = roomZ + moveZ[i];
+			if(x >= 0 && z >= 0 && x < TILEMAP_ROOMNUM && z < TILEMAP_ROOMNUM &&
+				TileMap_GetChunkCell(cell, x * 2 + 1, z * 2 + 1) == 0)
+			{
+				next[nextNum++] = i;
+			}
+		}
+		if(nextNum == 0)
+		{
+			stackNum--;
+			continue;
+		}
+
+		// 隣の部屋との間の壁と隣の部屋を掘る
+		int i = next[TileMap_Random(&random, nextNum)];
+		TileMap_SetChunkCell(cell, roomX * 2 + 1 + moveX[i], roomZ * 2 + 1 + moveZ[i], 1);
+		TileMap_SetChunkCell(cell, (roomX + moveX[i]) * 2 + 1, (roomZ + moveZ[i]) * 2 + 1, 1);
+		stack[stackNum++] = (roomZ + moveZ[i]) * TILEMAP_ROOMNUM + roomX + moveX[i];
+	}
+
+	// 部屋の間の壁を少しだけ開けて回り道を作る
+	for(int z=1; z<TILEMAP_CHUNKSIZE; z++)
+	{
+		for(int x=1; x<TILEMAP_CHUNKSIZE; x++)
+		{
+			// 片方だけ奇数座標のマスが部屋の間の壁
+			if(((x + z) & 1) == 0)
+			{
+				continue;
+			}
+			if(TileMap_GetChunkCell(cell, x, z) == 0 && TileMap_Random(&random, TILEMAP_LOOPRATE) == 0)
+			{
+				TileMap_SetChunkCell(cell, x, z, 1);
+			}
+		}
+	}
+
+	// 西と南のチャンクとの境界に扉を開ける( 世界の端には開けない、必ず１つは開ける )
+	if(chunkX > 0)
+	{
+		TileMap_SetChunkCell(cell, 0, TileMap_Random(&random, TILEMAP_ROOMNUM) * 2 + 1, 1);
+		for(int z=1; z<TILEMAP_CHUNKSIZE; z+=2)
+		{
+			if(TileMap_Random(&random, TILEMAP_DOORRATE) == 0)
+			{
+				TileMap_SetChunkCell(cell, 0, z, 1);
+			}
+		}
+	}
+	if(chunkZ > 0)
+	{
+		TileMap_SetChunkCell(cell, TileMap_Random(&random, TILEMAP_ROOMNUM) * 2 + 1, 0, 1);
+		for(int x=1; x<TILEMAP_CHUNKSIZE; x+=2)
+		{
+			if(TileMap_Random(&random, TILEMAP_DOORRATE) == 0)
+			{
+				TileMap_SetChunkCell(cell, x, 0, 1);
+			}
+		}
+	}
+
+	// 行き止まりの部屋の一部をスイッチにする( 東と北の境界の扉は分からないので壁として数える )
+	for(int z=1; z<TILEMAP_CHUNKSIZE; z+=2)
+	{
+		for(int x=1; x<TILEMAP_CHUNKSIZE; x+=2)
+		{
+			int openNum = 0;
+			for(int i=0; i<4; i++)
+			{
+				int nextX = x + moveX[i];
+				int nextZ = z + moveZ[i];
+				if(nextX < TILEMAP_CHUNKSIZE && nextZ < TILEMAP_CHUNKSIZE && TileMap_GetChunkCell(cell, nextX, nextZ) != 0)
+				{
+					openNum++;
+				}
+			}
+			if(openNum == 1 && TileMap_Random(&random, TILEMAP_SWITCHRATE) == 0)
+			{
+				TileMap_SetChunkCell(cell, x, z, 2);
+			}
+		}
+	}
+}
+
+/**
+* @fn TileMap_WorkerThread
+* @brief 読み込み用のスレッド、依頼が来るのを待ってチャンクを生成する
+* @param[in] LPVOID param 未使用
+* @return DWORD 0
+*/
+static DWORD WINAPI TileMap_WorkerThread(LPVOID param)
+{
+	for(;;)
+	{
+		// 依頼が来るまで待つ
+		WaitForSingleObject(tileMap.requestSemaphore, INFINITE);
+		if(tileMap.quit)
+		{
+			break;
+		}
+
+		// 読み込み中のチャンクはメインスレッドが参照しないので、そのまま書き込んで良い
+		TILEMAPCHUNK *chunk = &tileMap.slot[tileMap.request[tileMap.requestTail % TILEMAP_QUEUESIZE]];
+		tileMap.requestTail++;
+		LONGLONG startTime = GetNowHiPerformanceCount();
+		TileMap_Generate(chunk->cell, tileMap.seed, chunk->chunkX, chunk->chunkZ);
+		chunk->generateTime = GetNowHiPerformanceCount() - startTime;
+		InterlockedExchange(&chunk->state, TILEMAP_READY);
+	}
+	return 0;
+}
+
+/**
+* @fn TileMap_GetChunk
+* @brief 指定のマスを含むチャンクの番号を求める
+* @param[in] int x, int z
+* @param[out] int *chunkX, int *chunkZ
+* @return bool true:世界の中  false:世界の外
+*/
+static bool TileMap_GetChunk(int x, int z, int *chunkX, int *chunkZ)
+{
+	int worldSize = TileMap_GetWorldSize();
+	if(x < 0 || z < 0 || x >= worldSize || z >= worldSize)
+	{
+		return false;
+	}
+	*chunkX = x / TILEMAP_CHUNKSIZE;
+	*chunkZ = z / TILEMAP_CHUNKSIZE;
+	return true;
+}
+
+/**
+* @fn TileMap_ApplyEdit
+* @brief 生成したチャンクに、これまでに書き換えたマスを反映する
+* @param[in] TILEMAPCHUNK *chunk
+* @details 書き換えるのはスイッチを踏んだマスだけなので、記録は全体を調べても十分少ない
+*/
+static void TileMap_ApplyEdit(TILEMAPCHUNK *chunk)
+{
+	int minX = chunk->chunkX * TILEMAP_CHUNKSIZE;
+	int minZ = chunk->chunkZ * TILEMAP_CHUNKSIZE;
+	for(int i=0; i<tileMap.editNum; i++)
+	{
+		TILEMAPEDIT *edit = &tileMap.edit[i];
+		int x = edit->x - minX;
+		int z = edit->z - minZ;
+		if(x >= 0 && z >= 0 && x < TILEMAP_CHUNKSIZE && z < TILEMAP_CHUNKSIZE)
+		{
+			TileMap_SetChunkCell(chunk->cell, x, z, edit->value);
+		}
+	}
+}
+
+/**
+* @fn TileMap_CollectLoaded
+* @brief 読み込み用のスレッドが生成し終えたチャンクを読み込み済みにする
+* @details 書き換えたマスの記録を反映してから読み込み済みにするので、メインスレッドから生成したままの状態は見えない
+*/
+static void TileMap_CollectLoaded()
+{
+	for(int i=0; i<tileMap.slotNum; i++)
+	{
+		TILEMAPCHUNK *chunk = &tileMap.slot[i];
+		if(chunk->ready == false && chunk->state == TILEMAP_READY)
+		{
+			TileMap_ApplyEdit(chunk);
+			chunk->ready = true;
+			tileMap.stats.loadNum++;
+			if(chunk->generateTime > tileMap.stats.generateTimeMax)
+			{
+				tileMap.stats.generateTimeMax = chunk->generateTime;
+			}
+		}
+	}
+}
+
+/**
+* @fn TileMap_FindSlot
+* @brief 新しく読み込むチャンクを置く場所を探す
+* @param[in] int centerX, int centerZ プレイヤーのいるチャンクの番号
+* @return int 置く場所の番号( -1:空きが無い )
+* @details 空いている場所が無ければ、プレイヤーから離れているチャンクのうち、最も長く使われていないものを捨てる
+*          書き換えたマスは別に記録してあるので、書き換えたチャンクも捨てて良い
+*/
+static int TileMap_FindSlot(int centerX, int centerZ)
+{
+	int oldest = -1;
+	for(int i=0; i<tileMap.slotNum; i++)
+	{
+		TILEMAPCHUNK *chunk = &tileMap.slot[i];
+		if(chunk->state == TILEMAP_FREE)
+		{
+			return i;
+		}
+		if(chunk->ready == false)
+		{
+			continue;
+		}
+		int distanceX = chunk->chunkX > centerX ? chunk->chunkX - centerX : centerX - chunk->chunkX;
+		int distanceZ = chunk->chunkZ > centerZ ? chunk->chunkZ - centerZ : centerZ - chunk->chunkZ;
+		if(distanceX <= TILEMAP_LOADRADIUS && distanceZ <= TILEMAP_LOADRADIUS)
+		{
+			continue;
+		}
+		if(oldest < 0 || chunk->lastUseFrame < tileMap.slot[oldest].lastUseFrame)
+		{
+			oldest = i;
+		}
+	}
+	if(oldest < 0)
+	{
+		return -1;
+	}
+
+	// 捨てるチャンクを世界から外す
+	TILEMAPCHUNK *chunk = &tileMap.slot[oldest];
+	tileMap.chunkSlot[chunk->chunkZ * TILEMAP_WORLDCHUNK + chunk->chunkX] = -1;
+	tileMap.stats.evictNum++;
+	return oldest;
+}
+
+/**
+* @fn TileMap_Request
+* @brief チャンクの読み込みを依頼する
+* @param[in] int chunkX, int chunkZ, int centerX, int centerZ プレイヤーのいるチャンクの番号
+* @details 読み込み済みか読み込み中の場合は最後に使ったフレームだけを更新する
+*/
+static void TileMap_Request(int chunkX, int chunkZ, int centerX, int centerZ)
+{
+	short *chunkSlot = &tileMap.chunkSlot[chunkZ * TILEMAP_WORLDCHUNK + chunkX];
+	if(*chunkSlot >= 0)
+	{
+		tileMap.slot[*chunkSlot].lastUseFrame = tileMap.frame;
+		return;
+	}
+
+	// 依頼のキューが一杯にならないように、読み込み中の数を制限する
+	int loadingNum = 0;
+	for(int i=0; i<tileMap.slotNum; i++)
+	{
+		if(tileMap.slot[i].state == TILEMAP_LOADING)
+		{
+			loadingNum++;
+		}
+	}
+	if(loadingNum >= TILEMAP_QUEUESIZE)
+	{
+		return;
+	}
+
+	int slotIndex = TileMap_FindSlot(centerX, centerZ);
+	if(slotIndex < 0)
+	{
+		return;
+	}
+
+	TILEMAPCHUNK *chunk = &tileMap.slot[slotIndex];
+	chunk->chunkX = chunkX;
+	chunk->chunkZ = chunkZ;
+	chunk->ready = false;
+	chunk->lastUseFrame = tileMap.frame;
+	InterlockedExchange(&chunk->state, TILEMAP_LOADING);
+	*chunkSlot = (short)slotIndex;
+
+	tileMap.request[tileMap.requestHead % TILEMAP_QUEUESIZE] = slotIndex;
+	tileMap.requestHead++;
+	ReleaseSemaphore(tileMap.requestSemaphore, 1, NULL);
+}
+
+/**
+* @fn TileMap_Initialize
+* @brief 迷路の種を指定してチャンクの管理と読み込み用のスレッドを開始する
+* @param[in] unsigned int seed
+* @return bool true:成功  false:失敗
+* @details メモリの上限からチャンクを置ける数を決め、必要になるまでチャンクは生成しない
+*/
+bool TileMap_Initialize(unsigned int seed)
+{
+	tileMap.seed = seed;
+	tileMap.slotNum = TILEMAP_MEMORYBUDGET / TILEMAP_CHUNKBYTES;
+	tileMap.slot = (TILEMAPCHUNK *)malloc(sizeof(TILEMAPCHUNK) * tileMap.slotNum);
+	tileMap.chunkSlot = (short *)malloc(sizeof(short) * TILEMAP_WORLDCHUNK * TILEMAP_WORLDCHUNK);
+	if(tileMap.slot == NULL || tileMap.chunkSlot == NULL)
+	{
+		free(tileMap.slot);
+		free(tileMap.chunkSlot);
+		tileMap.slot = NULL;
+		tileMap.chunkSlot = NULL;
+		return false;
+	}
+	for(int i=0; i<tileMap.slotNum; i++)
+	{
+		tileMap.slot[i].state = TILEMAP_FREE;
+		tileMap.slot[i].ready = false;
+		tileMap.slot[i].lastUseFrame = 0;
+		tileMap.slot[i].generateTime = 0;
+	}
+	for(int i=0; i<TILEMAP_WORLDCHUNK * TILEMAP_WORLDCHUNK; i++)
+	{
+		tileMap.chunkSlot[i] = -1;
+	}
+	tileMap.frame = 0;
+	tileMap.requestHead = 0;
+	tileMap.requestTail = 0;
+	tileMap.edit = NULL;
+	tileMap.editNum = 0;
+	tileMap.editMax = 0;
+	memset(&tileMap.stats, 0, sizeof(tileMap.stats));
+	tileMap.stats.slotNum = tileMap.slotNum;
+
+	// 読み込み用のスレッドを開始する
+	tileMap.quit = 0;
+	tileMap.thread = NULL;
+	tileMap.requestSemaphore = CreateSemaphoreA(NULL, 0, TILEMAP_QUEUESIZE + 1, NULL);
+	if(tileMap.requestSemaphore != NULL)
+	{
+		tileMap.thread = CreateThread(NULL, 0, TileMap_WorkerThread, NULL, 0, NULL);
+	}
+	if(tileMap.thread == NULL)
+	{
+		ErrorLogFmtAdd("tilemap: failed to start the chunk loading thread");
+		if(tileMap.requestSemaphore != NULL)
+		{
+			CloseHandle(tileMap.requestSemaphore);
+			tileMap.requestSemaphore = NULL;
+		}
+		free(tileMap.slot);
+		free(tileMap.chunkSlot);
+		tileMap.slot = NULL;
+		tileMap.chunkSlot = NULL;
+		return false;
+	}
+	return true;
+}
+
+/**
+* @fn TileMap_Terminate
+* @brief チャンクの管理と読み込み用のスレッドの後始末
+*/
+void TileMap_Terminate()
+{
+	if(tileMap.slot == NULL)
+	{
+		return;
+	}
+
+	// 読み込み用のスレッドを終了させる
+	InterlockedExchange(&tileMap.quit, 1);
+	ReleaseSemaphore(tileMap.requestSemaphore, 1, NULL);
+	WaitForSingleObject(tileMap.thread, INFINITE);
+	CloseHandle(tileMap.thread);
+	CloseHandle(tileMap.requestSemaphore);
+
+	free(tileMap.slot);
+	free(tileMap.chunkSlot);
+	free(tileMap.edit);
+	tileMap.slot = NULL;
+	tileMap.chunkSlot = NULL;
+	tileMap.edit = NULL;
+	tileMap.slotNum = 0;
+	tileMap.editNum = 0;
+	tileMap.editMax = 0;
+}
+
+/**
+* @fn TileMap_Update
+* @brief プレイヤーの周りのチャンクの読み込みを依頼し、遠いチャンクを捨てる
+* @param[in] int x, int z プレイヤーのいるマス
+* @details 近いチャンクから順に依頼する、遠いチャンクは置く場所が足りなくなった時に捨てる
+*/
+void TileMap_Update(int x, int z)
+{
+	tileMap.frame++;
+	TileMap_CollectLoaded();
+
+	int centerX;
+	int centerZ;
+	if(!TileMap_GetChunk(x, z, &centerX, &centerZ))
+	{
+		return;
+	}
+	for(int r=0; r<=TILEMAP_LOADRADIUS; r++)
+	{
+		for(int dz=-r; dz<=r; dz++)
+		{
+			for(int dx=-r; dx<=r; dx++)
+			{
+				// 内側の輪は依頼済み
+				if(dx != -r && dx != r && dz != -r && dz != r)
+				{
+					continue;
+				}
+				int chunkX = centerX + dx;
+				int chunkZ = centerZ + dz;
+				if(chunkX >= 0 && chunkZ >= 0 && chunkX < TILEMAP_WORLDCHUNK && chunkZ < TILEMAP_WORLDCHUNK)
+				{
+					TileMap_Request(chunkX, chunkZ, centerX, centerZ);
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn TileMap_WaitLoaded
+* @brief 指定のマスを含むチャンクの読み込みが終わるまで待つ
+* @param[in] int x, int z
+* @details 開始直後のように、周りのチャンクが読み込まれるのを待たないといけない時に使う
+*/
+void TileMap_WaitLoaded(int x, int z)
+{
+	int chunkX;
+	int chunkZ;
+	if(!TileMap_GetChunk(x, z, &chunkX, &chunkZ))
+	{
+		return;
+	}
+	TileMap_Request(chunkX, chunkZ, chunkX, chunkZ);
+	for(;;)
+	{
+		TileMap_CollectLoaded();
+		int slotIndex = tileMap.chunkSlot[chunkZ * TILEMAP_WORLDCHUNK + chunkX];
+		if(slotIndex < 0 || tileMap.slot[slotIndex].ready)
+		{
+			break;
+		}
+		Sleep(1);
+	}
+}
+
+/**
+* @fn TileMap_IsLoaded
+* @brief 指定のマスを含むチャンクが読み込み済みかどうか
+* @param[in] int x, int z
+* @return bool true:読み込み済みか世界の外( マスの値が確定している )  false:読み込まれていない
+*/
+bool TileMap_IsLoaded(int x, int z)
+{
+	int chunkX;
+	int chunkZ;
+	if(!TileMap_GetChunk(x, z, &chunkX, &chunkZ))
+	{
+		return true;
+	}
+	int slotIndex = tileMap.chunkSlot[chunkZ * TILEMAP_WORLDCHUNK + chunkX];
+	return slotIndex >= 0 && tileMap.slot[slotIndex].ready;
+}
+
+/**
+* @fn TileMap_GetCell
+* @brief マスの値を取得する
+* @param[in] int x, int z
+* @return int 0:壁  1:道  2:スイッチ( 世界の外と読み込まれていないチャンクは 0 )
+* @details チャンクの境界をまたいだ隣のマスもそのまま取得できる
+*/
+int TileMap_GetCell(int x, int z)
+{
+	int chunkX;
+	int chunkZ;
+	if(!TileMap_GetChunk(x, z, &chunkX, &chunkZ))
+	{
+		return 0;
+	}
+	int slotIndex = tileMap.chunkSlot[chunkZ * TILEMAP_WORLDCHUNK + chunkX];
+	if(slotIndex < 0 || tileMap.slot[slotIndex].ready == false)
+	{
+		return 0;
+	}
+	return TileMap_GetChunkCell(tileMap.slot[slotIndex].cell, x - chunkX * TILEMAP_CHUNKSIZE, z - chunkZ * TILEMAP_CHUNKSIZE);
+}
+
+/**
+* @fn TileMap_SetCell
+* @brief マスの値を書き換える
+* @param[in] int x, int z, int value
+* @details チャンクは種から生成し直すと元に戻ってしまうので、書き換えたマスは別に記録しておき、
+*          チャンクを読み込む度に反映する( 読み込まれていないチャンクのマスも記録だけしておく )
+*/
+void TileMap_SetCell(int x, int z, int value)
+{
+	int chunkX;
+	int chunkZ;
+	if(!TileMap_GetChunk(x, z, &chunkX, &chunkZ))
+	{
+		return;
+	}
+
+	// 同じマスの記録があれば値だけ書き換え、無ければ追加する
+	int editIndex = 0;
+	while(editIndex < tileMap.editNum && (tileMap.edit[editIndex].x != x || tileMap.edit[editIndex].z != z))
+	{
+		editIndex++;
+	}
+	if(editIndex == tileMap.editNum)
+	{
+		if(tileMap.editNum >= tileMap.editMax)
+		{
+			int editMax = tileMap.editMax > 0 ? tileMap.editMax * 2 : TILEMAP_EDITFIRST;
+			TILEMAPEDIT *edit = (TILEMAPEDIT *)realloc(tileMap.edit, sizeof(TILEMAPEDIT) * editMax);
+			if(edit == NULL)
+			{
+				return;
+			}
+			tileMap.edit = edit;
+			tileMap.editMax = editMax;
+		}
+		tileMap.edit[editIndex].x = x;
+		tileMap.edit[editIndex].z = z;
+		tileMap.editNum++;
+	}
+	tileMap.edit[editIndex].value = value;
+
+	// 読み込み済みのチャンクにはすぐに反映する( 読み込み中のチャンクは読み込み終わった時に反映される )
+	int slotIndex = tileMap.chunkSlot[chunkZ * TILEMAP_WORLDCHUNK + chunkX];
+	if(slotIndex < 0 || tileMap.slot[slotIndex].ready == false)
+	{
+		return;
+	}
+	TileMap_SetChunkCell(tileMap.slot[slotIndex].cell, x - chunkX * TILEMAP_CHUNKSIZE, z - chunkZ * TILEMAP_CHUNKSIZE, value);
+}
+
+/**
+* @fn TileMap_GetWorldSize
+* @brief 世界全体の一辺のマスの数を取得する
+* @return int マスの数
+*/
+int TileMap_GetWorldSize()
+{
+	return TILEMAP_WORLDCHUNK * TILEMAP_CHUNKSIZE;
+}
+
+/**
+* @fn TileMap_GetStats
+* @brief 統計情報を取得する
+* @param[out] TILEMAP_STATS *stats
+*/
+void TileMap_GetStats(TILEMAP_STATS *stats)
+{
+	*stats = tileMap.stats;
+	stats->residentNum = 0;
+	stats->loadingNum = 0;
+	stats->editNum = tileMap.editNum;
+	for(int i=0; i<tileMap.slotNum; i++)
+	{
+		TILEMAPCHUNK *chunk = &tileMap.slot[i];
+		if(chunk->ready)
+		{
+			stats->residentNum++;
+		}
+		else if(chunk->state == TILEMAP_LOADING)
+		{
+			stats->loadingNum++;
+		}
+	}
+}
+
+/**
+* @fn TileMap_GenerateArea
+* @brief 読み込みとは関係なく、指定の範囲の迷路を生成する
+* @param[in] unsigned int seed, int x, int z 左下のマス, int width, int height
+* @param[out] BYTE *map マスの値( z * width + x の順、世界の外は 0 )
+* @details チャンクを置く場所を使わないので、メモリの上限より広い範囲の迷路も作れる
+*/
+void TileMap_GenerateArea(unsigned int seed, int x, int z, int width, int height, BYTE *map)
+{
+	BYTE cell[TILEMAP_CHUNKBYTES];
+	memset(map, 0, width * height);
+
+	int worldSize = TileMap_GetWorldSize();
+	int minX = x > 0 ? x : 0;
+	int minZ = z > 0 ? z : 0;
+	int maxX = x + width < worldSize ? x + width : worldSize;
+	int maxZ = z + height < worldSize ? z + height : worldSize;
+	for(int chunkZ=minZ / TILEMAP_CHUNKSIZE; chunkZ * TILEMAP_CHUNKSIZE < maxZ; chunkZ++)
+	{
+		for(int chunkX=minX / TILEMAP_CHUNKSIZE; chunkX * TILEMAP_CHUNKSIZE < maxX; chunkX++)
+		{
+			TileMap_Generate(cell, seed, chunkX, chunkZ);
+
+			// チャンクのうち範囲と重なる部分を書き写す
+			for(int localZ=0; localZ<TILEMAP_CHUNKSIZE; localZ++)
+			{
+				int mapZ = chunkZ * TILEMAP_CHUNKSIZE + localZ - z;
+				if(mapZ < 0 || mapZ >= height)
+				{
+					continue;
+				}
+				for(int localX=0; localX<TILEMAP_CHUNKSIZE; localX++)
+				{
+					int mapX = chunkX * TILEMAP_CHUNKSIZE + localX - x;
+					if(mapX >= 0 && mapX < width)
+					{
+						map[mapZ * width + mapX] = (BYTE)TileMap_GetChunkCell(cell, localX, localZ);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int TILEMAP_CHUNKSIZE = 64;				//!< チャンク１つの一辺のマスの数( 偶数 )
+const int TILEMAP_CHUNKBYTES = TILEMAP_CHUNKSIZE * TILEMAP_CHUNKSIZE / 4;	//!< チャンク１つのマスの情報のバイト数( １マス２ビット )
+const int TILEMAP_WORLDCHUNK = 64;				//!< 世界全体の一辺のチャンクの数
+const int TILEMAP_MEMORYBUDGET = 64 * 1024;		//!< 読み込んでおくチャンクのマスの情報に使うメモリの上限( バイト )
+const int TILEMAP_LOADRADIUS = 1;				//!< プレイヤーのいるチャンクから何チャンク先まで読み込んでおくか
+const int TILEMAP_QUEUESIZE = 32;				//!< 読み込みの依頼のキューの大きさ
+
+/**
+* @struct TILEMAP_STATS
+* @brief チャンクの読み込みの統計情報
+*/
+struct TILEMAP_STATS
+{
+	int slotNum;							//!< メモリの上限から決めたチャンクを置ける数
+	int residentNum;						//!< 読み込み済みのチャンクの数
+	int loadingNum;							//!< 読み込み中のチャンクの数
+	int editNum;							//!< 書き換えたマスの数( 捨てたチャンクを読み込み直した時に反映する )
+	int loadNum;							//!< これまでに読み込んだチャンクの数
+	int evictNum;							//!< これまでに捨てたチャンクの数
+	LONGLONG generateTimeMax;				//!< チャンク１つの生成にかかった最大時間( マイクロ秒 )
+};
+
+bool TileMap_Initialize(unsigned int seed);		//!< 迷路の種を指定してチャンクの管理と読み込み用のスレッドを開始する( 戻り値  true:成功  false:失敗 )
+void TileMap_Terminate(void);					//!< チャンクの管理と読み込み用のスレッドの後始末
+void TileMap_Update(int x, int z);				//!< プレイヤーの周りのチャンクの読み込みを依頼し、遠いチャンクを捨てる( 毎フレームメインスレッドで呼ぶ )
+void TileMap_WaitLoaded(int x, int z);			//!< 指定のマスを含むチャンクの読み込みが終わるまで待つ
+bool TileMap_IsLoaded(int x, int z);			//!< 指定のマスを含むチャンクが読み込み済みかどうか( 世界の外は常に true )
+int TileMap_GetCell(int x, int z);				//!< マスの値を取得する( 0:壁  1:道  2:スイッチ、世界の外と読み込まれていないチャンクは 0 )
+void TileMap_SetCell(int x, int z, int value);	//!< マスの値を書き換える( 書き換えは記録しておき、チャンクを読み込み直しても残る )
+int TileMap_GetWorldSize(void);					//!< 世界全体の一辺のマスの数を取得する
+void TileMap_GetStats(TILEMAP_STATS *stats);	//!< 統計情報を取得する
+void TileMap_GenerateArea(unsigned int seed, int x, int z, int width, int height, BYTE *map);	//!< 読み込みとは関係なく、指定の範囲の迷路を生成する
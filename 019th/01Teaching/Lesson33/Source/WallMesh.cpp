@@ -0,0 +1,408 @@
+﻿#include "WallMesh.h"
+#include "TileMap.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson33
+* @author N.Yamada
+* @date 2023/01/03
+*
+* @details 迷路の壁をチャンクごとに１つの頂点バッファにまとめて描画する
+*          壁モデルの１６通りのフレームのポリゴンを最初に取り出しておき、チャンク内の全ての道のマスについて
+*          ４方の壁の状態で決まるフレームのポリゴンをマスの位置にずらして並べる
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @struct WALLMESHFRAME
+* @brief 壁モデルのフレーム１つ分のポリゴン
+*/
+struct WALLMESHFRAME
+{
+	VERTEX3D *vertex;						//!< 頂点の配列
+	int vertexNum;							//!< 頂点の数
+	int *index;								//!< ポリゴンの頂点番号の配列( ポリゴン数×３ )
+	int polygonNum;							//!< ポリゴンの数
+};
+
+/**
+* @struct WALLMESHCHUNK
+* @brief チャンク１つ分の壁の頂点バッファ
+*/
+struct WALLMESHCHUNK
+{
+	bool active;							//!< 使用中かどうか
+	int chunkX;								//!< チャンクのＸ方向の番号
+	int chunkZ;								//!< チャンクのＺ方向の番号
+	int neighborMask;						//!< 作った時に読み込み済みだった東西南北のチャンク( ビット )
+	int vertexBuffer;						//!< 頂点バッファのハンドル
+	int indexBuffer;						//!< インデックスバッファのハンドル
+	int polygonNum;							//!< ポリゴンの数
+	int lastUseFrame;						//!< 最後に描画したフレーム
+};
+
+/**
+* @struct WALLMESHINFO
+* @brief 壁の描画の情報
+*/
+struct WALLMESHINFO
+{
+	WALLMESHFRAME frame[WALLMESH_FRAMENUM];	//!< 壁モデルの各フレームのポリゴン
+	int textureHandle;						//!< 壁のテクスチャのグラフィックハンドル
+	MATERIALPARAM material;					//!< 壁モデルのマテリアル( MV1DrawFrame で描画していた時と同じ色にする )
+	float blockSize;						//!< マス１つのサイズ
+	VERTEX3D *bakeVertex;					//!< チャンクの頂点を並べる作業用の配列
+	unsigned int *bakeIndex;				//!< チャンクの頂点番号を並べる作業用の配列
+	WALLMESHCHUNK chunk[WALLMESH_CACHENUM];	//!< チャンクの頂点バッファ
+	int frameCount;							//!< WallMesh_Draw を呼んだ回数
+	WALLMESH_STATS stats;					//!< 統計情報
+};
+
+static WALLMESHINFO wallMesh;					//!< 壁の描画の実体
+
+/**
+* @fn WallMesh_GetNeighborMask
+* @brief 東西南北のチャンクのうち読み込み済みのものを求める
+* @param[in] int chunkX, int chunkZ
+* @return int 読み込み済みのチャンク( 1:東  2:西  4:北  8:南 )
+* @details 隣のチャンクが読み込まれていないと境界のマスが壁として扱われるので、後で作り直す為に覚えておく
+*/
+static int WallMesh_GetNeighborMask(int chunkX, int chunkZ)
+{
+	int x = chunkX * TILEMAP_CHUNKSIZE;
+	int z = chunkZ * TILEMAP_CHUNKSIZE;
+	int mask = 0;
+	if(TileMap_IsLoaded(x + TILEMAP_CHUNKSIZE, z))
+	{
+		mask += 1;
+	}
+	if(TileMap_IsLoaded(x - 1, z))
+	{
+		mask += 2;
+	}
+	if(TileMap_IsLoaded(x, z + TILEMAP_CHUNKSIZE))
+	{
+		mask += 4;
+	}
+	if(TileMap_IsLoaded(x, z - 1))
+	{
+		mask += 8;
+	}
+	return mask;
+}
+
+/**
+* @fn WallMesh_Bake
+* @brief チャンク内の全ての道のマスの壁を１つの頂点バッファにまとめる
+* @param[in] WALLMESHCHUNK *chunk
+* @details フレーム番号の求め方は MV1DrawFrame で描画していた時と同じ
+*/
+static void WallMesh_Bake(WALLMESHCHUNK *chunk)
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+	int vertexNum = 0;
+	int polygonNum = 0;
+	for(int z=0; z<TILEMAP_CHUNKSIZE; z++)
+	{
+		for(int x=0; x<TILEMAP_CHUNKSIZE; x++)
+		{
+			int i = chunk->chunkZ * TILEMAP_CHUNKSIZE + z;
+			int j = chunk->chunkX * TILEMAP_CHUNKSIZE + x;
+
+			// 道ではないところは描画しない
+			if(TileMap_GetCell(j, i) == 0)
+			{
+				continue;
+			}
+
+			// ４方の壁の状態で使うフレーム番号を変更する
+			int frameNo = 0;
+			if(TileMap_GetCell(j + 1, i) == 0)
+			{
+				frameNo += 1;
+			}
+			if(TileMap_GetCell(j - 1, i) == 0)
+			{
+				frameNo += 2;
+			}
+			if(TileMap_GetCell(j, i + 1) == 0)
+			{
+				frameNo += 4;
+			}
+			if(TileMap_GetCell(j, i - 1) == 0)
+			{
+				frameNo += 8;
+			}
+
+			// フレームのポリゴンをマスの位置にずらして追加する
+			WALLMESHFRAME *frame = &wallMesh.frame[frameNo];
+			VECTOR offset = VGet(j * wallMesh.blockSize, 0.0f, i * wallMesh.blockSize);
+			for(int k=0; k<frame->polygonNum * 3; k++)
+			{
+				wallMesh.bakeIndex[polygonNum * 3 + k] = (unsigned int)(vertexNum + frame->index[k]);
+			}
+			for(int k=0; k<frame->vertexNum; k++)
+			{
+				wallMesh.bakeVertex[vertexNum + k] = frame->vertex[k];
+				wallMesh.bakeVertex[vertexNum + k].pos = VAdd(frame->vertex[k].pos, offset);
+			}
+			vertexNum += frame->vertexNum;
+			polygonNum += frame->polygonNum;
+		}
+	}
+
+	// 頂点バッファを作り直す
+	if(chunk->vertexBuffer != -1)
+	{
+		DeleteVertexBuffer(chunk->vertexBuffer);
+		DeleteIndexBuffer(chunk->indexBuffer);
+		chunk->vertexBuffer = -1;
+		chunk->indexBuffer = -1;
+	}
+	chunk->polygonNum = polygonNum;
+	if(polygonNum > 0)
+	{
+		chunk->vertexBuffer = CreateVertexBuffer(vertexNum, DX_VERTEX_TYPE_NORMAL_3D);
+		chunk->indexBuffer = CreateIndexBuffer(polygonNum * 3, DX_INDEX_TYPE_32BIT);
+		SetVertexBufferData(0, wallMesh.bakeVertex, vertexNum, chunk->vertexBuffer);
+		SetIndexBufferData(0, wallMesh.bakeIndex, polygonNum * 3, chunk->indexBuffer);
+	}
+
+	wallMesh.stats.bakeNum++;
+	LONGLONG bakeTime = GetNowHiPerformanceCount() - startTime;
+	if(bakeTime > wallMesh.stats.bakeTimeMax)
+	{
+		wallMesh.stats.bakeTimeMax = bakeTime;
+	}
+}
+
+/**
+* @fn WallMesh_GetChunk
+* @brief 指定のチャンクの頂点バッファを取得する、無いか古くなっている場合は作る
+* @param[in] int chunkX, int chunkZ
+* @return WALLMESHCHUNK* 頂点バッファ( NULL:チャンクが読み込まれていない )
+* @details 空きが無い場合は最も長く描画していないチャンクの頂点バッファを使い回す
+*/
+static WALLMESHCHUNK *WallMesh_GetChunk(int chunkX, int chunkZ)
+{
+	if(!TileMap_IsLoaded(chunkX * TILEMAP_CHUNKSIZE, chunkZ * TILEMAP_CHUNKSIZE))
+	{
+		return NULL;
+	}
+
+	int neighborMask = WallMesh_GetNeighborMask(chunkX, chunkZ);
+	WALLMESHCHUNK *chunk = NULL;
+	for(int i=0; i<WALLMESH_CACHENUM; i++)
+	{
+		if(wallMesh.chunk[i].active && wallMesh.chunk[i].chunkX == chunkX && wallMesh.chunk[i].chunkZ == chunkZ)
+		{
+			chunk = &wallMesh.chunk[i];
+			break;
+		}
+	}
+
+	if(chunk == NULL)
+	{
+		for(int i=0; i<WALLMESH_CACHENUM; i++)
+		{
+			if(wallMesh.chunk[i].active == false)
+			{
+				chunk = &wallMesh.chunk[i];
+				break;
+			}
+			if(chunk == NULL || wallMesh.chunk[i].lastUseFrame < chunk->lastUseFrame)
+			{
+				chunk = &wallMesh.chunk[i];
+			}
+		}
+		chunk->active = true;
+		chunk->chunkX = chunkX;
+		chunk->chunkZ = chunkZ;
+		chunk->neighborMask = neighborMask;
+		WallMesh_Bake(chunk);
+	}
+	else if(chunk->neighborMask != neighborMask)
+	{
+		// 作った後に隣のチャンクが読み込まれたので、境界の壁を作り直す
+		chunk->neighborMask = neighborMask;
+		WallMesh_Bake(chunk);
+	}
+
+	chunk->lastUseFrame = wallMesh.frameCount;
+	return chunk;
+}
+
+/**
+* @fn WallMesh_Initialize
+* @brief 壁モデルの各フレームのポリゴンを取り出す
+* @param[in] int modelHandle 壁モデル( フレーム番号が４方の壁の有無の組み合わせになっているもの ), float blockSize マス１つのサイズ
+* @return bool true:成功  false:失敗
+*/
+bool WallMesh_Initialize(int modelHandle, float blockSize)
+{
+	memset(&wallMesh, 0, sizeof(wallMesh));
+	wallMesh.blockSize = blockSize;
+
+	// 壁モデルのマテリアルは１つなので、最初のマテリアルの色とテクスチャを使う
+	int textureIndex = MV1GetMaterialDifMapTexture(modelHandle, 0);
+	wallMesh.textureHandle = MV1GetTextureGraphHandle(modelHandle, textureIndex >= 0 ? textureIndex : 0);
+	wallMesh.material.Diffuse = MV1GetMaterialDifColor(modelHandle, 0);
+	wallMesh.material.Ambient = MV1GetMaterialAmbColor(modelHandle, 0);
+	wallMesh.material.Specular = MV1GetMaterialSpcColor(modelHandle, 0);
+	wallMesh.material.Emissive = MV1GetMaterialEmiColor(modelHandle, 0);
+	wallMesh.material.Power = MV1GetMaterialSpcPower(modelHandle, 0);
+
+	int vertexMax = 0;
+	int polygonMax = 0;
+	for(int i=0; i<WALLMESH_FRAMENUM; i++)
+	{
+		MV1SetupReferenceMesh(modelHandle, i, FALSE);
+		MV1_REF_POLYGONLIST refMesh = MV1GetReferenceMesh(modelHandle, i, FALSE);
+
+		WALLMESHFRAME *frame = &wallMesh.frame[i];
+		frame->vertexNum = refMesh.VertexNum;
+		frame->polygonNum = refMesh.PolygonNum;
+		frame->vertex = (VERTEX3D *)malloc(sizeof(VERTEX3D) * (refMesh.VertexNum > 0 ? refMesh.VertexNum : 1));
+		frame->index = (int *)malloc(sizeof(int) * (refMesh.PolygonNum > 0 ? refMesh.PolygonNum * 3 : 1));
+		for(int k=0; k<refMesh.VertexNum; k++)
+		{
+			MV1_REF_VERTEX *refVertex = &refMesh.Vertexs[k];
+			frame->vertex[k].pos = refVertex->Position;
+			frame->vertex[k].norm = refVertex->Normal;
+			frame->vertex[k].dif = refVertex->DiffuseColor;
+			frame->vertex[k].spc = refVertex->SpecularColor;
+			frame->vertex[k].u = refVertex->TexCoord[0].u;
+			frame->vertex[k].v = refVertex->TexCoord[0].v;
+			frame->vertex[k].su = 0.0f;
+			frame->vertex[k].sv = 0.0f;
+		}
+		for(int k=0; k<refMesh.PolygonNum; k++)
+		{
+			frame->index[k * 3 + 0] = refMesh.Polygons[k].VIndex[0];
+			frame->index[k * 3 + 1] = refMesh.Polygons[k].VIndex[1];
+			frame->index[k * 3 + 2] = refMesh.Polygons[k].VIndex[2];
+		}
+		MV1TerminateReferenceMesh(modelHandle, i, FALSE);
+
+		vertexMax = frame->vertexNum > vertexMax ? frame->vertexNum : vertexMax;
+		polygonMax = frame->polygonNum > polygonMax ? frame->polygonNum : polygonMax;
+	}
+
+	// チャンクの全マスが最も多いフレームだった場合でも入る大きさを確保しておく
+	int cellNum = TILEMAP_CHUNKSIZE * TILEMAP_CHUNKSIZE;
+	wallMesh.bakeVertex = (VERTEX3D *)malloc(sizeof(VERTEX3D) * (cellNum * vertexMax > 0 ? cellNum * vertexMax : 1));
+	wallMesh.bakeIndex = (unsigned int *)malloc(sizeof(unsigned int) * (cellNum * polygonMax * 3 > 0 ? cellNum * polygonMax * 3 : 1));
+	if(wallMesh.bakeVertex == NULL || wallMesh.bakeIndex == NULL)
+	{
+		WallMesh_Terminate();
+		return false;
+	}
+
+	for(int i=0; i<WALLMESH_CACHENUM; i++)
+	{
+		wallMesh.chunk[i].active = false;
+		wallMesh.chunk[i].vertexBuffer = -1;
+		wallMesh.chunk[i].indexBuffer = -1;
+	}
+	return true;
+}
+
+/**
+* @fn WallMesh_Terminate
+* @brief 取り出したポリゴンとチャンクの頂点バッファの後始末
+*/
+void WallMesh_Terminate()
+{
+	for(int i=0; i<WALLMESH_CACHENUM; i++)
+	{
+		if(wallMesh.chunk[i].vertexBuffer != -1)
+		{
+			DeleteVertexBuffer(wallMesh.chunk[i].vertexBuffer);
+			DeleteIndexBuffer(wallMesh.chunk[i].indexBuffer);
+			wallMesh.chunk[i].vertexBuffer = -1;
+			wallMesh.chunk[i].indexBuffer = -1;
+		}
+		wallMesh.chunk[i].active = false;
+	}
+	for(int i=0; i<WALLMESH_FRAMENUM; i++)
+	{
+		free(wallMesh.frame[i].vertex);
+		free(wallMesh.frame[i].index);
+		wallMesh.frame[i].vertex = NULL;
+		wallMesh.frame[i].index = NULL;
+	}
+	free(wallMesh.bakeVertex);
+	free(wallMesh.bakeIndex);
+	wallMesh.bakeVertex = NULL;
+	wallMesh.bakeIndex = NULL;
+}
+
+/**
+* @fn WallMesh_Draw
+* @brief 指定のマスを含むチャンクの壁をチャンクごとにまとめて描画する
+* @param[in] const int *cellX, const int *cellZ 見えるマスの座標の一覧, int cellNum マスの数
+* @return int 描画したチャンクの数
+* @details 見えるマスの壁だけでなく、そのマスを含むチャンクの壁を全て１回の描画で描く
+*          DrawPolygonIndexed3D_UseVertexBuffer はモデルのマテリアルを使わないので、描画前に設定しておく
+*/
+int WallMesh_Draw(const int *cellX, const int *cellZ, int cellNum)
+{
+	wallMesh.frameCount++;
+	wallMesh.stats.drawChunkNum = 0;
+	wallMesh.stats.drawPolygonNum = 0;
+
+	// 見えるマスを含むチャンクを重複しないように集める
+	int drawX[WALLMESH_DRAWMAX];
+	int drawZ[WALLMESH_DRAWMAX];
+	int drawNum = 0;
+	for(int i=0; i<cellNum; i++)
+	{
+		int chunkX = cellX[i] / TILEMAP_CHUNKSIZE;
+		int chunkZ = cellZ[i] / TILEMAP_CHUNKSIZE;
+		bool found = false;
+		for(int j=0; j<drawNum; j++)
+		{
+			if(drawX[j] == chunkX && drawZ[j] == chunkZ)
+			{
+				found = true;
+				break;
+			}
+		}
+		if(!found && drawNum < WALLMESH_DRAWMAX)
+		{
+			drawX[drawNum] = chunkX;
+			drawZ[drawNum] = chunkZ;
+			drawNum++;
+		}
+	}
+
+	// 頂点の色ではなくモデルのマテリアルの色で描画する( 描画後は頂点の色を使う既定の設定に戻す )
+	SetMaterialParam(wallMesh.material);
+	SetMaterialUseVertDifColor(FALSE);
+	SetMaterialUseVertSpcColor(FALSE);
+	for(int i=0; i<drawNum; i++)
+	{
+		WALLMESHCHUNK *chunk = WallMesh_GetChunk(drawX[i], drawZ[i]);
+		if(chunk == NULL || chunk->polygonNum == 0)
+		{
+			continue;
+		}
+		DrawPolygonIndexed3D_UseVertexBuffer(chunk->vertexBuffer, chunk->indexBuffer, wallMesh.textureHandle, FALSE);
+		wallMesh.stats.drawChunkNum++;
+		wallMesh.stats.drawPolygonNum += chunk->polygonNum;
+	}
+	SetMaterialUseVertDifColor(TRUE);
+	SetMaterialUseVertSpcColor(TRUE);
+	return wallMesh.stats.drawChunkNum;
+}
+
+/**
+* @fn WallMesh_GetStats
+* @brief 統計情報を取得する
+* @param[out] WALLMESH_STATS *stats
+*/
+void WallMesh_GetStats(WALLMESH_STATS *stats)
+{
+	*stats = wallMesh.stats;
+}
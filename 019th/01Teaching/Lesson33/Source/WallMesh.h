@@ -0,0 +1,23 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int WALLMESH_FRAMENUM = 16;				//!< 壁モデルのフレームの数( ４方の壁の有無の組み合わせ )
+const int WALLMESH_CACHENUM = 16;				//!< 頂点バッファを作っておくチャンクの最大数
+const int WALLMESH_DRAWMAX = 16;				//!< １フレームに描画するチャンクの最大数
+
+/**
+* @struct WALLMESH_STATS
+* @brief 壁の描画の統計情報
+*/
+struct WALLMESH_STATS
+{
+	int drawChunkNum;						//!< 最後の描画で描画したチャンクの数( 描画回数 )
+	int drawPolygonNum;						//!< 最後の描画で描画したポリゴンの数
+	int bakeNum;							//!< これまでにチャンクの頂点バッファを作った回数
+	LONGLONG bakeTimeMax;					//!< チャンク１つの頂点バッファを作るのにかかった最大時間( マイクロ秒 )
+};
+
+bool WallMesh_Initialize(int modelHandle, float blockSize);	//!< 壁モデルの各フレームのポリゴンを取り出す( 戻り値  true:成功  false:失敗 )
+void WallMesh_Terminate(void);					//!< 取り出したポリゴンとチャンクの頂点バッファの後始末
+int WallMesh_Draw(const int *cellX, const int *cellZ, int cellNum);	//!< 指定のマスを含むチャンクの壁をチャンクごとにまとめて描画する( 戻り値 : 描画したチャンクの数 )
+void WallMesh_GetStats(WALLMESH_STATS *stats);	//!< 統計情報を取得する
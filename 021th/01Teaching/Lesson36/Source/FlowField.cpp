@@ -0,0 +1,383 @@
+﻿#include "FlowField.h"
+#include "PolyLink.h"
+#include "NavTile.h"
+#include <malloc.h>
+#include <float.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 同じゴールを目指す多数のエージェント用のフローフィールド
+*          ゴールのポリゴンから全ポリゴンへの最短距離を一度だけ求め、各ポリゴンに次に進むポリゴンを保存しておく
+*          障害物で通れないポリゴンからは辿らないので、通れないポリゴンを経由する経路はできない
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+static const float FLOWFIELD_REBUILDOFFSET = 30000.0f;	//!< 差分更新で距離の基準値がこれを超えたら作り直す( 浮動小数点の誤差の蓄積を防ぐ )
+
+/**
+* @fn FlowField_SetTargetPosition
+* @brief 指定のポリゴンから次に進むポリゴンとの境界の辺の中点を求める
+* @param[in] FLOWFIELD *flow, int polyIndex
+*/
+static void FlowField_SetTargetPosition(FLOWFIELD *flow, int polyIndex)
+{
+	int nextPolyIndex = flow->nextPolyIndex[polyIndex];
+	if(nextPolyIndex == -1)
+	{
+		flow->targetPosition[polyIndex] = flow->goalPosition;
+		return;
+	}
+
+	// 次のポリゴンと隣接している辺を探す
+	int edge;
+	for(edge=0; edge<2; edge++)
+	{
+		if(polyLinkInfo[polyIndex].linkPolyIndex[edge] == nextPolyIndex)
+		{
+			break;
+		}
+	}
+	MV1_REF_POLYGON *refPoly = &polyList.Polygons[polyIndex];
+	VECTOR edgePos1 = polyList.Vertexs[refPoly->VIndex[edge]].Position;
+	VECTOR edgePos2 = polyList.Vertexs[refPoly->VIndex[(edge + 1) % 3]].Position;
+	flow->targetPosition[polyIndex] = VScale(VAdd(edgePos1, edgePos2), 0.5f);
+}
+
+/**
+* @fn FlowField_Propagate
+* @brief ヒープに登録されたポリゴンから距離が短くなるポリゴンだけを辿って距離と次に進むポリゴンを更新する
+* @param[in] FLOWFIELD *flow
+*/
+static void FlowField_Propagate(FLOWFIELD *flow)
+{
+	int polyIndex;
+	float key;
+	while(PathHeap_Pop(&flow->heap, &polyIndex, &key))
+	{
+		// 既により短い距離で処理済みの場合は何もしない
+		if(key > flow->distance[polyIndex])
+		{
+			continue;
+		}
+		flow->updatePolyNum++;
+
+		// 障害物で通れないポリゴンは経由できないので、ゴールのポリゴン以外はここから先に辿らない
+		if(polyIndex != flow->goalPolyIndex && NavTile_IsPolyBlocked(polyIndex))
+		{
+			continue;
+		}
+
+		// ポリゴンの辺の数だけ繰り返し
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = pLInfo->linkPolyIndex[i];
+			if(linkPolyIndex == -1)
+			{
+				continue;
+			}
+
+			// 今の距離より短くならない場合は何もしない
+			float newDistance = flow->distance[polyIndex] + pLInfo->linkPolyDistance[i];
+			if(newDistance >= flow->distance[linkPolyIndex])
+			{
+				continue;
+			}
+
+			// 隣接ポリゴンはこのポリゴンを経由してゴールに向かう
+			flow->distance[linkPolyIndex] = newDistance;
+			flow->nextPolyIndex[linkPolyIndex] = polyIndex;
+			FlowField_SetTargetPosition(flow, linkPolyIndex);
+			PathHeap_Push(&flow->heap, linkPolyIndex, newDistance);
+		}
+	}
+}
+
+/**
+* @fn FlowField_Build
+* @brief 指定のゴールのポリゴンから全ポリゴンへの最短距離を求め直す
+* @param[in] FLOWFIELD *flow, int goalPolyIndex
+*/
+static void FlowField_Build(FLOWFIELD *flow, int goalPolyIndex)
+{
+	// 全ポリゴンを辿り着けない状態にする
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		flow->distance[i] = FLT_MAX;
+		flow->nextPolyIndex[i] = -1;
+	}
+	flow->distanceOffset = 0.0f;
+	flow->navSerial = NavTile_GetSerial();
+
+	// ゴールのポリゴンから辿る
+	flow->goalPolyIndex = goalPolyIndex;
+	flow->distance[goalPolyIndex] = 0.0f;
+	flow->targetPosition[goalPolyIndex] = flow->goalPosition;
+	flow->updatePolyNum = 0;
+	flow->incrementalUpdate = false;
+	PathHeap_Clear(&flow->heap);
+	PathHeap_Push(&flow->heap, goalPolyIndex, 0.0f);
+	FlowField_Propagate(flow);
+}
+
+/**
+* @fn FlowField_MoveGoal
+* @brief ゴールが隣接するポリゴンに移動した時に、距離が短くなるポリゴンだけを更新する
+* @param[in] FLOWFIELD *flow, int goalPolyIndex 新しいゴールのポリゴン番号, float linkDistance 前のゴールのポリゴンとの距離
+* @details 全ポリゴンの距離に linkDistance を足したもの( 前のゴールを経由して新しいゴールに向かう )は必ず辿れる経路の長さなので、
+*          それより短くなるポリゴンだけを新しいゴールから辿れば最短距離になる
+*          全ポリゴンに足す代わりに基準値の distanceOffset を増やし、新しいゴールの距離は -distanceOffset で表す
+*/
+static void FlowField_MoveGoal(FLOWFIELD *flow, int goalPolyIndex, float linkDistance)
+{
+	int prevGoalPolyIndex = flow->goalPolyIndex;
+	flow->distanceOffset += linkDistance;
+
+	// 前のゴールは新しいゴールに向かう
+	flow->goalPolyIndex = goalPolyIndex;
+	flow->nextPolyIndex[prevGoalPolyIndex] = goalPolyIndex;
+	FlowField_SetTargetPosition(flow, prevGoalPolyIndex);
+
+	// 新しいゴールから距離が短くなるポリゴンを辿る
+	flow->distance[goalPolyIndex] = -flow->distanceOffset;
+	flow->nextPolyIndex[goalPolyIndex] = -1;
+	flow->targetPosition[goalPolyIndex] = flow->goalPosition;
+	flow->updatePolyNum = 0;
+	flow->incrementalUpdate = true;
+	PathHeap_Clear(&flow->heap);
+	PathHeap_Push(&flow->heap, goalPolyIndex, flow->distance[goalPolyIndex]);
+	FlowField_Propagate(flow);
+}
+
+/**
+* @fn FlowField_Initialize
+* @brief フローフィールドの初期化
+* @param[out] FLOWFIELD *flow
+* @details ステージモデルのポリゴン情報と連結情報を構築した後に呼ぶ
+*/
+void FlowField_Initialize(FLOWFIELD *flow)
+{
+	flow->distance = (float *)malloc(sizeof(float) * polyList.PolygonNum);
+	flow->nextPolyIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	flow->targetPosition = (VECTOR *)malloc(sizeof(VECTOR) * polyList.PolygonNum);
+	flow->goalPolyIndex = -1;
+	flow->goalPosition = VGet(0.0f, 0.0f, 0.0f);
+	flow->distanceOffset = 0.0f;
+	flow->navSerial = 0;
+	PathHeap_Initialize(&flow->heap, polyList.PolygonNum);
+	flow->updatePolyNum = 0;
+	flow->incrementalUpdate = false;
+}
+
+/**
+* @fn FlowField_Terminate
+* @brief フローフィールドの後始末
+* @param[in] FLOWFIELD *flow
+*/
+void FlowField_Terminate(FLOWFIELD *flow)
+{
+	PathHeap_Terminate(&flow->heap);
+	free(flow->targetPosition);
+	free(flow->nextPolyIndex);
+	free(flow->distance);
+	flow->targetPosition = NULL;
+	flow->nextPolyIndex = NULL;
+	flow->distance = NULL;
+}
+
+/**
+* @fn FlowField_SetGoal
+* @brief ゴールを設定してフローフィールドを更新する
+* @param[in] FLOWFIELD *flow, VECTOR goalPos
+* @return int ゴールのポリゴン番号( ゴールの下にポリゴンが無い場合は -1 を返し、フローフィールドは更新しない )
+* @details ゴールのポリゴンが変わらなければゴール座標だけ、隣接するポリゴンに移動した場合は差分だけを更新する
+*          前回作り直した後にタイルが切り替わっていたら、通れないポリゴンが変わっているので全て作り直す
+*/
+int FlowField_SetGoal(FLOWFIELD *flow, VECTOR goalPos)
+{
+	int goalPolyIndex = CheckOnPolyIndexNear(goalPos, flow->goalPolyIndex);
+	if(goalPolyIndex == -1)
+	{
+		return -1;
+	}
+	flow->goalPosition = goalPos;
+
+	// 障害物が変わっていたら全て作り直す
+	if(flow->navSerial != NavTile_GetSerial())
+	{
+		FlowField_Build(flow, goalPolyIndex);
+		return goalPolyIndex;
+	}
+
+	// 同じポリゴンの中での移動ならゴール座標を差し替えるだけ
+	if(goalPolyIndex == flow->goalPolyIndex)
+	{
+		flow->targetPosition[goalPolyIndex] = goalPos;
+		flow->updatePolyNum = 0;
+		flow->incrementalUpdate = true;
+		return goalPolyIndex;
+	}
+
+	// 前のゴールのポリゴンに隣接するポリゴンへの移動なら差分だけを更新する( 前のゴールが通れないポリゴンの場合は経由できないので作り直す )
+	if(flow->goalPolyIndex != -1 && NavTile_IsPolyBlocked(flow->goalPolyIndex) == false)
+	{
+		POLYLINKINFO *pLInfo = &polyLinkInfo[flow->goalPolyIndex];
+		for(int i=0; i<3; i++)
+		{
+			if(pLInfo->linkPolyIndex[i] == goalPolyIndex && flow->distanceOffset + pLInfo->linkPolyDistance[i] < FLOWFIELD_REBUILDOFFSET)
+			{
+				FlowField_MoveGoal(flow, goalPolyIndex, pLInfo->linkPolyDistance[i]);
+				return goalPolyIndex;
+			}
+		}
+	}
+
+	// それ以外は全て作り直す
+	FlowField_Build(flow, goalPolyIndex);
+	return goalPolyIndex;
+}
+
+/**
+* @fn FlowField_GetTarget
+* @brief 指定のポリゴンから次に向かう座標を取得する
+* @param[in] const FLOWFIELD *flow, int polyIndex
+* @param[out] VECTOR *targetPos 次に進むポリゴンとの境界の辺の中点( ゴールのポリゴンではゴール座標 )
+* @return bool true:取得した  false:ゴールに辿り着けない
+*/
+bool FlowField_GetTarget(const FLOWFIELD *flow, int polyIndex, VECTOR *targetPos)
+{
+	if(polyIndex == -1 || flow->goalPolyIndex == -1 || flow->distance[polyIndex] == FLT_MAX)
+	{
+		return false;
+	}
+
+	*targetPos = flow->targetPosition[polyIndex];
+	return true;
+}
+
+/**
+* @fn FlowField_MoveAgent
+* @brief エージェントをフローフィールドに従って１フレーム分移動する
+* @param[in] const FLOWFIELD *flow, float speed １フレームの移動距離
+* @param[in,out] FLOWAGENT *agent
+* @details 境界の辺の中点に着いたら、残りの移動距離で次のポリゴンの目標に向かう
+*/
+void FlowField_MoveAgent(const FLOWFIELD *flow, FLOWAGENT *agent, float speed)
+{
+	VECTOR targetPos;
+	if(!FlowField_GetTarget(flow, agent->polyIndex, &targetPos))
+	{
+		return;
+	}
+
+	VECTOR moveVec = VSub(targetPos, agent->position);
+	float moveLength = VSize(moveVec);
+	VECTOR newPos;
+	if(moveLength > speed)
+	{
+		newPos = VAdd(agent->position, VScale(moveVec, speed / moveLength));
+	}
+	else
+	{
+		// ゴールに着いたらその場に留まる
+		newPos = targetPos;
+		int nextPolyIndex = flow->nextPolyIndex[agent->polyIndex];
+		if(nextPolyIndex != -1)
+		{
+			VECTOR nextVec = VSub(flow->targetPosition[nextPolyIndex], targetPos);
+			float nextLength = VSize(nextVec);
+			float restLength = speed - moveLength;
+			if(nextLength > restLength)
+			{
+				newPos = VAdd(newPos, VScale(nextVec, restLength / nextLength));
+			}
+			else
+			{
+				newPos = flow->targetPosition[nextPolyIndex];
+			}
+		}
+	}
+
+	// 移動先にポリゴンが無いか、障害物で通れないポリゴンに入る場合は移動しない
+	int newPolyIndex = CheckOnPolyIndexNear(newPos, agent->polyIndex);
+	if(newPolyIndex == -1 || (newPolyIndex != agent->polyIndex && NavTile_IsPolyBlocked(newPolyIndex)))
+	{
+		return;
+	}
+	agent->position = newPos;
+	agent->polyIndex = newPolyIndex;
+}
+
+/**
+* @fn FlowField_Benchmark
+* @brief エージェント数を 1 ～ 10000 で変えて１フレームあたりの処理時間を計測する
+* @param[in] int frameNum 計測するフレーム数, float speed エージェントの１フレームの移動距離
+* @param[out] LONGLONG *agentTime 全エージェントの移動の１フレームあたりの平均時間( マイクロ秒、FLOWFIELD_BENCHNUM 個 )
+* @param[out] LONGLONG *updateTime フローフィールドの更新の１フレームあたりの平均時間( マイクロ秒、FLOWFIELD_BENCHNUM 個 )
+* @details ゴールは毎フレーム隣接するポリゴンのどれかに移動させる( 差分更新の計測 )
+*          ゴールとエージェントの初期位置は乱数で決めるので、計測の前に SRand で種を固定すると結果を比較しやすい
+*/
+void FlowField_Benchmark(int frameNum, float speed, LONGLONG *agentTime, LONGLONG *updateTime)
+{
+	FLOWFIELD flow;
+	FlowField_Initialize(&flow);
+
+	int agentNum = 1;
+	for(int n=0; n<FLOWFIELD_BENCHNUM; n++, agentNum *= 10)
+	{
+		agentTime[n] = 0;
+		updateTime[n] = 0;
+		if(polyList.PolygonNum == 0)
+		{
+			continue;
+		}
+
+		// エージェントを適当なポリゴンの中心に配置する
+		FLOWAGENT *agentArray = (FLOWAGENT *)malloc(sizeof(FLOWAGENT) * agentNum);
+		for(int i=0; i<agentNum; i++)
+		{
+			agentArray[i].polyIndex = GetRand(polyList.PolygonNum - 1);
+			agentArray[i].position = polyLinkInfo[agentArray[i].polyIndex].centerPosition;
+		}
+
+		// ゴールも適当なポリゴンの中心から始める
+		int goalPolyIndex = GetRand(polyList.PolygonNum - 1);
+		flow.goalPolyIndex = -1;
+		FlowField_SetGoal(&flow, polyLinkInfo[goalPolyIndex].centerPosition);
+
+		for(int frame=0; frame<frameNum; frame++)
+		{
+			// ゴールを隣接するポリゴンのどれかに移動する
+			int linkPolyIndex = polyLinkInfo[goalPolyIndex].linkPolyIndex[GetRand(2)];
+			if(linkPolyIndex != -1)
+			{
+				goalPolyIndex = linkPolyIndex;
+			}
+
+			LONGLONG startTime = GetNowHiPerformanceCount();
+			FlowField_SetGoal(&flow, polyLinkInfo[goalPolyIndex].centerPosition);
+			LONGLONG moveStartTime = GetNowHiPerformanceCount();
+			for(int i=0; i<agentNum; i++)
+			{
+				FlowField_MoveAgent(&flow, &agentArray[i], speed);
+			}
+			LONGLONG endTime = GetNowHiPerformanceCount();
+
+			updateTime[n] += moveStartTime - startTime;
+			agentTime[n] += endTime - moveStartTime;
+		}
+
+		if(frameNum > 0)
+		{
+			updateTime[n] /= frameNum;
+			agentTime[n] /= frameNum;
+		}
+
+		free(agentArray);
+	}
+
+	FlowField_Terminate(&flow);
+}
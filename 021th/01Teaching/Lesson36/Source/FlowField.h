@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "DxLib.h"
+#include "PathHeap.h"
+
+const int FLOWFIELD_BENCHNUM = 5;				//!< ベンチマークで計測するエージェント数の段階の数( 1, 10, 100, 1000, 10000 )
+
+/**
+* @struct FLOWFIELD
+* @brief 全ポリゴンからゴールへの次の移動先を保存したフローフィールド
+* @details ゴールのポリゴンから一度だけ最短距離を求めておけば、
+*          同じゴールを目指すエージェントはいくつあっても自分が乗っているポリゴンの情報を引くだけで進む方向が分かる
+*          障害物で通れないポリゴンは経由しない( 通れないポリゴンに乗っているエージェントは外に出られる )
+*/
+struct FLOWFIELD
+{
+	float *distance;						//!< ゴールまでの距離から distanceOffset を引いた値( ポリゴン数分、辿り着けない場合は FLT_MAX )
+	int *nextPolyIndex;						//!< ゴールに向かって次に進むポリゴン番号( ポリゴン数分、ゴールのポリゴンと辿り着けない場合は -1 )
+	VECTOR *targetPosition;					//!< 次に進むポリゴンとの境界の辺の中点( ポリゴン数分、ゴールのポリゴンではゴール座標 )
+	int goalPolyIndex;						//!< ゴールのポリゴン番号( -1:未設定 )
+	VECTOR goalPosition;					//!< ゴール座標
+	float distanceOffset;					//!< 差分更新でゴールが移動した分の距離の合計( 全ポリゴンに足す代わりにここに足しておく )
+	int navSerial;							//!< 最後に作り直した時のタイルの切り替えの通し番号( 変わっていたら障害物が変わったので作り直す )
+	PATHHEAP heap;							//!< 最短距離の算出用のヒープ
+	int updatePolyNum;						//!< 直前の更新で距離を設定したポリゴンの数( 統計用 )
+	bool incrementalUpdate;					//!< 直前の更新が差分更新だったかどうか( 統計用 )
+};
+
+/**
+* @struct FLOWAGENT
+* @brief フローフィールドに従って移動するエージェント
+*/
+struct FLOWAGENT
+{
+	VECTOR position;						//!< 現在の座標
+	int polyIndex;							//!< 現在乗っているポリゴン番号
+};
+
+void FlowField_Initialize(FLOWFIELD *flow);				//!< フローフィールドの初期化
+void FlowField_Terminate(FLOWFIELD *flow);				//!< フローフィールドの後始末
+int FlowField_SetGoal(FLOWFIELD *flow, VECTOR goalPos);	//!< ゴールを設定してフローフィールドを更新する( 戻り値 : ゴールのポリゴン番号、ポリゴンが無い場合は -1 )
+bool FlowField_GetTarget(const FLOWFIELD *flow, int polyIndex, VECTOR *targetPos);	//!< 指定のポリゴンから次に向かう座標を取得する( 戻り値  true:取得した  false:ゴールに辿り着けない )
+void FlowField_MoveAgent(const FLOWFIELD *flow, FLOWAGENT *agent, float speed);	//!< エージェントをフローフィールドに従って１フレーム分移動する
+void FlowField_Benchmark(int frameNum, float speed, LONGLONG *agentTime, LONGLONG *updateTime);	//!< エージェント数を 1 ～ 10000 で変えて１フレームあたりの処理時間を計測する
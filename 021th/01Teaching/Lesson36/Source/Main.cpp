@@ -1,5 +1,16 @@
 ﻿#include "DxLib.h"
+#include "PolyLink.h"
+#include "PathCluster.h"
+#include "PathFunnel.h"
+#include "PathService.h"
+#include "FlowField.h"
+#include "PathDStar.h"
+#include "NavMesh.h"
+#include "NavTile.h"
+#include "NavGen.h"
+#include "DebugDraw.h"
 #include <malloc.h>
+#include <string.h>
 /**
 * @file
 * @brief Lesson36
@@ -13,17 +24,24 @@
 const int   MOVESPEED = 20;				//!< 移動速度
 const float SPHERESIZE = 150.0f;			//!< 球体のサイズ
 const float COLLWIDTH = 400.0f;				//!< 当たり判定のサイズ
-
-/**
-* @struct POLYLINKINFO
-* @brief ポリゴン同士の連結情報を保存する為の構造体
-*/
-struct POLYLINKINFO
-{
-	int linkPolyIndex[3];					//!< ポリゴンの三つの辺とそれぞれ隣接しているポリゴンのポリゴン番号( -1：隣接ポリゴン無し  -1以外：ポリゴン番号 )
-	float linkPolyDistance[3];				//!< 隣接しているポリゴンとの距離
-	VECTOR centerPosition;					//!< ポリゴンの中心座標
-};
+const int   POLYGRID_MAXCELLNUM = 256;		//!< ポリゴン検索用格子の一辺あたりの最大マス数
+const int   PATHSERVICE_WORKERNUM = 2;		//!< 経路探索に使用するワーカースレッドの数( 0 の場合はメインスレッドで予算時間内に探索する )
+const int   PATHSERVICE_BUDGET = 2000;		//!< メインスレッドで探索する場合の１フレームの予算時間( マイクロ秒 )
+const int   FLOWAGENT_NUM = 32;				//!< 球体を追いかけるエージェントの数
+const float FLOWAGENT_SPEED = 12.0f;		//!< 球体を追いかけるエージェントの移動速度
+const float FLOWAGENT_SIZE = 60.0f;			//!< 球体を追いかけるエージェントの描画サイズ
+const int   FLOWFIELD_BENCHFRAME = 60;		//!< フローフィールドのベンチマークで計測するフレーム数
+const float CHASER_SPEED = 15.0f;			//!< 差分経路探索で球体を追いかけるものの移動速度
+const int   CHASER_MAXWAYPOINT = 64;		//!< 差分経路探索で球体を追いかけるものが一度に算出する中間地点の最大数
+const float OBSTACLE_RADIUS = 500.0f;		//!< 右クリックで配置する障害物の半径
+const float OBSTACLE_HEIGHT = 600.0f;		//!< 右クリックで配置する障害物の描画上の高さ
+const float OBSTACLE_MOVESPEED = 30.0f;		//!< 方向キーで障害物を動かす速度
+const char *const STAGE_FILEPATH = "Resource/pathPlanning.mqo";	//!< ステージモデルのファイル
+const char *const NAVMESH_FILEPATH = "Resource/pathPlanning.nav";	//!< 事前に構築したナビメッシュファイル( 無いかステージモデルが変わっていたら自動生成し直す )
+const float NAVGEN_AGENTRADIUS = 200.0f;	//!< ナビメッシュを自動生成する時のキャラクターの半径( Lesson37～40 の CHARA_HIT_WIDTH )
+const float NAVGEN_AGENTHEIGHT = 900.0f;	//!< ナビメッシュを自動生成する時のキャラクターの高さ( Lesson37～40 の CHARA_HIT_HEIGHT に上の球の半径を足したもの )
+const int   DEBUGDRAW_LINEMAX = 65536;		//!< 確認用の図形としてためられる線の最大数
+const int   DEBUGDRAW_TRIANGLEMAX = 8192;	//!< 確認用の図形としてためられる三角形の最大数
 
 /**
 * @struct PATHPLANNING_UNIT
@@ -50,6 +68,8 @@ struct PATHPLANNING
 	PATHPLANNING_UNIT *activeFirstUnit;		//!< 経路探索処理対象になっているポリゴン群の最初のポリゴン情報へのメモリアドレスを格納する変数
 	PATHPLANNING_UNIT *startUnit;			//!< 経路のスタート地点にあるポリゴン情報へのメモリアドレスを格納する変数
 	PATHPLANNING_UNIT *goalUnit;			//!< 経路のゴール地点にあるポリゴン情報へのメモリアドレスを格納する変数
+	VECTOR *wayPointArray;					//!< ファネルアルゴリズムで算出した経路上の中間地点( 最後はゴール位置 )の配列が格納されたメモリ領域の先頭メモリアドレスを格納する変数
+	int wayPointNum;						//!< 経路上の中間地点の数
 };
 
 /**
@@ -62,7 +82,7 @@ struct PATHMOVEINFO
 	VECTOR nowPosition;							//!< 現在位置
 	VECTOR moveDirection;						//!< 移動方向
 	PATHPLANNING_UNIT *nowPathPlanningUnit;		//!< 現在乗っているポリゴンの経路探索情報が格納されているメモリアドレスを格納する変数
-	PATHPLANNING_UNIT *targetPathPlanningUnit;	//!< 次の中間地点となる経路上のポリゴンの経路探索情報が格納されているメモリアドレスを格納する変数
+	int targetWayPointIndex;					//!< 次に向かう経路上の中間地点の番号
 };
 
 int stageModelHandle;							//!< ステージモデルハンドル
@@ -71,56 +91,234 @@ MV1_REF_POLYGONLIST polyList;					//!< ステージモデルのポリゴン情
 POLYLINKINFO *polyLinkInfo;						//!< ステージモデルの全ポリゴン分の「ポリゴン同士の連結情報」の配列が格納が格納されたメモリエリアの先頭アドレスを格納する変数
 PATHPLANNING pathPlanning;						//!< 経路探索処理用の構造体
 PATHMOVEINFO pathMove;							//!< 探索した経路を移動する処理に使用する情報を纏めた構造体
-
-
-int CheckOnPolyIndex(VECTOR Pos);				//!< 指定の座標の直下、若しくは直上にあるポリゴンの番号を取得する( ポリゴンが無かった場合は -1 を返す )
+POLYGRID polyGrid;								//!< ポリゴン検索用の格子
+PATHCLUSTER_WORK pathClusterWork;				//!< 階層的経路探索の作業用の情報
+bool usePathCluster = true;						//!< 階層的経路探索を使用するかどうか
+int pathRequestTicket = -1;						//!< 最後に要求した経路探索の番号
+PATHRESULT pathResult;							//!< 経路探索サービスから受け取った結果
+PATHRESULT movePathResult;						//!< 現在移動している経路の結果( 障害物で無効になっていないかの確認用 )
+bool movePathCheck = false;						//!< movePathResult を確認するかどうか
+int lastObstacleIndex = -1;						//!< 最後に配置した障害物の番号
+FLOWFIELD flowField;							//!< 移動中の球体をゴールにしたフローフィールド
+FLOWAGENT flowAgent[FLOWAGENT_NUM];				//!< 球体を追いかけるエージェント
+LONGLONG flowBenchAgentTime[FLOWFIELD_BENCHNUM];	//!< フローフィールドのベンチマークのエージェントの移動時間
+LONGLONG flowBenchUpdateTime[FLOWFIELD_BENCHNUM];	//!< フローフィールドのベンチマークの更新時間
+bool flowBenchDone = false;						//!< フローフィールドのベンチマークを実行したかどうか
+PATHDSTAR chaserDStar;							//!< 球体を追いかけるものの差分経路探索の情報
+VECTOR chaserPosition;							//!< 球体を追いかけるものの現在位置
+VECTOR chaserWayPoint[CHASER_MAXWAYPOINT];		//!< 球体を追いかけるものの経路上の中間地点
+DEBUGDRAW debugDraw;							//!< 経路やポリゴンの輪郭などの確認用の図形をまとめて描画する入れ物
+
+
+void SetupPolyGrid(void);						//!< ポリゴン検索用の格子を構築する
+void TerminatePolyGrid(void);					//!< ポリゴン検索用の格子の後始末を行う
 
 void SetupPolyLinkInfo(void);					//!< ポリゴン同士の連結情報を構築する
+void BuildPolyLinkInfo(void);					//!< polyList に設定済みのポリゴンから連結情報を構築する
 void TerminatePolyLinkInfo(void);				//!< ポリゴン同士の連結情報の後始末を行う
-bool CheckPolyMove(VECTOR startPos, VECTOR targetPos);	//!< ポリゴン同士の連結情報を使用して指定の二つの座標間を直線的に移動できるかどうかをチェックする( 戻り値  true:直線的に移動できる  false:直線的に移動できない )
-bool CheckPolyMoveWidth(VECTOR startPos, VECTOR targetPos, float width);	//!< ポリゴン同士の連結情報を使用して指定の二つの座標間を直線的に移動できるかどうかをチェックする( 戻り値  true:直線的に移動できる  false:直線的に移動できない )( 幅指定版 )
 
 bool SetupPathPlanning(VECTOR startPos, VECTOR goalPos);			//!< 指定の２点の経路を探索する( 戻り値  true:経路構築成功  false:経路構築失敗( スタート地点とゴール地点を繋ぐ経路が無かった等 ) )
+bool SetupPathPlanningCluster(void);			//!< スタート地点とゴール地点のポリゴンの間を階層的に探索して経路情報を設定する( 戻り値  true:経路構築成功  false:経路構築失敗 )
+void SetupPathPlanningUnit(const int *pathPolyIndex, int pathPolyNum);	//!< 経路上のポリゴン番号の列から経路探索用のポリゴン情報を設定する
+void SetupPathPlanningResult(const PATHRESULT *result);	//!< 経路探索サービスから受け取った結果を経路情報に設定する
+void SetupPathWayPoint(float width);			//!< 探索した経路のポリゴンの境界の辺からファネルアルゴリズムで直線的に移動できる中間地点を算出する
 void TerminatePathPlanning(void);				//!< 経路探索情報の後始末
 
 void MoveInitialize(void);						//!< 探索した経路を移動する処理の初期化を行う関数
 void MoveProcess(void);							//!< 探索した経路を移動する処理の１フレーム分の処理を行う関数
 bool RefreshMoveDirection(void);				//!< 探索した経路を移動する処理で移動方向を更新する処理を行う関数( 戻り値  true:ゴールに辿り着いている  false:ゴールに辿り着いていない )
 
+const char *GetCommandLineToken(const char *commandLine, char *token, int tokenSize);	//!< コマンドラインから空白で区切られた次の引数を取り出す( 戻り値 : 続きの位置、引数が無い場合は NULL )
+bool GenerateNavMesh(const char *stageFilePath, const char *navMeshFilePath);	//!< 指定のステージモデルからナビメッシュを自動生成してファイルに書き出す( 戻り値  true:成功  false:失敗 )
+
+/**
+* @fn CheckPolyContainXZ
+* @brief 指定のポリゴンをＸＺ平面に投影した三角形の中に指定の座標が含まれるかどうかをチェック
+* @param[in] int polyIndex, VECTOR Pos
+* @return bool true:含まれる  false:含まれない
+* @details Ｙ軸方向に伸びる線分とポリゴンとの当たり判定と同じ結果になる( 辺の上も含まれるものとする )
+*/
+bool CheckPolyContainXZ(int polyIndex, VECTOR Pos)
+{
+	MV1_REF_POLYGON *refPoly = &polyList.Polygons[polyIndex];
+	VECTOR p0 = polyList.Vertexs[refPoly->VIndex[0]].Position;
+	VECTOR p1 = polyList.Vertexs[refPoly->VIndex[1]].Position;
+	VECTOR p2 = polyList.Vertexs[refPoly->VIndex[2]].Position;
+
+	// 三角形の各辺と、辺の始点から指定座標へのベクトルとの外積のＹ成分を求める
+	float c0 = (p1.x - p0.x) * (Pos.z - p0.z) - (p1.z - p0.z) * (Pos.x - p0.x);
+	float c1 = (p2.x - p1.x) * (Pos.z - p1.z) - (p2.z - p1.z) * (Pos.x - p1.x);
+	float c2 = (p0.x - p2.x) * (Pos.z - p2.z) - (p0.z - p2.z) * (Pos.x - p2.x);
+
+	// ポリゴンの表裏どちら向きでも判定できるように、全て同じ符号( 若しくは0 )なら含まれている
+	return (c0 >= 0.0f && c1 >= 0.0f && c2 >= 0.0f) || (c0 <= 0.0f && c1 <= 0.0f && c2 <= 0.0f);
+}
+
 /**
 * @fn CheckOnPolyIndex
 * @brief 指定の座標の直下、若しくは直上にあるポリゴンの番号を取得
 * @param[in] VECTOR Pos
 * @return int ポリゴンが無かった場合は -1
+* @details 全ポリゴンを調べる代わりに、ポリゴン検索用の格子で指定の座標があるマスに登録されたポリゴンだけを調べる
 */
 int CheckOnPolyIndex(VECTOR Pos)
 {
-	HITRESULT_LINE hitRes;
+	// 指定の座標があるマスを算出
+	int cellX = (int)((Pos.x - polyGrid.minX) / polyGrid.cellSize);
+	int cellZ = (int)((Pos.z - polyGrid.minZ) / polyGrid.cellSize);
+
+	// 格子の外だったらポリゴンは無いので -1 を返す
+	if(Pos.x < polyGrid.minX || Pos.z < polyGrid.minZ || cellX >= polyGrid.cellNumX || cellZ >= polyGrid.cellNumZ)
+	{
+		return -1;
+	}
+
+	// マスに登録されているポリゴンの数だけ繰り返し
+	int cellIndex = cellZ * polyGrid.cellNumX + cellX;
+	for(int i=polyGrid.cellStart[cellIndex]; i<polyGrid.cellStart[cellIndex + 1]; i++)
+	{
+		// 指定の座標を含むポリゴンがあったらそのポリゴンの番号を返す
+		if(CheckPolyContainXZ(polyGrid.cellPolyIndex[i], Pos))
+		{
+			return polyGrid.cellPolyIndex[i];
+		}
+	}
+
+	// ここに来たら指定の座標の上下にポリゴンが無かったということなので -1 を返す
+	return -1;
+}
+
+/**
+* @fn CheckOnPolyIndexNear
+* @brief 前回乗っていたポリゴンとその隣接ポリゴンから優先して、指定の座標の直下、若しくは直上にあるポリゴンの番号を取得
+* @param[in] VECTOR Pos, int prevPolyIndex
+* @return int ポリゴンが無かった場合は -1
+* @details 毎フレーム少しずつ移動する場合は殆ど前回のポリゴンか隣のポリゴンに乗っているので、格子を調べずに済む
+*/
+int CheckOnPolyIndexNear(VECTOR Pos, int prevPolyIndex)
+{
+	if(prevPolyIndex != -1)
+	{
+		// 前回乗っていたポリゴンにまだ乗っていたらそのポリゴンの番号を返す
+		if(CheckPolyContainXZ(prevPolyIndex, Pos))
+		{
+			return prevPolyIndex;
+		}
 
-	// 指定の座標のY軸方向に大きく伸びる線分の２座標をセット
-	VECTOR linePos1 = VGet(Pos.x, 1000000.0f, Pos.z);
-	VECTOR linePos2 = VGet(Pos.x, -1000000.0f, Pos.z);
+		// 前回乗っていたポリゴンに隣接するポリゴンに乗っていたらそのポリゴンの番号を返す
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = polyLinkInfo[prevPolyIndex].linkPolyIndex[i];
+			if(linkPolyIndex != -1 && CheckPolyContainXZ(linkPolyIndex, Pos))
+			{
+				return linkPolyIndex;
+			}
+		}
+	}
+
+	// 近くに見つからなかったら格子を使用して検索する
+	return CheckOnPolyIndex(Pos);
+}
 
-	// ステージモデルのポリゴンの数だけ繰り返し
+/**
+* @fn SetupPolyGrid
+* @brief ポリゴン検索用の格子を構築する
+* @details ポリゴンのＸＺ平面上の範囲と重なる全てのマスにポリゴン番号を登録する
+*/
+void SetupPolyGrid()
+{
+	// 格子の範囲はステージモデル全体の範囲
+	polyGrid.minX = polyList.MinPosition.x;
+	polyGrid.minZ = polyList.MinPosition.z;
+	float sizeX = polyList.MaxPosition.x - polyList.MinPosition.x;
+	float sizeZ = polyList.MaxPosition.z - polyList.MinPosition.z;
+
+	// １マスのサイズはポリゴン１枚あたりの平均的な面積の一辺程度にする
+	polyGrid.cellSize = sqrtf(sizeX * sizeZ / (polyList.PolygonNum > 0 ? polyList.PolygonNum : 1));
+	if(polyGrid.cellSize * POLYGRID_MAXCELLNUM < sizeX)
+	{
+		polyGrid.cellSize = sizeX / POLYGRID_MAXCELLNUM;
+	}
+	if(polyGrid.cellSize * POLYGRID_MAXCELLNUM < sizeZ)
+	{
+		polyGrid.cellSize = sizeZ / POLYGRID_MAXCELLNUM;
+	}
+	if(polyGrid.cellSize <= 0.0f)
+	{
+		polyGrid.cellSize = 1.0f;
+	}
+	polyGrid.cellNumX = (int)(sizeX / polyGrid.cellSize) + 1;
+	polyGrid.cellNumZ = (int)(sizeZ / polyGrid.cellSize) + 1;
+
+	// 各マスの開始位置を格納する為のメモリ領域を確保する
+	int cellNum = polyGrid.cellNumX * polyGrid.cellNumZ;
+	polyGrid.cellStart = (int *)malloc(sizeof(int) * (cellNum + 1));
+	for(int i=0; i<=cellNum; i++)
+	{
+		polyGrid.cellStart[i] = 0;
+	}
+
+	// 一回目は各マスに登録されるポリゴンの数を数える
 	MV1_REF_POLYGON *refPoly = polyList.Polygons;
 	for(int i=0; i<polyList.PolygonNum; i++, refPoly++)
 	{
-		// 線分と接するポリゴンがあったらそのポリゴンの番号を返す
-		hitRes = HitCheck_Line_Triangle(
-			linePos1,
-			linePos2,
-			polyList.Vertexs[refPoly->VIndex[0]].Position,
-			polyList.Vertexs[refPoly->VIndex[1]].Position,
-			polyList.Vertexs[refPoly->VIndex[2]].Position
-		);
-		if(hitRes.HitFlag)
+		int cellMinX = (int)((refPoly->MinPosition.x - polyGrid.minX) / polyGrid.cellSize);
+		int cellMinZ = (int)((refPoly->MinPosition.z - polyGrid.minZ) / polyGrid.cellSize);
+		int cellMaxX = (int)((refPoly->MaxPosition.x - polyGrid.minX) / polyGrid.cellSize);
+		int cellMaxZ = (int)((refPoly->MaxPosition.z - polyGrid.minZ) / polyGrid.cellSize);
+		for(int z=cellMinZ; z<=cellMaxZ; z++)
 		{
-			return i;
+			for(int x=cellMinX; x<=cellMaxX; x++)
+			{
+				polyGrid.cellStart[z * polyGrid.cellNumX + x + 1]++;
+			}
 		}
 	}
 
-	// ここに来たら線分と接するポリゴンが無かったということなので -1 を返す
-	return -1;
+	// 数を累計して各マスの開始位置にする
+	for(int i=0; i<cellNum; i++)
+	{
+		polyGrid.cellStart[i + 1] += polyGrid.cellStart[i];
+	}
+
+	// ポリゴン番号を格納する為のメモリ領域を確保する
+	polyGrid.cellPolyIndex = (int *)malloc(sizeof(int) * (polyGrid.cellStart[cellNum] > 0 ? polyGrid.cellStart[cellNum] : 1));
+
+	// 二回目はポリゴン番号を登録する( ポリゴン番号の小さい順に並ぶので、全ポリゴンを調べた場合と同じ結果になる )
+	int *cellFill = (int *)malloc(sizeof(int) * cellNum);
+	for(int i=0; i<cellNum; i++)
+	{
+		cellFill[i] = polyGrid.cellStart[i];
+	}
+	refPoly = polyList.Polygons;
+	for(int i=0; i<polyList.PolygonNum; i++, refPoly++)
+	{
+		int cellMinX = (int)((refPoly->MinPosition.x - polyGrid.minX) / polyGrid.cellSize);
+		int cellMinZ = (int)((refPoly->MinPosition.z - polyGrid.minZ) / polyGrid.cellSize);
+		int cellMaxX = (int)((refPoly->MaxPosition.x - polyGrid.minX) / polyGrid.cellSize);
+		int cellMaxZ = (int)((refPoly->MaxPosition.z - polyGrid.minZ) / polyGrid.cellSize);
+		for(int z=cellMinZ; z<=cellMaxZ; z++)
+		{
+			for(int x=cellMinX; x<=cellMaxX; x++)
+			{
+				polyGrid.cellPolyIndex[cellFill[z * polyGrid.cellNumX + x]++] = i;
+			}
+		}
+	}
+	free(cellFill);
+}
+
+/**
+* @fn TerminatePolyGrid
+* @brief ポリゴン検索用の格子の後始末を行う
+*/
+void TerminatePolyGrid()
+{
+	// 格子の情報を格納していたメモリ領域を解放
+	free(polyGrid.cellStart);
+	polyGrid.cellStart = NULL;
+	free(polyGrid.cellPolyIndex);
+	polyGrid.cellPolyIndex = NULL;
 }
 
 /**
@@ -129,15 +327,26 @@ int CheckOnPolyIndex(VECTOR Pos)
 */
 void SetupPolyLinkInfo()
 {
-	POLYLINKINFO *pLInfoSub;
-	MV1_REF_POLYGON *refPolySub;
-
 	// ステージモデル全体の参照用メッシュを構築する
 	MV1SetupReferenceMesh(stageModelHandle, 0, true);
 
 	// ステージモデル全体の参照用メッシュの情報を取得する
 	polyList = MV1GetReferenceMesh(stageModelHandle, 0, true);
 
+	// 取得したポリゴンから連結情報を構築する
+	BuildPolyLinkInfo();
+}
+
+/**
+* @fn BuildPolyLinkInfo
+* @brief polyList に設定済みのポリゴンから連結情報を構築する
+* @details 隣り合うポリゴンは頂点番号を共有している必要がある
+*/
+void BuildPolyLinkInfo()
+{
+	POLYLINKINFO *pLInfoSub;
+	MV1_REF_POLYGON *refPolySub;
+
 	// ステージモデルの全ポリゴンの連結情報を格納する為のメモリ領域を確保する
 	polyLinkInfo = (POLYLINKINFO *)malloc(sizeof(POLYLINKINFO) * polyList.PolygonNum);
 
@@ -221,309 +430,6 @@ void TerminatePolyLinkInfo()
 	polyLinkInfo = NULL;
 }
 
-/**
-* @fn CheckPolyMove
-* @brief ポリゴン同士の連結情報を使用して指定の二つの座標間を直線的に移動できるかどうかをチェック
-* @param[in] VECTOR startPos, VECTOR targetPos
-* @return bool true:直線的に移動できる  false:直線的に移動できない
-*/
-bool CheckPolyMove(VECTOR startPos, VECTOR targetPos)
-{
-	VECTOR_D polyPos[3];
-	int nextCheckPoly[3];
-	int nextCheckPolyPrev[3];
-	int nextCheckPolyNum;
-	int nextCheckPolyPrevNum;
-
-	// 開始座標と目標座標の y座標値を 0.0f にして、平面上の判定にする
-	startPos.y = 0.0f;
-	targetPos.y = 0.0f;
-
-	// 精度を上げるために double型にする
-	VECTOR_D startPosD = VConvFtoD(startPos);
-	VECTOR_D targetPosD = VConvFtoD(targetPos);
-
-	// 開始座標と目標座標の直上、若しくは直下に存在するポリゴンを検索する
-	int startPoly = CheckOnPolyIndex(startPos);
-	int targetPoly = CheckOnPolyIndex(targetPos);
-
-	// ポリゴンが存在しなかったら移動できないので false を返す
-	if(startPoly == -1 || targetPoly == -1)
-	{
-		return false;
-	}
-
-	// 開始座標と目標座標の直上、若しくは直下に存在するポリゴンの連結情報のアドレスを取得しておく
-	POLYLINKINFO *pInfoStart = &polyLinkInfo[startPoly];
-	POLYLINKINFO *pInfoTarget = &polyLinkInfo[targetPoly];
-
-	// 指定線分上にあるかどうかをチェックするポリゴンとして開始座標の直上、若しくは直下に存在するポリゴンを登録
-	int checkPolyNum = 1;
-	int checkPoly[3];
-	checkPoly[0] = startPoly;
-	int checkPolyPrevNum = 0;
-	int checkPolyPrev[3];
-	checkPolyPrev[0] = -1;
-
-	// 結果が出るまで無条件で繰り返し
-	while(1)
-	{
-		// 次のループでチェック対象になるポリゴンの数をリセットしておく
-		nextCheckPolyNum = 0;
-
-		// 次のループでチェック対象から外すポリゴンの数をリセットしておく
-		nextCheckPolyPrevNum = 0;
-
-		// チェック対象のポリゴンの数だけ繰り返し
-		for(int i=0; i<checkPolyNum; i++)
-		{
-			// チェック対象のポリゴンの３座標を取得
-			polyPos[0] = VConvFtoD(polyList.Vertexs[polyList.Polygons[checkPoly[i]].VIndex[0]].Position);
-			polyPos[1] = VConvFtoD(polyList.Vertexs[polyList.Polygons[checkPoly[i]].VIndex[1]].Position);
-			polyPos[2] = VConvFtoD(polyList.Vertexs[polyList.Polygons[checkPoly[i]].VIndex[2]].Position);
-
-			// y座標を0.0にして、平面的な判定を行うようにする
-			polyPos[0].y = 0.0;
-			polyPos[1].y = 0.0;
-			polyPos[2].y = 0.0;
-
-			// ポリゴンの頂点番号0と1の辺に隣接するポリゴンが存在する場合で、
-			// 且つ辺の線分と移動開始点、終了点で形成する線分が接していたら if 文が真になる
-			if(polyLinkInfo[checkPoly[i]].linkPolyIndex[0] != -1 &&
-				Segment_Segment_MinLength_SquareD(startPosD, targetPosD, polyPos[0], polyPos[1]) < 0.001)
-			{
-				// もし辺と接しているポリゴンが目標座標上に存在するポリゴンだったら
-				// 開始座標から目標座標上まで途切れなくポリゴンが存在するということなので true を返す
-				if(polyLinkInfo[checkPoly[i]].linkPolyIndex[0] == targetPoly)
-				{
-					return true;
-				}
-
-				// 辺と接しているポリゴンを次のチェック対象のポリゴンに加える
-
-				// 既に登録されているポリゴンの場合は加えない
-				int j;
-				for(j=0; j<nextCheckPolyNum; j++)
-				{
-					if(nextCheckPoly[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[0])
-					{
-						break;
-					}
-				}
-				if(j == nextCheckPolyNum)
-				{
-					// 次のループで除外するポリゴンの対象に加える
-
-					// 既に登録されている除外ポリゴンの場合は加えない
-					for(j=0; j<nextCheckPolyPrevNum; j++)
-					{
-						if(nextCheckPolyPrev[j] == checkPoly[i])
-						{
-							break;
-						}
-					}
-					if(j == nextCheckPolyPrevNum)
-					{
-						nextCheckPolyPrev[nextCheckPolyPrevNum] = checkPoly[i];
-						nextCheckPolyPrevNum++;
-					}
-
-					// 一つ前のループでチェック対象になったポリゴンの場合も加えない
-					for(j=0; j<checkPolyPrevNum; j++)
-					{
-						if(checkPolyPrev[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[0])
-						{
-							break;
-						}
-					}
-					if(j == checkPolyPrevNum)
-					{
-						// ここまで来たら漸く次のチェック対象のポリゴンに加える
-						nextCheckPoly[nextCheckPolyNum] = polyLinkInfo[checkPoly[i]].linkPolyIndex[0];
-						nextCheckPolyNum++;
-					}
-				}
-			}
-
-			// ポリゴンの頂点番号1と2の辺に隣接するポリゴンが存在する場合で、
-			// 且つ辺の線分と移動開始点、終了点で形成する線分が接していたら if 文が真になる
-			if(polyLinkInfo[checkPoly[i]].linkPolyIndex[1] != -1 &&
-				Segment_Segment_MinLength_SquareD(startPosD, targetPosD, polyPos[1], polyPos[2]) < 0.001)
-			{
-				// もし辺と接しているポリゴンが目標座標上に存在するポリゴンだったら
-				// 開始座標から目標座標上まで途切れなくポリゴンが存在するということなので true を返す
-				if(polyLinkInfo[checkPoly[i]].linkPolyIndex[1] == targetPoly)
-				{
-					return true;
-				}
-
-				// 辺と接しているポリゴンを次のチェック対象のポリゴンに加える
-
-				int j;
-				// 既に登録されているポリゴンの場合は加えない
-				for(j=0; j<nextCheckPolyNum; j++)
-				{
-					if(nextCheckPoly[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[1])
-					{
-						break;
-					}
-				}
-				if(j == nextCheckPolyNum)
-				{
-					// 既に登録されている除外ポリゴンの場合は加えない
-					for(j=0; j<nextCheckPolyPrevNum; j++)
-					{
-						if(nextCheckPolyPrev[j] == checkPoly[i])
-						{
-							break;
-						}
-					}
-					if(j == nextCheckPolyPrevNum)
-					{
-						nextCheckPolyPrev[nextCheckPolyPrevNum] = checkPoly[i];
-						nextCheckPolyPrevNum++;
-					}
-
-					// 一つ前のループでチェック対象になったポリゴンの場合も加えない
-					for(j=0; j<checkPolyPrevNum; j++)
-					{
-						if(checkPolyPrev[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[1])
-						{
-							break;
-						}
-					}
-					if(j == checkPolyPrevNum)
-					{
-						// ここまで来たら漸く次のチェック対象のポリゴンに加える
-						nextCheckPoly[nextCheckPolyNum] = polyLinkInfo[checkPoly[i]].linkPolyIndex[1];
-						nextCheckPolyNum++;
-					}
-				}
-			}
-
-			// ポリゴンの頂点番号2と0の辺に隣接するポリゴンが存在する場合で、
-			// 且つ辺の線分と移動開始点、終了点で形成する線分が接していたら if 文が真になる
-			if(polyLinkInfo[checkPoly[i]].linkPolyIndex[2] != -1 &&
-				Segment_Segment_MinLength_SquareD(startPosD, targetPosD, polyPos[2], polyPos[0]) < 0.001)
-			{
-				// もし辺と接しているポリゴンが目標座標上に存在するポリゴンだったら
-				// 開始座標から目標座標上まで途切れなくポリゴンが存在するということなので true を返す
-				if(polyLinkInfo[checkPoly[i]].linkPolyIndex[2] == targetPoly)
-				{
-					return true;
-				}
-
-				// 辺と接しているポリゴンを次のチェック対象のポリゴンに加える
-
-				int j;
-				// 既に登録されているポリゴンの場合は加えない
-				for(j=0; j<nextCheckPolyNum; j++)
-				{
-					if(nextCheckPoly[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[2])
-					{
-						break;
-					}
-				}
-				if(j == nextCheckPolyNum)
-				{
-					// 既に登録されている除外ポリゴンの場合は加えない
-					for(j=0; j<nextCheckPolyPrevNum; j++)
-					{
-						if(nextCheckPolyPrev[j] == checkPoly[i])
-						{
-							break;
-						}
-					}
-					if(j == nextCheckPolyPrevNum)
-					{
-						nextCheckPolyPrev[nextCheckPolyPrevNum] = checkPoly[i];
-						nextCheckPolyPrevNum++;
-					}
-
-					// 一つ前のループでチェック対象になったポリゴンの場合も加えない
-					for(j=0; j<checkPolyPrevNum; j++)
-					{
-						if(checkPolyPrev[j] == polyLinkInfo[checkPoly[i]].linkPolyIndex[2])
-						{
-							break;
-						}
-					}
-					if(j == checkPolyPrevNum)
-					{
-						// ここまで来たら漸く次のチェック対象のポリゴンに加える
-						nextCheckPoly[nextCheckPolyNum] = polyLinkInfo[checkPoly[i]].linkPolyIndex[2];
-						nextCheckPolyNum++;
-					}
-				}
-			}
-		}
-
-		// 次のループでチェック対象になるポリゴンが一つもなかったということは
-		// 移動開始点、終了点で形成する線分と接するチェック対象のポリゴンに隣接する
-		// ポリゴンが一つもなかったということなので、直線的な移動はできないということで false を返す
-		if(nextCheckPolyNum == 0)
-		{
-			return false;
-		}
-
-		// 次にチェック対象となるポリゴンの情報をコピーする
-		for(int i=0; i<nextCheckPolyNum; i++)
-		{
-			checkPoly[i] = nextCheckPoly[i];
-		}
-		checkPolyNum = nextCheckPolyNum;
-
-		// 次にチェック対象外となるポリゴンの情報をコピーする
-		for(int i=0; i<nextCheckPolyPrevNum; i++)
-		{
-			checkPolyPrev[i] = nextCheckPolyPrev[i];
-		}
-		checkPolyPrevNum = nextCheckPolyPrevNum;
-	}
-}
-
-/**
-* @fn CheckPolyMoveWidth
-* @brief ポリゴン同士の連結情報を使用して指定の二つの座標間を直線的に移動できるかどうかをチェック( 幅指定版 )
-* @param[in] VECTOR startPos, VECTOR targetPos, float width
-* @return bool true:直線的に移動できる  false:直線的に移動できない
-*/
-bool CheckPolyMoveWidth(VECTOR startPos, VECTOR targetPos, float width)
-{
-	// 最初に開始座標から目標座標に直線的に移動できるかどうかをチェック
-	if(CheckPolyMove(startPos, targetPos) == false)
-	{
-		return false;
-	}
-
-	// 開始座標から目標座標に向かうベクトルを算出
-	VECTOR direction = VSub(targetPos, startPos);
-
-	// y座標を 0.0f にして平面的なベクトルにする
-	direction.y = 0.0f;
-
-	// 開始座標から目標座標に向かうベクトルに直角な正規化ベクトルを算出
-	VECTOR sideDirection = VCross(direction, VGet(0.0f, 1.0f, 0.0f));
-	sideDirection = VNorm(sideDirection);
-
-	// 開始座標と目標座標を width / 2.0f 分だけ垂直方向にずらして、再度直線的に移動できるかどうかをチェック
-	VECTOR tempVec = VScale(sideDirection, width / 2.0f);
-	if(CheckPolyMove(VAdd(startPos, tempVec), VAdd(targetPos, tempVec)) == false)
-	{
-		return false;
-	}
-
-	// 開始座標と目標座標を width / 2.0f 分だけ一つ前とは逆方向の垂直方向にずらして、再度直線的に移動できるかどうかをチェック
-	tempVec = VScale(sideDirection, -width / 2.0f);
-	if(CheckPolyMove(VAdd(startPos, tempVec), VAdd(targetPos, tempVec)) == false)
-	{
-		return false;
-	}
-
-	// ここまできたら指定の幅があっても直線的に移動できるということなので true を返す
-	return true;
-}
-
 /**
 * @fn SetupPathPlanning
 * @brief 指定の２点の経路を探索
@@ -572,12 +478,19 @@ bool SetupPathPlanning(VECTOR startPos, VECTOR goalPos)
 	}
 	pathPlanning.goalUnit = &pathPlanning.unitArray[polyIndex];
 
-	// ゴール地点にあるポリゴンとスタート地点にあるポリゴンが同じだったら false を返す
+	// ゴール地点にあるポリゴンとスタート地点にあるポリゴンが同じだったら、ゴール位置だけを中間地点にして false を返す
 	if(pathPlanning.goalUnit == pathPlanning.startUnit)
 	{
+		SetupPathWayPoint(COLLWIDTH);
 		return false;
 	}
 
+	// 階層的経路探索を使用する場合はクラスタ単位で探索する
+	if(usePathCluster)
+	{
+		return SetupPathPlanningCluster();
+	}
+
 	// 経路を探索してゴール地点のポリゴンにたどり着くまでループを繰り返す
 	bool goal = false;
 	while(goal == false)
@@ -653,10 +566,151 @@ bool SetupPathPlanning(VECTOR startPos, VECTOR goalPos)
 
 	} while(pUnit != pathPlanning.startUnit);
 
+	// 経路上を直線的に移動できる中間地点を算出する
+	SetupPathWayPoint(COLLWIDTH);
+
 	// ここにきたらスタート地点からゴール地点までの経路が探索できたということなので true を返す
 	return true;
 }
 
+/**
+* @fn SetupPathPlanningCluster
+* @brief スタート地点とゴール地点のポリゴンの間を階層的に探索して経路情報を設定する
+* @return bool true:経路構築成功  false:経路構築失敗
+* @details 探索結果のポリゴンの列から、全ポリゴンを探索した場合と同じように経路探索用のポリゴン情報を設定する
+*/
+bool SetupPathPlanningCluster()
+{
+	// 経路上のポリゴン番号を格納するメモリ領域を確保する
+	int *pathPolyIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	int pathPolyNum;
+	bool truncated;
+
+	// 経路が無かったら false を返す( 全ポリゴン数分の領域があるので途中までになることは無い )
+	if(PathCluster_FindPath(&pathClusterWork, pathPlanning.startUnit->polyIndex, pathPlanning.goalUnit->polyIndex,
+		pathPolyIndex, polyList.PolygonNum, &pathPolyNum, &truncated) == false)
+	{
+		free(pathPolyIndex);
+		return false;
+	}
+
+	// 経路上のポリゴンに経路情報を設定する
+	SetupPathPlanningUnit(pathPolyIndex, pathPolyNum);
+	free(pathPolyIndex);
+
+	// 経路上を直線的に移動できる中間地点を算出する
+	SetupPathWayPoint(COLLWIDTH);
+
+	return true;
+}
+
+/**
+* @fn SetupPathPlanningUnit
+* @brief 経路上のポリゴン番号の列から経路探索用のポリゴン情報を設定する
+* @param[in] const int *pathPolyIndex スタートからゴールまでのポリゴン番号, int pathPolyNum
+*/
+void SetupPathPlanningUnit(const int *pathPolyIndex, int pathPolyNum)
+{
+	// 経路上のポリゴンに一つ前と一つ先のポリゴンの番号、到達するまでの距離を代入する
+	for(int i=1; i<pathPolyNum; i++)
+	{
+		PATHPLANNING_UNIT *pUnit = &pathPlanning.unitArray[pathPolyIndex[i - 1]];
+		PATHPLANNING_UNIT *pUnitSub = &pathPlanning.unitArray[pathPolyIndex[i]];
+
+		pUnit->nextPolyIndex = pUnitSub->polyIndex;
+		pUnitSub->prevPolyIndex = pUnit->polyIndex;
+
+		for(int j=0; j<3; j++)
+		{
+			if(polyLinkInfo[pUnit->polyIndex].linkPolyIndex[j] == pUnitSub->polyIndex)
+			{
+				pUnitSub->totalDistance = pUnit->totalDistance + polyLinkInfo[pUnit->polyIndex].linkPolyDistance[j];
+				break;
+			}
+		}
+	}
+}
+
+/**
+* @fn SetupPathPlanningResult
+* @brief 経路探索サービスから受け取った結果を経路情報に設定する
+* @param[in] const PATHRESULT *result
+* @details 探索を要求してから結果を受け取るまでの間も移動しているので、現在位置はそのままにして中間地点だけを入れ替える
+*/
+void SetupPathPlanningResult(const PATHRESULT *result)
+{
+	// スタート位置とゴール位置を保存
+	pathPlanning.startPosition = result->startPosition;
+	pathPlanning.goalPosition = result->goalPosition;
+
+	// 経路探索用のポリゴン情報を初期化
+	PATHPLANNING_UNIT *pUnit = pathPlanning.unitArray;
+	for(int i=0; i<polyList.PolygonNum; i++, pUnit++)
+	{
+		pUnit->totalDistance = 0.0f;
+		pUnit->prevPolyIndex = -1;
+		pUnit->nextPolyIndex = -1;
+		pUnit->activeNextUnit = NULL;
+	}
+	pathPlanning.startUnit = &pathPlanning.unitArray[result->pathPolyIndex[0]];
+	pathPlanning.goalUnit = &pathPlanning.unitArray[result->pathPolyIndex[result->pathPolyNum - 1]];
+	SetupPathPlanningUnit(result->pathPolyIndex, result->pathPolyNum);
+
+	// 中間地点をコピーする
+	free(pathPlanning.wayPointArray);
+	pathPlanning.wayPointArray = (VECTOR *)malloc(sizeof(VECTOR) * result->wayPointNum);
+	for(int i=0; i<result->wayPointNum; i++)
+	{
+		pathPlanning.wayPointArray[i] = result->wayPoint[i];
+	}
+	pathPlanning.wayPointNum = result->wayPointNum;
+
+	// 最初の中間地点から移動し直す
+	pathMove.targetWayPointIndex = 0;
+}
+
+/**
+* @fn SetupPathWayPoint
+* @brief 探索した経路のポリゴンの境界の辺からファネルアルゴリズムで直線的に移動できる中間地点を算出する
+* @param[in] float width 移動するものの幅
+* @details 経路を探索した時に一度だけ行うので、移動中は中間地点に向かって進むだけで良い
+*/
+void SetupPathWayPoint(float width)
+{
+	PATHPLANNING_UNIT *pUnit;
+
+	// 経路上のポリゴンの数を数える
+	int pathPolyNum = 1;
+	for(pUnit = pathPlanning.startUnit; pUnit != pathPlanning.goalUnit; pUnit = &pathPlanning.unitArray[pUnit->nextPolyIndex])
+	{
+		pathPolyNum++;
+	}
+
+	// 経路上のポリゴン番号を順番に並べる
+	int *pathPolyIndex = (int *)malloc(sizeof(int) * pathPolyNum);
+	int i = 0;
+	for(pUnit = pathPlanning.startUnit; ; pUnit = &pathPlanning.unitArray[pUnit->nextPolyIndex])
+	{
+		pathPolyIndex[i] = pUnit->polyIndex;
+		i++;
+		if(pUnit == pathPlanning.goalUnit)
+		{
+			break;
+		}
+	}
+
+	// 中間地点を格納するメモリ領域を確保する
+	free(pathPlanning.wayPointArray);
+	pathPlanning.wayPointArray = (VECTOR *)malloc(sizeof(VECTOR) * (pathPolyNum + 1));
+
+	// 移動開始時点の座標はスタート地点にあるポリゴンの中心座標なので、そこから中間地点を算出する
+	pathPlanning.wayPointNum = PathFunnel_Build(pathPolyIndex, pathPolyNum,
+		polyLinkInfo[pathPlanning.startUnit->polyIndex].centerPosition, pathPlanning.goalPosition, width,
+		pathPlanning.wayPointArray, pathPolyNum + 1);
+
+	free(pathPolyIndex);
+}
+
 /**
 * @fn TerminatePathPlanning
 * @brief 経路探索情報の後始末
@@ -666,6 +720,9 @@ void TerminatePathPlanning()
 	// 経路探索の為に確保したメモリ領域を解放
 	free(pathPlanning.unitArray);
 	pathPlanning.unitArray = NULL;
+	free(pathPlanning.wayPointArray);
+	pathPlanning.wayPointArray = NULL;
+	pathPlanning.wayPointNum = 0;
 }
 
 /**
@@ -683,8 +740,8 @@ void MoveInitialize()
 	// 移動開始時点の経路探索情報はスタート地点にあるポリゴンの情報
 	pathMove.nowPathPlanningUnit = pathPlanning.startUnit;
 
-	// 移動開始時点の移動中間地点の経路探索情報もスタート地点にあるポリゴンの情報
-	pathMove.targetPathPlanningUnit = pathPlanning.startUnit;
+	// 移動開始時点で向かう中間地点は経路上の最初の中間地点
+	pathMove.targetWayPointIndex = 0;
 }
 
 /**
@@ -702,8 +759,8 @@ void MoveProcess()
 	// 移動方向に座標を移動する
 	pathMove.nowPosition = VAdd(pathMove.nowPosition, VScale(pathMove.moveDirection, MOVESPEED));
 
-	// 現在の座標で乗っているポリゴンを検索する
-	pathMove.nowPolyIndex = CheckOnPolyIndex(pathMove.nowPosition);
+	// 現在の座標で乗っているポリゴンを検索する( 前回乗っていたポリゴンの周辺から探す )
+	pathMove.nowPolyIndex = CheckOnPolyIndexNear(pathMove.nowPosition, pathMove.nowPolyIndex);
 
 	// 現在の座標で乗っているポリゴンの経路探索情報のメモリアドレスを代入する
 	pathMove.nowPathPlanningUnit = &pathPlanning.unitArray[pathMove.nowPolyIndex];
@@ -713,62 +770,123 @@ void MoveProcess()
 * @fn RefreshMoveDirection
 * @brief 探索した経路を移動する処理で移動方向を更新する処理を行う
 * @return bool true:ゴールに辿り着いている  false:ゴールに辿り着いていない
+* @details 中間地点は経路探索時に算出済みなので、次の中間地点に向かうだけで良い
 */
 bool RefreshMoveDirection()
 {
-	PATHPLANNING_UNIT *tempPUnit;
-
-	// 現在乗っているポリゴンがゴール地点にあるポリゴンの場合は処理を分岐
-	if(pathMove.nowPathPlanningUnit == pathPlanning.goalUnit)
+	// 次の中間地点が決定するまでループし続ける
+	for(;;)
 	{
-		// 方向は目標座標
-		pathMove.moveDirection = VSub(pathPlanning.goalPosition, pathMove.nowPosition);
+		// 方向は中間地点
+		pathMove.moveDirection = VSub(pathPlanning.wayPointArray[pathMove.targetWayPointIndex], pathMove.nowPosition);
 		pathMove.moveDirection.y = 0.0f;
 
-		// 目標座標までの距離が移動速度以下だったらゴールに辿りついたことにする
-		if(VSize(pathMove.moveDirection) <= MOVESPEED)
+		// 中間地点までの距離が移動速度より長ければまだたどり着いていないものとして移動する
+		if(VSize(pathMove.moveDirection) > MOVESPEED)
 		{
-			return true;
+			break;
 		}
 
-		// それ以外の場合はまだたどり着いていないものとして移動する
-		pathMove.moveDirection = VNorm(pathMove.moveDirection);
+		// 最後の中間地点( ゴール位置 )までの距離が移動速度以下だったらゴールに辿りついたことにする
+		if(pathMove.targetWayPointIndex == pathPlanning.wayPointNum - 1)
+		{
+			return true;
+		}
 
-		return false;
+		// 向かう先を一つ先の中間地点に変更する
+		pathMove.targetWayPointIndex++;
 	}
 
-	// 現在乗っているポリゴンが移動中間地点のポリゴンの場合は次の中間地点を決定する処理を行う
-	if(pathMove.nowPathPlanningUnit == pathMove.targetPathPlanningUnit)
-	{
-		// 次の中間地点が決定するまでループし続ける
-		for(;;)
-		{
-			tempPUnit = &pathPlanning.unitArray[pathMove.targetPathPlanningUnit->nextPolyIndex];
+	// 移動方向を決定する、移動方向は現在の座標から中間地点に向かう方向
+	pathMove.moveDirection = VNorm(pathMove.moveDirection);
 
-			// 経路上の次のポリゴンの中心座標に直線的に移動できない場合はループから抜ける
-			if(CheckPolyMoveWidth(pathMove.nowPosition, polyLinkInfo[tempPUnit->polyIndex].centerPosition, COLLWIDTH) == false)
-			{
-				break;
-			}
+	// ここに来たということはゴールに辿り着いていないので false を返す
+	return false;
+}
 
-			// チェック対象を経路上の更に一つ先のポリゴンに変更する
-			pathMove.targetPathPlanningUnit = tempPUnit;
+/**
+* @fn GetCommandLineToken
+* @brief コマンドラインから空白で区切られた次の引数を取り出す
+* @param[in] const char *commandLine 取り出し始める位置, int tokenSize
+* @param[out] char *token 取り出した引数
+* @return const char * 続きの位置、引数が無い場合は NULL
+* @details " で囲まれた引数は空白を含めて１つの引数にする
+*/
+const char *GetCommandLineToken(const char *commandLine, char *token, int tokenSize)
+{
+	while(*commandLine == ' ' || *commandLine == '\t')
+	{
+		commandLine++;
+	}
+	if(*commandLine == '\0')
+	{
+		return NULL;
+	}
 
-			// もしゴール地点のポリゴンだったらループを抜ける
-			if(pathMove.targetPathPlanningUnit == pathPlanning.goalUnit)
-			{
-				break;
-			}
+	bool quote = *commandLine == '"';
+	if(quote)
+	{
+		commandLine++;
+	}
+	int length = 0;
+	while(*commandLine != '\0' && (quote ? *commandLine != '"' : (*commandLine != ' ' && *commandLine != '\t')))
+	{
+		if(length < tokenSize - 1)
+		{
+			token[length++] = *commandLine;
 		}
+		commandLine++;
 	}
+	if(quote && *commandLine == '"')
+	{
+		commandLine++;
+	}
+	token[length] = '\0';
+	return commandLine;
+}
 
-	// 移動方向を決定する、移動方向は現在の座標から中間地点のポリゴンの中心座標に向かう方向
-	pathMove.moveDirection = VSub(polyLinkInfo[pathMove.targetPathPlanningUnit->polyIndex].centerPosition, pathMove.nowPosition);
-	pathMove.moveDirection.y = 0.0f;
-	pathMove.moveDirection = VNorm(pathMove.moveDirection);
+/**
+* @fn GenerateNavMesh
+* @brief 指定のステージモデルからナビメッシュを自動生成してファイルに書き出す
+* @param[in] const char *stageFilePath, const char *navMeshFilePath
+* @return bool true:成功  false:失敗
+* @details 書き出したファイルは NavMesh_Load でそのまま読み込める、生成の統計情報は Log.txt に出力する
+*/
+bool GenerateNavMesh(const char *stageFilePath, const char *navMeshFilePath)
+{
+	// ステージモデルを読み込んで、全フレームの参照用メッシュを構築する
+	int modelHandle = MV1LoadModel(stageFilePath);
+	if(modelHandle == -1)
+	{
+		ErrorLogFmtAdd("navgen: failed to load %s", stageFilePath);
+		return false;
+	}
+	MV1SetupReferenceMesh(modelHandle, -1, true);
+	MV1_REF_POLYGONLIST source = MV1GetReferenceMesh(modelHandle, -1, true);
+
+	// キャラクターの当たり判定のサイズに合わせてポリゴンを生成する
+	NAVGEN_CONFIG config;
+	NAVGEN_STATS stats;
+	NavGen_GetDefaultConfig(&config, NAVGEN_AGENTRADIUS, NAVGEN_AGENTHEIGHT);
+	bool result = NavGen_Build(&source, &config, &polyList, &stats);
+	MV1DeleteModel(modelHandle);
+
+	// 生成したポリゴンから連結情報と検索用の格子を構築して書き出す
+	if(result)
+	{
+		BuildPolyLinkInfo();
+		SetupPolyGrid();
+		result = NavMesh_Save(navMeshFilePath, stageFilePath);
+		TerminatePolyGrid();
+		TerminatePolyLinkInfo();
+	}
+	NavGen_Free(&polyList);
 
-	// ここに来たということはゴールに辿り着いていないので false を返す
-	return false;
+	ErrorLogFmtAdd("navgen: %s -> %s %s  tile %d span %d region %d fail %d  polygon %d vertex %d  time %lldus (tile max %lldus total %lldus)",
+		stageFilePath, navMeshFilePath, result ? "ok" : "failed",
+		stats.tileNum, stats.spanNum, stats.regionNum, stats.failContourNum, stats.polygonNum, stats.vertexNum,
+		stats.buildTime, stats.tileTimeMax, stats.tileTimeTotal);
+	return result;
 }
 
 const int CAMERA_ANGLE_SPEED = 3;	//!< カメラの回転速度
@@ -784,6 +902,29 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 {
 	PATHPLANNING_UNIT *pUnit;
 
+	// -navgen ステージモデル ナビメッシュファイル を指定して起動した場合は、ウインドウを表示せずに自動生成だけを行う
+	// ファイルを省略した場合は、このレッスンのステージモデルから起動時に読み込むナビメッシュファイルを生成する
+	char navGenStagePath[MAX_PATH];
+	char navGenFilePath[MAX_PATH];
+	const char *navGenStage = STAGE_FILEPATH;
+	const char *navGenFile = NAVMESH_FILEPATH;
+	const char *navGenOption = strstr(lpCmdLine, "-navgen");
+	bool generateNavMesh = navGenOption != NULL;
+	if(generateNavMesh)
+	{
+		const char *next = GetCommandLineToken(navGenOption + strlen("-navgen"), navGenStagePath, MAX_PATH);
+		if(next != NULL && navGenStagePath[0] != '-')
+		{
+			if(GetCommandLineToken(next, navGenFilePath, MAX_PATH) == NULL)
+			{
+				return -1;
+			}
+			navGenStage = navGenStagePath;
+			navGenFile = navGenFilePath;
+		}
+		SetWindowVisibleFlag(false);
+	}
+
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
@@ -793,14 +934,63 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return -1;
 	}
 
+	if(generateNavMesh)
+	{
+		bool result = GenerateNavMesh(navGenStage, navGenFile);
+		DxLib_End();
+		return result ? 0 : -1;
+	}
+
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
 
 	// ステージモデルの読み込み
-	stageModelHandle = MV1LoadModel("Resource/pathPlanning.mqo");
+	stageModelHandle = MV1LoadModel(STAGE_FILEPATH);
+
+	// ナビメッシュファイルがあればマップしてそのまま使い、無いかステージモデルが変わっていたら自動生成して書き出してからマップする
+	// 自動生成にも失敗した場合はステージモデルのポリゴンをそのまま使って構築する
+	bool bakeNavMesh = strstr(lpCmdLine, "-bake") != NULL;
+	const char *navMeshSource = "mapped";
+	LONGLONG navMeshTime = GetNowHiPerformanceCount();
+	if(!bakeNavMesh && !NavMesh_Load(NAVMESH_FILEPATH, STAGE_FILEPATH))
+	{
+		navMeshSource = "generated";
+		if(GenerateNavMesh(STAGE_FILEPATH, NAVMESH_FILEPATH))
+		{
+			NavMesh_Load(NAVMESH_FILEPATH, STAGE_FILEPATH);
+		}
+	}
+	if(!NavMesh_IsLoaded())
+	{
+		navMeshSource = "built";
+
+		// ステージモデルのポリゴン同士の連結情報を構築する
+		SetupPolyLinkInfo();
+
+		// ポリゴン検索用の格子を構築する
+		SetupPolyGrid();
+	}
+	navMeshTime = GetNowHiPerformanceCount() - navMeshTime;
+
+	// -bake を指定して起動した場合は、構築したナビメッシュをファイルに書き出して終了する
+	if(bakeNavMesh)
+	{
+		bool result = NavMesh_Save(NAVMESH_FILEPATH, STAGE_FILEPATH);
+		TerminatePolyGrid();
+		TerminatePolyLinkInfo();
+		DxLib_End();
+		return result ? 0 : -1;
+	}
 
-	// ステージモデルのポリゴン同士の連結情報を構築する
-	SetupPolyLinkInfo();
+	// 階層的経路探索用のクラスタを構築する
+	PathCluster_Setup();
+	PathCluster_InitializeWork(&pathClusterWork);
+
+	// 障害物に対応する為にナビメッシュをタイルに分割する
+	NavTile_Initialize();
+
+	// 経路探索サービスを開始する
+	PathService_Initialize(PATHSERVICE_WORKERNUM);
 
 	// 指定の２点の経路情報を探索する
 	SetupPathPlanning(VGet(-7400.0f, 0.0f, -7400.0f), VGet(7400.0f, 0.0f, 7400.0f));
@@ -808,6 +998,41 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// 探索した経路上を移動する準備を行う
 	MoveInitialize();
 
+	// 球体を追いかけるエージェントを適当なポリゴンの中心に配置する
+	FlowField_Initialize(&flowField);
+	for(int i=0; i<FLOWAGENT_NUM; i++)
+	{
+		flowAgent[i].polyIndex = GetRand(polyList.PolygonNum - 1);
+		flowAgent[i].position = polyLinkInfo[flowAgent[i].polyIndex].centerPosition;
+	}
+
+	// 差分経路探索で球体を追いかけるものをステージの反対側に配置する
+	PathDStar_Initialize(&chaserDStar);
+	chaserPosition = VGet(7400.0f, 0.0f, 7400.0f);
+
+	// 確認用の図形をまとめて描画する入れ物を用意する
+	if(!DebugDraw_Initialize(&debugDraw, DEBUGDRAW_LINEMAX, DEBUGDRAW_TRIANGLEMAX))
+	{
+		PathDStar_Terminate(&chaserDStar);
+		FlowField_Terminate(&flowField);
+		PathService_Terminate();
+		NavTile_Terminate();
+		TerminatePathPlanning();
+		PathCluster_TerminateWork(&pathClusterWork);
+		PathCluster_Terminate();
+		if(NavMesh_IsLoaded())
+		{
+			NavMesh_Unload();
+		}
+		else
+		{
+			TerminatePolyGrid();
+			TerminatePolyLinkInfo();
+		}
+		DxLib_End();
+		return -1;
+	}
+
 	// カメラの設定
 	{
 		// X軸とY軸の回転から回転行列を作成
@@ -827,6 +1052,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	MV1SetupCollInfo(stageModelHandle, -1, 8, 8, 8);
 
 	// メインループ(ESCキーが押されたらループを抜ける)
+	int prevMouseInput = 0;
 	while(ProcessMessage() == 0 && CheckHitKey(KEY_INPUT_ESCAPE) == 0)
 	{
 		// 画面の初期化
@@ -854,29 +1080,201 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 				// 座標を表示
 				DrawFormatString(5, 5, 65535, "%f, %f, %f", HitPoly.HitPosition.x, HitPoly.HitPosition.y, HitPoly.HitPosition.z);
 				
-				// 指定の２点の経路情報を探索する
-				SetupPathPlanning(pathMove.nowPosition, HitPoly.HitPosition);
+				// 指定の２点の経路探索を要求する( 結果は後のフレームで受け取る )
+				int ticket = PathService_Submit(pathMove.nowPosition, HitPoly.HitPosition, COLLWIDTH / 2.0f);
+				if(ticket != -1)
+				{
+					pathRequestTicket = ticket;
+				}
+			}
+		}
+
+		// 右クリックした地点に障害物を配置する
+		int mouseInput = GetMouseInput();
+		if((mouseInput & MOUSE_INPUT_RIGHT) && (prevMouseInput & MOUSE_INPUT_RIGHT) == 0)
+		{
+			int mouseX, mouseY;
+			GetMousePoint(&mouseX, &mouseY);
+			VECTOR startPos = ConvScreenPosToWorldPos(VGet((float)mouseX, (float)mouseY, 0.0f));
+			VECTOR endPos = ConvScreenPosToWorldPos(VGet((float)mouseX, (float)mouseY, 1.0f));
+			MV1_COLL_RESULT_POLY HitPoly = MV1CollCheck_Line(stageModelHandle, -1, startPos, endPos);
+			if(HitPoly.HitFlag == 1)
+			{
+				// 経路探索に使う半径は移動するものの半径を含める
+				int obstacleIndex = NavTile_AddObstacle(HitPoly.HitPosition, OBSTACLE_RADIUS + COLLWIDTH / 2.0f);
+				if(obstacleIndex != -1)
+				{
+					lastObstacleIndex = obstacleIndex;
+				}
+			}
+		}
+		prevMouseInput = mouseInput;
+
+		// 方向キーで最後に配置した障害物を動かし、Ｘキーで全ての障害物を取り除く
+		if(lastObstacleIndex != -1)
+		{
+			VECTOR moveVec = VGet(0.0f, 0.0f, 0.0f);
+			if(CheckHitKey(KEY_INPUT_LEFT) == 1)
+			{
+				moveVec.x += OBSTACLE_MOVESPEED;
+			}
+			if(CheckHitKey(KEY_INPUT_RIGHT) == 1)
+			{
+				moveVec.x -= OBSTACLE_MOVESPEED;
+			}
+			if(CheckHitKey(KEY_INPUT_UP) == 1)
+			{
+				moveVec.z -= OBSTACLE_MOVESPEED;
+			}
+			if(CheckHitKey(KEY_INPUT_DOWN) == 1)
+			{
+				moveVec.z += OBSTACLE_MOVESPEED;
+			}
+			if(moveVec.x != 0.0f || moveVec.z != 0.0f)
+			{
+				NavTile_MoveObstacle(lastObstacleIndex, VAdd(NavTile_GetObstacle(lastObstacleIndex)->position, moveVec));
+			}
+		}
+		if(CheckHitKey(KEY_INPUT_X) != 0)
+		{
+			for(int i=0; i<NAVTILE_MAXOBSTACLE; i++)
+			{
+				NavTile_RemoveObstacle(i);
+			}
+			lastObstacleIndex = -1;
+		}
+
+		// 作り直しが終わったタイルに切り替え、移動中の経路がそのタイルを通っていたら探索し直す
+		NavTile_Process();
+
+		// 通れるかどうかが変わったポリゴンの移動コストを差分経路探索に伝える( 次の探索で影響のある部分だけ探し直す )
+		const int *changedPolyIndex;
+		int changedPolyNum = NavTile_GetChangedPoly(&changedPolyIndex);
+		for(int i=0; i<changedPolyNum; i++)
+		{
+			PathDStar_UpdateBlockedPoly(&chaserDStar, changedPolyIndex[i]);
+		}
+		if(movePathCheck && NavTile_CheckPath(movePathResult.pathPolyIndex, movePathResult.pathPolyNum, movePathResult.navSerial) == false)
+		{
+			int ticket = PathService_Submit(pathMove.nowPosition, pathPlanning.goalPosition, COLLWIDTH / 2.0f);
+			if(ticket != -1)
+			{
+				pathRequestTicket = ticket;
+				movePathCheck = false;
+			}
+		}
+
+		// 長すぎて途中までしか求まらなかった経路は、最後の中間地点に向かい始めたら続きを探索する
+		if(movePathCheck && movePathResult.truncated && pathMove.targetWayPointIndex >= pathPlanning.wayPointNum - 1)
+		{
+			int ticket = PathService_Submit(pathMove.nowPosition, pathPlanning.goalPosition, COLLWIDTH / 2.0f);
+			if(ticket != -1)
+			{
+				pathRequestTicket = ticket;
+				movePathResult.truncated = false;
+			}
+		}
+
+		// メインスレッドで探索する場合は予算時間の範囲で探索を進める
+		PathService_Process(PATHSERVICE_BUDGET);
 
-				// 探索した経路上を移動する準備を行う
-				MoveInitialize();
+		// 探索が終わった結果を受け取り、最後に要求したものだったら経路上を移動する準備を行う
+		while(PathService_PollResult(&pathResult))
+		{
+			if(pathResult.ticket != pathRequestTicket || pathResult.success == false)
+			{
+				continue;
 			}
+
+			// 探索中にタイルが切り替わって通れなくなっていたら探索し直す
+			if(NavTile_CheckPath(pathResult.pathPolyIndex, pathResult.pathPolyNum, pathResult.navSerial) == false)
+			{
+				int ticket = PathService_Submit(pathMove.nowPosition, pathResult.goalPosition, COLLWIDTH / 2.0f);
+				if(ticket != -1)
+				{
+					pathRequestTicket = ticket;
+				}
+				continue;
+			}
+
+			SetupPathPlanningResult(&pathResult);
+			movePathResult = pathResult;
+			movePathCheck = true;
 		}
 
+		// タイルの作り直しの統計情報を表示
+		NAVTILE_STATS tileStats;
+		NavTile_GetStats(&tileStats);
+		DrawFormatString(5, 205, 65535, "obstacle %d  tile pending %d rebuilt %d  build last %lldus avg %lldus max %lldus",
+			tileStats.obstacleNum, tileStats.pendingTileNum, tileStats.rebuildTileNum, tileStats.buildTimeLast, tileStats.buildTimeAverage, tileStats.buildTimeMax);
+
+		// ナビメッシュの準備にかかった時間を表示
+		DrawFormatString(5, 185, 65535, "navmesh %s %lldus", navMeshSource, navMeshTime);
+
+		// 経路探索サービスの統計情報を表示
+		PATHSERVICE_STATS stats;
+		PathService_GetStats(&stats);
+		DrawFormatString(5, 25, 65535, "queue %d/%d  latency avg %lldus max %lldus  overrun %d  truncated %d",
+			stats.requestQueueDepth, stats.resultQueueDepth, stats.latencyAverage, stats.latencyMax, stats.budgetOverrunNum, stats.truncateNum);
+
 		// １フレーム分経路上を移動
 		MoveProcess();
 
+		// 球体の位置をゴールにしてフローフィールドを更新し、エージェントを球体に向かって移動する
+		FlowField_SetGoal(&flowField, pathMove.nowPosition);
+		for(int i=0; i<FLOWAGENT_NUM; i++)
+		{
+			FlowField_MoveAgent(&flowField, &flowAgent[i], FLOWAGENT_SPEED);
+		}
+		DrawFormatString(5, 45, 65535, "flow field %s update %d polys", flowField.incrementalUpdate ? "incremental" : "full", flowField.updatePolyNum);
+
+		// 毎フレーム球体の位置をゴールにして差分経路探索を行い、経路の最初の中間地点に向かって移動する
+		if(PathDStar_Plan(&chaserDStar, chaserPosition, pathMove.nowPosition))
+		{
+			int wayPointNum = PathFunnel_Build(chaserDStar.pathPolyIndex, chaserDStar.pathPolyNum, chaserPosition, pathMove.nowPosition, COLLWIDTH, chaserWayPoint, CHASER_MAXWAYPOINT);
+			if(wayPointNum > 0)
+			{
+				VECTOR moveVec = VSub(chaserWayPoint[0], chaserPosition);
+				float moveLength = VSize(moveVec);
+				if(moveLength > CHASER_SPEED)
+				{
+					moveVec = VScale(moveVec, CHASER_SPEED / moveLength);
+				}
+				chaserPosition = VAdd(chaserPosition, moveVec);
+			}
+		}
+		DrawFormatString(5, 65, 65535, "D* Lite expand %d reuse %d  total expand %d reuse %d  reset %d  repair %d edges expand %d",
+			chaserDStar.expandNodeNum, chaserDStar.reuseNodeNum, chaserDStar.totalExpandNodeNum, chaserDStar.totalReuseNodeNum, chaserDStar.resetNum,
+			chaserDStar.repairEdgeNum, chaserDStar.repairExpandNodeNum);
+
+		// Ｂキーでフローフィールドのベンチマークを実行する
+		if(CheckHitKey(KEY_INPUT_B) != 0 && !flowBenchDone)
+		{
+			FlowField_Benchmark(FLOWFIELD_BENCHFRAME, FLOWAGENT_SPEED, flowBenchAgentTime, flowBenchUpdateTime);
+			flowBenchDone = true;
+		}
+		if(flowBenchDone)
+		{
+			int agentNum = 1;
+			for(int i=0; i<FLOWFIELD_BENCHNUM; i++, agentNum *= 10)
+			{
+				DrawFormatString(5, 85 + i * 20, 65535, "%5d agents  move %lldus  update %lldus", agentNum, flowBenchAgentTime[i], flowBenchUpdateTime[i]);
+			}
+		}
+
 		// ステージモデルを描画する
 		MV1DrawModel(stageModelHandle);
 
-		// 探索した経路のポリゴンの輪郭を描画する( デバッグ表示 )
+		// 探索した経路のポリゴンの輪郭を描画する( デバッグ表示、図形はためておいて最後にまとめて描画する )
 		pUnit = pathPlanning.goalUnit;
 		for(;;)
 		{
-			DrawTriangle3D(
+			DebugDraw_AddTriangle(
+				&debugDraw,
 				polyList.Vertexs[polyList.Polygons[pUnit->polyIndex].VIndex[0]].Position,
 				polyList.Vertexs[polyList.Polygons[pUnit->polyIndex].VIndex[1]].Position,
 				polyList.Vertexs[polyList.Polygons[pUnit->polyIndex].VIndex[2]].Position,
-				GetColor(255, 0, 0),
+				GetColorU8(255, 0, 0, 255),
 				false
 			);
 
@@ -889,17 +1287,85 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 
 		// 移動中の現在座標に球体を描画する
-		DrawSphere3D(VAdd(pathMove.nowPosition, VGet(0.0f, 40.0f, 0.0f)), SPHERESIZE, 10, GetColor(255, 0, 0), GetColor(0, 0, 0), true);
+		DebugDraw_AddSphere(&debugDraw, VAdd(pathMove.nowPosition, VGet(0.0f, 40.0f, 0.0f)), SPHERESIZE, GetColorU8(255, 0, 0, 255), true);
+
+		// 球体を追いかけるエージェントを描画する
+		for(int i=0; i<FLOWAGENT_NUM; i++)
+		{
+			DebugDraw_AddSphere(&debugDraw, VAdd(flowAgent[i].position, VGet(0.0f, 40.0f, 0.0f)), FLOWAGENT_SIZE, GetColorU8(0, 128, 255, 255), true);
+		}
+
+		// 差分経路探索で球体を追いかけるものを描画する
+		DebugDraw_AddSphere(&debugDraw, VAdd(chaserPosition, VGet(0.0f, 40.0f, 0.0f)), SPHERESIZE, GetColorU8(0, 255, 0, 255), true);
+
+		// 障害物と、障害物で通れないポリゴンの輪郭を描画する
+		for(int i=0; i<NAVTILE_MAXOBSTACLE; i++)
+		{
+			const NAVOBSTACLE *obstacle = NavTile_GetObstacle(i);
+			if(obstacle->active)
+			{
+				DebugDraw_AddCapsule(&debugDraw, obstacle->position, VAdd(obstacle->position, VGet(0.0f, OBSTACLE_HEIGHT, 0.0f)), OBSTACLE_RADIUS, GetColorU8(128, 128, 128, 255), true);
+			}
+		}
+		for(int i=0; i<polyList.PolygonNum; i++)
+		{
+			if(NavTile_IsPolyBlocked(i))
+			{
+				DebugDraw_AddTriangle(
+					&debugDraw,
+					polyList.Vertexs[polyList.Polygons[i].VIndex[0]].Position,
+					polyList.Vertexs[polyList.Polygons[i].VIndex[1]].Position,
+					polyList.Vertexs[polyList.Polygons[i].VIndex[2]].Position,
+					GetColorU8(255, 255, 0, 255),
+					false
+				);
+			}
+		}
+
+		// ためておいた確認用の図形をまとめて描画する
+		DebugDraw_Flush(&debugDraw);
+		DrawFormatString(5, 225, 65535, "debug draw call %d  line %d  triangle %d",
+			debugDraw.lastDrawCallNum, debugDraw.lastDrawLineNum, debugDraw.lastDrawTriangleNum);
 
 		// 裏画面の内容を表画面に反映
 		ScreenFlip();
 	}
 
+	// 確認用の図形の入れ物の後始末
+	DebugDraw_Terminate(&debugDraw);
+
+	// 差分経路探索の後始末
+	PathDStar_Terminate(&chaserDStar);
+
+	// フローフィールドの後始末
+	FlowField_Terminate(&flowField);
+
+	// 経路探索サービスの後始末
+	PathService_Terminate();
+
+	// タイルの情報の後始末
+	NavTile_Terminate();
+
 	// 経路情報の後始末
 	TerminatePathPlanning();
 
-	// ステージモデルのポリゴン同士の連結情報の後始末
-	TerminatePolyLinkInfo();
+	// 階層的経路探索用のクラスタの後始末
+	PathCluster_TerminateWork(&pathClusterWork);
+	PathCluster_Terminate();
+
+	if(NavMesh_IsLoaded())
+	{
+		// マップしたナビメッシュファイルの後始末
+		NavMesh_Unload();
+	}
+	else
+	{
+		// ポリゴン検索用の格子の後始末
+		TerminatePolyGrid();
+
+		// ステージモデルのポリゴン同士の連結情報の後始末
+		TerminatePolyLinkInfo();
+	}
 
 	// DXライブラリの後始末
 	DxLib_End();
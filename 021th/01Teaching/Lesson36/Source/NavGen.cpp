@@ -0,0 +1,1852 @@
+﻿#include "NavGen.h"
+#include <malloc.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details ステージのポリゴンからのナビメッシュの自動生成
+*          ステージをボクセル化して、キャラクターが立てる床だけを残し、壁から当たり判定の半径だけ削ってから
+*          領域に分け、領域の輪郭を単純化して三角形に分割する
+*          ステージはタイルに分けて、タイルごとに別々のスレッドで生成し、最後に頂点を共有させて１つのポリゴンの一覧にする
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const int NAVGEN_DIRX[4] = { -1, 0, 1, 0 };		//!< 方向ごとの隣のボクセルへのＸ方向の差分( 0:-X  1:+Z  2:+X  3:-Z )
+const int NAVGEN_DIRZ[4] = { 0, 1, 0, -1 };		//!< 方向ごとの隣のボクセルへのＺ方向の差分
+const int NAVGEN_MAXSPANHEIGHT = 0xffff;		//!< スパンの高さの最大値( ボクセルの数 )
+const int NAVGEN_MAXCLIPVERTEX = 12;			//!< 三角形をボクセルの境界で切り取った多角形の最大の頂点数
+const int NAVGEN_BORDERREG = 0x40000000;		//!< タイルの周囲の余白のボクセルに付ける領域番号( 下位ビットは余白の辺ごとの番号 )
+const int NAVGEN_NULLNEIGHBOR = -1;				//!< 領域分けで下の行の複数の領域と接していることを表す値
+const int NAVGEN_MERGEVERTEXHEIGHT = 2;			//!< 頂点を共有させる時に同じ頂点とみなす高さの差( ボクセルの数 )
+const int NAVGEN_CANREMOVE = 0x40000000;		//!< 三角形分割で耳として切り取れる頂点に付ける印
+const int NAVGEN_INDEXMASK = 0x0fffffff;		//!< 三角形分割で頂点の番号を取り出すマスク
+
+/**
+* @struct NAVGEN_SPAN
+* @brief ボクセル化した時に縦に連続して埋まっているボクセルの範囲
+*/
+struct NAVGEN_SPAN
+{
+	int smin;								//!< 下端の高さ( ボクセルの数 )
+	int smax;								//!< 上端の高さ( ボクセルの数 )
+	int area;								//!< 上端に立てるかどうか( 0:立てない  1:立てる )
+	int next;								//!< 同じ列の一つ上のスパンの番号( -1:無し )
+};
+
+/**
+* @struct NAVGEN_SWEEP
+* @brief 領域分けで１行の中で連続しているボクセルの並びの情報
+*/
+struct NAVGEN_SWEEP
+{
+	int id;									//!< 並びに割り当てる領域番号
+	int neighborCount;						//!< 下の行の領域と接しているボクセルの数
+	int neighbor;							//!< 接している下の行の領域番号( 0:無し  NAVGEN_NULLNEIGHBOR:複数 )
+};
+
+/**
+* @struct NAVGEN_TILE
+* @brief タイル１つの生成の作業用の情報と結果
+* @details 座標は周囲の余白を含めたタイルの左手前を 0 とするボクセルの番号
+*/
+struct NAVGEN_TILE
+{
+	int originX;							//!< タイルの左端のボクセルの全体での番号( 余白を含む )
+	int originZ;							//!< タイルの手前端のボクセルの全体での番号( 余白を含む )
+	int width;								//!< Ｘ方向のボクセルの数( 余白を含む )
+	int height;								//!< Ｚ方向のボクセルの数( 余白を含む )
+	VECTOR bmin;							//!< タイルの左手前下のワールド座標
+
+	int *columnHead;						//!< 各列の一番下のスパンの番号( -1:無し )
+	NAVGEN_SPAN *spanArray;					//!< スパンの配列
+	int spanNum;							//!< 使用したスパンの数
+	int spanMax;							//!< spanArray に確保した数
+	int freeSpan;							//!< 結合して空いたスパンの番号( -1:無し )
+
+	int *cellIndex;							//!< 各列の床の先頭の番号
+	int *cellCount;							//!< 各列の床の数
+	int floorNum;							//!< 床の数
+	int *floorY;							//!< 床の高さ
+	int *floorHeight;						//!< 床から天井までの高さ
+	BYTE *floorArea;						//!< 床に立てるかどうか( 0:立てない  1:立てる )
+	int *floorConnect;						//!< 各方向に繋がっている床の番号( 床１つにつき４つ、-1:繋がっていない )
+	BYTE *floorDist;						//!< 床の壁からの距離
+	int *floorRegion;						//!< 床の領域番号( 0:無し )
+	BYTE *floorFlag;						//!< 輪郭を辿っていない境界の辺( 方向ごとのビット )
+
+	int *rawVertex;							//!< 辿った輪郭の頂点( Ｘ、高さ、Ｚ、辺の向こうの領域番号 )
+	int rawNum;								//!< 辿った輪郭の頂点の数
+	int rawMax;								//!< rawVertex に確保した数
+	int *simpleVertex;						//!< 単純化した輪郭の頂点( Ｘ、高さ、Ｚ、rawVertex での番号 )
+	int simpleNum;							//!< 単純化した輪郭の頂点の数
+	int simpleMax;							//!< simpleVertex に確保した数
+	int *indexArray;						//!< 三角形分割で残っている頂点の番号
+
+	int *triangleVertex;					//!< 生成した三角形の頂点の全体でのボクセルの番号( 三角形１つにつきＸ、高さ、Ｚを３つ )
+	int triangleNum;						//!< 生成した三角形の数
+	int triangleMax;						//!< triangleVertex に確保した数
+	int spanCount;							//!< 統計用のスパンの数
+	int regionNum;							//!< 残った領域の数
+	int failContourNum;						//!< 三角形に分割できなかった輪郭の数
+	LONGLONG buildTime;						//!< 生成にかかった時間( マイクロ秒 )
+};
+
+/**
+* @struct NAVGENINFO
+* @brief ナビメッシュの自動生成全体の情報
+*/
+struct NAVGENINFO
+{
+	const MV1_REF_POLYGONLIST *source;		//!< ステージのポリゴン
+	BYTE *sourceArea;						//!< ステージの各ポリゴンに立てるかどうか
+	NAVGEN_CONFIG config;					//!< 生成の設定
+	VECTOR bmin;							//!< ステージ全体の最小座標
+	int maxSpanHeight;						//!< ステージ全体の高さ( ボクセルの数 )
+	int tileNumX;							//!< Ｘ方向のタイルの数
+	int tileNumZ;							//!< Ｚ方向のタイルの数
+	int tileNum;							//!< タイルの数
+	int border;								//!< タイルの周囲に付ける余白のボクセルの数
+	int walkableHeight;						//!< 通るのに必要な天井までの高さ( ボクセルの数 )
+	int walkableClimb;						//!< 乗り越えられる段差の高さ( ボクセルの数 )
+	int walkableRadius;						//!< 壁から削る幅( ボクセルの数 )
+	NAVGEN_TILE *tileArray;					//!< タイルの配列
+	volatile LONG nextTile;					//!< 次に生成するタイルの番号
+};
+
+static NAVGENINFO navGen;						//!< ナビメッシュの自動生成の実体
+
+/**
+* @fn NavGen_Reserve
+* @brief 可変長の配列に必要な数の領域を確保する
+* @param[in,out] void **array, int *max 確保済みの数, int need 必要な数, int elementSize 要素１つのサイズ
+*/
+static void NavGen_Reserve(void **array, int *max, int need, int elementSize)
+{
+	if(need <= *max)
+	{
+		return;
+	}
+	int newMax = *max > 0 ? *max * 2 : 64;
+	while(newMax < need)
+	{
+		newMax *= 2;
+	}
+	*array = realloc(*array, (size_t)newMax * elementSize);
+	*max = newMax;
+}
+
+/**
+* @fn NavGen_AddSpan
+* @brief 列にスパンを追加し、重なるスパンと結合する
+* @param[in] NAVGEN_TILE *tile, int x, int z, int smin, int smax, int area
+* @details 上端が段差の高さ以内で揃っているスパン同士は、どちらかが立てるなら立てるスパンにする
+*/
+static void NavGen_AddSpan(NAVGEN_TILE *tile, int x, int z, int smin, int smax, int area)
+{
+	int column = x + z * tile->width;
+	int prev = -1;
+	int cur = tile->columnHead[column];
+	while(cur != -1)
+	{
+		NAVGEN_SPAN *span = &tile->spanArray[cur];
+		if(span->smin > smax)
+		{
+			break;
+		}
+		if(span->smax < smin)
+		{
+			prev = cur;
+			cur = span->next;
+			continue;
+		}
+
+		// 重なっているので結合し、上端が高い方の立てるかどうかを使う
+		if(span->smax > smax + navGen.walkableClimb)
+		{
+			area = span->area;
+		}
+		else if(abs(span->smax - smax) <= navGen.walkableClimb && span->area > area)
+		{
+			area = span->area;
+		}
+		if(span->smin < smin)
+		{
+			smin = span->smin;
+		}
+		if(span->smax > smax)
+		{
+			smax = span->smax;
+		}
+
+		// 結合したスパンは空きにする
+		int next = span->next;
+		span->next = tile->freeSpan;
+		tile->freeSpan = cur;
+		if(prev != -1)
+		{
+			tile->spanArray[prev].next = next;
+		}
+		else
+		{
+			tile->columnHead[column] = next;
+		}
+		cur = next;
+	}
+
+	int index = tile->freeSpan;
+	if(index != -1)
+	{
+		tile->freeSpan = tile->spanArray[index].next;
+	}
+	else
+	{
+		NavGen_Reserve((void **)&tile->spanArray, &tile->spanMax, tile->spanNum + 1, sizeof(NAVGEN_SPAN));
+		index = tile->spanNum++;
+	}
+	NAVGEN_SPAN *span = &tile->spanArray[index];
+	span->smin = smin;
+	span->smax = smax;
+	span->area = area;
+	if(prev != -1)
+	{
+		span->next = tile->spanArray[prev].next;
+		tile->spanArray[prev].next = index;
+	}
+	else
+	{
+		span->next = tile->columnHead[column];
+		tile->columnHead[column] = index;
+	}
+}
+
+/**
+* @fn NavGen_DividePoly
+* @brief 多角形を指定の軸の座標で２つに分ける
+* @param[in] const float *in, int inNum, float *out1 座標より小さい側, int *out1Num, float *out2 座標より大きい側, int *out2Num, float position, int axis 0:Ｘ 2:Ｚ
+*/
+static void NavGen_DividePoly(const float *in, int inNum, float *out1, int *out1Num, float *out2, int *out2Num, float position, int axis)
+{
+	float d[NAVGEN_MAXCLIPVERTEX];
+	for(int i=0; i<inNum; i++)
+	{
+		d[i] = position - in[i * 3 + axis];
+	}
+
+	int m = 0;
+	int n = 0;
+	for(int i=0, j=inNum-1; i<inNum; j=i, i++)
+	{
+		bool ina = d[j] >= 0.0f;
+		bool inb = d[i] >= 0.0f;
+		if(ina != inb)
+		{
+			// 辺が座標をまたいでいるので、交点を両方に追加する
+			float s = d[j] / (d[j] - d[i]);
+			for(int k=0; k<3; k++)
+			{
+				out1[m * 3 + k] = in[j * 3 + k] + (in[i * 3 + k] - in[j * 3 + k]) * s;
+				out2[n * 3 + k] = out1[m * 3 + k];
+			}
+			m++;
+			n++;
+			if(d[i] > 0.0f)
+			{
+				memcpy(&out1[m * 3], &in[i * 3], sizeof(float) * 3);
+				m++;
+			}
+			else if(d[i] < 0.0f)
+			{
+				memcpy(&out2[n * 3], &in[i * 3], sizeof(float) * 3);
+				n++;
+			}
+		}
+		else
+		{
+			if(d[i] >= 0.0f)
+			{
+				memcpy(&out1[m * 3], &in[i * 3], sizeof(float) * 3);
+				m++;
+				if(d[i] != 0.0f)
+				{
+					continue;
+				}
+			}
+			memcpy(&out2[n * 3], &in[i * 3], sizeof(float) * 3);
+			n++;
+		}
+	}
+	*out1Num = m;
+	*out2Num = n;
+}
+
+/**
+* @fn NavGen_RasterizeTriangle
+* @brief 三角形をボクセルの列ごとに切り取って、列ごとにスパンを追加する
+* @param[in] NAVGEN_TILE *tile, VECTOR v0, VECTOR v1, VECTOR v2, int area
+*/
+static void NavGen_RasterizeTriangle(NAVGEN_TILE *tile, VECTOR v0, VECTOR v1, VECTOR v2, int area)
+{
+	float buffer[NAVGEN_MAXCLIPVERTEX * 3 * 4];
+	float *in = buffer;
+	float *inRow = buffer + NAVGEN_MAXCLIPVERTEX * 3;
+	float *p1 = inRow + NAVGEN_MAXCLIPVERTEX * 3;
+	float *p2 = p1 + NAVGEN_MAXCLIPVERTEX * 3;
+	float cs = navGen.config.cellSize;
+	float ch = navGen.config.cellHeight;
+	float maxY = navGen.maxSpanHeight * ch;
+
+	in[0] = v0.x; in[1] = v0.y; in[2] = v0.z;
+	in[3] = v1.x; in[4] = v1.y; in[5] = v1.z;
+	in[6] = v2.x; in[7] = v2.y; in[8] = v2.z;
+	int inNum = 3;
+
+	float minZ = v0.z < v1.z ? (v0.z < v2.z ? v0.z : v2.z) : (v1.z < v2.z ? v1.z : v2.z);
+	float maxZ = v0.z > v1.z ? (v0.z > v2.z ? v0.z : v2.z) : (v1.z > v2.z ? v1.z : v2.z);
+	int z0 = (int)floorf((minZ - tile->bmin.z) / cs);
+	int z1 = (int)floorf((maxZ - tile->bmin.z) / cs);
+	if(z1 < 0 || z0 >= tile->height)
+	{
+		return;
+	}
+	z0 = z0 < -1 ? -1 : z0;
+	z1 = z1 >= tile->height ? tile->height - 1 : z1;
+
+	for(int z=z0; z<=z1; z++)
+	{
+		// Ｚ方向の１行分を切り取る
+		int rowNum;
+		float cz = tile->bmin.z + z * cs;
+		NavGen_DividePoly(in, inNum, inRow, &rowNum, p1, &inNum, cz + cs, 2);
+		float *swap = in;
+		in = p1;
+		p1 = swap;
+		if(rowNum < 3 || z < 0)
+		{
+			continue;
+		}
+
+		float minX = inRow[0];
+		float maxX = inRow[0];
+		for(int i=1; i<rowNum; i++)
+		{
+			minX = inRow[i * 3] < minX ? inRow[i * 3] : minX;
+			maxX = inRow[i * 3] > maxX ? inRow[i * 3] : maxX;
+		}
+		int x0 = (int)floorf((minX - tile->bmin.x) / cs);
+		int x1 = (int)floorf((maxX - tile->bmin.x) / cs);
+		if(x1 < 0 || x0 >= tile->width)
+		{
+			continue;
+		}
+		x0 = x0 < -1 ? -1 : x0;
+		x1 = x1 >= tile->width ? tile->width - 1 : x1;
+
+		for(int x=x0; x<=x1; x++)
+		{
+			// Ｘ方向の１マス分を切り取る
+			int cellNum;
+			float cx = tile->bmin.x + x * cs;
+			NavGen_DividePoly(inRow, rowNum, p1, &cellNum, p2, &rowNum, cx + cs, 0);
+			swap = inRow;
+			inRow = p2;
+			p2 = swap;
+			if(cellNum < 3 || x < 0)
+			{
+				continue;
+			}
+
+			// 切り取った多角形の高さの範囲をスパンにする
+			float spanMin = p1[1];
+			float spanMax = p1[1];
+			for(int i=1; i<cellNum; i++)
+			{
+				spanMin = p1[i * 3 + 1] < spanMin ? p1[i * 3 + 1] : spanMin;
+				spanMax = p1[i * 3 + 1] > spanMax ? p1[i * 3 + 1] : spanMax;
+			}
+			spanMin -= tile->bmin.y;
+			spanMax -= tile->bmin.y;
+			if(spanMax < 0.0f || spanMin > maxY)
+			{
+				continue;
+			}
+			spanMin = spanMin < 0.0f ? 0.0f : spanMin;
+			spanMax = spanMax > maxY ? maxY : spanMax;
+
+			int smin = (int)floorf(spanMin / ch);
+			int smax = (int)ceilf(spanMax / ch);
+			smin = smin > NAVGEN_MAXSPANHEIGHT - 1 ? NAVGEN_MAXSPANHEIGHT - 1 : smin;
+			smax = smax <= smin ? smin + 1 : (smax > NAVGEN_MAXSPANHEIGHT ? NAVGEN_MAXSPANHEIGHT : smax);
+			NavGen_AddSpan(tile, x, z, smin, smax, area);
+		}
+	}
+}
+
+/**
+* @fn NavGen_Rasterize
+* @brief タイルと重なるステージのポリゴンをボクセル化する
+* @param[in] NAVGEN_TILE *tile
+*/
+static void NavGen_Rasterize(NAVGEN_TILE *tile)
+{
+	const MV1_REF_POLYGONLIST *source = navGen.source;
+	float cs = navGen.config.cellSize;
+	float maxX = tile->bmin.x + tile->width * cs;
+	float maxZ = tile->bmin.z + tile->height * cs;
+
+	for(int i=0; i<source->PolygonNum; i++)
+	{
+		const MV1_REF_POLYGON *refPoly = &source->Polygons[i];
+		if(refPoly->MaxPosition.x < tile->bmin.x || refPoly->MinPosition.x > maxX ||
+			refPoly->MaxPosition.z < tile->bmin.z || refPoly->MinPosition.z > maxZ)
+		{
+			continue;
+		}
+		NavGen_RasterizeTriangle(tile,
+			source->Vertexs[refPoly->VIndex[0]].Position,
+			source->Vertexs[refPoly->VIndex[1]].Position,
+			source->Vertexs[refPoly->VIndex[2]].Position,
+			navGen.sourceArea[i]);
+	}
+}
+
+/**
+* @fn NavGen_FilterSpans
+* @brief 低い段差の上を立てるようにし、天井が低くて通れないスパンを立てないようにする
+* @param[in] NAVGEN_TILE *tile
+*/
+static void NavGen_FilterSpans(NAVGEN_TILE *tile)
+{
+	int columnNum = tile->width * tile->height;
+	for(int i=0; i<columnNum; i++)
+	{
+		// 立てるスパンのすぐ上に乗っている低い段差は立てるようにする
+		bool prevWalkable = false;
+		int prevArea = 0;
+		int prevMax = 0;
+		for(int s=tile->columnHead[i]; s!=-1; s=tile->spanArray[s].next)
+		{
+			NAVGEN_SPAN *span = &tile->spanArray[s];
+			bool walkable = span->area != 0;
+			if(!walkable && prevWalkable && abs(span->smax - prevMax) <= navGen.walkableClimb)
+			{
+				span->area = prevArea;
+			}
+
+			// 変更後の値を使うと段差が何段も続く場合に伝わってしまうので、元の値を覚えておく
+			prevWalkable = walkable;
+			prevArea = span->area;
+			prevMax = span->smax;
+		}
+
+		// 上のスパンまでの高さが足りない場合は立てない
+		for(int s=tile->columnHead[i]; s!=-1; s=tile->spanArray[s].next)
+		{
+			NAVGEN_SPAN *span = &tile->spanArray[s];
+			int top = span->next != -1 ? tile->spanArray[span->next].smin : NAVGEN_MAXSPANHEIGHT;
+			if(top - span->smax < navGen.walkableHeight)
+			{
+				span->area = 0;
+			}
+		}
+	}
+}
+
+/**
+* @fn NavGen_BuildFloors
+* @brief 立てるスパンの上端を床にして、隣の列の床との繋がりを求める
+* @param[in] NAVGEN_TILE *tile
+*/
+static void NavGen_BuildFloors(NAVGEN_TILE *tile)
+{
+	int columnNum = tile->width * tile->height;
+	tile->floorNum = 0;
+	for(int i=0; i<columnNum; i++)
+	{
+		for(int s=tile->columnHead[i]; s!=-1; s=tile->spanArray[s].next)
+		{
+			tile->spanCount++;
+			if(tile->spanArray[s].area != 0)
+			{
+				tile->floorNum++;
+			}
+		}
+	}
+
+	int floorNum = tile->floorNum > 0 ? tile->floorNum : 1;
+	tile->cellIndex = (int *)malloc(sizeof(int) * columnNum);
+	tile->cellCount = (int *)malloc(sizeof(int) * columnNum);
+	tile->floorY = (int *)malloc(sizeof(int) * floorNum);
+	tile->floorHeight = (int *)malloc(sizeof(int) * floorNum);
+	tile->floorArea = (BYTE *)malloc(sizeof(BYTE) * floorNum);
+	tile->floorConnect = (int *)malloc(sizeof(int) * floorNum * 4);
+	tile->floorDist = (BYTE *)malloc(sizeof(BYTE) * floorNum);
+	tile->floorRegion = (int *)malloc(sizeof(int) * floorNum);
+	tile->floorFlag = (BYTE *)malloc(sizeof(BYTE) * floorNum);
+
+	// 床の高さと天井までの高さ
+	int index = 0;
+	for(int i=0; i<columnNum; i++)
+	{
+		tile->cellIndex[i] = index;
+		tile->cellCount[i] = 0;
+		for(int s=tile->columnHead[i]; s!=-1; s=tile->spanArray[s].next)
+		{
+			NAVGEN_SPAN *span = &tile->spanArray[s];
+			if(span->area == 0)
+			{
+				continue;
+			}
+			int top = span->next != -1 ? tile->spanArray[span->next].smin : NAVGEN_MAXSPANHEIGHT;
+			tile->floorY[index] = span->smax;
+			tile->floorHeight[index] = top - span->smax;
+			tile->floorArea[index] = (BYTE)span->area;
+			tile->floorRegion[index] = 0;
+			index++;
+			tile->cellCount[i]++;
+		}
+	}
+
+	// 段差が乗り越えられる高さ以内で、重なっている部分の高さが足りている隣の床と繋げる
+	for(int z=0; z<tile->height; z++)
+	{
+		for(int x=0; x<tile->width; x++)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				for(int dir=0; dir<4; dir++)
+				{
+					tile->floorConnect[i * 4 + dir] = -1;
+					int nx = x + NAVGEN_DIRX[dir];
+					int nz = z + NAVGEN_DIRZ[dir];
+					if(nx < 0 || nz < 0 || nx >= tile->width || nz >= tile->height)
+					{
+						continue;
+					}
+					int neighborCell = nx + nz * tile->width;
+					for(int k=tile->cellIndex[neighborCell]; k<tile->cellIndex[neighborCell]+tile->cellCount[neighborCell]; k++)
+					{
+						int bottom = tile->floorY[i] > tile->floorY[k] ? tile->floorY[i] : tile->floorY[k];
+						int topI = tile->floorY[i] + tile->floorHeight[i];
+						int topK = tile->floorY[k] + tile->floorHeight[k];
+						int top = topI < topK ? topI : topK;
+						if(top - bottom >= navGen.walkableHeight && abs(tile->floorY[k] - tile->floorY[i]) <= navGen.walkableClimb)
+						{
+							tile->floorConnect[i * 4 + dir] = k;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn NavGen_Erode
+* @brief 壁や段差の縁からキャラクターの当たり判定の半径以内の床を立てないようにする
+* @param[in] NAVGEN_TILE *tile
+* @details 縦横を 2、斜めを 3 とした距離を２回の走査で求める
+*/
+static void NavGen_Erode(NAVGEN_TILE *tile)
+{
+	int *con = tile->floorConnect;
+	BYTE *dist = tile->floorDist;
+
+	// ４方向全てに立てる床が繋がっていない床を縁とする
+	for(int i=0; i<tile->floorNum; i++)
+	{
+		dist[i] = 0xff;
+		if(tile->floorArea[i] == 0)
+		{
+			dist[i] = 0;
+			continue;
+		}
+		int connectNum = 0;
+		for(int dir=0; dir<4; dir++)
+		{
+			if(con[i * 4 + dir] != -1 && tile->floorArea[con[i * 4 + dir]] != 0)
+			{
+				connectNum++;
+			}
+		}
+		if(connectNum != 4)
+		{
+			dist[i] = 0;
+		}
+	}
+
+	// 左手前から右奥に向かって、左と手前、左手前からの距離を伝える
+	for(int z=0; z<tile->height; z++)
+	{
+		for(int x=0; x<tile->width; x++)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				int a = con[i * 4 + 0];
+				if(a != -1)
+				{
+					dist[i] = dist[a] + 2 < dist[i] ? (BYTE)(dist[a] + 2) : dist[i];
+					int aa = con[a * 4 + 3];
+					if(aa != -1)
+					{
+						dist[i] = dist[aa] + 3 < dist[i] ? (BYTE)(dist[aa] + 3) : dist[i];
+					}
+				}
+				a = con[i * 4 + 3];
+				if(a != -1)
+				{
+					dist[i] = dist[a] + 2 < dist[i] ? (BYTE)(dist[a] + 2) : dist[i];
+					int aa = con[a * 4 + 2];
+					if(aa != -1)
+					{
+						dist[i] = dist[aa] + 3 < dist[i] ? (BYTE)(dist[aa] + 3) : dist[i];
+					}
+				}
+			}
+		}
+	}
+
+	// 右奥から左手前に向かって、右と奥、右奥からの距離を伝える
+	for(int z=tile->height-1; z>=0; z--)
+	{
+		for(int x=tile->width-1; x>=0; x--)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				int a = con[i * 4 + 2];
+				if(a != -1)
+				{
+					dist[i] = dist[a] + 2 < dist[i] ? (BYTE)(dist[a] + 2) : dist[i];
+					int aa = con[a * 4 + 1];
+					if(aa != -1)
+					{
+						dist[i] = dist[aa] + 3 < dist[i] ? (BYTE)(dist[aa] + 3) : dist[i];
+					}
+				}
+				a = con[i * 4 + 1];
+				if(a != -1)
+				{
+					dist[i] = dist[a] + 2 < dist[i] ? (BYTE)(dist[a] + 2) : dist[i];
+					int aa = con[a * 4 + 0];
+					if(aa != -1)
+					{
+						dist[i] = dist[aa] + 3 < dist[i] ? (BYTE)(dist[aa] + 3) : dist[i];
+					}
+				}
+			}
+		}
+	}
+
+	int threshold = navGen.walkableRadius * 2;
+	for(int i=0; i<tile->floorNum; i++)
+	{
+		if(dist[i] < threshold)
+		{
+			tile->floorArea[i] = 0;
+		}
+	}
+}
+
+/**
+* @fn NavGen_BuildRegions
+* @brief 立てる床を穴の無い領域に分ける
+* @param[in] NAVGEN_TILE *tile
+* @details Ｘ方向に連続している床の並びを１行ずつ作り、下の行の領域と１対１で接している場合だけ同じ領域にする
+*          タイルの周囲の余白は辺ごとに別の NAVGEN_BORDERREG の番号にして、どの領域にも含めない
+*          ( 辺ごとに分けることで、タイルの角で輪郭の頂点が残る )
+*/
+static void NavGen_BuildRegions(NAVGEN_TILE *tile)
+{
+	int border = navGen.border;
+	int *reg = tile->floorRegion;
+	int *con = tile->floorConnect;
+
+	// 余白の床に印を付ける( 手前と奥の辺を左右の辺より優先する )
+	for(int z=0; z<tile->height; z++)
+	{
+		for(int x=0; x<tile->width; x++)
+		{
+			int side = z < border ? 3 : (z >= tile->height - border ? 4 : (x < border ? 1 : (x >= tile->width - border ? 2 : 0)));
+			if(side == 0)
+			{
+				continue;
+			}
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				if(tile->floorArea[i] != 0)
+				{
+					reg[i] = NAVGEN_BORDERREG | side;
+				}
+			}
+		}
+	}
+
+	NAVGEN_SWEEP *sweep = (NAVGEN_SWEEP *)malloc(sizeof(NAVGEN_SWEEP) * (tile->floorNum + 1));
+	int *prevCount = (int *)malloc(sizeof(int) * (tile->floorNum + 1));
+	int id = 1;
+	for(int z=border; z<tile->height-border; z++)
+	{
+		memset(prevCount, 0, sizeof(int) * id);
+		int sweepNum = 1;
+
+		for(int x=border; x<tile->width-border; x++)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				if(tile->floorArea[i] == 0)
+				{
+					continue;
+				}
+
+				// 左の床と同じ並びにする
+				int sweepId = 0;
+				int a = con[i * 4 + 0];
+				if(a != -1 && tile->floorArea[a] != 0 && (reg[a] & NAVGEN_BORDERREG) == 0)
+				{
+					sweepId = reg[a];
+				}
+				if(sweepId == 0)
+				{
+					sweepId = sweepNum++;
+					sweep[sweepId].neighborCount = 0;
+					sweep[sweepId].neighbor = 0;
+				}
+
+				// 手前の行の領域と接しているか
+				a = con[i * 4 + 3];
+				if(a != -1 && reg[a] != 0 && (reg[a] & NAVGEN_BORDERREG) == 0)
+				{
+					int neighborId = reg[a];
+					if(sweep[sweepId].neighbor == 0 || sweep[sweepId].neighbor == neighborId)
+					{
+						sweep[sweepId].neighbor = neighborId;
+						sweep[sweepId].neighborCount++;
+						prevCount[neighborId]++;
+					}
+					else
+					{
+						sweep[sweepId].neighbor = NAVGEN_NULLNEIGHBOR;
+					}
+				}
+				reg[i] = sweepId;
+			}
+		}
+
+		// 手前の行の領域と１対１で接している並びはその領域を続け、それ以外は新しい領域にする
+		for(int i=1; i<sweepNum; i++)
+		{
+			int neighborId = sweep[i].neighbor;
+			if(neighborId != NAVGEN_NULLNEIGHBOR && neighborId != 0 && prevCount[neighborId] == sweep[i].neighborCount)
+			{
+				sweep[i].id = neighborId;
+			}
+			else
+			{
+				sweep[i].id = id++;
+			}
+		}
+		for(int x=border; x<tile->width-border; x++)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				if(reg[i] > 0 && reg[i] < sweepNum)
+				{
+					reg[i] = sweep[reg[i]].id;
+				}
+			}
+		}
+	}
+
+	// 小さすぎる領域は捨てる( 隣のタイルに続いている領域は隣と合わせると小さくないかもしれないので残す )
+	int *regionArea = prevCount;
+	BYTE *regionBorder = (BYTE *)malloc(sizeof(BYTE) * (id + 1));
+	memset(regionArea, 0, sizeof(int) * id);
+	memset(regionBorder, 0, sizeof(BYTE) * id);
+	for(int i=0; i<tile->floorNum; i++)
+	{
+		if(reg[i] == 0 || (reg[i] & NAVGEN_BORDERREG) != 0)
+		{
+			continue;
+		}
+		regionArea[reg[i]]++;
+		for(int dir=0; dir<4; dir++)
+		{
+			int a = con[i * 4 + dir];
+			if(a != -1 && (reg[a] & NAVGEN_BORDERREG) != 0)
+			{
+				regionBorder[reg[i]] = 1;
+			}
+		}
+	}
+	tile->regionNum = 0;
+	for(int i=1; i<id; i++)
+	{
+		if(regionArea[i] > 0 && (regionArea[i] >= navGen.config.minRegionArea || regionBorder[i]))
+		{
+			tile->regionNum++;
+		}
+	}
+	for(int i=0; i<tile->floorNum; i++)
+	{
+		if(reg[i] != 0 && (reg[i] & NAVGEN_BORDERREG) == 0 &&
+			regionArea[reg[i]] < navGen.config.minRegionArea && regionBorder[reg[i]] == 0)
+		{
+			reg[i] = 0;
+		}
+	}
+
+	free(regionBorder);
+	free(prevCount);
+	free(sweep);
+}
+
+/**
+* @fn NavGen_GetCornerHeight
+* @brief 床の指定の方向の辺の終わりの角の高さを求める
+* @param[in] NAVGEN_TILE *tile, int i 床の番号, int dir
+* @return int 角を囲む床の中で一番高い床の高さ
+*/
+static int NavGen_GetCornerHeight(NAVGEN_TILE *tile, int i, int dir)
+{
+	int *con = tile->floorConnect;
+	int nextDir = (dir + 1) & 0x3;
+	int height = tile->floorY[i];
+
+	int a = con[i * 4 + dir];
+	if(a != -1)
+	{
+		height = tile->floorY[a] > height ? tile->floorY[a] : height;
+		int aa = con[a * 4 + nextDir];
+		if(aa != -1)
+		{
+			height = tile->floorY[aa] > height ? tile->floorY[aa] : height;
+		}
+	}
+	a = con[i * 4 + nextDir];
+	if(a != -1)
+	{
+		height = tile->floorY[a] > height ? tile->floorY[a] : height;
+		int aa = con[a * 4 + dir];
+		if(aa != -1)
+		{
+			height = tile->floorY[aa] > height ? tile->floorY[aa] : height;
+		}
+	}
+	return height;
+}
+
+/**
+* @fn NavGen_WalkContour
+* @brief 指定の床から領域の境界の辺を時計回りに辿って輪郭の頂点を求める
+* @param[in] NAVGEN_TILE *tile, int x, int z, int i 開始する床の番号
+* @details 頂点には、その頂点で終わる辺の向こう側の領域番号を持たせる
+*/
+static void NavGen_WalkContour(NAVGEN_TILE *tile, int x, int z, int i)
+{
+	BYTE *flag = tile->floorFlag;
+	int dir = 0;
+	while((flag[i] & (1 << dir)) == 0)
+	{
+		dir++;
+	}
+	int startDir = dir;
+	int startI = i;
+
+	tile->rawNum = 0;
+	for(int iter=0; iter<40000; iter++)
+	{
+		if(flag[i] & (1 << dir))
+		{
+			// 境界の辺なので、辺の終わりの角を頂点にする
+			int px = x;
+			int py = NavGen_GetCornerHeight(tile, i, dir);
+			int pz = z;
+			switch(dir)
+			{
+			case 0: pz++; break;
+			case 1: px++; pz++; break;
+			case 2: px++; break;
+			}
+			int a = tile->floorConnect[i * 4 + dir];
+			int r = a != -1 ? tile->floorRegion[a] : 0;
+
+			NavGen_Reserve((void **)&tile->rawVertex, &tile->rawMax, (tile->rawNum + 1) * 4, sizeof(int));
+			int *v = &tile->rawVertex[tile->rawNum * 4];
+			v[0] = px;
+			v[1] = py;
+			v[2] = pz;
+			v[3] = r;
+			tile->rawNum++;
+
+			flag[i] &= ~(1 << dir);
+			dir = (dir + 1) & 0x3;
+		}
+		else
+		{
+			// 同じ領域の隣の床に移る
+			int a = tile->floorConnect[i * 4 + dir];
+			if(a == -1)
+			{
+				return;
+			}
+			x += NAVGEN_DIRX[dir];
+			z += NAVGEN_DIRZ[dir];
+			i = a;
+			dir = (dir + 3) & 0x3;
+		}
+
+		if(i == startI && dir == startDir)
+		{
+			break;
+		}
+	}
+}
+
+/**
+* @fn NavGen_DistancePtSeg
+* @brief ＸＺ平面上の点と線分の距離の２乗
+* @param[in] int x, int z, int px, int pz, int qx, int qz
+* @return float 距離の２乗
+*/
+static float NavGen_DistancePtSeg(int x, int z, int px, int pz, int qx, int qz)
+{
+	float pqx = (float)(qx - px);
+	float pqz = (float)(qz - pz);
+	float dx = (float)(x - px);
+	float dz = (float)(z - pz);
+	float d = pqx * pqx + pqz * pqz;
+	float t = pqx * dx + pqz * dz;
+	if(d > 0.0f)
+	{
+		t /= d;
+	}
+	t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+	dx = px + t * pqx - x;
+	dz = pz + t * pqz - z;
+	return dx * dx + dz * dz;
+}
+
+/**
+* @fn NavGen_AddSimpleVertex
+* @brief 単純化した輪郭の指定の位置に、辿った輪郭の頂点を挿入する
+* @param[in] NAVGEN_TILE *tile, int position, int rawIndex
+*/
+static void NavGen_AddSimpleVertex(NAVGEN_TILE *tile, int position, int rawIndex)
+{
+	NavGen_Reserve((void **)&tile->simpleVertex, &tile->simpleMax, (tile->simpleNum + 1) * 4, sizeof(int));
+	int *v = &tile->simpleVertex[position * 4];
+	memmove(v + 4, v, sizeof(int) * 4 * (tile->simpleNum - position));
+	memcpy(v, &tile->rawVertex[rawIndex * 4], sizeof(int) * 3);
+	v[3] = rawIndex;
+	tile->simpleNum++;
+}
+
+/**
+* @fn NavGen_SimplifyContour
+* @brief 辿った輪郭を単純化する
+* @param[in] NAVGEN_TILE *tile
+* @details 隣の領域やタイルの余白と接する辺は両端だけを残し、壁に沿った辺は許されるずれに収まるまで頂点を足す
+*/
+static void NavGen_SimplifyContour(NAVGEN_TILE *tile)
+{
+	const int *raw = tile->rawVertex;
+	int rawNum = tile->rawNum;
+	tile->simpleNum = 0;
+
+	// 辺の向こう側の領域が変わる頂点を残す
+	for(int i=0; i<rawNum; i++)
+	{
+		if(raw[i * 4 + 3] != raw[((i + 1) % rawNum) * 4 + 3])
+		{
+			NavGen_AddSimpleVertex(tile, tile->simpleNum, i);
+		}
+	}
+
+	// 全て壁に囲まれている場合は左手前と右奥の頂点から始める
+	if(tile->simpleNum == 0)
+	{
+		int lowerLeft = 0;
+		int upperRight = 0;
+		for(int i=1; i<rawNum; i++)
+		{
+			int x = raw[i * 4 + 0];
+			int z = raw[i * 4 + 2];
+			if(x < raw[lowerLeft * 4 + 0] || (x == raw[lowerLeft * 4 + 0] && z < raw[lowerLeft * 4 + 2]))
+			{
+				lowerLeft = i;
+			}
+			if(x > raw[upperRight * 4 + 0] || (x == raw[upperRight * 4 + 0] && z > raw[upperRight * 4 + 2]))
+			{
+				upperRight = i;
+			}
+		}
+		NavGen_AddSimpleVertex(tile, 0, lowerLeft);
+		NavGen_AddSimpleVertex(tile, 1, upperRight);
+	}
+
+	// 壁に沿った辺は、一番離れている頂点が許されるずれに収まるまで頂点を足す
+	float maxError = navGen.config.maxEdgeError / navGen.config.cellSize;
+	for(int i=0; i<tile->simpleNum; )
+	{
+		int ii = (i + 1) % tile->simpleNum;
+		int ax = tile->simpleVertex[i * 4 + 0];
+		int az = tile->simpleVertex[i * 4 + 2];
+		int ai = tile->simpleVertex[i * 4 + 3];
+		int bx = tile->simpleVertex[ii * 4 + 0];
+		int bz = tile->simpleVertex[ii * 4 + 2];
+		int bi = tile->simpleVertex[ii * 4 + 3];
+
+		// 逆向きに辿っても同じ結果になるように、常に座標の小さい方から調べる
+		int ci;
+		int step;
+		int endi;
+		if(bx > ax || (bx == ax && bz > az))
+		{
+			step = 1;
+			ci = (ai + step) % rawNum;
+			endi = bi;
+		}
+		else
+		{
+			step = rawNum - 1;
+			ci = (bi + step) % rawNum;
+			endi = ai;
+			int swap = ax; ax = bx; bx = swap;
+			swap = az; az = bz; bz = swap;
+		}
+
+		float maxDist = 0.0f;
+		int maxIndex = -1;
+		if(raw[ci * 4 + 3] == 0)
+		{
+			while(ci != endi)
+			{
+				float d = NavGen_DistancePtSeg(raw[ci * 4 + 0], raw[ci * 4 + 2], ax, az, bx, bz);
+				if(d > maxDist)
+				{
+					maxDist = d;
+					maxIndex = ci;
+				}
+				ci = (ci + step) % rawNum;
+			}
+		}
+
+		if(maxIndex != -1 && maxDist > maxError * maxError)
+		{
+			NavGen_AddSimpleVertex(tile, i + 1, maxIndex);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// ＸＺ平面上で同じ位置に並んだ頂点を取り除く
+	for(int i=0; i<tile->simpleNum && tile->simpleNum > 0; )
+	{
+		int ii = (i + 1) % tile->simpleNum;
+		int *a = &tile->simpleVertex[i * 4];
+		int *b = &tile->simpleVertex[ii * 4];
+		if(tile->simpleNum > 1 && a[0] == b[0] && a[2] == b[2])
+		{
+			memmove(b, b + 4, sizeof(int) * 4 * (tile->simpleNum - ii - 1));
+			tile->simpleNum--;
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+/**
+* @fn NavGen_Area2
+* @brief ＸＺ平面上の３点が作る三角形の面積の２倍( 符号付き )
+* @param[in] const int *a, const int *b, const int *c
+* @return int
+*/
+static int NavGen_Area2(const int *a, const int *b, const int *c)
+{
+	return (b[0] - a[0]) * (c[2] - a[2]) - (c[0] - a[0]) * (b[2] - a[2]);
+}
+
+/**
+* @fn NavGen_Left
+* @brief c が a から b への線の左にあるかどうか
+* @param[in] const int *a, const int *b, const int *c
+* @return bool
+*/
+static bool NavGen_Left(const int *a, const int *b, const int *c)
+{
+	return NavGen_Area2(a, b, c) < 0;
+}
+
+/**
+* @fn NavGen_LeftOn
+* @brief c が a から b への線の左か線上にあるかどうか
+* @param[in] const int *a, const int *b, const int *c
+* @return bool
+*/
+static bool NavGen_LeftOn(const int *a, const int *b, const int *c)
+{
+	return NavGen_Area2(a, b, c) <= 0;
+}
+
+/**
+* @fn NavGen_Collinear
+* @brief ３点が一直線上にあるかどうか
+* @param[in] const int *a, const int *b, const int *c
+* @return bool
+*/
+static bool NavGen_Collinear(const int *a, const int *b, const int *c)
+{
+	return NavGen_Area2(a, b, c) == 0;
+}
+
+/**
+* @fn NavGen_IntersectProp
+* @brief 線分 ab と cd が端点以外で交差しているかどうか
+* @param[in] const int *a, const int *b, const int *c, const int *d
+* @return bool
+*/
+static bool NavGen_IntersectProp(const int *a, const int *b, const int *c, const int *d)
+{
+	if(NavGen_Collinear(a, b, c) || NavGen_Collinear(a, b, d) || NavGen_Collinear(c, d, a) || NavGen_Collinear(c, d, b))
+	{
+		return false;
+	}
+	return (NavGen_Left(a, b, c) != NavGen_Left(a, b, d)) && (NavGen_Left(c, d, a) != NavGen_Left(c, d, b));
+}
+
+/**
+* @fn NavGen_Between
+* @brief c が線分 ab の上にあるかどうか
+* @param[in] const int *a, const int *b, const int *c
+* @return bool
+*/
+static bool NavGen_Between(const int *a, const int *b, const int *c)
+{
+	if(!NavGen_Collinear(a, b, c))
+	{
+		return false;
+	}
+	if(a[0] != b[0])
+	{
+		return (a[0] <= c[0] && c[0] <= b[0]) || (a[0] >= c[0] && c[0] >= b[0]);
+	}
+	return (a[2] <= c[2] && c[2] <= b[2]) || (a[2] >= c[2] && c[2] >= b[2]);
+}
+
+/**
+* @fn NavGen_Intersect
+* @brief 線分 ab と cd が交差しているかどうか( 端点が重なる場合も含む )
+* @param[in] const int *a, const int *b, const int *c, const int *d
+* @return bool
+*/
+static bool NavGen_Intersect(const int *a, const int *b, const int *c, const int *d)
+{
+	return NavGen_IntersectProp(a, b, c, d) ||
+		NavGen_Between(a, b, c) || NavGen_Between(a, b, d) || NavGen_Between(c, d, a) || NavGen_Between(c, d, b);
+}
+
+/**
+* @fn NavGen_Diagonal
+* @brief 多角形の頂点 i と j を結ぶ線分が、多角形の内側を通る対角線かどうか
+* @param[in] NAVGEN_TILE *tile, int i, int j, int n 残っている頂点の数, bool loose 端点が辺に接する場合も許すかどうか
+* @return bool
+*/
+static bool NavGen_Diagonal(NAVGEN_TILE *tile, int i, int j, int n, bool loose)
+{
+	const int *index = tile->indexArray;
+	const int *d0 = &tile->simpleVertex[(index[i] & NAVGEN_INDEXMASK) * 4];
+	const int *d1 = &tile->simpleVertex[(index[j] & NAVGEN_INDEXMASK) * 4];
+	const int *pi1 = &tile->simpleVertex[(index[(i + 1) % n] & NAVGEN_INDEXMASK) * 4];
+	const int *pin1 = &tile->simpleVertex[(index[(i + n - 1) % n] & NAVGEN_INDEXMASK) * 4];
+
+	// 頂点 i の内角の中に j があるか
+	if(NavGen_LeftOn(pin1, d0, pi1))
+	{
+		bool inCone = loose ?
+			(NavGen_LeftOn(d0, d1, pin1) && NavGen_LeftOn(d1, d0, pi1)) :
+			(NavGen_Left(d0, d1, pin1) && NavGen_Left(d1, d0, pi1));
+		if(!inCone)
+		{
+			return false;
+		}
+	}
+	else if(loose ?
+		(NavGen_Left(d0, d1, pi1) && NavGen_Left(d1, d0, pin1)) :
+		(NavGen_LeftOn(d0, d1, pi1) && NavGen_LeftOn(d1, d0, pin1)))
+	{
+		return false;
+	}
+
+	// 他の辺と交差していないか
+	for(int k=0; k<n; k++)
+	{
+		int k1 = (k + 1) % n;
+		if(k == i || k1 == i || k == j || k1 == j)
+		{
+			continue;
+		}
+		const int *p0 = &tile->simpleVertex[(index[k] & NAVGEN_INDEXMASK) * 4];
+		const int *p1 = &tile->simpleVertex[(index[k1] & NAVGEN_INDEXMASK) * 4];
+		if((d0[0] == p0[0] && d0[2] == p0[2]) || (d1[0] == p0[0] && d1[2] == p0[2]) ||
+			(d0[0] == p1[0] && d0[2] == p1[2]) || (d1[0] == p1[0] && d1[2] == p1[2]))
+		{
+			continue;
+		}
+		if(loose ? NavGen_IntersectProp(d0, d1, p0, p1) : NavGen_Intersect(d0, d1, p0, p1))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @fn NavGen_AddTriangle
+* @brief 単純化した輪郭の３頂点から三角形を結果に追加する
+* @param[in] NAVGEN_TILE *tile, int a, int b, int c 単純化した輪郭の頂点の番号
+* @details 頂点はタイル内の番号から全体のボクセルの番号に直す、ＸＺ平面上で面積の無い三角形は追加しない
+*/
+static void NavGen_AddTriangle(NAVGEN_TILE *tile, int a, int b, int c)
+{
+	const int *va = &tile->simpleVertex[a * 4];
+	const int *vb = &tile->simpleVertex[b * 4];
+	const int *vc = &tile->simpleVertex[c * 4];
+	if(NavGen_Area2(va, vb, vc) == 0)
+	{
+		return;
+	}
+
+	NavGen_Reserve((void **)&tile->triangleVertex, &tile->triangleMax, (tile->triangleNum + 1) * 9, sizeof(int));
+	int *out = &tile->triangleVertex[tile->triangleNum * 9];
+	const int *v[3] = { va, vb, vc };
+	for(int i=0; i<3; i++)
+	{
+		out[i * 3 + 0] = v[i][0] + tile->originX;
+		out[i * 3 + 1] = v[i][1];
+		out[i * 3 + 2] = v[i][2] + tile->originZ;
+	}
+	tile->triangleNum++;
+}
+
+/**
+* @fn NavGen_Triangulate
+* @brief 単純化した輪郭を耳を切り取る方法で三角形に分割する
+* @param[in] NAVGEN_TILE *tile
+* @return bool true:全て分割できた  false:途中で分割できなくなった
+* @details 切り取れる耳の中で一番短い対角線を持つ耳から切り取る
+*/
+static bool NavGen_Triangulate(NAVGEN_TILE *tile)
+{
+	int n = tile->simpleNum;
+	int *index = (int *)malloc(sizeof(int) * n);
+	tile->indexArray = index;
+
+	for(int i=0; i<n; i++)
+	{
+		index[i] = i;
+	}
+
+	// 耳にできる頂点に印を付ける
+	for(int i=0; i<n; i++)
+	{
+		if(NavGen_Diagonal(tile, i, (i + 2) % n, n, false))
+		{
+			index[(i + 1) % n] |= NAVGEN_CANREMOVE;
+		}
+	}
+
+	bool result = true;
+	while(n > 3)
+	{
+		int minLength = -1;
+		int minIndex = -1;
+		for(int i=0; i<n; i++)
+		{
+			int i1 = (i + 1) % n;
+			if(index[i1] & NAVGEN_CANREMOVE)
+			{
+				const int *p0 = &tile->simpleVertex[(index[i] & NAVGEN_INDEXMASK) * 4];
+				const int *p2 = &tile->simpleVertex[(index[(i1 + 1) % n] & NAVGEN_INDEXMASK) * 4];
+				int dx = p2[0] - p0[0];
+				int dz = p2[2] - p0[2];
+				int length = dx * dx + dz * dz;
+				if(minLength < 0 || length < minLength)
+				{
+					minLength = length;
+					minIndex = i;
+				}
+			}
+		}
+
+		// 耳が無い場合は、辺に接する対角線も許して探し直す
+		if(minIndex == -1)
+		{
+			for(int i=0; i<n; i++)
+			{
+				if(NavGen_Diagonal(tile, i, (i + 2) % n, n, true))
+				{
+					minIndex = i;
+					break;
+				}
+			}
+			if(minIndex == -1)
+			{
+				result = false;
+				break;
+			}
+		}
+
+		int i = minIndex;
+		int i1 = (i + 1) % n;
+		int i2 = (i1 + 1) % n;
+		NavGen_AddTriangle(tile, index[i] & NAVGEN_INDEXMASK, index[i1] & NAVGEN_INDEXMASK, index[i2] & NAVGEN_INDEXMASK);
+
+		// 耳の頂点を取り除く
+		n--;
+		for(int k=i1; k<n; k++)
+		{
+			index[k] = index[k + 1];
+		}
+		if(i1 >= n)
+		{
+			i1 = 0;
+		}
+		i = (i1 + n - 1) % n;
+
+		// 取り除いた頂点の両隣が耳にできるかどうかを更新する
+		index[i] &= NAVGEN_INDEXMASK;
+		if(NavGen_Diagonal(tile, (i + n - 1) % n, i1, n, false))
+		{
+			index[i] |= NAVGEN_CANREMOVE;
+		}
+		index[i1] &= NAVGEN_INDEXMASK;
+		if(NavGen_Diagonal(tile, i, (i1 + 1) % n, n, false))
+		{
+			index[i1] |= NAVGEN_CANREMOVE;
+		}
+	}
+
+	if(result)
+	{
+		NavGen_AddTriangle(tile, index[0] & NAVGEN_INDEXMASK, index[1] & NAVGEN_INDEXMASK, index[2] & NAVGEN_INDEXMASK);
+	}
+	free(index);
+	tile->indexArray = NULL;
+	return result;
+}
+
+/**
+* @fn NavGen_BuildContours
+* @brief 全ての領域の輪郭を辿って単純化し、三角形に分割する
+* @param[in] NAVGEN_TILE *tile
+*/
+static void NavGen_BuildContours(NAVGEN_TILE *tile)
+{
+	int *reg = tile->floorRegion;
+	BYTE *flag = tile->floorFlag;
+
+	// 各床の、隣が違う領域になっている辺に印を付ける
+	for(int i=0; i<tile->floorNum; i++)
+	{
+		flag[i] = 0;
+		if(reg[i] == 0 || (reg[i] & NAVGEN_BORDERREG) != 0)
+		{
+			continue;
+		}
+		int same = 0;
+		for(int dir=0; dir<4; dir++)
+		{
+			int a = tile->floorConnect[i * 4 + dir];
+			if(a != -1 && reg[a] == reg[i])
+			{
+				same |= 1 << dir;
+			}
+		}
+		flag[i] = (BYTE)(same ^ 0xf);
+	}
+
+	for(int z=0; z<tile->height; z++)
+	{
+		for(int x=0; x<tile->width; x++)
+		{
+			int cell = x + z * tile->width;
+			for(int i=tile->cellIndex[cell]; i<tile->cellIndex[cell]+tile->cellCount[cell]; i++)
+			{
+				// 境界の辺が無い床と、１つだけ孤立した床は対象外
+				if(flag[i] == 0 || flag[i] == 0xf)
+				{
+					flag[i] = 0;
+					continue;
+				}
+
+				NavGen_WalkContour(tile, x, z, i);
+				NavGen_SimplifyContour(tile);
+				if(tile->simpleNum < 3)
+				{
+					continue;
+				}
+				if(NavGen_Triangulate(tile) == false)
+				{
+					tile->failContourNum++;
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn NavGen_BuildTile
+* @brief タイル１つ分の三角形を生成する
+* @param[in] NAVGEN_TILE *tile
+* @details 他のタイルとは共有する情報を書き換えないので、別々のスレッドで同時に実行できる
+*/
+static void NavGen_BuildTile(NAVGEN_TILE *tile)
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+
+	int columnNum = tile->width * tile->height;
+	tile->columnHead = (int *)malloc(sizeof(int) * columnNum);
+	for(int i=0; i<columnNum; i++)
+	{
+		tile->columnHead[i] = -1;
+	}
+
+	NavGen_Rasterize(tile);
+	NavGen_FilterSpans(tile);
+	NavGen_BuildFloors(tile);
+	NavGen_Erode(tile);
+	NavGen_BuildRegions(tile);
+	NavGen_BuildContours(tile);
+
+	// 三角形以外の作業用の情報を解放する
+	free(tile->columnHead);
+	free(tile->spanArray);
+	free(tile->cellIndex);
+	free(tile->cellCount);
+	free(tile->floorY);
+	free(tile->floorHeight);
+	free(tile->floorArea);
+	free(tile->floorConnect);
+	free(tile->floorDist);
+	free(tile->floorRegion);
+	free(tile->floorFlag);
+	free(tile->rawVertex);
+	free(tile->simpleVertex);
+	tile->columnHead = NULL;
+	tile->spanArray = NULL;
+	tile->rawVertex = NULL;
+	tile->simpleVertex = NULL;
+
+	tile->buildTime = GetNowHiPerformanceCount() - startTime;
+}
+
+/**
+* @fn NavGen_WorkerThread
+* @brief 生成用のスレッド、まだ生成していないタイルを１つずつ取って生成する
+* @param[in] LPVOID param 未使用
+* @return DWORD 0
+*/
+static DWORD WINAPI NavGen_WorkerThread(LPVOID param)
+{
+	for(;;)
+	{
+		LONG tileIndex = InterlockedIncrement(&navGen.nextTile) - 1;
+		if(tileIndex >= navGen.tileNum)
+		{
+			break;
+		}
+		NavGen_BuildTile(&navGen.tileArray[tileIndex]);
+	}
+	return 0;
+}
+
+/**
+* @fn NavGen_SplitSeamEdges
+* @brief タイルの境目の辺の途中にある隣のタイルの頂点で三角形を分ける
+* @param[in,out] int **triangle 三角形の頂点番号の配列, int *triangleNum, int *triangleMax
+* @param[in] const int *vertexPos 頂点のボクセルの番号, int vertexNum
+* @details タイルの境目の辺は両端の頂点しか残さないので、隣のタイルとは頂点の位置がずれることがある
+*          辺の上に乗っている頂点で分けておけば、境目の両側の三角形が同じ辺を共有して連結できる
+*/
+static void NavGen_SplitSeamEdges(int **triangle, int *triangleNum, int *triangleMax, const int *vertexPos, int vertexNum)
+{
+	int tileSize = navGen.config.tileSize;
+	int tolerance = navGen.walkableClimb + NAVGEN_MERGEVERTEXHEIGHT;
+
+	// タイルの境目の上にある頂点だけを調べる対象にする
+	int *seamVertex = (int *)malloc(sizeof(int) * (vertexNum > 0 ? vertexNum : 1));
+	int seamNum = 0;
+	for(int i=0; i<vertexNum; i++)
+	{
+		if(vertexPos[i * 3 + 0] % tileSize == 0 || vertexPos[i * 3 + 2] % tileSize == 0)
+		{
+			seamVertex[seamNum++] = i;
+		}
+	}
+
+	for(int t=0; t<*triangleNum; t++)
+	{
+		for(int e=0; e<3; e++)
+		{
+			int *tri = &(*triangle)[t * 3];
+			const int *a = &vertexPos[tri[e] * 3];
+			const int *b = &vertexPos[tri[(e + 1) % 3] * 3];
+
+			// 境目に沿った辺かどうか( fixed:境目で一定の軸  along:辺に沿った軸 )
+			int fixed;
+			int along;
+			if(a[0] == b[0] && a[0] % tileSize == 0)
+			{
+				fixed = 0;
+				along = 2;
+			}
+			else if(a[2] == b[2] && a[2] % tileSize == 0)
+			{
+				fixed = 2;
+				along = 0;
+			}
+			else
+			{
+				continue;
+			}
+
+			// ＸＺで長さの無い( 真上に立った )辺は分けない
+			if(b[along] == a[along])
+			{
+				continue;
+			}
+
+			// 辺の上にある一番 a に近い頂点を探す
+			int split = -1;
+			float splitT = 1.0f;
+			for(int i=0; i<seamNum; i++)
+			{
+				const int *v = &vertexPos[seamVertex[i] * 3];
+				if(v[fixed] != a[fixed] || seamVertex[i] == tri[e] || seamVertex[i] == tri[(e + 1) % 3])
+				{
+					continue;
+				}
+				float t0 = (float)(v[along] - a[along]) / (float)(b[along] - a[along]);
+				if(t0 <= 0.0f || t0 >= splitT)
+				{
+					continue;
+				}
+				float y = a[1] + (b[1] - a[1]) * t0;
+				if(fabsf(v[1] - y) > tolerance)
+				{
+					continue;
+				}
+				split = seamVertex[i];
+				splitT = t0;
+			}
+			if(split == -1)
+			{
+				continue;
+			}
+
+			// a, b, c の三角形を a, split, c と split, b, c に分けて、分けた三角形をもう一度調べる
+			NavGen_Reserve((void **)triangle, triangleMax, (*triangleNum + 1) * 3, sizeof(int));
+			tri = &(*triangle)[t * 3];
+			int *added = &(*triangle)[*triangleNum * 3];
+			added[0] = split;
+			added[1] = tri[(e + 1) % 3];
+			added[2] = tri[(e + 2) % 3];
+			tri[(e + 1) % 3] = split;
+			(*triangleNum)++;
+			e = -1;
+		}
+	}
+
+	free(seamVertex);
+}
+
+/**
+* @fn NavGen_Weld
+* @brief 全タイルの三角形の頂点を共有させて、ポリゴンの一覧にする
+* @param[out] MV1_REF_POLYGONLIST *result
+* @details ボクセルの角のＸＺが同じで高さが近い頂点を同じ頂点にして、タイルの境目の辺を隣のタイルの頂点で分ける
+*/
+static void NavGen_Weld(MV1_REF_POLYGONLIST *result)
+{
+	int triangleNum = 0;
+	for(int i=0; i<navGen.tileNum; i++)
+	{
+		triangleNum += navGen.tileArray[i].triangleNum;
+	}
+
+	// ＸＺの座標で頂点を探す為のハッシュ表
+	int bucketNum = 1;
+	while(bucketNum < triangleNum * 2)
+	{
+		bucketNum *= 2;
+	}
+	int *bucket = (int *)malloc(sizeof(int) * bucketNum);
+	for(int i=0; i<bucketNum; i++)
+	{
+		bucket[i] = -1;
+	}
+	int vertexMax = triangleNum * 3 > 0 ? triangleNum * 3 : 1;
+	int *vertexPos = (int *)malloc(sizeof(int) * 3 * vertexMax);
+	int *vertexNext = (int *)malloc(sizeof(int) * vertexMax);
+	int vertexNum = 0;
+	int *triangle = (int *)malloc(sizeof(int) * vertexMax);
+	int triangleMax = vertexMax;
+
+	int index = 0;
+	for(int t=0; t<navGen.tileNum; t++)
+	{
+		NAVGEN_TILE *tile = &navGen.tileArray[t];
+		for(int i=0; i<tile->triangleNum*3; i++)
+		{
+			const int *v = &tile->triangleVertex[i * 3];
+			unsigned int hash = ((unsigned int)v[0] * 73856093u) ^ ((unsigned int)v[2] * 19349663u);
+			int b = (int)(hash & (bucketNum - 1));
+			int found = -1;
+			for(int j=bucket[b]; j!=-1; j=vertexNext[j])
+			{
+				if(vertexPos[j * 3 + 0] == v[0] && vertexPos[j * 3 + 2] == v[2] &&
+					abs(vertexPos[j * 3 + 1] - v[1]) <= NAVGEN_MERGEVERTEXHEIGHT)
+				{
+					found = j;
+					break;
+				}
+			}
+			if(found == -1)
+			{
+				found = vertexNum++;
+				memcpy(&vertexPos[found * 3], v, sizeof(int) * 3);
+				vertexNext[found] = bucket[b];
+				bucket[b] = found;
+			}
+			triangle[index++] = found;
+		}
+	}
+
+	// タイルの境目で辺を揃える
+	NavGen_SplitSeamEdges(&triangle, &triangleNum, &triangleMax, vertexPos, vertexNum);
+
+	// 頂点をワールド座標にする
+	result->Vertexs = (MV1_REF_VERTEX *)malloc(sizeof(MV1_REF_VERTEX) * (vertexNum > 0 ? vertexNum : 1));
+	memset(result->Vertexs, 0, sizeof(MV1_REF_VERTEX) * (vertexNum > 0 ? vertexNum : 1));
+	for(int i=0; i<vertexNum; i++)
+	{
+		MV1_REF_VERTEX *vertex = &result->Vertexs[i];
+		vertex->Position = VGet(
+			navGen.bmin.x + vertexPos[i * 3 + 0] * navGen.config.cellSize,
+			navGen.bmin.y + vertexPos[i * 3 + 1] * navGen.config.cellHeight,
+			navGen.bmin.z + vertexPos[i * 3 + 2] * navGen.config.cellSize);
+		vertex->Normal = VGet(0.0f, 1.0f, 0.0f);
+		vertex->DiffuseColor = GetColorU8(255, 255, 255, 255);
+		vertex->SpecularColor = GetColorU8(0, 0, 0, 0);
+		result->MinPosition = i == 0 ? vertex->Position : VGet(
+			vertex->Position.x < result->MinPosition.x ? vertex->Position.x : result->MinPosition.x,
+			vertex->Position.y < result->MinPosition.y ? vertex->Position.y : result->MinPosition.y,
+			vertex->Position.z < result->MinPosition.z ? vertex->Position.z : result->MinPosition.z);
+		result->MaxPosition = i == 0 ? vertex->Position : VGet(
+			vertex->Position.x > result->MaxPosition.x ? vertex->Position.x : result->MaxPosition.x,
+			vertex->Position.y > result->MaxPosition.y ? vertex->Position.y : result->MaxPosition.y,
+			vertex->Position.z > result->MaxPosition.z ? vertex->Position.z : result->MaxPosition.z);
+	}
+
+	// ポリゴンと、各ポリゴンを囲む範囲
+	result->Polygons = (MV1_REF_POLYGON *)malloc(sizeof(MV1_REF_POLYGON) * (triangleNum > 0 ? triangleNum : 1));
+	memset(result->Polygons, 0, sizeof(MV1_REF_POLYGON) * (triangleNum > 0 ? triangleNum : 1));
+	for(int i=0; i<triangleNum; i++)
+	{
+		MV1_REF_POLYGON *refPoly = &result->Polygons[i];
+		refPoly->VIndex[0] = triangle[i * 3 + 0];
+		refPoly->VIndex[1] = triangle[i * 3 + 1];
+		refPoly->VIndex[2] = triangle[i * 3 + 2];
+		VECTOR p0 = result->Vertexs[refPoly->VIndex[0]].Position;
+		VECTOR p1 = result->Vertexs[refPoly->VIndex[1]].Position;
+		VECTOR p2 = result->Vertexs[refPoly->VIndex[2]].Position;
+		refPoly->MinPosition = VGet(
+			p0.x < p1.x ? (p0.x < p2.x ? p0.x : p2.x) : (p1.x < p2.x ? p1.x : p2.x),
+			p0.y < p1.y ? (p0.y < p2.y ? p0.y : p2.y) : (p1.y < p2.y ? p1.y : p2.y),
+			p0.z < p1.z ? (p0.z < p2.z ? p0.z : p2.z) : (p1.z < p2.z ? p1.z : p2.z));
+		refPoly->MaxPosition = VGet(
+			p0.x > p1.x ? (p0.x > p2.x ? p0.x : p2.x) : (p1.x > p2.x ? p1.x : p2.x),
+			p0.y > p1.y ? (p0.y > p2.y ? p0.y : p2.y) : (p1.y > p2.y ? p1.y : p2.y),
+			p0.z > p1.z ? (p0.z > p2.z ? p0.z : p2.z) : (p1.z > p2.z ? p1.z : p2.z));
+	}
+
+	result->PolygonNum = triangleNum;
+	result->VertexNum = vertexNum;
+
+	free(triangle);
+	free(vertexNext);
+	free(vertexPos);
+	free(bucket);
+}
+
+/**
+* @fn NavGen_GetDefaultConfig
+* @brief キャラクターの当たり判定のサイズから生成の設定の既定値を求める
+* @param[out] NAVGEN_CONFIG *config
+* @param[in] float agentRadius 当たり判定の半径, float agentHeight 通るのに必要な高さ
+*/
+void NavGen_GetDefaultConfig(NAVGEN_CONFIG *config, float agentRadius, float agentHeight)
+{
+	// ボクセルは半径を４つに分けられるサイズにする
+	config->cellSize = agentRadius / 4.0f;
+	config->cellHeight = config->cellSize * 0.5f;
+	config->agentRadius = agentRadius;
+	config->agentHeight = agentHeight;
+	config->agentClimb = config->cellSize * 2.0f;
+	config->maxSlope = 60.0f;
+	config->tileSize = 48;
+	config->maxEdgeError = config->cellSize * 1.3f;
+	config->minRegionArea = 64;
+	config->threadNum = 4;
+}
+
+/**
+* @fn NavGen_Build
+* @brief ステージのポリゴンからナビメッシュのポリゴンを生成する
+* @param[in] const MV1_REF_POLYGONLIST *source ステージのポリゴン, const NAVGEN_CONFIG *config
+* @param[out] MV1_REF_POLYGONLIST *result 生成したポリゴン( NavGen_Free で解放する ), NAVGEN_STATS *stats 統計情報( NULL可 )
+* @return bool true:成功  false:失敗
+* @details 生成したポリゴンは隣のポリゴンと頂点番号を共有しているので、そのまま連結情報を構築できる
+*/
+bool NavGen_Build(const MV1_REF_POLYGONLIST *source, const NAVGEN_CONFIG *config, MV1_REF_POLYGONLIST *result, NAVGEN_STATS *stats)
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+	memset(result, 0, sizeof(MV1_REF_POLYGONLIST));
+	if(source->PolygonNum <= 0 || config->cellSize <= 0.0f || config->cellHeight <= 0.0f || config->tileSize <= 0)
+	{
+		return false;
+	}
+
+	navGen.source = source;
+	navGen.config = *config;
+	navGen.bmin = source->MinPosition;
+	navGen.maxSpanHeight = (int)ceilf((source->MaxPosition.y - source->MinPosition.y) / config->cellHeight) + 1;
+	navGen.maxSpanHeight = navGen.maxSpanHeight > NAVGEN_MAXSPANHEIGHT ? NAVGEN_MAXSPANHEIGHT : navGen.maxSpanHeight;
+	navGen.walkableHeight = (int)ceilf(config->agentHeight / config->cellHeight);
+	navGen.walkableClimb = (int)floorf(config->agentClimb / config->cellHeight);
+	navGen.walkableRadius = (int)ceilf(config->agentRadius / config->cellSize);
+	navGen.border = navGen.walkableRadius + 3;
+
+	// ステージの各ポリゴンの傾きから立てるかどうかを決める( 表の向きは頂点の法線に合わせる )
+	float walkableCos = cosf(config->maxSlope * DX_PI_F / 180.0f);
+	navGen.sourceArea = (BYTE *)malloc(sizeof(BYTE) * source->PolygonNum);
+	for(int i=0; i<source->PolygonNum; i++)
+	{
+		const MV1_REF_POLYGON *refPoly = &source->Polygons[i];
+		const MV1_REF_VERTEX *v0 = &source->Vertexs[refPoly->VIndex[0]];
+		const MV1_REF_VERTEX *v1 = &source->Vertexs[refPoly->VIndex[1]];
+		const MV1_REF_VERTEX *v2 = &source->Vertexs[refPoly->VIndex[2]];
+		VECTOR normal = VCross(VSub(v1->Position, v0->Position), VSub(v2->Position, v0->Position));
+		float facing = VDot(normal, VAdd(v0->Normal, VAdd(v1->Normal, v2->Normal)));
+		if(facing < 0.0f || (facing == 0.0f && normal.y < 0.0f))
+		{
+			normal = VScale(normal, -1.0f);
+		}
+		float length = VSize(normal);
+		navGen.sourceArea[i] = length > 0.0f && normal.y >= walkableCos * length ? 1 : 0;
+	}
+
+	// ステージ全体をタイルに分ける
+	int gridWidth = (int)ceilf((source->MaxPosition.x - source->MinPosition.x) / config->cellSize);
+	int gridHeight = (int)ceilf((source->MaxPosition.z - source->MinPosition.z) / config->cellSize);
+	navGen.tileNumX = (gridWidth + config->tileSize - 1) / config->tileSize;
+	navGen.tileNumZ = (gridHeight + config->tileSize - 1) / config->tileSize;
+	navGen.tileNumX = navGen.tileNumX > 0 ? navGen.tileNumX : 1;
+	navGen.tileNumZ = navGen.tileNumZ > 0 ? navGen.tileNumZ : 1;
+	navGen.tileNum = navGen.tileNumX * navGen.tileNumZ;
+	navGen.tileArray = (NAVGEN_TILE *)malloc(sizeof(NAVGEN_TILE) * navGen.tileNum);
+	memset(navGen.tileArray, 0, sizeof(NAVGEN_TILE) * navGen.tileNum);
+	for(int z=0; z<navGen.tileNumZ; z++)
+	{
+		for(int x=0; x<navGen.tileNumX; x++)
+		{
+			NAVGEN_TILE *tile = &navGen.tileArray[x + z * navGen.tileNumX];
+			tile->originX = x * config->tileSize - navGen.border;
+			tile->originZ = z * config->tileSize - navGen.border;
+			tile->width = config->tileSize + navGen.border * 2;
+			tile->height = config->tileSize + navGen.border * 2;
+			tile->bmin = VGet(
+				navGen.bmin.x + tile->originX * config->cellSize,
+				navGen.bmin.y,
+				navGen.bmin.z + tile->originZ * config->cellSize);
+			tile->freeSpan = -1;
+		}
+	}
+
+	// タイルを複数のスレッドで生成する
+	navGen.nextTile = 0;
+	int threadNum = config->threadNum > NAVGEN_MAXTHREAD ? NAVGEN_MAXTHREAD : config->threadNum;
+	HANDLE thread[NAVGEN_MAXTHREAD];
+	for(int i=0; i<threadNum; i++)
+	{
+		thread[i] = CreateThread(NULL, 0, NavGen_WorkerThread, NULL, 0, NULL);
+	}
+	if(threadNum <= 0)
+	{
+		NavGen_WorkerThread(NULL);
+	}
+	for(int i=0; i<threadNum; i++)
+	{
+		WaitForSingleObject(thread[i], INFINITE);
+		CloseHandle(thread[i]);
+	}
+
+	// 全タイルの三角形をまとめる
+	NavGen_Weld(result);
+
+	NAVGEN_STATS localStats;
+	if(stats == NULL)
+	{
+		stats = &localStats;
+	}
+	memset(stats, 0, sizeof(NAVGEN_STATS));
+	stats->tileNum = navGen.tileNum;
+	for(int i=0; i<navGen.tileNum; i++)
+	{
+		NAVGEN_TILE *tile = &navGen.tileArray[i];
+		stats->spanNum += tile->spanCount;
+		stats->regionNum += tile->regionNum;
+		stats->failContourNum += tile->failContourNum;
+		stats->tileTimeTotal += tile->buildTime;
+		stats->tileTimeMax = tile->buildTime > stats->tileTimeMax ? tile->buildTime : stats->tileTimeMax;
+		free(tile->triangleVertex);
+	}
+	stats->polygonNum = result->PolygonNum;
+	stats->vertexNum = result->VertexNum;
+
+	free(navGen.tileArray);
+	free(navGen.sourceArea);
+	navGen.tileArray = NULL;
+	navGen.sourceArea = NULL;
+	navGen.source = NULL;
+
+	stats->buildTime = GetNowHiPerformanceCount() - startTime;
+	return result->PolygonNum > 0;
+}
+
+/**
+* @fn NavGen_Free
+* @brief NavGen_Build で生成したポリゴンの後始末
+* @param[in] MV1_REF_POLYGONLIST *result
+*/
+void NavGen_Free(MV1_REF_POLYGONLIST *result)
+{
+	free(result->Polygons);
+	free(result->Vertexs);
+	memset(result, 0, sizeof(MV1_REF_POLYGONLIST));
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int NAVGEN_MAXTHREAD = 8;				//!< ナビメッシュの自動生成に使用するスレッドの最大数
+
+/**
+* @struct NAVGEN_CONFIG
+* @brief ナビメッシュの自動生成の設定
+* @details 長さは全てワールド座標の単位で指定する
+*/
+struct NAVGEN_CONFIG
+{
+	float cellSize;							//!< ボクセルのＸＺ平面上のサイズ
+	float cellHeight;						//!< ボクセルのＹ軸方向のサイズ
+	float agentRadius;						//!< キャラクターの当たり判定の半径( この分だけ壁から離す )
+	float agentHeight;						//!< キャラクターが通るのに必要な天井までの高さ
+	float agentClimb;						//!< キャラクターが乗り越えられる段差の高さ
+	float maxSlope;							//!< 歩ける床の最大の傾き( 度 )
+	int tileSize;							//!< タイル１つの一辺のボクセルの数
+	float maxEdgeError;						//!< 壁に沿った輪郭を単純化する時に許す元の輪郭からのずれ
+	int minRegionArea;						//!< これより少ないボクセルしか無い領域は捨てる
+	int threadNum;							//!< タイルの生成に使用するスレッドの数( 0 の場合は呼び出したスレッドで生成する )
+};
+
+/**
+* @struct NAVGEN_STATS
+* @brief ナビメッシュの自動生成の統計情報
+*/
+struct NAVGEN_STATS
+{
+	int tileNum;							//!< タイルの数
+	int spanNum;							//!< ボクセル化で作ったスパンの数
+	int regionNum;							//!< 全タイルの領域の数
+	int failContourNum;						//!< 三角形に分割できなかった輪郭の数
+	int polygonNum;							//!< 生成したポリゴンの数
+	int vertexNum;							//!< 生成した頂点の数
+	LONGLONG buildTime;						//!< 生成全体にかかった時間( マイクロ秒 )
+	LONGLONG tileTimeMax;					//!< タイル１つの生成にかかった最大時間( マイクロ秒 )
+	LONGLONG tileTimeTotal;					//!< 全タイルの生成にかかった時間の合計( マイクロ秒 )
+};
+
+void NavGen_GetDefaultConfig(NAVGEN_CONFIG *config, float agentRadius, float agentHeight);	//!< キャラクターの当たり判定のサイズから生成の設定の既定値を求める
+bool NavGen_Build(const MV1_REF_POLYGONLIST *source, const NAVGEN_CONFIG *config, MV1_REF_POLYGONLIST *result, NAVGEN_STATS *stats);	//!< ステージのポリゴンからナビメッシュのポリゴンを生成する( 戻り値  true:成功  false:失敗 )
+void NavGen_Free(MV1_REF_POLYGONLIST *result);	//!< NavGen_Build で生成したポリゴンの後始末
@@ -0,0 +1,379 @@
+﻿#include "NavMesh.h"
+#include "PolyLink.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 事前に構築したナビメッシュのファイルへの書き出しと、メモリマップによる読み込み
+*          読み込み時は解析もメモリ確保も行わず、マップしたファイルの中をそのまま参照する
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const unsigned int NAVMESH_ALIGN = 16;			//!< ファイル内の各配列の先頭の境界
+
+static HANDLE navMeshFileHandle = INVALID_HANDLE_VALUE;	//!< マップしているファイルのハンドル
+static HANDLE navMeshMappingHandle = NULL;		//!< ファイルマッピングオブジェクトのハンドル
+static const unsigned char *navMeshImage = NULL;	//!< マップしたファイルの先頭アドレス( NULL:マップしていない )
+
+/**
+* @fn NavMesh_Checksum
+* @brief 指定のデータのチェックサムを求める
+* @param[in] const unsigned char *data, unsigned int size
+* @return unsigned int FNV-1a の 32bit ハッシュ値
+*/
+static unsigned int NavMesh_Checksum(const unsigned char *data, unsigned int size)
+{
+	unsigned int hash = 2166136261u;
+	for(unsigned int i=0; i<size; i++)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* @fn NavMesh_AddBlock
+* @brief ファイル内に指定サイズの配列を置く場所を割り当てる
+* @param[in,out] unsigned int *fileSize 現在のファイルサイズ
+* @param[in] unsigned int size 配列のサイズ
+* @return unsigned int 配列のオフセット
+*/
+static unsigned int NavMesh_AddBlock(unsigned int *fileSize, unsigned int size)
+{
+	unsigned int offset = (*fileSize + NAVMESH_ALIGN - 1) / NAVMESH_ALIGN * NAVMESH_ALIGN;
+	*fileSize = offset + size;
+	return offset;
+}
+
+/**
+* @fn NavMesh_CheckBlock
+* @brief ファイル内の配列がファイルの範囲に収まっているかどうか
+* @param[in] const NAVMESH_FILEHEADER *header, unsigned int offset, unsigned int elementSize, int num
+* @return bool true:収まっている  false:はみ出している
+*/
+static bool NavMesh_CheckBlock(const NAVMESH_FILEHEADER *header, unsigned int offset, unsigned int elementSize, int num)
+{
+	if(num < 0 || offset % NAVMESH_ALIGN != 0 || offset < header->headerSize || offset > header->fileSize)
+	{
+		return false;
+	}
+	return (unsigned long long)elementSize * num <= header->fileSize - offset;
+}
+
+/**
+* @fn NavMesh_GetSourceStamp
+* @brief 構築元のステージモデルのファイルのサイズと最終更新日時を取得する
+* @param[in] const char *sourceFilePath
+* @param[out] unsigned int *size, FILETIME *writeTime
+* @return bool true:成功  false:ファイルが無かった
+* @details ファイルの中身は読まないので、起動のたびに呼んでもステージモデルを読み込む時間はかからない
+*/
+static bool NavMesh_GetSourceStamp(const char *sourceFilePath, unsigned int *size, FILETIME *writeTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA sourceData;
+	if(GetFileAttributesExA(sourceFilePath, GetFileExInfoStandard, &sourceData) == 0 || sourceData.nFileSizeHigh != 0)
+	{
+		return false;
+	}
+	*size = sourceData.nFileSizeLow;
+	*writeTime = sourceData.ftLastWriteTime;
+	return true;
+}
+
+/**
+* @fn NavMesh_GetSourceHash
+* @brief 構築元のステージモデルのファイルのハッシュ値を求める
+* @param[in] const char *sourceFilePath
+* @param[out] unsigned int *hash
+* @return bool true:成功  false:ファイルが読めなかった
+* @details ファイル全体を読むので、ナビメッシュファイルを書き出す時だけ呼ぶ
+*/
+static bool NavMesh_GetSourceHash(const char *sourceFilePath, unsigned int *hash)
+{
+	HANDLE fileHandle = CreateFileA(sourceFilePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	bool result = false;
+	DWORD fileSize = GetFileSize(fileHandle, NULL);
+	if(fileSize != INVALID_FILE_SIZE)
+	{
+		unsigned char *data = (unsigned char *)malloc(fileSize + 1);
+		DWORD readSize = 0;
+		if(ReadFile(fileHandle, data, fileSize, &readSize, NULL) != 0 && readSize == fileSize)
+		{
+			*hash = NavMesh_Checksum(data, fileSize);
+			result = true;
+		}
+		free(data);
+	}
+	CloseHandle(fileHandle);
+	return result;
+}
+
+/**
+* @fn NavMesh_CheckIndices
+* @brief ファイル内の各配列に入っている番号が範囲に収まっているかどうか
+* @param[in] const NAVMESH_FILEHEADER *header
+* @return bool true:収まっている  false:範囲外の番号がある
+* @details 読み込み時に一度だけ確認して、以降の探索では番号の範囲を確認しない
+*/
+static bool NavMesh_CheckIndices(const NAVMESH_FILEHEADER *header)
+{
+	const MV1_REF_POLYGON *polygons = (const MV1_REF_POLYGON *)(navMeshImage + header->polygonOffset);
+	const POLYLINKINFO *links = (const POLYLINKINFO *)(navMeshImage + header->linkOffset);
+	const int *cellStart = (const int *)(navMeshImage + header->gridCellStartOffset);
+	const int *cellPolyIndex = (const int *)(navMeshImage + header->gridCellPolyIndexOffset);
+	int cellNum = header->gridCellNumX * header->gridCellNumZ;
+
+	// ポリゴンの頂点番号と連結先のポリゴン番号( -1 は連結無し )
+	for(int i=0; i<header->polygonNum; i++)
+	{
+		for(int j=0; j<3; j++)
+		{
+			if(polygons[i].VIndex[j] < 0 || polygons[i].VIndex[j] >= header->vertexNum)
+			{
+				return false;
+			}
+			if(links[i].linkPolyIndex[j] < -1 || links[i].linkPolyIndex[j] >= header->polygonNum)
+			{
+				return false;
+			}
+		}
+	}
+
+	// 各マスの開始位置は 0 から始まって減らずに、最後が登録数と一致する
+	if(cellStart[0] != 0 || cellStart[cellNum] != header->gridCellPolyNum)
+	{
+		return false;
+	}
+	for(int i=0; i<cellNum; i++)
+	{
+		if(cellStart[i] > cellStart[i + 1])
+		{
+			return false;
+		}
+	}
+
+	// 各マスに登録されたポリゴン番号
+	for(int i=0; i<header->gridCellPolyNum; i++)
+	{
+		if(cellPolyIndex[i] < 0 || cellPolyIndex[i] >= header->polygonNum)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @fn NavMesh_Save
+* @brief 構築済みのポリゴン情報、連結情報、検索用の格子を構築元のステージモデルの情報と一緒にナビメッシュファイルに書き出す
+* @param[in] const char *filePath, const char *sourceFilePath 構築元のステージモデルのファイル
+* @return bool true:成功  false:失敗
+* @details SetupPolyLinkInfo と SetupPolyGrid の後に呼ぶ
+*/
+bool NavMesh_Save(const char *filePath, const char *sourceFilePath)
+{
+	int cellNum = polyGrid.cellNumX * polyGrid.cellNumZ;
+
+	// ヘッダと各配列の配置を決める
+	NAVMESH_FILEHEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = NAVMESH_MAGIC;
+	header.version = NAVMESH_VERSION;
+	header.headerSize = sizeof(NAVMESH_FILEHEADER);
+	header.polygonSize = sizeof(MV1_REF_POLYGON);
+	header.vertexSize = sizeof(MV1_REF_VERTEX);
+	header.linkSize = sizeof(POLYLINKINFO);
+	FILETIME sourceWriteTime;
+	if(!NavMesh_GetSourceStamp(sourceFilePath, &header.sourceSize, &sourceWriteTime) ||
+		!NavMesh_GetSourceHash(sourceFilePath, &header.sourceHash))
+	{
+		ErrorLogFmtAdd("navmesh: failed to read source %s", sourceFilePath);
+		return false;
+	}
+	header.sourceWriteTimeLow = sourceWriteTime.dwLowDateTime;
+	header.sourceWriteTimeHigh = sourceWriteTime.dwHighDateTime;
+	header.polygonNum = polyList.PolygonNum;
+	header.vertexNum = polyList.VertexNum;
+	header.minPosition = polyList.MinPosition;
+	header.maxPosition = polyList.MaxPosition;
+	header.gridMinX = polyGrid.minX;
+	header.gridMinZ = polyGrid.minZ;
+	header.gridCellSize = polyGrid.cellSize;
+	header.gridCellNumX = polyGrid.cellNumX;
+	header.gridCellNumZ = polyGrid.cellNumZ;
+	header.gridCellPolyNum = polyGrid.cellStart[cellNum];
+
+	unsigned int fileSize = sizeof(NAVMESH_FILEHEADER);
+	header.polygonOffset = NavMesh_AddBlock(&fileSize, sizeof(MV1_REF_POLYGON) * header.polygonNum);
+	header.vertexOffset = NavMesh_AddBlock(&fileSize, sizeof(MV1_REF_VERTEX) * header.vertexNum);
+	header.linkOffset = NavMesh_AddBlock(&fileSize, sizeof(POLYLINKINFO) * header.polygonNum);
+	header.gridCellStartOffset = NavMesh_AddBlock(&fileSize, sizeof(int) * (cellNum + 1));
+	header.gridCellPolyIndexOffset = NavMesh_AddBlock(&fileSize, sizeof(int) * header.gridCellPolyNum);
+	header.fileSize = fileSize;
+
+	// ファイルの内容をメモリ上に組み立てる( 隙間は 0 で埋める )
+	unsigned char *image = (unsigned char *)malloc(fileSize);
+	memset(image, 0, fileSize);
+	memcpy(image + header.polygonOffset, polyList.Polygons, sizeof(MV1_REF_POLYGON) * header.polygonNum);
+	memcpy(image + header.vertexOffset, polyList.Vertexs, sizeof(MV1_REF_VERTEX) * header.vertexNum);
+	memcpy(image + header.linkOffset, polyLinkInfo, sizeof(POLYLINKINFO) * header.polygonNum);
+	memcpy(image + header.gridCellStartOffset, polyGrid.cellStart, sizeof(int) * (cellNum + 1));
+	memcpy(image + header.gridCellPolyIndexOffset, polyGrid.cellPolyIndex, sizeof(int) * header.gridCellPolyNum);
+	header.checksum = NavMesh_Checksum(image + sizeof(NAVMESH_FILEHEADER), fileSize - sizeof(NAVMESH_FILEHEADER));
+	memcpy(image, &header, sizeof(NAVMESH_FILEHEADER));
+
+	// 書き出す
+	bool result = false;
+	HANDLE fileHandle = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle != INVALID_HANDLE_VALUE)
+	{
+		DWORD writeSize = 0;
+		result = WriteFile(fileHandle, image, fileSize, &writeSize, NULL) != 0 && writeSize == fileSize;
+		CloseHandle(fileHandle);
+	}
+
+	free(image);
+	return result;
+}
+
+/**
+* @fn NavMesh_Load
+* @brief ナビメッシュファイルをメモリにマップして、そのままポリゴン情報、連結情報、検索用の格子として使う
+* @param[in] const char *filePath, const char *sourceFilePath 構築元のステージモデルのファイル
+* @return bool true:成功  false:失敗( ファイルが無い、バージョンが違う、ステージモデルが変わった、壊れている等、この場合は何も設定しない )
+* @details polyList、polyLinkInfo、polyGrid はマップしたファイルの中を指すので、書き換えてはいけない
+*          後始末は TerminatePolyLinkInfo と TerminatePolyGrid ではなく NavMesh_Unload で行う
+*/
+bool NavMesh_Load(const char *filePath, const char *sourceFilePath)
+{
+	NavMesh_Unload();
+
+	navMeshFileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(navMeshFileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD fileSize = GetFileSize(navMeshFileHandle, NULL);
+	if(fileSize == INVALID_FILE_SIZE || fileSize < sizeof(NAVMESH_FILEHEADER))
+	{
+		NavMesh_Unload();
+		return false;
+	}
+
+	navMeshMappingHandle = CreateFileMappingA(navMeshFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(navMeshMappingHandle == NULL)
+	{
+		NavMesh_Unload();
+		return false;
+	}
+
+	navMeshImage = (const unsigned char *)MapViewOfFile(navMeshMappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if(navMeshImage == NULL)
+	{
+		NavMesh_Unload();
+		return false;
+	}
+
+	// 形式とサイズとチェックサムと番号の範囲を確認する
+	const NAVMESH_FILEHEADER *header = (const NAVMESH_FILEHEADER *)navMeshImage;
+	int cellNum = header->gridCellNumX * header->gridCellNumZ;
+	if(header->magic != NAVMESH_MAGIC ||
+		header->version != NAVMESH_VERSION ||
+		header->headerSize != sizeof(NAVMESH_FILEHEADER) ||
+		header->fileSize != fileSize ||
+		header->polygonSize != sizeof(MV1_REF_POLYGON) ||
+		header->vertexSize != sizeof(MV1_REF_VERTEX) ||
+		header->linkSize != sizeof(POLYLINKINFO) ||
+		header->gridCellNumX <= 0 || header->gridCellNumZ <= 0 ||
+		!NavMesh_CheckBlock(header, header->polygonOffset, sizeof(MV1_REF_POLYGON), header->polygonNum) ||
+		!NavMesh_CheckBlock(header, header->vertexOffset, sizeof(MV1_REF_VERTEX), header->vertexNum) ||
+		!NavMesh_CheckBlock(header, header->linkOffset, sizeof(POLYLINKINFO), header->polygonNum) ||
+		!NavMesh_CheckBlock(header, header->gridCellStartOffset, sizeof(int), cellNum + 1) ||
+		!NavMesh_CheckBlock(header, header->gridCellPolyIndexOffset, sizeof(int), header->gridCellPolyNum) ||
+		header->checksum != NavMesh_Checksum(navMeshImage + sizeof(NAVMESH_FILEHEADER), fileSize - sizeof(NAVMESH_FILEHEADER)) ||
+		!NavMesh_CheckIndices(header))
+	{
+		ErrorLogFmtAdd("navmesh: %s is broken or has a different format", filePath);
+		NavMesh_Unload();
+		return false;
+	}
+
+	// 構築元のステージモデルのサイズか最終更新日時が変わっていたら使わない
+	unsigned int sourceSize = 0;
+	FILETIME sourceWriteTime;
+	if(!NavMesh_GetSourceStamp(sourceFilePath, &sourceSize, &sourceWriteTime) ||
+		header->sourceSize != sourceSize ||
+		header->sourceWriteTimeLow != sourceWriteTime.dwLowDateTime || header->sourceWriteTimeHigh != sourceWriteTime.dwHighDateTime)
+	{
+		ErrorLogFmtAdd("navmesh: %s was built from a different %s", filePath, sourceFilePath);
+		NavMesh_Unload();
+		return false;
+	}
+
+	// マップしたファイルの中をそのまま指す
+	polyList.PolygonNum = header->polygonNum;
+	polyList.VertexNum = header->vertexNum;
+	polyList.MinPosition = header->minPosition;
+	polyList.MaxPosition = header->maxPosition;
+	polyList.Polygons = (MV1_REF_POLYGON *)(navMeshImage + header->polygonOffset);
+	polyList.Vertexs = (MV1_REF_VERTEX *)(navMeshImage + header->vertexOffset);
+	polyLinkInfo = (POLYLINKINFO *)(navMeshImage + header->linkOffset);
+	polyGrid.minX = header->gridMinX;
+	polyGrid.minZ = header->gridMinZ;
+	polyGrid.cellSize = header->gridCellSize;
+	polyGrid.cellNumX = header->gridCellNumX;
+	polyGrid.cellNumZ = header->gridCellNumZ;
+	polyGrid.cellStart = (int *)(navMeshImage + header->gridCellStartOffset);
+	polyGrid.cellPolyIndex = (int *)(navMeshImage + header->gridCellPolyIndexOffset);
+
+	return true;
+}
+
+/**
+* @fn NavMesh_Unload
+* @brief マップしたナビメッシュファイルの後始末
+*/
+void NavMesh_Unload()
+{
+	if(navMeshImage != NULL)
+	{
+		UnmapViewOfFile(navMeshImage);
+		navMeshImage = NULL;
+		polyList.Polygons = NULL;
+		polyList.Vertexs = NULL;
+		polyLinkInfo = NULL;
+		polyGrid.cellStart = NULL;
+		polyGrid.cellPolyIndex = NULL;
+	}
+	if(navMeshMappingHandle != NULL)
+	{
+		CloseHandle(navMeshMappingHandle);
+		navMeshMappingHandle = NULL;
+	}
+	if(navMeshFileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(navMeshFileHandle);
+		navMeshFileHandle = INVALID_HANDLE_VALUE;
+	}
+}
+
+/**
+* @fn NavMesh_IsLoaded
+* @brief ナビメッシュファイルをマップして使っているかどうか
+* @return bool true:マップして使っている  false:使っていない
+*/
+bool NavMesh_IsLoaded()
+{
+	return navMeshImage != NULL;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const unsigned int NAVMESH_MAGIC = 0x4D56414E;	//!< ナビメッシュファイルの識別子( "NAVM" )
+const unsigned int NAVMESH_VERSION = 3;			//!< ナビメッシュファイルの形式のバージョン( 形式を変えたら増やす )
+
+/**
+* @struct NAVMESH_FILEHEADER
+* @brief ナビメッシュファイルの先頭に置く情報
+* @details 各配列はファイルの先頭からのオフセットで指すので、どのアドレスに読み込んでもそのまま使える
+*/
+struct NAVMESH_FILEHEADER
+{
+	unsigned int magic;						//!< 識別子( NAVMESH_MAGIC )
+	unsigned int version;					//!< 形式のバージョン( NAVMESH_VERSION )
+	unsigned int headerSize;				//!< この構造体のサイズ
+	unsigned int fileSize;					//!< ファイル全体のサイズ
+	unsigned int checksum;					//!< ヘッダより後ろの全データのチェックサム( FNV-1a )
+	unsigned int polygonSize;				//!< MV1_REF_POLYGON のサイズ( 作成時と DXライブラリの構造体が違っていないかの確認用 )
+	unsigned int vertexSize;				//!< MV1_REF_VERTEX のサイズ
+	unsigned int linkSize;					//!< POLYLINKINFO のサイズ
+	unsigned int sourceSize;				//!< 構築元のステージモデルのファイルサイズ
+	unsigned int sourceWriteTimeLow;		//!< 構築元のステージモデルの最終更新日時の下位 32bit( サイズと合わせて、古いステージから作ったファイルを読まない為 )
+	unsigned int sourceWriteTimeHigh;		//!< 構築元のステージモデルの最終更新日時の上位 32bit
+	unsigned int sourceHash;				//!< 構築元のステージモデルのファイルの FNV-1a ハッシュ値( 構築時に記録するだけで、読み込み時は確認しない )
+	int polygonNum;							//!< ポリゴンの数
+	int vertexNum;							//!< 頂点の数
+	VECTOR minPosition;						//!< 全ポリゴンを囲む範囲の最小座標
+	VECTOR maxPosition;						//!< 全ポリゴンを囲む範囲の最大座標
+	unsigned int polygonOffset;				//!< ポリゴンの配列のオフセット
+	unsigned int vertexOffset;				//!< 頂点の配列のオフセット
+	unsigned int linkOffset;				//!< ポリゴン同士の連結情報の配列のオフセット
+	float gridMinX;							//!< ポリゴン検索用の格子の左端のＸ座標
+	float gridMinZ;							//!< ポリゴン検索用の格子の手前端のＺ座標
+	float gridCellSize;						//!< ポリゴン検索用の格子の１マスのサイズ
+	int gridCellNumX;						//!< ポリゴン検索用の格子のＸ軸方向のマスの数
+	int gridCellNumZ;						//!< ポリゴン検索用の格子のＺ軸方向のマスの数
+	int gridCellPolyNum;					//!< ポリゴン検索用の格子の全マスに登録されたポリゴン番号の数
+	unsigned int gridCellStartOffset;		//!< 各マスの開始位置の配列のオフセット
+	unsigned int gridCellPolyIndexOffset;	//!< 全マスに登録されたポリゴン番号の配列のオフセット
+};
+
+bool NavMesh_Save(const char *filePath, const char *sourceFilePath);	//!< 構築済みのポリゴン情報、連結情報、検索用の格子を構築元のステージモデルの情報と一緒にナビメッシュファイルに書き出す( 戻り値  true:成功  false:失敗 )
+bool NavMesh_Load(const char *filePath, const char *sourceFilePath);	//!< ナビメッシュファイルをメモリにマップして、そのままポリゴン情報、連結情報、検索用の格子として使う( 戻り値  true:成功  false:失敗 )
+void NavMesh_Unload(void);						//!< マップしたナビメッシュファイルの後始末
+bool NavMesh_IsLoaded(void);					//!< ナビメッシュファイルをマップして使っているかどうか
@@ -0,0 +1,601 @@
+﻿#include "NavTile.h"
+#include "PolyLink.h"
+#include "PathCluster.h"
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 実行中に配置する障害物に対応する為のタイル分割したナビメッシュ
+*          障害物を配置、移動、削除すると重なるタイルだけをバックグラウンドのスレッドで作り直し、
+*          終わったらメインスレッドで使用する情報を切り替えて、切り替えの通し番号を進める
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @struct NAVTILEJOB
+* @brief タイルの作り直しの依頼
+* @details 依頼した時点の障害物の情報を持たせるので、作り直し中に障害物が変わっても影響しない
+*/
+struct NAVTILEJOB
+{
+	int tileIndex;							//!< タイルの番号
+	int buffer;								//!< 書き込む blocked の番号
+	int obstacleNum;						//!< タイルと重なる障害物の数
+	NAVOBSTACLE obstacle[NAVTILE_MAXOBSTACLE];	//!< タイルと重なる障害物
+};
+
+/**
+* @struct NAVTILEDONE
+* @brief タイルの作り直しの完了の通知
+*/
+struct NAVTILEDONE
+{
+	int tileIndex;							//!< タイルの番号
+	int buffer;								//!< 書き込んだ blocked の番号
+	LONGLONG buildTime;						//!< 作り直しにかかった時間( マイクロ秒 )
+};
+
+/**
+* @struct NAVTILEINFO
+* @brief タイル分割したナビメッシュの情報
+*/
+struct NAVTILEINFO
+{
+	float minX;								//!< タイル分割の左端のＸ座標
+	float minZ;								//!< タイル分割の手前端のＺ座標
+	float tileSize;							//!< タイル１つのＸＺ平面上のサイズ
+	int tileNumX;							//!< Ｘ軸方向のタイルの数
+	int tileNumZ;							//!< Ｚ軸方向のタイルの数
+	int tileNum;							//!< タイルの数
+	NAVTILE *tileArray;						//!< タイルの配列( NULL:未初期化 )
+	int *tilePolyIndex;						//!< 全タイルに属するポリゴン番号をタイルの順番に並べた配列
+	int *polyTileIndex;						//!< 各ポリゴンが属するタイルの番号( ポリゴン数分 )
+	int *polyLocalIndex;					//!< 各ポリゴンのタイル内での番号( ポリゴン数分 )
+	int *changedPolyIndex;					//!< 直前の NavTile_Process で通れるかどうかが変わったポリゴンの番号( ポリゴン数分 )
+	int changedPolyNum;						//!< 直前の NavTile_Process で通れるかどうかが変わったポリゴンの数
+	NAVOBSTACLE obstacle[NAVTILE_MAXOBSTACLE];	//!< 障害物の配列
+	HANDLE thread;							//!< 作り直し用のスレッドのハンドル
+	HANDLE jobSemaphore;					//!< 依頼が追加されたことを知らせるセマフォ
+	volatile LONG quit;						//!< 作り直し用のスレッドを終了させるかどうか
+	PATHQUEUE jobQueue;						//!< 作り直しの依頼のキュー
+	PATHQUEUE doneQueue;					//!< 作り直しの完了の通知のキュー
+	NAVTILEJOB submitJob;					//!< メインスレッドで依頼を作る為の作業用の依頼( 毎フレーム確保しないように持っておく )
+	NAVTILEJOB buildJob;					//!< 作り直し用のスレッドで取り出した依頼を入れておく作業用の依頼
+	volatile LONG serial;					//!< 切り替えの通し番号
+	LONGLONG buildTimeTotal;				//!< 作り直しにかかった時間の合計( マイクロ秒 )
+	NAVTILE_STATS stats;					//!< 統計情報
+};
+
+static NAVTILEINFO navTile;						//!< タイル分割したナビメッシュの実体
+
+/**
+* @fn NavTile_HitPolyCircle
+* @brief 指定のポリゴンとＸＺ平面上の円が重なっているかどうか
+* @param[in] int polyIndex, VECTOR position 円の中心, float radius 円の半径
+* @return bool true:重なっている  false:重なっていない
+*/
+static bool NavTile_HitPolyCircle(int polyIndex, VECTOR position, float radius)
+{
+	// 円の中心がポリゴンの中にある場合
+	if(CheckPolyContainXZ(polyIndex, position))
+	{
+		return true;
+	}
+
+	// 円の中心からポリゴンの各辺までの距離が半径以下の場合
+	MV1_REF_POLYGON *refPoly = &polyList.Polygons[polyIndex];
+	for(int i=0; i<3; i++)
+	{
+		VECTOR p0 = polyList.Vertexs[refPoly->VIndex[i]].Position;
+		VECTOR p1 = polyList.Vertexs[refPoly->VIndex[(i + 1) % 3]].Position;
+		float edgeX = p1.x - p0.x;
+		float edgeZ = p1.z - p0.z;
+		float length = edgeX * edgeX + edgeZ * edgeZ;
+		float t = length > 0.0f ? ((position.x - p0.x) * edgeX + (position.z - p0.z) * edgeZ) / length : 0.0f;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		float dx = p0.x + edgeX * t - position.x;
+		float dz = p0.z + edgeZ * t - position.z;
+		if(dx * dx + dz * dz <= radius * radius)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+* @fn NavTile_HitTileCircle
+* @brief 指定のタイルの範囲とＸＺ平面上の円を囲む範囲が重なっているかどうか
+* @param[in] const NAVTILE *tile, VECTOR position, float radius
+* @return bool true:重なっている  false:重なっていない
+*/
+static bool NavTile_HitTileCircle(const NAVTILE *tile, VECTOR position, float radius)
+{
+	return tile->polyNum > 0 &&
+		position.x + radius >= tile->minX && position.x - radius <= tile->maxX &&
+		position.z + radius >= tile->minZ && position.z - radius <= tile->maxZ;
+}
+
+/**
+* @fn NavTile_SetDirtyCircle
+* @brief ＸＺ平面上の円と重なるタイルを作り直しが必要な状態にする
+* @param[in] VECTOR position, float radius
+*/
+static void NavTile_SetDirtyCircle(VECTOR position, float radius)
+{
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		if(NavTile_HitTileCircle(&navTile.tileArray[i], position, radius))
+		{
+			navTile.tileArray[i].dirty = true;
+		}
+	}
+}
+
+/**
+* @fn NavTile_Build
+* @brief 依頼された障害物の情報から、タイル内の各ポリゴンが通れないかどうかを求める
+* @param[in] const NAVTILEJOB *job
+* @details 書き込むのは使用中ではない方の blocked なので、探索中のスレッドと同時に行って良い
+*/
+static void NavTile_Build(const NAVTILEJOB *job)
+{
+	NAVTILE *tile = &navTile.tileArray[job->tileIndex];
+	BYTE *blocked = tile->blocked[job->buffer];
+	for(int i=0; i<tile->polyNum; i++)
+	{
+		int polyIndex = navTile.tilePolyIndex[tile->polyStart + i];
+		blocked[i] = 0;
+		for(int j=0; j<job->obstacleNum; j++)
+		{
+			if(NavTile_HitPolyCircle(polyIndex, job->obstacle[j].position, job->obstacle[j].radius))
+			{
+				blocked[i] = 1;
+				break;
+			}
+		}
+	}
+}
+
+/**
+* @fn NavTile_WorkerThread
+* @brief 作り直し用のスレッド、依頼が来るのを待って作り直し、完了をキューに追加する
+* @param[in] LPVOID param 未使用
+* @return DWORD 0
+*/
+static DWORD WINAPI NavTile_WorkerThread(LPVOID param)
+{
+	NAVTILEJOB *job = &navTile.buildJob;
+	NAVTILEDONE done;
+
+	for(;;)
+	{
+		// 依頼が来るまで待つ
+		WaitForSingleObject(navTile.jobSemaphore, INFINITE);
+		if(navTile.quit)
+		{
+			break;
+		}
+
+		if(PathQueue_Pop(&navTile.jobQueue, job) == false)
+		{
+			continue;
+		}
+
+		LONGLONG startTime = GetNowHiPerformanceCount();
+		NavTile_Build(job);
+		done.tileIndex = job->tileIndex;
+		done.buffer = job->buffer;
+		done.buildTime = GetNowHiPerformanceCount() - startTime;
+
+		// 完了のキューが一杯の場合は空くまで待つ
+		while(PathQueue_Push(&navTile.doneQueue, &done) == false)
+		{
+			if(navTile.quit)
+			{
+				break;
+			}
+			Sleep(1);
+		}
+	}
+
+	return 0;
+}
+
+/**
+* @fn NavTile_Initialize
+* @brief ナビメッシュをタイルに分割して、作り直し用のスレッドを開始する
+* @details ポリゴンの中心座標をＸＺ平面上の格子で区切り、１マスを１タイルにする
+*          ポリゴン同士の連結情報と階層的経路探索用のクラスタを構築した後に呼ぶ
+*/
+void NavTile_Initialize()
+{
+	// 分割の範囲はステージモデル全体の範囲
+	navTile.minX = polyList.MinPosition.x;
+	navTile.minZ = polyList.MinPosition.z;
+	float sizeX = polyList.MaxPosition.x - polyList.MinPosition.x;
+	float sizeZ = polyList.MaxPosition.z - polyList.MinPosition.z;
+
+	// １タイルにおよそ NAVTILE_POLYNUM 枚のポリゴンが入るサイズにする
+	navTile.tileSize = sqrtf(sizeX * sizeZ * NAVTILE_POLYNUM / (polyList.PolygonNum > 0 ? polyList.PolygonNum : 1));
+	if(navTile.tileSize <= 0.0f)
+	{
+		navTile.tileSize = 1.0f;
+	}
+	navTile.tileNumX = (int)(sizeX / navTile.tileSize) + 1;
+	navTile.tileNumZ = (int)(sizeZ / navTile.tileSize) + 1;
+	navTile.tileNum = navTile.tileNumX * navTile.tileNumZ;
+	navTile.tileArray = (NAVTILE *)malloc(sizeof(NAVTILE) * navTile.tileNum);
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		NAVTILE *tile = &navTile.tileArray[i];
+		tile->polyStart = 0;
+		tile->polyNum = 0;
+		tile->minX = 0.0f;
+		tile->minZ = 0.0f;
+		tile->maxX = 0.0f;
+		tile->maxZ = 0.0f;
+		tile->activeBuffer = 0;
+		tile->swapSerial = 0;
+		tile->dirty = false;
+		tile->building = false;
+		tile->buildTime = 0;
+	}
+
+	// 各ポリゴンが属するタイルを中心座標から決めて、タイルごとの数と範囲を求める
+	navTile.polyTileIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	navTile.polyLocalIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	navTile.tilePolyIndex = (int *)malloc(sizeof(int) * (polyList.PolygonNum > 0 ? polyList.PolygonNum : 1));
+	navTile.changedPolyIndex = (int *)malloc(sizeof(int) * (polyList.PolygonNum > 0 ? polyList.PolygonNum : 1));
+	navTile.changedPolyNum = 0;
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		int tileX = (int)((polyLinkInfo[i].centerPosition.x - navTile.minX) / navTile.tileSize);
+		int tileZ = (int)((polyLinkInfo[i].centerPosition.z - navTile.minZ) / navTile.tileSize);
+		NAVTILE *tile = &navTile.tileArray[tileZ * navTile.tileNumX + tileX];
+		MV1_REF_POLYGON *refPoly = &polyList.Polygons[i];
+		if(tile->polyNum == 0)
+		{
+			tile->minX = refPoly->MinPosition.x;
+			tile->minZ = refPoly->MinPosition.z;
+			tile->maxX = refPoly->MaxPosition.x;
+			tile->maxZ = refPoly->MaxPosition.z;
+		}
+		else
+		{
+			tile->minX = refPoly->MinPosition.x < tile->minX ? refPoly->MinPosition.x : tile->minX;
+			tile->minZ = refPoly->MinPosition.z < tile->minZ ? refPoly->MinPosition.z : tile->minZ;
+			tile->maxX = refPoly->MaxPosition.x > tile->maxX ? refPoly->MaxPosition.x : tile->maxX;
+			tile->maxZ = refPoly->MaxPosition.z > tile->maxZ ? refPoly->MaxPosition.z : tile->maxZ;
+		}
+		navTile.polyTileIndex[i] = tileZ * navTile.tileNumX + tileX;
+		navTile.polyLocalIndex[i] = tile->polyNum;
+		tile->polyNum++;
+	}
+
+	// タイルの順番にポリゴン番号を並べて、通れないかどうかの情報を確保する
+	int polyStart = 0;
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		NAVTILE *tile = &navTile.tileArray[i];
+		tile->polyStart = polyStart;
+		polyStart += tile->polyNum;
+		for(int j=0; j<2; j++)
+		{
+			tile->blocked[j] = (BYTE *)malloc(tile->polyNum > 0 ? tile->polyNum : 1);
+			memset(tile->blocked[j], 0, tile->polyNum > 0 ? tile->polyNum : 1);
+		}
+	}
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		NAVTILE *tile = &navTile.tileArray[navTile.polyTileIndex[i]];
+		navTile.tilePolyIndex[tile->polyStart + navTile.polyLocalIndex[i]] = i;
+	}
+
+	for(int i=0; i<NAVTILE_MAXOBSTACLE; i++)
+	{
+		navTile.obstacle[i].active = false;
+	}
+	navTile.serial = 0;
+	navTile.buildTimeTotal = 0;
+	memset(&navTile.stats, 0, sizeof(navTile.stats));
+
+	// 作り直し用のスレッドを開始する
+	PathQueue_Initialize(&navTile.jobQueue, sizeof(NAVTILEJOB), NAVTILE_QUEUESIZE);
+	PathQueue_Initialize(&navTile.doneQueue, sizeof(NAVTILEDONE), NAVTILE_QUEUESIZE);
+	navTile.quit = 0;
+	navTile.jobSemaphore = CreateSemaphoreA(NULL, 0, NAVTILE_QUEUESIZE + 1, NULL);
+	navTile.thread = CreateThread(NULL, 0, NavTile_WorkerThread, NULL, 0, NULL);
+}
+
+/**
+* @fn NavTile_Terminate
+* @brief タイルの情報と作り直し用のスレッドの後始末
+*/
+void NavTile_Terminate()
+{
+	if(navTile.tileArray == NULL)
+	{
+		return;
+	}
+
+	// 作り直し用のスレッドを終了させる
+	InterlockedExchange(&navTile.quit, 1);
+	ReleaseSemaphore(navTile.jobSemaphore, 1, NULL);
+	WaitForSingleObject(navTile.thread, INFINITE);
+	CloseHandle(navTile.thread);
+	CloseHandle(navTile.jobSemaphore);
+	PathQueue_Terminate(&navTile.jobQueue);
+	PathQueue_Terminate(&navTile.doneQueue);
+
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		free(navTile.tileArray[i].blocked[0]);
+		free(navTile.tileArray[i].blocked[1]);
+	}
+	free(navTile.tileArray);
+	navTile.tileArray = NULL;
+	navTile.tileNum = 0;
+	free(navTile.tilePolyIndex);
+	navTile.tilePolyIndex = NULL;
+	free(navTile.polyTileIndex);
+	navTile.polyTileIndex = NULL;
+	free(navTile.polyLocalIndex);
+	navTile.polyLocalIndex = NULL;
+	free(navTile.changedPolyIndex);
+	navTile.changedPolyIndex = NULL;
+	navTile.changedPolyNum = 0;
+}
+
+/**
+* @fn NavTile_AddObstacle
+* @brief 障害物を配置する
+* @param[in] VECTOR position 中心座標, float radius ＸＺ平面上の半径( 移動するものの半径を含めておく )
+* @return int 障害物の番号、一杯の場合は -1
+*/
+int NavTile_AddObstacle(VECTOR position, float radius)
+{
+	for(int i=0; i<NAVTILE_MAXOBSTACLE; i++)
+	{
+		if(navTile.obstacle[i].active == false)
+		{
+			navTile.obstacle[i].active = true;
+			navTile.obstacle[i].position = position;
+			navTile.obstacle[i].radius = radius;
+			NavTile_SetDirtyCircle(position, radius);
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+* @fn NavTile_MoveObstacle
+* @brief 障害物を移動する
+* @param[in] int obstacleIndex, VECTOR position
+* @details 移動前と移動後の両方の位置と重なるタイルを作り直す
+*/
+void NavTile_MoveObstacle(int obstacleIndex, VECTOR position)
+{
+	NAVOBSTACLE *obstacle = &navTile.obstacle[obstacleIndex];
+	if(obstacle->active == false)
+	{
+		return;
+	}
+	NavTile_SetDirtyCircle(obstacle->position, obstacle->radius);
+	obstacle->position = position;
+	NavTile_SetDirtyCircle(obstacle->position, obstacle->radius);
+}
+
+/**
+* @fn NavTile_RemoveObstacle
+* @brief 障害物を取り除く
+* @param[in] int obstacleIndex
+*/
+void NavTile_RemoveObstacle(int obstacleIndex)
+{
+	NAVOBSTACLE *obstacle = &navTile.obstacle[obstacleIndex];
+	if(obstacle->active == false)
+	{
+		return;
+	}
+	NavTile_SetDirtyCircle(obstacle->position, obstacle->radius);
+	obstacle->active = false;
+}
+
+/**
+* @fn NavTile_Process
+* @brief 作り直しを依頼し、作り直しが終わったタイルを切り替える
+* @return int 切り替えたタイルの数
+* @details 切り替えたタイルのポリゴンに関係するクラスタは作り直し、通れるかどうかが変わったポリゴンは NavTile_GetChangedPoly で取得できるようにする
+*          １つのタイルの作り直しは同時に１つしか依頼しないので、使用中ではない方の blocked を書き換えるのは作り直し用のスレッドだけになる
+*/
+int NavTile_Process()
+{
+	int swapNum = 0;
+	navTile.changedPolyNum = 0;
+
+	// 作り直しが終わったタイルを切り替える
+	NAVTILEDONE done;
+	while(PathQueue_Pop(&navTile.doneQueue, &done))
+	{
+		NAVTILE *tile = &navTile.tileArray[done.tileIndex];
+
+		// 切り替える前と後で通れるかどうかが変わったポリゴンを記録しておく( タイルの作り直しは同時に１つなので重複しない )
+		const BYTE *prevBlocked = tile->blocked[tile->activeBuffer];
+		const BYTE *nextBlocked = tile->blocked[done.buffer];
+		for(int i=0; i<tile->polyNum; i++)
+		{
+			if(prevBlocked[i] != nextBlocked[i])
+			{
+				navTile.changedPolyIndex[navTile.changedPolyNum] = navTile.tilePolyIndex[tile->polyStart + i];
+				navTile.changedPolyNum++;
+			}
+		}
+
+		InterlockedExchange(&tile->activeBuffer, done.buffer);
+		InterlockedExchange(&tile->swapSerial, InterlockedIncrement(&navTile.serial));
+		tile->building = false;
+		tile->buildTime = done.buildTime;
+
+		for(int i=0; i<tile->polyNum; i++)
+		{
+			PathCluster_SetDirtyPoly(navTile.tilePolyIndex[tile->polyStart + i]);
+		}
+
+		navTile.stats.rebuildTileNum++;
+		navTile.stats.buildTimeLast = done.buildTime;
+		if(done.buildTime > navTile.stats.buildTimeMax)
+		{
+			navTile.stats.buildTimeMax = done.buildTime;
+		}
+		navTile.buildTimeTotal += done.buildTime;
+		navTile.stats.buildTimeAverage = navTile.buildTimeTotal / navTile.stats.rebuildTileNum;
+		swapNum++;
+	}
+	if(swapNum > 0)
+	{
+		PathCluster_Refresh();
+	}
+
+	// 作り直しが必要なタイルを依頼する
+	NAVTILEJOB *job = &navTile.submitJob;
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		NAVTILE *tile = &navTile.tileArray[i];
+		if(tile->dirty == false || tile->building)
+		{
+			continue;
+		}
+
+		// 依頼した時点でタイルと重なっている障害物を持たせる
+		job->tileIndex = i;
+		job->buffer = 1 - tile->activeBuffer;
+		job->obstacleNum = 0;
+		for(int j=0; j<NAVTILE_MAXOBSTACLE; j++)
+		{
+			NAVOBSTACLE *obstacle = &navTile.obstacle[j];
+			if(obstacle->active && NavTile_HitTileCircle(tile, obstacle->position, obstacle->radius))
+			{
+				job->obstacle[job->obstacleNum] = *obstacle;
+				job->obstacleNum++;
+			}
+		}
+
+		// キューが一杯の場合は次のフレームに依頼する
+		if(PathQueue_Push(&navTile.jobQueue, job) == false)
+		{
+			break;
+		}
+		tile->dirty = false;
+		tile->building = true;
+		ReleaseSemaphore(navTile.jobSemaphore, 1, NULL);
+	}
+
+	return swapNum;
+}
+
+/**
+* @fn NavTile_IsPolyBlocked
+* @brief 指定のポリゴンが障害物で通れないかどうか
+* @param[in] int polyIndex
+* @return bool true:通れない  false:通れる( タイル分割していない場合も通れる )
+* @details どのスレッドから呼んでも良い、探索中に切り替わった場合は NavTile_CheckPath で経路が無効になる
+*/
+bool NavTile_IsPolyBlocked(int polyIndex)
+{
+	if(navTile.tileArray == NULL)
+	{
+		return false;
+	}
+	const NAVTILE *tile = &navTile.tileArray[navTile.polyTileIndex[polyIndex]];
+	return tile->blocked[tile->activeBuffer][navTile.polyLocalIndex[polyIndex]] != 0;
+}
+
+/**
+* @fn NavTile_GetChangedPoly
+* @brief 直前の NavTile_Process で通れるかどうかが変わったポリゴンを取得する
+* @param[out] const int **polyIndexArray ポリゴン番号の配列( 次の NavTile_Process まで有効 )
+* @return int ポリゴンの数
+* @details 探索の状態を残しておく差分経路探索などで、変わったポリゴンの移動コストだけを更新する為に使う
+*/
+int NavTile_GetChangedPoly(const int **polyIndexArray)
+{
+	*polyIndexArray = navTile.changedPolyIndex;
+	return navTile.changedPolyNum;
+}
+
+/**
+* @fn NavTile_GetSerial
+* @brief 現在の切り替えの通し番号を取得する
+* @return int 通し番号( 経路探索を開始する時に保存しておき、NavTile_CheckPath に渡す )
+*/
+int NavTile_GetSerial()
+{
+	return navTile.serial;
+}
+
+/**
+* @fn NavTile_CheckPath
+* @brief 指定の通し番号の時点で求めた経路が、その後のタイルの切り替えの影響を受けていないかどうか
+* @param[in] const int *pathPolyIndex, int pathPolyNum, int serial
+* @return bool true:有効  false:経路上のタイルが切り替わったので無効
+*/
+bool NavTile_CheckPath(const int *pathPolyIndex, int pathPolyNum, int serial)
+{
+	if(navTile.tileArray == NULL)
+	{
+		return true;
+	}
+	for(int i=0; i<pathPolyNum; i++)
+	{
+		if(navTile.tileArray[navTile.polyTileIndex[pathPolyIndex[i]]].swapSerial > serial)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @fn NavTile_GetObstacle
+* @brief 障害物の情報を取得する
+* @param[in] int obstacleIndex
+* @return const NAVOBSTACLE * 障害物の情報
+*/
+const NAVOBSTACLE *NavTile_GetObstacle(int obstacleIndex)
+{
+	return &navTile.obstacle[obstacleIndex];
+}
+
+/**
+* @fn NavTile_GetStats
+* @brief 統計情報を取得する
+* @param[out] NAVTILE_STATS *stats
+*/
+void NavTile_GetStats(NAVTILE_STATS *stats)
+{
+	navTile.stats.obstacleNum = 0;
+	for(int i=0; i<NAVTILE_MAXOBSTACLE; i++)
+	{
+		if(navTile.obstacle[i].active)
+		{
+			navTile.stats.obstacleNum++;
+		}
+	}
+	navTile.stats.pendingTileNum = 0;
+	for(int i=0; i<navTile.tileNum; i++)
+	{
+		if(navTile.tileArray[i].dirty || navTile.tileArray[i].building)
+		{
+			navTile.stats.pendingTileNum++;
+		}
+	}
+	navTile.stats.serial = navTile.serial;
+	*stats = navTile.stats;
+}
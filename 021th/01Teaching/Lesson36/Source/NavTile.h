@@ -0,0 +1,67 @@
+﻿#pragma once
+#include "DxLib.h"
+#include "PathQueue.h"
+
+const int NAVTILE_POLYNUM = 64;					//!< １タイルに含めるポリゴン数の目安
+const int NAVTILE_MAXOBSTACLE = 32;				//!< 配置できる障害物の最大数
+const int NAVTILE_QUEUESIZE = 64;				//!< 作り直しの依頼と完了のキューの大きさ( ２のべき乗 )
+
+/**
+* @struct NAVOBSTACLE
+* @brief 実行中に配置する円柱状の障害物
+*/
+struct NAVOBSTACLE
+{
+	bool active;							//!< 使用中かどうか
+	VECTOR position;						//!< 中心座標
+	float radius;							//!< ＸＺ平面上の半径( 移動するものの半径を含めておく )
+};
+
+/**
+* @struct NAVTILE
+* @brief ナビメッシュを分割したタイルの情報
+* @details 通れないポリゴンの情報を２つ持ち、バックグラウンドで使っていない方を作り直してから切り替える
+*/
+struct NAVTILE
+{
+	int polyStart;							//!< タイルに属するポリゴン番号が tilePolyIndex の何番目から始まるか
+	int polyNum;							//!< タイルに属するポリゴンの数
+	float minX;								//!< タイルに属するポリゴンを囲む範囲の最小Ｘ座標
+	float minZ;								//!< タイルに属するポリゴンを囲む範囲の最小Ｚ座標
+	float maxX;								//!< タイルに属するポリゴンを囲む範囲の最大Ｘ座標
+	float maxZ;								//!< タイルに属するポリゴンを囲む範囲の最大Ｚ座標
+	BYTE *blocked[2];						//!< タイル内の各ポリゴンが障害物で通れないかどうか( polyNum 個 × 2 )
+	volatile LONG activeBuffer;				//!< 使用中の blocked の番号
+	volatile LONG swapSerial;				//!< 最後に切り替えた時の通し番号
+	bool dirty;								//!< 作り直しが必要かどうか
+	bool building;							//!< バックグラウンドで作り直し中かどうか
+	LONGLONG buildTime;						//!< 最後に作り直した時にかかった時間( マイクロ秒 )
+};
+
+/**
+* @struct NAVTILE_STATS
+* @brief タイルの作り直しの統計情報
+*/
+struct NAVTILE_STATS
+{
+	int obstacleNum;						//!< 配置中の障害物の数
+	int pendingTileNum;						//!< 作り直しを待っているか作り直し中のタイルの数
+	int rebuildTileNum;						//!< これまでに作り直したタイルの数
+	LONGLONG buildTimeLast;					//!< 最後に作り直したタイルにかかった時間( マイクロ秒 )
+	LONGLONG buildTimeAverage;				//!< タイル１つの作り直しにかかった平均時間( マイクロ秒 )
+	LONGLONG buildTimeMax;					//!< タイル１つの作り直しにかかった最大時間( マイクロ秒 )
+	int serial;								//!< 現在の切り替えの通し番号
+};
+
+void NavTile_Initialize(void);					//!< ナビメッシュをタイルに分割して、作り直し用のスレッドを開始する
+void NavTile_Terminate(void);					//!< タイルの情報と作り直し用のスレッドの後始末
+int NavTile_AddObstacle(VECTOR position, float radius);	//!< 障害物を配置する( 戻り値 : 障害物の番号、一杯の場合は -1 )
+void NavTile_MoveObstacle(int obstacleIndex, VECTOR position);	//!< 障害物を移動する
+void NavTile_RemoveObstacle(int obstacleIndex);	//!< 障害物を取り除く
+int NavTile_Process(void);						//!< 作り直しを依頼し、作り直しが終わったタイルを切り替える( 毎フレームメインスレッドで呼ぶ )( 戻り値 : 切り替えたタイルの数 )
+bool NavTile_IsPolyBlocked(int polyIndex);		//!< 指定のポリゴンが障害物で通れないかどうか( どのスレッドから呼んでも良い )
+int NavTile_GetChangedPoly(const int **polyIndexArray);	//!< 直前の NavTile_Process で通れるかどうかが変わったポリゴンを取得する( 戻り値 : ポリゴンの数 )
+int NavTile_GetSerial(void);					//!< 現在の切り替えの通し番号を取得する
+bool NavTile_CheckPath(const int *pathPolyIndex, int pathPolyNum, int serial);	//!< 指定の通し番号の時点で求めた経路が、その後のタイルの切り替えの影響を受けていないかどうか( 戻り値  true:有効  false:無効 )
+const NAVOBSTACLE *NavTile_GetObstacle(int obstacleIndex);	//!< 障害物の情報を取得する
+void NavTile_GetStats(NAVTILE_STATS *stats);	//!< 統計情報を取得する
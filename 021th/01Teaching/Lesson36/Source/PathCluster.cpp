@@ -0,0 +1,629 @@
+﻿#include "PathCluster.h"
+#include "PolyLink.h"
+#include "NavTile.h"
+#include <malloc.h>
+#include <math.h>
+#include <limits.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details ポリゴンをクラスタに分割した階層的経路探索( HPA* )
+*          上位の探索は境界ノード( 他のクラスタと隣接しているポリゴン )だけを辿り、
+*          見つかった境界ノード同士の間をクラスタ内の探索で埋めて最終的な経路にする
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+PATHCLUSTERINFO pathCluster;					//!< クラスタ分割の情報
+static SRWLOCK pathClusterLock = SRWLOCK_INIT;	//!< 探索中のスレッドがある間はクラスタを作り直さない為のロック
+
+/**
+* @fn PathCluster_SearchInCluster
+* @brief 指定のポリゴンが属しているクラスタの中だけで、指定のポリゴンからの最短距離を求める
+* @param[in] PATHCLUSTER_WORK *work, int startPolyIndex, int targetPolyIndex 辿り着いたら探索を止めるポリゴン番号( -1 の場合はクラスタ内の全ポリゴンを調べる )
+* @param[out] float *distance, int *prevPolyIndex, int *stamp
+* @return int 今回の探索で stamp に設定した値
+*/
+static int PathCluster_SearchInCluster(PATHCLUSTER_WORK *work, int startPolyIndex, int targetPolyIndex, float *distance, int *prevPolyIndex, int *stamp)
+{
+	int clusterIndex = pathCluster.polyClusterIndex[startPolyIndex];
+	work->nowStamp++;
+	int stampValue = work->nowStamp;
+
+	// スタートのポリゴンを登録する
+	PathHeap_Clear(&work->localHeap);
+	distance[startPolyIndex] = 0.0f;
+	prevPolyIndex[startPolyIndex] = -1;
+	stamp[startPolyIndex] = stampValue;
+	PathHeap_Push(&work->localHeap, startPolyIndex, 0.0f);
+
+	int polyIndex;
+	float key;
+	while(PathHeap_Pop(&work->localHeap, &polyIndex, &key))
+	{
+		// 既により短い距離で処理済みの場合は何もしない
+		if(key > distance[polyIndex])
+		{
+			continue;
+		}
+
+		// 目標のポリゴンに辿り着いたら終了
+		if(polyIndex == targetPolyIndex)
+		{
+			break;
+		}
+
+		// ポリゴンの辺の数だけ繰り返し
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		for(int i=0; i<3; i++)
+		{
+			// 隣接ポリゴンが無いか、他のクラスタのポリゴンか、障害物で通れない場合は何もしない
+			int linkPolyIndex = pLInfo->linkPolyIndex[i];
+			if(linkPolyIndex == -1 || pathCluster.polyClusterIndex[linkPolyIndex] != clusterIndex || NavTile_IsPolyBlocked(linkPolyIndex))
+			{
+				continue;
+			}
+
+			// 既により短い距離で到達している場合は何もしない
+			float newDistance = distance[polyIndex] + pLInfo->linkPolyDistance[i];
+			if(stamp[linkPolyIndex] == stampValue && distance[linkPolyIndex] <= newDistance)
+			{
+				continue;
+			}
+
+			distance[linkPolyIndex] = newDistance;
+			prevPolyIndex[linkPolyIndex] = polyIndex;
+			stamp[linkPolyIndex] = stampValue;
+			PathHeap_Push(&work->localHeap, linkPolyIndex, newDistance);
+		}
+	}
+
+	return stampValue;
+}
+
+/**
+* @fn PathCluster_BuildCluster
+* @brief 指定のクラスタの境界ノードと、境界ノード同士の最短距離を構築する
+* @param[in] int clusterIndex
+*/
+static void PathCluster_BuildCluster(int clusterIndex)
+{
+	PATHCLUSTER *cluster = &pathCluster.clusterArray[clusterIndex];
+	PATHCLUSTER_WORK *work = &pathCluster.buildWork;
+
+	// 前回構築した情報を解放する
+	free(cluster->nodePolyIndex);
+	free(cluster->nodeCost);
+
+	// 一回目は境界ノードの数を数える
+	cluster->nodeNum = 0;
+	for(int polyIndex=0; polyIndex<polyList.PolygonNum; polyIndex++)
+	{
+		if(pathCluster.polyClusterIndex[polyIndex] != clusterIndex)
+		{
+			continue;
+		}
+
+		// 他のクラスタのポリゴンと隣接していたら境界ノードにする
+		pathCluster.polyNodeIndex[polyIndex] = -1;
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = polyLinkInfo[polyIndex].linkPolyIndex[i];
+			if(linkPolyIndex != -1 && pathCluster.polyClusterIndex[linkPolyIndex] != clusterIndex)
+			{
+				pathCluster.polyNodeIndex[polyIndex] = cluster->nodeNum;
+				cluster->nodeNum++;
+				break;
+			}
+		}
+	}
+
+	// 二回目は境界ノードのポリゴン番号を登録する
+	cluster->nodePolyIndex = (int *)malloc(sizeof(int) * (cluster->nodeNum > 0 ? cluster->nodeNum : 1));
+	for(int polyIndex=0; polyIndex<polyList.PolygonNum; polyIndex++)
+	{
+		if(pathCluster.polyClusterIndex[polyIndex] == clusterIndex && pathCluster.polyNodeIndex[polyIndex] != -1)
+		{
+			cluster->nodePolyIndex[pathCluster.polyNodeIndex[polyIndex]] = polyIndex;
+		}
+	}
+
+	// 境界ノードからクラスタ内を探索して、他の境界ノードまでの最短距離を保存する
+	cluster->nodeCost = (float *)malloc(sizeof(float) * (cluster->nodeNum > 0 ? cluster->nodeNum * cluster->nodeNum : 1));
+	for(int i=0; i<cluster->nodeNum; i++)
+	{
+		// 障害物で通れない境界ノードからはどこにも繋がらない
+		if(NavTile_IsPolyBlocked(cluster->nodePolyIndex[i]))
+		{
+			for(int j=0; j<cluster->nodeNum; j++)
+			{
+				cluster->nodeCost[i * cluster->nodeNum + j] = -1.0f;
+			}
+			continue;
+		}
+
+		int stampValue = PathCluster_SearchInCluster(work, cluster->nodePolyIndex[i], -1,
+			work->localDistance, work->localPrevPolyIndex, work->localStamp);
+
+		for(int j=0; j<cluster->nodeNum; j++)
+		{
+			int nodePolyIndex = cluster->nodePolyIndex[j];
+			cluster->nodeCost[i * cluster->nodeNum + j] =
+				work->localStamp[nodePolyIndex] == stampValue ? work->localDistance[nodePolyIndex] : -1.0f;
+		}
+	}
+
+	cluster->dirty = false;
+	pathCluster.rebuildClusterNum++;
+}
+
+/**
+* @fn PathCluster_Setup
+* @brief 全ポリゴンをクラスタに分割して、全クラスタの境界ノードを構築する
+* @details ポリゴンの中心座標をＸＺ平面上の格子で区切り、１マスを１クラスタにする
+*/
+void PathCluster_Setup()
+{
+	// 分割の範囲はステージモデル全体の範囲
+	pathCluster.minX = polyList.MinPosition.x;
+	pathCluster.minZ = polyList.MinPosition.z;
+	float sizeX = polyList.MaxPosition.x - polyList.MinPosition.x;
+	float sizeZ = polyList.MaxPosition.z - polyList.MinPosition.z;
+
+	// １クラスタにおよそ PATHCLUSTER_POLYNUM 枚のポリゴンが入るサイズにする
+	pathCluster.clusterSize = sqrtf(sizeX * sizeZ * PATHCLUSTER_POLYNUM / (polyList.PolygonNum > 0 ? polyList.PolygonNum : 1));
+	if(pathCluster.clusterSize <= 0.0f)
+	{
+		pathCluster.clusterSize = 1.0f;
+	}
+	pathCluster.clusterNumX = (int)(sizeX / pathCluster.clusterSize) + 1;
+	pathCluster.clusterNumZ = (int)(sizeZ / pathCluster.clusterSize) + 1;
+	pathCluster.clusterNum = pathCluster.clusterNumX * pathCluster.clusterNumZ;
+
+	// 各ポリゴンが属するクラスタを中心座標から決める
+	pathCluster.polyClusterIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	pathCluster.polyNodeIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		int clusterX = (int)((polyLinkInfo[i].centerPosition.x - pathCluster.minX) / pathCluster.clusterSize);
+		int clusterZ = (int)((polyLinkInfo[i].centerPosition.z - pathCluster.minZ) / pathCluster.clusterSize);
+		pathCluster.polyClusterIndex[i] = clusterZ * pathCluster.clusterNumX + clusterX;
+		pathCluster.polyNodeIndex[i] = -1;
+	}
+
+	// クラスタの配列を確保する
+	pathCluster.clusterArray = (PATHCLUSTER *)malloc(sizeof(PATHCLUSTER) * pathCluster.clusterNum);
+	for(int i=0; i<pathCluster.clusterNum; i++)
+	{
+		pathCluster.clusterArray[i].nodeNum = 0;
+		pathCluster.clusterArray[i].nodePolyIndex = NULL;
+		pathCluster.clusterArray[i].nodeCost = NULL;
+		pathCluster.clusterArray[i].dirty = true;
+	}
+
+	// 全クラスタを構築する
+	PathCluster_InitializeWork(&pathCluster.buildWork);
+	pathCluster.rebuildClusterNum = 0;
+	PathCluster_Refresh();
+}
+
+/**
+* @fn PathCluster_Terminate
+* @brief クラスタ分割の情報の後始末
+*/
+void PathCluster_Terminate()
+{
+	for(int i=0; i<pathCluster.clusterNum; i++)
+	{
+		free(pathCluster.clusterArray[i].nodePolyIndex);
+		free(pathCluster.clusterArray[i].nodeCost);
+	}
+	free(pathCluster.clusterArray);
+	pathCluster.clusterArray = NULL;
+	pathCluster.clusterNum = 0;
+
+	free(pathCluster.polyClusterIndex);
+	pathCluster.polyClusterIndex = NULL;
+	free(pathCluster.polyNodeIndex);
+	pathCluster.polyNodeIndex = NULL;
+
+	PathCluster_TerminateWork(&pathCluster.buildWork);
+}
+
+/**
+* @fn PathCluster_SetDirtyPoly
+* @brief 指定のポリゴンの連結情報が変わったので、関係するクラスタを作り直しが必要な状態にする
+* @param[in] int polyIndex
+* @details ポリゴンが属するクラスタと隣接ポリゴンが属するクラスタが対象になる
+*          連結を外した場合は、外した相手のポリゴンについても呼ぶこと
+*/
+void PathCluster_SetDirtyPoly(int polyIndex)
+{
+	pathCluster.clusterArray[pathCluster.polyClusterIndex[polyIndex]].dirty = true;
+	for(int i=0; i<3; i++)
+	{
+		int linkPolyIndex = polyLinkInfo[polyIndex].linkPolyIndex[i];
+		if(linkPolyIndex != -1)
+		{
+			pathCluster.clusterArray[pathCluster.polyClusterIndex[linkPolyIndex]].dirty = true;
+		}
+	}
+}
+
+/**
+* @fn PathCluster_Refresh
+* @brief 作り直しが必要なクラスタだけを作り直す
+* @return int 作り直したクラスタの数
+* @details 他のスレッドで PathCluster_FindPath を実行中の場合は終わるまで待つ
+*/
+int PathCluster_Refresh()
+{
+	AcquireSRWLockExclusive(&pathClusterLock);
+	int rebuildNum = 0;
+	for(int i=0; i<pathCluster.clusterNum; i++)
+	{
+		if(pathCluster.clusterArray[i].dirty)
+		{
+			PathCluster_BuildCluster(i);
+			rebuildNum++;
+		}
+	}
+	ReleaseSRWLockExclusive(&pathClusterLock);
+	return rebuildNum;
+}
+
+/**
+* @fn PathCluster_InitializeWork
+* @brief 作業用の情報の初期化
+* @param[in] PATHCLUSTER_WORK *work
+*/
+void PathCluster_InitializeWork(PATHCLUSTER_WORK *work)
+{
+	work->distance = (float *)malloc(sizeof(float) * polyList.PolygonNum);
+	work->prevPolyIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	work->nextPolyIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	work->stamp = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	work->localDistance = (float *)malloc(sizeof(float) * polyList.PolygonNum);
+	work->localPrevPolyIndex = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	work->localStamp = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	work->goalDistance = (float *)malloc(sizeof(float) * polyList.PolygonNum);
+	work->goalStamp = (int *)malloc(sizeof(int) * polyList.PolygonNum);
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		work->stamp[i] = 0;
+		work->localStamp[i] = 0;
+		work->goalStamp[i] = 0;
+	}
+	work->nowStamp = 0;
+	PathHeap_Initialize(&work->heap, 64);
+	PathHeap_Initialize(&work->localHeap, 64);
+	work->expandNodeNum = 0;
+}
+
+/**
+* @fn PathCluster_TerminateWork
+* @brief 作業用の情報の後始末
+* @param[in] PATHCLUSTER_WORK *work
+*/
+void PathCluster_TerminateWork(PATHCLUSTER_WORK *work)
+{
+	free(work->distance);
+	free(work->prevPolyIndex);
+	free(work->nextPolyIndex);
+	free(work->stamp);
+	free(work->localDistance);
+	free(work->localPrevPolyIndex);
+	free(work->localStamp);
+	free(work->goalDistance);
+	free(work->goalStamp);
+	work->distance = NULL;
+	work->prevPolyIndex = NULL;
+	work->nextPolyIndex = NULL;
+	work->stamp = NULL;
+	work->localDistance = NULL;
+	work->localPrevPolyIndex = NULL;
+	work->localStamp = NULL;
+	work->goalDistance = NULL;
+	work->goalStamp = NULL;
+	PathHeap_Terminate(&work->heap);
+	PathHeap_Terminate(&work->localHeap);
+}
+
+/**
+* @fn PathCluster_Relax
+* @brief 上位の探索で、指定のノードにより短い距離で到達できたら登録する
+* @param[in] PATHCLUSTER_WORK *work, int stampValue, int polyIndex, int prevPolyIndex, float distance, int goalPolyIndex
+*/
+static void PathCluster_Relax(PATHCLUSTER_WORK *work, int stampValue, int polyIndex, int prevPolyIndex, float distance, int goalPolyIndex)
+{
+	// 障害物で通れないポリゴンには進まない( スタートは障害物の中からでも抜け出せるようにする )
+	if(prevPolyIndex != -1 && NavTile_IsPolyBlocked(polyIndex))
+	{
+		return;
+	}
+
+	if(work->stamp[polyIndex] == stampValue && work->distance[polyIndex] <= distance)
+	{
+		return;
+	}
+
+	work->distance[polyIndex] = distance;
+	work->prevPolyIndex[polyIndex] = prevPolyIndex;
+	work->stamp[polyIndex] = stampValue;
+
+	// 評価値はスタートからの距離とゴールまでの直線距離の合計
+	PathHeap_Push(&work->heap, polyIndex,
+		distance + VSize(VSub(polyLinkInfo[goalPolyIndex].centerPosition, polyLinkInfo[polyIndex].centerPosition)));
+}
+
+/**
+* @fn PathCluster_BeginSearchUnlocked
+* @brief PathCluster_BeginSearch の本体
+* @param[in] PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex
+*/
+static void PathCluster_BeginSearchUnlocked(PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex)
+{
+	work->startPolyIndex = startPolyIndex;
+	work->goalPolyIndex = goalPolyIndex;
+	work->clusterSerial = pathCluster.rebuildClusterNum;
+
+	// ゴールのクラスタ内で、各ポリゴンからゴールまでの距離を求めておく
+	work->goalSearchStamp = PathCluster_SearchInCluster(work, goalPolyIndex, -1, work->goalDistance, work->localPrevPolyIndex, work->goalStamp);
+
+	// 上位の探索の開始
+	work->nowStamp++;
+	work->searchStamp = work->nowStamp;
+	work->expandNodeNum = 0;
+	PathHeap_Clear(&work->heap);
+	PathCluster_Relax(work, work->searchStamp, startPolyIndex, -1, 0.0f, goalPolyIndex);
+}
+
+/**
+* @fn PathCluster_StepSearchUnlocked
+* @brief PathCluster_StepSearch の本体
+* @param[in] PATHCLUSTER_WORK *work, int maxExpandNum
+* @return int 1:ゴールに辿り着いた  -1:経路が無かった  0:まだ探索中
+*/
+static int PathCluster_StepSearchUnlocked(PATHCLUSTER_WORK *work, int maxExpandNum)
+{
+	// 前回から今回までの間にクラスタが作り直されていたら最初からやり直す
+	if(work->clusterSerial != pathCluster.rebuildClusterNum)
+	{
+		PathCluster_BeginSearchUnlocked(work, work->startPolyIndex, work->goalPolyIndex);
+	}
+
+	int startPolyIndex = work->startPolyIndex;
+	int goalPolyIndex = work->goalPolyIndex;
+	int startClusterIndex = pathCluster.polyClusterIndex[startPolyIndex];
+	int goalClusterIndex = pathCluster.polyClusterIndex[goalPolyIndex];
+	int stampValue = work->searchStamp;
+	int goalStampValue = work->goalSearchStamp;
+
+	int polyIndex;
+	float key;
+	for(int n=0; n<maxExpandNum; n++)
+	{
+		if(PathHeap_Pop(&work->heap, &polyIndex, &key) == false)
+		{
+			return -1;
+		}
+		float distance = work->distance[polyIndex];
+
+		// 既により短い距離で処理済みの場合は何もしない
+		if(key > distance + VSize(VSub(polyLinkInfo[goalPolyIndex].centerPosition, polyLinkInfo[polyIndex].centerPosition)))
+		{
+			continue;
+		}
+
+		// ゴールに辿り着いたら終了
+		if(polyIndex == goalPolyIndex)
+		{
+			return 1;
+		}
+		work->expandNodeNum++;
+
+		int clusterIndex = pathCluster.polyClusterIndex[polyIndex];
+		PATHCLUSTER *cluster = &pathCluster.clusterArray[clusterIndex];
+
+		// スタートのポリゴンからはクラスタ内を探索して境界ノードとゴールに繋ぐ
+		if(polyIndex == startPolyIndex)
+		{
+			int localStampValue = PathCluster_SearchInCluster(work, startPolyIndex, -1,
+				work->localDistance, work->localPrevPolyIndex, work->localStamp);
+			for(int i=0; i<cluster->nodeNum; i++)
+			{
+				int nodePolyIndex = cluster->nodePolyIndex[i];
+				if(work->localStamp[nodePolyIndex] == localStampValue)
+				{
+					PathCluster_Relax(work, stampValue, nodePolyIndex, polyIndex, distance + work->localDistance[nodePolyIndex], goalPolyIndex);
+				}
+			}
+			if(startClusterIndex == goalClusterIndex && work->localStamp[goalPolyIndex] == localStampValue)
+			{
+				PathCluster_Relax(work, stampValue, goalPolyIndex, polyIndex, distance + work->localDistance[goalPolyIndex], goalPolyIndex);
+			}
+		}
+
+		// 境界ノードでなければここまで
+		int nodeIndex = pathCluster.polyNodeIndex[polyIndex];
+		if(nodeIndex == -1)
+		{
+			continue;
+		}
+
+		// 同じクラスタの境界ノードへは保存しておいた最短距離で繋ぐ
+		for(int i=0; i<cluster->nodeNum; i++)
+		{
+			float cost = cluster->nodeCost[nodeIndex * cluster->nodeNum + i];
+			if(i != nodeIndex && cost >= 0.0f)
+			{
+				PathCluster_Relax(work, stampValue, cluster->nodePolyIndex[i], polyIndex, distance + cost, goalPolyIndex);
+			}
+		}
+
+		// 隣のクラスタの境界ノードへはポリゴン同士の連結情報で繋ぐ
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = pLInfo->linkPolyIndex[i];
+			if(linkPolyIndex != -1 && pathCluster.polyClusterIndex[linkPolyIndex] != clusterIndex)
+			{
+				PathCluster_Relax(work, stampValue, linkPolyIndex, polyIndex, distance + pLInfo->linkPolyDistance[i], goalPolyIndex);
+			}
+		}
+
+		// ゴールのクラスタの境界ノードからはゴールに繋ぐ
+		if(clusterIndex == goalClusterIndex && work->goalStamp[polyIndex] == goalStampValue)
+		{
+			PathCluster_Relax(work, stampValue, goalPolyIndex, polyIndex, distance + work->goalDistance[polyIndex], goalPolyIndex);
+		}
+	}
+
+	return 0;
+}
+
+/**
+* @fn PathCluster_EndSearchUnlocked
+* @brief PathCluster_EndSearch の本体
+* @param[in] PATHCLUSTER_WORK *work, int maxPathNum
+* @param[out] int *pathPolyIndex, int *pathPolyNum, bool *truncated
+* @return bool true:成功  false:失敗
+*/
+static bool PathCluster_EndSearchUnlocked(PATHCLUSTER_WORK *work, int *pathPolyIndex, int maxPathNum, int *pathPolyNum, bool *truncated)
+{
+	int startPolyIndex = work->startPolyIndex;
+	int goalPolyIndex = work->goalPolyIndex;
+	int polyIndex;
+	*truncated = false;
+
+	// 上位の経路をゴールからスタートに辿って、スタートから順に辿れるように一つ先のノードを記録する
+	int *nextNode = work->nextPolyIndex;
+	nextNode[goalPolyIndex] = -1;
+	for(polyIndex = goalPolyIndex; polyIndex != startPolyIndex; polyIndex = work->prevPolyIndex[polyIndex])
+	{
+		nextNode[work->prevPolyIndex[polyIndex]] = polyIndex;
+	}
+
+	// 上位の経路のノード同士の間をクラスタ内の探索で埋めて、ポリゴン番号の列にする
+	// maxPathNum に収まらない場合はスタートから収まる所までを返す
+	int num = 0;
+	pathPolyIndex[num] = startPolyIndex;
+	num++;
+	for(polyIndex = startPolyIndex; polyIndex != goalPolyIndex; polyIndex = nextNode[polyIndex])
+	{
+		int nextPolyIndex = nextNode[polyIndex];
+
+		// 隣のクラスタへの移動は隣接ポリゴンなのでそのまま追加する
+		if(pathCluster.polyClusterIndex[nextPolyIndex] != pathCluster.polyClusterIndex[polyIndex])
+		{
+			if(num >= maxPathNum)
+			{
+				*truncated = true;
+				break;
+			}
+			pathPolyIndex[num] = nextPolyIndex;
+			num++;
+			continue;
+		}
+
+		// 同じクラスタ内の移動はクラスタ内を探索し直す
+		int localStampValue = PathCluster_SearchInCluster(work, polyIndex, nextPolyIndex,
+			work->localDistance, work->localPrevPolyIndex, work->localStamp);
+		if(work->localStamp[nextPolyIndex] != localStampValue)
+		{
+			return false;
+		}
+
+		// 経路上のポリゴンの数を数えてから、後ろから順に格納する( 収まらない部分は捨てる )
+		int length = 0;
+		for(int i=nextPolyIndex; i!=polyIndex; i=work->localPrevPolyIndex[i])
+		{
+			length++;
+		}
+		int writeIndex = num + length - 1;
+		for(int i=nextPolyIndex; i!=polyIndex; i=work->localPrevPolyIndex[i])
+		{
+			if(writeIndex < maxPathNum)
+			{
+				pathPolyIndex[writeIndex] = i;
+			}
+			writeIndex--;
+		}
+		if(num + length > maxPathNum)
+		{
+			num = maxPathNum;
+			*truncated = true;
+			break;
+		}
+		num += length;
+	}
+
+	*pathPolyNum = num;
+	return true;
+}
+
+/**
+* @fn PathCluster_FindPath
+* @brief 階層的に経路を探索して、スタートからゴールまでのポリゴン番号の列を求める
+* @param[in] PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex, int maxPathNum
+* @param[out] int *pathPolyIndex スタートからゴールまでのポリゴン番号( スタートとゴールを含む ), int *pathPolyNum ポリゴン番号の数,
+*             bool *truncated true:maxPathNum に収まらなかったのでスタートから途中までの経路
+* @return bool true:成功  false:経路が無い
+* @details 複数のスレッドから同時に呼んで良い( 作業用の情報はスレッドごとに用意する )
+*          障害物で通れないポリゴンは通らない
+*/
+bool PathCluster_FindPath(PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex, int *pathPolyIndex, int maxPathNum, int *pathPolyNum, bool *truncated)
+{
+	AcquireSRWLockShared(&pathClusterLock);
+	PathCluster_BeginSearchUnlocked(work, startPolyIndex, goalPolyIndex);
+	bool result = PathCluster_StepSearchUnlocked(work, INT_MAX) == 1 &&
+		PathCluster_EndSearchUnlocked(work, pathPolyIndex, maxPathNum, pathPolyNum, truncated);
+	ReleaseSRWLockShared(&pathClusterLock);
+	return result;
+}
+
+/**
+* @fn PathCluster_BeginSearch
+* @brief 少しずつ進める階層的経路探索を開始する
+* @param[in] PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex
+* @details PathCluster_StepSearch で 1 が返るまで進めてから PathCluster_EndSearch で経路を受け取る
+*          途中でクラスタが作り直された場合は、次の PathCluster_StepSearch で最初からやり直す
+*/
+void PathCluster_BeginSearch(PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex)
+{
+	AcquireSRWLockShared(&pathClusterLock);
+	PathCluster_BeginSearchUnlocked(work, startPolyIndex, goalPolyIndex);
+	ReleaseSRWLockShared(&pathClusterLock);
+}
+
+/**
+* @fn PathCluster_StepSearch
+* @brief 上位の探索を指定のノード数だけ進める
+* @param[in] PATHCLUSTER_WORK *work, int maxExpandNum
+* @return int 1:ゴールに辿り着いた  -1:経路が無かった  0:まだ探索中
+*/
+int PathCluster_StepSearch(PATHCLUSTER_WORK *work, int maxExpandNum)
+{
+	AcquireSRWLockShared(&pathClusterLock);
+	int state = PathCluster_StepSearchUnlocked(work, maxExpandNum);
+	ReleaseSRWLockShared(&pathClusterLock);
+	return state;
+}
+
+/**
+* @fn PathCluster_EndSearch
+* @brief ゴールに辿り着いた探索のポリゴン番号の列を求める
+* @param[in] PATHCLUSTER_WORK *work, int maxPathNum
+* @param[out] int *pathPolyIndex, int *pathPolyNum, bool *truncated true:maxPathNum に収まらなかったのでスタートから途中までの経路
+* @return bool true:成功  false:失敗
+* @details PathCluster_StepSearch が 1 を返した直後に、クラスタを作り直す前に呼ぶこと
+*/
+bool PathCluster_EndSearch(PATHCLUSTER_WORK *work, int *pathPolyIndex, int maxPathNum, int *pathPolyNum, bool *truncated)
+{
+	AcquireSRWLockShared(&pathClusterLock);
+	bool result = PathCluster_EndSearchUnlocked(work, pathPolyIndex, maxPathNum, pathPolyNum, truncated);
+	ReleaseSRWLockShared(&pathClusterLock);
+	return result;
+}
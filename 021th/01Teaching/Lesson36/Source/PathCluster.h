@@ -0,0 +1,76 @@
+﻿#pragma once
+#include "PathHeap.h"
+
+const int PATHCLUSTER_POLYNUM = 32;				//!< １クラスタに含めるポリゴン数の目安
+
+/**
+* @struct PATHCLUSTER
+* @brief 階層的経路探索用のクラスタ( ポリゴンのまとまり )の情報
+* @details 他のクラスタと隣接しているポリゴンを境界ノードとして、境界ノード同士の最短距離を保存しておく
+*/
+struct PATHCLUSTER
+{
+	int nodeNum;							//!< 境界ノードの数
+	int *nodePolyIndex;						//!< 境界ノードのポリゴン番号の配列
+	float *nodeCost;						//!< 境界ノード同士のクラスタ内での最短距離( nodeNum × nodeNum、辿り着けない場合は -1.0f )
+	bool dirty;								//!< 作り直しが必要かどうか
+};
+
+/**
+* @struct PATHCLUSTER_WORK
+* @brief 階層的経路探索の作業用の情報( 同時に探索する処理ごとに一つ用意する )
+*/
+struct PATHCLUSTER_WORK
+{
+	float *distance;						//!< 上位の探索でのスタートからの距離( ポリゴン数分 )
+	int *prevPolyIndex;						//!< 上位の探索での一つ前のノードのポリゴン番号( ポリゴン数分 )
+	int *nextPolyIndex;						//!< 上位の経路での一つ先のノードのポリゴン番号( ポリゴン数分 )
+	int *stamp;								//!< distance と prevPolyIndex が今回の探索で設定されたかどうかの判定用( ポリゴン数分 )
+	float *localDistance;					//!< クラスタ内の探索での距離( ポリゴン数分 )
+	int *localPrevPolyIndex;				//!< クラスタ内の探索での一つ前のポリゴン番号( ポリゴン数分 )
+	int *localStamp;						//!< localDistance と localPrevPolyIndex の判定用( ポリゴン数分 )
+	float *goalDistance;					//!< ゴールのクラスタ内でのゴールまでの距離( ポリゴン数分 )
+	int *goalStamp;							//!< goalDistance の判定用( ポリゴン数分 )
+	int nowStamp;							//!< 現在の判定用の値
+	PATHHEAP heap;							//!< 上位の探索用のヒープ
+	PATHHEAP localHeap;						//!< クラスタ内の探索用のヒープ
+	int expandNodeNum;						//!< 直前の探索で上位の探索で処理したノードの数( 統計用 )
+	int startPolyIndex;						//!< 探索中のスタートのポリゴン番号
+	int goalPolyIndex;						//!< 探索中のゴールのポリゴン番号
+	int searchStamp;						//!< 探索中の上位の探索の判定用の値
+	int goalSearchStamp;					//!< 探索中のゴールのクラスタ内の探索の判定用の値
+	int clusterSerial;						//!< 探索を開始した時点のクラスタの作り直しの回数( 変わっていたら探索をやり直す )
+};
+
+/**
+* @struct PATHCLUSTERINFO
+* @brief ステージモデルの全ポリゴンをクラスタに分割した情報
+*/
+struct PATHCLUSTERINFO
+{
+	float minX;								//!< クラスタ分割の左端のＸ座標
+	float minZ;								//!< クラスタ分割の手前端のＺ座標
+	float clusterSize;						//!< クラスタ１つのＸＺ平面上のサイズ
+	int clusterNumX;						//!< Ｘ軸方向のクラスタの数
+	int clusterNumZ;						//!< Ｚ軸方向のクラスタの数
+	int clusterNum;							//!< クラスタの数
+	PATHCLUSTER *clusterArray;				//!< クラスタの配列
+	int *polyClusterIndex;					//!< 各ポリゴンが属しているクラスタの番号( ポリゴン数分 )
+	int *polyNodeIndex;						//!< 各ポリゴンのクラスタ内での境界ノードの番号( ポリゴン数分、境界ノードでは無い場合は -1 )
+	PATHCLUSTER_WORK buildWork;				//!< クラスタの構築で使用する作業用の情報
+	int rebuildClusterNum;					//!< これまでに作り直したクラスタの数( 統計用 )
+};
+
+extern PATHCLUSTERINFO pathCluster;				//!< クラスタ分割の情報
+
+void PathCluster_Setup(void);					//!< 全ポリゴンをクラスタに分割して、全クラスタの境界ノードを構築する
+void PathCluster_Terminate(void);				//!< クラスタ分割の情報の後始末
+void PathCluster_SetDirtyPoly(int polyIndex);	//!< 指定のポリゴンの連結情報が変わったので、関係するクラスタを作り直しが必要な状態にする
+int PathCluster_Refresh(void);					//!< 作り直しが必要なクラスタだけを作り直す( 戻り値 : 作り直したクラスタの数 )
+
+void PathCluster_InitializeWork(PATHCLUSTER_WORK *work);	//!< 作業用の情報の初期化
+void PathCluster_TerminateWork(PATHCLUSTER_WORK *work);		//!< 作業用の情報の後始末
+bool PathCluster_FindPath(PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex, int *pathPolyIndex, int maxPathNum, int *pathPolyNum, bool *truncated);	//!< 階層的に経路を探索して、スタートからゴールまでのポリゴン番号の列を求める( 戻り値  true:成功  false:経路が無い )
+void PathCluster_BeginSearch(PATHCLUSTER_WORK *work, int startPolyIndex, int goalPolyIndex);	//!< 少しずつ進める階層的経路探索を開始する
+int PathCluster_StepSearch(PATHCLUSTER_WORK *work, int maxExpandNum);	//!< 上位の探索を指定のノード数だけ進める( 戻り値 1:ゴールに辿り着いた  -1:経路が無かった  0:まだ探索中 )
+bool PathCluster_EndSearch(PATHCLUSTER_WORK *work, int *pathPolyIndex, int maxPathNum, int *pathPolyNum, bool *truncated);	//!< ゴールに辿り着いた探索のポリゴン番号の列を求める( 戻り値  true:成功  false:失敗 )
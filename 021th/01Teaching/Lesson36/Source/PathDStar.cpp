@@ -0,0 +1,427 @@
+﻿#include "PathDStar.h"
+#include "PolyLink.h"
+#include "NavTile.h"
+#include <malloc.h>
+#include <float.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details D* Lite による差分経路探索
+*          スタートのポリゴンを根にして g( スタートからの最短距離 )を保ち続け、
+*          ゴールの移動は優先度の補正値 km で、移動コストの変更は変わった辺の両端の再計算で吸収する
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @fn PathDStar_Heuristic
+* @brief 指定のポリゴンからゴールのポリゴンまでの推定距離
+* @param[in] PATHDSTAR *dstar, int polyIndex
+* @return float 中心同士の直線距離( 隣接ポリゴン間の移動コストは中心同士の距離以上なので過大評価にならない )
+*/
+static float PathDStar_Heuristic(PATHDSTAR *dstar, int polyIndex)
+{
+	return VSize(VSub(polyLinkInfo[dstar->goalPolyIndex].centerPosition, polyLinkInfo[polyIndex].centerPosition));
+}
+
+/**
+* @fn PathDStar_CalcKey
+* @brief 指定のポリゴンの優先度を求める
+* @param[in] PATHDSTAR *dstar, int polyIndex
+* @param[out] float *key, float *subKey 優先度( key が同じ場合は subKey の小さい方が優先 )
+*/
+static void PathDStar_CalcKey(PATHDSTAR *dstar, int polyIndex, float *key, float *subKey)
+{
+	float minDistance = dstar->g[polyIndex] < dstar->rhs[polyIndex] ? dstar->g[polyIndex] : dstar->rhs[polyIndex];
+	*subKey = minDistance;
+	*key = minDistance == FLT_MAX ? FLT_MAX : minDistance + PathDStar_Heuristic(dstar, polyIndex) + dstar->km;
+}
+
+/**
+* @fn PathDStar_UpdateVertex
+* @brief 指定のポリゴンの rhs を隣接ポリゴンから求め直し、g と違う場合は展開待ちにする
+* @param[in] PATHDSTAR *dstar, int polyIndex
+* @details ヒープからは取り除かず、取り出した時に古い優先度のものを読み飛ばす
+*/
+static void PathDStar_UpdateVertex(PATHDSTAR *dstar, int polyIndex)
+{
+	if(polyIndex != dstar->rootPolyIndex)
+	{
+		float minDistance = FLT_MAX;
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = pLInfo->linkPolyIndex[i];
+			float cost = dstar->edgeCost[polyIndex * 3 + i];
+			if(linkPolyIndex == -1 || cost == FLT_MAX || dstar->g[linkPolyIndex] == FLT_MAX)
+			{
+				continue;
+			}
+			if(dstar->g[linkPolyIndex] + cost < minDistance)
+			{
+				minDistance = dstar->g[linkPolyIndex] + cost;
+			}
+		}
+		dstar->rhs[polyIndex] = minDistance;
+	}
+
+	if(dstar->g[polyIndex] != dstar->rhs[polyIndex])
+	{
+		float key, subKey;
+		PathDStar_CalcKey(dstar, polyIndex, &key, &subKey);
+		PathHeap_PushSubKey(&dstar->heap, polyIndex, key, subKey);
+	}
+}
+
+/**
+* @fn PathDStar_ComputeShortestPath
+* @brief ゴールの g が確定するまで、優先度の高い順にポリゴンを展開する
+* @param[in] PATHDSTAR *dstar
+*/
+static void PathDStar_ComputeShortestPath(PATHDSTAR *dstar)
+{
+	int goalPolyIndex = dstar->goalPolyIndex;
+	for(;;)
+	{
+		// ゴールより優先度の高いポリゴンが無く、ゴールの g が確定していたら終了
+		float topKey, topSubKey, goalKey, goalSubKey;
+		if(!PathHeap_GetTop(&dstar->heap, &topKey, &topSubKey))
+		{
+			break;
+		}
+		PathDStar_CalcKey(dstar, goalPolyIndex, &goalKey, &goalSubKey);
+		if((topKey > goalKey || (topKey == goalKey && topSubKey >= goalSubKey)) && dstar->g[goalPolyIndex] == dstar->rhs[goalPolyIndex])
+		{
+			break;
+		}
+
+		int polyIndex;
+		float oldKey, oldSubKey;
+		PathHeap_PopSubKey(&dstar->heap, &polyIndex, &oldKey, &oldSubKey);
+
+		// g と rhs が一致しているものは展開済み
+		if(dstar->g[polyIndex] == dstar->rhs[polyIndex])
+		{
+			continue;
+		}
+
+		// ゴールの移動で優先度が下がっていたら入れ直す、上がっていたら新しい方が登録されているので読み飛ばす
+		float newKey, newSubKey;
+		PathDStar_CalcKey(dstar, polyIndex, &newKey, &newSubKey);
+		if(oldKey < newKey || (oldKey == newKey && oldSubKey < newSubKey))
+		{
+			PathHeap_PushSubKey(&dstar->heap, polyIndex, newKey, newSubKey);
+			continue;
+		}
+		if(oldKey != newKey || oldSubKey != newSubKey)
+		{
+			continue;
+		}
+
+		dstar->expandNodeNum++;
+		dstar->expandStamp[polyIndex] = dstar->nowStamp;
+
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		if(dstar->g[polyIndex] > dstar->rhs[polyIndex])
+		{
+			// 距離が短くなったので確定して、隣接ポリゴンに伝える
+			dstar->g[polyIndex] = dstar->rhs[polyIndex];
+			for(int i=0; i<3; i++)
+			{
+				int linkPolyIndex = pLInfo->linkPolyIndex[i];
+				if(linkPolyIndex != -1)
+				{
+					PathDStar_UpdateVertex(dstar, linkPolyIndex);
+				}
+			}
+		}
+		else
+		{
+			// 距離が長くなったので一旦未到達にして、自身と隣接ポリゴンを求め直す
+			dstar->g[polyIndex] = FLT_MAX;
+			PathDStar_UpdateVertex(dstar, polyIndex);
+			for(int i=0; i<3; i++)
+			{
+				int linkPolyIndex = pLInfo->linkPolyIndex[i];
+				if(linkPolyIndex != -1)
+				{
+					PathDStar_UpdateVertex(dstar, linkPolyIndex);
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn PathDStar_Reset
+* @brief 探索の状態を捨てて、指定のポリゴンを根にして最初から探索できる状態にする
+* @param[in] PATHDSTAR *dstar, int rootPolyIndex
+*/
+static void PathDStar_Reset(PATHDSTAR *dstar, int rootPolyIndex)
+{
+	for(int i=0; i<polyList.PolygonNum; i++)
+	{
+		dstar->g[i] = FLT_MAX;
+		dstar->rhs[i] = FLT_MAX;
+	}
+	dstar->km = 0.0f;
+	dstar->rootPolyIndex = rootPolyIndex;
+	dstar->rhs[rootPolyIndex] = 0.0f;
+	PathHeap_Clear(&dstar->heap);
+	PathDStar_UpdateVertex(dstar, rootPolyIndex);
+}
+
+/**
+* @fn PathDStar_BuildPath
+* @brief ゴールから g の小さい隣接ポリゴンを辿ってスタートまでの経路を作る
+* @param[in] PATHDSTAR *dstar
+* @return bool true:現在のスタートのポリゴンが経路上にあった  false:無かった
+* @details 根から現在のスタートまでの部分は取り除く
+*/
+static bool PathDStar_BuildPath(PATHDSTAR *dstar)
+{
+	// ゴールから根まで辿って、後ろから詰める
+	int num = 0;
+	int polyIndex = dstar->goalPolyIndex;
+	for(;;)
+	{
+		dstar->pathPolyIndex[polyList.PolygonNum - 1 - num] = polyIndex;
+		num++;
+		if(polyIndex == dstar->rootPolyIndex || num == polyList.PolygonNum)
+		{
+			break;
+		}
+
+		int bestPolyIndex = -1;
+		float bestDistance = FLT_MAX;
+		POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+		for(int i=0; i<3; i++)
+		{
+			int linkPolyIndex = pLInfo->linkPolyIndex[i];
+			float cost = dstar->edgeCost[polyIndex * 3 + i];
+			if(linkPolyIndex == -1 || cost == FLT_MAX || dstar->g[linkPolyIndex] == FLT_MAX)
+			{
+				continue;
+			}
+			if(dstar->g[linkPolyIndex] + cost < bestDistance)
+			{
+				bestDistance = dstar->g[linkPolyIndex] + cost;
+				bestPolyIndex = linkPolyIndex;
+			}
+		}
+		if(bestPolyIndex == -1)
+		{
+			return false;
+		}
+		polyIndex = bestPolyIndex;
+	}
+	int *pathTop = &dstar->pathPolyIndex[polyList.PolygonNum - num];
+
+	// 現在のスタートのポリゴンより先の部分を先頭に詰める
+	for(int i=0; i<num; i++)
+	{
+		if(pathTop[i] == dstar->startPolyIndex)
+		{
+			dstar->pathPolyNum = num - i;
+			for(int j=0; j<dstar->pathPolyNum; j++)
+			{
+				dstar->pathPolyIndex[j] = pathTop[i + j];
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+* @fn PathDStar_Initialize
+* @brief 差分経路探索の初期化
+* @param[out] PATHDSTAR *dstar
+* @details ステージモデルのポリゴン情報と連結情報を構築した後に呼ぶ、移動コストは中心同士の距離で初期化する
+*/
+void PathDStar_Initialize(PATHDSTAR *dstar)
+{
+	int polyNum = polyList.PolygonNum;
+	dstar->g = (float *)malloc(sizeof(float) * polyNum);
+	dstar->rhs = (float *)malloc(sizeof(float) * polyNum);
+	dstar->edgeCost = (float *)malloc(sizeof(float) * polyNum * 3);
+	dstar->expandStamp = (int *)malloc(sizeof(int) * polyNum);
+	dstar->pathPolyIndex = (int *)malloc(sizeof(int) * polyNum);
+	for(int i=0; i<polyNum; i++)
+	{
+		for(int j=0; j<3; j++)
+		{
+			dstar->edgeCost[i * 3 + j] = polyLinkInfo[i].linkPolyIndex[j] == -1 ? FLT_MAX : polyLinkInfo[i].linkPolyDistance[j];
+		}
+		dstar->expandStamp[i] = 0;
+	}
+	dstar->pathPolyNum = 0;
+	dstar->nowStamp = 0;
+	PathHeap_Initialize(&dstar->heap, polyNum);
+	dstar->km = 0.0f;
+	dstar->rootPolyIndex = -1;
+	dstar->goalPolyIndex = -1;
+	dstar->startPolyIndex = -1;
+	dstar->expandNodeNum = 0;
+	dstar->reuseNodeNum = 0;
+	dstar->totalExpandNodeNum = 0;
+	dstar->totalReuseNodeNum = 0;
+	dstar->resetNum = 0;
+	dstar->changeEdgeNum = 0;
+	dstar->repairEdgeNum = 0;
+	dstar->repairExpandNodeNum = 0;
+}
+
+/**
+* @fn PathDStar_Terminate
+* @brief 差分経路探索の後始末
+* @param[in] PATHDSTAR *dstar
+*/
+void PathDStar_Terminate(PATHDSTAR *dstar)
+{
+	PathHeap_Terminate(&dstar->heap);
+	free(dstar->pathPolyIndex);
+	free(dstar->expandStamp);
+	free(dstar->edgeCost);
+	free(dstar->rhs);
+	free(dstar->g);
+	dstar->pathPolyIndex = NULL;
+	dstar->expandStamp = NULL;
+	dstar->edgeCost = NULL;
+	dstar->rhs = NULL;
+	dstar->g = NULL;
+}
+
+/**
+* @fn PathDStar_Plan
+* @brief 前回の探索結果を使って指定の２点の経路を探索する
+* @param[in] PATHDSTAR *dstar, VECTOR startPos, VECTOR goalPos
+* @return bool true:経路構築成功( 経路は pathPolyIndex に入る )  false:経路構築失敗
+* @details スタートが前回の経路上を進んでいる間は根を変えずに探索を続け、経路から外れた時だけ最初からやり直す
+*/
+bool PathDStar_Plan(PATHDSTAR *dstar, VECTOR startPos, VECTOR goalPos)
+{
+	int startPolyIndex = CheckOnPolyIndexNear(startPos, dstar->startPolyIndex);
+	int goalPolyIndex = CheckOnPolyIndexNear(goalPos, dstar->goalPolyIndex);
+	if(startPolyIndex == -1 || goalPolyIndex == -1)
+	{
+		return false;
+	}
+
+	dstar->nowStamp++;
+	dstar->expandNodeNum = 0;
+	dstar->reuseNodeNum = 0;
+	dstar->pathPolyNum = 0;
+
+	// 初回は最初から探索する
+	bool reset = dstar->rootPolyIndex == -1;
+	if(reset)
+	{
+		dstar->goalPolyIndex = goalPolyIndex;
+		PathDStar_Reset(dstar, startPolyIndex);
+	}
+	else if(goalPolyIndex != dstar->goalPolyIndex)
+	{
+		// ゴールが移動した分だけ補正値を増やし、以前の優先度が下限のままになるようにする
+		dstar->km += VSize(VSub(polyLinkInfo[goalPolyIndex].centerPosition, polyLinkInfo[dstar->goalPolyIndex].centerPosition));
+		dstar->goalPolyIndex = goalPolyIndex;
+	}
+	dstar->startPolyIndex = startPolyIndex;
+
+	PathDStar_ComputeShortestPath(dstar);
+
+	// スタートが経路から外れていたら、現在のスタートを根にして探索し直す
+	bool found = dstar->g[goalPolyIndex] != FLT_MAX && PathDStar_BuildPath(dstar);
+	if(!found && !reset)
+	{
+		dstar->resetNum++;
+		PathDStar_Reset(dstar, startPolyIndex);
+		PathDStar_ComputeShortestPath(dstar);
+		found = dstar->g[goalPolyIndex] != FLT_MAX && PathDStar_BuildPath(dstar);
+	}
+
+	// 経路上のポリゴンのうち、今回展開しなかったものは前回までの探索結果をそのまま使ったもの
+	if(found)
+	{
+		for(int i=0; i<dstar->pathPolyNum; i++)
+		{
+			if(dstar->expandStamp[dstar->pathPolyIndex[i]] != dstar->nowStamp)
+			{
+				dstar->reuseNodeNum++;
+			}
+		}
+	}
+	dstar->totalExpandNodeNum += dstar->expandNodeNum;
+	dstar->totalReuseNodeNum += dstar->reuseNodeNum;
+
+	// 移動コストの変更があった場合は、探し直しにかかった分を記録しておく
+	if(dstar->changeEdgeNum > 0)
+	{
+		dstar->repairEdgeNum = dstar->changeEdgeNum;
+		dstar->repairExpandNodeNum = dstar->expandNodeNum;
+		dstar->changeEdgeNum = 0;
+	}
+
+	return found;
+}
+
+/**
+* @fn PathDStar_SetEdgeCost
+* @brief ポリゴンの辺を通る移動コストを変更する
+* @param[in] PATHDSTAR *dstar, int polyIndex, int edge 辺の番号( 0 ～ 2 ), float cost 移動コスト( FLT_MAX で通行不可 )
+* @details 反対向きの移動コストも同じ値にする、影響は次の PathDStar_Plan で探索し直される
+*/
+void PathDStar_SetEdgeCost(PATHDSTAR *dstar, int polyIndex, int edge, float cost)
+{
+	int linkPolyIndex = polyLinkInfo[polyIndex].linkPolyIndex[edge];
+	if(linkPolyIndex == -1)
+	{
+		return;
+	}
+
+	if(dstar->edgeCost[polyIndex * 3 + edge] == cost)
+	{
+		return;
+	}
+	dstar->changeEdgeNum++;
+
+	dstar->edgeCost[polyIndex * 3 + edge] = cost;
+	for(int i=0; i<3; i++)
+	{
+		if(polyLinkInfo[linkPolyIndex].linkPolyIndex[i] == polyIndex)
+		{
+			dstar->edgeCost[linkPolyIndex * 3 + i] = cost;
+		}
+	}
+
+	// 両端のポリゴンの rhs を求め直す
+	if(dstar->rootPolyIndex != -1)
+	{
+		PathDStar_UpdateVertex(dstar, polyIndex);
+		PathDStar_UpdateVertex(dstar, linkPolyIndex);
+	}
+}
+
+/**
+* @fn PathDStar_UpdateBlockedPoly
+* @brief 障害物で通れるかどうかが変わったポリゴンの辺の移動コストを変更する
+* @param[in] PATHDSTAR *dstar, int polyIndex
+* @details どちらかのポリゴンが通れない辺は通行不可、両方とも通れる辺は中心同士の距離に戻す
+*          NavTile_Process の後に NavTile_GetChangedPoly で取得したポリゴンごとに呼ぶと、次の PathDStar_Plan で影響のある部分だけを探索し直す
+*/
+void PathDStar_UpdateBlockedPoly(PATHDSTAR *dstar, int polyIndex)
+{
+	bool blocked = NavTile_IsPolyBlocked(polyIndex);
+	POLYLINKINFO *pLInfo = &polyLinkInfo[polyIndex];
+	for(int i=0; i<3; i++)
+	{
+		int linkPolyIndex = pLInfo->linkPolyIndex[i];
+		if(linkPolyIndex == -1)
+		{
+			continue;
+		}
+		PathDStar_SetEdgeCost(dstar, polyIndex, i, blocked || NavTile_IsPolyBlocked(linkPolyIndex) ? FLT_MAX : pLInfo->linkPolyDistance[i]);
+	}
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+#include "DxLib.h"
+#include "PathHeap.h"
+
+/**
+* @struct PATHDSTAR
+* @brief D* Lite による差分経路探索の情報
+* @details 探索の根( 最短距離の基準 )をスタートのポリゴンにして、呼び出しの間も探索の状態を残しておく
+*          ゴールの移動やポリゴン間の移動コストの変更があった時は、影響のあるポリゴンだけを探索し直す
+*/
+struct PATHDSTAR
+{
+	float *g;								//!< スタートからの最短距離( ポリゴン数分、未到達は FLT_MAX )
+	float *rhs;								//!< 隣接ポリゴンの g から求めた一手先読みの最短距離( ポリゴン数分 )
+	float *edgeCost;						//!< 隣接ポリゴンへの移動コスト( ポリゴン数 × 3、移動できない場合は FLT_MAX )
+	int *expandStamp;						//!< 最後に展開された探索の番号( ポリゴン数分 )
+	int *pathPolyIndex;						//!< スタートからゴールまでのポリゴン番号( ポリゴン数分 )
+	int pathPolyNum;						//!< 経路上のポリゴンの数
+	int nowStamp;							//!< 現在の探索の番号
+	PATHHEAP heap;							//!< 展開するポリゴンの優先度付きキュー
+	float km;								//!< ゴールが移動した距離の合計( 優先度の下限を保つ為の補正値 )
+	int rootPolyIndex;						//!< 探索の根にしているスタートのポリゴン番号( -1:未探索 )
+	int goalPolyIndex;						//!< ゴールのポリゴン番号
+	int startPolyIndex;						//!< 現在のスタートのポリゴン番号( 経路上を進むと根から離れていく )
+	int expandNodeNum;						//!< 直前の探索で展開したポリゴンの数( 統計用 )
+	int reuseNodeNum;						//!< 直前の探索の経路で、前回までの探索結果をそのまま使ったポリゴンの数( 統計用 )
+	int totalExpandNodeNum;					//!< これまでに展開したポリゴンの数( 統計用 )
+	int totalReuseNodeNum;					//!< これまでに前回までの探索結果をそのまま使ったポリゴンの数( 統計用 )
+	int resetNum;							//!< スタートが経路から外れて探索を最初からやり直した回数( 統計用 )
+	int changeEdgeNum;						//!< 前回の探索の後に移動コストを変更した辺の数
+	int repairEdgeNum;						//!< 最後に移動コストの変更を反映した探索で、変更されていた辺の数( 統計用 )
+	int repairExpandNodeNum;				//!< 最後に移動コストの変更を反映した探索で展開したポリゴンの数( 統計用 )
+};
+
+void PathDStar_Initialize(PATHDSTAR *dstar);				//!< 差分経路探索の初期化
+void PathDStar_Terminate(PATHDSTAR *dstar);					//!< 差分経路探索の後始末
+bool PathDStar_Plan(PATHDSTAR *dstar, VECTOR startPos, VECTOR goalPos);	//!< 前回の探索結果を使って指定の２点の経路を探索する( 戻り値  true:経路構築成功  false:経路構築失敗 )
+void PathDStar_SetEdgeCost(PATHDSTAR *dstar, int polyIndex, int edge, float cost);	//!< ポリゴンの辺を通る移動コストを変更する( FLT_MAX で通行不可 )
+void PathDStar_UpdateBlockedPoly(PATHDSTAR *dstar, int polyIndex);	//!< 障害物で通れるかどうかが変わったポリゴンの辺の移動コストを変更する
@@ -0,0 +1,196 @@
+﻿#include "PathFunnel.h"
+#include "PolyLink.h"
+#include <malloc.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details ファネルアルゴリズムによる経路の直線化
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @fn CrossXZ
+* @brief ＸＺ平面上で p1 から見た p2 と p3 の位置関係を外積で求める
+* @param[in] VECTOR p1, VECTOR p2, VECTOR p3
+* @return float 正:p3 は p2 より反時計回り側  負:時計回り側  0:同じ方向
+*/
+static float CrossXZ(VECTOR p1, VECTOR p2, VECTOR p3)
+{
+	return (p2.x - p1.x) * (p3.z - p1.z) - (p2.z - p1.z) * (p3.x - p1.x);
+}
+
+/**
+* @fn EqualXZ
+* @brief ＸＺ平面上で２点が同じ位置かどうか
+* @param[in] VECTOR p1, VECTOR p2
+* @return bool true:同じ位置  false:違う位置
+*/
+static bool EqualXZ(VECTOR p1, VECTOR p2)
+{
+	float dx = p2.x - p1.x;
+	float dz = p2.z - p1.z;
+	return dx * dx + dz * dz < 0.001f;
+}
+
+/**
+* @fn PathFunnel_Build
+* @brief 経路上のポリゴンの列からファネルアルゴリズムで直線的に移動できる中間地点を算出する
+* @param[in] const int *pathPolyIndex スタートからゴールまでのポリゴン番号, int pathPolyNum, VECTOR startPos, VECTOR goalPos, float width 移動するものの幅, int maxWayPointNum
+* @param[out] VECTOR *wayPoint 中間地点( 最後はゴール位置、pathPolyNum + 1 個あれば足りる )
+* @return int 中間地点の数
+* @details 経路上の隣り合うポリゴン同士が共有する辺( ポータル )を width / 2.0f だけ両端から縮めて並べ、
+*          開始位置から見た左右の境界( ファネル )が交差した所を中間地点にする
+*          グローバルな作業領域を使用しないので、複数のスレッドから同時に呼んでも良い
+*/
+int PathFunnel_Build(const int *pathPolyIndex, int pathPolyNum, VECTOR startPos, VECTOR goalPos, float width, VECTOR *wayPoint, int maxWayPointNum)
+{
+	// ポータルの左右の端点を格納するメモリ領域を確保する( 先頭は開始位置、最後はゴール位置 )
+	int portalNum = pathPolyNum + 1;
+	VECTOR *portalLeft = (VECTOR *)malloc(sizeof(VECTOR) * portalNum);
+	VECTOR *portalRight = (VECTOR *)malloc(sizeof(VECTOR) * portalNum);
+
+	portalLeft[0] = startPos;
+	portalRight[0] = startPos;
+
+	// 経路上の隣り合うポリゴン同士が共有する辺をポータルとして登録する
+	int portalIndex = 1;
+	for(int n=0; n<pathPolyNum - 1; n++)
+	{
+		POLYLINKINFO *pLInfo = &polyLinkInfo[pathPolyIndex[n]];
+		MV1_REF_POLYGON *refPoly = &polyList.Polygons[pathPolyIndex[n]];
+
+		// 次のポリゴンと隣接している辺を探す
+		int edge;
+		for(edge=0; edge<2; edge++)
+		{
+			if(pLInfo->linkPolyIndex[edge] == pathPolyIndex[n + 1])
+			{
+				break;
+			}
+		}
+		VECTOR edgePos1 = polyList.Vertexs[refPoly->VIndex[edge]].Position;
+		VECTOR edgePos2 = polyList.Vertexs[refPoly->VIndex[(edge + 1) % 3]].Position;
+
+		// 辺の両端を width / 2.0f ずつ内側に縮める、辺の長さが width に満たない場合は辺の中点を通る
+		VECTOR edgeVec = VSub(edgePos2, edgePos1);
+		float edgeLength = VSize(edgeVec);
+		if(edgeLength > width)
+		{
+			VECTOR tempVec = VScale(edgeVec, width / 2.0f / edgeLength);
+			edgePos1 = VAdd(edgePos1, tempVec);
+			edgePos2 = VSub(edgePos2, tempVec);
+		}
+		else
+		{
+			edgePos1 = VScale(VAdd(edgePos1, edgePos2), 0.5f);
+			edgePos2 = edgePos1;
+		}
+
+		// 今いるポリゴンの中心から見て反時計回り側を左、時計回り側を右とする
+		if(CrossXZ(pLInfo->centerPosition, edgePos1, edgePos2) > 0.0f)
+		{
+			portalRight[portalIndex] = edgePos1;
+			portalLeft[portalIndex] = edgePos2;
+		}
+		else
+		{
+			portalRight[portalIndex] = edgePos2;
+			portalLeft[portalIndex] = edgePos1;
+		}
+		portalIndex++;
+	}
+
+	// 最後のポータルはゴール位置
+	portalLeft[portalIndex] = goalPos;
+	portalRight[portalIndex] = goalPos;
+
+	int wayPointNum = 0;
+
+	// ファネルの頂点と左右の境界を開始位置で初期化する
+	VECTOR apex = portalLeft[0];
+	VECTOR left = portalLeft[0];
+	VECTOR right = portalRight[0];
+	int apexIndex = 0;
+	int leftIndex = 0;
+	int rightIndex = 0;
+
+	for(int i=1; i<portalNum; i++)
+	{
+		// 右側の境界を狭められるかどうか
+		if(CrossXZ(apex, right, portalRight[i]) >= 0.0f)
+		{
+			if(EqualXZ(apex, right) || CrossXZ(apex, left, portalRight[i]) < 0.0f)
+			{
+				// 左側の境界を越えていなければ右側の境界を狭める
+				right = portalRight[i];
+				rightIndex = i;
+			}
+			else
+			{
+				// 左側の境界を越えたら左側の境界の端点を中間地点にして、そこから調べ直す
+				apex = left;
+				apexIndex = leftIndex;
+				if(wayPointNum >= maxWayPointNum)
+				{
+					break;
+				}
+				wayPoint[wayPointNum] = apex;
+				wayPointNum++;
+
+				left = apex;
+				right = apex;
+				leftIndex = apexIndex;
+				rightIndex = apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+
+		// 左側の境界を狭められるかどうか
+		if(CrossXZ(apex, left, portalLeft[i]) <= 0.0f)
+		{
+			if(EqualXZ(apex, left) || CrossXZ(apex, right, portalLeft[i]) > 0.0f)
+			{
+				// 右側の境界を越えていなければ左側の境界を狭める
+				left = portalLeft[i];
+				leftIndex = i;
+			}
+			else
+			{
+				// 右側の境界を越えたら右側の境界の端点を中間地点にして、そこから調べ直す
+				apex = right;
+				apexIndex = rightIndex;
+				if(wayPointNum >= maxWayPointNum)
+				{
+					break;
+				}
+				wayPoint[wayPointNum] = apex;
+				wayPointNum++;
+
+				left = apex;
+				right = apex;
+				leftIndex = apexIndex;
+				rightIndex = apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+	}
+
+	// 最後の中間地点はゴール位置
+	if(wayPointNum < maxWayPointNum &&
+		(wayPointNum == 0 || EqualXZ(wayPoint[wayPointNum - 1], goalPos) == false))
+	{
+		wayPoint[wayPointNum] = goalPos;
+		wayPointNum++;
+	}
+
+	// ポータルを格納していたメモリ領域を解放
+	free(portalLeft);
+	free(portalRight);
+
+	return wayPointNum;
+}
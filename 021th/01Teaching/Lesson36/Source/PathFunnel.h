@@ -0,0 +1,4 @@
+﻿#pragma once
+#include "DxLib.h"
+
+int PathFunnel_Build(const int *pathPolyIndex, int pathPolyNum, VECTOR startPos, VECTOR goalPos, float width, VECTOR *wayPoint, int maxWayPointNum);	//!< 経路上のポリゴンの列からファネルアルゴリズムで直線的に移動できる中間地点を算出する( 戻り値 : 中間地点の数 )
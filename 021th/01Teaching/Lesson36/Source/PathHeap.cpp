@@ -0,0 +1,198 @@
+﻿#include "PathHeap.h"
+#include <malloc.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 経路探索用の二分ヒープ
+*/
+
+/**
+* @fn PathHeap_Less
+* @brief 評価値( 同じ場合は第二の評価値 )を比べる
+* @param[in] float key1, float subKey1, float key2, float subKey2
+* @return bool true:１つ目の方が小さい  false:１つ目の方が小さくない
+*/
+static bool PathHeap_Less(float key1, float subKey1, float key2, float subKey2)
+{
+	return key1 < key2 || (key1 == key2 && subKey1 < subKey2);
+}
+
+/**
+* @fn PathHeap_Initialize
+* @brief ヒープの初期化
+* @param[in] PATHHEAP *heap, int maxNum 最初に確保する要素数
+*/
+void PathHeap_Initialize(PATHHEAP *heap, int maxNum)
+{
+	if(maxNum < 16)
+	{
+		maxNum = 16;
+	}
+	heap->index = (int *)malloc(sizeof(int) * maxNum);
+	heap->key = (float *)malloc(sizeof(float) * maxNum);
+	heap->subKey = (float *)malloc(sizeof(float) * maxNum);
+	heap->num = 0;
+	heap->maxNum = maxNum;
+}
+
+/**
+* @fn PathHeap_Terminate
+* @brief ヒープの後始末
+* @param[in] PATHHEAP *heap
+*/
+void PathHeap_Terminate(PATHHEAP *heap)
+{
+	free(heap->index);
+	free(heap->key);
+	free(heap->subKey);
+	heap->index = NULL;
+	heap->key = NULL;
+	heap->subKey = NULL;
+	heap->num = 0;
+	heap->maxNum = 0;
+}
+
+/**
+* @fn PathHeap_Clear
+* @brief ヒープを空にする
+* @param[in] PATHHEAP *heap
+*/
+void PathHeap_Clear(PATHHEAP *heap)
+{
+	heap->num = 0;
+}
+
+/**
+* @fn PathHeap_Push
+* @brief ヒープに追加する
+* @param[in] PATHHEAP *heap, int index, float key
+*/
+void PathHeap_Push(PATHHEAP *heap, int index, float key)
+{
+	PathHeap_PushSubKey(heap, index, key, 0.0f);
+}
+
+/**
+* @fn PathHeap_Pop
+* @brief ヒープから評価値の一番小さいものを取り出す
+* @param[in] PATHHEAP *heap
+* @param[out] int *index, float *key
+* @return bool true:取り出した  false:空だった
+*/
+bool PathHeap_Pop(PATHHEAP *heap, int *index, float *key)
+{
+	float subKey;
+	return PathHeap_PopSubKey(heap, index, key, &subKey);
+}
+
+/**
+* @fn PathHeap_PushSubKey
+* @brief 第二の評価値付きでヒープに追加する
+* @param[in] PATHHEAP *heap, int index, float key, float subKey 評価値が同じ場合に比べる値
+* @details 配列が足りなくなったら倍の大きさに確保し直す
+*/
+void PathHeap_PushSubKey(PATHHEAP *heap, int index, float key, float subKey)
+{
+	if(heap->num == heap->maxNum)
+	{
+		heap->maxNum *= 2;
+		heap->index = (int *)realloc(heap->index, sizeof(int) * heap->maxNum);
+		heap->key = (float *)realloc(heap->key, sizeof(float) * heap->maxNum);
+		heap->subKey = (float *)realloc(heap->subKey, sizeof(float) * heap->maxNum);
+	}
+
+	// 末尾に追加して、親より評価値が小さい間は親と入れ替える
+	int i = heap->num;
+	heap->num++;
+	while(i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if(!PathHeap_Less(key, subKey, heap->key[parent], heap->subKey[parent]))
+		{
+			break;
+		}
+		heap->index[i] = heap->index[parent];
+		heap->key[i] = heap->key[parent];
+		heap->subKey[i] = heap->subKey[parent];
+		i = parent;
+	}
+	heap->index[i] = index;
+	heap->key[i] = key;
+	heap->subKey[i] = subKey;
+}
+
+/**
+* @fn PathHeap_PopSubKey
+* @brief ヒープから評価値( 同じ場合は第二の評価値 )の一番小さいものを取り出す
+* @param[in] PATHHEAP *heap
+* @param[out] int *index, float *key, float *subKey
+* @return bool true:取り出した  false:空だった
+*/
+bool PathHeap_PopSubKey(PATHHEAP *heap, int *index, float *key, float *subKey)
+{
+	if(heap->num == 0)
+	{
+		return false;
+	}
+
+	*index = heap->index[0];
+	*key = heap->key[0];
+	*subKey = heap->subKey[0];
+
+	// 末尾の要素を先頭に置いて、子より評価値が大きい間は小さい方の子と入れ替える
+	heap->num--;
+	int lastIndex = heap->index[heap->num];
+	float lastKey = heap->key[heap->num];
+	float lastSubKey = heap->subKey[heap->num];
+	int i = 0;
+	for(;;)
+	{
+		int child = i * 2 + 1;
+		if(child >= heap->num)
+		{
+			break;
+		}
+		if(child + 1 < heap->num && PathHeap_Less(heap->key[child + 1], heap->subKey[child + 1], heap->key[child], heap->subKey[child]))
+		{
+			child++;
+		}
+		if(!PathHeap_Less(heap->key[child], heap->subKey[child], lastKey, lastSubKey))
+		{
+			break;
+		}
+		heap->index[i] = heap->index[child];
+		heap->key[i] = heap->key[child];
+		heap->subKey[i] = heap->subKey[child];
+		i = child;
+	}
+	if(heap->num > 0)
+	{
+		heap->index[i] = lastIndex;
+		heap->key[i] = lastKey;
+		heap->subKey[i] = lastSubKey;
+	}
+
+	return true;
+}
+
+/**
+* @fn PathHeap_GetTop
+* @brief ヒープの評価値の一番小さいものの評価値を取得する
+* @param[in] const PATHHEAP *heap
+* @param[out] float *key, float *subKey
+* @return bool true:取得した  false:空だった
+*/
+bool PathHeap_GetTop(const PATHHEAP *heap, float *key, float *subKey)
+{
+	if(heap->num == 0)
+	{
+		return false;
+	}
+
+	*key = heap->key[0];
+	*subKey = heap->subKey[0];
+	return true;
+}
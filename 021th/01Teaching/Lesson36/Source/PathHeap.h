@@ -0,0 +1,24 @@
+﻿#pragma once
+
+/**
+* @struct PATHHEAP
+* @brief 経路探索で次に処理するポリゴンを、評価値の小さい順に取り出す為の二分ヒープ
+* @details 同じ番号を何度追加しても良い( 取り出した側で古い評価値のものを読み飛ばす )
+*/
+struct PATHHEAP
+{
+	int *index;								//!< 番号の配列
+	float *key;								//!< 評価値の配列
+	float *subKey;							//!< 評価値が同じ場合に比べる第二の評価値の配列
+	int num;								//!< 格納している数
+	int maxNum;								//!< 確保している配列の要素数
+};
+
+void PathHeap_Initialize(PATHHEAP *heap, int maxNum);	//!< ヒープの初期化
+void PathHeap_Terminate(PATHHEAP *heap);				//!< ヒープの後始末
+void PathHeap_Clear(PATHHEAP *heap);					//!< ヒープを空にする
+void PathHeap_Push(PATHHEAP *heap, int index, float key);	//!< ヒープに追加する
+bool PathHeap_Pop(PATHHEAP *heap, int *index, float *key);	//!< ヒープから評価値の一番小さいものを取り出す( 戻り値  true:取り出した  false:空だった )
+void PathHeap_PushSubKey(PATHHEAP *heap, int index, float key, float subKey);	//!< 第二の評価値付きでヒープに追加する
+bool PathHeap_PopSubKey(PATHHEAP *heap, int *index, float *key, float *subKey);	//!< ヒープから評価値( 同じ場合は第二の評価値 )の一番小さいものを取り出す( 戻り値  true:取り出した  false:空だった )
+bool PathHeap_GetTop(const PATHHEAP *heap, float *key, float *subKey);	//!< ヒープの評価値の一番小さいものの評価値を取得する( 戻り値  true:取得した  false:空だった )
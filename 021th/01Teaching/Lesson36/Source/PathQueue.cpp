@@ -0,0 +1,127 @@
+﻿#include "PathQueue.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details ロックを使わずに複数のスレッドから出し入れできる固定長のキュー
+*/
+
+/**
+* @fn PathQueue_Initialize
+* @brief キューの初期化
+* @param[in] PATHQUEUE *queue, int dataSize, int capacity
+*/
+void PathQueue_Initialize(PATHQUEUE *queue, int dataSize, int capacity)
+{
+	queue->sequence = (volatile LONG *)malloc(sizeof(LONG) * capacity);
+	queue->data = (BYTE *)malloc(dataSize * capacity);
+	queue->dataSize = dataSize;
+	queue->capacity = capacity;
+	for(int i=0; i<capacity; i++)
+	{
+		queue->sequence[i] = i;
+	}
+	queue->enqueuePos = 0;
+	queue->dequeuePos = 0;
+}
+
+/**
+* @fn PathQueue_Terminate
+* @brief キューの後始末
+* @param[in] PATHQUEUE *queue
+*/
+void PathQueue_Terminate(PATHQUEUE *queue)
+{
+	free((void *)queue->sequence);
+	free(queue->data);
+	queue->sequence = NULL;
+	queue->data = NULL;
+}
+
+/**
+* @fn PathQueue_Push
+* @brief キューに要素を追加する
+* @param[in] PATHQUEUE *queue, const void *item
+* @return bool true:追加した  false:キューが一杯だった
+* @details 書き込む位置を InterlockedCompareExchange で確保してから書き込み、最後に要素の番号を更新して読み出せるようにする
+*/
+bool PathQueue_Push(PATHQUEUE *queue, const void *item)
+{
+	LONG pos = queue->enqueuePos;
+	int slot;
+	for(;;)
+	{
+		slot = pos & (queue->capacity - 1);
+		LONG diff = queue->sequence[slot] - pos;
+		if(diff == 0)
+		{
+			// 空いている要素なので書き込む位置を確保する、他のスレッドに先を越されたらやり直す
+			LONG prevPos = InterlockedCompareExchange(&queue->enqueuePos, pos + 1, pos);
+			if(prevPos == pos)
+			{
+				break;
+			}
+			pos = prevPos;
+		}
+		else if(diff < 0)
+		{
+			// まだ読み出されていない要素なのでキューが一杯
+			return false;
+		}
+		else
+		{
+			pos = queue->enqueuePos;
+		}
+	}
+
+	memcpy(queue->data + slot * queue->dataSize, item, queue->dataSize);
+	MemoryBarrier();
+	queue->sequence[slot] = pos + 1;
+	return true;
+}
+
+/**
+* @fn PathQueue_Pop
+* @brief キューから要素を取り出す
+* @param[in] PATHQUEUE *queue
+* @param[out] void *item
+* @return bool true:取り出した  false:キューが空だった
+*/
+bool PathQueue_Pop(PATHQUEUE *queue, void *item)
+{
+	LONG pos = queue->dequeuePos;
+	int slot;
+	for(;;)
+	{
+		slot = pos & (queue->capacity - 1);
+		LONG diff = queue->sequence[slot] - (pos + 1);
+		if(diff == 0)
+		{
+			// 書き込み済みの要素なので読み出す位置を確保する、他のスレッドに先を越されたらやり直す
+			LONG prevPos = InterlockedCompareExchange(&queue->dequeuePos, pos + 1, pos);
+			if(prevPos == pos)
+			{
+				break;
+			}
+			pos = prevPos;
+		}
+		else if(diff < 0)
+		{
+			// まだ書き込まれていない要素なのでキューが空
+			return false;
+		}
+		else
+		{
+			pos = queue->dequeuePos;
+		}
+	}
+
+	memcpy(item, queue->data + slot * queue->dataSize, queue->dataSize);
+	MemoryBarrier();
+	queue->sequence[slot] = pos + queue->capacity;
+	return true;
+}
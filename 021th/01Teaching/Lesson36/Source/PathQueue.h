@@ -0,0 +1,22 @@
+﻿#pragma once
+#include "DxLib.h"
+
+/**
+* @struct PATHQUEUE
+* @brief ロックを使わずに複数のスレッドから出し入れできる固定長のキュー
+* @details 要素ごとの番号で、書き込み済みか読み出し済みかを判定する
+*/
+struct PATHQUEUE
+{
+	volatile LONG *sequence;				//!< 要素ごとの番号
+	BYTE *data;								//!< 要素のデータ
+	int dataSize;							//!< 要素１つのサイズ
+	int capacity;							//!< 要素の数( ２のべき乗 )
+	volatile LONG enqueuePos;				//!< 次に書き込む位置
+	volatile LONG dequeuePos;				//!< 次に読み出す位置
+};
+
+void PathQueue_Initialize(PATHQUEUE *queue, int dataSize, int capacity);	//!< キューの初期化( capacity は２のべき乗 )
+void PathQueue_Terminate(PATHQUEUE *queue);			//!< キューの後始末
+bool PathQueue_Push(PATHQUEUE *queue, const void *item);	//!< キューに要素を追加する( 戻り値  true:追加した  false:キューが一杯だった )
+bool PathQueue_Pop(PATHQUEUE *queue, void *item);		//!< キューから要素を取り出す( 戻り値  true:取り出した  false:キューが空だった )
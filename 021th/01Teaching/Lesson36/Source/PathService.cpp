@@ -0,0 +1,431 @@
+﻿#include "PathService.h"
+#include "PathFunnel.h"
+#include "PolyLink.h"
+#include "NavTile.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson36
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 経路探索の要求を受け付けて、ワーカースレッド、若しくはメインスレッドの予算時間内で探索するサービス
+*          探索が終わった結果はロックを使わないキューで呼び出し側に返す
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @struct PATHSERVICE
+* @brief 経路探索サービスの情報
+*/
+struct PATHSERVICE
+{
+	int workerNum;							//!< ワーカースレッドの数
+	HANDLE workerThread[PATHSERVICE_MAXWORKER];	//!< ワーカースレッドのハンドル
+	PATHCLUSTER_WORK workerWork[PATHSERVICE_MAXWORKER];	//!< ワーカースレッドごとの階層的経路探索の作業用の情報
+	HANDLE requestSemaphore;				//!< 要求が追加されたことをワーカースレッドに知らせるセマフォ
+	volatile LONG quit;						//!< ワーカースレッドを終了させるかどうか
+	PATHQUEUE requestQueue;					//!< 要求のキュー
+	PATHQUEUE resultQueue;					//!< 結果のキュー
+	PATHSEARCH search;						//!< メインスレッドで進めている探索
+	PATHRESULT searchResult;				//!< メインスレッドで探索した結果
+	int nextTicket;							//!< 次の要求の番号
+	LONGLONG latencyTotal;					//!< 要求してから受け取るまでの時間の合計( マイクロ秒 )
+	LONGLONG stepTime;						//!< メインスレッドで探索を一区切り進めるのに最後に掛かった時間( マイクロ秒 )
+	PATHSERVICE_STATS stats;				//!< 統計情報
+};
+
+static PATHSERVICE pathService;				//!< 経路探索サービスの実体
+
+/**
+* @fn PathService_SetupResult
+* @brief 経路上のポリゴンの列が求まった結果に中間地点を設定する
+* @param[in] const PATHREQUEST *request
+* @param[out] PATHRESULT *result
+* @details 途中までの経路の場合は、最後のポリゴンの中心を最後の中間地点にする
+*/
+static void PathService_SetupResult(const PATHREQUEST *request, PATHRESULT *result)
+{
+	VECTOR goalPosition = request->goalPosition;
+	if(result->truncated)
+	{
+		goalPosition = polyLinkInfo[result->pathPolyIndex[result->pathPolyNum - 1]].centerPosition;
+	}
+	result->wayPointNum = PathFunnel_Build(result->pathPolyIndex, result->pathPolyNum,
+		request->startPosition, goalPosition, request->radius * 2.0f,
+		result->wayPoint, PATHSERVICE_MAXWAYPOINT);
+	result->success = true;
+}
+
+/**
+* @fn PathService_InitializeResult
+* @brief 結果を経路が見つからなかった状態で初期化する
+* @param[in] const PATHREQUEST *request
+* @param[out] PATHRESULT *result
+*/
+static void PathService_InitializeResult(const PATHREQUEST *request, PATHRESULT *result)
+{
+	result->ticket = request->ticket;
+	result->success = false;
+	result->truncated = false;
+	result->startPosition = request->startPosition;
+	result->goalPosition = request->goalPosition;
+	result->pathPolyNum = 0;
+	result->wayPointNum = 0;
+	result->submitTime = request->submitTime;
+	result->latency = 0;
+	result->navSerial = request->navSerial;
+}
+
+/**
+* @fn PathService_Execute
+* @brief 要求を最後まで探索する( ワーカースレッド用 )
+* @param[in] PATHCLUSTER_WORK *work, const PATHREQUEST *request
+* @param[out] PATHRESULT *result
+*/
+static void PathService_Execute(PATHCLUSTER_WORK *work, const PATHREQUEST *request, PATHRESULT *result)
+{
+	PathService_InitializeResult(request, result);
+
+	int startPolyIndex = CheckOnPolyIndex(request->startPosition);
+	int goalPolyIndex = CheckOnPolyIndex(request->goalPosition);
+	if(startPolyIndex == -1 || goalPolyIndex == -1)
+	{
+		return;
+	}
+
+	// 同じポリゴンの場合はそのポリゴンだけの経路
+	if(startPolyIndex == goalPolyIndex)
+	{
+		result->pathPolyIndex[0] = startPolyIndex;
+		result->pathPolyNum = 1;
+	}
+	else if(PathCluster_FindPath(work, startPolyIndex, goalPolyIndex, result->pathPolyIndex, PATHSERVICE_MAXPATHPOLY, &result->pathPolyNum, &result->truncated) == false)
+	{
+		return;
+	}
+
+	PathService_SetupResult(request, result);
+}
+
+/**
+* @fn PathService_WorkerThread
+* @brief ワーカースレッド、要求が来るのを待って探索し、結果をキューに追加する
+* @param[in] LPVOID param ワーカースレッドの番号
+* @return DWORD 0
+*/
+static DWORD WINAPI PathService_WorkerThread(LPVOID param)
+{
+	int workerIndex = (int)(INT_PTR)param;
+	PATHREQUEST request;
+
+	// 結果は大きいのでスタックではなくヒープに確保する
+	PATHRESULT *result = (PATHRESULT *)malloc(sizeof(PATHRESULT));
+
+	for(;;)
+	{
+		// 要求が来るまで待つ
+		WaitForSingleObject(pathService.requestSemaphore, INFINITE);
+		if(pathService.quit)
+		{
+			break;
+		}
+
+		if(PathQueue_Pop(&pathService.requestQueue, &request) == false)
+		{
+			continue;
+		}
+
+		PathService_Execute(&pathService.workerWork[workerIndex], &request, result);
+
+		// 結果のキューが一杯の場合は空くまで待つ
+		while(PathQueue_Push(&pathService.resultQueue, result) == false)
+		{
+			if(pathService.quit)
+			{
+				break;
+			}
+			Sleep(1);
+		}
+	}
+
+	free(result);
+	return 0;
+}
+
+/**
+* @fn PathService_Initialize
+* @brief 経路探索サービスの初期化
+* @param[in] int workerNum ワーカースレッドの数( 0 の場合はメインスレッドで PathService_Process を呼んで探索する )
+* @details ポリゴン同士の連結情報と階層的経路探索用のクラスタは構築済みであること、
+*          ワーカースレッドの動作中は連結情報を変更しないこと( クラスタの作り直しは PathCluster_Refresh が探索の終了を待つ )
+*/
+void PathService_Initialize(int workerNum)
+{
+	if(workerNum > PATHSERVICE_MAXWORKER)
+	{
+		workerNum = PATHSERVICE_MAXWORKER;
+	}
+
+	PathQueue_Initialize(&pathService.requestQueue, sizeof(PATHREQUEST), PATHSERVICE_QUEUESIZE);
+	PathQueue_Initialize(&pathService.resultQueue, sizeof(PATHRESULT), PATHSERVICE_QUEUESIZE);
+	pathService.nextTicket = 0;
+	pathService.latencyTotal = 0;
+	pathService.stepTime = 0;
+	memset(&pathService.stats, 0, sizeof(pathService.stats));
+
+	// メインスレッドで探索する為の情報の初期化
+	PATHSEARCH *search = &pathService.search;
+	search->active = false;
+	search->resultPending = false;
+	PathCluster_InitializeWork(&search->work);
+
+	// ワーカースレッドを起動する
+	pathService.quit = 0;
+	pathService.workerNum = workerNum;
+	pathService.requestSemaphore = CreateSemaphore(NULL, 0, PATHSERVICE_QUEUESIZE + PATHSERVICE_MAXWORKER, NULL);
+	for(int i=0; i<workerNum; i++)
+	{
+		PathCluster_InitializeWork(&pathService.workerWork[i]);
+		pathService.workerThread[i] = CreateThread(NULL, 0, PathService_WorkerThread, (LPVOID)(INT_PTR)i, 0, NULL);
+	}
+}
+
+/**
+* @fn PathService_Terminate
+* @brief 経路探索サービスの後始末
+*/
+void PathService_Terminate()
+{
+	// ワーカースレッドに終了を知らせて、終了するまで待つ
+	InterlockedExchange(&pathService.quit, 1);
+	if(pathService.workerNum > 0)
+	{
+		ReleaseSemaphore(pathService.requestSemaphore, pathService.workerNum, NULL);
+	}
+	for(int i=0; i<pathService.workerNum; i++)
+	{
+		WaitForSingleObject(pathService.workerThread[i], INFINITE);
+		CloseHandle(pathService.workerThread[i]);
+		PathCluster_TerminateWork(&pathService.workerWork[i]);
+	}
+	pathService.workerNum = 0;
+	CloseHandle(pathService.requestSemaphore);
+
+	PATHSEARCH *search = &pathService.search;
+	search->active = false;
+	PathCluster_TerminateWork(&search->work);
+
+	PathQueue_Terminate(&pathService.requestQueue);
+	PathQueue_Terminate(&pathService.resultQueue);
+}
+
+/**
+* @fn PathService_Submit
+* @brief 経路探索を要求する
+* @param[in] VECTOR startPos, VECTOR goalPos, float radius
+* @return int 要求の番号、キューが一杯の場合は -1
+*/
+int PathService_Submit(VECTOR startPos, VECTOR goalPos, float radius)
+{
+	PATHREQUEST request;
+	request.ticket = pathService.nextTicket;
+	request.startPosition = startPos;
+	request.goalPosition = goalPos;
+	request.radius = radius;
+	request.submitTime = GetNowHiPerformanceCount();
+	request.navSerial = NavTile_GetSerial();
+
+	if(PathQueue_Push(&pathService.requestQueue, &request) == false)
+	{
+		return -1;
+	}
+	pathService.nextTicket++;
+	pathService.stats.submitNum++;
+
+	// ワーカースレッドに要求が追加されたことを知らせる
+	if(pathService.workerNum > 0)
+	{
+		ReleaseSemaphore(pathService.requestSemaphore, 1, NULL);
+	}
+
+	return request.ticket;
+}
+
+/**
+* @fn PathService_BeginSearch
+* @brief メインスレッドで進める探索を開始する
+* @param[in] const PATHREQUEST *request
+* @return bool true:探索を開始した  false:探索するまでもなく結果が決まった( searchResult に設定済み )
+* @details ワーカースレッドと同じ階層的経路探索を、上位の探索のノード数で区切って少しずつ進める
+*/
+static bool PathService_BeginSearch(const PATHREQUEST *request)
+{
+	PATHSEARCH *search = &pathService.search;
+	PATHRESULT *result = &pathService.searchResult;
+
+	PathService_InitializeResult(request, result);
+	search->request = *request;
+	int startPolyIndex = CheckOnPolyIndex(request->startPosition);
+	int goalPolyIndex = CheckOnPolyIndex(request->goalPosition);
+	if(startPolyIndex == -1 || goalPolyIndex == -1)
+	{
+		return false;
+	}
+
+	// 同じポリゴンの場合はそのポリゴンだけの経路
+	if(startPolyIndex == goalPolyIndex)
+	{
+		result->pathPolyIndex[0] = startPolyIndex;
+		result->pathPolyNum = 1;
+		PathService_SetupResult(request, result);
+		return false;
+	}
+
+	PathCluster_BeginSearch(&search->work, startPolyIndex, goalPolyIndex);
+	search->active = true;
+	return true;
+}
+
+/**
+* @fn PathService_EndSearch
+* @brief ゴールに辿り着いた探索の経路を結果に設定する
+*/
+static void PathService_EndSearch()
+{
+	PATHSEARCH *search = &pathService.search;
+	PATHRESULT *result = &pathService.searchResult;
+
+	if(PathCluster_EndSearch(&search->work, result->pathPolyIndex, PATHSERVICE_MAXPATHPOLY, &result->pathPolyNum, &result->truncated) == false)
+	{
+		return;
+	}
+
+	PathService_SetupResult(&search->request, result);
+}
+
+/**
+* @fn PathService_Process
+* @brief メインスレッドで探索する場合に、予算時間の範囲で探索を進める
+* @param[in] int budgetMicroSec １フレームで探索に使って良い時間( マイクロ秒 )
+* @details 探索は上位の探索の PATHSERVICE_SEARCHSTEP ノードごとに経過時間を確認して、次の一区切りが予算に収まらなければ次のフレームに続きを行う
+*          一区切りの時間は前回の一区切りに掛かった時間で見積もり、見積もりが外れて予算を超えたフレームだけを超過として数える
+*          ワーカースレッドを使用している場合は何もしない
+*/
+void PathService_Process(int budgetMicroSec)
+{
+	if(pathService.workerNum > 0)
+	{
+		return;
+	}
+
+	PATHSEARCH *search = &pathService.search;
+	LONGLONG startTime = GetNowHiPerformanceCount();
+	LONGLONG elapsedTime = 0;
+	bool stepped = false;
+	PATHREQUEST request;
+
+	for(;;)
+	{
+		// 予算時間を使い切ったか、次の一区切りが予算に収まらなければ続きは次のフレーム( 最初の一区切りは必ず進める )
+		elapsedTime = GetNowHiPerformanceCount() - startTime;
+		if(elapsedTime >= budgetMicroSec || (stepped && elapsedTime + pathService.stepTime > budgetMicroSec))
+		{
+			break;
+		}
+
+		// キューが一杯で追加できていない結果があれば先に追加する
+		if(search->resultPending)
+		{
+			if(PathQueue_Push(&pathService.resultQueue, &pathService.searchResult) == false)
+			{
+				break;
+			}
+			search->resultPending = false;
+		}
+
+		// 探索中で無ければ次の要求を取り出して探索を開始する
+		if(search->active == false)
+		{
+			if(PathQueue_Pop(&pathService.requestQueue, &request) == false)
+			{
+				break;
+			}
+			if(PathService_BeginSearch(&request) == false)
+			{
+				search->resultPending = true;
+				continue;
+			}
+		}
+
+		// 探索を少し進めて、終わったら結果を追加する
+		LONGLONG stepStartTime = GetNowHiPerformanceCount();
+		int state = PathCluster_StepSearch(&search->work, PATHSERVICE_SEARCHSTEP);
+		if(state != 0)
+		{
+			if(state == 1)
+			{
+				PathService_EndSearch();
+			}
+			search->active = false;
+			search->resultPending = true;
+		}
+		pathService.stepTime = GetNowHiPerformanceCount() - stepStartTime;
+		stepped = true;
+	}
+
+	// 予算に収まる見込みで進めた一区切りで予算時間を超えた場合だけ記録しておく
+	elapsedTime = GetNowHiPerformanceCount() - startTime;
+	if(elapsedTime > budgetMicroSec)
+	{
+		pathService.stats.budgetOverrunNum++;
+	}
+}
+
+/**
+* @fn PathService_PollResult
+* @brief 探索が終わった結果を一つ受け取る
+* @param[out] PATHRESULT *result
+* @return bool true:受け取った  false:結果が無かった
+*/
+bool PathService_PollResult(PATHRESULT *result)
+{
+	if(PathQueue_Pop(&pathService.resultQueue, result) == false)
+	{
+		return false;
+	}
+
+	// 要求してから受け取るまでの時間を記録する
+	result->latency = GetNowHiPerformanceCount() - result->submitTime;
+	pathService.latencyTotal += result->latency;
+	pathService.stats.completeNum++;
+	if(result->success == false)
+	{
+		pathService.stats.failNum++;
+	}
+	if(result->truncated)
+	{
+		pathService.stats.truncateNum++;
+		ErrorLogFmtAdd("pathservice: ticket %d path exceeds %d polygons, returned the first part", result->ticket, PATHSERVICE_MAXPATHPOLY);
+	}
+	if(result->latency > pathService.stats.latencyMax)
+	{
+		pathService.stats.latencyMax = result->latency;
+	}
+	pathService.stats.latencyAverage = pathService.latencyTotal / pathService.stats.completeNum;
+
+	return true;
+}
+
+/**
+* @fn PathService_GetStats
+* @brief 統計情報を取得する
+* @param[out] PATHSERVICE_STATS *stats
+*/
+void PathService_GetStats(PATHSERVICE_STATS *stats)
+{
+	pathService.stats.requestQueueDepth = pathService.requestQueue.enqueuePos - pathService.requestQueue.dequeuePos;
+	pathService.stats.resultQueueDepth = pathService.resultQueue.enqueuePos - pathService.resultQueue.dequeuePos;
+	*stats = pathService.stats;
+}
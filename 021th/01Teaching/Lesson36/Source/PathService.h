@@ -0,0 +1,80 @@
+﻿#pragma once
+#include "DxLib.h"
+#include "PathCluster.h"
+#include "PathQueue.h"
+
+const int PATHSERVICE_MAXPATHPOLY = 512;						//!< １つの経路に含められるポリゴンの最大数
+const int PATHSERVICE_MAXWAYPOINT = PATHSERVICE_MAXPATHPOLY + 1;	//!< １つの経路に含められる中間地点の最大数
+const int PATHSERVICE_QUEUESIZE = 64;							//!< 要求と結果のキューの大きさ( ２のべき乗 )
+const int PATHSERVICE_MAXWORKER = 8;							//!< ワーカースレッドの最大数
+const int PATHSERVICE_SEARCHSTEP = 32;							//!< メインスレッドで探索する時に経過時間を確認する間隔( 上位の探索で処理するノード数 )
+
+/**
+* @struct PATHREQUEST
+* @brief 経路探索の要求
+*/
+struct PATHREQUEST
+{
+	int ticket;								//!< 要求の番号
+	VECTOR startPosition;					//!< 開始位置
+	VECTOR goalPosition;					//!< 目標位置
+	float radius;							//!< 移動するものの半径
+	LONGLONG submitTime;					//!< 要求した時刻( マイクロ秒 )
+	int navSerial;							//!< 要求した時点のタイルの切り替えの通し番号
+};
+
+/**
+* @struct PATHRESULT
+* @brief 経路探索の結果
+*/
+struct PATHRESULT
+{
+	int ticket;								//!< 要求の番号
+	bool success;							//!< 経路が見つかったかどうか
+	bool truncated;							//!< 経路が PATHSERVICE_MAXPATHPOLY に収まらなかったので途中までの経路かどうか( 最後の中間地点は途中のポリゴンの中心 )
+	VECTOR startPosition;					//!< 開始位置
+	VECTOR goalPosition;					//!< 目標位置
+	int pathPolyNum;						//!< 経路上のポリゴンの数
+	int pathPolyIndex[PATHSERVICE_MAXPATHPOLY];	//!< 経路上のポリゴン番号( スタートからゴールの順 )
+	int wayPointNum;						//!< 中間地点の数
+	VECTOR wayPoint[PATHSERVICE_MAXWAYPOINT];	//!< 中間地点( 最後はゴール位置 )
+	LONGLONG submitTime;					//!< 要求した時刻( マイクロ秒 )
+	LONGLONG latency;						//!< 要求してから受け取るまでの時間( マイクロ秒 )
+	int navSerial;							//!< 要求した時点のタイルの切り替えの通し番号( NavTile_CheckPath で経路が有効か確認する )
+};
+
+/**
+* @struct PATHSEARCH
+* @brief メインスレッドで少しずつ進める経路探索の状態
+*/
+struct PATHSEARCH
+{
+	bool active;							//!< 探索中かどうか
+	bool resultPending;						//!< 結果のキューが一杯で追加できていない結果があるかどうか
+	PATHREQUEST request;					//!< 探索中の要求
+	PATHCLUSTER_WORK work;					//!< 階層的経路探索の作業用の情報( ワーカースレッドと同じ探索を少しずつ進める )
+};
+
+/**
+* @struct PATHSERVICE_STATS
+* @brief 経路探索サービスの統計情報
+*/
+struct PATHSERVICE_STATS
+{
+	int requestQueueDepth;					//!< 探索を待っている要求の数
+	int resultQueueDepth;					//!< 受け取られるのを待っている結果の数
+	int submitNum;							//!< これまでに受け付けた要求の数
+	int completeNum;						//!< これまでに受け取った結果の数
+	int failNum;							//!< これまでに受け取った結果のうち経路が見つからなかった数
+	int truncateNum;						//!< これまでに受け取った結果のうち途中までの経路だった数
+	LONGLONG latencyAverage;				//!< 要求してから受け取るまでの平均時間( マイクロ秒 )
+	LONGLONG latencyMax;					//!< 要求してから受け取るまでの最大時間( マイクロ秒 )
+	int budgetOverrunNum;					//!< メインスレッドでの探索が１フレームの予算時間を超えた回数
+};
+
+void PathService_Initialize(int workerNum);	//!< 経路探索サービスの初期化( workerNum が 0 の場合はメインスレッドで探索する )
+void PathService_Terminate(void);			//!< 経路探索サービスの後始末
+int PathService_Submit(VECTOR startPos, VECTOR goalPos, float radius);	//!< 経路探索を要求する( 戻り値 : 要求の番号、キューが一杯の場合は -1 )
+void PathService_Process(int budgetMicroSec);	//!< メインスレッドで探索する場合に、予算時間の範囲で探索を進める
+bool PathService_PollResult(PATHRESULT *result);	//!< 探索が終わった結果を一つ受け取る( 戻り値  true:受け取った  false:結果が無かった )
+void PathService_GetStats(PATHSERVICE_STATS *stats);	//!< 統計情報を取得する
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include "DxLib.h"
+
+/**
+* @struct POLYLINKINFO
+* @brief ポリゴン同士の連結情報を保存する為の構造体
+*/
+struct POLYLINKINFO
+{
+	int linkPolyIndex[3];					//!< ポリゴンの三つの辺とそれぞれ隣接しているポリゴンのポリゴン番号( -1：隣接ポリゴン無し  -1以外：ポリゴン番号 )
+	float linkPolyDistance[3];				//!< 隣接しているポリゴンとの距離
+	VECTOR centerPosition;					//!< ポリゴンの中心座標
+};
+
+/**
+* @struct POLYGRID
+* @brief ポリゴンをＸＺ平面上の格子に登録して、指定座標のポリゴンを高速に検索する為の構造体
+*/
+struct POLYGRID
+{
+	float minX;								//!< 格子の左端のＸ座標
+	float minZ;								//!< 格子の手前端のＺ座標
+	float cellSize;							//!< 格子の１マスのサイズ
+	int cellNumX;							//!< Ｘ軸方向のマスの数
+	int cellNumZ;							//!< Ｚ軸方向のマスの数
+	int *cellStart;							//!< 各マスに登録されたポリゴン番号が cellPolyIndex の何番目から始まるかの配列( マスの数 + 1 個 )
+	int *cellPolyIndex;						//!< 全マスに登録されたポリゴン番号をマスの順番に並べた配列
+};
+
+extern MV1_REF_POLYGONLIST polyList;			//!< ステージモデルのポリゴン情報
+extern POLYLINKINFO *polyLinkInfo;				//!< ステージモデルの全ポリゴン分の「ポリゴン同士の連結情報」の配列
+extern POLYGRID polyGrid;						//!< ポリゴン検索用の格子
+
+int CheckOnPolyIndex(VECTOR Pos);				//!< 指定の座標の直下、若しくは直上にあるポリゴンの番号を取得する( ポリゴンが無かった場合は -1 を返す )
+int CheckOnPolyIndexNear(VECTOR Pos, int prevPolyIndex);	//!< 前回乗っていたポリゴンとその隣接ポリゴンから優先して、指定の座標の直下、若しくは直上にあるポリゴンの番号を取得する
+bool CheckPolyContainXZ(int polyIndex, VECTOR Pos);	//!< 指定のポリゴンをＸＺ平面に投影した三角形の中に指定の座標が含まれるかどうかをチェックする
@@ -0,0 +1,492 @@
+﻿#include "DebugDraw.h"
+#include <math.h>
+/**
+* @file
+* @brief Mission04
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 当たり判定や格子などの確認用の図形をためておき、まとめて描画する
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+
+const int SHELL_DIV = 8;		//!< 球とカプセルの経度方向の分割数
+const int SHELL_ROW = 6;		//!< 球とカプセルの緯度方向の頂点の列の数( 南極、-45度、赤道( 下 )、赤道( 上 )、45度、北極 )
+const float SHELL_ROW_SIN[SHELL_ROW] = { -1.0f, -0.70710678f, 0.0f, 0.0f, 0.70710678f, 1.0f };	//!< 頂点の列ごとの緯度の sin
+const float SHELL_ROW_COS[SHELL_ROW] = { 0.0f, 0.70710678f, 1.0f, 1.0f, 0.70710678f, 0.0f };	//!< 頂点の列ごとの緯度の cos
+
+
+/**
+* @fn DebugDraw::DebugDraw
+* @brief コンストラクタ
+* @param[in] int lineMax ためられる線の最大数, int triangleMax ためられる三角形の最大数
+*/
+DebugDraw::DebugDraw(int lineMax, int triangleMax)
+{
+	m_lineMax = lineMax;
+	m_lineNum = 0;
+	m_line = new VERTEX3D[lineMax * 2];
+	m_triangleMax = triangleMax;
+	m_triangleNum = 0;
+	m_triangle = new VERTEX3D[triangleMax * 3];
+	m_static = false;
+	m_staticLineBuffer = -1;
+	m_staticTriangleBuffer = -1;
+	m_staticLineNum = 0;
+	m_staticTriangleNum = 0;
+	m_drawCallNum = 0;
+	m_drawLineNum = 0;
+	m_drawTriangleNum = 0;
+	m_lastDrawCallNum = 0;
+	m_lastDrawLineNum = 0;
+	m_lastDrawTriangleNum = 0;
+
+	// 球の経度ごとの向きは変わらないので先に求めておく
+	m_lonCos = new float[SHELL_DIV];
+	m_lonSin = new float[SHELL_DIV];
+	for(int i=0; i<SHELL_DIV; i++)
+	{
+		m_lonCos[i] = cosf(DX_PI_F * 2.0f * i / SHELL_DIV);
+		m_lonSin[i] = sinf(DX_PI_F * 2.0f * i / SHELL_DIV);
+	}
+}
+
+/**
+* @fn DebugDraw::~DebugDraw
+* @brief デストラクタ
+*/
+DebugDraw::~DebugDraw()
+{
+	Terminate();
+	delete[] m_line;
+	delete[] m_triangle;
+	delete[] m_lonCos;
+	delete[] m_lonSin;
+}
+
+/**
+* @fn DebugDraw::Terminate
+* @brief 変わらない図形の頂点バッファを解放する
+* @details DxLib_End の後では解放できないので、DxLib_End の前に呼ぶ( 変わらない図形は無くなる )
+*/
+void DebugDraw::Terminate()
+{
+	if(m_staticLineBuffer != -1)
+	{
+		DeleteVertexBuffer(m_staticLineBuffer);
+		m_staticLineBuffer = -1;
+	}
+	if(m_staticTriangleBuffer != -1)
+	{
+		DeleteVertexBuffer(m_staticTriangleBuffer);
+		m_staticTriangleBuffer = -1;
+	}
+	m_staticLineNum = 0;
+	m_staticTriangleNum = 0;
+}
+
+/**
+* @fn DebugDraw::ReserveLine
+* @brief 線を num 本ためられるようにする
+* @param[in] int num
+* @return bool true:ためられる  false:あふれる
+* @details 一杯の時はそこまでの図形を先に描画して空ける( 変わらない図形を覚えている間は空けられない )
+*/
+bool DebugDraw::ReserveLine(int num)
+{
+	if(m_lineNum + num <= m_lineMax)
+	{
+		return true;
+	}
+	if(m_static || num > m_lineMax)
+	{
+		return false;
+	}
+	FlushDynamic();
+	return true;
+}
+
+/**
+* @fn DebugDraw::ReserveTriangle
+* @brief 三角形を num 枚ためられるようにする
+* @param[in] int num
+* @return bool true:ためられる  false:あふれる
+* @details 一杯の時はそこまでの図形を先に描画して空ける( 変わらない図形を覚えている間は空けられない )
+*/
+bool DebugDraw::ReserveTriangle(int num)
+{
+	if(m_triangleNum + num <= m_triangleMax)
+	{
+		return true;
+	}
+	if(m_static || num > m_triangleMax)
+	{
+		return false;
+	}
+	FlushDynamic();
+	return true;
+}
+
+/**
+* @fn DebugDraw::AddLine
+* @brief 線を追加する
+* @param[in] VECTOR p1, VECTOR p2, COLOR_U8 color
+*/
+void DebugDraw::AddLine(VECTOR p1, VECTOR p2, COLOR_U8 color)
+{
+	if(!ReserveLine(1))
+	{
+		return;
+	}
+	VERTEX3D *v = &m_line[m_lineNum * 2];
+	v[0].pos = p1;
+	v[1].pos = p2;
+	for(int i=0; i<2; i++)
+	{
+		v[i].norm = VGet(0.0f, 1.0f, 0.0f);
+		v[i].dif = color;
+		v[i].spc = GetColorU8(0, 0, 0, 0);
+		v[i].u = 0.0f;
+		v[i].v = 0.0f;
+		v[i].su = 0.0f;
+		v[i].sv = 0.0f;
+	}
+	m_lineNum++;
+}
+
+/**
+* @fn DebugDraw::AddTriangle
+* @brief 三角形を追加する
+* @param[in] VECTOR p1, VECTOR p2, VECTOR p3, COLOR_U8 color, bool fill false:輪郭の線だけ
+*/
+void DebugDraw::AddTriangle(VECTOR p1, VECTOR p2, VECTOR p3, COLOR_U8 color, bool fill)
+{
+	if(!fill)
+	{
+		AddLine(p1, p2, color);
+		AddLine(p2, p3, color);
+		AddLine(p3, p1, color);
+		return;
+	}
+	if(!ReserveTriangle(1))
+	{
+		return;
+	}
+
+	// 法線は辺の外積から求める( 潰れた三角形は上向きにする )
+	VECTOR normal = VCross(VSub(p2, p1), VSub(p3, p1));
+	float length = VSize(normal);
+	normal = length > 0.0f ? VScale(normal, 1.0f / length) : VGet(0.0f, 1.0f, 0.0f);
+
+	VERTEX3D *v = &m_triangle[m_triangleNum * 3];
+	v[0].pos = p1;
+	v[1].pos = p2;
+	v[2].pos = p3;
+	for(int i=0; i<3; i++)
+	{
+		v[i].norm = normal;
+		v[i].dif = color;
+		v[i].spc = GetColorU8(0, 0, 0, 0);
+		v[i].u = 0.0f;
+		v[i].v = 0.0f;
+		v[i].su = 0.0f;
+		v[i].sv = 0.0f;
+	}
+	m_triangleNum++;
+}
+
+/**
+* @fn DebugDraw::AddShell
+* @brief 線分の両端に半球をつけた形を追加する
+* @param[in] VECTOR p1 下の半球の中心, VECTOR p2 上の半球の中心, float r 半径, COLOR_U8 color, bool fill false:線で組んだ形
+* @details 経度 SHELL_DIV 本、緯度 SHELL_ROW 列の格子を作り、線なら緯線と経線、面なら格子の四角形を三角形２枚ずつで追加する
+*          p1 と p2 が同じ場所なら球になるので、重なる赤道の２列の間は追加しない
+*/
+void DebugDraw::AddShell(VECTOR p1, VECTOR p2, float r, COLOR_U8 color, bool fill)
+{
+	// 線分の向きを軸にして、それに垂直な２本の向きを求める
+	VECTOR axis = VSub(p2, p1);
+	float length = VSize(axis);
+	bool sphere = length <= 0.0f;
+	axis = sphere ? VGet(0.0f, 1.0f, 0.0f) : VScale(axis, 1.0f / length);
+	VECTOR side1 = VNorm(VCross(axis, fabsf(axis.x) < 0.9f ? VGet(1.0f, 0.0f, 0.0f) : VGet(0.0f, 1.0f, 0.0f)));
+	VECTOR side2 = VCross(axis, side1);
+
+	// 格子の頂点の向き( 長さ１ )を求める
+	VECTOR direction[SHELL_ROW][SHELL_DIV];
+	for(int row=0; row<SHELL_ROW; row++)
+	{
+		for(int i=0; i<SHELL_DIV; i++)
+		{
+			VECTOR around = VAdd(VScale(side1, m_lonCos[i]), VScale(side2, m_lonSin[i]));
+			direction[row][i] = VAdd(VScale(around, SHELL_ROW_COS[row]), VScale(axis, SHELL_ROW_SIN[row]));
+		}
+	}
+
+	// 赤道の下側の列までは p1、上側の列からは p2 を中心にする
+	int bandNum = SHELL_ROW - 1;
+	if(!fill)
+	{
+		int lineNum = (SHELL_ROW - 2 - (sphere ? 1 : 0)) * SHELL_DIV + (bandNum - (sphere ? 1 : 0)) * SHELL_DIV;
+		if(!ReserveLine(lineNum))
+		{
+			return;
+		}
+
+		// 緯線( 極は点なので除く )
+		for(int row=1; row<SHELL_ROW-1; row++)
+		{
+			if(sphere && row == SHELL_ROW / 2)
+			{
+				continue;
+			}
+			VECTOR center = row < SHELL_ROW / 2 ? p1 : p2;
+			for(int i=0; i<SHELL_DIV; i++)
+			{
+				int next = (i + 1) % SHELL_DIV;
+				AddLine(VAdd(center, VScale(direction[row][i], r)), VAdd(center, VScale(direction[row][next], r)), color);
+			}
+		}
+
+		// 経線
+		for(int band=0; band<bandNum; band++)
+		{
+			if(sphere && band == SHELL_ROW / 2 - 1)
+			{
+				continue;
+			}
+			VECTOR center1 = band < SHELL_ROW / 2 ? p1 : p2;
+			VECTOR center2 = band + 1 < SHELL_ROW / 2 ? p1 : p2;
+			for(int i=0; i<SHELL_DIV; i++)
+			{
+				AddLine(VAdd(center1, VScale(direction[band][i], r)), VAdd(center2, VScale(direction[band + 1][i], r)), color);
+			}
+		}
+		return;
+	}
+
+	// 極につながる帯は三角形１枚、それ以外は２枚ずつ
+	int triangleNum = (bandNum - 2 - (sphere ? 1 : 0)) * SHELL_DIV * 2 + SHELL_DIV * 2;
+	if(!ReserveTriangle(triangleNum))
+	{
+		return;
+	}
+	for(int band=0; band<bandNum; band++)
+	{
+		if(sphere && band == SHELL_ROW / 2 - 1)
+		{
+			continue;
+		}
+		VECTOR center1 = band < SHELL_ROW / 2 ? p1 : p2;
+		VECTOR center2 = band + 1 < SHELL_ROW / 2 ? p1 : p2;
+		for(int i=0; i<SHELL_DIV; i++)
+		{
+			int next = (i + 1) % SHELL_DIV;
+			VERTEX3D *v = &m_triangle[m_triangleNum * 3];
+			VECTOR d[4] = { direction[band][i], direction[band][next], direction[band + 1][i], direction[band + 1][next] };
+			VECTOR c[4] = { center1, center1, center2, center2 };
+			static const int order[2][3] = { { 0, 2, 1 }, { 1, 2, 3 } };
+			for(int t=0; t<2; t++)
+			{
+				// 極の列は全て同じ点なので、潰れる方の三角形は追加しない
+				if((band == 0 && t == 0) || (band == bandNum - 1 && t == 1))
+				{
+					continue;
+				}
+				for(int k=0; k<3; k++)
+				{
+					int n = order[t][k];
+					v->pos = VAdd(c[n], VScale(d[n], r));
+					v->norm = d[n];
+					v->dif = color;
+					v->spc = GetColorU8(0, 0, 0, 0);
+					v->u = 0.0f;
+					v->v = 0.0f;
+					v->su = 0.0f;
+					v->sv = 0.0f;
+					v++;
+				}
+				m_triangleNum++;
+			}
+		}
+	}
+}
+
+/**
+* @fn DebugDraw::AddSphere
+* @brief 球を追加する
+* @param[in] VECTOR center, float r, COLOR_U8 color, bool fill false:線で組んだ形
+*/
+void DebugDraw::AddSphere(VECTOR center, float r, COLOR_U8 color, bool fill)
+{
+	AddShell(center, center, r, color, fill);
+}
+
+/**
+* @fn DebugDraw::AddCapsule
+* @brief カプセルを追加する
+* @param[in] VECTOR p1, VECTOR p2 両端の球の中心, float r, COLOR_U8 color, bool fill false:線で組んだ形
+*/
+void DebugDraw::AddCapsule(VECTOR p1, VECTOR p2, float r, COLOR_U8 color, bool fill)
+{
+	AddShell(p1, p2, r, color, fill);
+}
+
+/**
+* @fn DebugDraw::BeginStatic
+* @brief ここから EndStatic までに追加した図形を変わらない図形として覚える
+* @details それまでにためていた図形は先に描画しておく
+*/
+void DebugDraw::BeginStatic()
+{
+	FlushDynamic();
+	m_static = true;
+}
+
+/**
+* @fn DebugDraw::EndStatic
+* @brief 追加した図形を頂点バッファに入れる
+* @details 前に覚えた図形は捨てて、今回追加した図形に置き換える
+*/
+void DebugDraw::EndStatic()
+{
+	if(m_staticLineBuffer != -1)
+	{
+		DeleteVertexBuffer(m_staticLineBuffer);
+		m_staticLineBuffer = -1;
+	}
+	if(m_staticTriangleBuffer != -1)
+	{
+		DeleteVertexBuffer(m_staticTriangleBuffer);
+		m_staticTriangleBuffer = -1;
+	}
+
+	m_staticLineNum = m_lineNum;
+	if(m_lineNum > 0)
+	{
+		m_staticLineBuffer = CreateVertexBuffer(m_lineNum * 2, DX_VERTEX_TYPE_NORMAL_3D);
+		SetVertexBufferData(0, m_line, m_lineNum * 2, m_staticLineBuffer);
+	}
+	m_staticTriangleNum = m_triangleNum;
+	if(m_triangleNum > 0)
+	{
+		m_staticTriangleBuffer = CreateVertexBuffer(m_triangleNum * 3, DX_VERTEX_TYPE_NORMAL_3D);
+		SetVertexBufferData(0, m_triangle, m_triangleNum * 3, m_staticTriangleBuffer);
+	}
+
+	m_lineNum = 0;
+	m_triangleNum = 0;
+	m_static = false;
+}
+
+/**
+* @fn DebugDraw::FlushDynamic
+* @brief ためている図形を描画して空にする
+* @details 線はライティングをせずに、三角形は法線でライティングをして描画する
+*          色のアルファ値で半透明にする、ブレンドモードとライティングは呼び出し前の設定に戻す
+*/
+void DebugDraw::FlushDynamic()
+{
+	if(m_lineNum == 0 && m_triangleNum == 0)
+	{
+		return;
+	}
+
+	// 呼び出し側の描画の設定を覚えておき、描画後に戻す
+	int blendMode;
+	int blendParam;
+	GetDrawBlendMode(&blendMode, &blendParam);
+	int useLighting = GetUseLighting();
+	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
+	if(m_lineNum > 0)
+	{
+		SetUseLighting(false);
+		DrawPrimitive3D(m_line, m_lineNum * 2, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPHIC, true);
+		m_drawCallNum++;
+		m_drawLineNum += m_lineNum;
+	}
+	if(m_triangleNum > 0)
+	{
+		SetUseLighting(true);
+		DrawPrimitive3D(m_triangle, m_triangleNum * 3, DX_PRIMTYPE_TRIANGLELIST, DX_NONE_GRAPHIC, true);
+		m_drawCallNum++;
+		m_drawTriangleNum += m_triangleNum;
+	}
+	SetUseLighting(useLighting);
+	SetDrawBlendMode(blendMode, blendParam);
+
+	m_lineNum = 0;
+	m_triangleNum = 0;
+}
+
+/**
+* @fn DebugDraw::Flush
+* @brief 変わらない図形とためている図形を描画して、ためている図形を空にする
+* @details 毎フレームの最後に１回呼ぶ( 描画の呼び出しは変わらない図形と、ためている図形の種類ごとに１回ずつ )
+*/
+void DebugDraw::Flush()
+{
+	// 呼び出し側の描画の設定を覚えておき、描画後に戻す
+	int blendMode;
+	int blendParam;
+	GetDrawBlendMode(&blendMode, &blendParam);
+	int useLighting = GetUseLighting();
+	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
+	if(m_staticLineNum > 0)
+	{
+		SetUseLighting(false);
+		DrawPrimitive3D_UseVertexBuffer(m_staticLineBuffer, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPHIC, true);
+		m_drawCallNum++;
+		m_drawLineNum += m_staticLineNum;
+	}
+	if(m_staticTriangleNum > 0)
+	{
+		SetUseLighting(true);
+		DrawPrimitive3D_UseVertexBuffer(m_staticTriangleBuffer, DX_PRIMTYPE_TRIANGLELIST, DX_NONE_GRAPHIC, true);
+		m_drawCallNum++;
+		m_drawTriangleNum += m_staticTriangleNum;
+	}
+	SetUseLighting(useLighting);
+	SetDrawBlendMode(blendMode, blendParam);
+
+	FlushDynamic();
+
+	// このフレームの数を覚えて、次のフレームの数を数え直す
+	m_lastDrawCallNum = m_drawCallNum;
+	m_lastDrawLineNum = m_drawLineNum;
+	m_lastDrawTriangleNum = m_drawTriangleNum;
+	m_drawCallNum = 0;
+	m_drawLineNum = 0;
+	m_drawTriangleNum = 0;
+}
+
+/**
+* @fn DebugDraw::GetDrawCallNum
+* @brief 最後の Flush で描画を呼んだ回数
+* @return int
+*/
+int DebugDraw::GetDrawCallNum() const
+{
+	return m_lastDrawCallNum;
+}
+
+/**
+* @fn DebugDraw::GetDrawLineNum
+* @brief 最後の Flush で描画した線の数
+* @return int
+*/
+int DebugDraw::GetDrawLineNum() const
+{
+	return m_lastDrawLineNum;
+}
+
+/**
+* @fn DebugDraw::GetDrawTriangleNum
+* @brief 最後の Flush で描画した三角形の数
+* @return int
+*/
+int DebugDraw::GetDrawTriangleNum() const
+{
+	return m_lastDrawTriangleNum;
+}
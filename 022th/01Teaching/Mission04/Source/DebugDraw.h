@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include "DxLib.h"
+
+/**
+* @class DebugDraw
+* @brief 当たり判定や格子などの確認用の図形をためておき、まとめて描画する
+* @details 線と三角形を種類ごとの配列にためて、Flush で種類ごとに１回ずつ描画する
+*          BeginStatic から EndStatic までに追加した図形は頂点バッファに入れて、毎フレーム作り直さずに描画する
+*/
+class DebugDraw {
+private:
+	VERTEX3D *m_line;			// 線の頂点( ２頂点で１本 )
+	int m_lineNum;				// ためている線の数
+	int m_lineMax;				// ためられる線の最大数
+	VERTEX3D *m_triangle;		// 三角形の頂点( ３頂点で１枚 )
+	int m_triangleNum;			// ためている三角形の数
+	int m_triangleMax;			// ためられる三角形の最大数
+	bool m_static;				// BeginStatic から EndStatic までの間か
+	int m_staticLineBuffer;		// 変わらない線の頂点バッファ( -1:無し )
+	int m_staticTriangleBuffer;	// 変わらない三角形の頂点バッファ( -1:無し )
+	int m_staticLineNum;		// 変わらない線の数
+	int m_staticTriangleNum;	// 変わらない三角形の数
+	int m_drawCallNum;			// このフレームで描画を呼んだ回数( 一杯になって途中で描画した分も含む )
+	int m_drawLineNum;			// このフレームで描画した線の数
+	int m_drawTriangleNum;		// このフレームで描画した三角形の数
+	int m_lastDrawCallNum;		// 前のフレームで描画を呼んだ回数
+	int m_lastDrawLineNum;		// 前のフレームで描画した線の数
+	int m_lastDrawTriangleNum;	// 前のフレームで描画した三角形の数
+	float *m_lonCos;			// 球の経度ごとの cos
+	float *m_lonSin;			// 球の経度ごとの sin
+
+	bool ReserveLine(int num);		// 線を num 本ためられるようにする( 戻り値  true:ためられる  false:あふれる )
+	bool ReserveTriangle(int num);	// 三角形を num 枚ためられるようにする( 戻り値  true:ためられる  false:あふれる )
+	void FlushDynamic();			// ためている図形を描画して空にする
+	void AddShell(VECTOR p1, VECTOR p2, float r, COLOR_U8 color, bool fill);	// 線分の両端に半球をつけた形を追加する
+
+	DebugDraw(const DebugDraw &) = delete;			// 配列を持つのでコピー禁止
+	DebugDraw &operator =(const DebugDraw &) = delete;
+
+public:
+	DebugDraw(int lineMax, int triangleMax);	//!< コンストラクタ
+	~DebugDraw();								//!< デストラクタ
+	void Terminate();							//!< 変わらない図形の頂点バッファを解放する( DxLib_End の前に呼ぶ )
+
+	void AddLine(VECTOR p1, VECTOR p2, COLOR_U8 color);							//!< 線を追加する
+	void AddTriangle(VECTOR p1, VECTOR p2, VECTOR p3, COLOR_U8 color, bool fill);	//!< 三角形を追加する( fill が false なら輪郭の線 )
+	void AddSphere(VECTOR center, float r, COLOR_U8 color, bool fill);			//!< 球を追加する( fill が false なら線で組んだ形 )
+	void AddCapsule(VECTOR p1, VECTOR p2, float r, COLOR_U8 color, bool fill);	//!< カプセルを追加する( fill が false なら線で組んだ形 )
+
+	void BeginStatic();							//!< ここから EndStatic までに追加した図形を変わらない図形として覚える
+	void EndStatic();							//!< 追加した図形を頂点バッファに入れる( 前に覚えた図形は捨てる )
+	void Flush();								//!< 変わらない図形とためている図形を描画して、ためている図形を空にする
+
+	int GetDrawCallNum() const;					//!< 最後の Flush で描画を呼んだ回数
+	int GetDrawLineNum() const;					//!< 最後の Flush で描画した線の数
+	int GetDrawTriangleNum() const;				//!< 最後の Flush で描画した三角形の数
+};
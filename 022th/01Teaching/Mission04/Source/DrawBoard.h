@@ -1,8 +0,0 @@
-﻿/*
-2D画像を3D空間に配置する関数
-
-*/
-#pragma once
-#include "DxLib.h"
-
-void DrawBoard(VECTOR TopLeft, VECTOR BottomRight, int graphHandle);
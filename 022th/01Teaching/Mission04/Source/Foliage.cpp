@@ -0,0 +1,479 @@
+﻿#include "Foliage.h"
+#include <string.h>
+/**
+* @file
+* @brief Mission04
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 同じ画像を使う木の板ポリをまとめて描画する
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+
+const float Foliage::BOARD_WIDTH = 200.0f;		//!< 拡大率１の時の板ポリの幅
+const float Foliage::BOARD_HEIGHT = 200.0f;		//!< 拡大率１の時の板ポリの高さ
+const float Foliage::FULL_DISTANCE = 2000.0f;	//!< 拡大率１の時に板ポリ２枚で描画する距離
+const float Foliage::CULL_DISTANCE = 12000.0f;	//!< 拡大率１の時に描画しなくなる距離
+const float Foliage::LOD_HYSTERESIS = 0.1f;		//!< 切り替える距離の幅( 距離の割合、行ったり来たりしないように )
+const int   Foliage::IMPOSTOR_BATCH = 16384;	//!< 遠くの木を１回で描画する最大数( WORD のインデックスで足りる数 )
+
+/**
+* @fn Foliage::Foliage
+* @brief コンストラクタ
+* @param[in] int graphHandle, int capacity 置ける木の最大数
+*/
+Foliage::Foliage(int graphHandle, int capacity)
+{
+	m_graphHandle = graphHandle;
+	m_capacity = capacity;
+	m_treeNum = 0;
+	m_position = new VECTOR[capacity];
+	m_scale = new float[capacity];
+	m_nextFree = new int[capacity];
+	m_lod = new BYTE[capacity];
+	m_updatePending = new BYTE[capacity];
+	m_updateIndex = new int[capacity];
+	for(int i=0; i<capacity; i++)
+	{
+		m_scale[i] = 0.0f;
+		m_nextFree[i] = i + 1 < capacity ? i + 1 : -1;
+		m_updatePending[i] = 0;
+	}
+	m_freeHead = capacity > 0 ? 0 : -1;
+	m_updateNum = 0;
+	m_vertexBuffer = -1;
+	m_indexBuffer = -1;
+	m_vertexNum = 0;
+	m_fullIndex = new unsigned int[capacity * 12];
+	m_rebuildTime = 0;
+	m_rebuildTreeNum = 0;
+	for(int i=0; i<Lod_Num; i++)
+	{
+		m_lodTreeNum[i] = 0;
+		m_lodPolygonNum[i] = 0;
+	}
+
+	// 遠くの木の板ポリの色、法線、ＵＶ、インデックスは変わらないので先に入れておく
+	m_impostorVertex = new VERTEX3D[IMPOSTOR_BATCH * 4];
+	m_impostorIndex = new WORD[IMPOSTOR_BATCH * 6];
+	for(int i=0; i<IMPOSTOR_BATCH * 4; i++)
+	{
+		m_impostorVertex[i].norm = VGet(0.0f, 0.0f, -1.0f);
+		m_impostorVertex[i].dif = GetColorU8(255, 255, 255, 255);
+		m_impostorVertex[i].spc = GetColorU8(0, 0, 0, 0);
+		m_impostorVertex[i].u = (float)(i & 1);
+		m_impostorVertex[i].v = (float)((i >> 1) & 1);
+		m_impostorVertex[i].su = m_impostorVertex[i].u;
+		m_impostorVertex[i].sv = m_impostorVertex[i].v;
+	}
+	for(int i=0; i<IMPOSTOR_BATCH; i++)
+	{
+		WORD base = (WORD)(i * 4);
+		m_impostorIndex[i * 6 + 0] = base + 0;
+		m_impostorIndex[i * 6 + 1] = base + 1;
+		m_impostorIndex[i * 6 + 2] = base + 2;
+		m_impostorIndex[i * 6 + 3] = base + 3;
+		m_impostorIndex[i * 6 + 4] = base + 2;
+		m_impostorIndex[i * 6 + 5] = base + 1;
+	}
+}
+
+/**
+* @fn Foliage::~Foliage
+* @brief デストラクタ
+*/
+Foliage::~Foliage()
+{
+	Terminate();
+	delete[] m_position;
+	delete[] m_scale;
+	delete[] m_nextFree;
+	delete[] m_lod;
+	delete[] m_updatePending;
+	delete[] m_updateIndex;
+	delete[] m_fullIndex;
+	delete[] m_impostorVertex;
+	delete[] m_impostorIndex;
+}
+
+/**
+* @fn Foliage::Terminate
+* @brief 頂点バッファとインデックスバッファを解放する
+* @details DxLib_End の後では解放できないので、DxLib_End の前に呼ぶ( 次に描画する時は作り直す )
+*/
+void Foliage::Terminate()
+{
+	if(m_vertexBuffer != -1)
+	{
+		DeleteVertexBuffer(m_vertexBuffer);
+		DeleteIndexBuffer(m_indexBuffer);
+		m_vertexBuffer = -1;
+		m_indexBuffer = -1;
+		m_vertexNum = 0;
+	}
+}
+
+/**
+* @fn Foliage::Add
+* @brief 木を追加する
+* @param[in] VECTOR position 根元の座標, float scale 拡大率
+* @return int 番号( 一杯の場合は -1 )
+* @details 頂点バッファのこの木の板ポリは次に描画する時に書き換える
+*/
+int Foliage::Add(VECTOR position, float scale)
+{
+	int index = m_freeHead;
+	if(index < 0 || scale <= 0.0f)
+	{
+		return -1;
+	}
+	m_freeHead = m_nextFree[index];
+
+	m_position[index] = position;
+	m_scale[index] = scale;
+	m_lod[index] = Lod_Full;
+	m_treeNum++;
+	RequestUpdate(index);
+	return index;
+}
+
+/**
+* @fn Foliage::Remove
+* @brief 木を削除する
+* @param[in] int index Add で取得した番号
+*/
+void Foliage::Remove(int index)
+{
+	if(index < 0 || index >= m_capacity || m_scale[index] == 0.0f)
+	{
+		return;
+	}
+	m_scale[index] = 0.0f;
+	m_nextFree[index] = m_freeHead;
+	m_freeHead = index;
+	m_treeNum--;
+	RequestUpdate(index);
+}
+
+/**
+* @fn Foliage::SetBoard
+* @brief 木１本分の板ポリの８頂点を求める
+* @param[in] int index 木の番号
+* @param[out] VERTEX3D *vertex ８頂点分の配列
+* @details ＸＹ平面とＺＹ平面の板ポリを１枚ずつ入れる、色と法線とＵＶは全ての木で同じ
+*/
+void Foliage::SetBoard(int index, VERTEX3D *vertex)
+{
+	float halfWidth = BOARD_WIDTH * 0.5f * m_scale[index];
+	float top = m_position[index].y + BOARD_HEIGHT * m_scale[index];
+	float bottom = m_position[index].y;
+	for(int j=0; j<8; j++)
+	{
+		vertex[j].norm = VGet(0.0f, 0.0f, -1.0f);
+		vertex[j].dif = GetColorU8(255, 255, 255, 255);
+		vertex[j].spc = GetColorU8(0, 0, 0, 0);
+		vertex[j].u = (float)(j & 1);
+		vertex[j].v = (float)((j >> 1) & 1);
+		vertex[j].su = vertex[j].u;
+		vertex[j].sv = vertex[j].v;
+	}
+
+	// ＸＹ平面の板ポリ( 左上、右上、左下、右下 )
+	for(int j=0; j<4; j++)
+	{
+		vertex[j].pos = VGet(m_position[index].x + ((j & 1) ? halfWidth : -halfWidth), (j >> 1) ? bottom : top, m_position[index].z);
+	}
+
+	// ＺＹ平面の板ポリ
+	for(int j=0; j<4; j++)
+	{
+		vertex[4 + j].pos = VGet(m_position[index].x, (j >> 1) ? bottom : top, m_position[index].z + ((j & 1) ? halfWidth : -halfWidth));
+	}
+}
+
+/**
+* @fn Foliage::RequestUpdate
+* @brief 木の板ポリを次の描画で書き換えるようにする
+* @param[in] int index 木の番号
+* @details 同じ木を何度追加、削除しても一覧には１回だけ入れる
+*/
+void Foliage::RequestUpdate(int index)
+{
+	if(m_updatePending[index] != 0)
+	{
+		return;
+	}
+	m_updatePending[index] = 1;
+	m_updateIndex[m_updateNum++] = index;
+}
+
+/**
+* @fn Foliage::Rebuild
+* @brief 頂点バッファとインデックスバッファを作り直す
+* @details 木の番号をそのまま頂点バッファの中の番号にして、置ける木の最大数分( 木１本につき８頂点 )を確保する
+*          空いている番号の板ポリはインデックスを並べないので描画されない
+*          インデックスバッファは近くの木の分を描画の度に書き込むので、大きさだけ確保する
+*/
+void Foliage::Rebuild()
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+
+	int vertexNum = m_capacity * 8;
+	VERTEX3D *vertex = new VERTEX3D[vertexNum];
+	for(int i=0; i<m_capacity; i++)
+	{
+		if(m_scale[i] != 0.0f)
+		{
+			SetBoard(i, &vertex[i * 8]);
+		}
+		else
+		{
+			memset(&vertex[i * 8], 0, sizeof(VERTEX3D) * 8);
+		}
+		m_updatePending[i] = 0;
+	}
+	m_updateNum = 0;
+
+	m_vertexNum = vertexNum;
+	m_vertexBuffer = CreateVertexBuffer(vertexNum, DX_VERTEX_TYPE_NORMAL_3D);
+	m_indexBuffer = CreateIndexBuffer(m_capacity * 12, DX_INDEX_TYPE_32BIT);
+	SetVertexBufferData(0, vertex, vertexNum, m_vertexBuffer);
+
+	delete[] vertex;
+
+	m_rebuildTreeNum = m_treeNum;
+	m_rebuildTime = GetNowHiPerformanceCount() - startTime;
+}
+
+/**
+* @fn Foliage::Update
+* @brief 追加、削除した木の板ポリだけ頂点バッファを書き換える
+* @details 削除した木はインデックスを並べなくなるだけなので、頂点は書き換えない
+*/
+void Foliage::Update()
+{
+	LONGLONG startTime = GetNowHiPerformanceCount();
+
+	int treeNum = 0;
+	for(int i=0; i<m_updateNum; i++)
+	{
+		int index = m_updateIndex[i];
+		m_updatePending[index] = 0;
+		if(m_scale[index] == 0.0f)
+		{
+			continue;
+		}
+		VERTEX3D vertex[8];
+		SetBoard(index, vertex);
+		SetVertexBufferData(index * 8, vertex, 8, m_vertexBuffer);
+		treeNum++;
+	}
+	m_updateNum = 0;
+
+	m_rebuildTreeNum = treeNum;
+	m_rebuildTime = GetNowHiPerformanceCount() - startTime;
+}
+
+/**
+* @fn Foliage::UpdateLod
+* @brief カメラからの距離で木ごとの描画の細かさを切り替える
+* @param[in] VECTOR cameraPosition
+* @details 切り替える距離は拡大率に比例させ、遠ざかる時は少し遠く、近づく時は少し近くで切り替える
+*/
+void Foliage::UpdateLod(VECTOR cameraPosition)
+{
+	float farRate = (1.0f + LOD_HYSTERESIS) * (1.0f + LOD_HYSTERESIS);
+	float nearRate = (1.0f - LOD_HYSTERESIS) * (1.0f - LOD_HYSTERESIS);
+	for(int i=0; i<m_capacity; i++)
+	{
+		if(m_scale[i] == 0.0f)
+		{
+			continue;
+		}
+		VECTOR d = VSub(m_position[i], cameraPosition);
+		float distanceSq = d.x * d.x + d.y * d.y + d.z * d.z;
+		float fullSq = FULL_DISTANCE * m_scale[i] * FULL_DISTANCE * m_scale[i];
+		float cullSq = CULL_DISTANCE * m_scale[i] * CULL_DISTANCE * m_scale[i];
+
+		int lod = m_lod[i];
+		if(lod == Lod_Full && distanceSq > fullSq * farRate)
+		{
+			lod = Lod_Impostor;
+		}
+		if(lod == Lod_Impostor && distanceSq > cullSq * farRate)
+		{
+			lod = Lod_Culled;
+		}
+		if(lod == Lod_Culled && distanceSq < cullSq * nearRate)
+		{
+			lod = Lod_Impostor;
+		}
+		if(lod == Lod_Impostor && distanceSq < fullSq * nearRate)
+		{
+			lod = Lod_Full;
+		}
+		m_lod[i] = (BYTE)lod;
+	}
+}
+
+/**
+* @fn Foliage::DrawImpostor
+* @brief 遠くの木をカメラの方を向いた板ポリ１枚で描画する
+* @param[in] VECTOR cameraPosition
+* @details 板ポリはＹ軸を中心に回して、木ごとにカメラの方へ向ける
+*/
+void Foliage::DrawImpostor(VECTOR cameraPosition)
+{
+	int num = 0;
+	for(int i=0; i<m_capacity; i++)
+	{
+		if(m_scale[i] == 0.0f || m_lod[i] != Lod_Impostor)
+		{
+			continue;
+		}
+
+		// カメラから木への向きに垂直な横向き
+		float dx = m_position[i].x - cameraPosition.x;
+		float dz = m_position[i].z - cameraPosition.z;
+		float length = sqrtf(dx * dx + dz * dz);
+		float halfWidth = BOARD_WIDTH * 0.5f * m_scale[i];
+		VECTOR side = length > 0.0f ? VGet(dz / length * halfWidth, 0.0f, -dx / length * halfWidth) : VGet(halfWidth, 0.0f, 0.0f);
+		VECTOR bottom = m_position[i];
+		VECTOR top = VGet(bottom.x, bottom.y + BOARD_HEIGHT * m_scale[i], bottom.z);
+
+		// 左上、右上、左下、右下
+		VERTEX3D *v = &m_impostorVertex[num * 4];
+		v[0].pos = VSub(top, side);
+		v[1].pos = VAdd(top, side);
+		v[2].pos = VSub(bottom, side);
+		v[3].pos = VAdd(bottom, side);
+		num++;
+
+		if(num == IMPOSTOR_BATCH)
+		{
+			DrawPolygonIndexed3D(m_impostorVertex, num * 4, m_impostorIndex, num * 2, m_graphHandle, true);
+			num = 0;
+		}
+	}
+	if(num > 0)
+	{
+		DrawPolygonIndexed3D(m_impostorVertex, num * 4, m_impostorIndex, num * 2, m_graphHandle, true);
+	}
+}
+
+/**
+* @fn Foliage::Draw
+* @brief 全ての木を描画
+* @param[in] VECTOR cameraPosition
+* @details 頂点バッファが無ければ作り、前回の描画から追加、削除された木があればその分だけ書き換える
+*          近い木は頂点バッファの中の分のインデックスを並べて１回で、遠い木はカメラの方を向いた板ポリ１枚で描画する
+*/
+void Foliage::Draw(VECTOR cameraPosition)
+{
+	if(m_vertexBuffer == -1)
+	{
+		Rebuild();
+	}
+	else if(m_updateNum > 0)
+	{
+		Update();
+	}
+	UpdateLod(cameraPosition);
+
+	// 細かさごとの数を数えながら、近い木のインデックスを並べる
+	int indexNum = 0;
+	for(int i=0; i<Lod_Num; i++)
+	{
+		m_lodTreeNum[i] = 0;
+	}
+	for(int i=0; i<m_capacity; i++)
+	{
+		if(m_scale[i] == 0.0f)
+		{
+			continue;
+		}
+		m_lodTreeNum[m_lod[i]]++;
+		if(m_lod[i] != Lod_Full)
+		{
+			continue;
+		}
+
+		// 板ポリ１枚につき２ポリゴン
+		unsigned int base = (unsigned int)i * 8;
+		for(int j=0; j<2; j++)
+		{
+			unsigned int *p = &m_fullIndex[indexNum];
+			p[0] = base + 0;
+			p[1] = base + 1;
+			p[2] = base + 2;
+			p[3] = base + 3;
+			p[4] = base + 2;
+			p[5] = base + 1;
+			indexNum += 6;
+			base += 4;
+		}
+	}
+	m_lodPolygonNum[Lod_Full] = m_lodTreeNum[Lod_Full] * 4;
+	m_lodPolygonNum[Lod_Impostor] = m_lodTreeNum[Lod_Impostor] * 2;
+	m_lodPolygonNum[Lod_Culled] = 0;
+
+	if(indexNum > 0)
+	{
+		SetIndexBufferData(0, m_fullIndex, indexNum, m_indexBuffer);
+		DrawPrimitiveIndexed3D_UseVertexBuffer2(m_vertexBuffer, m_indexBuffer, DX_PRIMTYPE_TRIANGLELIST, 0, 0, m_vertexNum, 0, indexNum, m_graphHandle, true);
+	}
+	DrawImpostor(cameraPosition);
+}
+
+/**
+* @fn Foliage::GetTreeNum
+* @brief 置いてある木の数
+* @return int
+*/
+int Foliage::GetTreeNum() const
+{
+	return m_treeNum;
+}
+
+/**
+* @fn Foliage::GetLodTreeNum
+* @brief 最後の描画での細かさごとの木の数
+* @param[in] int lod FoliageLod
+* @return int
+*/
+int Foliage::GetLodTreeNum(int lod) const
+{
+	return m_lodTreeNum[lod];
+}
+
+/**
+* @fn Foliage::GetLodPolygonNum
+* @brief 最後の描画での細かさごとのポリゴンの数
+* @param[in] int lod FoliageLod
+* @return int
+*/
+int Foliage::GetLodPolygonNum(int lod) const
+{
+	return m_lodPolygonNum[lod];
+}
+
+/**
+* @fn Foliage::GetRebuildTime
+* @brief 最後に頂点バッファを作り直すか書き換えるのにかかった時間
+* @return LONGLONG マイクロ秒
+*/
+LONGLONG Foliage::GetRebuildTime() const
+{
+	return m_rebuildTime;
+}
+
+/**
+* @fn Foliage::GetRebuildTreeNum
+* @brief 最後に頂点バッファを書き換えた木の数
+* @return int
+*/
+int Foliage::GetRebuildTreeNum() const
+{
+	return m_rebuildTreeNum;
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include "DxLib.h"
+
+/**
+* @enum FoliageLod
+* @brief 木の描画の細かさ
+*/
+enum FoliageLod
+{
+	Lod_Full,		// 板ポリ２枚
+	Lod_Impostor,	// カメラの方を向いた板ポリ１枚
+	Lod_Culled,		// 描画しない
+
+	Lod_Num,
+};
+
+/**
+* @class Foliage
+* @brief 同じ画像を使う木の板ポリをまとめて描画する
+* @details 頂点バッファは置ける木の最大数分を最初に１回だけ作り、木を追加、削除した時はその木の板ポリだけを書き換える
+*          カメラからの距離で木ごとに描画の細かさを切り替え、近い木は頂点バッファから１回で、遠い木はカメラの方を向いた板ポリ１枚で描画する
+*/
+class Foliage {
+private:
+	int m_graphHandle;			// 画像ハンドル
+	int m_capacity;				// 置ける木の最大数
+	int m_treeNum;				// 置いてある木の数
+	VECTOR *m_position;			// 木ごとの座標
+	float *m_scale;				// 木ごとの拡大率( 0.0f:空き )
+	int *m_nextFree;			// 次の空いている番号( -1:終端 )
+	int m_freeHead;				// 最初の空いている番号( -1:空き無し )
+	BYTE *m_lod;				// 木ごとの描画の細かさ( FoliageLod )
+	BYTE *m_updatePending;		// 木ごとに頂点バッファを書き換える必要があるか
+	int *m_updateIndex;			// 頂点バッファを書き換える木の番号の一覧
+	int m_updateNum;			// 頂点バッファを書き換える木の数
+	int m_vertexBuffer;			// 頂点バッファハンドル
+	int m_indexBuffer;			// インデックスバッファハンドル( 毎フレーム近くの木の分だけ書き込む )
+	int m_vertexNum;			// 頂点バッファの頂点の数( 置ける木の最大数×８ )
+	unsigned int *m_fullIndex;	// 近くの木のインデックス
+	VERTEX3D *m_impostorVertex;	// 遠くの木の頂点
+	WORD *m_impostorIndex;		// 遠くの木のインデックス
+	int m_lodTreeNum[Lod_Num];	// 最後の描画での細かさごとの木の数
+	int m_lodPolygonNum[Lod_Num];	// 最後の描画での細かさごとのポリゴンの数
+	LONGLONG m_rebuildTime;		// 最後に頂点バッファを作り直すか書き換えるのにかかった時間( マイクロ秒 )
+	int m_rebuildTreeNum;		// 最後に頂点バッファを書き換えた木の数
+
+	void SetBoard(int index, VERTEX3D *vertex);	// 木１本分の板ポリの８頂点を求める
+	void RequestUpdate(int index);	// 木の板ポリを次の描画で書き換えるようにする
+	void Rebuild();				// 頂点バッファとインデックスバッファを作り直す
+	void Update();				// 追加、削除した木の板ポリだけ頂点バッファを書き換える
+	void UpdateLod(VECTOR cameraPosition);	// カメラからの距離で木ごとの描画の細かさを切り替える
+	void DrawImpostor(VECTOR cameraPosition);	// 遠くの木をカメラの方を向いた板ポリ１枚で描画する
+
+	Foliage(const Foliage &) = delete;				// 頂点バッファを持つのでコピー禁止
+	Foliage &operator =(const Foliage &) = delete;
+
+public:
+	static const float BOARD_WIDTH;						//!< 拡大率１の時の板ポリの幅
+	static const float BOARD_HEIGHT;					//!< 拡大率１の時の板ポリの高さ
+	static const float FULL_DISTANCE;					//!< 拡大率１の時に板ポリ２枚で描画する距離
+	static const float CULL_DISTANCE;					//!< 拡大率１の時に描画しなくなる距離
+	static const float LOD_HYSTERESIS;					//!< 切り替える距離の幅( 距離の割合、行ったり来たりしないように )
+	static const int   IMPOSTOR_BATCH;					//!< 遠くの木を１回で描画する最大数
+
+	Foliage(int graphHandle, int capacity);				//!< コンストラクタ
+	~Foliage();											//!< デストラクタ
+	void Terminate();									//!< 頂点バッファとインデックスバッファを解放する( DxLib_End の前に呼ぶ )
+
+	int Add(VECTOR position, float scale);				//!< 木を追加する( 戻り値 : 番号、一杯の場合は -1 )
+	void Remove(int index);								//!< 木を削除する
+	void Draw(VECTOR cameraPosition);					//!< 全ての木を描画
+	int GetTreeNum() const;								//!< 置いてある木の数
+	int GetLodTreeNum(int lod) const;					//!< 最後の描画での細かさごとの木の数
+	int GetLodPolygonNum(int lod) const;				//!< 最後の描画での細かさごとのポリゴンの数
+	LONGLONG GetRebuildTime() const;					//!< 最後に頂点バッファを作り直すか書き換えるのにかかった時間( マイクロ秒 )
+	int GetRebuildTreeNum() const;						//!< 最後に頂点バッファを書き換えた木の数
+};
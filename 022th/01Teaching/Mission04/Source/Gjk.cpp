@@ -0,0 +1,936 @@
+﻿#include "Gjk.h"
+#include <stddef.h>
+/**
+* @file
+* @brief Mission04
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details GJK で凸形状同士の距離を、EPA で重なっている時のめり込み量を求める
+* @note 参考 G. van den Bergen "Collision Detection in Interactive 3D Environments"
+*       C. Ericson "Real-Time Collision Detection" 5.1.5, 5.1.6
+*/
+
+
+const int   GJK_ITERATION_MAX = 64;				//!< GJK の反復回数の上限
+const int   EPA_ITERATION_MAX = 64;				//!< EPA の反復回数の上限
+const int   EPA_VERTEX_MAX = EPA_ITERATION_MAX + 4;	//!< EPA の多面体の頂点の最大数
+const int   EPA_FACE_MAX = EPA_VERTEX_MAX * 2;	//!< EPA の多面体の面の最大数
+const int   EPA_EDGE_MAX = EPA_FACE_MAX;		//!< EPA で面を作り直す時の境界の辺の最大数
+const float GJK_TOLERANCE = 0.0001f;			//!< 収束したとみなす相対誤差
+const float GJK_EPSILON = 0.000001f;			//!< 重なっているとみなす距離の２乗
+
+/**
+* @struct SimplexVertex
+* @brief A－B の頂点と、それを作った A と B の点
+*/
+struct SimplexVertex {
+	Float3 w;	// a - b
+	Float3 a;	// A の点
+	Float3 b;	// B の点
+	Vec3 d;		// 探索方向
+};
+
+/**
+* @struct Simplex
+* @brief GJK の単体( 点、線分、三角形、四面体 )
+*/
+struct Simplex {
+	SimplexVertex v[4];
+	float bary[4];		// 原点に一番近い点の重心座標
+	int num;
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+* @fn Convex::supportCore
+* @brief 厚みを除いた芯の、指定の向きに一番遠い点
+* @param[in] const Vec3 &d 向き( 長さは問わない )
+* @return Float3
+*/
+Float3 Convex::supportCore(const Vec3 &d) const
+{
+	switch(type)
+	{
+	case Convex_Sphere:
+		return ((const Sphere *)shape)->p;
+
+	case Convex_Capsule:
+	{
+		const Segment &s = ((const Capsule *)shape)->s;
+		return s.v.dot(d) > 0.0f ? s.getEndPoint() : s.p;
+	}
+
+	case Convex_AABB:
+	{
+		const AABB *box = (const AABB *)shape;
+		return Float3(
+			box->p.x + (d.x >= 0.0f ? box->hl.x : -box->hl.x),
+			box->p.y + (d.y >= 0.0f ? box->hl.y : -box->hl.y),
+			box->p.z + (d.z >= 0.0f ? box->hl.z : -box->hl.z));
+	}
+
+	case Convex_OBB:
+	{
+		const OBB *box = (const OBB *)shape;
+		Float3 p = box->p;
+		p = p + box->axis[0] * (box->axis[0].dot(d) >= 0.0f ? box->hl.x : -box->hl.x);
+		p = p + box->axis[1] * (box->axis[1].dot(d) >= 0.0f ? box->hl.y : -box->hl.y);
+		p = p + box->axis[2] * (box->axis[2].dot(d) >= 0.0f ? box->hl.z : -box->hl.z);
+		return p;
+	}
+
+	case Convex_Cylinder:
+	{
+		// 軸の向きで上面か底面を選び、軸に垂直な成分の向きに半径だけずらす
+		const Cylinder *cylinder = (const Cylinder *)shape;
+		Vec3 axis = cylinder->s.v.getNorm();
+		Float3 p = axis.dot(d) > 0.0f ? cylinder->s.getEndPoint() : cylinder->s.p;
+		Vec3 side = d - axis * axis.dot(d);
+		float sideLength = side.length();
+		if(sideLength > _OX_EPSILON_)
+		{
+			p = p + side * (cylinder->r / sideLength);
+		}
+		return p;
+	}
+
+	case Convex_Hull:
+	{
+		const ConvexHull *hull = (const ConvexHull *)shape;
+		int best = 0;
+		float bestDot = hull->vertexNum > 0 ? hull->vertex[0].dot(d) : 0.0f;
+		for(int i=1; i<hull->vertexNum; i++)
+		{
+			float dot = hull->vertex[i].dot(d);
+			if(dot > bestDot)
+			{
+				bestDot = dot;
+				best = i;
+			}
+		}
+		return hull->vertexNum > 0 ? hull->p + hull->vertex[best] : hull->p;
+	}
+	}
+	return Float3(0.0f, 0.0f, 0.0f);
+}
+
+/**
+* @fn Convex::margin
+* @brief 厚み
+* @return float 球とカプセルは半径、それ以外は 0
+*/
+float Convex::margin() const
+{
+	switch(type)
+	{
+	case Convex_Sphere:
+		return ((const Sphere *)shape)->r;
+
+	case Convex_Capsule:
+		return ((const Capsule *)shape)->r;
+
+	default:
+		return 0.0f;
+	}
+}
+
+/**
+* @fn Convex::support
+* @brief 厚みを含めた、指定の向きに一番遠い点
+* @param[in] const Vec3 &d 向き( 長さは問わない )
+* @return Float3
+*/
+Float3 Convex::support(const Vec3 &d) const
+{
+	float r = margin();
+	if(r > 0.0f)
+	{
+		return supportCore(d) + d.getNorm() * r;
+	}
+	return supportCore(d);
+}
+
+/**
+* @fn IsRoundCore
+* @brief 芯が点か線分で、厚みで丸みをつけた形かどうか
+* @param[in] const Convex &c
+* @return bool true:球かカプセル  false:それ以外
+*/
+static bool IsRoundCore(const Convex &c)
+{
+	return c.type == Convex_Sphere || c.type == Convex_Capsule;
+}
+
+/**
+* @fn CoreCenter
+* @brief 形の中心
+* @param[in] const Convex &c
+* @return Float3 カプセルと円柱は芯の線分の中点、それ以外は位置
+*/
+static Float3 CoreCenter(const Convex &c)
+{
+	switch(c.type)
+	{
+	case Convex_Sphere:
+		return ((const Sphere *)c.shape)->p;
+
+	case Convex_Capsule:
+	{
+		const Segment &s = ((const Capsule *)c.shape)->s;
+		return s.p + s.v * 0.5f;
+	}
+
+	case Convex_AABB:
+		return ((const AABB *)c.shape)->p;
+
+	case Convex_OBB:
+		return ((const OBB *)c.shape)->p;
+
+	case Convex_Cylinder:
+	{
+		const Segment &s = ((const Cylinder *)c.shape)->s;
+		return s.p + s.v * 0.5f;
+	}
+
+	case Convex_Hull:
+		return ((const ConvexHull *)c.shape)->p;
+	}
+	return Float3(0.0f, 0.0f, 0.0f);
+}
+
+/**
+* @fn CenterAxis
+* @brief A の中心から B の中心への向き
+* @param[in] const Convex &a, const Convex &b
+* @return Vec3 単位ベクトル( 中心が重なっている場合は上向き )
+*/
+static Vec3 CenterAxis(const Convex &a, const Convex &b)
+{
+	Vec3 axis = CoreCenter(b) - CoreCenter(a);
+	float length = axis.length();
+	if(length <= _OX_EPSILON_)
+	{
+		return Vec3(0.0f, 1.0f, 0.0f);
+	}
+	return axis / length;
+}
+
+/**
+* @fn AxisPenetration
+* @brief 指定の向きに B を動かして離す場合のめり込み量を求める
+* @param[in] const Convex &a, const Convex &b, const Vec3 &n A から B への向き( 単位ベクトル )
+* @param[out] GjkResult &result
+* @details A の n の向きに一番遠い点と、B の -n の向きに一番遠い点の n の向きの差がめり込み量になる
+*/
+static void AxisPenetration(const Convex &a, const Convex &b, const Vec3 &n, GjkResult &result)
+{
+	Vec3 negative = -n;
+	result.pointA = a.support(n);
+	result.pointB = b.support(negative);
+	result.distance = -n.dot(result.pointA - result.pointB);
+	result.normal = n;
+	result.hit = result.distance <= 0.0f;
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+* @fn MakeVertex
+* @brief 指定の向きの A－B の頂点を求める
+* @param[in] const Convex &a, const Convex &b, const Vec3 &d, bool core true:芯だけ  false:厚みを含める
+* @return SimplexVertex
+*/
+static SimplexVertex MakeVertex(const Convex &a, const Convex &b, const Vec3 &d, bool core)
+{
+	SimplexVertex v;
+	Vec3 negative = -d;
+	v.a = core ? a.supportCore(d) : a.support(d);
+	v.b = core ? b.supportCore(negative) : b.support(negative);
+	v.w = v.a - v.b;
+	v.d = d;
+	return v;
+}
+
+/**
+* @fn SolveSegment
+* @brief 単体の線分 v[i0]v[i1] の上で原点に一番近い点を求めて、単体をその点を含む最小の部分にする
+* @param[in,out] Simplex &s
+* @param[in] int i0, int i1
+* @return Float3 一番近い点
+*/
+static Float3 SolveSegment(Simplex &s, int i0, int i1)
+{
+	SimplexVertex a = s.v[i0];
+	SimplexVertex b = s.v[i1];
+	Vec3 ab = b.w - a.w;
+	float lengthSq = ab.lengthSq();
+	float t = lengthSq > 0.0f ? -a.w.dot(ab) / lengthSq : 0.0f;
+	if(t <= 0.0f)
+	{
+		s.v[0] = a;
+		s.bary[0] = 1.0f;
+		s.num = 1;
+		return a.w;
+	}
+	if(t >= 1.0f)
+	{
+		s.v[0] = b;
+		s.bary[0] = 1.0f;
+		s.num = 1;
+		return b.w;
+	}
+	s.v[0] = a;
+	s.v[1] = b;
+	s.bary[0] = 1.0f - t;
+	s.bary[1] = t;
+	s.num = 2;
+	return a.w + ab * t;
+}
+
+/**
+* @fn SolveTriangle
+* @brief 単体の三角形 v[i0]v[i1]v[i2] の上で原点に一番近い点を求めて、単体をその点を含む最小の部分にする
+* @param[in,out] Simplex &s
+* @param[in] int i0, int i1, int i2
+* @return Float3 一番近い点
+* @details 原点がどの頂点、辺、面の領域にあるかを順に調べる
+*/
+static Float3 SolveTriangle(Simplex &s, int i0, int i1, int i2)
+{
+	SimplexVertex a = s.v[i0];
+	SimplexVertex b = s.v[i1];
+	SimplexVertex c = s.v[i2];
+	Vec3 ab = b.w - a.w;
+	Vec3 ac = c.w - a.w;
+
+	// 頂点 a の領域
+	Vec3 ap = -a.w;
+	float d1 = ab.dot(ap);
+	float d2 = ac.dot(ap);
+	if(d1 <= 0.0f && d2 <= 0.0f)
+	{
+		s.v[0] = a;
+		s.bary[0] = 1.0f;
+		s.num = 1;
+		return a.w;
+	}
+
+	// 頂点 b の領域
+	Vec3 bp = -b.w;
+	float d3 = ab.dot(bp);
+	float d4 = ac.dot(bp);
+	if(d3 >= 0.0f && d4 <= d3)
+	{
+		s.v[0] = b;
+		s.bary[0] = 1.0f;
+		s.num = 1;
+		return b.w;
+	}
+
+	// 辺 ab の領域
+	float vc = d1 * d4 - d3 * d2;
+	if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		s.v[0] = a;
+		s.v[1] = b;
+		s.num = 2;
+		return SolveSegment(s, 0, 1);
+	}
+
+	// 頂点 c の領域
+	Vec3 cp = -c.w;
+	float d5 = ab.dot(cp);
+	float d6 = ac.dot(cp);
+	if(d6 >= 0.0f && d5 <= d6)
+	{
+		s.v[0] = c;
+		s.bary[0] = 1.0f;
+		s.num = 1;
+		return c.w;
+	}
+
+	// 辺 ac の領域
+	float vb = d5 * d2 - d1 * d6;
+	if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		s.v[0] = a;
+		s.v[1] = c;
+		s.num = 2;
+		return SolveSegment(s, 0, 1);
+	}
+
+	// 辺 bc の領域
+	float va = d3 * d6 - d5 * d4;
+	if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		s.v[0] = b;
+		s.v[1] = c;
+		s.num = 2;
+		return SolveSegment(s, 0, 1);
+	}
+
+	// 面の領域( 潰れた三角形の場合は辺の中で一番近いもの )
+	float denom = va + vb + vc;
+	if(denom <= 0.0f)
+	{
+		Simplex best = s;
+		Float3 bestPoint = SolveSegment(best, i0, i1);
+		Simplex other = s;
+		Float3 otherPoint = SolveSegment(other, i1, i2);
+		if(otherPoint.lengthSq() < bestPoint.lengthSq())
+		{
+			best = other;
+			bestPoint = otherPoint;
+		}
+		other = s;
+		otherPoint = SolveSegment(other, i2, i0);
+		if(otherPoint.lengthSq() < bestPoint.lengthSq())
+		{
+			best = other;
+			bestPoint = otherPoint;
+		}
+		s = best;
+		return bestPoint;
+	}
+	float v = vb / denom;
+	float w = vc / denom;
+	s.v[0] = a;
+	s.v[1] = b;
+	s.v[2] = c;
+	s.bary[0] = 1.0f - v - w;
+	s.bary[1] = v;
+	s.bary[2] = w;
+	s.num = 3;
+	return a.w + ab * v + ac * w;
+}
+
+/**
+* @fn IsOutsideOfFace
+* @brief 原点が三角形 abc の、d と反対側にあるかどうか
+* @param[in] const Float3 &a, const Float3 &b, const Float3 &c, const Float3 &d
+* @return bool true:反対側にある( d が面の上にある潰れた四面体も含む )
+*/
+static bool IsOutsideOfFace(const Float3 &a, const Float3 &b, const Float3 &c, const Float3 &d)
+{
+	Vec3 n = (b - a).cross(c - a);
+	float signOrigin = (-a).dot(n);
+	float signD = (d - a).dot(n);
+	if(signD * signD <= GJK_EPSILON * n.lengthSq())
+	{
+		return true;
+	}
+	return signOrigin * signD < 0.0f;
+}
+
+/**
+* @fn SolveTetrahedron
+* @brief 単体の四面体の上で原点に一番近い点を求めて、単体をその点を含む最小の部分にする
+* @param[in,out] Simplex &s
+* @param[out] bool &inside 原点が四面体の中にあるか
+* @return Float3 一番近い点
+*/
+static Float3 SolveTetrahedron(Simplex &s, bool &inside)
+{
+	static const int FACE[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+	inside = true;
+	Simplex best = s;
+	Float3 bestPoint(0.0f, 0.0f, 0.0f);
+	float bestDistance = 0.0f;
+	for(int i=0; i<4; i++)
+	{
+		const int *f = FACE[i];
+		if(!IsOutsideOfFace(s.v[f[0]].w, s.v[f[1]].w, s.v[f[2]].w, s.v[f[3]].w))
+		{
+			continue;
+		}
+		Simplex face = s;
+		Float3 point = SolveTriangle(face, f[0], f[1], f[2]);
+		if(inside || point.lengthSq() < bestDistance)
+		{
+			best = face;
+			bestPoint = point;
+			bestDistance = point.lengthSq();
+		}
+		inside = false;
+	}
+	if(inside)
+	{
+		return Float3(0.0f, 0.0f, 0.0f);
+	}
+	s = best;
+	return bestPoint;
+}
+
+/**
+* @fn SolveSimplex
+* @brief 単体の上で原点に一番近い点を求めて、単体をその点を含む最小の部分にする
+* @param[in,out] Simplex &s
+* @param[out] bool &inside 原点が四面体の中にあるか
+* @return Float3 一番近い点
+*/
+static Float3 SolveSimplex(Simplex &s, bool &inside)
+{
+	inside = false;
+	switch(s.num)
+	{
+	case 1:
+		s.bary[0] = 1.0f;
+		return s.v[0].w;
+
+	case 2:
+		return SolveSegment(s, 0, 1);
+
+	case 3:
+		return SolveTriangle(s, 0, 1, 2);
+
+	default:
+		return SolveTetrahedron(s, inside);
+	}
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+* @struct EpaFace
+* @brief EPA の多面体の面
+*/
+struct EpaFace {
+	int index[3];	// 頂点の番号( 外から見て反時計回り )
+	Vec3 n;			// 外向きの法線( 単位ベクトル )
+	float dist;		// 原点から面までの距離
+	bool alive;		// 使っているか
+};
+
+/**
+* @fn AddEpaFace
+* @brief EPA の多面体に面を追加する
+* @param[in,out] EpaFace *face, int &faceNum
+* @param[in] const SimplexVertex *vertex, int i0, int i1, int i2
+* @return bool true:成功  false:面が一杯か潰れている
+*/
+static bool AddEpaFace(EpaFace *face, int &faceNum, const SimplexVertex *vertex, int i0, int i1, int i2)
+{
+	if(faceNum >= EPA_FACE_MAX)
+	{
+		return false;
+	}
+	Vec3 n = (vertex[i1].w - vertex[i0].w).cross(vertex[i2].w - vertex[i0].w);
+	float length = n.length();
+	if(length <= _OX_EPSILON_)
+	{
+		return false;
+	}
+	EpaFace &f = face[faceNum++];
+	f.index[0] = i0;
+	f.index[1] = i1;
+	f.index[2] = i2;
+	f.n = n / length;
+	f.dist = f.n.dot(vertex[i0].w);
+	f.alive = true;
+	return true;
+}
+
+/**
+* @fn BlowUpSimplex
+* @brief GJK の単体を、原点を含む四面体に広げる
+* @param[in] const Convex &a, const Convex &b
+* @param[in,out] Simplex &s
+* @return bool true:成功  false:A－B が潰れていて四面体にならない
+*/
+static bool BlowUpSimplex(const Convex &a, const Convex &b, Simplex &s)
+{
+	static const Vec3 AXIS[3] = { Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f) };
+
+	// 点なら各軸の向きに伸ばす
+	if(s.num == 1)
+	{
+		for(int i=0; i<6 && s.num == 1; i++)
+		{
+			Vec3 d = i < 3 ? AXIS[i] : Vec3(-AXIS[i - 3]);
+			SimplexVertex v = MakeVertex(a, b, d, false);
+			if((v.w - s.v[0].w).lengthSq() > GJK_EPSILON)
+			{
+				s.v[s.num++] = v;
+			}
+		}
+	}
+
+	// 線分なら線分に垂直な向きに伸ばす
+	if(s.num == 2)
+	{
+		Vec3 line = s.v[1].w - s.v[0].w;
+		int minAxis = 0;
+		for(int i=1; i<3; i++)
+		{
+			if(fabsf(*(&line.x + i)) < fabsf(*(&line.x + minAxis)))
+			{
+				minAxis = i;
+			}
+		}
+		Vec3 d1 = line.cross(AXIS[minAxis]);
+		Vec3 d2 = line.cross(d1);
+		Vec3 dir[4] = { d1, -d1, d2, -d2 };
+		for(int i=0; i<4 && s.num == 2; i++)
+		{
+			SimplexVertex v = MakeVertex(a, b, dir[i], false);
+			if(line.cross(v.w - s.v[0].w).lengthSq() > GJK_EPSILON * line.lengthSq())
+			{
+				s.v[s.num++] = v;
+			}
+		}
+	}
+
+	// 三角形なら面に垂直な向きに伸ばす
+	if(s.num == 3)
+	{
+		Vec3 n = (s.v[1].w - s.v[0].w).cross(s.v[2].w - s.v[0].w);
+		Vec3 dir[2] = { n, -n };
+		for(int i=0; i<2 && s.num == 3; i++)
+		{
+			SimplexVertex v = MakeVertex(a, b, dir[i], false);
+			float height = n.dot(v.w - s.v[0].w);
+			if(height * height > GJK_EPSILON * n.lengthSq())
+			{
+				s.v[s.num++] = v;
+			}
+		}
+	}
+	return s.num == 4;
+}
+
+/**
+* @fn Epa
+* @brief 重なっている２つの凸形状のめり込み量を求める
+* @param[in] const Convex &a, const Convex &b, const Simplex &simplex 原点を含む GJK の単体
+* @param[out] GjkResult &result
+* @return bool true:成功  false:A－B が潰れていて求められない
+* @details 原点を含む多面体を、原点に一番近い面の法線の向きに広げていき、広がらなくなった面がめり込みを解消する向きになる
+*          頂点の数の上限で広げられなくなった場合は、その面の法線と中心同士を結ぶ向きのうち、めり込みの少ない方を使う
+*/
+static bool Epa(const Convex &a, const Convex &b, const Simplex &simplex, GjkResult &result)
+{
+	SimplexVertex vertex[EPA_VERTEX_MAX];
+	EpaFace face[EPA_FACE_MAX];
+	int edge[EPA_EDGE_MAX][2];
+	int faceNum = 0;
+
+	Simplex s = simplex;
+	if(!BlowUpSimplex(a, b, s))
+	{
+		return false;
+	}
+	for(int i=0; i<4; i++)
+	{
+		vertex[i] = s.v[i];
+	}
+	int vertexNum = 4;
+
+	// 面が外を向くように四面体の向きをそろえる
+	if((vertex[1].w - vertex[0].w).cross(vertex[2].w - vertex[0].w).dot(vertex[3].w - vertex[0].w) > 0.0f)
+	{
+		SimplexVertex temp = vertex[1];
+		vertex[1] = vertex[2];
+		vertex[2] = temp;
+	}
+	if(!AddEpaFace(face, faceNum, vertex, 0, 1, 2) || !AddEpaFace(face, faceNum, vertex, 0, 3, 1) ||
+		!AddEpaFace(face, faceNum, vertex, 0, 2, 3) || !AddEpaFace(face, faceNum, vertex, 1, 3, 2))
+	{
+		return false;
+	}
+
+	EpaFace *closest = NULL;
+	bool converged = false;
+	for(int iteration=0; iteration<EPA_ITERATION_MAX; iteration++)
+	{
+		result.iteration++;
+
+		// 原点に一番近い面
+		closest = NULL;
+		for(int i=0; i<faceNum; i++)
+		{
+			if(face[i].alive && (closest == NULL || face[i].dist < closest->dist))
+			{
+				closest = &face[i];
+			}
+		}
+		if(closest == NULL)
+		{
+			return false;
+		}
+
+		// その面の法線の向きにそれ以上広がらなければ終わり
+		SimplexVertex w = MakeVertex(a, b, closest->n, false);
+		float grow = closest->n.dot(w.w) - closest->dist;
+		if(grow <= GJK_TOLERANCE * (closest->dist > 1.0f ? closest->dist : 1.0f))
+		{
+			converged = true;
+			break;
+		}
+		if(vertexNum >= EPA_VERTEX_MAX)
+		{
+			break;
+		}
+
+		// 新しい頂点から見える面を消し、その境界の辺と新しい頂点で面を作る
+		int newIndex = vertexNum++;
+		vertex[newIndex] = w;
+		int edgeNum = 0;
+		for(int i=0; i<faceNum; i++)
+		{
+			if(!face[i].alive || face[i].n.dot(w.w - vertex[face[i].index[0]].w) <= 0.0f)
+			{
+				continue;
+			}
+			face[i].alive = false;
+			for(int j=0; j<3; j++)
+			{
+				int e0 = face[i].index[j];
+				int e1 = face[i].index[(j + 1) % 3];
+
+				// 隣の消した面と共有している辺は境界ではない
+				bool shared = false;
+				for(int k=0; k<edgeNum; k++)
+				{
+					if(edge[k][0] == e1 && edge[k][1] == e0)
+					{
+						edge[k][0] = edge[edgeNum - 1][0];
+						edge[k][1] = edge[edgeNum - 1][1];
+						edgeNum--;
+						shared = true;
+						break;
+					}
+				}
+				if(!shared && edgeNum < EPA_EDGE_MAX)
+				{
+					edge[edgeNum][0] = e0;
+					edge[edgeNum][1] = e1;
+					edgeNum++;
+				}
+			}
+		}
+
+		// 消した面の場所を詰めてから面を追加する
+		int aliveNum = 0;
+		for(int i=0; i<faceNum; i++)
+		{
+			if(face[i].alive)
+			{
+				face[aliveNum++] = face[i];
+			}
+		}
+		faceNum = aliveNum;
+		for(int i=0; i<edgeNum; i++)
+		{
+			AddEpaFace(face, faceNum, vertex, edge[i][0], edge[i][1], newIndex);
+		}
+		closest = NULL;
+	}
+	if(closest == NULL)
+	{
+		for(int i=0; i<faceNum; i++)
+		{
+			if(face[i].alive && (closest == NULL || face[i].dist < closest->dist))
+			{
+				closest = &face[i];
+			}
+		}
+		if(closest == NULL)
+		{
+			return false;
+		}
+	}
+
+	// 原点を面に投影した点の重心座標から、A と B の点を求める
+	const SimplexVertex &v0 = vertex[closest->index[0]];
+	const SimplexVertex &v1 = vertex[closest->index[1]];
+	const SimplexVertex &v2 = vertex[closest->index[2]];
+	Float3 p = closest->n * closest->dist;
+	float area0 = (v1.w - p).cross(v2.w - p).dot(closest->n);
+	float area1 = (v2.w - p).cross(v0.w - p).dot(closest->n);
+	float area2 = (v0.w - p).cross(v1.w - p).dot(closest->n);
+	float areaTotal = area0 + area1 + area2;
+	if(areaTotal <= 0.0f)
+	{
+		area0 = area1 = area2 = 1.0f;
+		areaTotal = 3.0f;
+	}
+	area0 /= areaTotal;
+	area1 /= areaTotal;
+	area2 /= areaTotal;
+
+	result.hit = true;
+	result.distance = -closest->dist;
+	result.pointA = v0.a * area0 + v1.a * area1 + v2.a * area2;
+	result.pointB = v0.b * area0 + v1.b * area1 + v2.b * area2;
+	result.normal = closest->n;
+
+	// 収束する前に多面体を広げられなくなった場合、面の向きは当てにならない
+	if(!converged)
+	{
+		GjkResult axisResult;
+		AxisPenetration(a, b, closest->n, result);
+		AxisPenetration(a, b, CenterAxis(a, b), axisResult);
+		if(axisResult.distance > result.distance)
+		{
+			result.pointA = axisResult.pointA;
+			result.pointB = axisResult.pointB;
+			result.distance = axisResult.distance;
+			result.normal = axisResult.normal;
+		}
+		result.hit = true;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+* @fn GjkDistance
+* @brief ２つの凸形状の距離かめり込み量を求める
+* @param[in] const Convex &a, const Convex &b
+* @param[out] GjkResult &result
+* @param[in,out] GjkCache *cache 前のフレームの探索方向( NULL なら使わない )
+* @return bool true:重なっている  false:離れている
+* @details 芯同士の距離を GJK で求めて厚みを引く、芯同士が重なっている時は厚みを含めた形で EPA を行う
+*          球とカプセル同士は芯が点か線分なので、芯同士が重なっていても EPA は使わず、中心同士を結ぶ向きに離す
+*/
+bool GjkDistance(const Convex &a, const Convex &b, GjkResult &result, GjkCache *cache)
+{
+	result.iteration = 0;
+
+	// 前のフレームの単体の探索方向で単体を作り直す、無ければ中心同士を結ぶ向きから始める
+	Simplex s;
+	s.num = 0;
+	if(cache != NULL)
+	{
+		for(int i=0; i<cache->num; i++)
+		{
+			SimplexVertex w = MakeVertex(a, b, cache->dir[i], true);
+			bool duplicate = false;
+			for(int j=0; j<s.num; j++)
+			{
+				if((s.v[j].w - w.w).lengthSq() <= GJK_EPSILON)
+				{
+					duplicate = true;
+				}
+			}
+			if(!duplicate)
+			{
+				s.v[s.num++] = w;
+			}
+		}
+	}
+	if(s.num == 0)
+	{
+		Vec3 d = b.supportCore(Vec3(0.0f, 0.0f, 0.0f)) - a.supportCore(Vec3(0.0f, 0.0f, 0.0f));
+		if(d.lengthSq() <= GJK_EPSILON)
+		{
+			d = Vec3(1.0f, 0.0f, 0.0f);
+		}
+		s.v[s.num++] = MakeVertex(a, b, d, true);
+	}
+
+	bool inside = false;
+	Float3 v = SolveSimplex(s, inside);
+	for(int iteration=0; iteration<GJK_ITERATION_MAX && !inside; iteration++)
+	{
+		result.iteration++;
+		float vLengthSq = v.lengthSq();
+		if(vLengthSq <= GJK_EPSILON)
+		{
+			inside = true;
+			break;
+		}
+
+		// 原点の向きに一番遠い点が今の単体より近づかなければ収束
+		Vec3 d = -v;
+		SimplexVertex w = MakeVertex(a, b, d, true);
+		if(vLengthSq - v.dot(w.w) <= GJK_TOLERANCE * vLengthSq)
+		{
+			break;
+		}
+		bool duplicate = false;
+		for(int i=0; i<s.num; i++)
+		{
+			if((s.v[i].w - w.w).lengthSq() <= GJK_EPSILON)
+			{
+				duplicate = true;
+			}
+		}
+		if(duplicate)
+		{
+			break;
+		}
+
+		s.v[s.num++] = w;
+		Float3 next = SolveSimplex(s, inside);
+		if(inside)
+		{
+			break;
+		}
+		if(next.lengthSq() >= vLengthSq)
+		{
+			break;
+		}
+		v = next;
+	}
+	if(cache != NULL)
+	{
+		for(int i=0; i<s.num; i++)
+		{
+			cache->dir[i] = s.v[i].d;
+		}
+		cache->num = s.num;
+	}
+
+	float marginA = a.margin();
+	float marginB = b.margin();
+	if(inside && IsRoundCore(a) && IsRoundCore(b))
+	{
+		// 芯の最近点同士がほぼ同じ位置なので、中心同士を結ぶ向きに厚みの分だけめり込んでいるとする
+		Float3 pointA(0.0f, 0.0f, 0.0f);
+		Float3 pointB(0.0f, 0.0f, 0.0f);
+		for(int i=0; i<s.num; i++)
+		{
+			pointA = pointA + s.v[i].a * s.bary[i];
+			pointB = pointB + s.v[i].b * s.bary[i];
+		}
+		Vec3 axis = pointB - pointA;
+		float coreDistance = axis.length();
+		result.normal = coreDistance > _OX_EPSILON_ ? Vec3(axis / coreDistance) : CenterAxis(a, b);
+		result.pointA = pointA + result.normal * marginA;
+		result.pointB = pointB - result.normal * marginB;
+		result.distance = coreDistance - marginA - marginB;
+		result.hit = true;
+		return true;
+	}
+	if(!inside)
+	{
+		// 芯同士の最近点から厚みの分だけ相手に近づける
+		Float3 pointA(0.0f, 0.0f, 0.0f);
+		Float3 pointB(0.0f, 0.0f, 0.0f);
+		for(int i=0; i<s.num; i++)
+		{
+			pointA = pointA + s.v[i].a * s.bary[i];
+			pointB = pointB + s.v[i].b * s.bary[i];
+		}
+		float coreDistance = v.length();
+		result.normal = -v / coreDistance;
+		result.pointA = pointA + result.normal * marginA;
+		result.pointB = pointB - result.normal * marginB;
+		result.distance = coreDistance - marginA - marginB;
+		result.hit = result.distance <= 0.0f;
+		return result.hit;
+	}
+
+	// 芯同士が重なっているので厚みを含めた形でめり込み量を求める
+	if(!Epa(a, b, s, result))
+	{
+		// A－B が潰れている( 面の無い形同士 )場合は、中心同士を結ぶ向きに離す
+		AxisPenetration(a, b, CenterAxis(a, b), result);
+		result.hit = true;
+	}
+	return true;
+}
@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include "Primitive.h"
+
+/**
+* @struct OBB
+* @brief 向きのある箱
+*/
+struct OBB {
+	Point p;		// 中心点
+	Vec3 axis[3];	// 各軸の向き( 単位ベクトル )
+	Float3 hl;		// 各軸の辺の長さの半分
+	OBB() {}
+	OBB( const Point &p, const Vec3 &axisX, const Vec3 &axisY, const Vec3 &axisZ, const Float3 &hl ) : p( p ), hl( hl ) {
+		axis[0] = axisX;
+		axis[1] = axisY;
+		axis[2] = axisZ;
+	}
+};
+
+/**
+* @struct Cylinder
+* @brief 円柱
+*/
+struct Cylinder {
+	Segment s;	// 底面の中心から上面の中心への線分
+	float r;	// 半径
+	Cylinder() : r( 0.5f ) {}
+	Cylinder( const Point &p1, const Point &p2, float r ) : s( p1, p2 ), r( r ) {}
+};
+
+/**
+* @struct ConvexHull
+* @brief 凸包( 頂点の配列は呼び出し側で持っておく )
+*/
+struct ConvexHull {
+	const Float3 *vertex;	// 頂点の配列( p からの相対座標 )
+	int vertexNum;			// 頂点の数
+	Point p;				// 位置
+	ConvexHull() : vertex( 0 ), vertexNum( 0 ), p( 0.0f, 0.0f, 0.0f ) {}
+	ConvexHull( const Float3 *vertex, int vertexNum, const Point &p ) : vertex( vertex ), vertexNum( vertexNum ), p( p ) {}
+};
+
+/**
+* @enum ConvexType
+* @brief Convex が指している形の種類
+*/
+enum ConvexType
+{
+	Convex_Sphere,
+	Convex_Capsule,
+	Convex_AABB,
+	Convex_OBB,
+	Convex_Cylinder,
+	Convex_Hull,
+};
+
+/**
+* @struct Convex
+* @brief GJK と EPA で扱う凸形状
+* @details 形そのものは呼び出し側で持ち、サポート写像( 指定の向きに一番遠い点 )だけを求める
+*          球とカプセルは中心の点、線分を芯にして、半径を厚みとして別に扱う
+*/
+struct Convex {
+	ConvexType type;
+	const void *shape;
+
+	Convex( const Sphere &s ) : type( Convex_Sphere ), shape( &s ) {}
+	Convex( const Capsule &c ) : type( Convex_Capsule ), shape( &c ) {}
+	Convex( const AABB &b ) : type( Convex_AABB ), shape( &b ) {}
+	Convex( const OBB &b ) : type( Convex_OBB ), shape( &b ) {}
+	Convex( const Cylinder &c ) : type( Convex_Cylinder ), shape( &c ) {}
+	Convex( const ConvexHull &h ) : type( Convex_Hull ), shape( &h ) {}
+
+	Float3 supportCore( const Vec3 &d ) const;	// 厚みを除いた芯の、d の向きに一番遠い点
+	float margin() const;						// 厚み
+	Float3 support( const Vec3 &d ) const;		// 厚みを含めた、d の向きに一番遠い点
+};
+
+/**
+* @struct GjkCache
+* @brief 前のフレームの単体を作った探索方向を覚えておき、次の探索の最初の単体に使う
+* @details 形が少し動いただけなら、同じ方向のサポート点で作った単体はほぼ最終的な単体になっている
+*/
+struct GjkCache {
+	Vec3 dir[4];	// 単体の各頂点を作った探索方向
+	int num;		// 単体の頂点の数( 0:使えない )
+	GjkCache() : num( 0 ) {}
+};
+
+/**
+* @struct GjkResult
+* @brief GJK / EPA の結果
+*/
+struct GjkResult {
+	bool hit;			// 重なっているか
+	float distance;		// 表面同士の距離( 重なっている場合は－めり込み量 )
+	Point pointA;		// A の上の最近点( 重なっている場合は B に一番深く入り込んだ点 )
+	Point pointB;		// B の上の最近点( 重なっている場合は A に一番深く入り込んだ点 )
+	Vec3 normal;		// A から B への向き( 単位ベクトル、B をこの向きに -distance だけ動かすと離れる )
+	int iteration;		// GJK と EPA の反復回数の合計
+};
+
+bool GjkDistance( const Convex &a, const Convex &b, GjkResult &result, GjkCache *cache );	//!< ２つの凸形状の距離かめり込み量を求める( 戻り値  true:重なっている  false:離れている )
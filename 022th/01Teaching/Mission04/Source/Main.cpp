@@ -1,7 +1,12 @@
 ﻿#include "DxLib.h"
 #include "Tree.h"
+#include "Foliage.h"
+#include "TreeGrid.h"
+#include "DebugDraw.h"
 #include "HitCheckType.h"
 #include "CheckKey.h"
+#include "PacketTest.h"
+#include "TextureCook.h"
 #include <cmath>
 /**
 * @file
@@ -26,11 +31,19 @@ const float PLAYER_COLLISION_HEIGHT = 90.0f;			//!< プレイヤーの当たり
 const float PLAYER_COLLISION_CAPSULE_RADIUS = 35.0f;	//!< プレイヤ－の当たり判定カプセルの半径
 const float PLAYER_COLLISION_CAPSULE_HEIGHT = 140.0f;	//!< プレイヤーの当たり判定カプセルの高さ
 const int   TREE_NUM = 4;								//!< 木の数
+const int   FOREST_TREE_NUM = 50000;					//!< 周りの森に生やす木の数
+const float FOREST_AREA_SIZE = 40000.0f;				//!< 周りの森の範囲( ラインを描く範囲の外側に生やす )
+const int   TREE_QUERY_MAX = TREE_NUM + FOREST_TREE_NUM;	//!< 一度に当たり判定の候補にする木の最大数( 同じ木は１回しか集めないので、全ての木の数にしておけば切り捨てられない )
+const float TREE_DRAW_COLLISION_DISTANCE = 3000.0f;		//!< プレイヤーからこの距離にある木だけ当たり判定を描画する
 const float CAMERA_ANGLE_SPEED = 3.0f;					//!< カメラの回転速度
 const float CAMERA_LOOK_AT_HEIGHT = 180.0f;				//!< カメラの注視点の高さ
 const float CAMERA_LOOK_AT_DISTANCE = 250.0f;			//!< カメラと注視点の距離
 const float LINE_AREA_SIZE = 10000.0f;					//!< ラインを描く範囲
 const int   LINE_NUM = 50;								//!< ラインの数
+const int   DEBUGDRAW_LINE_MAX = 65536;					//!< 確認用の図形としてためられる線の最大数
+const int   DEBUGDRAW_TRIANGLE_MAX = 16384;				//!< 確認用の図形としてためられる三角形の最大数
+const int   PACKETTEST_LOOP = 100000;						//!< -packettest でパケット版とスカラーの計算を比べる回数
+const unsigned int PACKETTEST_SEED = 20230106;			//!< -packettest で使う乱数の種
 
 /**
 * @enum Animation
@@ -59,6 +72,16 @@ const char* animationName[Animation::Length] = {
 */
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+	// -packettest を指定して起動した場合は、ウインドウを表示せずにパケット版の当たり判定をスカラーの計算と比べるだけにする
+	bool packetTest = strstr(lpCmdLine, "-packettest") != NULL;
+
+	// -cooktexture を指定して起動した場合は、ウインドウを表示せずにテクスチャをミップマップ付きの圧縮テクスチャ( DDS ファイル )にするだけにする
+	bool cookTexture = strstr(lpCmdLine, "-cooktexture") != NULL;
+	if(packetTest || cookTexture)
+	{
+		SetWindowVisibleFlag(false);
+	}
+
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
@@ -68,14 +91,31 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return -1;
 	}
 
+	if(packetTest)
+	{
+		int mismatchNum = RunPacketTest(PACKETTEST_LOOP, PACKETTEST_SEED);
+		DxLib_End();
+		return mismatchNum == 0 ? 0 : -1;
+	}
+
+	// 木はアルファを使うので BC3、キャラクターは BC1 にする
+	if(cookTexture)
+	{
+		bool treeResult = TextureCook_Cook("Resource/Tree.png", "Resource/Tree.dds", TEXTURECOOK_FORMAT_BC3);
+		bool heroResult = TextureCook_Cook("Resource/Hero.tga", "Resource/Hero.dds", TEXTURECOOK_FORMAT_BC1);
+		ErrorLogFmtAdd("cooktexture : Tree.dds %s  Hero.dds %s", treeResult ? "written" : "failed", heroResult ? "written" : "failed");
+		DxLib_End();
+		return treeResult && heroResult ? 0 : -1;
+	}
+
 	// 画像の読み込み
 	int graphHandle = LoadGraph("Resource/DxLogo.png");
 
-	// 画像の読み込み
-	int treeHandle = LoadGraph("Resource/Tree.png");
+	// 画像の読み込み( 元の画像より新しい DDS ファイルがあればそちらを読み込む )
+	int treeHandle = TextureCook_LoadGraph("Resource/Tree.png");
 
-	// 3Dモデルの読み込み
-	int modelHandle = MV1LoadModel("Resource/Hero.x");
+	// 3Dモデルの読み込み( テクスチャも元の画像より新しい DDS ファイルがあればそちらを読み込む )
+	int modelHandle = TextureCook_LoadModel("Resource/Hero.x", NULL);
 
 	// 3Dモデルのアニメーション番号を読み込む
 	int animationIndex[Animation::Length];			// アニメーション番号
@@ -120,12 +160,62 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// プレイヤーの座標を初期化
 	VECTOR position = VGet(0.0f, 0.0f, 0.0f);
 
-	// 木を用意する
-	Tree* treeList[TREE_NUM];
-	treeList[0] = new Tree(VGet(-750.0f, 0.0f, 0.0f), 1.0f, treeHandle);
-	treeList[1] = new Tree(VGet(750.0f, 0.0f, 0.0f), 3.0f, treeHandle);
-	treeList[2] = new Tree(VGet(-750.0f, 0.0f, 1500.0f), 6.0f, treeHandle);
-	treeList[3] = new Tree(VGet(750.0f, 0.0f, 1500.0f), 12.0f, treeHandle);
+	// 木の板ポリをまとめて描画する入れ物を用意する
+	Foliage foliage(treeHandle, TREE_NUM + FOREST_TREE_NUM);
+
+	// 木を用意する( 森の木も含めて１つの配列に並べる )
+	static Tree treeList[TREE_NUM + FOREST_TREE_NUM];
+	int treeNum = 0;
+	treeList[treeNum++] = Tree(VGet(-750.0f, 0.0f, 0.0f), 1.0f, &foliage);
+	treeList[treeNum++] = Tree(VGet(750.0f, 0.0f, 0.0f), 3.0f, &foliage);
+	treeList[treeNum++] = Tree(VGet(-750.0f, 0.0f, 1500.0f), 6.0f, &foliage);
+	treeList[treeNum++] = Tree(VGet(750.0f, 0.0f, 1500.0f), 12.0f, &foliage);
+
+	// ラインを描く範囲の外側に森を生やす
+	while(treeNum < TREE_NUM + FOREST_TREE_NUM)
+	{
+		float x = GetRand((int)FOREST_AREA_SIZE) - FOREST_AREA_SIZE / 2.0f;
+		float z = GetRand((int)FOREST_AREA_SIZE) - FOREST_AREA_SIZE / 2.0f;
+		if(fabsf(x) < LINE_AREA_SIZE / 2.0f && fabsf(z) < LINE_AREA_SIZE / 2.0f)
+		{
+			continue;
+		}
+		treeList[treeNum++] = Tree(VGet(x, 0.0f, z), 1.0f + GetRand(200) / 100.0f, &foliage);
+	}
+
+	// 当たり判定の候補を絞り込む格子を作る
+	TreeGrid treeGrid(treeList, treeNum);
+	static int treeQuery[TREE_QUERY_MAX];
+	int treeTestNum = 0;		// 最後に移動した時に当たり判定をした木の数
+
+	// 確認用の図形をまとめて描画する入れ物を用意する
+	DebugDraw debugDraw(DEBUGDRAW_LINE_MAX, DEBUGDRAW_TRIANGLE_MAX);
+
+	// 位置関係が分かるように地面に描くラインは変わらないので、頂点バッファに入れておく
+	debugDraw.BeginStatic();
+	{
+		VECTOR pos1;
+		VECTOR pos2;
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<=LINE_NUM; i++)
+		{
+			debugDraw.AddLine(pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.x += LINE_AREA_SIZE / LINE_NUM;
+			pos2.x += LINE_AREA_SIZE / LINE_NUM;
+		}
+
+		pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
+		for(int i=0; i<LINE_NUM; i++)
+		{
+			debugDraw.AddLine(pos1, pos2, GetColorU8(255, 255, 255, 255));
+			pos1.z += LINE_AREA_SIZE / LINE_NUM;
+			pos2.z += LINE_AREA_SIZE / LINE_NUM;
+		}
+	}
+	debugDraw.EndStatic();
 
 	// 当たり判定タイプ
 	HitCheckType hitCheckType = HitCheckType::Type_Sphere;
@@ -240,15 +330,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 			tempMoveVector.y = 0.0f;
 			tempMoveVector.z = moveVector.x * sinParam + moveVector.z * cosParam;
 
-			// 移動先の当たり判定
+			// 移動先の近くにある木だけ当たり判定をする
 			bool hitFlag = false;
-			for(int i=0; i<TREE_NUM; i++)
+			float queryRadius = PLAYER_COLLISION_SPHERE_RADIUS > PLAYER_COLLISION_CAPSULE_RADIUS ? PLAYER_COLLISION_SPHERE_RADIUS : PLAYER_COLLISION_CAPSULE_RADIUS;
+			int queryNum = treeGrid.Query(VAdd(position, tempMoveVector), queryRadius, treeQuery, TREE_QUERY_MAX);
+			treeTestNum = queryNum;
+			for(int j=0; j<queryNum; j++)
 			{
+				int i = treeQuery[j];
 				switch(hitCheckType)
 				{
 				// 球と球で当たり判定
 				case HitCheckType::Type_Sphere:
-					hitFlag = treeList[i]->CheckSphereToSphere(
+					hitFlag = treeList[i].CheckSphereToSphere(
 						VAdd(VAdd(position, tempMoveVector), VGet(0.0f, PLAYER_COLLISION_HEIGHT, 0.0f)),
 						PLAYER_COLLISION_SPHERE_RADIUS);
 					break;
@@ -260,7 +354,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 						Point(move.x, move.y + PLAYER_COLLISION_CAPSULE_RADIUS, move.z),
 						Point(move.x, move.y + PLAYER_COLLISION_CAPSULE_HEIGHT, move.z),
 						PLAYER_COLLISION_CAPSULE_RADIUS);
-					hitFlag = treeList[i]->CheckCapsuleToCapsule(capsule);
+					hitFlag = treeList[i].CheckCapsuleToCapsule(capsule);
 					break;
 				}
 
@@ -394,35 +488,44 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 			// 3Dモデルの描画
 			MV1DrawModel(modelHandle);
 
-			//当たり判定を半透明で描画
-			SetDrawBlendMode(DX_BLENDMODE_ALPHA, 128);
+			//当たり判定を半透明で描画( 確認用の図形としてためておく )
 			switch (hitCheckType)
 			{
 			// 球
 			case HitCheckType::Type_Sphere:
-				DrawSphere3D(
+				debugDraw.AddSphere(
 					VAdd(position, VGet(0.0f, PLAYER_COLLISION_HEIGHT, 0.0f)),
 					PLAYER_COLLISION_SPHERE_RADIUS,
-					8, GetColor(255, 255, 255), GetColor(255, 255, 255), false);
+					GetColorU8(255, 255, 255, 128), false);
 				break;
 
 			// カプセル
 			case HitCheckType::Type_Capsule:
-				DrawCapsule3D(
+				debugDraw.AddCapsule(
 					VAdd(position, VGet(0.0f, PLAYER_COLLISION_CAPSULE_RADIUS, 0.0f)),
 					VAdd(position, VGet(0.0f, PLAYER_COLLISION_CAPSULE_HEIGHT, 0.0f)),
 					PLAYER_COLLISION_CAPSULE_RADIUS,
-					8, GetColor(255, 255, 255), GetColor(255, 255, 255), false);
+					GetColorU8(255, 255, 255, 128), false);
 				break;
 			}
-			SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
 		}
 
 
-		// 木を描画
-		for(int i=0; i<TREE_NUM; i++)
+		// 全ての木をカメラからの距離に合わせた細かさでまとめて描画
+		foliage.Draw(GetCameraPosition());
+
+		// プレイヤーの近くにある木の当たり判定を描画
 		{
-			treeList[i]->Draw(hitCheckType);
+			int drawNum = treeGrid.Query(position, TREE_DRAW_COLLISION_DISTANCE, treeQuery, TREE_QUERY_MAX);
+			for(int j=0; j<drawNum; j++)
+			{
+				treeList[treeQuery[j]].Draw(hitCheckType, &debugDraw);
+			}
+			DrawFormatString(0, 0, GetColor(255, 255, 255), "tree %d rebuild %lldus (%d tree) cell %.0f test %d", foliage.GetTreeNum(), foliage.GetRebuildTime(), foliage.GetRebuildTreeNum(),
+				treeGrid.GetCellSize(), treeTestNum);
+			DrawFormatString(0, 20, GetColor(255, 255, 255), "full %d (%d poly) impostor %d (%d poly) culled %d",
+				foliage.GetLodTreeNum(Lod_Full), foliage.GetLodPolygonNum(Lod_Full),
+				foliage.GetLodTreeNum(Lod_Impostor), foliage.GetLodPolygonNum(Lod_Impostor), foliage.GetLodTreeNum(Lod_Culled));
 		}
 
 		// ビルボード
@@ -431,29 +534,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 			DrawBillboard3D(VAdd(position, VGet(0.0f, 250.0f, 0.0f)), 0.5f, 0.5f, 100.0f, 0.0f, graphHandle, true);
 		}
 
-		// 位置関係が分かるように地面にラインを描画する
-		{
-			VECTOR pos1;
-			VECTOR pos2;
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<=LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.x += LINE_AREA_SIZE / LINE_NUM;
-				pos2.x += LINE_AREA_SIZE / LINE_NUM;
-			}
-
-			pos1 = VGet(-LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			pos2 = VGet(LINE_AREA_SIZE / 2.0f, 0.0f, -LINE_AREA_SIZE / 2.0f);
-			for(int i=0; i<LINE_NUM; i++)
-			{
-				DrawLine3D(pos1, pos2, GetColor(255, 255, 255));
-				pos1.z += LINE_AREA_SIZE / LINE_NUM;
-				pos2.z += LINE_AREA_SIZE / LINE_NUM;
-			}
-		}
+		// 地面のラインと、ためておいた当たり判定をまとめて描画する
+		debugDraw.Flush();
+		DrawFormatString(0, 40, GetColor(255, 255, 255), "debug draw call %d line %d triangle %d",
+			debugDraw.GetDrawCallNum(), debugDraw.GetDrawLineNum(), debugDraw.GetDrawTriangleNum());
 
 		// 裏画面の内容を表画面に反映
 		ScreenFlip();
@@ -465,12 +549,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 	}
 
-	// 木の後始末
-	for(int i=0; i<TREE_NUM; i++)
-	{
-		delete treeList[i];
-		treeList[i] = NULL;
-	}
+	// 木と確認用の図形の頂点バッファの後始末( DXライブラリの後始末より前に行う )
+	foliage.Terminate();
+	debugDraw.Terminate();
 
 	// DXライブラリの後始末
 	DxLib_End();
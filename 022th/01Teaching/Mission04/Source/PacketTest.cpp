@@ -0,0 +1,625 @@
+﻿#include "DxLib.h"
+#include "PacketTest.h"
+#include "PrimitivePacket.h"
+/**
+* @file
+* @brief Mission04
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details PrimitivePacket.h の８個まとめ版、４個まとめ版の各演算と距離の関数を、
+*          同じ値をスカラーで計算した結果とランダムな値で比べて、一致しなかったものをログに出力する
+*          四則演算、比較、min、max、sqrt、select はスカラーの演算と完全に一致しなければならない
+*          距離の関数は、線分上の位置を数値的に探して求めた最短距離と誤差の範囲で比べる
+* @note 参考 C. Ericson "Real-Time Collision Detection" 5.1.9
+*/
+
+
+const float PACKETTEST_RANGE = 100.0f;			//!< ランダムな座標の範囲( -PACKETTEST_RANGE～PACKETTEST_RANGE )
+const float PACKETTEST_TOLERANCE = 0.0005f;		//!< 距離を比べる時の許容誤差( 座標の範囲に対する割合 )
+const int   PACKETTEST_LOGMAX = 32;				//!< 一致しなかったものをログに出力する最大数
+const int   PACKETTEST_SEARCHLOOP = 32;			//!< 比べる相手の最短距離を探す時に区間を縮める回数( 区間の幅は 0.618 倍ずつになり、32 回で 1/1000 万より狭くなる )
+const int   PACKETTEST_DISTANCEINTERVAL = 4;	//!< 距離の関数を比べる間隔( 探索に時間がかかるので、演算の比べる回数の何回に１回にするか )
+const double PACKETTEST_GOLDEN = 0.6180339887498949;	//!< 黄金分割探索で区間を縮める割合
+const float PACKETTEST_LONGSEGMENT = 1.0f;		//!< 最近点の位置を比べる線分の長さの２乗の下限( 短いと位置が少しずれても距離が変わらない )
+
+/**
+* @struct PacketTestState
+* @brief 比べた結果の集計
+*/
+struct PacketTestState {
+	unsigned int random;	// 乱数の状態
+	int checkNum;			// 比べた数
+	int mismatchNum;		// 一致しなかった数
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+* @fn RandomFloat
+* @brief 比べる値に使う乱数( xorshift )
+* @param[in] PacketTestState &state, float minValue, float maxValue
+* @return float minValue～maxValue の乱数
+*/
+static float RandomFloat(PacketTestState &state, float minValue, float maxValue)
+{
+	unsigned int x = state.random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	state.random = x;
+	return minValue + (maxValue - minValue) * ((x >> 8) * (1.0f / 16777216.0f));
+}
+
+/**
+* @fn RandomFloat3
+* @brief 各成分が -PACKETTEST_RANGE～PACKETTEST_RANGE の乱数
+* @param[in] PacketTestState &state
+* @return Float3
+*/
+static Float3 RandomFloat3(PacketTestState &state)
+{
+	float x = RandomFloat(state, -PACKETTEST_RANGE, PACKETTEST_RANGE);
+	float y = RandomFloat(state, -PACKETTEST_RANGE, PACKETTEST_RANGE);
+	float z = RandomFloat(state, -PACKETTEST_RANGE, PACKETTEST_RANGE);
+	return Float3(x, y, z);
+}
+
+/**
+* @fn RandomSegment
+* @brief 線分の乱数、長さが 0 のものと、other と平行なものも混ぜる
+* @param[in] PacketTestState &state, const Segment *other 平行にする相手( NULL の場合は平行にしない )
+* @return Segment
+*/
+static Segment RandomSegment(PacketTestState &state, const Segment *other)
+{
+	Point p = RandomFloat3(state);
+	float kind = RandomFloat(state, 0.0f, 1.0f);
+	if(kind < 0.125f)
+	{
+		return Segment(p, Vec3(0.0f, 0.0f, 0.0f));
+	}
+	if(other != NULL && kind < 0.25f)
+	{
+		// 同じ直線上に並ぶものも作る
+		if(kind < 0.1875f)
+		{
+			p = other->p + other->v * RandomFloat(state, -2.0f, 2.0f);
+		}
+		return Segment(p, Vec3(other->v * RandomFloat(state, -2.0f, 2.0f)));
+	}
+	return Segment(p, Vec3(RandomFloat3(state)));
+}
+
+/**
+* @fn CheckExact
+* @brief パケットの結果とスカラーの結果が完全に一致するか比べる
+* @param[in] PacketTestState &state, const char *name 比べた演算, int lane 何番目か, float packet, float scalar
+*/
+static void CheckExact(PacketTestState &state, const char *name, int lane, float packet, float scalar)
+{
+	state.checkNum++;
+	if(packet == scalar)
+	{
+		return;
+	}
+	if(state.mismatchNum < PACKETTEST_LOGMAX)
+	{
+		ErrorLogFmtAdd("packettest: %s lane %d  packet %.9g scalar %.9g", name, lane, packet, scalar);
+	}
+	state.mismatchNum++;
+}
+
+/**
+* @fn CheckNear
+* @brief パケットの結果と比べる相手の結果が誤差の範囲で一致するか比べる
+* @param[in] PacketTestState &state, const char *name 比べた演算, int lane 何番目か, float packet, float scalar, float tolerance
+*/
+static void CheckNear(PacketTestState &state, const char *name, int lane, float packet, float scalar, float tolerance)
+{
+	state.checkNum++;
+	if(fabsf(packet - scalar) <= tolerance)
+	{
+		return;
+	}
+	if(state.mismatchNum < PACKETTEST_LOGMAX)
+	{
+		ErrorLogFmtAdd("packettest: %s lane %d  packet %.9g scalar %.9g", name, lane, packet, scalar);
+	}
+	state.mismatchNum++;
+}
+
+//---------------------------------------------------------------------------------
+// 比べる相手の最短距離
+//  Tree の距離の関数は課題なので、式を解いて求める代わりに、線分上の位置を黄金分割探索で探して求める
+//  距離の２乗は線分上の位置について下に凸なので、探索で最小値にたどり着ける
+
+/**
+* @struct SearchSegment
+* @brief 探索に使う線分( 誤差を減らすため double で持つ )
+*/
+struct SearchSegment {
+	double p[3];	// 始点
+	double v[3];	// 始点から終点へのベクトル
+};
+
+/**
+* @fn ToSearchSegment
+* @brief 線分を探索に使う形にする
+* @param[in] const Segment &seg
+* @return SearchSegment
+*/
+static SearchSegment ToSearchSegment(const Segment &seg)
+{
+	SearchSegment out;
+	out.p[0] = seg.p.x;
+	out.p[1] = seg.p.y;
+	out.p[2] = seg.p.z;
+	out.v[0] = seg.v.x;
+	out.v[1] = seg.v.y;
+	out.v[2] = seg.v.z;
+	return out;
+}
+
+/**
+* @fn GetSearchPoint
+* @brief 線分上の位置の座標
+* @param[in] const SearchSegment &seg, double t 位置( 0～1 )
+* @param[out] double *point 座標( ３成分 )
+*/
+static void GetSearchPoint(const SearchSegment &seg, double t, double *point)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		point[i] = seg.p[i] + seg.v[i] * t;
+	}
+}
+
+/**
+* @fn SearchPointSegmentDistSq
+* @brief 点と線分の最短距離の２乗を探す
+* @param[in] const double *point 点( ３成分 ), const SearchSegment &seg
+* @param[out] double &t 線分上の最近点の位置( 0～1 )
+* @return double 距離の２乗
+*/
+static double SearchPointSegmentDistSq(const double *point, const SearchSegment &seg, double &t)
+{
+	double lo = 0.0;
+	double hi = 1.0;
+	double x[2];
+	double f[2];
+	x[0] = hi - PACKETTEST_GOLDEN * (hi - lo);
+	x[1] = lo + PACKETTEST_GOLDEN * (hi - lo);
+	for(int k = 0; k < 2; k++)
+	{
+		double h[3];
+		GetSearchPoint(seg, x[k], h);
+		f[k] = (h[0] - point[0]) * (h[0] - point[0]) + (h[1] - point[1]) * (h[1] - point[1]) + (h[2] - point[2]) * (h[2] - point[2]);
+	}
+	for(int loop = 0; loop < PACKETTEST_SEARCHLOOP; loop++)
+	{
+		// 小さい方を含む側に区間を縮めて、新しい点を１つだけ計算する
+		int k;
+		if(f[0] <= f[1])
+		{
+			hi = x[1];
+			x[1] = x[0];
+			f[1] = f[0];
+			x[0] = hi - PACKETTEST_GOLDEN * (hi - lo);
+			k = 0;
+		}
+		else
+		{
+			lo = x[0];
+			x[0] = x[1];
+			f[0] = f[1];
+			x[1] = lo + PACKETTEST_GOLDEN * (hi - lo);
+			k = 1;
+		}
+		double h[3];
+		GetSearchPoint(seg, x[k], h);
+		f[k] = (h[0] - point[0]) * (h[0] - point[0]) + (h[1] - point[1]) * (h[1] - point[1]) + (h[2] - point[2]) * (h[2] - point[2]);
+	}
+	t = f[0] <= f[1] ? x[0] : x[1];
+	return f[0] <= f[1] ? f[0] : f[1];
+}
+
+/**
+* @fn SearchSegmentSegmentDist
+* @brief 2線分の最短距離を探す
+* @param[in] const SearchSegment &s1, const SearchSegment &s2
+* @param[out] double &t1, double &t2 それぞれの線分上の最近点の位置( 0～1 )
+* @return double 距離
+* @details s1 上の位置ごとに s2 との最短距離を探し、それが最も小さくなる s1 上の位置を探す
+*/
+static double SearchSegmentSegmentDist(const SearchSegment &s1, const SearchSegment &s2, double &t1, double &t2)
+{
+	double lo = 0.0;
+	double hi = 1.0;
+	double x[2];
+	double f[2];
+	double t[2];
+	x[0] = hi - PACKETTEST_GOLDEN * (hi - lo);
+	x[1] = lo + PACKETTEST_GOLDEN * (hi - lo);
+	for(int k = 0; k < 2; k++)
+	{
+		double p1[3];
+		GetSearchPoint(s1, x[k], p1);
+		f[k] = SearchPointSegmentDistSq(p1, s2, t[k]);
+	}
+	for(int loop = 0; loop < PACKETTEST_SEARCHLOOP; loop++)
+	{
+		int k;
+		if(f[0] <= f[1])
+		{
+			hi = x[1];
+			x[1] = x[0];
+			f[1] = f[0];
+			t[1] = t[0];
+			x[0] = hi - PACKETTEST_GOLDEN * (hi - lo);
+			k = 0;
+		}
+		else
+		{
+			lo = x[0];
+			x[0] = x[1];
+			f[0] = f[1];
+			t[0] = t[1];
+			x[1] = lo + PACKETTEST_GOLDEN * (hi - lo);
+			k = 1;
+		}
+		double p1[3];
+		GetSearchPoint(s1, x[k], p1);
+		f[k] = SearchPointSegmentDistSq(p1, s2, t[k]);
+	}
+	int best = f[0] <= f[1] ? 0 : 1;
+	t1 = x[best];
+	t2 = t[best];
+	return sqrt(f[best]);
+}
+
+/**
+* @fn Clamp01
+* @brief 0～1の間にクランプ
+* @param[in,out] float &v
+*/
+static void Clamp01(float &v)
+{
+	if(v < 0.0f)
+	{
+		v = 0.0f;
+	}
+	else if(v > 1.0f)
+	{
+		v = 1.0f;
+	}
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+* @fn TestFloat8
+* @brief Float8 、 Mask8 の各演算をスカラーの演算と比べる
+* @param[in] PacketTestState &state
+*/
+static void TestFloat8(PacketTestState &state)
+{
+	Float8 a, b, c;
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		a.f[i] = RandomFloat(state, -2.0f, 2.0f);
+		b.f[i] = RandomFloat(state, -2.0f, 2.0f);
+		c.f[i] = RandomFloat(state, 0.0f, 4.0f);
+	}
+
+	// 比較が等しい場合も確かめる
+	b.f[0] = a.f[0];
+
+	Float8 add = a + b;
+	Float8 sub = a - b;
+	Float8 mul = a * b;
+	Float8 div = a / (c + Float8(1.0f));
+	Float8 minValue = min8(a, b);
+	Float8 maxValue = max8(a, b);
+	Float8 root = sqrt8(c);
+	Float8 clamp = a.clamp01();
+	Mask8 less = a < b;
+	Mask8 lessEqual = a <= b;
+	Mask8 greater = a > b;
+	Float8 select = select8(less, a, b);
+	int andBits = (less & greater).bits();
+	int orBits = (less | greater).bits();
+
+	int lessBits = 0;
+	int lessEqualBits = 0;
+	int greaterBits = 0;
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		float ai = a.f[i];
+		float bi = b.f[i];
+		float clampValue = ai;
+		Clamp01(clampValue);
+		CheckExact(state, "Float8 +", i, add.f[i], ai + bi);
+		CheckExact(state, "Float8 -", i, sub.f[i], ai - bi);
+		CheckExact(state, "Float8 *", i, mul.f[i], ai * bi);
+		CheckExact(state, "Float8 /", i, div.f[i], ai / (c.f[i] + 1.0f));
+		CheckExact(state, "min8", i, minValue.f[i], ai < bi ? ai : bi);
+		CheckExact(state, "max8", i, maxValue.f[i], ai > bi ? ai : bi);
+		CheckExact(state, "sqrt8", i, root.f[i], sqrtf(c.f[i]));
+		CheckExact(state, "Float8 clamp01", i, clamp.f[i], clampValue);
+		CheckExact(state, "select8", i, select.f[i], ai < bi ? ai : bi);
+		lessBits |= (ai < bi) << i;
+		lessEqualBits |= (ai <= bi) << i;
+		greaterBits |= (ai > bi) << i;
+	}
+	CheckExact(state, "Float8 <", 0, (float)less.bits(), (float)lessBits);
+	CheckExact(state, "Float8 <=", 0, (float)lessEqual.bits(), (float)lessEqualBits);
+	CheckExact(state, "Float8 >", 0, (float)greater.bits(), (float)greaterBits);
+	CheckExact(state, "Mask8 &", 0, (float)andBits, (float)(lessBits & greaterBits));
+	CheckExact(state, "Mask8 |", 0, (float)orBits, (float)(lessBits | greaterBits));
+}
+
+/**
+* @fn TestFloat4
+* @brief Float4 、 Mask4 の各演算をスカラーの演算と比べる
+* @param[in] PacketTestState &state
+*/
+static void TestFloat4(PacketTestState &state)
+{
+	Float4 a, b, c;
+	for(int i = 0; i < PACKET4_SIZE; i++)
+	{
+		a.f[i] = RandomFloat(state, -2.0f, 2.0f);
+		b.f[i] = RandomFloat(state, -2.0f, 2.0f);
+		c.f[i] = RandomFloat(state, 0.0f, 4.0f);
+	}
+
+	// 比較が等しい場合も確かめる
+	b.f[0] = a.f[0];
+
+	Float4 add = a + b;
+	Float4 sub = a - b;
+	Float4 mul = a * b;
+	Float4 div = a / (c + Float4(1.0f));
+	Float4 minValue = min4(a, b);
+	Float4 maxValue = max4(a, b);
+	Float4 root = sqrt4(c);
+	Float4 clamp = a.clamp01();
+	Mask4 less = a < b;
+	Mask4 lessEqual = a <= b;
+	Mask4 greater = a > b;
+	Float4 select = select4(less, a, b);
+	int andBits = (less & greater).bits();
+	int orBits = (less | greater).bits();
+
+	int lessBits = 0;
+	int lessEqualBits = 0;
+	int greaterBits = 0;
+	for(int i = 0; i < PACKET4_SIZE; i++)
+	{
+		float ai = a.f[i];
+		float bi = b.f[i];
+		float clampValue = ai;
+		Clamp01(clampValue);
+		CheckExact(state, "Float4 +", i, add.f[i], ai + bi);
+		CheckExact(state, "Float4 -", i, sub.f[i], ai - bi);
+		CheckExact(state, "Float4 *", i, mul.f[i], ai * bi);
+		CheckExact(state, "Float4 /", i, div.f[i], ai / (c.f[i] + 1.0f));
+		CheckExact(state, "min4", i, minValue.f[i], ai < bi ? ai : bi);
+		CheckExact(state, "max4", i, maxValue.f[i], ai > bi ? ai : bi);
+		CheckExact(state, "sqrt4", i, root.f[i], sqrtf(c.f[i]));
+		CheckExact(state, "Float4 clamp01", i, clamp.f[i], clampValue);
+		CheckExact(state, "select4", i, select.f[i], ai < bi ? ai : bi);
+		lessBits |= (ai < bi) << i;
+		lessEqualBits |= (ai <= bi) << i;
+		greaterBits |= (ai > bi) << i;
+	}
+	CheckExact(state, "Float4 <", 0, (float)less.bits(), (float)lessBits);
+	CheckExact(state, "Float4 <=", 0, (float)lessEqual.bits(), (float)lessEqualBits);
+	CheckExact(state, "Float4 >", 0, (float)greater.bits(), (float)greaterBits);
+	CheckExact(state, "Mask4 &", 0, (float)andBits, (float)(lessBits & greaterBits));
+	CheckExact(state, "Mask4 |", 0, (float)orBits, (float)(lessBits | greaterBits));
+}
+
+/**
+* @fn TestFloat3x8
+* @brief Float3x8 と Float3x4 の各演算を Float3 と比べる
+* @param[in] PacketTestState &state
+*/
+static void TestFloat3x8(PacketTestState &state)
+{
+	Float3 a[PACKET_SIZE];
+	Float3 b[PACKET_SIZE];
+	Float8 s;
+	Float3x8 a8, b8;
+	Float3x4 a4, b4;
+	Float4 s4;
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		a[i] = RandomFloat3(state);
+		b[i] = RandomFloat3(state);
+		s.f[i] = RandomFloat(state, -2.0f, 2.0f);
+		a8.set(i, a[i]);
+		b8.set(i, b[i]);
+		if(i < PACKET4_SIZE)
+		{
+			a4.set(i, a[i]);
+			b4.set(i, b[i]);
+			s4.f[i] = s.f[i];
+		}
+	}
+
+	Float3x8 add = a8 + b8;
+	Float3x8 sub = a8 - b8;
+	Float3x8 mul = a8 * s;
+	Float8 dot = a8.dot(b8);
+	Float8 lengthSq = a8.lengthSq();
+	Float3x4 add4 = a4 + b4;
+	Float3x4 sub4 = a4 - b4;
+	Float3x4 mul4 = a4 * s4;
+	Float4 dot4 = a4.dot(b4);
+	Float4 lengthSq4 = a4.lengthSq();
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		Float3 get = a8.get(i);
+		Float3 addValue = a[i] + b[i];
+		Float3 subValue = a[i] - b[i];
+		Float3 mulValue = a[i] * s.f[i];
+		CheckExact(state, "Float3x8 get", i, get.x + get.y * 2.0f + get.z * 4.0f, a[i].x + a[i].y * 2.0f + a[i].z * 4.0f);
+		CheckExact(state, "Float3x8 + x", i, add.x.f[i], addValue.x);
+		CheckExact(state, "Float3x8 + y", i, add.y.f[i], addValue.y);
+		CheckExact(state, "Float3x8 + z", i, add.z.f[i], addValue.z);
+		CheckExact(state, "Float3x8 - x", i, sub.x.f[i], subValue.x);
+		CheckExact(state, "Float3x8 - y", i, sub.y.f[i], subValue.y);
+		CheckExact(state, "Float3x8 - z", i, sub.z.f[i], subValue.z);
+		CheckExact(state, "Float3x8 * x", i, mul.x.f[i], mulValue.x);
+		CheckExact(state, "Float3x8 * y", i, mul.y.f[i], mulValue.y);
+		CheckExact(state, "Float3x8 * z", i, mul.z.f[i], mulValue.z);
+		CheckExact(state, "Float3x8 dot", i, dot.f[i], a[i].dot(b[i]));
+		CheckExact(state, "Float3x8 lengthSq", i, lengthSq.f[i], a[i].lengthSq());
+		if(i < PACKET4_SIZE)
+		{
+			Float3 get4 = a4.get(i);
+			CheckExact(state, "Float3x4 get", i, get4.x + get4.y * 2.0f + get4.z * 4.0f, a[i].x + a[i].y * 2.0f + a[i].z * 4.0f);
+			CheckExact(state, "Float3x4 + x", i, add4.x.f[i], addValue.x);
+			CheckExact(state, "Float3x4 + y", i, add4.y.f[i], addValue.y);
+			CheckExact(state, "Float3x4 + z", i, add4.z.f[i], addValue.z);
+			CheckExact(state, "Float3x4 - x", i, sub4.x.f[i], subValue.x);
+			CheckExact(state, "Float3x4 - y", i, sub4.y.f[i], subValue.y);
+			CheckExact(state, "Float3x4 - z", i, sub4.z.f[i], subValue.z);
+			CheckExact(state, "Float3x4 * x", i, mul4.x.f[i], mulValue.x);
+			CheckExact(state, "Float3x4 * y", i, mul4.y.f[i], mulValue.y);
+			CheckExact(state, "Float3x4 * z", i, mul4.z.f[i], mulValue.z);
+			CheckExact(state, "Float3x4 dot", i, dot4.f[i], a[i].dot(b[i]));
+			CheckExact(state, "Float3x4 lengthSq", i, lengthSq4.f[i], a[i].lengthSq());
+		}
+	}
+}
+
+/**
+* @fn TestDistance8
+* @brief ８個まとめ版と４個まとめ版の距離の関数を、数値的に探した最短距離と比べる
+* @param[in] PacketTestState &state
+* @details 平行な線分同士は最近点が一つに決まらないので、位置は比べずに、返した位置の点同士の距離が返した距離と一致するかを調べる
+*          ４個まとめ版は同じ線分を前半と後半に分けて計算する
+*/
+static void TestDistance8(PacketTestState &state)
+{
+	const float tolerance = PACKETTEST_RANGE * PACKETTEST_TOLERANCE;
+	Point p[PACKET_SIZE];
+	Capsule c1[PACKET_SIZE];
+	Capsule c2[PACKET_SIZE];
+	Float3x8 p8;
+	Capsule8 c1x8, c2x8;
+	Float3x4 p4[2];
+	Capsule4 c1x4[2], c2x4[2];
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		p[i] = RandomFloat3(state);
+		c1[i] = Capsule(RandomSegment(state, NULL), RandomFloat(state, 0.0f, PACKETTEST_RANGE * 0.5f));
+		c2[i] = Capsule(RandomSegment(state, &c1[i].s), RandomFloat(state, 0.0f, PACKETTEST_RANGE * 0.5f));
+		p8.set(i, p[i]);
+		c1x8.set(i, c1[i]);
+		c2x8.set(i, c2[i]);
+		p4[i / PACKET4_SIZE].set(i % PACKET4_SIZE, p[i]);
+		c1x4[i / PACKET4_SIZE].set(i % PACKET4_SIZE, c1[i]);
+		c2x4[i / PACKET4_SIZE].set(i % PACKET4_SIZE, c2[i]);
+	}
+
+	Float8 pointT, t1, t2;
+	Float8 pointDist = CalcPointSegmentDist8(p8, c1x8.s, pointT);
+	Float8 segmentDist = CalcSegmentSegmentDist8(c1x8.s, c2x8.s, t1, t2);
+	Float8 capsuleDist = CalcCapsuleCapsuleDist8(c1x8, c2x8);
+	int hitBits = CheckCapsuleCapsule8(c1x8, c2x8);
+
+	Float4 pointT4[2], t1x4[2], t2x4[2], pointDist4[2], segmentDist4[2], capsuleDist4[2];
+	int hitBits4 = 0;
+	for(int j = 0; j < 2; j++)
+	{
+		pointDist4[j] = CalcPointSegmentDist4(p4[j], c1x4[j].s, pointT4[j]);
+		segmentDist4[j] = CalcSegmentSegmentDist4(c1x4[j].s, c2x4[j].s, t1x4[j], t2x4[j]);
+		capsuleDist4[j] = CalcCapsuleCapsuleDist4(c1x4[j], c2x4[j]);
+		hitBits4 |= CheckCapsuleCapsule4(c1x4[j], c2x4[j]) << (j * PACKET4_SIZE);
+	}
+
+	for(int i = 0; i < PACKET_SIZE; i++)
+	{
+		int half = i / PACKET4_SIZE;
+		int lane = i % PACKET4_SIZE;
+		SearchSegment s1 = ToSearchSegment(c1[i].s);
+		SearchSegment s2 = ToSearchSegment(c2[i].s);
+		bool long1 = c1[i].s.v.lengthSq() > PACKETTEST_LONGSEGMENT;
+
+		// 点と線分
+		double point[3] = { p[i].x, p[i].y, p[i].z };
+		double t;
+		float dist = (float)sqrt(SearchPointSegmentDistSq(point, s1, t));
+		CheckNear(state, "CalcPointSegmentDist8", i, pointDist.f[i], dist, tolerance);
+		CheckNear(state, "CalcPointSegmentDist4", i, pointDist4[half].f[lane], dist, tolerance);
+		if(long1)
+		{
+			CheckNear(state, "CalcPointSegmentDist8 t", i, pointT.f[i], (float)t, PACKETTEST_TOLERANCE);
+			CheckNear(state, "CalcPointSegmentDist4 t", i, pointT4[half].f[lane], (float)t, PACKETTEST_TOLERANCE);
+		}
+
+		// 線分と線分
+		double searchT1, searchT2;
+		dist = (float)SearchSegmentSegmentDist(s1, s2, searchT1, searchT2);
+		CheckNear(state, "CalcSegmentSegmentDist8", i, segmentDist.f[i], dist, tolerance);
+		CheckNear(state, "CalcSegmentSegmentDist4", i, segmentDist4[half].f[lane], dist, tolerance);
+		CheckNear(state, "CalcSegmentSegmentDist8 t1", i, t1.f[i], t1.clamp01().f[i], 0.0f);
+		CheckNear(state, "CalcSegmentSegmentDist8 t2", i, t2.f[i], t2.clamp01().f[i], 0.0f);
+		Point q1 = c1[i].s.getPoint(t1.f[i]);
+		Point q2 = c2[i].s.getPoint(t2.f[i]);
+		CheckNear(state, "CalcSegmentSegmentDist8 point", i, (q2 - q1).length(), segmentDist.f[i], tolerance);
+		q1 = c1[i].s.getPoint(t1x4[half].f[lane]);
+		q2 = c2[i].s.getPoint(t2x4[half].f[lane]);
+		CheckNear(state, "CalcSegmentSegmentDist4 point", i, (q2 - q1).length(), segmentDist4[half].f[lane], tolerance);
+
+		// カプセルとカプセル( 当たりの境目の誤差の範囲にあるものは当たりを比べない )
+		float capsule = dist - c1[i].r - c2[i].r;
+		CheckNear(state, "CalcCapsuleCapsuleDist8", i, capsuleDist.f[i], capsule, tolerance);
+		CheckNear(state, "CalcCapsuleCapsuleDist4", i, capsuleDist4[half].f[lane], capsule, tolerance);
+		if(fabsf(capsule) > tolerance)
+		{
+			CheckExact(state, "CheckCapsuleCapsule8", i, (float)((hitBits >> i) & 1), capsule <= 0.0f ? 1.0f : 0.0f);
+			CheckExact(state, "CheckCapsuleCapsule4", i, (float)((hitBits4 >> i) & 1), capsule <= 0.0f ? 1.0f : 0.0f);
+		}
+	}
+}
+
+/**
+* @fn RunPacketTest
+* @brief PrimitivePacket.h の各演算と距離の関数をスカラーの計算とランダムな値で比べる
+* @param[in] int loopNum 比べる回数( １回で各演算をパケット１つ分ずつ、PACKETTEST_DISTANCEINTERVAL 回に１回距離の関数を比べる ), unsigned int seed 乱数の種
+* @return int 一致しなかった数
+* @details 一致しなかったものは最初の PACKETTEST_LOGMAX 個だけ、最後に集計を Log.txt に出力する
+*/
+int RunPacketTest(int loopNum, unsigned int seed)
+{
+	PacketTestState state;
+	state.random = seed != 0 ? seed : 1;
+	state.checkNum = 0;
+	state.mismatchNum = 0;
+
+	for(int i = 0; i < loopNum; i++)
+	{
+		TestFloat8(state);
+		TestFloat4(state);
+		TestFloat3x8(state);
+		if(i % PACKETTEST_DISTANCEINTERVAL == 0)
+		{
+			TestDistance8(state);
+		}
+	}
+
+#if defined( PRIMITIVE_PACKET_AVX2 )
+	const char *backend = "AVX2";
+#elif defined( PRIMITIVE_PACKET_SSE )
+	const char *backend = "SSE2";
+#else
+	const char *backend = "scalar";
+#endif
+	ErrorLogFmtAdd("packettest: backend %s  loop %d  check %d  mismatch %d", backend, loopNum, state.checkNum, state.mismatchNum);
+	return state.mismatchNum;
+}
@@ -0,0 +1,3 @@
+﻿#pragma once
+
+int RunPacketTest(int loopNum, unsigned int seed);	//!< PrimitivePacket.h の各演算と距離の関数をスカラーの計算とランダムな値で比べる( 戻り値 : 一致しなかった数 )
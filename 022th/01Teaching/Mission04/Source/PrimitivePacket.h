@@ -0,0 +1,487 @@
+﻿#ifndef __PRIMITIVE_PACKET_H__
+#define __PRIMITIVE_PACKET_H__
+
+
+// プリミティブ定義の８個まとめ版
+//  Primitive.h の点、線分、カプセルを８個ずつ成分ごとの配列( SoA )にまとめて、
+//  ８組の距離を１回の呼び出しで求める
+//  AVX2 が使える場合は 256bit 、SSE2 が使える場合は 128bit×２ の命令で計算する
+//  ４個まとめ版の Float4 、 Float3x4 、 Capsule4 は SSE2 か AVX2 が使える場合は 128bit の命令で計算する
+//  ( AVX2 が使えない環境で、当たり判定の候補が少ない時に使う )
+//  PRIMITIVE_PACKET_NO_SIMD を定義すると SIMD 命令を使わない
+//  各演算と距離の関数は -packettest を指定して起動すると、スカラーの演算と数値的に探した最短距離と比べられる( PacketTest.cpp )
+
+
+#include "Primitive.h"
+
+#if !defined( PRIMITIVE_PACKET_NO_SIMD ) && defined( __AVX2__ )
+#define PRIMITIVE_PACKET_AVX2
+#include <immintrin.h>
+#elif !defined( PRIMITIVE_PACKET_NO_SIMD ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+#define PRIMITIVE_PACKET_SSE
+#include <emmintrin.h>
+#endif
+
+const int PACKET_SIZE = 8;						//!< １つのパケットにまとめる数
+const int PACKET4_SIZE = 4;						//!< ４個まとめ版のパケットにまとめる数
+
+/**
+* @struct Mask8
+* @brief ８個分の比較結果
+*/
+struct Mask8 {
+#if defined( PRIMITIVE_PACKET_AVX2 )
+	__m256 v;
+	Mask8( __m256 v ) : v( v ) {}
+	Mask8 operator &( const Mask8 &r ) const { return Mask8( _mm256_and_ps( v, r.v ) ); }
+	Mask8 operator |( const Mask8 &r ) const { return Mask8( _mm256_or_ps( v, r.v ) ); }
+	int bits() const { return _mm256_movemask_ps( v ); }
+#elif defined( PRIMITIVE_PACKET_SSE )
+	__m128 lo, hi;
+	Mask8( __m128 lo, __m128 hi ) : lo( lo ), hi( hi ) {}
+	Mask8 operator &( const Mask8 &r ) const { return Mask8( _mm_and_ps( lo, r.lo ), _mm_and_ps( hi, r.hi ) ); }
+	Mask8 operator |( const Mask8 &r ) const { return Mask8( _mm_or_ps( lo, r.lo ), _mm_or_ps( hi, r.hi ) ); }
+	int bits() const { return _mm_movemask_ps( lo ) | ( _mm_movemask_ps( hi ) << 4 ); }
+#else
+	int m;
+	Mask8( int m ) : m( m ) {}
+	Mask8 operator &( const Mask8 &r ) const { return Mask8( m & r.m ); }
+	Mask8 operator |( const Mask8 &r ) const { return Mask8( m | r.m ); }
+	int bits() const { return m; }
+#endif
+};
+
+/**
+* @struct Float8
+* @brief ８個分のfloat
+*/
+struct Float8 {
+#if defined( PRIMITIVE_PACKET_AVX2 )
+	union {
+		__m256 v;
+		float f[PACKET_SIZE];
+	};
+	Float8() {}
+	Float8( __m256 v ) : v( v ) {}
+	Float8( float s ) : v( _mm256_set1_ps( s ) ) {}
+
+	Float8 operator +( const Float8 &r ) const { return Float8( _mm256_add_ps( v, r.v ) ); }
+	Float8 operator -( const Float8 &r ) const { return Float8( _mm256_sub_ps( v, r.v ) ); }
+	Float8 operator *( const Float8 &r ) const { return Float8( _mm256_mul_ps( v, r.v ) ); }
+	Float8 operator /( const Float8 &r ) const { return Float8( _mm256_div_ps( v, r.v ) ); }
+	Mask8 operator <( const Float8 &r ) const { return Mask8( _mm256_cmp_ps( v, r.v, _CMP_LT_OQ ) ); }
+	Mask8 operator <=( const Float8 &r ) const { return Mask8( _mm256_cmp_ps( v, r.v, _CMP_LE_OQ ) ); }
+	Mask8 operator >( const Float8 &r ) const { return Mask8( _mm256_cmp_ps( v, r.v, _CMP_GT_OQ ) ); }
+
+	friend Float8 min8( const Float8 &l, const Float8 &r ) { return Float8( _mm256_min_ps( l.v, r.v ) ); }
+	friend Float8 max8( const Float8 &l, const Float8 &r ) { return Float8( _mm256_max_ps( l.v, r.v ) ); }
+	friend Float8 sqrt8( const Float8 &r ) { return Float8( _mm256_sqrt_ps( r.v ) ); }
+	// mask が立っている所は t 、それ以外は f
+	friend Float8 select8( const Mask8 &mask, const Float8 &t, const Float8 &f ) { return Float8( _mm256_blendv_ps( f.v, t.v, mask.v ) ); }
+#elif defined( PRIMITIVE_PACKET_SSE )
+	union {
+		__m128 v[2];
+		float f[PACKET_SIZE];
+	};
+	Float8() {}
+	Float8( __m128 lo, __m128 hi ) { v[0] = lo; v[1] = hi; }
+	Float8( float s ) { v[0] = v[1] = _mm_set1_ps( s ); }
+
+	Float8 operator +( const Float8 &r ) const { return Float8( _mm_add_ps( v[0], r.v[0] ), _mm_add_ps( v[1], r.v[1] ) ); }
+	Float8 operator -( const Float8 &r ) const { return Float8( _mm_sub_ps( v[0], r.v[0] ), _mm_sub_ps( v[1], r.v[1] ) ); }
+	Float8 operator *( const Float8 &r ) const { return Float8( _mm_mul_ps( v[0], r.v[0] ), _mm_mul_ps( v[1], r.v[1] ) ); }
+	Float8 operator /( const Float8 &r ) const { return Float8( _mm_div_ps( v[0], r.v[0] ), _mm_div_ps( v[1], r.v[1] ) ); }
+	Mask8 operator <( const Float8 &r ) const { return Mask8( _mm_cmplt_ps( v[0], r.v[0] ), _mm_cmplt_ps( v[1], r.v[1] ) ); }
+	Mask8 operator <=( const Float8 &r ) const { return Mask8( _mm_cmple_ps( v[0], r.v[0] ), _mm_cmple_ps( v[1], r.v[1] ) ); }
+	Mask8 operator >( const Float8 &r ) const { return Mask8( _mm_cmpgt_ps( v[0], r.v[0] ), _mm_cmpgt_ps( v[1], r.v[1] ) ); }
+
+	friend Float8 min8( const Float8 &l, const Float8 &r ) { return Float8( _mm_min_ps( l.v[0], r.v[0] ), _mm_min_ps( l.v[1], r.v[1] ) ); }
+	friend Float8 max8( const Float8 &l, const Float8 &r ) { return Float8( _mm_max_ps( l.v[0], r.v[0] ), _mm_max_ps( l.v[1], r.v[1] ) ); }
+	friend Float8 sqrt8( const Float8 &r ) { return Float8( _mm_sqrt_ps( r.v[0] ), _mm_sqrt_ps( r.v[1] ) ); }
+	// mask が立っている所は t 、それ以外は f
+	friend Float8 select8( const Mask8 &mask, const Float8 &t, const Float8 &f ) {
+		return Float8(
+			_mm_or_ps( _mm_and_ps( mask.lo, t.v[0] ), _mm_andnot_ps( mask.lo, f.v[0] ) ),
+			_mm_or_ps( _mm_and_ps( mask.hi, t.v[1] ), _mm_andnot_ps( mask.hi, f.v[1] ) ) );
+	}
+#else
+	float f[PACKET_SIZE];
+	Float8() {}
+	Float8( float s ) { for ( int i = 0; i < PACKET_SIZE; i++ ) { f[i] = s; } }
+
+	Float8 operator +( const Float8 &r ) const { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = f[i] + r.f[i]; } return o; }
+	Float8 operator -( const Float8 &r ) const { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = f[i] - r.f[i]; } return o; }
+	Float8 operator *( const Float8 &r ) const { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = f[i] * r.f[i]; } return o; }
+	Float8 operator /( const Float8 &r ) const { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = f[i] / r.f[i]; } return o; }
+	Mask8 operator <( const Float8 &r ) const { int m = 0; for ( int i = 0; i < PACKET_SIZE; i++ ) { m |= ( f[i] < r.f[i] ) << i; } return Mask8( m ); }
+	Mask8 operator <=( const Float8 &r ) const { int m = 0; for ( int i = 0; i < PACKET_SIZE; i++ ) { m |= ( f[i] <= r.f[i] ) << i; } return Mask8( m ); }
+	Mask8 operator >( const Float8 &r ) const { int m = 0; for ( int i = 0; i < PACKET_SIZE; i++ ) { m |= ( f[i] > r.f[i] ) << i; } return Mask8( m ); }
+
+	friend Float8 min8( const Float8 &l, const Float8 &r ) { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = l.f[i] < r.f[i] ? l.f[i] : r.f[i]; } return o; }
+	friend Float8 max8( const Float8 &l, const Float8 &r ) { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = l.f[i] > r.f[i] ? l.f[i] : r.f[i]; } return o; }
+	friend Float8 sqrt8( const Float8 &r ) { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = sqrtf( r.f[i] ); } return o; }
+	// mask が立っている所は t 、それ以外は f
+	friend Float8 select8( const Mask8 &mask, const Float8 &t, const Float8 &f ) { Float8 o; for ( int i = 0; i < PACKET_SIZE; i++ ) { o.f[i] = ( mask.m >> i ) & 1 ? t.f[i] : f.f[i]; } return o; }
+#endif
+
+	// 0～1の間にクランプ
+	Float8 clamp01() const {
+		return min8( max8( *this, Float8( 0.0f ) ), Float8( 1.0f ) );
+	}
+};
+
+/**
+* @struct Float3x8
+* @brief ８個分の3成分float( 成分ごとにまとめる )
+*/
+struct Float3x8 {
+	Float8 x, y, z;
+
+	Float3x8() {}
+	Float3x8( const Float8 &x, const Float8 &y, const Float8 &z ) : x( x ), y( y ), z( z ) {}
+
+	// i 番目に設定
+	void set( int i, const Float3 &r ) {
+		x.f[i] = r.x;
+		y.f[i] = r.y;
+		z.f[i] = r.z;
+	}
+
+	// i 番目を取得
+	Float3 get( int i ) const {
+		return Float3( x.f[i], y.f[i], z.f[i] );
+	}
+
+	Float3x8 operator +( const Float3x8 &r ) const {
+		return Float3x8( x + r.x, y + r.y, z + r.z );
+	}
+
+	Float3x8 operator -( const Float3x8 &r ) const {
+		return Float3x8( x - r.x, y - r.y, z - r.z );
+	}
+
+	Float3x8 operator *( const Float8 &r ) const {
+		return Float3x8( x * r, y * r, z * r );
+	}
+
+	Float8 dot( const Float3x8 &r ) const {
+		return x * r.x + y * r.y + z * r.z;
+	}
+
+	Float8 lengthSq() const {
+		return dot( *this );
+	}
+};
+
+/**
+* @struct Mask4
+* @brief ４個分の比較結果
+*/
+struct Mask4 {
+#if defined( PRIMITIVE_PACKET_AVX2 ) || defined( PRIMITIVE_PACKET_SSE )
+	__m128 v;
+	Mask4( __m128 v ) : v( v ) {}
+	Mask4 operator &( const Mask4 &r ) const { return Mask4( _mm_and_ps( v, r.v ) ); }
+	Mask4 operator |( const Mask4 &r ) const { return Mask4( _mm_or_ps( v, r.v ) ); }
+	int bits() const { return _mm_movemask_ps( v ); }
+#else
+	int m;
+	Mask4( int m ) : m( m ) {}
+	Mask4 operator &( const Mask4 &r ) const { return Mask4( m & r.m ); }
+	Mask4 operator |( const Mask4 &r ) const { return Mask4( m | r.m ); }
+	int bits() const { return m; }
+#endif
+};
+
+/**
+* @struct Float4
+* @brief ４個分のfloat
+*/
+struct Float4 {
+#if defined( PRIMITIVE_PACKET_AVX2 ) || defined( PRIMITIVE_PACKET_SSE )
+	union {
+		__m128 v;
+		float f[PACKET4_SIZE];
+	};
+	Float4() {}
+	Float4( __m128 v ) : v( v ) {}
+	Float4( float s ) : v( _mm_set1_ps( s ) ) {}
+
+	Float4 operator +( const Float4 &r ) const { return Float4( _mm_add_ps( v, r.v ) ); }
+	Float4 operator -( const Float4 &r ) const { return Float4( _mm_sub_ps( v, r.v ) ); }
+	Float4 operator *( const Float4 &r ) const { return Float4( _mm_mul_ps( v, r.v ) ); }
+	Float4 operator /( const Float4 &r ) const { return Float4( _mm_div_ps( v, r.v ) ); }
+	Mask4 operator <( const Float4 &r ) const { return Mask4( _mm_cmplt_ps( v, r.v ) ); }
+	Mask4 operator <=( const Float4 &r ) const { return Mask4( _mm_cmple_ps( v, r.v ) ); }
+	Mask4 operator >( const Float4 &r ) const { return Mask4( _mm_cmpgt_ps( v, r.v ) ); }
+
+	friend Float4 min4( const Float4 &l, const Float4 &r ) { return Float4( _mm_min_ps( l.v, r.v ) ); }
+	friend Float4 max4( const Float4 &l, const Float4 &r ) { return Float4( _mm_max_ps( l.v, r.v ) ); }
+	friend Float4 sqrt4( const Float4 &r ) { return Float4( _mm_sqrt_ps( r.v ) ); }
+	// mask が立っている所は t 、それ以外は f
+	friend Float4 select4( const Mask4 &mask, const Float4 &t, const Float4 &f ) { return Float4( _mm_or_ps( _mm_and_ps( mask.v, t.v ), _mm_andnot_ps( mask.v, f.v ) ) ); }
+#else
+	float f[PACKET4_SIZE];
+	Float4() {}
+	Float4( float s ) { for ( int i = 0; i < PACKET4_SIZE; i++ ) { f[i] = s; } }
+
+	Float4 operator +( const Float4 &r ) const { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = f[i] + r.f[i]; } return o; }
+	Float4 operator -( const Float4 &r ) const { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = f[i] - r.f[i]; } return o; }
+	Float4 operator *( const Float4 &r ) const { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = f[i] * r.f[i]; } return o; }
+	Float4 operator /( const Float4 &r ) const { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = f[i] / r.f[i]; } return o; }
+	Mask4 operator <( const Float4 &r ) const { int m = 0; for ( int i = 0; i < PACKET4_SIZE; i++ ) { m |= ( f[i] < r.f[i] ) << i; } return Mask4( m ); }
+	Mask4 operator <=( const Float4 &r ) const { int m = 0; for ( int i = 0; i < PACKET4_SIZE; i++ ) { m |= ( f[i] <= r.f[i] ) << i; } return Mask4( m ); }
+	Mask4 operator >( const Float4 &r ) const { int m = 0; for ( int i = 0; i < PACKET4_SIZE; i++ ) { m |= ( f[i] > r.f[i] ) << i; } return Mask4( m ); }
+
+	friend Float4 min4( const Float4 &l, const Float4 &r ) { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = l.f[i] < r.f[i] ? l.f[i] : r.f[i]; } return o; }
+	friend Float4 max4( const Float4 &l, const Float4 &r ) { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = l.f[i] > r.f[i] ? l.f[i] : r.f[i]; } return o; }
+	friend Float4 sqrt4( const Float4 &r ) { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = sqrtf( r.f[i] ); } return o; }
+	// mask が立っている所は t 、それ以外は f
+	friend Float4 select4( const Mask4 &mask, const Float4 &t, const Float4 &f ) { Float4 o; for ( int i = 0; i < PACKET4_SIZE; i++ ) { o.f[i] = ( mask.m >> i ) & 1 ? t.f[i] : f.f[i]; } return o; }
+#endif
+
+	// 0～1の間にクランプ
+	Float4 clamp01() const {
+		return min4( max4( *this, Float4( 0.0f ) ), Float4( 1.0f ) );
+	}
+};
+
+/**
+* @struct Float3x4
+* @brief ４個分の3成分float( 成分ごとにまとめる )
+*/
+struct Float3x4 {
+	Float4 x, y, z;
+
+	Float3x4() {}
+	Float3x4( const Float4 &x, const Float4 &y, const Float4 &z ) : x( x ), y( y ), z( z ) {}
+
+	// i 番目に設定
+	void set( int i, const Float3 &r ) {
+		x.f[i] = r.x;
+		y.f[i] = r.y;
+		z.f[i] = r.z;
+	}
+
+	// i 番目を取得
+	Float3 get( int i ) const {
+		return Float3( x.f[i], y.f[i], z.f[i] );
+	}
+
+	Float3x4 operator +( const Float3x4 &r ) const {
+		return Float3x4( x + r.x, y + r.y, z + r.z );
+	}
+
+	Float3x4 operator -( const Float3x4 &r ) const {
+		return Float3x4( x - r.x, y - r.y, z - r.z );
+	}
+
+	Float3x4 operator *( const Float4 &r ) const {
+		return Float3x4( x * r, y * r, z * r );
+	}
+
+	Float4 dot( const Float3x4 &r ) const {
+		return x * r.x + y * r.y + z * r.z;
+	}
+
+	Float4 lengthSq() const {
+		return dot( *this );
+	}
+};
+
+/**
+* @struct Segment8
+* @brief ８個分の線分
+*/
+struct Segment8 {
+	Float3x8 p;		// 始点
+	Float3x8 v;		// 始点から終点へのベクトル
+
+	// i 番目に設定
+	void set( int i, const Segment &s ) {
+		p.set( i, s.p );
+		v.set( i, s.v );
+	}
+};
+
+/**
+* @struct Capsule8
+* @brief ８個分のカプセル
+*/
+struct Capsule8 {
+	Segment8 s;
+	Float8 r;		// 半径
+
+	// i 番目に設定
+	void set( int i, const Capsule &c ) {
+		s.set( i, c.s );
+		r.f[i] = c.r;
+	}
+};
+
+// 点と線分の最短距離( ８組 )
+//  t には線分上の最近点の位置( 0～1 )が入る
+inline Float8 CalcPointSegmentDist8( const Float3x8 &p, const Segment8 &seg, Float8 &t ) {
+	const Float8 lenSq = seg.v.lengthSq();
+	const Mask8 degenerate = lenSq <= Float8( _OX_EPSILON_ );
+	t = select8( degenerate, Float8( 0.0f ), ( ( p - seg.p ).dot( seg.v ) / select8( degenerate, Float8( 1.0f ), lenSq ) ).clamp01() );
+	const Float3x8 h = seg.p + seg.v * t;
+	return sqrt8( ( p - h ).lengthSq() );
+}
+
+// 2線分の最短距離( ８組 )
+//  t1, t2 にはそれぞれの線分上の最近点の位置( 0～1 )が入る
+//  分岐の代わりに全ての場合を計算して select で選ぶ
+inline Float8 CalcSegmentSegmentDist8( const Segment8 &s1, const Segment8 &s2, Float8 &t1, Float8 &t2 ) {
+	const Float8 zero( 0.0f );
+	const Float8 one( 1.0f );
+	const Float8 epsilon( _OX_EPSILON_ );
+	const Float3x8 r = s1.p - s2.p;
+	const Float8 a = s1.v.lengthSq();
+	const Float8 e = s2.v.lengthSq();
+	const Float8 b = s1.v.dot( s2.v );
+	const Float8 c = s1.v.dot( r );
+	const Float8 f = s2.v.dot( r );
+	const Mask8 degenerate1 = a <= epsilon;
+	const Mask8 degenerate2 = e <= epsilon;
+	const Float8 safeA = select8( degenerate1, one, a );
+	const Float8 safeE = select8( degenerate2, one, e );
+
+	// 平行でなければ2直線の最近点、平行なら s1 の始点から始める
+	const Float8 denom = a * e - b * b;
+	const Mask8 parallel = denom <= epsilon * a * e;
+	Float8 s = select8( parallel, zero, ( ( b * f - c * e ) / select8( parallel, one, denom ) ).clamp01() );
+
+	// s2 上の位置を求めて、はみ出していたら端に合わせて s1 上の位置を求め直す
+	Float8 t = ( b * s + f ) / safeE;
+	const Mask8 under = t < zero;
+	const Mask8 over = t > one;
+	s = select8( under, ( ( zero - c ) / safeA ).clamp01(), s );
+	s = select8( over, ( ( b - c ) / safeA ).clamp01(), s );
+	t = t.clamp01();
+
+	// 片方が点になっている場合
+	s = select8( degenerate2, ( ( zero - c ) / safeA ).clamp01(), s );
+	t = select8( degenerate2, zero, t );
+	s = select8( degenerate1, zero, s );
+	t = select8( degenerate1, ( f / safeE ).clamp01(), t );
+	s = select8( degenerate1 & degenerate2, zero, s );
+	t = select8( degenerate1 & degenerate2, zero, t );
+
+	t1 = s;
+	t2 = t;
+	const Float3x8 p1 = s1.p + s1.v * s;
+	const Float3x8 p2 = s2.p + s2.v * t;
+	return sqrt8( ( p1 - p2 ).lengthSq() );
+}
+
+// カプセルとカプセルの表面の最短距離( ８組 )
+//  負の値なら重なっている
+inline Float8 CalcCapsuleCapsuleDist8( const Capsule8 &c1, const Capsule8 &c2 ) {
+	Float8 t1, t2;
+	return CalcSegmentSegmentDist8( c1.s, c2.s, t1, t2 ) - c1.r - c2.r;
+}
+
+// カプセルとカプセルの当たり判定( ８組 )
+//  戻り値は当たっている組のビットを立てたもの
+inline int CheckCapsuleCapsule8( const Capsule8 &c1, const Capsule8 &c2 ) {
+	return ( CalcCapsuleCapsuleDist8( c1, c2 ) <= Float8( 0.0f ) ).bits();
+}
+
+/**
+* @struct Segment4
+* @brief ４個分の線分
+*/
+struct Segment4 {
+	Float3x4 p;		// 始点
+	Float3x4 v;		// 始点から終点へのベクトル
+
+	// i 番目に設定
+	void set( int i, const Segment &s ) {
+		p.set( i, s.p );
+		v.set( i, s.v );
+	}
+};
+
+/**
+* @struct Capsule4
+* @brief ４個分のカプセル
+*/
+struct Capsule4 {
+	Segment4 s;
+	Float4 r;		// 半径
+
+	// i 番目に設定
+	void set( int i, const Capsule &c ) {
+		s.set( i, c.s );
+		r.f[i] = c.r;
+	}
+};
+
+// 点と線分の最短距離( ４組 )
+//  t には線分上の最近点の位置( 0～1 )が入る
+inline Float4 CalcPointSegmentDist4( const Float3x4 &p, const Segment4 &seg, Float4 &t ) {
+	const Float4 lenSq = seg.v.lengthSq();
+	const Mask4 degenerate = lenSq <= Float4( _OX_EPSILON_ );
+	t = select4( degenerate, Float4( 0.0f ), ( ( p - seg.p ).dot( seg.v ) / select4( degenerate, Float4( 1.0f ), lenSq ) ).clamp01() );
+	const Float3x4 h = seg.p + seg.v * t;
+	return sqrt4( ( p - h ).lengthSq() );
+}
+
+// 2線分の最短距離( ４組 )
+//  t1, t2 にはそれぞれの線分上の最近点の位置( 0～1 )が入る
+//  CalcSegmentSegmentDist8 と同じ手順
+inline Float4 CalcSegmentSegmentDist4( const Segment4 &s1, const Segment4 &s2, Float4 &t1, Float4 &t2 ) {
+	const Float4 zero( 0.0f );
+	const Float4 one( 1.0f );
+	const Float4 epsilon( _OX_EPSILON_ );
+	const Float3x4 r = s1.p - s2.p;
+	const Float4 a = s1.v.lengthSq();
+	const Float4 e = s2.v.lengthSq();
+	const Float4 b = s1.v.dot( s2.v );
+	const Float4 c = s1.v.dot( r );
+	const Float4 f = s2.v.dot( r );
+	const Mask4 degenerate1 = a <= epsilon;
+	const Mask4 degenerate2 = e <= epsilon;
+	const Float4 safeA = select4( degenerate1, one, a );
+	const Float4 safeE = select4( degenerate2, one, e );
+
+	const Float4 denom = a * e - b * b;
+	const Mask4 parallel = denom <= epsilon * a * e;
+	Float4 s = select4( parallel, zero, ( ( b * f - c * e ) / select4( parallel, one, denom ) ).clamp01() );
+
+	Float4 t = ( b * s + f ) / safeE;
+	const Mask4 under = t < zero;
+	const Mask4 over = t > one;
+	s = select4( under, ( ( zero - c ) / safeA ).clamp01(), s );
+	s = select4( over, ( ( b - c ) / safeA ).clamp01(), s );
+	t = t.clamp01();
+
+	s = select4( degenerate2, ( ( zero - c ) / safeA ).clamp01(), s );
+	t = select4( degenerate2, zero, t );
+	s = select4( degenerate1, zero, s );
+	t = select4( degenerate1, ( f / safeE ).clamp01(), t );
+	s = select4( degenerate1 & degenerate2, zero, s );
+	t = select4( degenerate1 & degenerate2, zero, t );
+
+	t1 = s;
+	t2 = t;
+	const Float3x4 p1 = s1.p + s1.v * s;
+	const Float3x4 p2 = s2.p + s2.v * t;
+	return sqrt4( ( p1 - p2 ).lengthSq() );
+}
+
+// カプセルとカプセルの表面の最短距離( ４組 )
+//  負の値なら重なっている
+inline Float4 CalcCapsuleCapsuleDist4( const Capsule4 &c1, const Capsule4 &c2 ) {
+	Float4 t1, t2;
+	return CalcSegmentSegmentDist4( c1.s, c2.s, t1, t2 ) - c1.r - c2.r;
+}
+
+// カプセルとカプセルの当たり判定( ４組 )
+//  戻り値は当たっている組のビットを立てたもの
+inline int CheckCapsuleCapsule4( const Capsule4 &c1, const Capsule4 &c2 ) {
+	return ( CalcCapsuleCapsuleDist4( c1, c2 ) <= Float4( 0.0f ) ).bits();
+}
+
+#endif
@@ -1,5 +1,4 @@
 ﻿#include "Tree.h"
-#include "DrawBoard.h"
 /**
 * @file
 * @brief Mission04
@@ -20,12 +19,27 @@ const float Tree::COLLISION_CAPSULE_HEIGHT = 80.0f;		//!< 当たり判定カプ
 /**
 * @fn Tree::Tree
 * @brief コンストラクタ
+* @details 配列に並べるための、何も置いていない木
 */
-Tree::Tree(VECTOR position, float scale, int graphHandle)
+Tree::Tree()
+{
+	m_position = VGet(0.0f, 0.0f, 0.0f);
+	m_scale = 0.0f;
+	m_foliage = NULL;
+	m_foliageIndex = -1;
+}
+
+/**
+* @fn Tree::Tree
+* @brief コンストラクタ
+* @param[in] VECTOR position, float scale, Foliage *foliage 板ポリを登録する先
+*/
+Tree::Tree(VECTOR position, float scale, Foliage *foliage)
 {
-	m_graphHandle = graphHandle;
 	m_position = position;
 	m_scale = scale;
+	m_foliage = foliage;
+	m_foliageIndex = foliage->Add(position, scale);
 }
 
 //---------------------------------------------------------------------------------
@@ -35,56 +49,77 @@ Tree::Tree(VECTOR position, float scale, int graphHandle)
 
 /**
 * @fn Tree::Draw
-* @brief 描画
-* @param[in] drawType
+* @brief 当たり判定の描画
+* @param[in] drawType, DebugDraw *debugDraw
+* @details 木そのものは Foliage::Draw でまとめて描画する
+*          当たり判定は debugDraw にためておき、他の確認用の図形とまとめて描画する
 */
-void Tree::Draw(int drawType)
+void Tree::Draw(int drawType, DebugDraw *debugDraw)
 {
-	DrawBoard(
-		VGet(
-			m_position.x - 100.0f * m_scale,
-			m_position.y + 200.0f * m_scale,
-			m_position.z
-		),
-		VGet(
-			m_position.x + 100.0f * m_scale,
-			m_position.y,
-			m_position.z
-		), m_graphHandle);
-
-	DrawBoard(
-		VGet(
-			m_position.x,
-			m_position.y + 200.0f * m_scale,
-			m_position.z - 100.0f * m_scale
-		),
-		VGet(
-			m_position.x,
-			m_position.y,
-			m_position.z + 100.0f * m_scale
-		), m_graphHandle);
-
 	//当たり判定を半透明で描画
-	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 128);
 	switch(drawType)
 	{
 	// 球
 	case HitCheckType::Type_Sphere:
-		DrawSphere3D(
+		debugDraw->AddSphere(
 			VAdd(m_position, VGet(0.0f, COLLISION_HEIGHT * m_scale, 0.0f)),
 			COLLISION_SPHERE_RADIUS * m_scale,
-			8, GetColor(255, 255, 255), GetColor(255, 255, 255), false);
+			GetColorU8(255, 255, 255, 128), false);
 		break;
 
 	// カプセル
 	case HitCheckType::Type_Capsule:
-		DrawCapsule3D(
+		debugDraw->AddCapsule(
 			VAdd(m_position, VGet(0.0f, COLLISION_CAPSULE_RADIUS * m_scale, 0.0f)),
 			VAdd(m_position, VGet(0.0f, COLLISION_CAPSULE_HEIGHT * m_scale, 0.0f)),
 			COLLISION_CAPSULE_RADIUS * m_scale,
-			8, GetColor(255, 255, 255), GetColor(255, 255, 255), false);
+			GetColorU8(255, 255, 255, 128), false);
+	}
+}
+
+/**
+* @fn Tree::GetPosition
+* @brief 根元の座標
+* @return VECTOR
+*/
+VECTOR Tree::GetPosition() const
+{
+	return m_position;
+}
+
+/**
+* @fn Tree::GetScale
+* @brief 拡大率
+* @return float
+*/
+float Tree::GetScale() const
+{
+	return m_scale;
+}
+
+/**
+* @fn Tree::GetFoliageIndex
+* @brief Foliage に登録した番号
+* @return int -1:登録していない( Foliage が一杯だった )
+*/
+int Tree::GetFoliageIndex() const
+{
+	return m_foliageIndex;
+}
+
+/**
+* @fn Tree::RemoveFoliage
+* @brief 板ポリを Foliage から削除する
+* @details 描画されなくなるだけで、当たり判定は TreeGrid に残る
+*/
+void Tree::RemoveFoliage()
+{
+	if(m_foliage == NULL || m_foliageIndex < 0)
+	{
+		return;
 	}
-	SetDrawBlendMode(DX_BLENDMODE_ALPHA, 255);
+	m_foliage->Remove(m_foliageIndex);
+	m_foliageIndex = -1;
 }
 
 /**
@@ -3,16 +3,20 @@
 #include "DxLib.h"
 #include "HitCheckType.h"
 #include "Primitive.h"
+#include "Foliage.h"
+#include "DebugDraw.h"
 
 /**
 * @class Tree
 * @brief 板ポリを2枚組み合わせて木を表示する
+* @details 板ポリは Foliage に登録して、同じ画像の木とまとめて描画する
 */
 class Tree {
 private:
-	int m_graphHandle;	// 画像ハンドル
 	VECTOR m_position;	// 座標
 	float m_scale;		// 拡大率
+	Foliage *m_foliage;	// 板ポリを登録した先
+	int m_foliageIndex;	// Foliage に登録した番号( -1:登録していない )
 
 	//-------------------------------------------------------------------------------------------
 	// 点と直線の最短距離
@@ -41,9 +45,14 @@ public:
 	static const float COLLISION_CAPSULE_RADIUS;				//!< 当たり判定カプセルの半径  35.0f
 	static const float COLLISION_CAPSULE_HEIGHT;				//!< 当たり判定カプセルの高さ 140.0f
 
-	Tree(VECTOR position, float scale, int graphHandle);		//!< コンストラクタ
+	Tree();														//!< コンストラクタ( 配列に並べるため )
+	Tree(VECTOR position, float scale, Foliage *foliage);		//!< コンストラクタ
 
-	void Draw(int drawType);									//!< 描画
+	void Draw(int drawType, DebugDraw *debugDraw);				//!< 当たり判定の描画( debugDraw にためる )
+	VECTOR GetPosition() const;									//!< 根元の座標
+	float GetScale() const;										//!< 拡大率
+	int GetFoliageIndex() const;								//!< Foliage に登録した番号( -1:登録していない )
+	void RemoveFoliage();										//!< 板ポリを Foliage から削除する( 木が描画されなくなる )
 	bool CheckSphereToSphere(VECTOR centerPosition, float r);	//!< 球と球の当たり判定
 	bool CheckCapsuleToCapsule(const Capsule &other);			//!< カプセルとカプセルの当たり判定
 };
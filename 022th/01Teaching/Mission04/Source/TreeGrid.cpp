@@ -0,0 +1,194 @@
+﻿#include "TreeGrid.h"
+#include <math.h>
+/**
+* @file
+* @brief Mission04
+* @author N.Yamada
+* @date 2023/01/06
+*
+* @details 木の当たり判定の候補をＸＺ平面の格子で絞り込む
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+
+/**
+* @fn TreeGrid::TreeGrid
+* @brief コンストラクタ
+* @param[in] const Tree *tree 木の配列, int treeNum 木の数
+* @details マスの大きさは木の当たり判定球の直径の平均にして、大きな木だけが複数のマスにまたがるようにする
+*/
+TreeGrid::TreeGrid(const Tree *tree, int treeNum)
+{
+	m_tree = tree;
+	m_treeNum = treeNum;
+	m_queryId = 0;
+
+	// マスの大きさを決める
+	float reachTotal = 0.0f;
+	for(int i=0; i<treeNum; i++)
+	{
+		reachTotal += Tree::COLLISION_SPHERE_RADIUS * tree[i].GetScale();
+	}
+	m_cellSize = treeNum > 0 ? reachTotal / treeNum * 2.0f : 1.0f;
+	if(m_cellSize <= 0.0f)
+	{
+		m_cellSize = 1.0f;
+	}
+
+	// 木が登録されるマスの数を数えて、それより大きな２のべき乗をハッシュ表の大きさにする
+	int entryNum = 0;
+	for(int i=0; i<treeNum; i++)
+	{
+		VECTOR position = tree[i].GetPosition();
+		float reach = Tree::COLLISION_SPHERE_RADIUS * tree[i].GetScale();
+		entryNum += (GetCell(position.x + reach) - GetCell(position.x - reach) + 1) * (GetCell(position.z + reach) - GetCell(position.z - reach) + 1);
+	}
+	int tableSize = 1;
+	while(tableSize < entryNum * 2)
+	{
+		tableSize *= 2;
+	}
+	m_tableMask = tableSize - 1;
+	m_bucketStart = new int[tableSize + 1];
+	m_entry = new int[entryNum > 0 ? entryNum : 1];
+	m_queryStamp = new unsigned int[treeNum > 0 ? treeNum : 1];
+
+	// ハッシュ値ごとの数を数えて、開始位置に変換してから木の番号を並べる
+	for(int i=0; i<=tableSize; i++)
+	{
+		m_bucketStart[i] = 0;
+	}
+	for(int pass=0; pass<2; pass++)
+	{
+		for(int i=0; i<treeNum; i++)
+		{
+			VECTOR position = tree[i].GetPosition();
+			float reach = Tree::COLLISION_SPHERE_RADIUS * tree[i].GetScale();
+			int minX = GetCell(position.x - reach);
+			int maxX = GetCell(position.x + reach);
+			int minZ = GetCell(position.z - reach);
+			int maxZ = GetCell(position.z + reach);
+			for(int z=minZ; z<=maxZ; z++)
+			{
+				for(int x=minX; x<=maxX; x++)
+				{
+					int bucket = GetBucket(x, z);
+					if(pass == 0)
+					{
+						m_bucketStart[bucket]++;
+					}
+					else
+					{
+						m_entry[--m_bucketStart[bucket]] = i;
+					}
+				}
+			}
+		}
+		if(pass == 0)
+		{
+			// 終了位置にしておき、２回目に後ろから詰めると開始位置になる
+			for(int i=1; i<tableSize; i++)
+			{
+				m_bucketStart[i] += m_bucketStart[i - 1];
+			}
+			m_bucketStart[tableSize] = entryNum;
+		}
+	}
+	for(int i=0; i<treeNum; i++)
+	{
+		m_queryStamp[i] = 0;
+	}
+}
+
+/**
+* @fn TreeGrid::~TreeGrid
+* @brief デストラクタ
+*/
+TreeGrid::~TreeGrid()
+{
+	delete[] m_bucketStart;
+	delete[] m_entry;
+	delete[] m_queryStamp;
+}
+
+/**
+* @fn TreeGrid::GetCell
+* @brief 座標からマスの番号を求める
+* @param[in] float v
+* @return int
+*/
+int TreeGrid::GetCell(float v) const
+{
+	return (int)floorf(v / m_cellSize);
+}
+
+/**
+* @fn TreeGrid::GetBucket
+* @brief マスの座標からハッシュ値を求める
+* @param[in] int cellX, int cellZ
+* @return int
+*/
+int TreeGrid::GetBucket(int cellX, int cellZ) const
+{
+	return (int)(((unsigned int)cellX * 73856093u ^ (unsigned int)cellZ * 19349663u) & (unsigned int)m_tableMask);
+}
+
+/**
+* @fn TreeGrid::Query
+* @brief 指定の円に当たるかもしれない木を集める
+* @param[in] VECTOR position 中心( Ｙは使わない ), float radius 半径
+* @param[out] int *treeIndex 木の番号
+* @param[in] int treeMax treeIndex の大きさ
+* @return int 木の数( treeMax より多い場合は treeMax 個まで )
+* @details 円に重なるマスに登録された木だけを集めるので、実際に当たっているかどうかは木ごとに判定すること
+*/
+int TreeGrid::Query(VECTOR position, float radius, int *treeIndex, int treeMax)
+{
+	m_queryId++;
+	if(m_queryId == 0)
+	{
+		for(int i=0; i<m_treeNum; i++)
+		{
+			m_queryStamp[i] = 0;
+		}
+		m_queryId = 1;
+	}
+
+	int num = 0;
+	int minX = GetCell(position.x - radius);
+	int maxX = GetCell(position.x + radius);
+	int minZ = GetCell(position.z - radius);
+	int maxZ = GetCell(position.z + radius);
+	for(int z=minZ; z<=maxZ; z++)
+	{
+		for(int x=minX; x<=maxX; x++)
+		{
+			int bucket = GetBucket(x, z);
+			for(int i=m_bucketStart[bucket]; i<m_bucketStart[bucket + 1]; i++)
+			{
+				// 別のマスと同じハッシュ値だったり、複数のマスにまたがっていたりする木は１回だけにする
+				int index = m_entry[i];
+				if(m_queryStamp[index] == m_queryId)
+				{
+					continue;
+				}
+				m_queryStamp[index] = m_queryId;
+				if(num < treeMax)
+				{
+					treeIndex[num++] = index;
+				}
+			}
+		}
+	}
+	return num;
+}
+
+/**
+* @fn TreeGrid::GetCellSize
+* @brief マス１つの一辺の長さ
+* @return float
+*/
+float TreeGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "DxLib.h"
+#include "Tree.h"
+
+/**
+* @class TreeGrid
+* @brief 木の当たり判定の候補をＸＺ平面の格子で絞り込む
+* @details 木は当たり判定球が重なる全てのマスに登録し、マスの座標のハッシュ値ごとにまとめて並べておく
+*          木は動かないので、作った後は変更しない
+*/
+class TreeGrid {
+private:
+	const Tree *m_tree;			// 木の配列
+	int m_treeNum;				// 木の数
+	float m_cellSize;			// マス１つの一辺の長さ
+	int m_tableMask;			// ハッシュ表の大きさ－１( ２のべき乗－１ )
+	int *m_bucketStart;			// ハッシュ値ごとの m_entry の開始位置( ハッシュ表の大きさ＋１ )
+	int *m_entry;				// ハッシュ値の順に並べた木の番号
+	unsigned int *m_queryStamp;	// 木ごとの最後に候補にした検索の番号( 同じ木を２回候補にしないため )
+	unsigned int m_queryId;		// 検索の番号
+
+	int GetCell(float v) const;						// 座標からマスの番号を求める
+	int GetBucket(int cellX, int cellZ) const;		// マスの座標からハッシュ値を求める
+
+	TreeGrid(const TreeGrid &) = delete;			// 配列を持つのでコピー禁止
+	TreeGrid &operator =(const TreeGrid &) = delete;
+
+public:
+	TreeGrid(const Tree *tree, int treeNum);		//!< コンストラクタ( 木の配列は TreeGrid より長く残しておくこと )
+	~TreeGrid();									//!< デストラクタ
+
+	int Query(VECTOR position, float radius, int *treeIndex, int treeMax);	//!< 指定の円に当たるかもしれない木を集める( 戻り値 : 木の数 )
+	float GetCellSize() const;						//!< マス１つの一辺の長さ
+};
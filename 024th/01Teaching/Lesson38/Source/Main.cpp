@@ -3,7 +3,10 @@
 #include "Player.h"
 #include "Stage.h"
 #include "Camera.h"
+#include "StageBake.h"
+#include "TextureCook.h"
 #include <math.h>
+#include <string.h>
 /**
 * @file
 * @brief Lesson38
@@ -16,6 +19,8 @@
 
 void Render_Process();			//!< 描画処理
 
+const char STAGEBAKE_PATH[] = "Resource/ColTestStage.bake";	//!< ステージのライティングを焼き込んだファイル
+
 PADINPUT input;					//!< 入力情報の実体宣言
 PLAYER player;					//!< プレイヤー情報の実体宣言
 STAGE stage;					//!< ステージ情報の実体宣言
@@ -55,10 +60,10 @@ void Player_Initialize()
 	player.jumpPower = 0.0f;
 
 	// モデルの読み込み
-	player.modelHandle = MV1LoadModel("Resource/DxChara.x");
+	player.modelHandle = TextureCook_LoadModel("Resource/DxChara.x", NULL);
 
 	// 影描画用の画像の読み込み
-	player.shadowHandle = LoadGraph("Resource/Shadow.tga");
+	player.shadowHandle = TextureCook_LoadGraph("Resource/Shadow.tga");
 
 	// 初期状態では「立ち止り」状態
 	player.state = AnimeState::Neutral;
@@ -893,10 +898,10 @@ void Player_ShadowRender()
 void Stage_Initialize()
 {
 	// ステージモデルの読み込み
-	stage.modelHandle = MV1LoadModel("Resource/ColTestStage.mqo");
+	stage.modelHandle = TextureCook_LoadModel("Resource/ColTestStage.mqo", NULL);
 
 	// コリジョンモデルの派生元ハンドルの読み込み
-	stage.collObjBaseModelHandle = MV1LoadModel("Resource/ColTestObj.mqo");
+	stage.collObjBaseModelHandle = TextureCook_LoadModel("Resource/ColTestObj.mqo", NULL);
 
 	// ステージに配置しているコリジョンモデルの数を０にする
 	stage.collObjNum = 0;
@@ -1140,8 +1145,15 @@ void Camera_Process()
 */
 void Render_Process()
 {
-	// ステージモデルの描画
-	MV1DrawModel(stage.modelHandle);
+	// ステージモデルの描画( ライティングを焼き込んだものがあればそちらを描画する )
+	if(StageBake_IsLoaded())
+	{
+		StageBake_Draw();
+	}
+	else
+	{
+		MV1DrawModel(stage.modelHandle);
+	}
 
 	// コリジョンモデルの描画
 	for(int i=0; i<stage.collObjNum; i++)
@@ -1168,12 +1180,34 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
+	// -bakestage の指定があればステージのライティングを焼き込んで終了する( ウインドウは表示しない )
+	bool bakeMode = strstr(lpCmdLine, "-bakestage") != NULL;
+
+	// -cooktexture の指定があればテクスチャをミップマップ付きの圧縮テクスチャ( DDS ファイル )にして終了する( ウインドウは表示しない )
+	bool cookMode = strstr(lpCmdLine, "-cooktexture") != NULL;
+	if(bakeMode || cookMode)
+	{
+		SetWindowVisibleFlag(false);
+	}
+
 	// ライブラリの初期化
 	if(DxLib_Init() < 0)
 	{
 		return -1;
 	}
 
+	// テクスチャを DDS ファイルにする( アルファの無いものは BC1、影はアルファを使うので BC3 )
+	if(cookMode)
+	{
+		bool kabeResult = TextureCook_Cook("Resource/KabeTex.bmp", "Resource/KabeTex.dds", TEXTURECOOK_FORMAT_BC1);
+		bool eyeResult = TextureCook_Cook("Resource/DxCharaEye.tga", "Resource/DxCharaEye.dds", TEXTURECOOK_FORMAT_BC1);
+		bool shadowResult = TextureCook_Cook("Resource/Shadow.tga", "Resource/Shadow.dds", TEXTURECOOK_FORMAT_BC3);
+		ErrorLogFmtAdd("cooktexture : KabeTex.dds %s  DxCharaEye.dds %s  Shadow.dds %s",
+			kabeResult ? "written" : "failed", eyeResult ? "written" : "failed", shadowResult ? "written" : "failed");
+		DxLib_End();
+		return kabeResult && eyeResult && shadowResult ? 0 : -1;
+	}
+
 	// プレイヤーの初期化
 	Player_Initialize();
 
@@ -1189,6 +1223,24 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	Stage_AddCollObj(VGet(1600.0f, 2200.0f, 2700.0f));
 	Stage_AddCollObj(VGet(-2600.0f, 1600.0f, 2400.0f));
 
+	// ステージのライティングを焼き込む( ステージとコリジョンモデルを置いた状態で影と遮蔽を求める )
+	if(bakeMode)
+	{
+		STAGEBAKE_CONFIG config;
+		STAGEBAKE_STATS stats;
+		StageBake_GetDefaultConfig(&config);
+		bool result = StageBake_Build(stage.modelHandle, stage.collObjModelHandle, stage.collObjNum, &config, STAGEBAKE_PATH, &stats);
+		ErrorLogFmtAdd("StageBake %s : occluder %d polygons, %d nodes, baked %d vertices %d polygons, %lld rays, bvh %lld us, bake %lld us",
+			result ? "OK" : "FAILED", stats.occluderPolygonNum, stats.nodeNum, stats.vertexNum, stats.polygonNum, stats.rayNum, stats.bvhTime, stats.bakeTime);
+		Player_Terminate();
+		Stage_Terminate();
+		DxLib_End();
+		return result ? 0 : -1;
+	}
+
+	// 焼き込んだライティングを読み込む( 無いか古い場合は今まで通りライティングして描画する )
+	StageBake_Load(stage.modelHandle, STAGEBAKE_PATH);
+
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
 
@@ -1227,6 +1279,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	Player_Terminate();
 
 	// ステージの後始末
+	StageBake_Unload();
 	Stage_Terminate();
 
 	// ライブラリの後始末
@@ -0,0 +1,870 @@
+﻿#include "StageBake.h"
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson38
+* @author N.Yamada
+* @date 2023/01/09
+*
+* @details ステージの頂点ごとに、周りの物による遮蔽( アンビエントオクルージョン )とライトの影を前もって求めて頂点カラーに焼き込む
+*          レイはステージと配置したコリジョンモデルの三角形で作った BVH に対して飛ばし、頂点をいくつかずつ複数のスレッドで処理する
+*          実行時は焼き込んだ頂点カラーでライティング無しに描画するので、ライトの計算をしないでも影と遮蔽がつく
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const unsigned int STAGEBAKE_MAGIC = 0x4B414253;	//!< 焼き込みファイルの先頭の "SBAK"
+const unsigned int STAGEBAKE_VERSION = 1;		//!< 焼き込みファイルの形式のバージョン
+const int STAGEBAKE_LEAFSIZE = 4;				//!< BVH の葉に入れる三角形の最大数
+const int STAGEBAKE_BALANCEDEPTH = 32;			//!< BVH のこの深さからは数で半分に分ける( 深さを抑える )
+const int STAGEBAKE_STACKSIZE = 64;				//!< BVH をたどる時のスタックの大きさ( BVH の深さ + 1 以上 )
+const int STAGEBAKE_CHUNKSIZE = 64;				//!< スレッドが１度に取る頂点の数
+const float STAGEBAKE_FAR = 1.0e8f;				//!< ライトへのレイの長さ( ディレクショナルライトなので十分遠く )
+
+/**
+* @struct STAGEBAKE_FILEHEADER
+* @brief 焼き込みファイルの先頭
+* @details 後ろにグループ、頂点、インデックスの順に並ぶ
+*/
+struct STAGEBAKE_FILEHEADER
+{
+	unsigned int magic;						//!< STAGEBAKE_MAGIC
+	unsigned int version;					//!< STAGEBAKE_VERSION
+	unsigned int headerSize;				//!< このヘッダのサイズ
+	unsigned int fileSize;					//!< ファイル全体のサイズ
+	unsigned int checksum;					//!< ヘッダより後ろの FNV-1a ハッシュ値
+	int sourcePolygonNum;					//!< 焼き込んだ時のステージのポリゴンの数( モデルが変わったかの確認用 )
+	int sourceVertexNum;					//!< 焼き込んだ時のステージの頂点の数( モデルが変わったかの確認用 )
+	int vertexSize;							//!< 頂点１つのサイズ( sizeof(VERTEX3D) )
+	int vertexNum;							//!< 頂点の数
+	int indexNum;							//!< インデックスの数
+	int groupNum;							//!< マテリアルごとのグループの数
+};
+
+/**
+* @struct STAGEBAKE_GROUP
+* @brief 同じマテリアルのポリゴンのまとまり
+*/
+struct STAGEBAKE_GROUP
+{
+	int materialIndex;						//!< ステージのモデルのマテリアルの番号
+	int firstIndex;							//!< 最初のインデックスの位置
+	int indexNum;							//!< インデックスの数
+};
+
+/**
+* @struct STAGEBAKE_TRIANGLE
+* @brief レイを遮る三角形( 交差判定用に２辺を持つ )
+*/
+struct STAGEBAKE_TRIANGLE
+{
+	VECTOR v0;								//!< 頂点０
+	VECTOR edge1;							//!< 頂点０から頂点１
+	VECTOR edge2;							//!< 頂点０から頂点２
+};
+
+/**
+* @struct STAGEBAKE_NODE
+* @brief BVH のノード
+*/
+struct STAGEBAKE_NODE
+{
+	VECTOR bmin;							//!< 囲む箱の最小座標
+	VECTOR bmax;							//!< 囲む箱の最大座標
+	int first;								//!< 葉なら最初の三角形の番号の位置、葉でなければ左の子の番号( 右の子は +1 )
+	int count;								//!< 葉なら三角形の数、葉でなければ 0
+};
+
+/**
+* @struct STAGEBAKE_BUILD
+* @brief 焼き込み中の情報( スレッドから参照する )
+*/
+struct STAGEBAKE_BUILD
+{
+	const STAGEBAKE_CONFIG *config;			//!< 焼き込みの設定
+	STAGEBAKE_TRIANGLE *triangle;			//!< レイを遮る三角形
+	int *triangleIndex;						//!< BVH の葉から参照する三角形の番号
+	VECTOR *centroid;						//!< 三角形の重心
+	STAGEBAKE_NODE *node;					//!< BVH のノード( 0 が根 )
+	int nodeNum;							//!< BVH のノードの数
+	int depth;								//!< BVH の一番深い葉の深さ( 根が 0 )
+	VERTEX3D *vertex;						//!< 焼き込む頂点
+	int *vertexMaterial;					//!< 頂点のマテリアルの番号
+	int vertexNum;							//!< 焼き込む頂点の数
+	COLOR_F *materialDif;					//!< マテリアルのディフューズカラー
+	COLOR_F *materialAmb;					//!< マテリアルのアンビエントカラー
+	COLOR_F *materialEmi;					//!< マテリアルのエミッシブカラー
+	VECTOR lightDir;						//!< ライトへ向かう向き( 単位ベクトル )
+	COLOR_F lightDif;						//!< ライトのディフューズカラー
+	COLOR_F lightAmb;						//!< ライトのアンビエントカラー
+	volatile LONG nextChunk;				//!< 次に焼き込む頂点のまとまりの番号
+	LONGLONG rayNum[STAGEBAKE_MAXTHREAD + 1];	//!< スレッドごとの飛ばしたレイの数
+};
+
+/**
+* @struct STAGEBAKE_DRAW
+* @brief 読み込んだ焼き込みステージ
+*/
+struct STAGEBAKE_DRAW
+{
+	int vertexBufferHandle;					//!< 頂点バッファ( -1:読み込んでいない )
+	int indexBufferHandle;					//!< インデックスバッファ
+	int vertexNum;							//!< 頂点の数
+	int groupNum;							//!< グループの数
+	STAGEBAKE_GROUP *group;					//!< マテリアルごとのグループ
+	int *textureHandle;						//!< グループごとのテクスチャ
+};
+
+static STAGEBAKE_BUILD stageBake;			//!< 焼き込み中の情報
+static STAGEBAKE_DRAW stageBakeDraw = { -1, -1, 0, 0, NULL, NULL };	//!< 読み込んだ焼き込みステージ
+
+/**
+* @fn StageBake_Checksum
+* @brief 指定のデータのチェックサムを求める
+* @param[in] const unsigned char *data, unsigned int size
+* @return unsigned int FNV-1a の 32bit ハッシュ値
+*/
+static unsigned int StageBake_Checksum(const unsigned char *data, unsigned int size)
+{
+	unsigned int hash = 2166136261u;
+	for(unsigned int i=0; i<size; i++)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* @fn StageBake_GetDefaultConfig
+* @brief 焼き込みの設定の既定値を求める
+* @param[out] STAGEBAKE_CONFIG *config
+*/
+void StageBake_GetDefaultConfig(STAGEBAKE_CONFIG *config)
+{
+	config->cellSize = 200.0f;
+	config->sampleNum = 64;
+	config->aoRange = 1500.0f;
+	config->bias = 2.0f;
+	config->threadNum = 4;
+}
+
+/**
+* @fn StageBake_AddOccluder
+* @brief モデルのポリゴンをレイを遮る三角形に加える
+* @param[in] int modelHandle
+* @param[in,out] int *triangleNum 加えた三角形の数( NULL の場合は数だけを返す )
+* @return int モデルのポリゴンの数
+*/
+static int StageBake_AddOccluder(int modelHandle, int *triangleNum)
+{
+	MV1SetupReferenceMesh(modelHandle, -1, true);
+	MV1_REF_POLYGONLIST refMesh = MV1GetReferenceMesh(modelHandle, -1, true);
+	if(triangleNum != NULL)
+	{
+		for(int i=0; i<refMesh.PolygonNum; i++)
+		{
+			STAGEBAKE_TRIANGLE *triangle = &stageBake.triangle[*triangleNum];
+			VECTOR p0 = refMesh.Vertexs[refMesh.Polygons[i].VIndex[0]].Position;
+			VECTOR p1 = refMesh.Vertexs[refMesh.Polygons[i].VIndex[1]].Position;
+			VECTOR p2 = refMesh.Vertexs[refMesh.Polygons[i].VIndex[2]].Position;
+			triangle->v0 = p0;
+			triangle->edge1 = VSub(p1, p0);
+			triangle->edge2 = VSub(p2, p0);
+			stageBake.centroid[*triangleNum] = VScale(VAdd(p0, VAdd(p1, p2)), 1.0f / 3.0f);
+			stageBake.triangleIndex[*triangleNum] = *triangleNum;
+			(*triangleNum)++;
+		}
+	}
+	MV1TerminateReferenceMesh(modelHandle, -1, true);
+	return refMesh.PolygonNum;
+}
+
+/**
+* @fn StageBake_BuildNode
+* @brief BVH のノードに三角形の範囲を割り当て、多ければ２つに分ける
+* @param[in] int nodeIndex, int first 三角形の番号の位置, int count 三角形の数, int depth ノードの深さ
+* @details 重心を囲む箱の一番長い軸の真ん中で分け、片方に寄ってしまう場合は数で半分に分ける
+*          STAGEBAKE_BALANCEDEPTH より深いノードは常に数で半分に分けるので、深さは STAGEBAKE_BALANCEDEPTH + 31 を超えない
+*/
+static void StageBake_BuildNode(int nodeIndex, int first, int count, int depth)
+{
+	STAGEBAKE_NODE *node = &stageBake.node[nodeIndex];
+	VECTOR centerMin = VGet(1.0e30f, 1.0e30f, 1.0e30f);
+	VECTOR centerMax = VGet(-1.0e30f, -1.0e30f, -1.0e30f);
+	node->bmin = centerMin;
+	node->bmax = centerMax;
+	for(int i=first; i<first+count; i++)
+	{
+		const STAGEBAKE_TRIANGLE *triangle = &stageBake.triangle[stageBake.triangleIndex[i]];
+		VECTOR p[3] = { triangle->v0, VAdd(triangle->v0, triangle->edge1), VAdd(triangle->v0, triangle->edge2) };
+		for(int k=0; k<3; k++)
+		{
+			node->bmin = VGet(p[k].x < node->bmin.x ? p[k].x : node->bmin.x, p[k].y < node->bmin.y ? p[k].y : node->bmin.y, p[k].z < node->bmin.z ? p[k].z : node->bmin.z);
+			node->bmax = VGet(p[k].x > node->bmax.x ? p[k].x : node->bmax.x, p[k].y > node->bmax.y ? p[k].y : node->bmax.y, p[k].z > node->bmax.z ? p[k].z : node->bmax.z);
+		}
+		VECTOR c = stageBake.centroid[stageBake.triangleIndex[i]];
+		centerMin = VGet(c.x < centerMin.x ? c.x : centerMin.x, c.y < centerMin.y ? c.y : centerMin.y, c.z < centerMin.z ? c.z : centerMin.z);
+		centerMax = VGet(c.x > centerMax.x ? c.x : centerMax.x, c.y > centerMax.y ? c.y : centerMax.y, c.z > centerMax.z ? c.z : centerMax.z);
+	}
+	if(count <= STAGEBAKE_LEAFSIZE)
+	{
+		node->first = first;
+		node->count = count;
+		stageBake.depth = depth > stageBake.depth ? depth : stageBake.depth;
+		return;
+	}
+
+	// 一番長い軸の真ん中で分ける
+	VECTOR size = VSub(centerMax, centerMin);
+	int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+	float split = ((&centerMin.x)[axis] + (&centerMax.x)[axis]) * 0.5f;
+	int middle = first;
+	for(int i=first; i<first+count; i++)
+	{
+		if((&stageBake.centroid[stageBake.triangleIndex[i]].x)[axis] < split)
+		{
+			int temp = stageBake.triangleIndex[i];
+			stageBake.triangleIndex[i] = stageBake.triangleIndex[middle];
+			stageBake.triangleIndex[middle] = temp;
+			middle++;
+		}
+	}
+	if(middle == first || middle == first + count || depth >= STAGEBAKE_BALANCEDEPTH)
+	{
+		middle = first + count / 2;
+	}
+
+	int left = stageBake.nodeNum;
+	stageBake.nodeNum += 2;
+	node->first = left;
+	node->count = 0;
+	StageBake_BuildNode(left, first, middle - first, depth + 1);
+	StageBake_BuildNode(left + 1, middle, first + count - middle, depth + 1);
+}
+
+/**
+* @fn StageBake_Occluded
+* @brief レイが指定の距離までに三角形に当たるかどうか
+* @param[in] VECTOR origin 始点, VECTOR dir 向き( 単位ベクトル ), float maxDistance 調べる距離
+* @return bool true:当たる  false:当たらない
+* @details どれか１つに当たれば終わるので、一番近い三角形は求めない
+*          スタックに積むのは BVH の深さ + 1 個までなので、StageBake_Build で深さを確かめてある
+*/
+static bool StageBake_Occluded(VECTOR origin, VECTOR dir, float maxDistance)
+{
+	float invDir[3] = { dir.x != 0.0f ? 1.0f / dir.x : 1.0e30f, dir.y != 0.0f ? 1.0f / dir.y : 1.0e30f, dir.z != 0.0f ? 1.0f / dir.z : 1.0e30f };
+	const float *o = &origin.x;
+	int stack[STAGEBAKE_STACKSIZE];
+	int stackNum = 0;
+	stack[stackNum++] = 0;
+	while(stackNum > 0)
+	{
+		const STAGEBAKE_NODE *node = &stageBake.node[stack[--stackNum]];
+
+		// 箱との交差判定
+		float tNear = 0.0f;
+		float tFar = maxDistance;
+		const float *bmin = &node->bmin.x;
+		const float *bmax = &node->bmax.x;
+		for(int k=0; k<3; k++)
+		{
+			float t0 = (bmin[k] - o[k]) * invDir[k];
+			float t1 = (bmax[k] - o[k]) * invDir[k];
+			if(t0 > t1)
+			{
+				float temp = t0;
+				t0 = t1;
+				t1 = temp;
+			}
+			tNear = t0 > tNear ? t0 : tNear;
+			tFar = t1 < tFar ? t1 : tFar;
+		}
+		if(tNear > tFar)
+		{
+			continue;
+		}
+
+		if(node->count == 0)
+		{
+			stack[stackNum++] = node->first;
+			stack[stackNum++] = node->first + 1;
+			continue;
+		}
+
+		// 三角形との交差判定( 両面 )
+		for(int i=node->first; i<node->first+node->count; i++)
+		{
+			const STAGEBAKE_TRIANGLE *triangle = &stageBake.triangle[stageBake.triangleIndex[i]];
+			VECTOR p = VCross(dir, triangle->edge2);
+			float det = VDot(triangle->edge1, p);
+			if(det > -1.0e-8f && det < 1.0e-8f)
+			{
+				continue;
+			}
+			float invDet = 1.0f / det;
+			VECTOR t = VSub(origin, triangle->v0);
+			float u = VDot(t, p) * invDet;
+			if(u < 0.0f || u > 1.0f)
+			{
+				continue;
+			}
+			VECTOR q = VCross(t, triangle->edge1);
+			float v = VDot(dir, q) * invDet;
+			if(v < 0.0f || u + v > 1.0f)
+			{
+				continue;
+			}
+			float distance = VDot(triangle->edge2, q) * invDet;
+			if(distance > 0.0f && distance < maxDistance)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+* @fn StageBake_RadicalInverse
+* @brief ビットを反転させた 0～1 の値( Hammersley 点列の２つ目の座標 )
+* @param[in] unsigned int bits
+* @return float
+*/
+static float StageBake_RadicalInverse(unsigned int bits)
+{
+	bits = (bits << 16) | (bits >> 16);
+	bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+	bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+	bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+	bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+	return bits * 2.3283064365386963e-10f;
+}
+
+/**
+* @fn StageBake_BakeVertex
+* @brief 頂点１つの遮蔽とライトの影を求めて頂点カラーにする
+* @param[in] int index 頂点の番号
+* @return int 飛ばしたレイの数
+* @details 半球のサンプルは頂点の位置から決まる回転をかけた Hammersley 点列なので、同じ位置の頂点は同じ結果になる
+*/
+static int StageBake_BakeVertex(int index)
+{
+	const STAGEBAKE_CONFIG *config = stageBake.config;
+	VERTEX3D *vertex = &stageBake.vertex[index];
+	VECTOR normal = vertex->norm;
+	VECTOR origin = VAdd(vertex->pos, VScale(normal, config->bias));
+
+	// 法線を Ｚ 軸とする座標系
+	VECTOR tangent = fabsf(normal.x) < 0.9f ? VGet(1.0f, 0.0f, 0.0f) : VGet(0.0f, 1.0f, 0.0f);
+	tangent = VNorm(VCross(tangent, normal));
+	VECTOR binormal = VCross(normal, tangent);
+
+	// 頂点の位置からサンプルの回転を決める
+	unsigned int hash = StageBake_Checksum((const unsigned char *)&vertex->pos, sizeof(VECTOR));
+	float rotate0 = (hash & 0xffff) / 65536.0f;
+	float rotate1 = (hash >> 16) / 65536.0f;
+
+	// 余弦で重み付けした半球のサンプルのうち、近くで遮られないものの割合
+	int openNum = 0;
+	for(int i=0; i<config->sampleNum; i++)
+	{
+		float u0 = (i + 0.5f) / config->sampleNum + rotate0;
+		float u1 = StageBake_RadicalInverse(i) + rotate1;
+		u0 -= u0 >= 1.0f ? 1.0f : 0.0f;
+		u1 -= u1 >= 1.0f ? 1.0f : 0.0f;
+		float r = sqrtf(u0);
+		float phi = 2.0f * DX_PI_F * u1;
+		VECTOR dir = VAdd(VAdd(VScale(tangent, r * cosf(phi)), VScale(binormal, r * sinf(phi))), VScale(normal, sqrtf(1.0f - u0)));
+		if(!StageBake_Occluded(origin, dir, config->aoRange))
+		{
+			openNum++;
+		}
+	}
+	float occlusion = config->sampleNum > 0 ? (float)openNum / config->sampleNum : 1.0f;
+	int rayNum = config->sampleNum;
+
+	// ライトの向きに遮る物が無ければ光が当たる
+	float lightRate = VDot(normal, stageBake.lightDir);
+	if(lightRate > 0.0f)
+	{
+		rayNum++;
+		if(StageBake_Occluded(origin, stageBake.lightDir, STAGEBAKE_FAR))
+		{
+			lightRate = 0.0f;
+		}
+	}
+	else
+	{
+		lightRate = 0.0f;
+	}
+
+	// 固定機能のライティングと同じ式で、アンビエントに遮蔽を、ディフューズに影をかける
+	const COLOR_F *dif = &stageBake.materialDif[stageBake.vertexMaterial[index]];
+	const COLOR_F *amb = &stageBake.materialAmb[stageBake.vertexMaterial[index]];
+	const COLOR_F *emi = &stageBake.materialEmi[stageBake.vertexMaterial[index]];
+	float color[3];
+	color[0] = dif->r * stageBake.lightDif.r * lightRate + amb->r * stageBake.lightAmb.r * occlusion + emi->r;
+	color[1] = dif->g * stageBake.lightDif.g * lightRate + amb->g * stageBake.lightAmb.g * occlusion + emi->g;
+	color[2] = dif->b * stageBake.lightDif.b * lightRate + amb->b * stageBake.lightAmb.b * occlusion + emi->b;
+	for(int k=0; k<3; k++)
+	{
+		color[k] = color[k] < 0.0f ? 0.0f : (color[k] > 1.0f ? 1.0f : color[k]);
+	}
+	vertex->dif = GetColorU8((int)(color[0] * 255.0f + 0.5f), (int)(color[1] * 255.0f + 0.5f), (int)(color[2] * 255.0f + 0.5f), (int)(dif->a * 255.0f + 0.5f));
+	return rayNum;
+}
+
+/**
+* @fn StageBake_WorkerThread
+* @brief 焼き込み用のスレッド、まだ焼き込んでいない頂点をまとめて取って焼き込む
+* @param[in] LPVOID param スレッドの番号
+* @return DWORD 0
+*/
+static DWORD WINAPI StageBake_WorkerThread(LPVOID param)
+{
+	int threadIndex = (int)(INT_PTR)param;
+	LONGLONG rayNum = 0;
+	for(;;)
+	{
+		LONG chunk = InterlockedIncrement(&stageBake.nextChunk) - 1;
+		int first = chunk * STAGEBAKE_CHUNKSIZE;
+		if(first >= stageBake.vertexNum)
+		{
+			break;
+		}
+		int last = first + STAGEBAKE_CHUNKSIZE < stageBake.vertexNum ? first + STAGEBAKE_CHUNKSIZE : stageBake.vertexNum;
+		for(int i=first; i<last; i++)
+		{
+			rayNum += StageBake_BakeVertex(i);
+		}
+	}
+	stageBake.rayNum[threadIndex] = rayNum;
+	return 0;
+}
+
+/**
+* @fn StageBake_GetSubdivision
+* @brief ポリゴンの辺を何分割するか
+* @param[in] VECTOR p0, VECTOR p1, VECTOR p2, float cellSize
+* @return int 1～STAGEBAKE_SUBDIVMAX
+*/
+static int StageBake_GetSubdivision(VECTOR p0, VECTOR p1, VECTOR p2, float cellSize)
+{
+	float edge = VSize(VSub(p1, p0));
+	float edge1 = VSize(VSub(p2, p1));
+	float edge2 = VSize(VSub(p0, p2));
+	edge = edge1 > edge ? edge1 : edge;
+	edge = edge2 > edge ? edge2 : edge;
+	int subdiv = (int)ceilf(edge / cellSize);
+	return subdiv < 1 ? 1 : (subdiv > STAGEBAKE_SUBDIVMAX ? STAGEBAKE_SUBDIVMAX : subdiv);
+}
+
+/**
+* @fn StageBake_Build
+* @brief ステージの頂点ごとに遮蔽と光の量を求めて、頂点カラーにしたステージをファイルに書き出す
+* @param[in] int stageModelHandle ステージ, const int *occluderModelHandle 配置したコリジョンモデル, int occluderNum コリジョンモデルの数
+* @param[in] const STAGEBAKE_CONFIG *config, const char *bakePath 書き出すファイル
+* @param[out] STAGEBAKE_STATS *stats 統計情報( NULL の場合は返さない )
+* @return bool true:成功  false:失敗
+* @details ライトは呼んだ時点の標準ライト、マテリアルはステージのモデルのものを使う
+*          ステージのポリゴンは cellSize 間隔に分割して、頂点を増やしてから焼き込む
+*/
+bool StageBake_Build(int stageModelHandle, const int *occluderModelHandle, int occluderNum, const STAGEBAKE_CONFIG *config, const char *bakePath, STAGEBAKE_STATS *stats)
+{
+	STAGEBAKE_STATS localStats;
+	if(stats == NULL)
+	{
+		stats = &localStats;
+	}
+	memset(stats, 0, sizeof(STAGEBAKE_STATS));
+	memset(&stageBake, 0, sizeof(stageBake));
+	stageBake.config = config;
+
+	// レイを遮る三角形を集めて BVH を作る
+	LONGLONG bvhStart = GetNowHiPerformanceCount();
+	int triangleMax = StageBake_AddOccluder(stageModelHandle, NULL);
+	for(int i=0; i<occluderNum; i++)
+	{
+		triangleMax += StageBake_AddOccluder(occluderModelHandle[i], NULL);
+	}
+	int allocNum = triangleMax > 0 ? triangleMax : 1;
+	stageBake.triangle = (STAGEBAKE_TRIANGLE *)malloc(sizeof(STAGEBAKE_TRIANGLE) * allocNum);
+	stageBake.triangleIndex = (int *)malloc(sizeof(int) * allocNum);
+	stageBake.centroid = (VECTOR *)malloc(sizeof(VECTOR) * allocNum);
+	stageBake.node = (STAGEBAKE_NODE *)malloc(sizeof(STAGEBAKE_NODE) * allocNum * 2);
+	bool result = triangleMax > 0 && stageBake.triangle != NULL && stageBake.triangleIndex != NULL && stageBake.centroid != NULL && stageBake.node != NULL;
+	if(result)
+	{
+		int triangleNum = 0;
+		StageBake_AddOccluder(stageModelHandle, &triangleNum);
+		for(int i=0; i<occluderNum; i++)
+		{
+			StageBake_AddOccluder(occluderModelHandle[i], &triangleNum);
+		}
+		stageBake.nodeNum = 1;
+		stageBake.depth = 0;
+		StageBake_BuildNode(0, 0, triangleNum, 0);
+		stats->occluderPolygonNum = triangleNum;
+		stats->nodeNum = stageBake.nodeNum;
+
+		// たどる時のスタックに収まらない深さなら焼き込まない
+		if(stageBake.depth + 1 > STAGEBAKE_STACKSIZE)
+		{
+			ErrorLogFmtAdd("StageBake : BVH depth %d exceeds the traversal stack", stageBake.depth);
+			result = false;
+		}
+	}
+	free(stageBake.centroid);
+	stageBake.centroid = NULL;
+	stats->bvhTime = GetNowHiPerformanceCount() - bvhStart;
+
+	// ステージのポリゴンを分割した頂点とインデックスをマテリアルの順に作る
+	MV1SetupReferenceMesh(stageModelHandle, -1, true);
+	MV1_REF_POLYGONLIST refMesh = MV1GetReferenceMesh(stageModelHandle, -1, true);
+	int materialNum = MV1GetMaterialNum(stageModelHandle);
+	materialNum = materialNum > 0 ? materialNum : 1;
+	int vertexNum = 0;
+	int indexNum = 0;
+	for(int i=0; i<refMesh.PolygonNum; i++)
+	{
+		const MV1_REF_POLYGON *polygon = &refMesh.Polygons[i];
+		int n = StageBake_GetSubdivision(refMesh.Vertexs[polygon->VIndex[0]].Position, refMesh.Vertexs[polygon->VIndex[1]].Position, refMesh.Vertexs[polygon->VIndex[2]].Position, config->cellSize);
+		vertexNum += (n + 1) * (n + 2) / 2;
+		indexNum += n * n * 3;
+	}
+	stageBake.vertex = (VERTEX3D *)malloc(sizeof(VERTEX3D) * (vertexNum > 0 ? vertexNum : 1));
+	stageBake.vertexMaterial = (int *)malloc(sizeof(int) * (vertexNum > 0 ? vertexNum : 1));
+	unsigned int *index = (unsigned int *)malloc(sizeof(unsigned int) * (indexNum > 0 ? indexNum : 1));
+	STAGEBAKE_GROUP *group = (STAGEBAKE_GROUP *)malloc(sizeof(STAGEBAKE_GROUP) * materialNum);
+	stageBake.materialDif = (COLOR_F *)malloc(sizeof(COLOR_F) * materialNum);
+	stageBake.materialAmb = (COLOR_F *)malloc(sizeof(COLOR_F) * materialNum);
+	stageBake.materialEmi = (COLOR_F *)malloc(sizeof(COLOR_F) * materialNum);
+	result = result && vertexNum > 0 && stageBake.vertex != NULL && stageBake.vertexMaterial != NULL && index != NULL && group != NULL &&
+		stageBake.materialDif != NULL && stageBake.materialAmb != NULL && stageBake.materialEmi != NULL;
+	int groupNum = 0;
+	if(result)
+	{
+		int vertexCount = 0;
+		int indexCount = 0;
+		for(int m=0; m<materialNum; m++)
+		{
+			stageBake.materialDif[m] = MV1GetMaterialDifColor(stageModelHandle, m);
+			stageBake.materialAmb[m] = MV1GetMaterialAmbColor(stageModelHandle, m);
+			stageBake.materialEmi[m] = MV1GetMaterialEmiColor(stageModelHandle, m);
+
+			int firstIndex = indexCount;
+			for(int i=0; i<refMesh.PolygonNum; i++)
+			{
+				const MV1_REF_POLYGON *polygon = &refMesh.Polygons[i];
+				if(polygon->MaterialIndex != m && !(m == 0 && (polygon->MaterialIndex < 0 || polygon->MaterialIndex >= materialNum)))
+				{
+					continue;
+				}
+				const MV1_REF_VERTEX *v[3] = { &refMesh.Vertexs[polygon->VIndex[0]], &refMesh.Vertexs[polygon->VIndex[1]], &refMesh.Vertexs[polygon->VIndex[2]] };
+				int n = StageBake_GetSubdivision(v[0]->Position, v[1]->Position, v[2]->Position, config->cellSize);
+
+				// 頂点０からの頂点１方向に i、頂点２方向に j 番目の点を作る
+				int base = vertexCount;
+				for(int a=0; a<=n; a++)
+				{
+					for(int b=0; b<=n-a; b++)
+					{
+						float w1 = (float)a / n;
+						float w2 = (float)b / n;
+						float w0 = 1.0f - w1 - w2;
+						VERTEX3D *dest = &stageBake.vertex[vertexCount];
+						dest->pos = VAdd(VAdd(VScale(v[0]->Position, w0), VScale(v[1]->Position, w1)), VScale(v[2]->Position, w2));
+						dest->norm = VNorm(VAdd(VAdd(VScale(v[0]->Normal, w0), VScale(v[1]->Normal, w1)), VScale(v[2]->Normal, w2)));
+						dest->dif = GetColorU8(255, 255, 255, 255);
+						dest->spc = GetColorU8(0, 0, 0, 0);
+						dest->u = v[0]->TexCoord[0].u * w0 + v[1]->TexCoord[0].u * w1 + v[2]->TexCoord[0].u * w2;
+						dest->v = v[0]->TexCoord[0].v * w0 + v[1]->TexCoord[0].v * w1 + v[2]->TexCoord[0].v * w2;
+						dest->su = 0.0f;
+						dest->sv = 0.0f;
+						stageBake.vertexMaterial[vertexCount] = m;
+						vertexCount++;
+					}
+				}
+				for(int a=0; a<n; a++)
+				{
+					int row = base + a * (n + 1) - a * (a - 1) / 2;
+					int nextRow = row + (n + 1 - a);
+					for(int b=0; b<n-a; b++)
+					{
+						index[indexCount++] = row + b;
+						index[indexCount++] = nextRow + b;
+						index[indexCount++] = row + b + 1;
+						if(b < n - a - 1)
+						{
+							index[indexCount++] = nextRow + b;
+							index[indexCount++] = nextRow + b + 1;
+							index[indexCount++] = row + b + 1;
+						}
+					}
+				}
+			}
+			if(indexCount > firstIndex)
+			{
+				group[groupNum].materialIndex = m;
+				group[groupNum].firstIndex = firstIndex;
+				group[groupNum].indexNum = indexCount - firstIndex;
+				groupNum++;
+			}
+		}
+		stageBake.vertexNum = vertexCount;
+		stats->vertexNum = vertexCount;
+		stats->polygonNum = indexCount / 3;
+	}
+
+	// 頂点を複数のスレッドで焼き込む
+	if(result)
+	{
+		stageBake.lightDir = VNorm(VScale(GetLightDirection(), -1.0f));
+		stageBake.lightDif = GetLightDifColor();
+		stageBake.lightAmb = GetLightAmbColor();
+		stageBake.nextChunk = 0;
+
+		LONGLONG bakeStart = GetNowHiPerformanceCount();
+		int threadNum = config->threadNum > STAGEBAKE_MAXTHREAD ? STAGEBAKE_MAXTHREAD : config->threadNum;
+		HANDLE thread[STAGEBAKE_MAXTHREAD];
+		int failNum = 0;
+		for(int i=0; i<threadNum; i++)
+		{
+			thread[i] = CreateThread(NULL, 0, StageBake_WorkerThread, (LPVOID)(INT_PTR)i, 0, NULL);
+			failNum += thread[i] == NULL ? 1 : 0;
+		}
+
+		// 起動できなかったスレッドがあれば、残りの頂点は呼び出したスレッドでも焼き込む( 頂点は取り合うので１回呼べば全て終わる )
+		if(threadNum <= 0 || failNum > 0)
+		{
+			StageBake_WorkerThread((LPVOID)(INT_PTR)STAGEBAKE_MAXTHREAD);
+		}
+		for(int i=0; i<threadNum; i++)
+		{
+			if(thread[i] != NULL)
+			{
+				WaitForSingleObject(thread[i], INFINITE);
+				CloseHandle(thread[i]);
+			}
+		}
+		stats->bakeTime = GetNowHiPerformanceCount() - bakeStart;
+		for(int i=0; i<=STAGEBAKE_MAXTHREAD; i++)
+		{
+			stats->rayNum += stageBake.rayNum[i];
+		}
+	}
+
+	// ファイルに書き出す
+	if(result)
+	{
+		STAGEBAKE_FILEHEADER header;
+		memset(&header, 0, sizeof(header));
+		header.magic = STAGEBAKE_MAGIC;
+		header.version = STAGEBAKE_VERSION;
+		header.headerSize = sizeof(STAGEBAKE_FILEHEADER);
+		header.sourcePolygonNum = refMesh.PolygonNum;
+		header.sourceVertexNum = refMesh.VertexNum;
+		header.vertexSize = sizeof(VERTEX3D);
+		header.vertexNum = stageBake.vertexNum;
+		header.indexNum = stats->polygonNum * 3;
+		header.groupNum = groupNum;
+		unsigned int groupSize = sizeof(STAGEBAKE_GROUP) * groupNum;
+		unsigned int vertexSize = sizeof(VERTEX3D) * header.vertexNum;
+		unsigned int indexSize = sizeof(unsigned int) * header.indexNum;
+		header.fileSize = header.headerSize + groupSize + vertexSize + indexSize;
+
+		unsigned char *image = (unsigned char *)malloc(header.fileSize);
+		result = image != NULL;
+		if(result)
+		{
+			unsigned char *body = image + header.headerSize;
+			memcpy(body, group, groupSize);
+			memcpy(body + groupSize, stageBake.vertex, vertexSize);
+			memcpy(body + groupSize + vertexSize, index, indexSize);
+			header.checksum = StageBake_Checksum(body, header.fileSize - header.headerSize);
+			memcpy(image, &header, sizeof(header));
+
+			result = false;
+			HANDLE fileHandle = CreateFileA(bakePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if(fileHandle != INVALID_HANDLE_VALUE)
+			{
+				DWORD writeSize = 0;
+				result = WriteFile(fileHandle, image, header.fileSize, &writeSize, NULL) != 0 && writeSize == header.fileSize;
+				CloseHandle(fileHandle);
+			}
+		}
+		free(image);
+	}
+	MV1TerminateReferenceMesh(stageModelHandle, -1, true);
+
+	free(stageBake.triangle);
+	free(stageBake.triangleIndex);
+	free(stageBake.node);
+	free(stageBake.vertex);
+	free(stageBake.vertexMaterial);
+	free(stageBake.materialDif);
+	free(stageBake.materialAmb);
+	free(stageBake.materialEmi);
+	free(index);
+	free(group);
+	memset(&stageBake, 0, sizeof(stageBake));
+	return result;
+}
+
+/**
+* @fn StageBake_Load
+* @brief 焼き込んだファイルを読み込んで頂点バッファを作る
+* @param[in] int stageModelHandle テクスチャとポリゴンの数の確認に使うステージ, const char *bakePath
+* @return bool true:成功  false:ファイルが無いか、壊れているか、ステージのモデルが変わっている
+*/
+bool StageBake_Load(int stageModelHandle, const char *bakePath)
+{
+	StageBake_Unload();
+
+	HANDLE fileHandle = CreateFileA(bakePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	DWORD fileSize = GetFileSize(fileHandle, NULL);
+	unsigned char *image = fileSize != INVALID_FILE_SIZE && fileSize >= sizeof(STAGEBAKE_FILEHEADER) ? (unsigned char *)malloc(fileSize) : NULL;
+	DWORD readSize = 0;
+	bool result = image != NULL && ReadFile(fileHandle, image, fileSize, &readSize, NULL) != 0 && readSize == fileSize;
+	CloseHandle(fileHandle);
+
+	// 形式とサイズとチェックサム、焼き込んだ時のステージのポリゴンの数を確認する
+	const STAGEBAKE_FILEHEADER *header = (const STAGEBAKE_FILEHEADER *)image;
+	if(result)
+	{
+		MV1SetupReferenceMesh(stageModelHandle, -1, true);
+		MV1_REF_POLYGONLIST refMesh = MV1GetReferenceMesh(stageModelHandle, -1, true);
+		MV1TerminateReferenceMesh(stageModelHandle, -1, true);
+		result = header->magic == STAGEBAKE_MAGIC &&
+			header->version == STAGEBAKE_VERSION &&
+			header->headerSize == sizeof(STAGEBAKE_FILEHEADER) &&
+			header->fileSize == fileSize &&
+			header->vertexSize == sizeof(VERTEX3D) &&
+			header->vertexNum > 0 && header->indexNum > 0 && header->groupNum > 0 &&
+			header->sourcePolygonNum == refMesh.PolygonNum && header->sourceVertexNum == refMesh.VertexNum &&
+			(unsigned long long)header->headerSize + sizeof(STAGEBAKE_GROUP) * (unsigned long long)header->groupNum +
+				sizeof(VERTEX3D) * (unsigned long long)header->vertexNum + sizeof(unsigned int) * (unsigned long long)header->indexNum == fileSize &&
+			header->checksum == StageBake_Checksum(image + header->headerSize, fileSize - header->headerSize);
+	}
+	const STAGEBAKE_GROUP *group = NULL;
+	const VERTEX3D *vertex = NULL;
+	const unsigned int *index = NULL;
+	if(result)
+	{
+		group = (const STAGEBAKE_GROUP *)(image + header->headerSize);
+		vertex = (const VERTEX3D *)(group + header->groupNum);
+		index = (const unsigned int *)(vertex + header->vertexNum);
+		for(int i=0; i<header->groupNum && result; i++)
+		{
+			result = group[i].firstIndex >= 0 && group[i].indexNum >= 0 && group[i].firstIndex <= header->indexNum - group[i].indexNum;
+		}
+		for(int i=0; i<header->indexNum && result; i++)
+		{
+			result = index[i] < (unsigned int)header->vertexNum;
+		}
+	}
+
+	// 頂点バッファを作り、グループごとのテクスチャをステージのモデルから取得する
+	if(result)
+	{
+		stageBakeDraw.group = (STAGEBAKE_GROUP *)malloc(sizeof(STAGEBAKE_GROUP) * header->groupNum);
+		stageBakeDraw.textureHandle = (int *)malloc(sizeof(int) * header->groupNum);
+		stageBakeDraw.vertexBufferHandle = CreateVertexBuffer(header->vertexNum, DX_VERTEX_TYPE_NORMAL_3D);
+		stageBakeDraw.indexBufferHandle = CreateIndexBuffer(header->indexNum, DX_INDEX_TYPE_32BIT);
+		result = stageBakeDraw.group != NULL && stageBakeDraw.textureHandle != NULL && stageBakeDraw.vertexBufferHandle != -1 && stageBakeDraw.indexBufferHandle != -1;
+	}
+	if(result)
+	{
+		SetVertexBufferData(0, vertex, header->vertexNum, stageBakeDraw.vertexBufferHandle);
+		SetIndexBufferData(0, index, header->indexNum, stageBakeDraw.indexBufferHandle);
+		memcpy(stageBakeDraw.group, group, sizeof(STAGEBAKE_GROUP) * header->groupNum);
+		for(int i=0; i<header->groupNum; i++)
+		{
+			int textureIndex = MV1GetMaterialDifMapTexture(stageModelHandle, group[i].materialIndex);
+			stageBakeDraw.textureHandle[i] = textureIndex >= 0 ? MV1GetTextureGraphHandle(stageModelHandle, textureIndex) : DX_NONE_GRAPH;
+		}
+		stageBakeDraw.vertexNum = header->vertexNum;
+		stageBakeDraw.groupNum = header->groupNum;
+	}
+	free(image);
+
+	if(!result)
+	{
+		StageBake_Unload();
+	}
+	return result;
+}
+
+/**
+* @fn StageBake_Unload
+* @brief 頂点バッファの後始末
+* @details テクスチャはステージのモデルのものなので削除しない
+*/
+void StageBake_Unload()
+{
+	if(stageBakeDraw.vertexBufferHandle != -1)
+	{
+		DeleteVertexBuffer(stageBakeDraw.vertexBufferHandle);
+		stageBakeDraw.vertexBufferHandle = -1;
+	}
+	if(stageBakeDraw.indexBufferHandle != -1)
+	{
+		DeleteIndexBuffer(stageBakeDraw.indexBufferHandle);
+		stageBakeDraw.indexBufferHandle = -1;
+	}
+	free(stageBakeDraw.group);
+	free(stageBakeDraw.textureHandle);
+	stageBakeDraw.group = NULL;
+	stageBakeDraw.textureHandle = NULL;
+	stageBakeDraw.vertexNum = 0;
+	stageBakeDraw.groupNum = 0;
+}
+
+/**
+* @fn StageBake_IsLoaded
+* @brief 焼き込んだステージを読み込んでいるかどうか
+* @return bool true:読み込んでいる  false:読み込んでいない
+*/
+bool StageBake_IsLoaded()
+{
+	return stageBakeDraw.vertexBufferHandle != -1;
+}
+
+/**
+* @fn StageBake_Draw
+* @brief 焼き込んだステージをライティング無しで描画する
+* @details 頂点カラーに光の量が入っているので、テクスチャの色にそのまま掛ける
+*/
+void StageBake_Draw()
+{
+	if(!StageBake_IsLoaded())
+	{
+		return;
+	}
+
+	// ライティングを無効にして、Ｚバッファを使う
+	SetUseLighting(false);
+	SetUseZBuffer3D(true);
+	SetWriteZBuffer3D(true);
+
+	// ステージのテクスチャは繰り返して貼る( 影の描画で CLAMP にしているため戻す )
+	SetTextureAddressMode(DX_TEXADDRESS_WRAP);
+
+	for(int i=0; i<stageBakeDraw.groupNum; i++)
+	{
+		const STAGEBAKE_GROUP *group = &stageBakeDraw.group[i];
+		DrawPrimitiveIndexed3D_UseVertexBuffer2(stageBakeDraw.vertexBufferHandle, stageBakeDraw.indexBufferHandle, DX_PRIMTYPE_TRIANGLELIST,
+			0, 0, stageBakeDraw.vertexNum, group->firstIndex, group->indexNum, stageBakeDraw.textureHandle[i], false);
+	}
+
+	// 設定を元に戻す
+	SetUseLighting(true);
+	SetUseZBuffer3D(false);
+	SetWriteZBuffer3D(false);
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int STAGEBAKE_MAXTHREAD = 8;				//!< ライティングの焼き込みに使用するスレッドの最大数
+const int STAGEBAKE_SUBDIVMAX = 16;				//!< ステージのポリゴン１つの辺を分割する最大数
+
+/**
+* @struct STAGEBAKE_CONFIG
+* @brief ステージのライティングの焼き込みの設定
+* @details 長さは全てワールド座標の単位で指定する
+*/
+struct STAGEBAKE_CONFIG
+{
+	float cellSize;							//!< ポリゴンを分割して頂点を置く間隔( 頂点ごとに焼き込むので、細かいほど影がはっきりする )
+	int sampleNum;							//!< 頂点１つから半球に飛ばすレイの数
+	float aoRange;							//!< これより近くに物があれば遮られているとする距離
+	float bias;								//!< レイの始点を法線の向きにずらす距離( 自分自身に当たらないようにする )
+	int threadNum;							//!< 焼き込みに使用するスレッドの数( 0 の場合は呼び出したスレッドで焼き込む )
+};
+
+/**
+* @struct STAGEBAKE_STATS
+* @brief ステージのライティングの焼き込みの統計情報
+*/
+struct STAGEBAKE_STATS
+{
+	int occluderPolygonNum;					//!< レイを遮るポリゴンの数
+	int nodeNum;							//!< BVH のノードの数
+	int vertexNum;							//!< 焼き込んだ頂点の数
+	int polygonNum;							//!< 焼き込んだポリゴンの数
+	LONGLONG rayNum;						//!< 飛ばしたレイの数
+	LONGLONG bvhTime;						//!< BVH の構築にかかった時間( マイクロ秒 )
+	LONGLONG bakeTime;						//!< 焼き込みにかかった時間( マイクロ秒 )
+};
+
+void StageBake_GetDefaultConfig(STAGEBAKE_CONFIG *config);	//!< 焼き込みの設定の既定値を求める
+bool StageBake_Build(int stageModelHandle, const int *occluderModelHandle, int occluderNum, const STAGEBAKE_CONFIG *config, const char *bakePath, STAGEBAKE_STATS *stats);	//!< ステージの頂点ごとに遮蔽と光の量を求めてファイルに書き出す( 戻り値  true:成功  false:失敗 )
+bool StageBake_Load(int stageModelHandle, const char *bakePath);	//!< 焼き込んだファイルを読み込んで頂点バッファを作る( 戻り値  true:成功  false:ファイルが無いか古い )
+void StageBake_Unload();					//!< 頂点バッファの後始末
+bool StageBake_IsLoaded();					//!< 焼き込んだステージを読み込んでいるかどうか
+void StageBake_Draw();						//!< 焼き込んだステージをライティング無しで描画する
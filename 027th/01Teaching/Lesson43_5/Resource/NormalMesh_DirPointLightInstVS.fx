@@ -0,0 +1,266 @@
+// 頂点シェーダーの入力
+struct VS_INPUT
+{
+	float4 Position        : POSITION ;     // 座標( ローカル空間 )
+	float3 Normal          : NORMAL0 ;      // 法線( ローカル空間 )
+	float4 Diffuse         : COLOR0 ;       // ディフューズカラー
+	float4 Specular        : COLOR1 ;       // スペキュラカラー
+	float4 TexCoords0      : TEXCOORD0 ;	// テクスチャ座標
+	float4 TexCoords1      : TEXCOORD1 ;	// x:インスタンスの番号( C++ 側の InstanceMesh で頂点ごとに入れる )
+} ;
+
+// 頂点シェーダーの出力
+struct VS_OUTPUT
+{
+	float4 Position        : POSITION ;
+	float4 Diffuse         : COLOR0 ;
+	float4 Specular        : COLOR1 ;
+	float2 TexCoords0      : TEXCOORD0 ;
+} ;
+
+// マテリアルパラメータ
+struct VS_CONST_MATERIAL
+{
+	float4 Diffuse ;                // マテリアルディフューズカラー
+	float4 Specular ;               // マテリアルスペキュラカラー
+	float4 Power ;                  // マテリアルスペキュラハイライトの強さ
+} ;
+
+// ライトパラメータ
+struct VS_CONST_LIGHT
+{
+	float4 Position ;               // 座標( ビュー空間 )
+	float3 Direction ;              // 方向( ビュー空間 )
+	float4 Diffuse ;                // ディフューズカラー
+	float4 Specular ;               // スペキュラカラー
+	float4 Ambient ;                // アンビエントカラーとマテリアルのアンビエントカラーを乗算したもの
+	float4 Range_FallOff_AT0_AT1 ;  // x:有効距離  y:スポットライト用FallOff  z:距離による減衰処理用パラメータ０  w:距離による減衰処理用パラメータ１
+	float4 AT2_SpotP0_SpotP1 ;      // x:距離による減衰処理用パラメータ２  y:スポットライト用パラメータ０( cos( Phi / 2.0f ) )  z:スポットライト用パラメータ１( 1.0f / ( cos( Theta / 2.0f ) - cos( Phi / 2.0f ) ) )
+} ;
+
+// 沢山のライトから選んだポイントライトとスポットライトのパラメータ( C++ 側の LightBin_SetShaderConst で設定する )
+struct VS_CONST_LIGHTSLOT
+{
+	float4 Position_RangePow2 ;     // xyz:座標( ビュー空間 )  w:有効距離の二乗( 使わないスロットは 0 )
+	float4 Direction_SpotP0 ;       // xyz:方向( ビュー空間 )  w:スポットライト用パラメータ０( cos( Phi / 2.0f )、ポイントライトは -2 )
+	float4 Diffuse_SpotP1 ;         // xyz:ディフューズカラー  w:スポットライト用パラメータ１( 1.0f / ( cos( Theta / 2.0f ) - cos( Phi / 2.0f ) )、ポイントライトは 1 )
+	float4 Specular ;               // スペキュラカラー
+	float4 AT0_AT1_AT2 ;            // x:距離による減衰処理用パラメータ０  y:距離による減衰処理用パラメータ１  z:距離による減衰処理用パラメータ２
+} ;
+
+// １回の描画で使うポイントライトとスポットライトの数( C++ 側の LIGHTBIN_SLOTNUM と合わせる )
+#define LIGHTSLOT_NUM		4
+
+// １回の描画で描くインスタンスの最大数( C++ 側の INSTANCEMESH_BATCHMAX と合わせる )
+#define INSTANCE_NUM		52
+
+
+
+// C++ 側で設定する定数の定義
+float4              cfAmbient_Emissive        : register( c1  ) ;		// マテリアルエミッシブカラー + マテリアルアンビエントカラー * グローバルアンビエントカラー
+float4              cfProjectionMatrix[ 4 ]   : register( c2  ) ;		// ビュー　　→　射影行列
+float4              cfViewMatrix[ 3 ]         : register( c6  ) ;		// ワールド　→　ビュー行列
+float4              cfInstanceMatrix[ INSTANCE_NUM * 3 ] : register( c100 ) ;	// インスタンスごとのローカル　→　ワールド行列
+VS_CONST_MATERIAL   cfMaterial                : register( c11 ) ;		// マテリアルパラメータ
+VS_CONST_LIGHT      cfLight[ 1 ]              : register( c14 ) ;		// ディレクショナルライトのパラメータ
+VS_CONST_LIGHTSLOT  cfLightSlot[ LIGHTSLOT_NUM ] : register( c56 ) ;	// 選んだポイントライトとスポットライトのパラメータ
+
+
+// main関数
+VS_OUTPUT main( VS_INPUT VSInput )
+{
+	VS_OUTPUT VSOutput ;
+	float4 lWorldPosition ;
+	float4 lViewPosition ;
+	float3 lWorldNrm ;
+	float3 lViewNrm ;
+	float3 lLightHalfVec ;
+	float4 lLightLitParam ;
+	float4 lLightLitDest ;
+	float3 lLightDir ;
+	float3 lLightTemp ;
+	float lLightDistancePow2 ;
+	float lLightGen ;
+	float4 lTotalDiffuse ;
+	float4 lTotalSpecular ;
+	int lInstance ;
+
+
+	// 頂点座標変換 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 開始 )
+
+	// インスタンスの行列の先頭
+	lInstance = ( int )VSInput.TexCoords1.x * 3 ;
+
+	// ローカル座標をワールド座標に変換
+	lWorldPosition.x = dot( VSInput.Position, cfInstanceMatrix[ lInstance + 0 ] ) ;
+	lWorldPosition.y = dot( VSInput.Position, cfInstanceMatrix[ lInstance + 1 ] ) ;
+	lWorldPosition.z = dot( VSInput.Position, cfInstanceMatrix[ lInstance + 2 ] ) ;
+	lWorldPosition.w = 1.0f ;
+
+	// ワールド座標をビュー座標に変換
+	lViewPosition.x = dot( lWorldPosition, cfViewMatrix[ 0 ] ) ;
+	lViewPosition.y = dot( lWorldPosition, cfViewMatrix[ 1 ] ) ;
+	lViewPosition.z = dot( lWorldPosition, cfViewMatrix[ 2 ] ) ;
+	lViewPosition.w = 1.0f ;
+
+	// ビュー座標を射影座標に変換
+	VSOutput.Position.x = dot( lViewPosition, cfProjectionMatrix[ 0 ] ) ;
+	VSOutput.Position.y = dot( lViewPosition, cfProjectionMatrix[ 1 ] ) ;
+	VSOutput.Position.z = dot( lViewPosition, cfProjectionMatrix[ 2 ] ) ;
+	VSOutput.Position.w = dot( lViewPosition, cfProjectionMatrix[ 3 ] ) ;
+
+	// 頂点座標変換 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
+
+
+
+	// ライトの処理 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 開始 )
+
+	// ディフューズカラーとスペキュラカラーの蓄積値の初期化
+	lTotalDiffuse  = float4( 0, 0, 0, 0 ) ;
+	lTotalSpecular = float4( 0, 0, 0, 0 ) ;
+
+	// 法線をビュー空間の角度に変換 =====================================================( 開始 )
+
+	// ローカルベクトルをワールドベクトルに変換
+	lWorldNrm.x = dot( VSInput.Normal, cfInstanceMatrix[ lInstance + 0 ].xyz ) ;
+	lWorldNrm.y = dot( VSInput.Normal, cfInstanceMatrix[ lInstance + 1 ].xyz ) ;
+	lWorldNrm.z = dot( VSInput.Normal, cfInstanceMatrix[ lInstance + 2 ].xyz ) ;
+
+	// ワールドベクトルをビューベクトルに変換
+	lViewNrm.x = dot( lWorldNrm, cfViewMatrix[ 0 ].xyz ) ;
+	lViewNrm.y = dot( lWorldNrm, cfViewMatrix[ 1 ].xyz ) ;
+	lViewNrm.z = dot( lWorldNrm, cfViewMatrix[ 2 ].xyz ) ;
+
+	// 法線をビュー空間の角度に変換 =====================================================( 終了 )
+
+
+
+
+	// ディレクショナルライトの処理 *****************************************************( 開始 )
+
+	// ライトの方向セット
+	lLightDir = cfLight[ 0 ].Direction ;
+
+
+	// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 =======( 開始 )
+
+	// 法線とライトの逆方向ベクトルとの内積を lLightLitParam.x にセット
+	lLightLitParam.x = dot( lViewNrm, -lLightDir ) ;
+
+	// ハーフベクトルの計算 norm( ( norm( 頂点位置から視点へのベクトル ) + ライトの方向 ) )
+	lLightHalfVec = normalize( normalize( -lViewPosition.xyz ) - lLightDir ) ;
+
+	// 法線とハーフベクトルの内積を lLightLitParam.y にセット
+	lLightLitParam.y = dot( lLightHalfVec, lViewNrm ) ;
+
+	// スペキュラ反射率を lLightLitParam.w にセット
+	lLightLitParam.w = cfMaterial.Power.x ;
+
+	// ライト計算
+	lLightLitDest = lit( lLightLitParam.x, lLightLitParam.y, lLightLitParam.w ) ;
+
+	// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 =======( 終了 )
+
+
+	// カラー計算 ===========================================================( 開始 )
+
+	// ディフューズライト蓄積値 += ディフューズ角度減衰計算結果 * マテリアルディフューズカラー * ライトのディフューズカラー + ライトのアンビエントカラーとマテリアルのアンビエントカラーを乗算したもの
+	lTotalDiffuse += lLightLitDest.y * cfLight[ 0 ].Diffuse * cfMaterial.Diffuse + cfLight[ 0 ].Ambient ;
+
+	// スペキュラライト蓄積値 += スペキュラ角度減衰計算結果 * ライトのスペキュラカラー
+	lTotalSpecular += lLightLitDest.z * cfLight[ 0 ].Specular ;
+
+	// カラー計算 ===========================================================( 終了 )
+
+	// ディレクショナルライトの処理 *****************************************************( 終了 )
+
+
+
+
+	// ポイントライトとスポットライトの処理 *******************************************( 開始 )
+
+	// C++ 側で選んだライトの数だけ繰り返す( 使わないスロットは有効距離が 0 なので何も足されない )
+	for( int i = 0 ; i < LIGHTSLOT_NUM ; i ++ )
+	{
+		// 距離減衰値計算 ===================================================( 開始 )
+
+		// 頂点とライト位置との距離の二乗を求める
+		lLightTemp = lViewPosition.xyz - cfLightSlot[ i ].Position_RangePow2.xyz ;
+		lLightDistancePow2 = dot( lLightTemp, lLightTemp ) ;
+
+		// ライト方向ベクトルの計算
+		lLightDir = lLightTemp * rsqrt( max( lLightDistancePow2, 0.000001f ) ) ;
+
+		// 減衰率の計算 lLightGen = 1 / ( 減衰値0 + 減衰値1 * 距離 + 減衰値2 * ( 距離 * 距離 ) )
+		lLightGen = 1.0f / ( cfLightSlot[ i ].AT0_AT1_AT2.x + cfLightSlot[ i ].AT0_AT1_AT2.y * sqrt( lLightDistancePow2 ) + cfLightSlot[ i ].AT0_AT1_AT2.z * lLightDistancePow2 ) ;
+
+		// 有効距離外だったら減衰率を最大にする処理
+		lLightGen *= step( lLightDistancePow2, cfLightSlot[ i ].Position_RangePow2.w ) ;
+
+		// スポットライトのコーンの外側なら減衰率を最大にする処理( ポイントライトは常に 1 になる )
+		lLightGen *= saturate( ( dot( lLightDir, cfLightSlot[ i ].Direction_SpotP0.xyz ) - cfLightSlot[ i ].Direction_SpotP0.w ) * cfLightSlot[ i ].Diffuse_SpotP1.w ) ;
+
+		// 距離減衰値計算 ===================================================( 終了 )
+
+
+		// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 ===( 開始 )
+
+		// 法線とライトの逆方向ベクトルとの内積を lLightLitParam.x にセット
+		lLightLitParam.x = dot( lViewNrm, -lLightDir ) ;
+
+		// ハーフベクトルの計算 norm( ( norm( 頂点位置から視点へのベクトル ) + ライトの方向 ) )
+		lLightHalfVec = normalize( normalize( -lViewPosition.xyz ) - lLightDir ) ;
+
+		// 法線とハーフベクトルの内積を lLightLitParam.y にセット
+		lLightLitParam.y = dot( lLightHalfVec, lViewNrm ) ;
+
+		// スペキュラ反射率を lLightLitParam.w にセット
+		lLightLitParam.w = cfMaterial.Power.x ;
+
+		// ライト計算
+		lLightLitDest = lit( lLightLitParam.x, lLightLitParam.y, lLightLitParam.w ) ;
+
+		// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 ===( 終了 )
+
+
+		// カラー計算 =======================================================( 開始 )
+
+		// ディフーズライト蓄積値 += 距離・スポットライト角度減衰値 * ディフーズ角度減衰計算結果 * マテリアルディフューズカラー * ライトのディフーズカラー
+		lTotalDiffuse += lLightGen * lLightLitDest.y * float4( cfLightSlot[ i ].Diffuse_SpotP1.xyz, 0.0f ) * cfMaterial.Diffuse ;
+
+		// スペキュラライト蓄積値 += スペキュラ角度減衰計算結果 * 距離・スポットライト減衰 * ライトのスペキュラカラー
+		lTotalSpecular += lLightGen * lLightLitDest.z * cfLightSlot[ i ].Specular ;
+
+		// カラー計算 =======================================================( 終了 )
+	}
+
+	// ポイントライトとスポットライトの処理 *******************************************( 終了 )
+
+
+	// ライトの処理 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
+
+
+
+
+	// 出力パラメータセット ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 開始 )
+
+	// ディフューズカラー = ディフューズライト蓄積値 + マテリアルのアンビエントカラーとグローバルアンビエントカラーを乗算したものとマテリアルエミッシブカラーを加算したもの
+	VSOutput.Diffuse = lTotalDiffuse + cfAmbient_Emissive ;
+
+	// ディフューズアルファはマテリアルのディフューズカラーのアルファをそのまま使う
+	VSOutput.Diffuse.w = cfMaterial.Diffuse.w ;
+
+	// スペキュラカラー = スペキュラライト蓄積値 * マテリアルのスペキュラカラー
+	VSOutput.Specular = lTotalSpecular * cfMaterial.Specular ;
+
+
+	// テクスチャ座標をそのままセット( モデルとして描画しないのでテクスチャ座標変換行列は使わない )
+	VSOutput.TexCoords0 = VSInput.TexCoords0.xy ;
+
+	// 出力パラメータセット ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
+
+
+	// 出力パラメータを返す
+	return VSOutput ;
+}
+
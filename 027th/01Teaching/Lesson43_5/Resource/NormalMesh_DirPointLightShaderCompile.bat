@@ -1,3 +1,8 @@
-ShaderCompiler.exe /Tvs_2_0 NormalMesh_DirPointLightVS.fx
-ShaderCompiler.exe /Tps_2_0 NormalMesh_DirPointLightPS.fx
-pause
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_DirPointLightVS.fx || goto error
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_DirPointLightInstVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_DirPointLightPS.fx || goto error
+if "%1"=="" pause
+exit /b 0
+:error
+if "%1"=="" pause
+exit /b 1
@@ -37,6 +37,19 @@ struct VS_CONST_LIGHT
 	float4 AT2_SpotP0_SpotP1 ;      // x:距離による減衰処理用パラメータ２  y:スポットライト用パラメータ０( cos( Phi / 2.0f ) )  z:スポットライト用パラメータ１( 1.0f / ( cos( Theta / 2.0f ) - cos( Phi / 2.0f ) ) )
 } ;
 
+// 沢山のライトから選んだポイントライトとスポットライトのパラメータ( C++ 側の LightBin_SetShaderConst で設定する )
+struct VS_CONST_LIGHTSLOT
+{
+	float4 Position_RangePow2 ;     // xyz:座標( ビュー空間 )  w:有効距離の二乗( 使わないスロットは 0 )
+	float4 Direction_SpotP0 ;       // xyz:方向( ビュー空間 )  w:スポットライト用パラメータ０( cos( Phi / 2.0f )、ポイントライトは -2 )
+	float4 Diffuse_SpotP1 ;         // xyz:ディフューズカラー  w:スポットライト用パラメータ１( 1.0f / ( cos( Theta / 2.0f ) - cos( Phi / 2.0f ) )、ポイントライトは 1 )
+	float4 Specular ;               // スペキュラカラー
+	float4 AT0_AT1_AT2 ;            // x:距離による減衰処理用パラメータ０  y:距離による減衰処理用パラメータ１  z:距離による減衰処理用パラメータ２
+} ;
+
+// １回の描画で使うポイントライトとスポットライトの数( C++ 側の LIGHTBIN_SLOTNUM と合わせる )
+#define LIGHTSLOT_NUM		4
+
 
 
 // C++ 側で設定する定数の定義
@@ -46,7 +59,8 @@ float4              cfViewMatrix[ 3 ]         : register( c6  ) ;		// ワール
 float4              cfTextureMatrix[ 3 ][ 2 ] : register( c88 ) ;		// テクスチャ座標操作用行列
 float4              cfLocalWorldMatrix[ 3 ]   : register( c94 ) ;		// ローカル　→　ワールド行列
 VS_CONST_MATERIAL   cfMaterial                : register( c11 ) ;		// マテリアルパラメータ
-VS_CONST_LIGHT      cfLight[ 2 ]              : register( c14 ) ;		// ディレクショナルライトとポイントライトのパラメータ
+VS_CONST_LIGHT      cfLight[ 1 ]              : register( c14 ) ;		// ディレクショナルライトのパラメータ
+VS_CONST_LIGHTSLOT  cfLightSlot[ LIGHTSLOT_NUM ] : register( c56 ) ;	// 選んだポイントライトとスポットライトのパラメータ
 
 
 // main関数
@@ -156,58 +170,64 @@ VS_OUTPUT main( VS_INPUT VSInput )
 
 
 
-	// ポイントライトの処理 *************************************************************( 開始 )
+	// ポイントライトとスポットライトの処理 *******************************************( 開始 )
 
-	// ライト方向ベクトルの計算
-	lLightDir = normalize( lViewPosition.xyz - cfLight[ 1 ].Position.xyz ) ;
+	// C++ 側で選んだライトの数だけ繰り返す( 使わないスロットは有効距離が 0 なので何も足されない )
+	for( int i = 0 ; i < LIGHTSLOT_NUM ; i ++ )
+	{
+		// 距離減衰値計算 ===================================================( 開始 )
 
+		// 頂点とライト位置との距離の二乗を求める
+		lLightTemp = lViewPosition.xyz - cfLightSlot[ i ].Position_RangePow2.xyz ;
+		lLightDistancePow2 = dot( lLightTemp, lLightTemp ) ;
 
-	// 距離減衰値計算 =======================================================( 開始 )
+		// ライト方向ベクトルの計算
+		lLightDir = lLightTemp * rsqrt( max( lLightDistancePow2, 0.000001f ) ) ;
 
-	// 頂点とライト位置との距離の二乗を求める
-	lLightTemp = lViewPosition.xyz - cfLight[ 1 ].Position.xyz ;
-	lLightDistancePow2 = dot( lLightTemp, lLightTemp ) ;
+		// 減衰率の計算 lLightGen = 1 / ( 減衰値0 + 減衰値1 * 距離 + 減衰値2 * ( 距離 * 距離 ) )
+		lLightGen = 1.0f / ( cfLightSlot[ i ].AT0_AT1_AT2.x + cfLightSlot[ i ].AT0_AT1_AT2.y * sqrt( lLightDistancePow2 ) + cfLightSlot[ i ].AT0_AT1_AT2.z * lLightDistancePow2 ) ;
 
-	// 減衰率の計算 lLightGen = 1 / ( 減衰値0 + 減衰値1 * 距離 + 減衰値2 * ( 距離 * 距離 ) )
-	lLightGen = 1.0f / ( cfLight[ 1 ].Range_FallOff_AT0_AT1.z + cfLight[ 1 ].Range_FallOff_AT0_AT1.w * sqrt( lLightDistancePow2 ) + cfLight[ 1 ].AT2_SpotP0_SpotP1.x * lLightDistancePow2 ) ;
+		// 有効距離外だったら減衰率を最大にする処理
+		lLightGen *= step( lLightDistancePow2, cfLightSlot[ i ].Position_RangePow2.w ) ;
 
-	// 有効距離外だったら減衰率を最大にする処理
-	lLightGen *= step( lLightDistancePow2, cfLight[ 1 ].Range_FallOff_AT0_AT1.x ) ;
+		// スポットライトのコーンの外側なら減衰率を最大にする処理( ポイントライトは常に 1 になる )
+		lLightGen *= saturate( ( dot( lLightDir, cfLightSlot[ i ].Direction_SpotP0.xyz ) - cfLightSlot[ i ].Direction_SpotP0.w ) * cfLightSlot[ i ].Diffuse_SpotP1.w ) ;
 
-	// 距離減衰値計算 =======================================================( 終了 )
+		// 距離減衰値計算 ===================================================( 終了 )
 
 
-	// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 =======( 開始 )
+		// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 ===( 開始 )
 
-	// 法線とライトの逆方向ベクトルとの内積を lLightLitParam.x にセット
-	lLightLitParam.x = dot( lViewNrm, -lLightDir ) ;
+		// 法線とライトの逆方向ベクトルとの内積を lLightLitParam.x にセット
+		lLightLitParam.x = dot( lViewNrm, -lLightDir ) ;
 
-	// ハーフベクトルの計算 norm( ( norm( 頂点位置から視点へのベクトル ) + ライトの方向 ) )
-	lLightHalfVec = normalize( normalize( -lViewPosition.xyz ) - lLightDir ) ;
+		// ハーフベクトルの計算 norm( ( norm( 頂点位置から視点へのベクトル ) + ライトの方向 ) )
+		lLightHalfVec = normalize( normalize( -lViewPosition.xyz ) - lLightDir ) ;
 
-	// 法線とハーフベクトルの内積を lLightLitParam.y にセット
-	lLightLitParam.y = dot( lLightHalfVec, lViewNrm ) ;
+		// 法線とハーフベクトルの内積を lLightLitParam.y にセット
+		lLightLitParam.y = dot( lLightHalfVec, lViewNrm ) ;
 
-	// スペキュラ反射率を lLightLitParam.w にセット
-	lLightLitParam.w = cfMaterial.Power.x ;
+		// スペキュラ反射率を lLightLitParam.w にセット
+		lLightLitParam.w = cfMaterial.Power.x ;
 
-	// ライト計算
-	lLightLitDest = lit( lLightLitParam.x, lLightLitParam.y, lLightLitParam.w ) ;
+		// ライト計算
+		lLightLitDest = lit( lLightLitParam.x, lLightLitParam.y, lLightLitParam.w ) ;
 
-	// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 =======( 終了 )
+		// ライトディフューズカラーとライトスペキュラカラーの角度減衰計算 ===( 終了 )
 
 
-	// カラー計算 ===========================================================( 開始 )
+		// カラー計算 =======================================================( 開始 )
 
-	// ディフーズライト蓄積値 += 距離・スポットライト角度減衰値 * ( ディフーズ角度減衰計算結果 * マテリアルディフューズカラー * ライトのディフーズカラー + ライトのアンビエントカラーとマテリアルのアンビエントカラーを乗算したもの )
-	lTotalDiffuse += lLightGen * ( lLightLitDest.y * cfLight[ 1 ].Diffuse * cfMaterial.Diffuse + cfLight[ 1 ].Ambient ) ;
+		// ディフーズライト蓄積値 += 距離・スポットライト角度減衰値 * ディフーズ角度減衰計算結果 * マテリアルディフューズカラー * ライトのディフーズカラー
+		lTotalDiffuse += lLightGen * lLightLitDest.y * float4( cfLightSlot[ i ].Diffuse_SpotP1.xyz, 0.0f ) * cfMaterial.Diffuse ;
 
-	// スペキュラライト蓄積値 += スペキュラ角度減衰計算結果 * 距離・スポットライト減衰 * ライトのスペキュラカラー
-	lTotalSpecular += lLightGen * lLightLitDest.z * cfLight[ 1 ].Specular ;
+		// スペキュラライト蓄積値 += スペキュラ角度減衰計算結果 * 距離・スポットライト減衰 * ライトのスペキュラカラー
+		lTotalSpecular += lLightGen * lLightLitDest.z * cfLightSlot[ i ].Specular ;
 
-	// カラー計算 ===========================================================( 終了 )
+		// カラー計算 =======================================================( 終了 )
+	}
 
-	// ポイントライトの処理 *************************************************************( 終了 )
+	// ポイントライトとスポットライトの処理 *******************************************( 終了 )
 
 
 	// ライトの処理 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
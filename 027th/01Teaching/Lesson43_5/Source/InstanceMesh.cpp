@@ -0,0 +1,275 @@
+﻿#include "InstanceMesh.h"
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson43_5
+* @author N.Yamada
+* @date 2023/01/15
+*
+* @details 同じ剛体メッシュのインスタンスを定数レジスタの行列で動かして、まとめて描画する
+*          DXライブラリには頂点ストリームをインスタンスごとに進める機能が無いため、メッシュを並べた頂点バッファにインスタンスの番号を持たせる
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @fn InstanceMesh_Initialize
+* @brief モデルのポリゴンを取り出して、メッシュを batchMax 個並べた頂点バッファを作る
+* @param[out] INSTANCEMESH *mesh
+* @param[in] int modelHandle 剛体メッシュのモデル( マテリアルとテクスチャは最初の１つだけを使う ), int capacity 置けるインスタンスの最大数
+* @return bool true:成功  false:失敗
+*/
+bool InstanceMesh_Initialize(INSTANCEMESH *mesh, int modelHandle, int capacity)
+{
+	memset(mesh, 0, sizeof(INSTANCEMESH));
+	mesh->vertexBufferHandle = -1;
+	mesh->indexBufferHandle = -1;
+	mesh->textureHandle = -1;
+
+	MV1SetupReferenceMesh(modelHandle, -1, false);
+	MV1_REF_POLYGONLIST refMesh = MV1GetReferenceMesh(modelHandle, -1, false);
+	mesh->meshVertexNum = refMesh.VertexNum;
+	mesh->meshIndexNum = refMesh.PolygonNum * 3;
+
+	// 16bit のインデックスで届く数までしか並べられない
+	mesh->batchMax = INSTANCEMESH_BATCHMAX;
+	if(mesh->meshVertexNum > 0 && mesh->batchMax > 65536 / mesh->meshVertexNum)
+	{
+		mesh->batchMax = 65536 / mesh->meshVertexNum;
+	}
+	if(mesh->meshVertexNum <= 0 || mesh->meshIndexNum <= 0 || mesh->batchMax <= 0)
+	{
+		MV1TerminateReferenceMesh(modelHandle, -1, false);
+		return false;
+	}
+
+	// メッシュを batchMax 個並べて、各頂点の su に何個目かを入れる
+	int vertexNum = mesh->meshVertexNum * mesh->batchMax;
+	int indexNum = mesh->meshIndexNum * mesh->batchMax;
+	VERTEX3DSHADER *vertex = (VERTEX3DSHADER *)malloc(sizeof(VERTEX3DSHADER) * vertexNum);
+	unsigned short *index = (unsigned short *)malloc(sizeof(unsigned short) * indexNum);
+	mesh->transform = (MATRIX *)malloc(sizeof(MATRIX) * (capacity > 0 ? capacity : 1));
+	mesh->instanceConst = (FLOAT4 *)malloc(sizeof(FLOAT4) * INSTANCEMESH_MATRIXREG * (capacity > 0 ? capacity : 1));
+	if(vertex == NULL || index == NULL || mesh->transform == NULL || mesh->instanceConst == NULL)
+	{
+		free(vertex);
+		free(index);
+		MV1TerminateReferenceMesh(modelHandle, -1, false);
+		InstanceMesh_Terminate(mesh);
+		return false;
+	}
+
+	float radiusPow2 = 0.0f;
+	for(int i=0; i<mesh->batchMax; i++)
+	{
+		for(int k=0; k<mesh->meshVertexNum; k++)
+		{
+			MV1_REF_VERTEX *refVertex = &refMesh.Vertexs[k];
+			VERTEX3DSHADER *dest = &vertex[i * mesh->meshVertexNum + k];
+			memset(dest, 0, sizeof(VERTEX3DSHADER));
+			dest->pos = refVertex->Position;
+			dest->norm = refVertex->Normal;
+			dest->dif = refVertex->DiffuseColor;
+			dest->spc = refVertex->SpecularColor;
+			dest->u = refVertex->TexCoord[0].u;
+			dest->v = refVertex->TexCoord[0].v;
+			dest->su = (float)i;
+			if(i == 0 && VSquareSize(refVertex->Position) > radiusPow2)
+			{
+				radiusPow2 = VSquareSize(refVertex->Position);
+			}
+		}
+		for(int k=0; k<refMesh.PolygonNum; k++)
+		{
+			for(int j=0; j<3; j++)
+			{
+				index[i * mesh->meshIndexNum + k * 3 + j] = (unsigned short)(i * mesh->meshVertexNum + refMesh.Polygons[k].VIndex[j]);
+			}
+		}
+	}
+	mesh->meshRadius = sqrtf(radiusPow2);
+	MV1TerminateReferenceMesh(modelHandle, -1, false);
+
+	mesh->vertexBufferHandle = CreateVertexBuffer(vertexNum, DX_VERTEX_TYPE_SHADER_3D);
+	mesh->indexBufferHandle = CreateIndexBuffer(indexNum, DX_INDEX_TYPE_16BIT);
+	if(mesh->vertexBufferHandle != -1 && mesh->indexBufferHandle != -1)
+	{
+		SetVertexBufferData(0, vertex, vertexNum, mesh->vertexBufferHandle);
+		SetIndexBufferData(0, index, indexNum, mesh->indexBufferHandle);
+	}
+	free(vertex);
+	free(index);
+	if(mesh->vertexBufferHandle == -1 || mesh->indexBufferHandle == -1)
+	{
+		InstanceMesh_Terminate(mesh);
+		return false;
+	}
+
+	// 最初のマテリアルとテクスチャを使う
+	int textureIndex = MV1GetMaterialDifMapTexture(modelHandle, 0);
+	mesh->textureHandle = textureIndex >= 0 ? MV1GetTextureGraphHandle(modelHandle, textureIndex) : -1;
+	mesh->material.Diffuse = MV1GetMaterialDifColor(modelHandle, 0);
+	mesh->material.Ambient = MV1GetMaterialAmbColor(modelHandle, 0);
+	mesh->material.Specular = MV1GetMaterialSpcColor(modelHandle, 0);
+	mesh->material.Emissive = MV1GetMaterialEmiColor(modelHandle, 0);
+	mesh->material.Power = MV1GetMaterialSpcPower(modelHandle, 0);
+
+	mesh->capacity = capacity;
+	mesh->instanceNum = 0;
+	mesh->dirty = true;
+	return true;
+}
+
+/**
+* @fn InstanceMesh_Terminate
+* @brief 頂点バッファと入れ物の後始末
+* @param[in] INSTANCEMESH *mesh
+* @details テクスチャはモデルのものなので削除しない
+*/
+void InstanceMesh_Terminate(INSTANCEMESH *mesh)
+{
+	if(mesh->vertexBufferHandle != -1)
+	{
+		DeleteVertexBuffer(mesh->vertexBufferHandle);
+		mesh->vertexBufferHandle = -1;
+	}
+	if(mesh->indexBufferHandle != -1)
+	{
+		DeleteIndexBuffer(mesh->indexBufferHandle);
+		mesh->indexBufferHandle = -1;
+	}
+	free(mesh->transform);
+	free(mesh->instanceConst);
+	mesh->transform = NULL;
+	mesh->instanceConst = NULL;
+	mesh->capacity = 0;
+	mesh->instanceNum = 0;
+}
+
+/**
+* @fn InstanceMesh_Add
+* @brief インスタンスを置く
+* @param[in] INSTANCEMESH *mesh, MATRIX transform ワールド行列
+* @return int 番号( 一杯の場合は -1 )
+*/
+int InstanceMesh_Add(INSTANCEMESH *mesh, MATRIX transform)
+{
+	if(mesh->instanceNum >= mesh->capacity)
+	{
+		return -1;
+	}
+	mesh->transform[mesh->instanceNum] = transform;
+	mesh->dirty = true;
+	return mesh->instanceNum++;
+}
+
+/**
+* @fn InstanceMesh_SetTransform
+* @brief インスタンスのワールド行列を変える
+* @param[in] INSTANCEMESH *mesh, int index, MATRIX transform
+* @details 次の描画の前に行列の並びを作り直す
+*/
+void InstanceMesh_SetTransform(INSTANCEMESH *mesh, int index, MATRIX transform)
+{
+	mesh->transform[index] = transform;
+	mesh->dirty = true;
+}
+
+/**
+* @fn InstanceMesh_GetBounds
+* @brief 指定の範囲のインスタンスを囲む球を求める
+* @param[in] const INSTANCEMESH *mesh, int first 最初の番号, int num 数
+* @param[out] VECTOR *center, float *radius
+* @details 行列の拡大は考えず、インスタンスの位置を囲む箱にメッシュの半径を足す
+*/
+void InstanceMesh_GetBounds(const INSTANCEMESH *mesh, int first, int num, VECTOR *center, float *radius)
+{
+	if(num <= 0)
+	{
+		*center = VGet(0.0f, 0.0f, 0.0f);
+		*radius = 0.0f;
+		return;
+	}
+
+	VECTOR minPosition = VGet(mesh->transform[first].m[3][0], mesh->transform[first].m[3][1], mesh->transform[first].m[3][2]);
+	VECTOR maxPosition = minPosition;
+	for(int i=first+1; i<first+num; i++)
+	{
+		VECTOR position = VGet(mesh->transform[i].m[3][0], mesh->transform[i].m[3][1], mesh->transform[i].m[3][2]);
+		minPosition = VGet(position.x < minPosition.x ? position.x : minPosition.x, position.y < minPosition.y ? position.y : minPosition.y, position.z < minPosition.z ? position.z : minPosition.z);
+		maxPosition = VGet(position.x > maxPosition.x ? position.x : maxPosition.x, position.y > maxPosition.y ? position.y : maxPosition.y, position.z > maxPosition.z ? position.z : maxPosition.z);
+	}
+	*center = VScale(VAdd(minPosition, maxPosition), 0.5f);
+	*radius = VSize(VSub(maxPosition, *center)) + mesh->meshRadius;
+}
+
+/**
+* @fn InstanceMesh_Draw
+* @brief 指定の範囲のインスタンスを batchMax 個ずつまとめて描画する
+* @param[in] INSTANCEMESH *mesh, int first 最初の番号, int num 数
+* @return int 描画回数
+* @details インスタンス用の頂点シェーダーとピクセルシェーダーは呼び出し側でセットしておく
+*          位置を変えたインスタンスがある場合だけ、定数レジスタに設定する行列の並びを作り直す
+*/
+int InstanceMesh_Draw(INSTANCEMESH *mesh, int first, int num)
+{
+	if(first < 0)
+	{
+		num += first;
+		first = 0;
+	}
+	if(first + num > mesh->instanceNum)
+	{
+		num = mesh->instanceNum - first;
+	}
+	if(num <= 0)
+	{
+		return 0;
+	}
+
+	// ワールド行列を頂点シェーダーの cfLocalWorldMatrix と同じ並び( 転置した上３行 )にする
+	if(mesh->dirty)
+	{
+		for(int i=0; i<mesh->instanceNum; i++)
+		{
+			const MATRIX *m = &mesh->transform[i];
+			FLOAT4 *dest = &mesh->instanceConst[i * INSTANCEMESH_MATRIXREG];
+			for(int j=0; j<INSTANCEMESH_MATRIXREG; j++)
+			{
+				dest[j] = F4Get(m->m[0][j], m->m[1][j], m->m[2][j], m->m[3][j]);
+			}
+		}
+		mesh->dirty = false;
+		mesh->rebuildNum++;
+	}
+
+	SetMaterialParam(mesh->material);
+	SetUseTextureToShader(0, mesh->textureHandle);
+
+	int drawNum = 0;
+	for(int i=first; i<first+num; i+=mesh->batchMax)
+	{
+		int batchNum = first + num - i < mesh->batchMax ? first + num - i : mesh->batchMax;
+		SetVSConstFArray(INSTANCEMESH_REGISTER, &mesh->instanceConst[i * INSTANCEMESH_MATRIXREG], batchNum * INSTANCEMESH_MATRIXREG);
+		DrawPrimitiveIndexed3DToShader_UseVertexBuffer2(mesh->vertexBufferHandle, mesh->indexBufferHandle, DX_PRIMTYPE_TRIANGLELIST,
+			0, 0, batchNum * mesh->meshVertexNum, 0, batchNum * mesh->meshIndexNum);
+		drawNum++;
+	}
+	SetUseTextureToShader(0, -1);
+
+	mesh->drawCallNum += drawNum;
+	mesh->drawInstanceNum += num;
+	return drawNum;
+}
+
+/**
+* @fn InstanceMesh_ResetStats
+* @brief 描画回数と描いたインスタンスの数を 0 にする
+* @param[in] INSTANCEMESH *mesh
+*/
+void InstanceMesh_ResetStats(INSTANCEMESH *mesh)
+{
+	mesh->drawCallNum = 0;
+	mesh->drawInstanceNum = 0;
+}
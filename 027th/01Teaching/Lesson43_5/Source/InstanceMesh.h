@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int INSTANCEMESH_REGISTER = 100;		//!< インスタンスの行列を渡す頂点シェーダーの定数レジスタの先頭( c100、頂点シェーダーの cfInstanceMatrix と合わせる )
+const int INSTANCEMESH_MATRIXREG = 3;		//!< インスタンス１つ分の行列の定数レジスタの数( ４行３列 )
+const int INSTANCEMESH_BATCHMAX = (256 - INSTANCEMESH_REGISTER) / INSTANCEMESH_MATRIXREG;	//!< １回の描画で描けるインスタンスの最大数( 頂点シェーダーの INSTANCE_NUM と合わせる )
+
+/**
+* @struct INSTANCEMESH
+* @brief 同じ剛体メッシュを沢山置いて、まとめて１回の描画で描くための入れ物
+* @details メッシュを INSTANCEMESH_BATCHMAX 個並べた頂点バッファを作り、各頂点の su にインスタンスの番号を入れておく
+*          頂点シェーダーは番号を使って定数レジスタからインスタンスのワールド行列を取り出す
+*          行列の並びは位置を変えた時だけ作り直し、描画の時は定数レジスタに１回で設定する
+*          DXライブラリには２つ目の頂点ストリームをインスタンスごとに進める機能( Direct3D9 の SetStreamSourceFreq )が無いため、
+*          インスタンスごとの行列は頂点ストリームではなく定数レジスタで渡す( １回の描画は batchMax 個まで )
+*/
+struct INSTANCEMESH
+{
+	int vertexBufferHandle;					//!< メッシュを batchMax 個並べた頂点バッファ
+	int indexBufferHandle;					//!< メッシュを batchMax 個並べたインデックスバッファ
+	int meshVertexNum;						//!< メッシュ１つの頂点の数
+	int meshIndexNum;						//!< メッシュ１つのインデックスの数
+	int batchMax;							//!< １回の描画で描けるインスタンスの最大数
+	float meshRadius;						//!< メッシュを囲む球の半径( ローカル座標の原点が中心 )
+	int textureHandle;						//!< ディフューズテクスチャ( -1:無し )
+	MATERIALPARAM material;					//!< マテリアル
+	int capacity;							//!< 置けるインスタンスの最大数
+	int instanceNum;						//!< 置いたインスタンスの数
+	MATRIX *transform;						//!< インスタンスのワールド行列
+	FLOAT4 *instanceConst;					//!< 定数レジスタに設定する行列の並び( インスタンス１つにつき INSTANCEMESH_MATRIXREG 個 )
+	bool dirty;								//!< 行列の並びを作り直す必要があるか
+	int rebuildNum;							//!< これまでに行列の並びを作り直した回数
+	int drawCallNum;						//!< InstanceMesh_ResetStats からの描画回数
+	int drawInstanceNum;					//!< InstanceMesh_ResetStats から描いたインスタンスの数
+};
+
+bool InstanceMesh_Initialize(INSTANCEMESH *mesh, int modelHandle, int capacity);	//!< モデルのポリゴンを取り出して頂点バッファを作る( 戻り値  true:成功  false:失敗 )
+void InstanceMesh_Terminate(INSTANCEMESH *mesh);			//!< 頂点バッファと入れ物の後始末
+int InstanceMesh_Add(INSTANCEMESH *mesh, MATRIX transform);	//!< インスタンスを置く( 戻り値 : 番号、一杯の場合は -1 )
+void InstanceMesh_SetTransform(INSTANCEMESH *mesh, int index, MATRIX transform);	//!< インスタンスのワールド行列を変える
+void InstanceMesh_GetBounds(const INSTANCEMESH *mesh, int first, int num, VECTOR *center, float *radius);	//!< 指定の範囲のインスタンスを囲む球を求める
+int InstanceMesh_Draw(INSTANCEMESH *mesh, int first, int num);	//!< 指定の範囲のインスタンスを batchMax 個ずつまとめて描画する( 戻り値 : 描画回数 )
+void InstanceMesh_ResetStats(INSTANCEMESH *mesh);			//!< 描画回数と描いたインスタンスの数を 0 にする
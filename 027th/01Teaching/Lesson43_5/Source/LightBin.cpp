@@ -0,0 +1,341 @@
+﻿#include "LightBin.h"
+#include <malloc.h>
+#include <math.h>
+#include <emmintrin.h>
+/**
+* @file
+* @brief Lesson43_5
+* @author N.Yamada
+* @date 2023/01/15
+*
+* @details 沢山のポイントライトとスポットライトから、描画するモデルごとに影響の大きいライトを選んで頂点シェーダーに渡す
+*          モデルを囲む球に届かないライトを外し、残りを球の表面での明るさの順に並べて上から LIGHTBIN_SLOTNUM 個を使う
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+/**
+* @fn LightBin_Initialize
+* @brief 入れ物を確保する
+* @param[out] LIGHTBIN *bin
+* @param[in] int capacity 登録できるライトの最大数
+* @return bool true:成功  false:失敗
+*/
+bool LightBin_Initialize(LIGHTBIN *bin, int capacity)
+{
+	// ４つずつ判定するので、端数の分は届かないライトで埋めておく
+	capacity = (capacity + 3) & ~3;
+	bin->capacity = capacity;
+	bin->lightNum = 0;
+	bin->handle = (int *)malloc(sizeof(int) * capacity);
+	bin->positionX = (float *)malloc(sizeof(float) * capacity);
+	bin->positionY = (float *)malloc(sizeof(float) * capacity);
+	bin->positionZ = (float *)malloc(sizeof(float) * capacity);
+	bin->directionX = (float *)malloc(sizeof(float) * capacity);
+	bin->directionY = (float *)malloc(sizeof(float) * capacity);
+	bin->directionZ = (float *)malloc(sizeof(float) * capacity);
+	bin->range = (float *)malloc(sizeof(float) * capacity);
+	bin->atten0 = (float *)malloc(sizeof(float) * capacity);
+	bin->atten1 = (float *)malloc(sizeof(float) * capacity);
+	bin->atten2 = (float *)malloc(sizeof(float) * capacity);
+	bin->spotCos = (float *)malloc(sizeof(float) * capacity);
+	bin->spotSin = (float *)malloc(sizeof(float) * capacity);
+	bin->spotFlag = (float *)malloc(sizeof(float) * capacity);
+	bin->intensity = (float *)malloc(sizeof(float) * capacity);
+	bin->slotParam = (FLOAT4 *)malloc(sizeof(FLOAT4) * LIGHTBIN_SLOTREG * capacity);
+	if(bin->handle == NULL || bin->positionX == NULL || bin->positionY == NULL || bin->positionZ == NULL
+		|| bin->directionX == NULL || bin->directionY == NULL || bin->directionZ == NULL || bin->range == NULL
+		|| bin->atten0 == NULL || bin->atten1 == NULL || bin->atten2 == NULL
+		|| bin->spotCos == NULL || bin->spotSin == NULL || bin->spotFlag == NULL || bin->intensity == NULL || bin->slotParam == NULL)
+	{
+		LightBin_Terminate(bin);
+		return false;
+	}
+	LightBin_Clear(bin);
+	return true;
+}
+
+/**
+* @fn LightBin_Terminate
+* @brief 入れ物の後始末
+* @param[in] LIGHTBIN *bin
+* @details 登録したライトハンドルは削除しないので、呼び出し側で DeleteLightHandle する
+*/
+void LightBin_Terminate(LIGHTBIN *bin)
+{
+	free(bin->handle);
+	free(bin->positionX);
+	free(bin->positionY);
+	free(bin->positionZ);
+	free(bin->directionX);
+	free(bin->directionY);
+	free(bin->directionZ);
+	free(bin->range);
+	free(bin->atten0);
+	free(bin->atten1);
+	free(bin->atten2);
+	free(bin->spotCos);
+	free(bin->spotSin);
+	free(bin->spotFlag);
+	free(bin->intensity);
+	free(bin->slotParam);
+	bin->handle = NULL;
+	bin->positionX = NULL;
+	bin->positionY = NULL;
+	bin->positionZ = NULL;
+	bin->directionX = NULL;
+	bin->directionY = NULL;
+	bin->directionZ = NULL;
+	bin->range = NULL;
+	bin->atten0 = NULL;
+	bin->atten1 = NULL;
+	bin->atten2 = NULL;
+	bin->spotCos = NULL;
+	bin->spotSin = NULL;
+	bin->spotFlag = NULL;
+	bin->intensity = NULL;
+	bin->slotParam = NULL;
+	bin->capacity = 0;
+	bin->lightNum = 0;
+}
+
+/**
+* @fn LightBin_Add
+* @brief ポイントライトかスポットライトを登録する
+* @param[in] LIGHTBIN *bin, int lightHandle
+* @return int 番号( 一杯か種類が違う場合は -1 )
+* @details 登録したライトはDXライブラリの標準のライトとしては無効にして、シェーダーには LightBin_SetShaderConst で渡す
+*/
+int LightBin_Add(LIGHTBIN *bin, int lightHandle)
+{
+	int type = GetLightTypeHandle(lightHandle);
+	if(bin->lightNum >= bin->capacity || (type != DX_LIGHTTYPE_POINT && type != DX_LIGHTTYPE_SPOT))
+	{
+		return -1;
+	}
+	SetLightEnableHandle(lightHandle, false);
+	bin->handle[bin->lightNum] = lightHandle;
+	return bin->lightNum++;
+}
+
+/**
+* @fn LightBin_Clear
+* @brief 登録したライトを全て外す
+* @param[in] LIGHTBIN *bin
+*/
+void LightBin_Clear(LIGHTBIN *bin)
+{
+	bin->lightNum = 0;
+	for(int i=0; i<bin->capacity; i++)
+	{
+		bin->positionX[i] = 0.0f;
+		bin->positionY[i] = 0.0f;
+		bin->positionZ[i] = 0.0f;
+		bin->directionX[i] = 0.0f;
+		bin->directionY[i] = 0.0f;
+		bin->directionZ[i] = 0.0f;
+		bin->range[i] = -1.0f;
+		bin->atten0[i] = 1.0f;
+		bin->atten1[i] = 0.0f;
+		bin->atten2[i] = 0.0f;
+		bin->spotCos[i] = 0.0f;
+		bin->spotSin[i] = 0.0f;
+		bin->spotFlag[i] = 0.0f;
+		bin->intensity[i] = 0.0f;
+	}
+}
+
+/**
+* @fn LightBin_Update
+* @brief 登録したライトの今の設定とカメラの位置を読み込む
+* @param[in] LIGHTBIN *bin
+* @details 選ぶ時に使うワールド空間の情報と、シェーダーに渡すビュー空間の情報を作る
+*          毎フレーム、ライトとカメラを動かした後、描画の前に１回呼ぶ
+*/
+void LightBin_Update(LIGHTBIN *bin)
+{
+	MATRIX viewMatrix = GetCameraViewMatrix();
+	for(int i=0; i<bin->lightNum; i++)
+	{
+		int lightHandle = bin->handle[i];
+		bool spot = GetLightTypeHandle(lightHandle) == DX_LIGHTTYPE_SPOT;
+		VECTOR position = GetLightPositionHandle(lightHandle);
+		VECTOR direction = GetLightDirectionHandle(lightHandle);
+		COLOR_F diffuse = GetLightDifColorHandle(lightHandle);
+		COLOR_F specular = GetLightSpcColorHandle(lightHandle);
+		float range, atten0, atten1, atten2;
+		GetLightRangeAttenHandle(lightHandle, &range, &atten0, &atten1, &atten2);
+
+		// スポットライトのコーンの角度( ポイントライトは全ての向きを照らすようにする )
+		float spotParam0 = -2.0f;
+		float spotParam1 = 1.0f;
+		float outCos = -1.0f;
+		float outSin = 0.0f;
+		if(spot)
+		{
+			float outAngle, inAngle;
+			GetLightAngleHandle(lightHandle, &outAngle, &inAngle);
+			outCos = cosf(outAngle / 2.0f);
+			outSin = sinf(outAngle / 2.0f);
+			float inCos = cosf(inAngle / 2.0f);
+			spotParam0 = outCos;
+			spotParam1 = inCos - outCos > 0.0001f ? 1.0f / (inCos - outCos) : 10000.0f;
+		}
+
+		bin->positionX[i] = position.x;
+		bin->positionY[i] = position.y;
+		bin->positionZ[i] = position.z;
+		bin->directionX[i] = direction.x;
+		bin->directionY[i] = direction.y;
+		bin->directionZ[i] = direction.z;
+		bin->range[i] = range;
+		bin->atten0[i] = atten0;
+		bin->atten1[i] = atten1;
+		bin->atten2[i] = atten2;
+		bin->spotCos[i] = outCos;
+		bin->spotSin[i] = outSin;
+		bin->spotFlag[i] = spot ? 1.0f : 0.0f;
+		bin->intensity[i] = diffuse.r * 0.299f + diffuse.g * 0.587f + diffuse.b * 0.114f;
+
+		// シェーダーに渡す情報( 座標と向きはビュー空間 )
+		VECTOR viewPosition = VTransform(position, viewMatrix);
+		VECTOR viewDirection = VTransformSR(direction, viewMatrix);
+		FLOAT4 *param = &bin->slotParam[i * LIGHTBIN_SLOTREG];
+		param[0] = F4Get(viewPosition.x, viewPosition.y, viewPosition.z, range * range);
+		param[1] = F4Get(viewDirection.x, viewDirection.y, viewDirection.z, spotParam0);
+		param[2] = F4Get(diffuse.r, diffuse.g, diffuse.b, spotParam1);
+		param[3] = F4Get(specular.r, specular.g, specular.b, specular.a);
+		param[4] = F4Get(atten0, atten1, atten2, 0.0f);
+	}
+}
+
+/**
+* @fn LightBin_Select
+* @brief 球の範囲に届くライトを影響の大きい順に選ぶ
+* @param[in] const LIGHTBIN *bin, VECTOR center, float radius モデルを囲む球
+* @param[out] int *lightIndex 選んだライトの番号( 影響の大きい順 )
+* @param[in] int lightMax 選ぶ最大数
+* @return int 選んだ数
+* @details ライト４つずつまとめて、有効距離と( スポットライトは )コーンが球に届くかを判定し、
+*          届いたライトは球の表面で一番近い点での 明るさ÷減衰 を影響の大きさにする
+*/
+int LightBin_Select(const LIGHTBIN *bin, VECTOR center, float radius, int *lightIndex, int lightMax)
+{
+	float bestScore[LIGHTBIN_SLOTNUM];
+	int selectNum = 0;
+	if(lightMax > LIGHTBIN_SLOTNUM)
+	{
+		lightMax = LIGHTBIN_SLOTNUM;
+	}
+	if(lightMax <= 0)
+	{
+		return 0;
+	}
+
+	__m128 centerX = _mm_set1_ps(center.x);
+	__m128 centerY = _mm_set1_ps(center.y);
+	__m128 centerZ = _mm_set1_ps(center.z);
+	__m128 r = _mm_set1_ps(radius);
+	__m128 zero = _mm_setzero_ps();
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 minDenominator = _mm_set1_ps(0.000001f);
+	int lightNum = (bin->lightNum + 3) & ~3;
+	for(int i=0; i<lightNum; i+=4)
+	{
+		// ライトから球の中心へのベクトル
+		__m128 vx = _mm_sub_ps(centerX, _mm_loadu_ps(&bin->positionX[i]));
+		__m128 vy = _mm_sub_ps(centerY, _mm_loadu_ps(&bin->positionY[i]));
+		__m128 vz = _mm_sub_ps(centerZ, _mm_loadu_ps(&bin->positionZ[i]));
+		__m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+		__m128 distance = _mm_sqrt_ps(distanceSq);
+
+		// 有効距離＋半径より遠ければ届かない
+		__m128 range = _mm_loadu_ps(&bin->range[i]);
+		__m128 reach = _mm_add_ps(range, r);
+		__m128 hit = _mm_and_ps(_mm_cmpge_ps(range, zero), _mm_cmple_ps(distanceSq, _mm_mul_ps(reach, reach)));
+
+		// スポットライトは、球がコーンの外側か、ライトの後ろか、コーンの向きで有効距離より先にあれば届かない
+		__m128 along = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(vx, _mm_loadu_ps(&bin->directionX[i])),
+			_mm_mul_ps(vy, _mm_loadu_ps(&bin->directionY[i]))),
+			_mm_mul_ps(vz, _mm_loadu_ps(&bin->directionZ[i])));
+		__m128 aside = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(distanceSq, _mm_mul_ps(along, along)), zero));
+		__m128 coneDistance = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&bin->spotCos[i]), aside), _mm_mul_ps(along, _mm_loadu_ps(&bin->spotSin[i])));
+		__m128 spotOut = _mm_or_ps(_mm_or_ps(
+			_mm_cmpgt_ps(coneDistance, r),
+			_mm_cmplt_ps(along, _mm_sub_ps(zero, r))),
+			_mm_cmpgt_ps(along, reach));
+		__m128 spot = _mm_cmpgt_ps(_mm_loadu_ps(&bin->spotFlag[i]), half);
+		hit = _mm_andnot_ps(_mm_and_ps(spot, spotOut), hit);
+
+		int hitMask = _mm_movemask_ps(hit);
+		if(hitMask == 0)
+		{
+			continue;
+		}
+
+		// 球の表面で一番近い点での減衰を求めて、明るさに掛ける
+		__m128 d = _mm_max_ps(_mm_sub_ps(distance, r), zero);
+		__m128 denominator = _mm_add_ps(_mm_add_ps(
+			_mm_loadu_ps(&bin->atten0[i]),
+			_mm_mul_ps(_mm_loadu_ps(&bin->atten1[i]), d)),
+			_mm_mul_ps(_mm_loadu_ps(&bin->atten2[i]), _mm_mul_ps(d, d)));
+		__m128 score = _mm_div_ps(_mm_loadu_ps(&bin->intensity[i]), _mm_max_ps(denominator, minDenominator));
+		float scoreArray[4];
+		_mm_storeu_ps(scoreArray, score);
+
+		// 届いたライトだけ、影響の大きい順の一覧に差し込む
+		for(int j=0; j<4; j++)
+		{
+			if((hitMask & (1 << j)) == 0)
+			{
+				continue;
+			}
+			float s = scoreArray[j];
+			if(selectNum == lightMax && s <= bestScore[lightMax - 1])
+			{
+				continue;
+			}
+			int k = selectNum < lightMax ? selectNum++ : lightMax - 1;
+			while(k > 0 && bestScore[k - 1] < s)
+			{
+				bestScore[k] = bestScore[k - 1];
+				lightIndex[k] = lightIndex[k - 1];
+				k--;
+			}
+			bestScore[k] = s;
+			lightIndex[k] = i + j;
+		}
+	}
+	return selectNum;
+}
+
+/**
+* @fn LightBin_SetShaderConst
+* @brief 選んだライトを頂点シェーダーの定数レジスタに設定する
+* @param[in] const LIGHTBIN *bin, const int *lightIndex 選んだライトの番号, int lightNum 選んだ数
+* @details 余ったスロットは色を黒、有効距離を 0 にして何も照らさないようにする
+*          MV1DrawModel の直前に呼ぶ
+*/
+void LightBin_SetShaderConst(const LIGHTBIN *bin, const int *lightIndex, int lightNum)
+{
+	FLOAT4 param[LIGHTBIN_SLOTNUM * LIGHTBIN_SLOTREG];
+	for(int i=0; i<LIGHTBIN_SLOTNUM; i++)
+	{
+		FLOAT4 *slot = &param[i * LIGHTBIN_SLOTREG];
+		if(i < lightNum)
+		{
+			const FLOAT4 *src = &bin->slotParam[lightIndex[i] * LIGHTBIN_SLOTREG];
+			for(int j=0; j<LIGHTBIN_SLOTREG; j++)
+			{
+				slot[j] = src[j];
+			}
+			continue;
+		}
+		slot[0] = F4Get(0.0f, 0.0f, 0.0f, 0.0f);
+		slot[1] = F4Get(0.0f, 0.0f, 1.0f, -2.0f);
+		slot[2] = F4Get(0.0f, 0.0f, 0.0f, 1.0f);
+		slot[3] = F4Get(0.0f, 0.0f, 0.0f, 0.0f);
+		slot[4] = F4Get(1.0f, 0.0f, 0.0f, 0.0f);
+	}
+	SetVSConstFArray(LIGHTBIN_REGISTER, param, LIGHTBIN_SLOTNUM * LIGHTBIN_SLOTREG);
+}
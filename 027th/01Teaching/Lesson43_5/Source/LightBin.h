@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int LIGHTBIN_SLOTNUM = 4;				//!< １回の描画でシェーダーに渡すライトの最大数( 頂点シェーダーの LIGHTSLOT_NUM と合わせる )
+const int LIGHTBIN_SLOTREG = 5;				//!< ライト１つ分の頂点シェーダーの定数レジスタの数
+const int LIGHTBIN_REGISTER = 56;			//!< ライトを渡す頂点シェーダーの定数レジスタの先頭( c56、DXライブラリが使っていない所 )
+
+/**
+* @struct LIGHTBIN
+* @brief 沢山のポイントライトとスポットライトから、描画するモデルごとに影響の大きいライトを選ぶ入れ物
+* @details ライトの情報は項目ごとの配列で持ち、４つずつまとめて SSE で判定する
+*          配列は LightBin_Initialize で確保したものだけを使い、ライトを選ぶ時にはメモリを確保しない
+*/
+struct LIGHTBIN
+{
+	int capacity;							//!< 登録できるライトの最大数( ４の倍数に切り上げる )
+	int lightNum;							//!< 登録したライトの数
+	int *handle;							//!< ライトハンドル
+	float *positionX;						//!< ワールド座標のＸ
+	float *positionY;						//!< ワールド座標のＹ
+	float *positionZ;						//!< ワールド座標のＺ
+	float *directionX;						//!< スポットライトの向きのＸ( ワールド空間 )
+	float *directionY;						//!< スポットライトの向きのＹ
+	float *directionZ;						//!< スポットライトの向きのＺ
+	float *range;							//!< 有効距離( 空いている要素は -1 )
+	float *atten0;							//!< 距離による減衰処理用パラメータ０
+	float *atten1;							//!< 距離による減衰処理用パラメータ１
+	float *atten2;							//!< 距離による減衰処理用パラメータ２
+	float *spotCos;							//!< スポットライトのコーンの外側の角度の半分の cos
+	float *spotSin;							//!< スポットライトのコーンの外側の角度の半分の sin
+	float *spotFlag;						//!< スポットライトなら 1、ポイントライトなら 0
+	float *intensity;						//!< ディフューズカラーの明るさ
+	FLOAT4 *slotParam;						//!< シェーダーに渡すライトの情報( ライト１つにつき LIGHTBIN_SLOTREG 個、ビュー空間 )
+};
+
+bool LightBin_Initialize(LIGHTBIN *bin, int capacity);		//!< 入れ物を確保する( 戻り値  true:成功  false:失敗 )
+void LightBin_Terminate(LIGHTBIN *bin);						//!< 入れ物の後始末
+int LightBin_Add(LIGHTBIN *bin, int lightHandle);			//!< ポイントライトかスポットライトを登録する( 戻り値 : 番号、一杯か種類が違う場合は -1 )
+void LightBin_Clear(LIGHTBIN *bin);							//!< 登録したライトを全て外す
+void LightBin_Update(LIGHTBIN *bin);						//!< 登録したライトの今の設定とカメラの位置を読み込む( 毎フレーム描画の前に１回呼ぶ )
+int LightBin_Select(const LIGHTBIN *bin, VECTOR center, float radius, int *lightIndex, int lightMax);	//!< 球の範囲に届くライトを影響の大きい順に選ぶ( 戻り値 : 選んだ数 )
+void LightBin_SetShaderConst(const LIGHTBIN *bin, const int *lightIndex, int lightNum);	//!< 選んだライトを頂点シェーダーの定数レジスタに設定する( 余ったスロットは消す )
@@ -1,5 +1,9 @@
 ﻿#include "DxLib.h"
+#include "LightBin.h"
+#include "InstanceMesh.h"
+#include "TextureCook.h"
 #include <math.h>
+#include <string.h>
 /**
 * @file
 * @brief Lesson42_2
@@ -7,11 +11,108 @@
 * @date 2023/01/15
 *
 * @details オリジナルシェーダーを使用した3Dモデルの描画基本5 （剛体メッシュのディレクショナルライトとポイントライトあり描画）
+*          沢山のポイントライトとスポットライトから、モデルごとに影響の大きいライトを LightBin で選んでシェーダーに渡す
+*          並べたモデルは近くの CLUSTER_SIZE x CLUSTER_SIZE 個ずつ InstanceMesh でまとめて描画し、スペースキーを押している間は１つずつ描画する
+*          -lightbench を指定して起動すると、ウインドウを表示せずにライトを選ぶ速さを測ってログに書き出す
+*          -cooktexture を指定して起動すると、ウインドウを表示せずにテクスチャをミップマップ付きの圧縮テクスチャ( DDS ファイル )にする
 * @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
 */
 
-const int   DRAW_NUM = 3;
+const int   DRAW_NUM = 8;
 const float SPACE = 512.0f;
+const float MODEL_RADIUS = 222.0f;				//!< モデルを囲む球の半径( 一辺 256 の箱の対角線の半分 )
+const int   CLUSTER_SIZE = 2;					//!< まとめて描画する塊の一辺のモデルの数( ライトは塊ごとに選ぶので、大きくすると遠いライトに枠を取られる )
+const int   CLUSTER_NUM = CLUSTER_SIZE * CLUSTER_SIZE;	//!< まとめて描画する塊１つのモデルの数
+const int   LIGHT_NUM = 48;						//!< 配置するポイントライトとスポットライトの数
+const float LIGHT_HEIGHT = 400.0f;				//!< ライトの高さ
+const float LIGHT_MOVERADIUS = 300.0f;			//!< ライトが回る円の半径
+const int   LIGHTBENCH_LIGHTNUM = 1000;			//!< -lightbench で使うライトの数
+const int   LIGHTBENCH_OBJECTNUM = 1000;		//!< -lightbench で使うモデルの数
+const float LIGHTBENCH_AREA = 20000.0f;			//!< -lightbench でライトとモデルを置く範囲
+const int   LIGHTBENCH_TIME = 1000000;			//!< -lightbench で測る時間( マイクロ秒 )
+
+/**
+* @fn CreateLamp
+* @brief 番号が偶数ならポイントライト、奇数なら下向きのスポットライトを作る
+* @param[in] int index, VECTOR position
+* @return int ライトハンドル
+* @details 色はランダムにする
+*/
+int CreateLamp(int index, VECTOR position)
+{
+	int lightHandle;
+	if(index % 2 == 0)
+	{
+		lightHandle = CreatePointLightHandle(position, 1000.0f, 1.0f, 0.0f, 0.00001f);
+	}
+	else
+	{
+		lightHandle = CreateSpotLightHandle(position, VGet(0.0f, -1.0f, 0.0f), DX_PI_F / 2.0f, DX_PI_F / 3.0f, 1000.0f, 1.0f, 0.0f, 0.00001f);
+	}
+	SetLightAmbColorHandle(lightHandle, GetColorF(0.0f, 0.0f, 0.0f, 0.0f));
+	SetLightDifColorHandle(lightHandle, GetColorF(GetRand(100) / 50.0f, GetRand(100) / 50.0f, GetRand(100) / 50.0f, 0.0f));
+	return lightHandle;
+}
+
+/**
+* @fn RunLightBenchmark
+* @brief ライトとモデルをランダムに置いて、全てのモデルのライトを選ぶ速さを測ってログに書き出す
+* @return bool true:成功  false:失敗
+*/
+bool RunLightBenchmark()
+{
+	static int lightHandle[LIGHTBENCH_LIGHTNUM];
+	static VECTOR objectPosition[LIGHTBENCH_OBJECTNUM];
+	LIGHTBIN bin;
+	if(!LightBin_Initialize(&bin, LIGHTBENCH_LIGHTNUM))
+	{
+		return false;
+	}
+
+	SRand(0);
+	for(int i=0; i<LIGHTBENCH_LIGHTNUM; i++)
+	{
+		VECTOR position = VGet(GetRand((int)LIGHTBENCH_AREA) - LIGHTBENCH_AREA / 2.0f, LIGHT_HEIGHT, GetRand((int)LIGHTBENCH_AREA) - LIGHTBENCH_AREA / 2.0f);
+		lightHandle[i] = CreateLamp(i, position);
+		LightBin_Add(&bin, lightHandle[i]);
+	}
+	for(int i=0; i<LIGHTBENCH_OBJECTNUM; i++)
+	{
+		objectPosition[i] = VGet(GetRand((int)LIGHTBENCH_AREA) - LIGHTBENCH_AREA / 2.0f, 0.0f, GetRand((int)LIGHTBENCH_AREA) - LIGHTBENCH_AREA / 2.0f);
+	}
+
+	LONGLONG updateStart = GetNowHiPerformanceCount();
+	LightBin_Update(&bin);
+	LONGLONG updateTime = GetNowHiPerformanceCount() - updateStart;
+
+	// 全てのモデルのライトを選ぶのを１フレームとして、決められた時間だけ繰り返す
+	int frameNum = 0;
+	LONGLONG selectTotal = 0;
+	LONGLONG benchStart = GetNowHiPerformanceCount();
+	LONGLONG benchTime = 0;
+	while(benchTime < LIGHTBENCH_TIME)
+	{
+		int lightIndex[LIGHTBIN_SLOTNUM];
+		for(int i=0; i<LIGHTBENCH_OBJECTNUM; i++)
+		{
+			selectTotal += LightBin_Select(&bin, objectPosition[i], MODEL_RADIUS, lightIndex, LIGHTBIN_SLOTNUM);
+		}
+		frameNum++;
+		benchTime = GetNowHiPerformanceCount() - benchStart;
+	}
+
+	ErrorLogFmtAdd("lightbench: %d lights x %d objects  update %lldus  select %lldus/frame  %dns/object  %d.%02d lights/object",
+		LIGHTBENCH_LIGHTNUM, LIGHTBENCH_OBJECTNUM, updateTime, benchTime / frameNum,
+		(int)(benchTime * 1000 / ((LONGLONG)frameNum * LIGHTBENCH_OBJECTNUM)),
+		(int)(selectTotal / ((LONGLONG)frameNum * LIGHTBENCH_OBJECTNUM)), (int)(selectTotal * 100 / ((LONGLONG)frameNum * LIGHTBENCH_OBJECTNUM) % 100));
+
+	for(int i=0; i<LIGHTBENCH_LIGHTNUM; i++)
+	{
+		DeleteLightHandle(lightHandle[i]);
+	}
+	LightBin_Terminate(&bin);
+	return true;
+}
 
 /**
 * @fn WinMain
@@ -25,11 +126,26 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	int modelHandle;
 	int pixelShaderHandle;
 	int vertexShaderHandle;
+	int instanceVertexShaderHandle;
 	float lightRotateAngle;
 	int dirLightHandle;
-	int pointLightHandle;
+	int lampHandle[LIGHT_NUM];
+	VECTOR lampCenter[LIGHT_NUM];
+	LIGHTBIN lightBin;
+	int lightIndex[LIGHTBIN_SLOTNUM];
+	INSTANCEMESH boxMesh;
 	float drawX, drawZ;
 
+	// -lightbench を指定して起動した場合は、ウインドウを表示せずにライトを選ぶ速さを測るだけにする
+	bool lightBench = strstr(lpCmdLine, "-lightbench") != NULL;
+
+	// -cooktexture を指定して起動した場合は、ウインドウを表示せずにテクスチャを DDS ファイルにするだけにする
+	bool cookTexture = strstr(lpCmdLine, "-cooktexture") != NULL;
+	if(lightBench || cookTexture)
+	{
+		SetWindowVisibleFlag(false);
+	}
+
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
@@ -43,6 +159,22 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return -1;
 	}
 
+	if(lightBench)
+	{
+		bool result = RunLightBenchmark();
+		DxLib_End();
+		return result ? 0 : -1;
+	}
+
+	// モデルのテクスチャを DDS ファイルにする( BC1 )
+	if(cookTexture)
+	{
+		bool result = TextureCook_Cook("Resource/Texture0.bmp", "Resource/Texture0.dds", TEXTURECOOK_FORMAT_BC1);
+		ErrorLogFmtAdd("cooktexture : Texture0.dds %s", result ? "written" : "failed");
+		DxLib_End();
+		return result ? 0 : -1;
+	}
+
 	// プログラマブルシェーダーモデル２．０が使用できない場合はエラーを表示して終了
 	if(GetValidShaderVersion() < 200)
 	{
@@ -62,11 +194,52 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// 頂点シェーダーを読み込む
 	vertexShaderHandle = LoadVertexShader("Resource/NormalMesh_DirPointLightVS.vso");
 
+	// インスタンスの行列を定数レジスタから取り出す頂点シェーダーを読み込む
+	instanceVertexShaderHandle = LoadVertexShader("Resource/NormalMesh_DirPointLightInstVS.vso");
+
 	// ピクセルシェーダーを読み込む
 	pixelShaderHandle = LoadPixelShader("Resource/NormalMesh_DirPointLightPS.pso");
 
-	// 剛体メッシュモデルを読み込む
-	modelHandle = MV1LoadModel("Resource/NormalBox.mqo");
+	// 剛体メッシュモデルを読み込む( 元の画像より新しい DDS ファイルがあるテクスチャはそちらを読み込む )
+	modelHandle = TextureCook_LoadModel("Resource/NormalBox.mqo", NULL);
+
+	// シェーダーかモデルが読み込めなかったら終了
+	if(vertexShaderHandle == -1 || instanceVertexShaderHandle == -1 || pixelShaderHandle == -1 || modelHandle == -1)
+	{
+		DeleteShader(vertexShaderHandle);
+		DeleteShader(instanceVertexShaderHandle);
+		DeleteShader(pixelShaderHandle);
+		MV1DeleteModel(modelHandle);
+		DxLib_End();
+		return -1;
+	}
+
+	// 同じモデルを並べる位置をインスタンスとして登録する
+	// 近くのモデルが続き番号になるように、CLUSTER_SIZE x CLUSTER_SIZE の塊ごとに登録する
+	if(!InstanceMesh_Initialize(&boxMesh, modelHandle, DRAW_NUM * DRAW_NUM))
+	{
+		DeleteShader(vertexShaderHandle);
+		DeleteShader(instanceVertexShaderHandle);
+		DeleteShader(pixelShaderHandle);
+		MV1DeleteModel(modelHandle);
+		DxLib_End();
+		return -1;
+	}
+	for(int clusterZ=0; clusterZ<DRAW_NUM; clusterZ+=CLUSTER_SIZE)
+	{
+		for(int clusterX=0; clusterX<DRAW_NUM; clusterX+=CLUSTER_SIZE)
+		{
+			for(int i=clusterZ; i<clusterZ+CLUSTER_SIZE && i<DRAW_NUM; i++)
+			{
+				for(int j=clusterX; j<clusterX+CLUSTER_SIZE && j<DRAW_NUM; j++)
+				{
+					drawX = -(DRAW_NUM - 1) * SPACE / 2.0f + j * SPACE;
+					drawZ = -(DRAW_NUM - 1) * SPACE / 2.0f + i * SPACE;
+					InstanceMesh_Add(&boxMesh, MGetTranslate(VGet(drawX, 0.0f, drawZ)));
+				}
+			}
+		}
+	}
 
 	// 描画先を裏画面にする
 	SetDrawScreen(DX_SCREEN_BACK);
@@ -81,7 +254,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	SetUsePixelShader(pixelShaderHandle);
 
 	// 観察しやすい位置にカメラを移動
-	SetCameraPositionAndTarget_UpVecY(VGet(800.0f, 400.0f, -800.0f), VGet(0.0f, 0.0f, 0.0f));
+	SetCameraPositionAndTarget_UpVecY(VGet(2400.0f, 2400.0f, -3200.0f), VGet(0.0f, 0.0f, 0.0f));
 
 	// ライトの位置を回転する値を初期化
 	lightRotateAngle = 0.0f;
@@ -98,14 +271,24 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// ディレクショナルライトのディフューズカラーを緑にする
 	SetLightDifColorHandle(dirLightHandle, GetColorF(0.0f, 1.0f, 0.0f, 0.0f));
 
-	// ポイントライトを作成する
-	pointLightHandle = CreatePointLightHandle(VGet(0.0f, 0.0f, 0.0f), 7000.0f, 1.016523f, 0.000100f, 0.000010f);
-
-	// ポイントライトのアンビエントカラーを無効にする
-	SetLightAmbColorHandle(pointLightHandle, GetColorF(0.0f, 0.0f, 0.0f, 0.0f));
-
-	// ポイントライトのディフューズカラーを強い赤色にする
-	SetLightDifColorHandle(pointLightHandle, GetColorF(2.0f, 0.0f, 0.0f, 0.0f));
+	// ポイントライトとスポットライトをモデルを並べた範囲に散らして作成し、モデルごとに選ぶ入れ物に登録する
+	if(!LightBin_Initialize(&lightBin, LIGHT_NUM))
+	{
+		DeleteLightHandle(dirLightHandle);
+		InstanceMesh_Terminate(&boxMesh);
+		DeleteShader(vertexShaderHandle);
+		DeleteShader(instanceVertexShaderHandle);
+		DeleteShader(pixelShaderHandle);
+		MV1DeleteModel(modelHandle);
+		DxLib_End();
+		return -1;
+	}
+	for(int i=0; i<LIGHT_NUM; i++)
+	{
+		lampCenter[i] = VGet(GetRand((int)(DRAW_NUM * SPACE)) - DRAW_NUM * SPACE / 2.0f, LIGHT_HEIGHT, GetRand((int)(DRAW_NUM * SPACE)) - DRAW_NUM * SPACE / 2.0f);
+		lampHandle[i] = CreateLamp(i, lampCenter[i]);
+		LightBin_Add(&lightBin, lampHandle[i]);
+	}
 
 	// ESCキーが押されるまでループ
 	while(ProcessMessage() == 0 && CheckHitKey(KEY_INPUT_ESCAPE) == 0)
@@ -116,26 +299,76 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		// ポイントライトの位置の回転値を加算
 		lightRotateAngle += 0.02f;
 
-		// ポイントライトの位置の更新
-		SetLightPositionHandle(pointLightHandle, VGet(sinf(lightRotateAngle) * 400.0f, 400.0f, cosf(lightRotateAngle) * 400.0f));
+		// ライトの位置の更新( ライトごとに回る向きと位置をずらす )
+		for(int i=0; i<LIGHT_NUM; i++)
+		{
+			float angle = lightRotateAngle * (i % 2 == 0 ? 1.0f : -1.0f) + i;
+			SetLightPositionHandle(lampHandle[i], VAdd(lampCenter[i], VGet(sinf(angle) * LIGHT_MOVERADIUS, 0.0f, cosf(angle) * LIGHT_MOVERADIUS)));
+		}
+
+		// 動かしたライトの設定を読み込む
+		LightBin_Update(&lightBin);
 
 		// モデルを描画
-		drawZ = -(DRAW_NUM - 1) * SPACE / 2.0f;
-		for(int i=0; i<DRAW_NUM; i++)
+		int selectTotal = 0;
+		int drawCallNum = 0;
+		LONGLONG selectTime = 0;
+		bool perModel = CheckHitKey(KEY_INPUT_SPACE) != 0 || boxMesh.instanceNum == 0;
+		if(perModel)
 		{
-			drawX = -(DRAW_NUM - 1) * SPACE / 2.0f;
-			for(int j=0; j<DRAW_NUM; j++)
+			// １つずつ位置を設定して描画する
+			drawZ = -(DRAW_NUM - 1) * SPACE / 2.0f;
+			for(int i=0; i<DRAW_NUM; i++)
 			{
-				// 位置を設定
-				MV1SetPosition(modelHandle, VGet(drawX, 0.0f, drawZ));
-
-				// 描画
-				MV1DrawModel(modelHandle);
-
-				drawX += SPACE;
+				drawX = -(DRAW_NUM - 1) * SPACE / 2.0f;
+				for(int j=0; j<DRAW_NUM; j++)
+				{
+					// 位置を設定
+					MV1SetPosition(modelHandle, VGet(drawX, 0.0f, drawZ));
+
+					// モデルに届くライトを選んでシェーダーに渡す
+					LONGLONG selectStart = GetNowHiPerformanceCount();
+					int lightNum = LightBin_Select(&lightBin, VGet(drawX, 0.0f, drawZ), MODEL_RADIUS, lightIndex, LIGHTBIN_SLOTNUM);
+					LightBin_SetShaderConst(&lightBin, lightIndex, lightNum);
+					selectTime += GetNowHiPerformanceCount() - selectStart;
+					selectTotal += lightNum;
+
+					// 描画
+					MV1DrawModel(modelHandle);
+					drawCallNum++;
+
+					drawX += SPACE;
+				}
+				drawZ += SPACE;
+			}
+		}
+		else
+		{
+			// 近くのモデルの塊ごとにインスタンスをまとめて描画する( ライトは塊を囲む球で選ぶ )
+			// ライトの枠は描画１回分しか無いので、描画回数は塊の数( DRAW_NUM * DRAW_NUM / CLUSTER_NUM )になる
+			SetUseVertexShader(instanceVertexShaderHandle);
+			InstanceMesh_ResetStats(&boxMesh);
+			for(int i=0; i<boxMesh.instanceNum; i+=CLUSTER_NUM)
+			{
+				VECTOR center;
+				float radius;
+				int batchNum = boxMesh.instanceNum - i < CLUSTER_NUM ? boxMesh.instanceNum - i : CLUSTER_NUM;
+				InstanceMesh_GetBounds(&boxMesh, i, batchNum, &center, &radius);
+
+				LONGLONG selectStart = GetNowHiPerformanceCount();
+				int lightNum = LightBin_Select(&lightBin, center, radius, lightIndex, LIGHTBIN_SLOTNUM);
+				LightBin_SetShaderConst(&lightBin, lightIndex, lightNum);
+				selectTime += GetNowHiPerformanceCount() - selectStart;
+				selectTotal += lightNum;
+
+				InstanceMesh_Draw(&boxMesh, i, batchNum);
 			}
-			drawZ += SPACE;
+			drawCallNum = boxMesh.drawCallNum;
+			SetUseVertexShader(vertexShaderHandle);
 		}
+		DrawFormatString(0, 0, GetColor(255, 255, 255), "light %d  select %d/%d draws  %lldus", LIGHT_NUM, selectTotal, drawCallNum, selectTime);
+		DrawFormatString(0, 20, GetColor(255, 255, 255), "%s  model %d  draw call %d  saved %d  instance rebuild %d",
+			perModel ? "per model" : "instanced per cluster ( SPACE : per model )", DRAW_NUM * DRAW_NUM, drawCallNum, DRAW_NUM * DRAW_NUM - drawCallNum, boxMesh.rebuildNum);
 
 		// 裏画面の内容を表画面に反映させる
 		ScreenFlip();
@@ -144,11 +377,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	// ディレクショナルライトの削除
 	DeleteLightHandle(dirLightHandle);
 
-	// ポイントライトの削除
-	DeleteLightHandle(pointLightHandle);
+	// ポイントライトとスポットライトの削除
+	for(int i=0; i<LIGHT_NUM; i++)
+	{
+		DeleteLightHandle(lampHandle[i]);
+	}
+	LightBin_Terminate(&lightBin);
+
+	// インスタンスの後始末
+	InstanceMesh_Terminate(&boxMesh);
 
 	// 読み込んだ頂点シェーダーの削除
 	DeleteShader(vertexShaderHandle);
+	DeleteShader(instanceVertexShaderHandle);
 
 	// 読み込んだピクセルシェーダーの削除
 	DeleteShader(pixelShaderHandle);
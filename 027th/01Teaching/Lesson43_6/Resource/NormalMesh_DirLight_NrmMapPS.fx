@@ -74,8 +74,10 @@ PS_OUTPUT main( PS_INPUT PSInput )
 	TempF3.z = dot( VNrm, -PSInput.VPosition.xyz ) ;
 	V_to_Eye = normalize( TempF3 ) ;
 
-	// 法線の 0～1 の値を -1.0～1.0 に変換する
-	Normal = ( tex2D( NormalMapTexture, PSInput.TexCoords0.xy ).rgb - float3( 0.5f, 0.5f, 0.5f ) ) * 2.0f ;
+	// 法線のＸとＹの 0～1 の値を -1.0～1.0 に変換し、Ｚは長さが１になるように求める
+	// ( BC5 に圧縮した法線マップはＸとＹしか持たないため )
+	Normal.xy = ( tex2D( NormalMapTexture, PSInput.TexCoords0.xy ).rg - float2( 0.5f, 0.5f ) ) * 2.0f ;
+	Normal.z = sqrt( saturate( 1.0f - dot( Normal.xy, Normal.xy ) ) ) ;
 
 	// ディフューズカラーとスペキュラカラーの蓄積値を初期化
 	TotalDiffuse  = float4( 0.0f, 0.0f, 0.0f, 0.0f ) ;
@@ -1,3 +1,17 @@
-ShaderCompiler.exe /Tvs_3_0 NormalMesh_DirLight_NrmMapVS.fx
-ShaderCompiler.exe /Tps_3_0 NormalMesh_DirLight_NrmMapPS.fx
-pause
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_NoLightVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_NoLightPS.fx || goto error
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_DirLightVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_DirLightPS.fx || goto error
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_PointLightVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_PointLightPS.fx || goto error
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_SpotLightVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_SpotLightPS.fx || goto error
+ShaderCompiler.exe /Tvs_2_0 NormalMesh_DirPointLightVS.fx || goto error
+ShaderCompiler.exe /Tps_2_0 NormalMesh_DirPointLightPS.fx || goto error
+ShaderCompiler.exe /Tvs_3_0 NormalMesh_DirLight_NrmMapVS.fx || goto error
+ShaderCompiler.exe /Tps_3_0 NormalMesh_DirLight_NrmMapPS.fx || goto error
+if "%1"=="" pause
+exit /b 0
+:error
+if "%1"=="" pause
+exit /b 1
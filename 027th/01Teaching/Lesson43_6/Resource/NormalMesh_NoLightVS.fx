@@ -0,0 +1,71 @@
+// 頂点シェーダーの入力
+struct VS_INPUT
+{
+	float4 Position        : POSITION ;	// 座標( ローカル空間 )
+	float3 Normal          : NORMAL0 ;	// 法線( ローカル空間 )
+	float4 Diffuse         : COLOR0 ;	// ディフューズカラー
+	float4 Specular        : COLOR1 ;	// スペキュラカラー
+	float4 TexCoords0      : TEXCOORD0 ;	// テクスチャ座標
+} ;
+
+// 頂点シェーダーの出力
+struct VS_OUTPUT
+{
+	float4 Position        : POSITION ;
+	float2 TexCoords0      : TEXCOORD0 ;
+} ;
+
+
+
+// C++ 側で設定する定数の定義
+float4              cfProjectionMatrix[ 4 ]   : register( c2  ) ;		// ビュー　　→　射影行列
+float4              cfViewMatrix[ 3 ]         : register( c6  ) ;		// ワールド　→　ビュー行列
+float4              cfTextureMatrix[ 3 ][ 2 ] : register( c88 ) ;		// テクスチャ座標操作用行列
+float4              cfLocalWorldMatrix[ 3 ]   : register( c94 ) ;		// ローカル　→　ワールド行列
+
+
+// main関数
+VS_OUTPUT main( VS_INPUT VSInput )
+{
+	VS_OUTPUT VSOutput ;
+	float4 lWorldPosition ;
+	float4 lViewPosition ;
+
+
+	// 頂点座標変換 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 開始 )
+
+	// ローカル座標をワールド座標に変換
+	lWorldPosition.x = dot( VSInput.Position, cfLocalWorldMatrix[ 0 ] ) ;
+	lWorldPosition.y = dot( VSInput.Position, cfLocalWorldMatrix[ 1 ] ) ;
+	lWorldPosition.z = dot( VSInput.Position, cfLocalWorldMatrix[ 2 ] ) ;
+	lWorldPosition.w = 1.0f ;
+
+	// ワールド座標をビュー座標に変換
+	lViewPosition.x = dot( lWorldPosition, cfViewMatrix[ 0 ] ) ;
+	lViewPosition.y = dot( lWorldPosition, cfViewMatrix[ 1 ] ) ;
+	lViewPosition.z = dot( lWorldPosition, cfViewMatrix[ 2 ] ) ;
+	lViewPosition.w = 1.0f ;
+
+	// ビュー座標を射影座標に変換
+	VSOutput.Position.x = dot( lViewPosition, cfProjectionMatrix[ 0 ] ) ;
+	VSOutput.Position.y = dot( lViewPosition, cfProjectionMatrix[ 1 ] ) ;
+	VSOutput.Position.z = dot( lViewPosition, cfProjectionMatrix[ 2 ] ) ;
+	VSOutput.Position.w = dot( lViewPosition, cfProjectionMatrix[ 3 ] ) ;
+
+	// 頂点座標変換 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
+
+
+
+	// 出力パラメータセット ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 開始 )
+
+	// テクスチャ座標変換行列による変換を行った結果のテクスチャ座標をセット
+	VSOutput.TexCoords0.x = dot( VSInput.TexCoords0, cfTextureMatrix[ 0 ][ 0 ] ) ;
+	VSOutput.TexCoords0.y = dot( VSInput.TexCoords0, cfTextureMatrix[ 0 ][ 1 ] ) ;
+
+	// 出力パラメータセット ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++( 終了 )
+
+
+	// 出力パラメータを返す
+	return VSOutput ;
+}
+
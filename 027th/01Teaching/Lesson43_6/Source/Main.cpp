@@ -1,5 +1,8 @@
 ﻿#include "DxLib.h"
 #include <math.h>
+#include <string.h>
+#include "ShaderArchive.h"
+#include "TextureCook.h"
 /**
 * @file
 * @brief Lesson42_6
@@ -23,10 +26,25 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	int pixelShaderHandle;
 	int vertexShaderHandle;
 	float modelRotateAngle;
+	bool packShader;
+	bool cookTexture;
+	int cookedTextureNum;
+
+	// -packshader を付けて起動した場合は、シェーダーのアーカイブファイルを作って終了する
+	packShader = strstr(lpCmdLine, "-packshader") != NULL;
+
+	// -cooktexture を付けて起動した場合は、テクスチャをミップマップ付きの圧縮テクスチャにして終了する
+	cookTexture = strstr(lpCmdLine, "-cooktexture") != NULL;
 
 	// ウインドウモードで起動
 	ChangeWindowMode(true);
 
+	// アーカイブファイルやテクスチャを作るだけの場合はウインドウを表示しない
+	if(packShader || cookTexture)
+	{
+		SetWindowVisibleFlag(false);
+	}
+
 	// Direct3D9Ex を使用する
 	SetUseDirect3DVersion(DX_DIRECT3D_9EX);
 
@@ -53,14 +71,58 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return 0;
 	}
 
-	// 頂点シェーダーを読み込む
-	vertexShaderHandle = LoadVertexShader("Resource/NormalMesh_DirLight_NrmMapVS.vso");
+	// 一覧ファイルに書かれたコンパイル済みシェーダーをアーカイブファイルにまとめる
+	if(packShader)
+	{
+		if(ShaderArchive_Build("Resource/ShaderManifest.txt", "Resource/Shader.sar"))
+		{
+			ErrorLogFmtAdd("packshader : Resource/Shader.sar written");
+		}
+		else
+		{
+			ErrorLogFmtAdd("packshader : failed to build Resource/Shader.sar from Resource/ShaderManifest.txt");
+		}
+	}
+
+	// モデルのテクスチャを DDS ファイルにする( カラーは BC1、法線マップは BC5 )
+	if(cookTexture)
+	{
+		bool colorResult = TextureCook_Cook("Resource/Texture1.bmp", "Resource/Texture1.dds", TEXTURECOOK_FORMAT_BC1);
+		bool normalResult = TextureCook_Cook("Resource/BumpTexture0.bmp", "Resource/BumpTexture0.dds", TEXTURECOOK_FORMAT_BC5);
+		ErrorLogFmtAdd("cooktexture : Texture1.dds %s  BumpTexture0.dds %s", colorResult ? "written" : "failed", normalResult ? "written" : "failed");
+	}
 
-	// ピクセルシェーダーを読み込む
-	pixelShaderHandle = LoadPixelShader("Resource/NormalMesh_DirLight_NrmMapPS.pso");
+	// 作るだけの場合は終了
+	if(packShader || cookTexture)
+	{
+		DxLib_End();
+		return 0;
+	}
+
+	// シェーダーのアーカイブファイルを開き、法線マップ付きディレクショナルライト１つの組み合わせを取得する
+	// アーカイブファイルが無い場合は、今まで通り個別のファイルから読み込む
+	vertexShaderHandle = -1;
+	pixelShaderHandle = -1;
+	if(ShaderArchive_Open("Resource/Shader.sar"))
+	{
+		unsigned int feature = ShaderArchive_GetFeature(1, 0, 0, 0, true, false);
+		vertexShaderHandle = ShaderArchive_GetVertexShader(feature);
+		pixelShaderHandle = ShaderArchive_GetPixelShader(feature);
+	}
+	if(vertexShaderHandle == -1 || pixelShaderHandle == -1)
+	{
+		ShaderArchive_Close();
+
+		// 頂点シェーダーを読み込む
+		vertexShaderHandle = LoadVertexShader("Resource/NormalMesh_DirLight_NrmMapVS.vso");
+
+		// ピクセルシェーダーを読み込む
+		pixelShaderHandle = LoadPixelShader("Resource/NormalMesh_DirLight_NrmMapPS.pso");
+	}
 
 	// 剛体メッシュモデルを読み込む
-	modelHandle = MV1LoadModel("Resource/NormalBox_NrmMap.mv1");
+	// 元の画像より新しい DDS ファイルがあるテクスチャは、元の画像の代わりにミップマップ付きの圧縮テクスチャを読み込む
+	modelHandle = TextureCook_LoadModel("Resource/NormalBox_NrmMap.mv1", &cookedTextureNum);
 
 	// モデルの回転角度を初期化
 	modelRotateAngle = 0.0f;
@@ -95,15 +157,36 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		// モデルを描画
 		MV1DrawModel(modelHandle);
 
+		// シェーダーの読み込み元を表示
+		if(ShaderArchive_IsOpen())
+		{
+			DrawFormatString(0, 0, GetColor(255, 255, 255), "shader archive : %d variant  %d loaded", ShaderArchive_GetEntryNum(), ShaderArchive_GetLoadNum());
+		}
+		else
+		{
+			DrawString(0, 0, "shader archive : none ( run with -packshader )", GetColor(255, 255, 255));
+		}
+
+		// 差し替えたテクスチャの数を表示
+		DrawFormatString(0, 20, GetColor(255, 255, 255), "cooked texture : %d ( run with -cooktexture to update )", cookedTextureNum);
+
 		// 裏画面の内容を表画面に反映させる
 		ScreenFlip();
 	}
 
-	// 読み込んだ頂点シェーダーの削除
-	DeleteShader(vertexShaderHandle);
+	// 読み込んだシェーダーの削除( アーカイブファイルから作ったものはアーカイブファイルと一緒に削除する )
+	if(ShaderArchive_IsOpen())
+	{
+		ShaderArchive_Close();
+	}
+	else
+	{
+		// 読み込んだ頂点シェーダーの削除
+		DeleteShader(vertexShaderHandle);
 
-	// 読み込んだピクセルシェーダーの削除
-	DeleteShader(pixelShaderHandle);
+		// 読み込んだピクセルシェーダーの削除
+		DeleteShader(pixelShaderHandle);
+	}
 
 	// 読み込んだモデルの削除
 	MV1DeleteModel(modelHandle);
@@ -0,0 +1,608 @@
+﻿#include "ShaderArchive.h"
+#include <malloc.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson43_6
+* @author N.Yamada
+* @date 2023/01/15
+*
+* @details コンパイル済みシェーダーを機能ビットの組み合わせごとに１つのファイルにまとめたアーカイブ
+*          起動時はアーカイブファイルを１つマップするだけで、シェーダーは初めて使う時にメモリから作ってそのまま使い回す
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const unsigned int SHADERARCHIVE_ALIGN = 16;		//!< ファイル内の各シェーダーの先頭の境界
+const int SHADERARCHIVE_MAXENTRY = 256;				//!< 一覧ファイルに書けるシェーダーの組み合わせの最大数( 機能ビットの組み合わせの数 )
+const int SHADERARCHIVE_MAXTOKEN = 260;				//!< 一覧ファイルの１語の最大の長さ
+
+static HANDLE archiveFileHandle = INVALID_HANDLE_VALUE;	//!< マップしているファイルのハンドル
+static HANDLE archiveMappingHandle = NULL;		//!< ファイルマッピングオブジェクトのハンドル
+static const unsigned char *archiveImage = NULL;	//!< マップしたファイルの先頭アドレス( NULL:マップしていない )
+static const SHADERARCHIVE_ENTRY *archiveTable = NULL;	//!< マップしたファイルの中のハッシュ表
+static int *vertexShaderHandle = NULL;			//!< ハッシュ表の要素ごとの作った頂点シェーダー( -1:まだ作っていない )
+static int *pixelShaderHandle = NULL;			//!< ハッシュ表の要素ごとの作ったピクセルシェーダー( -1:まだ作っていない )
+static int loadNum = 0;							//!< 作ったシェーダーの数
+
+/**
+* @fn ShaderArchive_Checksum
+* @brief 指定のデータのチェックサムを求める
+* @param[in] const unsigned char *data, unsigned int size
+* @return unsigned int FNV-1a の 32bit ハッシュ値
+*/
+static unsigned int ShaderArchive_Checksum(const unsigned char *data, unsigned int size)
+{
+	unsigned int hash = 2166136261u;
+	for(unsigned int i=0; i<size; i++)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* @fn ShaderArchive_Find
+* @brief ハッシュ表から機能ビットの要素を探す
+* @param[in] const SHADERARCHIVE_ENTRY *table, int tableSize, unsigned int feature
+* @return int 要素の番号( 無い場合は、入れるべき空きの要素の番号を -2 から引いた値 )
+* @details 機能ビットのハッシュ値の位置から順番に調べる
+*/
+static int ShaderArchive_Find(const SHADERARCHIVE_ENTRY *table, int tableSize, unsigned int feature)
+{
+	int index = (int)(ShaderArchive_Checksum((const unsigned char *)&feature, sizeof(feature)) & (unsigned int)(tableSize - 1));
+	for(int i=0; i<tableSize; i++)
+	{
+		if(table[index].feature == feature)
+		{
+			return index;
+		}
+		if(table[index].feature == SHADERARCHIVE_EMPTY)
+		{
+			return -2 - index;
+		}
+		index = (index + 1) & (tableSize - 1);
+	}
+	return -1;
+}
+
+/**
+* @fn ShaderArchive_GetFeature
+* @brief 使う機能から機能ビットを作る
+* @param[in] int dirLightNum, int pointLightNum, int spotLightNum 各ライトの数( 0～3 ), int lightSlotNum LightBin のスロットの数( 0～7 ), bool normalMap 法線マップあり, bool skinning スキニングメッシュ
+* @return unsigned int 機能ビット
+*/
+unsigned int ShaderArchive_GetFeature(int dirLightNum, int pointLightNum, int spotLightNum, int lightSlotNum, bool normalMap, bool skinning)
+{
+	unsigned int feature = 0;
+	feature |= ((unsigned int)dirLightNum & SHADERFEATURE_LIGHTNUM_MASK) << SHADERFEATURE_DIRLIGHT_SHIFT;
+	feature |= ((unsigned int)pointLightNum & SHADERFEATURE_LIGHTNUM_MASK) << SHADERFEATURE_POINTLIGHT_SHIFT;
+	feature |= ((unsigned int)spotLightNum & SHADERFEATURE_LIGHTNUM_MASK) << SHADERFEATURE_SPOTLIGHT_SHIFT;
+	feature |= ((unsigned int)lightSlotNum & SHADERFEATURE_LIGHTSLOT_MASK) << SHADERFEATURE_LIGHTSLOT_SHIFT;
+	if(normalMap)
+	{
+		feature |= SHADERFEATURE_NORMALMAP;
+	}
+	if(skinning)
+	{
+		feature |= SHADERFEATURE_SKINNING;
+	}
+	return feature;
+}
+
+/**
+* @fn ShaderArchive_ParseFeature
+* @brief 一覧ファイルの機能の書き方( DIR1+POINT1+NRMMAP 、 DIR1+SLOT4 等、無しは NONE )を機能ビットにする
+* @param[in] const char *text
+* @param[out] unsigned int *feature
+* @return bool true:成功  false:知らない機能が書いてある
+*/
+static bool ShaderArchive_ParseFeature(const char *text, unsigned int *feature)
+{
+	int dirLightNum = 0;
+	int pointLightNum = 0;
+	int spotLightNum = 0;
+	int lightSlotNum = 0;
+	bool normalMap = false;
+	bool skinning = false;
+	while(*text != '\0')
+	{
+		// + で区切られた１つ分の長さ
+		int length = 0;
+		while(text[length] != '\0' && text[length] != '+')
+		{
+			length++;
+		}
+
+		if(length == 4 && strncmp(text, "NONE", 4) == 0)
+		{
+		}
+		else if(length == 4 && strncmp(text, "DIR", 3) == 0 && text[3] >= '0' && text[3] <= '3')
+		{
+			dirLightNum = text[3] - '0';
+		}
+		else if(length == 6 && strncmp(text, "POINT", 5) == 0 && text[5] >= '0' && text[5] <= '3')
+		{
+			pointLightNum = text[5] - '0';
+		}
+		else if(length == 5 && strncmp(text, "SPOT", 4) == 0 && text[4] >= '0' && text[4] <= '3')
+		{
+			spotLightNum = text[4] - '0';
+		}
+		else if(length == 5 && strncmp(text, "SLOT", 4) == 0 && text[4] >= '0' && text[4] <= '7')
+		{
+			lightSlotNum = text[4] - '0';
+		}
+		else if(length == 6 && strncmp(text, "NRMMAP", 6) == 0)
+		{
+			normalMap = true;
+		}
+		else if(length == 4 && strncmp(text, "SKIN", 4) == 0)
+		{
+			skinning = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		text += length;
+		if(*text == '+')
+		{
+			text++;
+		}
+	}
+	*feature = ShaderArchive_GetFeature(dirLightNum, pointLightNum, spotLightNum, lightSlotNum, normalMap, skinning);
+	return true;
+}
+
+/**
+* @fn ShaderArchive_ReadFile
+* @brief ファイル全体をメモリに読み込む
+* @param[in] const char *filePath
+* @param[out] unsigned int *fileSize
+* @return unsigned char * 読み込んだ内容( 終端に 0 を１バイト足してある、失敗した場合は NULL、使い終わったら free する )
+*/
+static unsigned char *ShaderArchive_ReadFile(const char *filePath, unsigned int *fileSize)
+{
+	HANDLE fileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	DWORD size = GetFileSize(fileHandle, NULL);
+	unsigned char *data = size != INVALID_FILE_SIZE ? (unsigned char *)malloc(size + 1) : NULL;
+	DWORD readSize = 0;
+	if(data != NULL && (ReadFile(fileHandle, data, size, &readSize, NULL) == 0 || readSize != size))
+	{
+		free(data);
+		data = NULL;
+	}
+	CloseHandle(fileHandle);
+
+	if(data != NULL)
+	{
+		data[size] = 0;
+		*fileSize = size;
+	}
+	return data;
+}
+
+/**
+* @fn ShaderArchive_GetToken
+* @brief 一覧ファイルから空白で区切られた次の１語を取り出す
+* @param[in,out] const char **text 読む位置( 取り出した語の後ろに進める )
+* @param[out] char *token, int tokenSize
+* @return bool true:取り出した  false:行の終わり
+* @details # から行の終わりまではコメントとして読み飛ばす
+*/
+static bool ShaderArchive_GetToken(const char **text, char *token, int tokenSize)
+{
+	const char *p = *text;
+	while(*p == ' ' || *p == '\t' || *p == '\r')
+	{
+		p++;
+	}
+	if(*p == '#')
+	{
+		while(*p != '\0' && *p != '\n')
+		{
+			p++;
+		}
+	}
+	if(*p == '\0' || *p == '\n')
+	{
+		*text = p;
+		return false;
+	}
+
+	int length = 0;
+	while(*p != '\0' && *p != '\n' && *p != ' ' && *p != '\t' && *p != '\r')
+	{
+		if(length < tokenSize - 1)
+		{
+			token[length++] = *p;
+		}
+		p++;
+	}
+	token[length] = '\0';
+	*text = p;
+	return true;
+}
+
+/**
+* @fn ShaderArchive_Build
+* @brief 一覧ファイルに書かれたコンパイル済みシェーダーを１つのアーカイブファイルにまとめる
+* @param[in] const char *manifestPath 一覧ファイル, const char *archivePath 書き出すアーカイブファイル
+* @return bool true:成功  false:失敗( 一覧ファイルの書き方が違う、シェーダーが読めない、機能ビットが重なっている等 )
+* @details 一覧ファイルは１行に「機能 頂点シェーダーのファイル ピクセルシェーダーのファイル」を書く
+*          ShaderCompiler.exe で .vso と .pso を作り直した後に -packshader で呼ぶ
+*/
+bool ShaderArchive_Build(const char *manifestPath, const char *archivePath)
+{
+	unsigned int manifestSize;
+	char *manifest = (char *)ShaderArchive_ReadFile(manifestPath, &manifestSize);
+	if(manifest == NULL)
+	{
+		return false;
+	}
+
+	// 一覧ファイルを１行ずつ読んで、シェーダーを読み込む
+	static unsigned int feature[SHADERARCHIVE_MAXENTRY];
+	static unsigned char *shaderData[SHADERARCHIVE_MAXENTRY][2];
+	static unsigned int shaderSize[SHADERARCHIVE_MAXENTRY][2];
+	int entryNum = 0;
+	bool result = true;
+	const char *text = manifest;
+	while(result && *text != '\0')
+	{
+		char token[3][SHADERARCHIVE_MAXTOKEN];
+		int tokenNum = 0;
+		while(tokenNum < 3 && ShaderArchive_GetToken(&text, token[tokenNum], SHADERARCHIVE_MAXTOKEN))
+		{
+			tokenNum++;
+		}
+		char extra[SHADERARCHIVE_MAXTOKEN];
+		if(tokenNum == 3 && ShaderArchive_GetToken(&text, extra, SHADERARCHIVE_MAXTOKEN))
+		{
+			tokenNum++;
+		}
+		while(*text != '\0' && *text != '\n')
+		{
+			text++;
+		}
+		if(*text == '\n')
+		{
+			text++;
+		}
+
+		// 空行とコメントだけの行は飛ばす
+		if(tokenNum == 0)
+		{
+			continue;
+		}
+		if(tokenNum != 3 || entryNum >= SHADERARCHIVE_MAXENTRY || !ShaderArchive_ParseFeature(token[0], &feature[entryNum]))
+		{
+			result = false;
+			break;
+		}
+		shaderData[entryNum][0] = ShaderArchive_ReadFile(token[1], &shaderSize[entryNum][0]);
+		shaderData[entryNum][1] = ShaderArchive_ReadFile(token[2], &shaderSize[entryNum][1]);
+		entryNum++;
+		if(shaderData[entryNum - 1][0] == NULL || shaderData[entryNum - 1][1] == NULL)
+		{
+			result = false;
+		}
+	}
+	free(manifest);
+
+	// ハッシュ表の大きさは組み合わせの数の２倍以上の２のべき乗にする
+	int tableSize = 1;
+	while(tableSize < entryNum * 2)
+	{
+		tableSize *= 2;
+	}
+	SHADERARCHIVE_ENTRY *table = (SHADERARCHIVE_ENTRY *)malloc(sizeof(SHADERARCHIVE_ENTRY) * tableSize);
+	if(table == NULL)
+	{
+		result = false;
+	}
+
+	// ヘッダとハッシュ表と各シェーダーの配置を決める
+	SHADERARCHIVE_FILEHEADER header;
+	memset(&header, 0, sizeof(header));
+	unsigned char *image = NULL;
+	if(result)
+	{
+		for(int i=0; i<tableSize; i++)
+		{
+			memset(&table[i], 0, sizeof(SHADERARCHIVE_ENTRY));
+			table[i].feature = SHADERARCHIVE_EMPTY;
+		}
+
+		unsigned int fileSize = sizeof(SHADERARCHIVE_FILEHEADER);
+		header.magic = SHADERARCHIVE_MAGIC;
+		header.version = SHADERARCHIVE_VERSION;
+		header.headerSize = sizeof(SHADERARCHIVE_FILEHEADER);
+		header.entrySize = sizeof(SHADERARCHIVE_ENTRY);
+		header.entryNum = entryNum;
+		header.tableSize = tableSize;
+		header.tableOffset = (fileSize + SHADERARCHIVE_ALIGN - 1) / SHADERARCHIVE_ALIGN * SHADERARCHIVE_ALIGN;
+		fileSize = header.tableOffset + sizeof(SHADERARCHIVE_ENTRY) * tableSize;
+		for(int i=0; i<entryNum && result; i++)
+		{
+			int index = ShaderArchive_Find(table, tableSize, feature[i]);
+			if(index >= -1)
+			{
+				// 同じ機能ビットが２回書いてある
+				result = false;
+				break;
+			}
+			index = -2 - index;
+			SHADERARCHIVE_ENTRY *entry = &table[index];
+			entry->feature = feature[i];
+			entry->vertexShaderOffset = (fileSize + SHADERARCHIVE_ALIGN - 1) / SHADERARCHIVE_ALIGN * SHADERARCHIVE_ALIGN;
+			entry->vertexShaderSize = shaderSize[i][0];
+			fileSize = entry->vertexShaderOffset + entry->vertexShaderSize;
+			entry->pixelShaderOffset = (fileSize + SHADERARCHIVE_ALIGN - 1) / SHADERARCHIVE_ALIGN * SHADERARCHIVE_ALIGN;
+			entry->pixelShaderSize = shaderSize[i][1];
+			fileSize = entry->pixelShaderOffset + entry->pixelShaderSize;
+
+			// 後で中身を書き込むため、何番目の行のシェーダーかを覚えておく
+			shaderSize[i][0] = (unsigned int)index;
+		}
+		header.fileSize = fileSize;
+
+		// ファイルの内容をメモリ上に組み立てる( 隙間は 0 で埋める )
+		image = result ? (unsigned char *)malloc(fileSize) : NULL;
+		if(image == NULL)
+		{
+			result = false;
+		}
+	}
+	if(result)
+	{
+		memset(image, 0, header.fileSize);
+		memcpy(image + header.tableOffset, table, sizeof(SHADERARCHIVE_ENTRY) * tableSize);
+		for(int i=0; i<entryNum; i++)
+		{
+			const SHADERARCHIVE_ENTRY *entry = &table[shaderSize[i][0]];
+			memcpy(image + entry->vertexShaderOffset, shaderData[i][0], entry->vertexShaderSize);
+			memcpy(image + entry->pixelShaderOffset, shaderData[i][1], entry->pixelShaderSize);
+		}
+		header.checksum = ShaderArchive_Checksum(image + sizeof(SHADERARCHIVE_FILEHEADER), header.fileSize - sizeof(SHADERARCHIVE_FILEHEADER));
+		memcpy(image, &header, sizeof(SHADERARCHIVE_FILEHEADER));
+
+		// 書き出す
+		result = false;
+		HANDLE fileHandle = CreateFileA(archivePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(fileHandle != INVALID_HANDLE_VALUE)
+		{
+			DWORD writeSize = 0;
+			result = WriteFile(fileHandle, image, header.fileSize, &writeSize, NULL) != 0 && writeSize == header.fileSize;
+			CloseHandle(fileHandle);
+		}
+	}
+
+	for(int i=0; i<entryNum; i++)
+	{
+		free(shaderData[i][0]);
+		free(shaderData[i][1]);
+	}
+	free(table);
+	free(image);
+	return result;
+}
+
+/**
+* @fn ShaderArchive_Open
+* @brief アーカイブファイルをメモリにマップする
+* @param[in] const char *archivePath
+* @return bool true:成功  false:失敗( ファイルが無い、バージョンが違う、壊れている等 )
+* @details シェーダーはまだ作らず、ShaderArchive_GetVertexShader 等で初めて使う時に作る
+*/
+bool ShaderArchive_Open(const char *archivePath)
+{
+	ShaderArchive_Close();
+
+	archiveFileHandle = CreateFileA(archivePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(archiveFileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD fileSize = GetFileSize(archiveFileHandle, NULL);
+	if(fileSize == INVALID_FILE_SIZE || fileSize < sizeof(SHADERARCHIVE_FILEHEADER))
+	{
+		ShaderArchive_Close();
+		return false;
+	}
+
+	archiveMappingHandle = CreateFileMappingA(archiveFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(archiveMappingHandle == NULL)
+	{
+		ShaderArchive_Close();
+		return false;
+	}
+
+	archiveImage = (const unsigned char *)MapViewOfFile(archiveMappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if(archiveImage == NULL)
+	{
+		ShaderArchive_Close();
+		return false;
+	}
+
+	// 形式とサイズとチェックサムを確認する
+	const SHADERARCHIVE_FILEHEADER *header = (const SHADERARCHIVE_FILEHEADER *)archiveImage;
+	if(header->magic != SHADERARCHIVE_MAGIC ||
+		header->version != SHADERARCHIVE_VERSION ||
+		header->headerSize != sizeof(SHADERARCHIVE_FILEHEADER) ||
+		header->fileSize != fileSize ||
+		header->entrySize != sizeof(SHADERARCHIVE_ENTRY) ||
+		header->tableSize <= 0 || (header->tableSize & (header->tableSize - 1)) != 0 ||
+		header->tableOffset < header->headerSize || header->tableOffset > fileSize ||
+		(unsigned long long)sizeof(SHADERARCHIVE_ENTRY) * header->tableSize > fileSize - header->tableOffset ||
+		header->checksum != ShaderArchive_Checksum(archiveImage + sizeof(SHADERARCHIVE_FILEHEADER), fileSize - sizeof(SHADERARCHIVE_FILEHEADER)))
+	{
+		ShaderArchive_Close();
+		return false;
+	}
+	archiveTable = (const SHADERARCHIVE_ENTRY *)(archiveImage + header->tableOffset);
+	for(int i=0; i<header->tableSize; i++)
+	{
+		const SHADERARCHIVE_ENTRY *entry = &archiveTable[i];
+		if(entry->feature != SHADERARCHIVE_EMPTY &&
+			(entry->vertexShaderOffset > fileSize || entry->vertexShaderSize > fileSize - entry->vertexShaderOffset ||
+			entry->pixelShaderOffset > fileSize || entry->pixelShaderSize > fileSize - entry->pixelShaderOffset))
+		{
+			ShaderArchive_Close();
+			return false;
+		}
+	}
+
+	// 作ったシェーダーを覚えておく配列
+	vertexShaderHandle = (int *)malloc(sizeof(int) * header->tableSize);
+	pixelShaderHandle = (int *)malloc(sizeof(int) * header->tableSize);
+	if(vertexShaderHandle == NULL || pixelShaderHandle == NULL)
+	{
+		ShaderArchive_Close();
+		return false;
+	}
+	for(int i=0; i<header->tableSize; i++)
+	{
+		vertexShaderHandle[i] = -1;
+		pixelShaderHandle[i] = -1;
+	}
+	loadNum = 0;
+	return true;
+}
+
+/**
+* @fn ShaderArchive_Close
+* @brief 作ったシェーダーを削除して、マップしたアーカイブファイルの後始末をする
+*/
+void ShaderArchive_Close()
+{
+	if(archiveImage != NULL && vertexShaderHandle != NULL && pixelShaderHandle != NULL)
+	{
+		int tableSize = ((const SHADERARCHIVE_FILEHEADER *)archiveImage)->tableSize;
+		for(int i=0; i<tableSize; i++)
+		{
+			if(vertexShaderHandle[i] != -1)
+			{
+				DeleteShader(vertexShaderHandle[i]);
+			}
+			if(pixelShaderHandle[i] != -1)
+			{
+				DeleteShader(pixelShaderHandle[i]);
+			}
+		}
+	}
+	free(vertexShaderHandle);
+	free(pixelShaderHandle);
+	vertexShaderHandle = NULL;
+	pixelShaderHandle = NULL;
+	loadNum = 0;
+
+	if(archiveImage != NULL)
+	{
+		UnmapViewOfFile(archiveImage);
+		archiveImage = NULL;
+		archiveTable = NULL;
+	}
+	if(archiveMappingHandle != NULL)
+	{
+		CloseHandle(archiveMappingHandle);
+		archiveMappingHandle = NULL;
+	}
+	if(archiveFileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(archiveFileHandle);
+		archiveFileHandle = INVALID_HANDLE_VALUE;
+	}
+}
+
+/**
+* @fn ShaderArchive_IsOpen
+* @brief アーカイブファイルをマップしているかどうか
+* @return bool true:マップしている  false:していない
+*/
+bool ShaderArchive_IsOpen()
+{
+	return archiveImage != NULL;
+}
+
+/**
+* @fn ShaderArchive_GetVertexShader
+* @brief 機能ビットに合う頂点シェーダーを取得する
+* @param[in] unsigned int feature
+* @return int シェーダーハンドル( 無い場合は -1 )
+* @details 初めて使う時にマップしたファイルの中から作り、２回目からは作ったものを返す
+*/
+int ShaderArchive_GetVertexShader(unsigned int feature)
+{
+	if(archiveImage == NULL)
+	{
+		return -1;
+	}
+	int index = ShaderArchive_Find(archiveTable, ((const SHADERARCHIVE_FILEHEADER *)archiveImage)->tableSize, feature);
+	if(index < 0)
+	{
+		return -1;
+	}
+	if(vertexShaderHandle[index] == -1)
+	{
+		const SHADERARCHIVE_ENTRY *entry = &archiveTable[index];
+		vertexShaderHandle[index] = LoadVertexShaderFromMem(archiveImage + entry->vertexShaderOffset, entry->vertexShaderSize);
+		loadNum++;
+	}
+	return vertexShaderHandle[index];
+}
+
+/**
+* @fn ShaderArchive_GetPixelShader
+* @brief 機能ビットに合うピクセルシェーダーを取得する
+* @param[in] unsigned int feature
+* @return int シェーダーハンドル( 無い場合は -1 )
+* @details 初めて使う時にマップしたファイルの中から作り、２回目からは作ったものを返す
+*/
+int ShaderArchive_GetPixelShader(unsigned int feature)
+{
+	if(archiveImage == NULL)
+	{
+		return -1;
+	}
+	int index = ShaderArchive_Find(archiveTable, ((const SHADERARCHIVE_FILEHEADER *)archiveImage)->tableSize, feature);
+	if(index < 0)
+	{
+		return -1;
+	}
+	if(pixelShaderHandle[index] == -1)
+	{
+		const SHADERARCHIVE_ENTRY *entry = &archiveTable[index];
+		pixelShaderHandle[index] = LoadPixelShaderFromMem(archiveImage + entry->pixelShaderOffset, entry->pixelShaderSize);
+		loadNum++;
+	}
+	return pixelShaderHandle[index];
+}
+
+/**
+* @fn ShaderArchive_GetEntryNum
+* @brief 登録されているシェーダーの組み合わせの数
+* @return int
+*/
+int ShaderArchive_GetEntryNum()
+{
+	return archiveImage != NULL ? ((const SHADERARCHIVE_FILEHEADER *)archiveImage)->entryNum : 0;
+}
+
+/**
+* @fn ShaderArchive_GetLoadNum
+* @brief 作ったシェーダーの数
+* @return int
+*/
+int ShaderArchive_GetLoadNum()
+{
+	return loadNum;
+}
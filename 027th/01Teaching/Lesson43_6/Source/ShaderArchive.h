@@ -0,0 +1,56 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const unsigned int SHADERARCHIVE_MAGIC = 0x41444853;	//!< シェーダーアーカイブファイルの識別子( "SHDA" )
+const unsigned int SHADERARCHIVE_VERSION = 2;			//!< シェーダーアーカイブファイルの形式のバージョン( 形式や機能ビットの意味を変えたら増やす )
+const unsigned int SHADERARCHIVE_EMPTY = 0xFFFFFFFF;	//!< ハッシュ表の空いている要素の機能ビット
+
+const unsigned int SHADERFEATURE_DIRLIGHT_SHIFT = 0;	//!< 機能ビット : ディレクショナルライトの数( 0～3 )の位置
+const unsigned int SHADERFEATURE_POINTLIGHT_SHIFT = 2;	//!< 機能ビット : ポイントライトの数( 0～3 )の位置
+const unsigned int SHADERFEATURE_SPOTLIGHT_SHIFT = 4;	//!< 機能ビット : スポットライトの数( 0～3 )の位置
+const unsigned int SHADERFEATURE_LIGHTNUM_MASK = 3;		//!< 機能ビット : ライトの数の取り出し用
+const unsigned int SHADERFEATURE_NORMALMAP = 1 << 6;	//!< 機能ビット : 法線マップあり
+const unsigned int SHADERFEATURE_SKINNING = 1 << 7;		//!< 機能ビット : スキニングメッシュ
+const unsigned int SHADERFEATURE_LIGHTSLOT_SHIFT = 8;	//!< 機能ビット : LightBin で選んだポイントライトかスポットライトを入れるスロットの数( 0～7 )の位置
+const unsigned int SHADERFEATURE_LIGHTSLOT_MASK = 7;	//!< 機能ビット : スロットの数の取り出し用
+
+/**
+* @struct SHADERARCHIVE_FILEHEADER
+* @brief シェーダーアーカイブファイルの先頭に置く情報
+* @details 各配列はファイルの先頭からのオフセットで指すので、どのアドレスに読み込んでもそのまま使える
+*/
+struct SHADERARCHIVE_FILEHEADER
+{
+	unsigned int magic;						//!< 識別子( SHADERARCHIVE_MAGIC )
+	unsigned int version;					//!< 形式のバージョン( SHADERARCHIVE_VERSION )
+	unsigned int headerSize;				//!< この構造体のサイズ
+	unsigned int fileSize;					//!< ファイル全体のサイズ
+	unsigned int checksum;					//!< ヘッダより後ろの全データのチェックサム( FNV-1a )
+	unsigned int entrySize;					//!< SHADERARCHIVE_ENTRY のサイズ
+	int entryNum;							//!< 登録したシェーダーの組み合わせの数
+	int tableSize;							//!< ハッシュ表の大きさ( ２のべき乗 )
+	unsigned int tableOffset;				//!< ハッシュ表( SHADERARCHIVE_ENTRY の配列 )のオフセット
+};
+
+/**
+* @struct SHADERARCHIVE_ENTRY
+* @brief 機能ビットの組み合わせ１つ分の頂点シェーダーとピクセルシェーダー
+*/
+struct SHADERARCHIVE_ENTRY
+{
+	unsigned int feature;					//!< 機能ビット( SHADERARCHIVE_EMPTY:空き )
+	unsigned int vertexShaderOffset;		//!< コンパイル済み頂点シェーダーのオフセット
+	unsigned int vertexShaderSize;			//!< コンパイル済み頂点シェーダーのサイズ
+	unsigned int pixelShaderOffset;			//!< コンパイル済みピクセルシェーダーのオフセット
+	unsigned int pixelShaderSize;			//!< コンパイル済みピクセルシェーダーのサイズ
+};
+
+unsigned int ShaderArchive_GetFeature(int dirLightNum, int pointLightNum, int spotLightNum, int lightSlotNum, bool normalMap, bool skinning);	//!< 使う機能から機能ビットを作る
+bool ShaderArchive_Build(const char *manifestPath, const char *archivePath);	//!< 一覧ファイルに書かれたコンパイル済みシェーダーを１つのアーカイブファイルにまとめる( 戻り値  true:成功  false:失敗 )
+bool ShaderArchive_Open(const char *archivePath);	//!< アーカイブファイルをメモリにマップする( 戻り値  true:成功  false:失敗 )
+void ShaderArchive_Close(void);						//!< 作ったシェーダーを削除して、マップしたアーカイブファイルの後始末をする
+bool ShaderArchive_IsOpen(void);					//!< アーカイブファイルをマップしているかどうか
+int ShaderArchive_GetVertexShader(unsigned int feature);	//!< 機能ビットに合う頂点シェーダーを取得する( 戻り値 : シェーダーハンドル、無い場合は -1 )
+int ShaderArchive_GetPixelShader(unsigned int feature);		//!< 機能ビットに合うピクセルシェーダーを取得する( 戻り値 : シェーダーハンドル、無い場合は -1 )
+int ShaderArchive_GetEntryNum(void);				//!< 登録されているシェーダーの組み合わせの数
+int ShaderArchive_GetLoadNum(void);					//!< 作ったシェーダーの数
@@ -0,0 +1,633 @@
+﻿#include "TextureCook.h"
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+/**
+* @file
+* @brief Lesson43_6
+* @author N.Yamada
+* @date 2023/01/15
+*
+* @details 画像をあらかじめミップマップ付きのブロック圧縮テクスチャ( DDS ファイル )にしておき、実行時はそちらを読み込む
+*          圧縮は CPU で行い、４×４ピクセルのブロックごとに色の分布の主軸の両端を代表色にする
+* @note リファレンス https://dxlib.xsrv.jp/dxfunc.html
+*/
+
+const unsigned int TEXTURECOOK_DDSMAGIC = 0x20534444;			//!< DDS ファイルの先頭の "DDS "
+const unsigned int TEXTURECOOK_FOURCC[3] = { 0x31545844, 0x35545844, 0x32495441 };	//!< 圧縮形式ごとの FourCC( "DXT1", "DXT5", "ATI2" )
+const int TEXTURECOOK_BLOCKBYTE[3] = { 8, 16, 16 };	//!< 圧縮形式ごとのブロック１つのバイト数
+
+/**
+* @fn TextureCook_Pack565
+* @brief 色を 16bit( R5G6B5 )にする
+* @param[in] const float *color RGB( 0～255 )
+* @return unsigned short
+*/
+static unsigned short TextureCook_Pack565(const float *color)
+{
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	r = r < 0 ? 0 : (r > 31 ? 31 : r);
+	g = g < 0 ? 0 : (g > 63 ? 63 : g);
+	b = b < 0 ? 0 : (b > 31 ? 31 : b);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+/**
+* @fn TextureCook_Unpack565
+* @brief 16bit( R5G6B5 )の色を 0～255 の RGB に戻す
+* @param[in] unsigned short packed
+* @param[out] int *color RGB
+*/
+static void TextureCook_Unpack565(unsigned short packed, int *color)
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+/**
+* @fn TextureCook_EncodeColorBlock
+* @brief ４×４ピクセルの色を BC1 の８バイトにする
+* @param[in] const unsigned char *block RGBA × 16
+* @param[out] unsigned char *dest
+* @details 色の分布の主軸を求め、主軸に投影した両端を代表色にする( 代表色は常に４色モードの順にする )
+*/
+static void TextureCook_EncodeColorBlock(const unsigned char *block, unsigned char *dest)
+{
+	// 平均と共分散
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for(int i=0; i<16; i++)
+	{
+		for(int c=0; c<3; c++)
+		{
+			mean[c] += block[i * 4 + c];
+		}
+	}
+	for(int c=0; c<3; c++)
+	{
+		mean[c] /= 16.0f;
+	}
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for(int i=0; i<16; i++)
+	{
+		float r = block[i * 4 + 0] - mean[0];
+		float g = block[i * 4 + 1] - mean[1];
+		float b = block[i * 4 + 2] - mean[2];
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// べき乗法で主軸を求める
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for(int k=0; k<4; k++)
+	{
+		float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		float length = sqrtf(x * x + y * y + z * z);
+		if(length < 1.0e-6f)
+		{
+			break;
+		}
+		axis[0] = x / length;
+		axis[1] = y / length;
+		axis[2] = z / length;
+	}
+
+	// 主軸に投影した両端の色
+	float minDot = 1.0e30f;
+	float maxDot = -1.0e30f;
+	int minIndex = 0;
+	int maxIndex = 0;
+	for(int i=0; i<16; i++)
+	{
+		float d = block[i * 4 + 0] * axis[0] + block[i * 4 + 1] * axis[1] + block[i * 4 + 2] * axis[2];
+		if(d < minDot)
+		{
+			minDot = d;
+			minIndex = i;
+		}
+		if(d > maxDot)
+		{
+			maxDot = d;
+			maxIndex = i;
+		}
+	}
+	float maxColor[3] = { (float)block[maxIndex * 4 + 0], (float)block[maxIndex * 4 + 1], (float)block[maxIndex * 4 + 2] };
+	float minColor[3] = { (float)block[minIndex * 4 + 0], (float)block[minIndex * 4 + 1], (float)block[minIndex * 4 + 2] };
+	unsigned short color0 = TextureCook_Pack565(maxColor);
+	unsigned short color1 = TextureCook_Pack565(minColor);
+	if(color0 < color1)
+	{
+		unsigned short temp = color0;
+		color0 = color1;
+		color1 = temp;
+	}
+
+	// ４色の中で一番近い色の番号を選ぶ
+	int palette[4][3];
+	TextureCook_Unpack565(color0, palette[0]);
+	TextureCook_Unpack565(color1, palette[1]);
+	for(int c=0; c<3; c++)
+	{
+		palette[2][c] = (palette[0][c] * 2 + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + palette[1][c] * 2) / 3;
+	}
+	unsigned int indices = 0;
+	if(color0 != color1)
+	{
+		for(int i=0; i<16; i++)
+		{
+			int bestIndex = 0;
+			int bestDistance = 0x7fffffff;
+			for(int j=0; j<4; j++)
+			{
+				int r = block[i * 4 + 0] - palette[j][0];
+				int g = block[i * 4 + 1] - palette[j][1];
+				int b = block[i * 4 + 2] - palette[j][2];
+				int distance = r * r + g * g + b * b;
+				if(distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = j;
+				}
+			}
+			indices |= (unsigned int)bestIndex << (i * 2);
+		}
+	}
+
+	dest[0] = (unsigned char)(color0 & 0xff);
+	dest[1] = (unsigned char)(color0 >> 8);
+	dest[2] = (unsigned char)(color1 & 0xff);
+	dest[3] = (unsigned char)(color1 >> 8);
+	for(int i=0; i<4; i++)
+	{
+		dest[4 + i] = (unsigned char)(indices >> (i * 8));
+	}
+}
+
+/**
+* @fn TextureCook_EncodeChannelBlock
+* @brief ４×４ピクセルの１チャンネルを BC4( BC3 のアルファ、BC5 の各チャンネル )の８バイトにする
+* @param[in] const unsigned char *block RGBA × 16, int channel 0:R 1:G 2:B 3:A
+* @param[out] unsigned char *dest
+* @details 最大値と最小値を代表値にした８段階で表す
+*/
+static void TextureCook_EncodeChannelBlock(const unsigned char *block, int channel, unsigned char *dest)
+{
+	int value0 = 0;
+	int value1 = 255;
+	for(int i=0; i<16; i++)
+	{
+		int value = block[i * 4 + channel];
+		value0 = value > value0 ? value : value0;
+		value1 = value < value1 ? value : value1;
+	}
+
+	unsigned long long indices = 0;
+	if(value0 != value1)
+	{
+		int palette[8];
+		palette[0] = value0;
+		palette[1] = value1;
+		for(int j=2; j<8; j++)
+		{
+			palette[j] = ((8 - j) * value0 + (j - 1) * value1 + 3) / 7;
+		}
+		for(int i=0; i<16; i++)
+		{
+			int value = block[i * 4 + channel];
+			int bestIndex = 0;
+			int bestDistance = 256;
+			for(int j=0; j<8; j++)
+			{
+				int distance = value > palette[j] ? value - palette[j] : palette[j] - value;
+				if(distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = j;
+				}
+			}
+			indices |= (unsigned long long)bestIndex << (i * 3);
+		}
+	}
+
+	dest[0] = (unsigned char)value0;
+	dest[1] = (unsigned char)value1;
+	for(int i=0; i<6; i++)
+	{
+		dest[2 + i] = (unsigned char)(indices >> (i * 8));
+	}
+}
+
+/**
+* @fn TextureCook_EncodeLevel
+* @brief ミップマップ１段分の画像をブロック圧縮する
+* @param[in] const unsigned char *image RGBA, int width, int height, int format TEXTURECOOK_FORMAT_BC1 等
+* @param[out] unsigned char *dest
+* @return int 書き込んだバイト数
+* @details ４の倍数に足りない端のブロックは、画像の端のピクセルを繰り返す
+*/
+static int TextureCook_EncodeLevel(const unsigned char *image, int width, int height, int format, unsigned char *dest)
+{
+	int size = 0;
+	for(int blockY=0; blockY<height; blockY+=4)
+	{
+		for(int blockX=0; blockX<width; blockX+=4)
+		{
+			unsigned char block[16 * 4];
+			for(int y=0; y<4; y++)
+			{
+				for(int x=0; x<4; x++)
+				{
+					int srcX = blockX + x < width ? blockX + x : width - 1;
+					int srcY = blockY + y < height ? blockY + y : height - 1;
+					memcpy(&block[(y * 4 + x) * 4], &image[(srcY * width + srcX) * 4], 4);
+				}
+			}
+
+			if(format == TEXTURECOOK_FORMAT_BC1)
+			{
+				TextureCook_EncodeColorBlock(block, dest + size);
+			}
+			else if(format == TEXTURECOOK_FORMAT_BC3)
+			{
+				TextureCook_EncodeChannelBlock(block, 3, dest + size);
+				TextureCook_EncodeColorBlock(block, dest + size + 8);
+			}
+			else
+			{
+				TextureCook_EncodeChannelBlock(block, 0, dest + size);
+				TextureCook_EncodeChannelBlock(block, 1, dest + size + 8);
+			}
+			size += TEXTURECOOK_BLOCKBYTE[format];
+		}
+	}
+	return size;
+}
+
+/**
+* @fn TextureCook_Downsample
+* @brief ２×２ピクセルを平均して半分の大きさの画像を作る
+* @param[in] const unsigned char *image RGBA, int width, int height, bool normalMap 法線マップ( 平均した法線を正規化する )
+* @param[out] unsigned char *dest RGBA( 幅と高さは半分、1 より小さくはしない )
+*/
+static void TextureCook_Downsample(const unsigned char *image, int width, int height, bool normalMap, unsigned char *dest)
+{
+	int destWidth = width > 1 ? width / 2 : 1;
+	int destHeight = height > 1 ? height / 2 : 1;
+	for(int y=0; y<destHeight; y++)
+	{
+		for(int x=0; x<destWidth; x++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for(int k=0; k<4; k++)
+			{
+				int srcX = x * 2 + (k & 1) < width ? x * 2 + (k & 1) : width - 1;
+				int srcY = y * 2 + (k >> 1) < height ? y * 2 + (k >> 1) : height - 1;
+				const unsigned char *src = &image[(srcY * width + srcX) * 4];
+				for(int c=0; c<4; c++)
+				{
+					sum[c] += normalMap && c < 3 ? src[c] / 127.5f - 1.0f : (float)src[c];
+				}
+			}
+
+			unsigned char *pixel = &dest[(y * destWidth + x) * 4];
+			if(normalMap)
+			{
+				float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				for(int c=0; c<3; c++)
+				{
+					float n = length > 1.0e-6f ? sum[c] / length : (c == 2 ? 1.0f : 0.0f);
+					pixel[c] = (unsigned char)((n * 0.5f + 0.5f) * 255.0f + 0.5f);
+				}
+				pixel[3] = (unsigned char)(sum[3] / 4.0f + 0.5f);
+			}
+			else
+			{
+				for(int c=0; c<4; c++)
+				{
+					pixel[c] = (unsigned char)(sum[c] / 4.0f + 0.5f);
+				}
+			}
+		}
+	}
+}
+
+/**
+* @fn TextureCook_Cook
+* @brief 画像を読み込んでミップマップを作り、ブロック圧縮して DDS ファイルに書き出す
+* @param[in] const char *sourcePath 元の画像( DXライブラリで読める形式 ), const char *ddsPath 書き出す DDS ファイル, int format TEXTURECOOK_FORMAT_BC1 等
+* @return bool true:成功  false:失敗
+* @details ミップマップは 1×1 まで作る、BC5 は法線マップとして扱い、縮小した法線を正規化する
+*/
+bool TextureCook_Cook(const char *sourcePath, const char *ddsPath, int format)
+{
+	if(format < TEXTURECOOK_FORMAT_BC1 || format > TEXTURECOOK_FORMAT_BC5)
+	{
+		return false;
+	}
+
+	// 元の画像を RGBA で読み込む
+	int softImageHandle = LoadSoftImage(sourcePath);
+	if(softImageHandle == -1)
+	{
+		return false;
+	}
+	int width, height;
+	GetSoftImageSize(softImageHandle, &width, &height);
+	unsigned char *image = width > 0 && height > 0 ? (unsigned char *)malloc(width * height * 4) : NULL;
+	if(image == NULL)
+	{
+		DeleteSoftImage(softImageHandle);
+		return false;
+	}
+	for(int y=0; y<height; y++)
+	{
+		for(int x=0; x<width; x++)
+		{
+			int r, g, b, a;
+			GetPixelSoftImage(softImageHandle, x, y, &r, &g, &b, &a);
+			unsigned char *pixel = &image[(y * width + x) * 4];
+			pixel[0] = (unsigned char)r;
+			pixel[1] = (unsigned char)g;
+			pixel[2] = (unsigned char)b;
+			pixel[3] = (unsigned char)a;
+		}
+	}
+	DeleteSoftImage(softImageHandle);
+
+	// ミップマップの段数と圧縮後の合計サイズ
+	int levelNum = 0;
+	int dataSize = 0;
+	for(int w=width, h=height; ; w=w>1?w/2:1, h=h>1?h/2:1)
+	{
+		dataSize += ((w + 3) / 4) * ((h + 3) / 4) * TEXTURECOOK_BLOCKBYTE[format];
+		levelNum++;
+		if(w == 1 && h == 1)
+		{
+			break;
+		}
+	}
+
+	// DDS のヘッダ
+	unsigned int header[32];
+	memset(header, 0, sizeof(header));
+	header[0] = TEXTURECOOK_DDSMAGIC;
+	header[1] = 124;								// ヘッダのサイズ
+	header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;	// CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+	header[3] = height;
+	header[4] = width;
+	header[5] = ((width + 3) / 4) * ((height + 3) / 4) * TEXTURECOOK_BLOCKBYTE[format];
+	header[7] = levelNum;
+	header[19] = 32;								// ピクセルフォーマットのサイズ
+	header[20] = 0x4;								// FOURCC
+	header[21] = TEXTURECOOK_FOURCC[format];
+	header[27] = 0x1000 | 0x400000 | 0x8;			// TEXTURE | MIPMAP | COMPLEX
+
+	// 縮小しながら１段ずつ圧縮する
+	unsigned char *data = (unsigned char *)malloc(sizeof(header) + dataSize);
+	unsigned char *work = (unsigned char *)malloc((width > 1 ? width / 2 : 1) * (height > 1 ? height / 2 : 1) * 4);
+	bool result = false;
+	if(data != NULL && work != NULL)
+	{
+		memcpy(data, header, sizeof(header));
+		int offset = sizeof(header);
+		int w = width;
+		int h = height;
+		for(int i=0; i<levelNum; i++)
+		{
+			offset += TextureCook_EncodeLevel(image, w, h, format, data + offset);
+			if(i + 1 < levelNum)
+			{
+				TextureCook_Downsample(image, w, h, format == TEXTURECOOK_FORMAT_BC5, work);
+				w = w > 1 ? w / 2 : 1;
+				h = h > 1 ? h / 2 : 1;
+				memcpy(image, work, w * h * 4);
+			}
+		}
+
+		// 書き出す
+		HANDLE fileHandle = CreateFileA(ddsPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(fileHandle != INVALID_HANDLE_VALUE)
+		{
+			DWORD writeSize = 0;
+			result = WriteFile(fileHandle, data, offset, &writeSize, NULL) != 0 && writeSize == (DWORD)offset;
+			CloseHandle(fileHandle);
+		}
+	}
+	free(data);
+	free(work);
+	free(image);
+	return result;
+}
+
+/**
+* @fn TextureCook_GetCookedPath
+* @brief 元の画像に対応する DDS ファイルのパスを作る( 拡張子を .dds にする )
+* @param[in] const char *sourcePath
+* @param[out] char *ddsPath
+* @param[in] int ddsPathSize
+* @return bool true:成功  false:パスが長すぎる
+*/
+bool TextureCook_GetCookedPath(const char *sourcePath, char *ddsPath, int ddsPathSize)
+{
+	int length = (int)strlen(sourcePath);
+	int baseLength = length;
+	for(int i=length-1; i>=0 && sourcePath[i] != '/' && sourcePath[i] != '\\'; i--)
+	{
+		if(sourcePath[i] == '.')
+		{
+			baseLength = i;
+			break;
+		}
+	}
+	if(baseLength + 5 > ddsPathSize)
+	{
+		return false;
+	}
+	memcpy(ddsPath, sourcePath, baseLength);
+	strcpy(ddsPath + baseLength, ".dds");
+	return true;
+}
+
+/**
+* @fn TextureCook_IsCookedNewer
+* @brief DDS ファイルがあって、元の画像より新しいかどうか
+* @param[in] const char *sourcePath, const char *ddsPath
+* @return bool true:DDS ファイルを使う  false:元の画像を使う
+* @details 元の画像が無く DDS ファイルだけがある場合も DDS ファイルを使う
+*/
+static bool TextureCook_IsCookedNewer(const char *sourcePath, const char *ddsPath)
+{
+	WIN32_FILE_ATTRIBUTE_DATA ddsData;
+	WIN32_FILE_ATTRIBUTE_DATA sourceData;
+	if(GetFileAttributesExA(ddsPath, GetFileExInfoStandard, &ddsData) == 0)
+	{
+		return false;
+	}
+	if(GetFileAttributesExA(sourcePath, GetFileExInfoStandard, &sourceData) == 0)
+	{
+		return true;
+	}
+	return CompareFileTime(&ddsData.ftLastWriteTime, &sourceData.ftLastWriteTime) >= 0;
+}
+
+/**
+* @fn TextureCook_LoadGraph
+* @brief 元の画像より新しい DDS ファイルがあればそちらを読み込み、無ければ元の画像を読み込む
+* @param[in] const char *sourcePath
+* @return int グラフィックハンドル( 失敗した場合は -1 )
+*/
+int TextureCook_LoadGraph(const char *sourcePath)
+{
+	char ddsPath[MAX_PATH];
+	if(TextureCook_GetCookedPath(sourcePath, ddsPath, MAX_PATH) && TextureCook_IsCookedNewer(sourcePath, ddsPath))
+	{
+		int graphHandle = LoadGraph(ddsPath);
+		if(graphHandle != -1)
+		{
+			return graphHandle;
+		}
+	}
+	return LoadGraph(sourcePath);
+}
+
+/**
+* @struct TEXTURECOOK_MODELLOAD
+* @brief モデルを読み込む間、テクスチャの読み込みに渡す情報
+*/
+struct TEXTURECOOK_MODELLOAD
+{
+	char directory[MAX_PATH];				//!< モデルのファイルがあるフォルダ( 最後の / を含める )
+	int cookedNum;							//!< DDS ファイルを読み込んだテクスチャの数
+};
+
+/**
+* @fn TextureCook_ReadFile
+* @brief ファイルを丸ごとメモリに読み込む
+* @param[in] const char *path
+* @param[out] void **image malloc で確保したメモリ( free で解放する ), int *size
+* @return bool true:成功  false:失敗
+*/
+static bool TextureCook_ReadFile(const char *path, void **image, int *size)
+{
+	HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	DWORD fileSize = GetFileSize(fileHandle, NULL);
+	void *data = fileSize != INVALID_FILE_SIZE && fileSize > 0 ? malloc(fileSize) : NULL;
+	DWORD readSize = 0;
+	bool result = data != NULL && ReadFile(fileHandle, data, fileSize, &readSize, NULL) != 0 && readSize == fileSize;
+	CloseHandle(fileHandle);
+	if(!result)
+	{
+		free(data);
+		return false;
+	}
+	*image = data;
+	*size = (int)fileSize;
+	return true;
+}
+
+/**
+* @fn TextureCook_ModelFileRead
+* @brief モデルが使うテクスチャのファイルを読み込む( MV1LoadModelFromMem から呼ばれる )
+* @param[in] const TCHAR *filePath モデルに書かれたファイル名
+* @param[out] void **fileImageAddr, int *fileSize
+* @param[in] void *fileReadFuncData TEXTURECOOK_MODELLOAD
+* @return int 0:成功  -1:失敗
+* @details 元の画像より新しい DDS ファイルがあれば、元の画像の代わりに DDS ファイルの中身を渡す
+*          DXライブラリは画像の形式をファイルの中身で判別するので、元の画像は読み込みも展開もされない
+*/
+static int TextureCook_ModelFileRead(const TCHAR *filePath, void **fileImageAddr, int *fileSize, void *fileReadFuncData)
+{
+	TEXTURECOOK_MODELLOAD *load = (TEXTURECOOK_MODELLOAD *)fileReadFuncData;
+	char sourcePath[MAX_PATH];
+	char ddsPath[MAX_PATH];
+	if(strlen(load->directory) + strlen(filePath) + 1 > MAX_PATH)
+	{
+		return -1;
+	}
+	strcpy(sourcePath, load->directory);
+	strcat(sourcePath, filePath);
+	if(TextureCook_GetCookedPath(sourcePath, ddsPath, MAX_PATH) && TextureCook_IsCookedNewer(sourcePath, ddsPath)
+		&& TextureCook_ReadFile(ddsPath, fileImageAddr, fileSize))
+	{
+		load->cookedNum++;
+		return 0;
+	}
+	return TextureCook_ReadFile(sourcePath, fileImageAddr, fileSize) ? 0 : -1;
+}
+
+/**
+* @fn TextureCook_ModelFileRelease
+* @brief TextureCook_ModelFileRead で読み込んだメモリを解放する( MV1LoadModelFromMem から呼ばれる )
+* @param[in] void *memoryAddr, void *fileReadFuncData
+* @return int 0:成功
+*/
+static int TextureCook_ModelFileRelease(void *memoryAddr, void *fileReadFuncData)
+{
+	free(memoryAddr);
+	return 0;
+}
+
+/**
+* @fn TextureCook_LoadModel
+* @brief モデルを読み込む、テクスチャは元の画像より新しい DDS ファイルがあればそちらを読み込む
+* @param[in] const char *modelPath
+* @param[out] int *cookedNum DDS ファイルを読み込んだテクスチャの数( NULL 可 )
+* @return int モデルハンドル( 失敗した場合は -1 )
+* @details モデルのファイルをメモリに読み込んで MV1LoadModelFromMem に渡し、テクスチャのファイルは TextureCook_ModelFileRead で読み込む
+*          元の画像を展開しないので読み込み時間が減り、テクスチャのメモリはミップマップ付きの圧縮テクスチャの分だけになる
+*/
+int TextureCook_LoadModel(const char *modelPath, int *cookedNum)
+{
+	if(cookedNum != NULL)
+	{
+		*cookedNum = 0;
+	}
+
+	TEXTURECOOK_MODELLOAD load;
+	int directoryLength = 0;
+	for(int i=(int)strlen(modelPath)-1; i>=0; i--)
+	{
+		if(modelPath[i] == '/' || modelPath[i] == '\\')
+		{
+			directoryLength = i + 1;
+			break;
+		}
+	}
+	if(directoryLength >= MAX_PATH)
+	{
+		return -1;
+	}
+	memcpy(load.directory, modelPath, directoryLength);
+	load.directory[directoryLength] = '\0';
+	load.cookedNum = 0;
+
+	void *image;
+	int size;
+	if(!TextureCook_ReadFile(modelPath, &image, &size))
+	{
+		return -1;
+	}
+	int modelHandle = MV1LoadModelFromMem(image, size, TextureCook_ModelFileRead, TextureCook_ModelFileRelease, &load);
+	free(image);
+	if(cookedNum != NULL && modelHandle != -1)
+	{
+		*cookedNum = load.cookedNum;
+	}
+	return modelHandle;
+}
@@ -0,0 +1,11 @@
+﻿#pragma once
+#include "DxLib.h"
+
+const int TEXTURECOOK_FORMAT_BC1 = 0;		//!< 圧縮形式 : BC1( DXT1、アルファ無しのカラー、4bit/ピクセル )
+const int TEXTURECOOK_FORMAT_BC3 = 1;		//!< 圧縮形式 : BC3( DXT5、アルファありのカラー、8bit/ピクセル )
+const int TEXTURECOOK_FORMAT_BC5 = 2;		//!< 圧縮形式 : BC5( ATI2、法線マップのＸとＹ、8bit/ピクセル、Ｚはシェーダーで求める )
+
+bool TextureCook_Cook(const char *sourcePath, const char *ddsPath, int format);	//!< 画像を読み込んでミップマップを作り、ブロック圧縮して DDS ファイルに書き出す( 戻り値  true:成功  false:失敗 )
+bool TextureCook_GetCookedPath(const char *sourcePath, char *ddsPath, int ddsPathSize);	//!< 元の画像に対応する DDS ファイルのパスを作る( 戻り値  true:成功  false:パスが長すぎる )
+int TextureCook_LoadGraph(const char *sourcePath);	//!< 元の画像より新しい DDS ファイルがあればそちらを読み込む( 戻り値 : グラフィックハンドル、失敗した場合は -1 )
+int TextureCook_LoadModel(const char *modelPath, int *cookedNum);	//!< モデルを読み込み、元の画像より新しい DDS ファイルがあるテクスチャはそちらを読み込む( 戻り値 : モデルハンドル、失敗した場合は -1 )